@@ -65,6 +65,11 @@
 #include <limits.h>
 
 #include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/MongoCommonUpdate.h"
+#include "mongoBackend/entityTypesCache.h"
+#include "mongoBackend/indexManager.h"
+#include "mongoBackend/subscriptionCache.h"
+#include "mongoBackend/subscriptionCounters.h"
 
 #include "parseArgs/parseArgs.h"
 #include "parseArgs/paConfig.h"
@@ -87,99 +92,13 @@
 
 #include "orionTypes/EntityTypesResponse.h"
 
-#include "serviceRoutines/logTraceTreat.h"
-
 #include "ngsi/ParseData.h"
 #include "ngsiNotify/onTimeIntervalThread.h"
-
-#include "serviceRoutines/getEntityTypes.h"
-#include "serviceRoutines/getAttributesForEntityType.h"
-#include "serviceRoutines/getAllContextEntities.h"
-
-#include "serviceRoutines/versionTreat.h"
-#include "serviceRoutines/statisticsTreat.h"
-#include "serviceRoutines/exitTreat.h"
-#include "serviceRoutines/leakTreat.h"
-
-#include "serviceRoutines/postDiscoverContextAvailability.h"
-#include "serviceRoutines/postQueryContext.h"
-#include "serviceRoutines/postRegisterContext.h"
-#include "serviceRoutines/postSubscribeContext.h"
-#include "serviceRoutines/postSubscribeContextAvailability.h"
-#include "serviceRoutines/postUnsubscribeContextAvailability.h"
-#include "serviceRoutines/postUpdateContext.h"
-#include "serviceRoutines/postUpdateContextAvailabilitySubscription.h"
-#include "serviceRoutines/postUpdateContextSubscription.h"
-#include "serviceRoutines/postUnsubscribeContext.h"
-#include "serviceRoutines/postNotifyContext.h"
-#include "serviceRoutines/postNotifyContextAvailability.h"
-
-#include "serviceRoutines/postSubscribeContextConvOp.h"
-#include "serviceRoutines/postSubscribeContextAvailabilityConvOp.h"
-#include "serviceRoutines/getContextEntitiesByEntityId.h"
-#include "serviceRoutines/postContextEntitiesByEntityId.h"
-#include "serviceRoutines/getContextEntityAttributes.h"
-#include "serviceRoutines/postContextEntityAttributes.h"
-#include "serviceRoutines/getEntityByIdAttributeByName.h"
-#include "serviceRoutines/postEntityByIdAttributeByName.h"
-#include "serviceRoutines/getContextEntityTypes.h"
-#include "serviceRoutines/postContextEntityTypes.h"
-#include "serviceRoutines/getContextEntityTypeAttribute.h"
-#include "serviceRoutines/postContextEntityTypeAttribute.h"
-#include "serviceRoutines/putAvailabilitySubscriptionConvOp.h"
-#include "serviceRoutines/deleteAvailabilitySubscriptionConvOp.h"
-
-#include "serviceRoutines/getIndividualContextEntity.h"
-#include "serviceRoutines/putIndividualContextEntity.h"
-#include "serviceRoutines/badVerbPostOnly.h"
-#include "serviceRoutines/badVerbPutDeleteOnly.h"
-#include "serviceRoutines/badVerbGetPostOnly.h"
-#include "serviceRoutines/postIndividualContextEntity.h"
-#include "serviceRoutines/deleteIndividualContextEntity.h"
-#include "serviceRoutines/badVerbAllFour.h"
-#include "serviceRoutines/putIndividualContextEntityAttribute.h"
-#include "serviceRoutines/getIndividualContextEntityAttribute.h"
-#include "serviceRoutines/getNgsi10ContextEntityTypes.h"
-#include "serviceRoutines/getNgsi10ContextEntityTypesAttribute.h"
-#include "serviceRoutines/postIndividualContextEntityAttribute.h"
-#include "serviceRoutines/deleteIndividualContextEntityAttribute.h"
-#include "serviceRoutines/putSubscriptionConvOp.h"
-#include "serviceRoutines/deleteSubscriptionConvOp.h"
-#include "serviceRoutines/getAttributeValueInstance.h"
-#include "serviceRoutines/putAttributeValueInstance.h"
-#include "serviceRoutines/deleteAttributeValueInstance.h"
-#include "serviceRoutines/getAllEntitiesWithTypeAndId.h"
-#include "serviceRoutines/postAllEntitiesWithTypeAndId.h"
-#include "serviceRoutines/putAllEntitiesWithTypeAndId.h"
-#include "serviceRoutines/deleteAllEntitiesWithTypeAndId.h"
-#include "serviceRoutines/getIndividualContextEntityAttributeWithTypeAndId.h"
-#include "serviceRoutines/postIndividualContextEntityAttributeWithTypeAndId.h"
-#include "serviceRoutines/putIndividualContextEntityAttributeWithTypeAndId.h"
-#include "serviceRoutines/deleteIndividualContextEntityAttributeWithTypeAndId.h"
-#include "serviceRoutines/getAttributeValueInstanceWithTypeAndId.h"
-#include "serviceRoutines/deleteAttributeValueInstanceWithTypeAndId.h"
-#include "serviceRoutines/postAttributeValueInstanceWithTypeAndId.h"
-#include "serviceRoutines/putAttributeValueInstanceWithTypeAndId.h"
-#include "serviceRoutines/getContextEntitiesByEntityIdAndType.h"
-#include "serviceRoutines/postContextEntitiesByEntityIdAndType.h"
-#include "serviceRoutines/getEntityByIdAttributeByNameWithTypeAndId.h"
-#include "serviceRoutines/postEntityByIdAttributeByNameWithTypeAndId.h"
-
-#include "serviceRoutines/badVerbGetPutDeleteOnly.h"
-#include "serviceRoutines/badVerbGetPostDeleteOnly.h"
-#include "serviceRoutines/badVerbGetOnly.h"
-#include "serviceRoutines/badVerbGetDeleteOnly.h"
-#include "serviceRoutines/badNgsi9Request.h"
-#include "serviceRoutines/badNgsi10Request.h"
-#include "serviceRoutines/badRequest.h"
-
-#include "serviceRoutinesV2/getEntities.h"
-#include "serviceRoutinesV2/entryPointsTreat.h"
-#include "serviceRoutinesV2/getEntity.h"
-#include "serviceRoutinesV2/getEntityAttribute.h"
-#include "serviceRoutinesV2/postEntities.h"
+#include "ngsiNotify/senderThreadPool.h"
+#include "rest/httpRequestAsync.h"
 
 #include "contextBroker/version.h"
+#include "contextBroker/orionRestServices.h"
 
 #include "common/string.h"
 
@@ -221,10 +140,26 @@ char            allowedOrigin[64];
 long            dbTimeout;
 long            httpTimeout;
 int             dbPoolSize;
+int             dbPoolMin;
 char            reqMutexPolicy[16];
 bool            mutexTimeStat;
 int             writeConcern;
 unsigned        cprForwardLimit;
+long            cprForwardTimeout;
+int             notificationWorkers;
+int             notificationQueueSize;
+char            notificationQueueOverflow[16];
+int             notificationAsync;
+bool            subCache;
+int             httpPoolSize;
+int             httpPoolIdleTimeout;
+char            httpMode[16];
+int             httpThreads;
+int             countCache;
+bool            logAsync;
+int             subCounters;
+bool            updateBatch;
+bool            typesCache;
 
 
 
@@ -260,11 +195,27 @@ unsigned        cprForwardLimit;
 #define ALLOWED_ORIGIN_DESC "CORS allowed origin. use '__ALL' for any"
 #define HTTP_TMO_DESC       "timeout in milliseconds for forwards and notifications"
 #define DBPS_DESC           "database connection pool size"
+#define DBPM_DESC           "database connections established at startup (the pool grows up to -dbPoolSize)"
 #define MAX_L               900000
-#define MUTEX_POLICY_DESC   "mutex policy (none/read/write/all)"
+#define MUTEX_POLICY_DESC   "mutex policy (none/read/write/all/entity)"
 #define MUTEX_TIMESTAT_DESC "measure total semaphore waiting time"
 #define WRITE_CONCERN_DESC  "db write concern (0:unacknowledged, 1:acknowledged)"
 #define CPR_FORWARD_LIMIT_DESC "maximum number of forwarded requests to Context Providers for a single client request"
+#define CPR_FORWARD_TMO_DESC "timeout in milliseconds for the (parallel) forwards to Context Providers of a client request (-1: httpTimeout)"
+#define NOTIF_WORKERS_DESC  "number of notification sender threads (0: one thread per notification)"
+#define NOTIF_QSIZE_DESC    "maximum number of notifications waiting for a sender thread"
+#define NOTIF_QOVF_DESC     "policy for notifications arriving to a full queue (block/dropOldest/dropNewest)"
+#define HTTP_POOL_DESC      "maximum number of simultaneous connections to the same destination of notifications and forwards"
+#define HTTP_POOL_IDLE_DESC "seconds an unused connection to a destination is kept open (0: forever)"
+#define NOTIF_ASYNC_DESC    "maximum number of notifications in flight, sent without sender threads (0: use sender threads)"
+#define HTTP_MODE_DESC      "how incoming connections are served (thread: a thread per connection, select/epoll: a pool of threads)"
+#define HTTP_THREADS_DESC   "number of threads serving incoming connections in select/epoll http mode"
+#define SUBCACHE_DESC       "keep ONCHANGE subscriptions in memory (not for several brokers sharing the same database)"
+#define LOG_ASYNC_DESC      "write log lines from a dedicated thread, in batches, instead of from the thread logging them"
+#define COUNT_CACHE_DESC    "seconds the count of a paginated query (details=on, count=true) is reused (0: count every time)"
+#define SUB_COUNTERS_DESC   "seconds between writes of the lastNotification and count of subscriptions (0: write them on each notification)"
+#define UPDATE_BATCH_DESC   "updates of several entities read and write them with one single query and bulk write"
+#define TYPES_CACHE_DESC    "keep a summary of entity types and attributes in memory (not for several brokers sharing the same database)"
 
 
 
@@ -286,6 +237,7 @@ PaArgument paArgs[] =
   { "-db",            dbName,        "DB",             PaString, PaOpt, _i "orion", PaNL,   PaNL,  DB_DESC            },
   { "-dbTimeout",     &dbTimeout,    "DB_TIMEOUT",     PaDouble, PaOpt, 10000,      PaNL,   PaNL,  DB_TMO_DESC        },
   { "-dbPoolSize",    &dbPoolSize,   "DB_POOL_SIZE",   PaInt,    PaOpt, 10,         1,      10000, DBPS_DESC          },
+  { "-dbPoolMin",     &dbPoolMin,    "DB_POOL_MIN",    PaInt,    PaOpt, 1,          1,      10000, DBPM_DESC          },
 
   { "-fwdHost",       fwdHost,       "FWD_HOST",       PaString, PaOpt, LOCALHOST,  PaNL,   PaNL,  FWDHOST_DESC       },
   { "-fwdPort",       &fwdPort,      "FWD_PORT",       PaInt,    PaOpt, 0,          0,      65000, FWDPORT_DESC       },
@@ -309,6 +261,22 @@ PaArgument paArgs[] =
   { "-corsOrigin",    allowedOrigin, "ALLOWED_ORIGIN", PaString, PaOpt, _i "",      PaNL,   PaNL,  ALLOWED_ORIGIN_DESC},
 
   { "-cprForwardLimit", &cprForwardLimit, "CPR_FORWARD_LIMIT", PaUInt, PaOpt, 1000, 0, UINT_MAX, CPR_FORWARD_LIMIT_DESC},
+  { "-cprForwardTimeout", &cprForwardTimeout, "CPR_FORWARD_TIMEOUT", PaLong, PaOpt, -1, -1, MAX_L, CPR_FORWARD_TMO_DESC},
+
+  { "-notificationWorkers",       &notificationWorkers,      "NOTIF_WORKERS",  PaInt,    PaOpt, 10,         0,     1000,    NOTIF_WORKERS_DESC },
+  { "-notificationQueueSize",     &notificationQueueSize,    "NOTIF_QSIZE",    PaInt,    PaOpt, 10000,      1,     1000000, NOTIF_QSIZE_DESC   },
+  { "-notificationQueueOverflow", notificationQueueOverflow, "NOTIF_QOVF",     PaString, PaOpt, _i "dropOldest", PaNL, PaNL, NOTIF_QOVF_DESC    },
+  { "-notificationAsync",         &notificationAsync,        "NOTIF_ASYNC",    PaInt,    PaOpt, 0,          0,     100000,  NOTIF_ASYNC_DESC   },
+  { "-subCache",                  &subCache,                 "SUB_CACHE",      PaBool,   PaOpt, false,      false, true,    SUBCACHE_DESC      },
+  { "-httpPoolSize",              &httpPoolSize,             "HTTP_POOL_SIZE", PaInt,    PaOpt, 10,         1,     1000,    HTTP_POOL_DESC     },
+  { "-httpPoolIdleTimeout",       &httpPoolIdleTimeout,      "HTTP_POOL_IDLE", PaInt,    PaOpt, 60,         0,     86400,   HTTP_POOL_IDLE_DESC},
+  { "-httpMode",                  httpMode,                  "HTTP_MODE",      PaString, PaOpt, _i "thread", PaNL, PaNL,    HTTP_MODE_DESC     },
+  { "-httpThreads",               &httpThreads,              "HTTP_THREADS",   PaInt,    PaOpt, 10,         1,     1000,    HTTP_THREADS_DESC  },
+  { "-countCache",                &countCache,               "COUNT_CACHE",    PaInt,    PaOpt, 0,          0,     3600,    COUNT_CACHE_DESC   },
+  { "-logAsync",                  &logAsync,                 "LOG_ASYNC",      PaBool,   PaOpt, false,      false, true,    LOG_ASYNC_DESC     },
+  { "-subCounters",               &subCounters,              "SUB_COUNTERS",   PaInt,    PaOpt, 0,          0,     3600,    SUB_COUNTERS_DESC  },
+  { "-updateBatch",               &updateBatch,              "UPDATE_BATCH",   PaBool,   PaOpt, false,      false, true,    UPDATE_BATCH_DESC  },
+  { "-typesCache",                &typesCache,               "TYPES_CACHE",    PaBool,   PaOpt, false,      false, true,    TYPES_CACHE_DESC   },
 
 
   PA_END_OF_ARGS
@@ -316,700 +284,6 @@ PaArgument paArgs[] =
 
 
 
-/* ****************************************************************************
-*
-* restService* - vectors of REST services for the context broker
-*
-* This vector matches an incoming REST service, using the path of the URL, to a function
-* to treat the incoming request.
-*
-* The URL path is divided into components (Using '/' as field separator) so that the URL
-* "/ngsi9/registerContext" becomes a component vector of the two components
-* "ngsi9" and "registerContext".
-*
-* Each line contains the necessary information for ONE service:
-*   std::string   verb        - GET/POST/PUT/DELETE
-*   RequestType   request     - The type of the request
-*   int           components  - Number of components in the following URL component vector
-*   std::string   compV       - Component vector of the URL
-*   std::string   payloadWord - first word in the payload for the request (to verify that the payload matches the URL). If empty, no check is performed)
-*   RestTreat     treat       - Function pointer to the function to treat the incoming REST request
-*
-*/
-
-
-//
-// /v2 API
-//
-
-#define EPS                EntryPointsRequest
-#define EPS_COMPS_V2       1, { "v2"             }
-
-#define ENT                EntitiesRequest
-#define ENT_COMPS_V2       2, { "v2", "entities" }
-#define ENT_COMPS_WORD     ""
-
-
-#define IENT                EntityRequest
-#define IENT_COMPS_V2       3, { "v2", "entities", "*" }
-#define IENT_COMPS_WORD     ""
-
-#define IENTATTR                EntityAttributeRequest
-#define IENTATTR_COMPS_V2       5, { "v2", "entities", "*", "attrs", "*" }
-#define IENTATTR_COMPS_WORD     ""
-
-
-
-//
-// NGSI9
-//
-#define RCR                RegisterContext
-#define DCAR               DiscoverContextAvailability
-#define SCAR               SubscribeContextAvailability
-#define UCAR               UnsubscribeContextAvailability
-#define UCAS               UpdateContextAvailabilitySubscription
-#define NCAR               NotifyContextAvailability
-
-#define RCR_COMPS_V0       2, { "ngsi9",          "registerContext" }
-#define RCR_COMPS_V1       3, { "v1", "registry", "registerContext" }
-#define RCR_POST_WORD      "registerContextRequest"
-
-#define DCAR_COMPS_V0      2, { "ngsi9",          "discoverContextAvailability" }
-#define DCAR_COMPS_V1      3, { "v1", "registry", "discoverContextAvailability" }
-#define DCAR_POST_WORD     "discoverContextAvailabilityRequest"
-
-#define SCAR_COMPS_V0      2, { "ngsi9",          "subscribeContextAvailability" }
-#define SCAR_COMPS_V1      3, { "v1", "registry", "subscribeContextAvailability" }
-#define SCAR_POST_WORD     "subscribeContextAvailabilityRequest"
-
-#define UCAR_COMPS_V0      2, { "ngsi9",          "unsubscribeContextAvailability" }
-#define UCAR_COMPS_V1      3, { "v1", "registry", "unsubscribeContextAvailability" }
-#define UCAR_POST_WORD     "unsubscribeContextAvailabilityRequest"
-
-#define UCAS_COMPS_V0      2, { "ngsi9",          "updateContextAvailabilitySubscription" }
-#define UCAS_COMPS_V1      3, { "v1", "registry", "updateContextAvailabilitySubscription" }
-#define UCAS_POST_WORD     "updateContextAvailabilitySubscriptionRequest"
-
-#define NCAR_COMPS_V0      2, { "ngsi9",          "notifyContextAvailability" }
-#define NCAR_COMPS_V1      3, { "v1", "registry", "notifyContextAvailability" }
-#define NCAR_POST_WORD     "notifyContextAvailabilityRequest"
-
-
-
-//
-// NGSI10
-//
-#define UPCR          UpdateContext
-#define QCR           QueryContext
-#define SCR           SubscribeContext
-#define UCSR          UpdateContextSubscription
-#define UNCR          UnsubscribeContext
-#define NCR           NotifyContext
-
-#define UPCR_COMPS_V0       2, { "ngsi10",  "updateContext" }
-#define UPCR_COMPS_V1       2, { "v1",      "updateContext" }
-#define UPCR_POST_WORD     "updateContextRequest"
-
-#define QCR_COMPS_V0        2, { "ngsi10",  "queryContext" }
-#define QCR_COMPS_V1        2, { "v1",      "queryContext" }
-#define QCR_POST_WORD      "queryContextRequest"
-
-#define SCR_COMPS_V0        2, { "ngsi10",  "subscribeContext" }
-#define SCR_COMPS_V1        2, { "v1",      "subscribeContext" }
-#define SCR_POST_WORD      "subscribeContextRequest"
-
-#define UCSR_COMPS_V0       2, { "ngsi10",  "updateContextSubscription" }
-#define UCSR_COMPS_V1       2, { "v1",      "updateContextSubscription" }
-#define UCSR_POST_WORD     "updateContextSubscriptionRequest"
-
-#define UNCR_COMPS_V0       2, { "ngsi10",  "unsubscribeContext" }
-#define UNCR_COMPS_V1       2, { "v1",      "unsubscribeContext" }
-#define UNCR_POST_WORD     "unsubscribeContextRequest"
-
-#define NCR_COMPS_V0        2, { "ngsi10",  "notifyContext" }
-#define NCR_COMPS_V1        2, { "v1",      "notifyContext" }
-#define NCR_POST_WORD      "notifyContextRequest"
-
-
-//
-// NGSI9 Convenience Operations
-//
-#define CE                 ContextEntitiesByEntityId
-#define CE_COMPS_V0        3, { "ngsi9",          "contextEntities", "*" }
-#define CE_COMPS_V1        4, { "v1", "registry", "contextEntities", "*" }
-#define CE_POST_WORD       "registerProviderRequest"
-
-#define CEA                ContextEntityAttributes
-#define CEA_COMPS_V0       4, { "ngsi9",          "contextEntities", "*", "attributes" }
-#define CEA_COMPS_V1       5, { "v1", "registry", "contextEntities", "*", "attributes" }
-#define CEA_POST_WORD      "registerProviderRequest"
-
-#define CEAA               EntityByIdAttributeByName
-#define CEAA_COMPS_V0      5, { "ngsi9",          "contextEntities", "*", "attributes", "*" }
-#define CEAA_COMPS_V1      6, { "v1", "registry", "contextEntities", "*", "attributes", "*" }
-#define CEAA_POST_WORD     "registerProviderRequest"
-
-#define CT                 ContextEntityTypes
-#define CT_COMPS_V0        3, { "ngsi9",          "contextEntityTypes", "*" }
-#define CT_COMPS_V1        4, { "v1", "registry", "contextEntityTypes", "*" }
-#define CT_POST_WORD       "registerProviderRequest"
-
-#define CTA                ContextEntityTypeAttributeContainer
-#define CTA_COMPS_V0       4, { "ngsi9",          "contextEntityTypes", "*", "attributes" }
-#define CTA_COMPS_V1       5, { "v1", "registry", "contextEntityTypes", "*", "attributes" }
-#define CTA_POST_WORD      "registerProviderRequest"
-
-#define CTAA               ContextEntityTypeAttribute
-#define CTAA_COMPS_V0      5, { "ngsi9",          "contextEntityTypes", "*", "attributes", "*" }
-#define CTAA_COMPS_V1      6, { "v1", "registry", "contextEntityTypes", "*", "attributes", "*" }
-#define CTAA_POST_WORD     "registerProviderRequest"
-
-#define SCA                SubscribeContextAvailability
-#define SCA_COMPS_V0       2, { "ngsi9",          "contextAvailabilitySubscriptions" }
-#define SCA_COMPS_V1       3, { "v1", "registry", "contextAvailabilitySubscriptions" }
-#define SCA_POST_WORD      "subscribeContextAvailabilityRequest"
-
-#define SCAS               Ngsi9SubscriptionsConvOp
-#define SCAS_COMPS_V0      3, { "ngsi9",          "contextAvailabilitySubscriptions", "*" }
-#define SCAS_COMPS_V1      4, { "v1", "registry", "contextAvailabilitySubscriptions", "*" }
-#define SCAS_PUT_WORD      "updateContextAvailabilitySubscriptionRequest"
-
-
-
-//
-// NGSI10 Convenience Operations
-//
-#define ICE                IndividualContextEntity
-#define ICE_COMPS_V0       3, { "ngsi10",  "contextEntities", "*" }
-#define ICE_COMPS_V1       3, { "v1",      "contextEntities", "*" }
-#define ICE_POST_WORD      "appendContextElementRequest"
-#define ICE_PUT_WORD       "updateContextElementRequest"
-
-#define ICEA               IndividualContextEntityAttributes
-#define ICEA_COMPS_V0      4, { "ngsi10",  "contextEntities", "*", "attributes" }
-#define ICEA_COMPS_V1      4, { "v1",      "contextEntities", "*", "attributes" }
-#define ICEA_POST_WORD     "appendContextElementRequest"
-#define ICEA_PUT_WORD      "updateContextElementRequest"
-
-#define ICEAA              IndividualContextEntityAttribute
-#define ICEAA_COMPS_V0     5, { "ngsi10",  "contextEntities", "*", "attributes", "*" }
-#define ICEAA_COMPS_V1     5, { "v1",      "contextEntities", "*", "attributes", "*" }
-// FIXME P10: funny having updateContextAttributeRequest for both ... Error in NEC-SPEC?
-#define ICEAA_POST_WORD    "updateContextAttributeRequest"
-#define ICEAA_PUT_WORD     "updateContextAttributeRequest"
-
-#define AVI                AttributeValueInstance
-#define AVI_COMPS_V0       6, { "ngsi10",  "contextEntities", "*", "attributes", "*", "*" }
-#define AVI_COMPS_V1       6, { "v1",      "contextEntities", "*", "attributes", "*", "*" }
-#define AVI_PUT_WORD       "updateContextAttributeRequest"
-
-#define CET                Ngsi10ContextEntityTypes
-#define CET_COMPS_V0       3, { "ngsi10",  "contextEntityTypes", "*" }
-#define CET_COMPS_V1       3, { "v1",      "contextEntityTypes", "*" }
-
-#define CETA               Ngsi10ContextEntityTypesAttributeContainer
-#define CETA_COMPS_V0      4, { "ngsi10",  "contextEntityTypes", "*", "attributes" }
-#define CETA_COMPS_V1      4, { "v1",      "contextEntityTypes", "*", "attributes" }
-
-#define CETAA              Ngsi10ContextEntityTypesAttribute
-#define CETAA_COMPS_V0     5, { "ngsi10",  "contextEntityTypes", "*", "attributes", "*" }
-#define CETAA_COMPS_V1     5, { "v1",      "contextEntityTypes", "*", "attributes", "*" }
-
-#define SC                 SubscribeContext
-#define SC_COMPS_V0        2, { "ngsi10",  "contextSubscriptions" }
-#define SC_COMPS_V1        2, { "v1",      "contextSubscriptions" }
-#define SC_POST_WORD       "subscribeContextRequest"
-
-#define SCS                Ngsi10SubscriptionsConvOp
-#define SCS_COMPS_V0       3, { "ngsi10",  "contextSubscriptions", "*" }
-#define SCS_COMPS_V1       3, { "v1",      "contextSubscriptions", "*" }
-#define SCS_PUT_WORD       "updateContextSubscriptionRequest"
-
-
-
-//
-// TID Convenience Operations
-//
-#define ET                 EntityTypes
-#define ET_COMPS_V1        2, { "v1", "contextTypes" }
-
-#define AFET               AttributesForEntityType
-#define AFET_COMPS_V1      3, { "v1", "contextTypes", "*" }
-
-#define ACE                AllContextEntities
-#define ACE_COMPS_V1       2, { "v1", "contextEntities" }
-#define ACE_POST_WORD     "appendContextElementRequest"
-
-#define ACET               AllEntitiesWithTypeAndId
-#define ACET_COMPS_V1      6, { "v1", "contextEntities", "type", "*", "id", "*" }
-#define ACET_POST_WORD     "appendContextElementRequest"
-#define ACET_PUT_WORD      "updateContextElementRequest"
-
-#define ICEAAT              IndividualContextEntityAttributeWithTypeAndId
-#define ICEAAT_COMPS_V1     8, { "v1", "contextEntities", "type", "*", "id", "*", "attributes", "*" }
-#define ICEAAT_POST_WORD    "updateContextAttributeRequest"
-#define ICEAAT_PUT_WORD     "updateContextAttributeRequest"
-
-#define AVIT                AttributeValueInstanceWithTypeAndId
-#define AVIT_COMPS_V1       9, { "v1",      "contextEntities", "type", "*", "id", "*", "attributes", "*", "*" }
-#define AVIT_PUT_WORD       "updateContextAttributeRequest"
-#define AVIT_POST_WORD      "updateContextAttributeRequest"
-
-#define CEET                ContextEntitiesByEntityIdAndType
-#define CEET_COMPS_V1       7, { "v1", "registry", "contextEntities", "type", "*", "id", "*" }
-#define CEET_POST_WORD      "registerProviderRequest"
-
-#define CEAAT               EntityByIdAttributeByNameIdAndType
-#define CEAAT_COMPS_V1      9, { "v1", "registry", "contextEntities", "type", "*", "id", "*", "attributes", "*" }
-#define CEAAT_POST_WORD     "registerProviderRequest"
-
-
-
-//
-// Log, version, statistics ...
-//
-#define LOG                LogRequest
-#define LOGT_COMPS_V0      2, { "log", "trace"                           }
-#define LOGTL_COMPS_V0     3, { "log", "trace",      "*"                 }
-#define LOG2T_COMPS_V0     2, { "log", "traceLevel"                      }
-#define LOG2TL_COMPS_V0    3, { "log", "traceLevel", "*"                 }
-#define LOGT_COMPS_V1      4, { "v1", "admin", "log", "trace"            }
-#define LOGTL_COMPS_V1     5, { "v1", "admin", "log", "trace",      "*"  }
-#define LOG2T_COMPS_V1     4, { "v1", "admin", "log", "traceLevel"       }
-#define LOG2TL_COMPS_V1    5, { "v1", "admin", "log", "traceLevel", "*"  }
-
-#define STAT               StatisticsRequest
-#define STAT_COMPS_V0      1, { "statistics"                             }
-#define STAT_COMPS_V1      3, { "v1", "admin", "statistics"              }
-
-
-
-//
-// Unversioned requests
-//
-#define VERS               VersionRequest
-#define VERS_COMPS         1, { "version"                                }
-
-#define EXIT               ExitRequest
-#define EXIT1_COMPS        1, { "exit"                                   }
-#define EXIT2_COMPS        2, { "exit", "*"                              }
-
-#define LEAK               LeakRequest
-#define LEAK1_COMPS        1, { "leak"                                   }
-#define LEAK2_COMPS        2, { "leak", "*"                              }
-
-#define INV                InvalidRequest
-#define INV9_COMPS         2, { "ngsi9",   "*"                           }
-#define INV10_COMPS        2, { "ngsi10",  "*"                           }
-#define INV_ALL_COMPS      0, { "*", "*", "*", "*", "*", "*"             }
-
-
-
-#define API_V2                                                                                     \
-  { "GET",    EPS,       EPS_COMPS_V2,         ENT_COMPS_WORD,       entryPointsTreat           }, \
-  { "*",      EPS,       EPS_COMPS_V2,         ENT_COMPS_WORD,       badVerbAllFour             }, \
-                                                                                                   \
-  { "GET",    ENT,       ENT_COMPS_V2,         ENT_COMPS_WORD,       getEntities                }, \
-  { "POST",   ENT,       ENT_COMPS_V2,         ENT_COMPS_WORD,       postEntities               }, \
-  { "*",      ENT,       ENT_COMPS_V2,         ENT_COMPS_WORD,       badVerbGetPostOnly         }, \
-                                                                                                   \
-  { "GET",    IENT,      IENT_COMPS_V2,        IENT_COMPS_WORD,      getEntity                  }, \
-  { "*",      IENT,      IENT_COMPS_V2,        IENT_COMPS_WORD,      badVerbGetOnly             }, \
-                                                                                                   \
-  { "GET",    IENTATTR,  IENTATTR_COMPS_V2,    IENTATTR_COMPS_WORD,  getEntityAttribute         }, \
-  { "*",      IENTATTR,  IENTATTR_COMPS_V2,    IENTATTR_COMPS_WORD,  badVerbGetOnly             }
-
-
-
-#define REGISTRY_STANDARD_REQUESTS_V0                                                                    \
-  { "POST",   RCR,   RCR_COMPS_V0,         RCR_POST_WORD,   postRegisterContext                       }, \
-  { "*",      RCR,   RCR_COMPS_V0,         RCR_POST_WORD,   badVerbPostOnly                           }, \
-  { "POST",   DCAR,  DCAR_COMPS_V0,        DCAR_POST_WORD,  postDiscoverContextAvailability           }, \
-  { "*",      DCAR,  DCAR_COMPS_V0,        DCAR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   SCAR,  SCAR_COMPS_V0,        SCAR_POST_WORD,  postSubscribeContextAvailability          }, \
-  { "*",      SCAR,  SCAR_COMPS_V0,        SCAR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   UCAR,  UCAR_COMPS_V0,        UCAR_POST_WORD,  postUnsubscribeContextAvailability        }, \
-  { "*",      UCAR,  UCAR_COMPS_V0,        UCAR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   UCAS,  UCAS_COMPS_V0,        UCAS_POST_WORD,  postUpdateContextAvailabilitySubscription }, \
-  { "*",      UCAS,  UCAS_COMPS_V0,        UCAS_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   NCAR,  NCAR_COMPS_V0,        NCAR_POST_WORD,  postNotifyContextAvailability             }, \
-  { "*",      NCAR,  NCAR_COMPS_V0,        NCAR_POST_WORD,  badVerbPostOnly                           }
-
-
-
-#define REGISTRY_STANDARD_REQUESTS_V1                                                                      \
-  { "POST",   RCR,   RCR_COMPS_V1,           RCR_POST_WORD,   postRegisterContext                       }, \
-  { "*",      RCR,   RCR_COMPS_V1,           RCR_POST_WORD,   badVerbPostOnly                           }, \
-  { "POST",   DCAR,  DCAR_COMPS_V1,          DCAR_POST_WORD,  postDiscoverContextAvailability           }, \
-  { "*",      DCAR,  DCAR_COMPS_V1,          DCAR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   SCAR,  SCAR_COMPS_V1,          SCAR_POST_WORD,  postSubscribeContextAvailability          }, \
-  { "*",      SCAR,  SCAR_COMPS_V1,          SCAR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   UCAR,  UCAR_COMPS_V1,          UCAR_POST_WORD,  postUnsubscribeContextAvailability        }, \
-  { "*",      UCAR,  UCAR_COMPS_V1,          UCAR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   UCAS,  UCAS_COMPS_V1,          UCAS_POST_WORD,  postUpdateContextAvailabilitySubscription }, \
-  { "*",      UCAS,  UCAS_COMPS_V1,          UCAS_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   NCAR,  NCAR_COMPS_V1,          NCAR_POST_WORD,  postNotifyContextAvailability             }, \
-  { "*",      NCAR,  NCAR_COMPS_V1,          NCAR_POST_WORD,  badVerbPostOnly                           }
-
-
-
-#define STANDARD_REQUESTS_V0                                                                             \
-  { "POST",   UPCR,  UPCR_COMPS_V0,        UPCR_POST_WORD,  postUpdateContext                         }, \
-  { "*",      UPCR,  UPCR_COMPS_V0,        UPCR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   QCR,   QCR_COMPS_V0,         QCR_POST_WORD,   postQueryContext                          }, \
-  { "*",      QCR,   QCR_COMPS_V0,         QCR_POST_WORD,   badVerbPostOnly                           }, \
-  { "POST",   SCR,   SCR_COMPS_V0,         SCR_POST_WORD,   postSubscribeContext                      }, \
-  { "*",      SCR,   SCR_COMPS_V0,         SCR_POST_WORD,   badVerbPostOnly                           }, \
-  { "POST",   UCSR,  UCSR_COMPS_V0,        UCSR_POST_WORD,  postUpdateContextSubscription             }, \
-  { "*",      UCSR,  UCSR_COMPS_V0,        UCSR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   UNCR,  UNCR_COMPS_V0,        UNCR_POST_WORD,  postUnsubscribeContext                    }, \
-  { "*",      UNCR,  UNCR_COMPS_V0,        UNCR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   NCR,   NCR_COMPS_V0,         NCR_POST_WORD,   postNotifyContext                         }, \
-  { "*",      NCR,   NCR_COMPS_V0,         NCR_POST_WORD,   badVerbPostOnly                           }
-
-
-
-#define STANDARD_REQUESTS_V1                                                                               \
-  { "POST",   UPCR,  UPCR_COMPS_V1,          UPCR_POST_WORD,  postUpdateContext                         }, \
-  { "*",      UPCR,  UPCR_COMPS_V1,          UPCR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   QCR,   QCR_COMPS_V1,           QCR_POST_WORD,   postQueryContext                          }, \
-  { "*",      QCR,   QCR_COMPS_V1,           QCR_POST_WORD,   badVerbPostOnly                           }, \
-  { "POST",   SCR,   SCR_COMPS_V1,           SCR_POST_WORD,   postSubscribeContext                      }, \
-  { "*",      SCR,   SCR_COMPS_V1,           SCR_POST_WORD,   badVerbPostOnly                           }, \
-  { "POST",   UCSR,  UCSR_COMPS_V1,          UCSR_POST_WORD,  postUpdateContextSubscription             }, \
-  { "*",      UCSR,  UCSR_COMPS_V1,          UCSR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   UNCR,  UNCR_COMPS_V1,          UNCR_POST_WORD,  postUnsubscribeContext                    }, \
-  { "*",      UNCR,  UNCR_COMPS_V1,          UNCR_POST_WORD,  badVerbPostOnly                           }, \
-  { "POST",   NCR,   NCR_COMPS_V1,           NCR_POST_WORD,   postNotifyContext                         }, \
-  { "*",      NCR,   NCR_COMPS_V1,           NCR_POST_WORD,   badVerbPostOnly                           }
-
-
-
-#define REGISTRY_CONVENIENCE_OPERATIONS_V0                                                               \
-  { "GET",    CE,    CE_COMPS_V0,          "",              getContextEntitiesByEntityId              }, \
-  { "POST",   CE,    CE_COMPS_V0,          CE_POST_WORD,    postContextEntitiesByEntityId             }, \
-  { "*",      CE,    CE_COMPS_V0,          "",              badVerbGetPostOnly                        }, \
-                                                                                                         \
-  { "GET",    CEA,   CEA_COMPS_V0,         "",              getContextEntityAttributes                }, \
-  { "POST",   CEA,   CEA_COMPS_V0,         CEA_POST_WORD,   postContextEntityAttributes               }, \
-  { "*",      CEA,   CEA_COMPS_V0,         "",              badVerbGetPostOnly                        }, \
-                                                                                                         \
-  { "GET",    CEAA,  CEAA_COMPS_V0,        "",              getEntityByIdAttributeByName              }, \
-  { "POST",   CEAA,  CEAA_COMPS_V0,        CEAA_POST_WORD,  postEntityByIdAttributeByName             }, \
-  { "*",      CEAA,  CEAA_COMPS_V0,        "",              badVerbGetPostOnly                        }, \
-                                                                                                         \
-  { "GET",    CT,    CT_COMPS_V0,          "",              getContextEntityTypes                     }, \
-  { "POST",   CT,    CT_COMPS_V0,          CT_POST_WORD,    postContextEntityTypes                    }, \
-  { "*",      CT,    CT_COMPS_V0,          "",              badVerbGetPostOnly                        }, \
-                                                                                                         \
-  { "GET",    CTA,   CTA_COMPS_V0,         "",              getContextEntityTypes                     }, \
-  { "POST",   CTA,   CTA_COMPS_V0,         CTA_POST_WORD,   postContextEntityTypes                    }, \
-  { "*",      CTA,   CTA_COMPS_V0,         "",              badVerbGetPostOnly                        }, \
-                                                                                                         \
-  { "GET",    CTAA,  CTAA_COMPS_V0,        "",              getContextEntityTypeAttribute             }, \
-  { "POST",   CTAA,  CTAA_COMPS_V0,        CTAA_POST_WORD,  postContextEntityTypeAttribute            }, \
-  { "*",      CTAA,  CTAA_COMPS_V0,        "",              badVerbGetPostOnly                        }, \
-                                                                                                         \
-  { "POST",   SCA,   SCA_COMPS_V0,         SCA_POST_WORD,   postSubscribeContextAvailabilityConvOp    }, \
-  { "*",      SCA,   SCA_COMPS_V0,         "",              badVerbPostOnly                           }, \
-                                                                                                         \
-  { "PUT",    SCAS,  SCAS_COMPS_V0,        SCAS_PUT_WORD,   putAvailabilitySubscriptionConvOp         }, \
-  { "DELETE", SCAS,  SCAS_COMPS_V0,        "",              deleteAvailabilitySubscriptionConvOp      }, \
-  { "*",      SCAS,  SCAS_COMPS_V0,        "",              badVerbPutDeleteOnly                      }
-
-
-
-#define REGISTRY_CONVENIENCE_OPERATIONS_V1                                                                 \
-  { "GET",    CE,    CE_COMPS_V1,            "",              getContextEntitiesByEntityId              }, \
-  { "POST",   CE,    CE_COMPS_V1,            CE_POST_WORD,    postContextEntitiesByEntityId             }, \
-  { "*",      CE,    CE_COMPS_V1,            "",              badVerbGetPostOnly                        }, \
-                                                                                                           \
-  { "GET",    CEA,   CEA_COMPS_V1,           "",              getContextEntityAttributes                }, \
-  { "POST",   CEA,   CEA_COMPS_V1,           CEA_POST_WORD,   postContextEntityAttributes               }, \
-  { "*",      CEA,   CEA_COMPS_V1,           "",              badVerbGetPostOnly                        }, \
-                                                                                                           \
-  { "GET",    CEAA,  CEAA_COMPS_V1,          "",              getEntityByIdAttributeByName              }, \
-  { "POST",   CEAA,  CEAA_COMPS_V1,          CEAA_POST_WORD,  postEntityByIdAttributeByName             }, \
-  { "*",      CEAA,  CEAA_COMPS_V1,          "",              badVerbGetPostOnly                        }, \
-                                                                                                           \
-  { "GET",    CT,    CT_COMPS_V1,            "",              getContextEntityTypes                     }, \
-  { "POST",   CT,    CT_COMPS_V1,            CT_POST_WORD,    postContextEntityTypes                    }, \
-  { "*",      CT,    CT_COMPS_V1,            "",              badVerbGetPostOnly                        }, \
-                                                                                                           \
-  { "GET",    CTA,   CTA_COMPS_V1,           "",              getContextEntityTypes                     }, \
-  { "POST",   CTA,   CTA_COMPS_V1,           CTA_POST_WORD,   postContextEntityTypes                    }, \
-  { "*",      CTA,   CTA_COMPS_V1,           "",              badVerbGetPostOnly                        }, \
-                                                                                                           \
-  { "GET",    CTAA,  CTAA_COMPS_V1,          "",              getContextEntityTypeAttribute             }, \
-  { "POST",   CTAA,  CTAA_COMPS_V1,          CTAA_POST_WORD,  postContextEntityTypeAttribute            }, \
-  { "*",      CTAA,  CTAA_COMPS_V1,          "",              badVerbGetPostOnly                        }, \
-                                                                                                           \
-  { "POST",   SCA,   SCA_COMPS_V1,           SCA_POST_WORD,   postSubscribeContextAvailability          }, \
-  { "*",      SCA,   SCA_COMPS_V1,           "",              badVerbPostOnly                           }, \
-                                                                                                           \
-  { "PUT",    SCAS,  SCAS_COMPS_V1,          SCAS_PUT_WORD,   putAvailabilitySubscriptionConvOp         }, \
-  { "DELETE", SCAS,  SCAS_COMPS_V1,          "",              deleteAvailabilitySubscriptionConvOp      }, \
-  { "*",      SCAS,  SCAS_COMPS_V1,          "",              badVerbPutDeleteOnly                      }
-
-
-
-#define CONVENIENCE_OPERATIONS_V0                                                                        \
-  { "GET",    ICE,   ICE_COMPS_V0,         "",              getIndividualContextEntity                }, \
-  { "PUT",    ICE,   ICE_COMPS_V0,         ICE_PUT_WORD,    putIndividualContextEntity                }, \
-  { "POST",   ICE,   ICE_COMPS_V0,         ICE_POST_WORD,   postIndividualContextEntity               }, \
-  { "DELETE", ICE,   ICE_COMPS_V0,         "",              deleteIndividualContextEntity             }, \
-  { "*",      ICE,   ICE_COMPS_V0,         "",              badVerbAllFour                            }, \
-                                                                                                         \
-  { "GET",    ICEA,  ICEA_COMPS_V0,        "",              getIndividualContextEntity                }, \
-  { "PUT",    ICEA,  ICEA_COMPS_V0,        ICEA_PUT_WORD,   putIndividualContextEntity                }, \
-  { "POST",   ICEA,  ICEA_COMPS_V0,        ICEA_POST_WORD,  postIndividualContextEntity               }, \
-  { "DELETE", ICEA,  ICEA_COMPS_V0,        "",              deleteIndividualContextEntity             }, \
-  { "*",      ICEA,  ICEA_COMPS_V0,        "",              badVerbAllFour                            }, \
-                                                                                                         \
-  { "GET",    ICEAA, ICEAA_COMPS_V0,       "",              getIndividualContextEntityAttribute       }, \
-  { "PUT",    ICEAA, ICEAA_COMPS_V0,       ICEAA_PUT_WORD,  putIndividualContextEntityAttribute       }, \
-  { "POST",   ICEAA, ICEAA_COMPS_V0,       ICEAA_POST_WORD, postIndividualContextEntityAttribute      }, \
-  { "DELETE", ICEAA, ICEAA_COMPS_V0,       "",              deleteIndividualContextEntityAttribute    }, \
-  { "*",      ICEAA, ICEAA_COMPS_V0,       "",              badVerbGetPostDeleteOnly                  }, \
-                                                                                                         \
-  { "GET",    AVI,   AVI_COMPS_V0,         "",              getAttributeValueInstance                 }, \
-  { "PUT",    AVI,   AVI_COMPS_V0,         AVI_PUT_WORD,    putAttributeValueInstance                 }, \
-  { "DELETE", AVI,   AVI_COMPS_V0,         "",              deleteAttributeValueInstance              }, \
-  { "*",      AVI,   AVI_COMPS_V0,         "",              badVerbGetPutDeleteOnly                   }, \
-                                                                                                         \
-  { "GET",    CET,   CET_COMPS_V0,         "",              getNgsi10ContextEntityTypes               }, \
-  { "*",      CET,   CET_COMPS_V0,         "",              badVerbGetOnly                            }, \
-                                                                                                         \
-  { "GET",    CETA,  CETA_COMPS_V0,        "",              getNgsi10ContextEntityTypes               }, \
-  { "*",      CETA,  CETA_COMPS_V0,        "",              badVerbGetOnly                            }, \
-                                                                                                         \
-  { "GET",    CETAA, CETAA_COMPS_V0,       "",              getNgsi10ContextEntityTypesAttribute      }, \
-  { "*",      CETAA, CETAA_COMPS_V0,       "",              badVerbGetOnly                            }, \
-                                                                                                         \
-  { "POST",   SC,    SC_COMPS_V0,          SC_POST_WORD,    postSubscribeContextConvOp                }, \
-  { "*",      SC,    SC_COMPS_V0,          "",              badVerbPostOnly                           }, \
-                                                                                                         \
-  { "PUT",    SCS,   SCS_COMPS_V0,         SCS_PUT_WORD,    putSubscriptionConvOp                     }, \
-  { "DELETE", SCS,   SCS_COMPS_V0,         "",              deleteSubscriptionConvOp                  }, \
-  { "*",      SCS,   SCS_COMPS_V0,         "",              badVerbPutDeleteOnly                      }
-
-
-
-#define CONVENIENCE_OPERATIONS_V1                                                                          \
-  { "GET",    ICE,   ICE_COMPS_V1,           "",              getIndividualContextEntity                }, \
-  { "PUT",    ICE,   ICE_COMPS_V1,           ICE_PUT_WORD,    putIndividualContextEntity                }, \
-  { "POST",   ICE,   ICE_COMPS_V1,           ICE_POST_WORD,   postIndividualContextEntity               }, \
-  { "DELETE", ICE,   ICE_COMPS_V1,           "",              deleteIndividualContextEntity             }, \
-  { "*",      ICE,   ICE_COMPS_V1,           "",              badVerbAllFour                            }, \
-                                                                                                           \
-  { "GET",    ICEA,  ICEA_COMPS_V1,          "",              getIndividualContextEntity                }, \
-  { "PUT",    ICEA,  ICEA_COMPS_V1,          ICEA_PUT_WORD,   putIndividualContextEntity                }, \
-  { "POST",   ICEA,  ICEA_COMPS_V1,          ICEA_POST_WORD,  postIndividualContextEntity               }, \
-  { "DELETE", ICEA,  ICEA_COMPS_V1,          "",              deleteIndividualContextEntity             }, \
-  { "*",      ICEA,  ICEA_COMPS_V1,          "",              badVerbAllFour                            }, \
-                                                                                                           \
-  { "GET",    ICEAA, ICEAA_COMPS_V1,         "",              getIndividualContextEntityAttribute       }, \
-  { "PUT",    ICEAA, ICEAA_COMPS_V1,         ICEAA_PUT_WORD,  putIndividualContextEntityAttribute       }, \
-  { "POST",   ICEAA, ICEAA_COMPS_V1,         ICEAA_POST_WORD, postIndividualContextEntityAttribute      }, \
-  { "DELETE", ICEAA, ICEAA_COMPS_V1,         "",              deleteIndividualContextEntityAttribute    }, \
-  { "*",      ICEAA, ICEAA_COMPS_V1,         "",              badVerbGetPostDeleteOnly                  }, \
-                                                                                                           \
-  { "GET",    AVI,   AVI_COMPS_V1,           "",              getAttributeValueInstance                 }, \
-  { "PUT",    AVI,   AVI_COMPS_V1,           AVI_PUT_WORD,    putAttributeValueInstance                 }, \
-  { "DELETE", AVI,   AVI_COMPS_V1,           "",              deleteAttributeValueInstance              }, \
-  { "*",      AVI,   AVI_COMPS_V1,           "",              badVerbGetPutDeleteOnly                   }, \
-                                                                                                           \
-  { "GET",    CET,   CET_COMPS_V1,           "",              getNgsi10ContextEntityTypes               }, \
-  { "*",      CET,   CET_COMPS_V1,           "",              badVerbGetOnly                            }, \
-                                                                                                           \
-  { "GET",    CETA,  CETA_COMPS_V1,          "",              getNgsi10ContextEntityTypes               }, \
-  { "*",      CETA,  CETA_COMPS_V1,          "",              badVerbGetOnly                            }, \
-                                                                                                           \
-  { "GET",    CETAA, CETAA_COMPS_V1,         "",              getNgsi10ContextEntityTypesAttribute      }, \
-  { "*",      CETAA, CETAA_COMPS_V1,         "",              badVerbGetOnly                            }, \
-                                                                                                           \
-  { "POST",   SC,    SC_COMPS_V1,            SC_POST_WORD,    postSubscribeContextConvOp                }, \
-  { "*",      SC,    SC_COMPS_V1,            "",              badVerbPostOnly                           }, \
-                                                                                                           \
-  { "PUT",    SCS,   SCS_COMPS_V1,           SCS_PUT_WORD,    putSubscriptionConvOp                     }, \
-  { "DELETE", SCS,   SCS_COMPS_V1,           "",              deleteSubscriptionConvOp                  }, \
-  { "*",      SCS,   SCS_COMPS_V1,           "",              badVerbPutDeleteOnly                      }, \
-                                                                                                           \
-  { "GET",    ET,    ET_COMPS_V1,            "",              getEntityTypes                            }, \
-  { "*",      ET,    ET_COMPS_V1,            "",              badVerbGetOnly                            }, \
-  { "GET",    AFET,  AFET_COMPS_V1,          "",              getAttributesForEntityType                }, \
-  { "*",      AFET,  AFET_COMPS_V1,          "",              badVerbGetOnly                            }, \
-                                                                                                           \
-  { "GET",    ACE,   ACE_COMPS_V1,           "",              getAllContextEntities                     }, \
-  { "POST",   ACE,   ACE_COMPS_V1,           ACE_POST_WORD,   postIndividualContextEntity               }, \
-  { "*",      ACE,   ACE_COMPS_V1,           "",              badVerbGetOnly                            }, \
-                                                                                                           \
-  { "GET",    ACET,  ACET_COMPS_V1,          "",              getAllEntitiesWithTypeAndId               }, \
-  { "POST",   ACET,  ACET_COMPS_V1,          ACET_POST_WORD,  postAllEntitiesWithTypeAndId              }, \
-  { "PUT",    ACET,  ACET_COMPS_V1,          ACET_PUT_WORD,   putAllEntitiesWithTypeAndId               }, \
-  { "DELETE", ACET,  ACET_COMPS_V1,          "",              deleteAllEntitiesWithTypeAndId            }, \
-  { "*",      ACET,  ACET_COMPS_V1,          "",              badVerbAllFour                            }, \
-                                                                                                           \
-  { "GET",    ICEAAT,  ICEAAT_COMPS_V1,      "",               getIndividualContextEntityAttributeWithTypeAndId    }, \
-  { "POST",   ICEAAT,  ICEAAT_COMPS_V1,      ICEAAT_POST_WORD, postIndividualContextEntityAttributeWithTypeAndId   }, \
-  { "PUT",    ICEAAT,  ICEAAT_COMPS_V1,      ICEAAT_PUT_WORD,  putIndividualContextEntityAttributeWithTypeAndId    }, \
-  { "DELETE", ICEAAT,  ICEAAT_COMPS_V1,      "",               deleteIndividualContextEntityAttributeWithTypeAndId }, \
-  { "*",      ICEAAT,  ICEAAT_COMPS_V1,      "",               badVerbAllFour                                      }, \
-                                                                                                                      \
-  { "GET",    AVIT,    AVIT_COMPS_V1,        "",               getAttributeValueInstanceWithTypeAndId              }, \
-  { "POST",   AVIT,    AVIT_COMPS_V1,        AVIT_POST_WORD,   postAttributeValueInstanceWithTypeAndId             }, \
-  { "PUT",    AVIT,    AVIT_COMPS_V1,        AVIT_PUT_WORD,    putAttributeValueInstanceWithTypeAndId              }, \
-  { "DELETE", AVIT,    AVIT_COMPS_V1,        "",               deleteAttributeValueInstanceWithTypeAndId           }, \
-  { "*",      AVIT,    AVIT_COMPS_V1,        "",               badVerbAllFour                                      }, \
-                                                                                                                      \
-  { "GET",    CEET,    CEET_COMPS_V1,        "",               getContextEntitiesByEntityIdAndType                 }, \
-  { "POST",   CEET,    CEET_COMPS_V1,        CEET_POST_WORD,   postContextEntitiesByEntityIdAndType                }, \
-  { "*",      CEET,    CEET_COMPS_V1,        "",               badVerbGetPostOnly                                  }, \
-                                                                                                                      \
-  { "GET",    CEAAT,   CEAAT_COMPS_V1,       "",               getEntityByIdAttributeByNameWithTypeAndId           }, \
-  { "POST",   CEAAT,   CEAAT_COMPS_V1,       CEAAT_POST_WORD,  postEntityByIdAttributeByNameWithTypeAndId          }, \
-  { "*",      CEAAT,   CEAAT_COMPS_V1,       "",               badVerbGetPostOnly                                  }
-
-
-
-/* *****************************************************************************
-*  
-* log requests
-* The documentation (Installation and Admin Guide) says /log/trace ...
-* ... and to maintain backward compatibility we keep supporting /log/traceLevel too
-*/
-#define LOG_REQUESTS_V0                                                              \
-  { "GET",    LOG,  LOGT_COMPS_V0,    "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOGT_COMPS_V0,    "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOGT_COMPS_V0,    "",  badVerbAllFour                         }, \
-  { "PUT",    LOG,  LOGTL_COMPS_V0,   "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOGTL_COMPS_V0,   "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOGTL_COMPS_V0,   "",  badVerbAllFour                         }, \
-  { "GET",    LOG,  LOG2T_COMPS_V0,   "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOG2T_COMPS_V0,   "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOG2T_COMPS_V0,   "",  badVerbAllFour                         }, \
-  { "PUT",    LOG,  LOG2TL_COMPS_V0,  "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOG2TL_COMPS_V0,  "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOG2TL_COMPS_V0,  "",  badVerbAllFour                         }
-
-#define LOG_REQUESTS_V1                                                              \
-  { "GET",    LOG,  LOGT_COMPS_V1,    "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOGT_COMPS_V1,    "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOGT_COMPS_V1,    "",  badVerbAllFour                         }, \
-  { "PUT",    LOG,  LOGTL_COMPS_V1,   "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOGTL_COMPS_V1,   "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOGTL_COMPS_V1,   "",  badVerbAllFour                         }, \
-  { "GET",    LOG,  LOG2T_COMPS_V1,   "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOG2T_COMPS_V1,   "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOG2T_COMPS_V1,   "",  badVerbAllFour                         }, \
-  { "PUT",    LOG,  LOG2TL_COMPS_V1,  "",  logTraceTreat                          }, \
-  { "DELETE", LOG,  LOG2TL_COMPS_V1,  "",  logTraceTreat                          }, \
-  { "*",      LOG,  LOG2TL_COMPS_V1,  "",  badVerbAllFour                         }
-
-#define STAT_REQUESTS_V0                                                             \
-  { "GET",    STAT, STAT_COMPS_V0,    "",  statisticsTreat                        }, \
-  { "DELETE", STAT, STAT_COMPS_V0,    "",  statisticsTreat                        }, \
-  { "*",      STAT, STAT_COMPS_V0,    "",  badVerbGetDeleteOnly                   }
-
-#define STAT_REQUESTS_V1                                                             \
-  { "GET",    STAT, STAT_COMPS_V1,    "",  statisticsTreat                        }, \
-  { "DELETE", STAT, STAT_COMPS_V1,    "",  statisticsTreat                        }, \
-  { "*",      STAT, STAT_COMPS_V1,    "",  badVerbGetDeleteOnly                   }
-
-#define VERSION_REQUESTS                                                             \
-  { "GET",    VERS, VERS_COMPS,    "",  versionTreat                              }, \
-  { "*",      VERS, VERS_COMPS,    "",  badVerbGetOnly                            }
-
-#define EXIT_REQUESTS                                                                \
-  { "GET",    EXIT, EXIT2_COMPS,   "",  exitTreat                                 }, \
-  { "GET",    EXIT, EXIT1_COMPS,   "",  exitTreat                                 }
-
-#define LEAK_REQUESTS                                                                \
-  { "GET",    LEAK, LEAK2_COMPS,   "",  leakTreat                                 }, \
-  { "GET",    LEAK, LEAK1_COMPS,   "",  leakTreat                                 }
-
-#define INVALID_REQUESTS                             \
-  { "*", INV, INV9_COMPS,    "", badNgsi9Request  }, \
-  { "*", INV, INV10_COMPS,   "", badNgsi10Request }, \
-  { "*", INV, INV_ALL_COMPS, "", badRequest       }
-
-
-
-/* ****************************************************************************
-*
-* END_REQUEST - End marker for the array
-*/
-#define END_REQUEST  { "", INV,  0, {}, "", NULL }
-
-
-
-/* ****************************************************************************
-*
-* restServiceV - services for BROKER (ngsi9/10)
-*
-* This is the default service vector, that is used if the broker is started without the -ngsi9 option
-*/
-RestService restServiceV[] =
-{
-  API_V2,
-
-  REGISTRY_STANDARD_REQUESTS_V0,
-  REGISTRY_STANDARD_REQUESTS_V1,
-  STANDARD_REQUESTS_V0,
-  STANDARD_REQUESTS_V1,
-
-  REGISTRY_CONVENIENCE_OPERATIONS_V0,
-  REGISTRY_CONVENIENCE_OPERATIONS_V1,
-  CONVENIENCE_OPERATIONS_V0,
-  CONVENIENCE_OPERATIONS_V1,
-  LOG_REQUESTS_V0,
-  LOG_REQUESTS_V1,
-  STAT_REQUESTS_V0,
-  STAT_REQUESTS_V1,
-  VERSION_REQUESTS,
-
-#ifdef DEBUG
-  EXIT_REQUESTS,
-  LEAK_REQUESTS,
-#endif
-
-  INVALID_REQUESTS,
-  END_REQUEST
-};
-
-
-
-/* ****************************************************************************
-*
-* restServiceNgsi9 - services for CONF MAN
-*
-* This service vector (configuration) is used if the broker is started as
-* CONFIGURATION MANAGER (using the -ngsi9 option) and without using the
-* -multiservice option.
-*/
-RestService restServiceNgsi9[] =
-{
-  REGISTRY_STANDARD_REQUESTS_V0,   // FIXME P10:  NCAR is added here, is that OK?
-  REGISTRY_STANDARD_REQUESTS_V1,
-  REGISTRY_CONVENIENCE_OPERATIONS_V0,
-  REGISTRY_CONVENIENCE_OPERATIONS_V1,
-  LOG_REQUESTS_V0,
-  LOG_REQUESTS_V1,
-  STAT_REQUESTS_V0,
-  STAT_REQUESTS_V1,
-  VERSION_REQUESTS,
-
-#ifdef DEBUG
-  EXIT_REQUESTS,
-  LEAK_REQUESTS,
-#endif
-
-  INVALID_REQUESTS,
-  END_REQUEST
-};
-
-
-
 /* ****************************************************************************
 *
 * pidFile -
@@ -1148,6 +422,8 @@ void orionExit(int code, const std::string& reason)
 */
 void exitFunc(void)
 {
+  subCountersShutdown();
+
   curl_context_cleanup();
   curl_global_cleanup();
 
@@ -1184,10 +460,39 @@ static void contextBrokerInit(bool ngsi9Only, std::string dbPrefix, bool multite
   /* Set notifier object (singleton) */
   setNotifier(new Notifier());
 
+  /* Start the notification sender threads (unless one thread per notification is used) */
+  QueueOverflow overflow;
+
+  if (queueOverflowGet(notificationQueueOverflow, &overflow) == false)
+  {
+    LM_X(1, ("Fatal Error (bad value for '-notificationQueueOverflow': '%s')", notificationQueueOverflow));
+  }
+
+  if (notificationAsync > 0)
+  {
+    /* Notifications sent by the curl_multi event loop, no sender threads needed */
+    if (httpRequestAsyncInit(notificationAsync, notificationQueueSize, overflow, httpPoolIdleTimeout) != 0)
+    {
+      LM_X(1, ("Fatal Error (error starting asynchronous notifications)"));
+    }
+  }
+  else if (senderThreadPoolInit(notificationWorkers, notificationQueueSize, overflow) != 0)
+  {
+    LM_X(1, ("Fatal Error (error starting notification sender threads)"));
+  }
+
   /* Launch threads corresponding to ONTIMEINTERVAL subscriptions in the database (unless ngsi9 only mode) */
+  /* and load the ONCHANGE subscriptions in the subscription cache and the entity types cache (if in use) */
+  subCacheInit(subCache && !ngsi9Only);
+  typesCacheInit(typesCache && !ngsi9Only);
+  subCountersInit(ngsi9Only? 0 : subCounters);
+  setUpdateBatch(updateBatch);
+
   if (!ngsi9Only)
   {
     recoverOntimeIntervalThreads("");
+    subCacheLoad("");
+    typesCacheLoad("");
 
     if (multitenant)
     {
@@ -1199,6 +504,8 @@ static void contextBrokerInit(bool ngsi9Only, std::string dbPrefix, bool multite
         std::string orionDb = orionDbs[ix];
         std::string tenant = orionDb.substr(dbPrefix.length() + 1);   // + 1 for the "_" in "orion_tenantA"
         recoverOntimeIntervalThreads(tenant);
+        subCacheLoad(tenant);
+        typesCacheLoad(tenant);
       }
     }
   }
@@ -1207,6 +514,7 @@ static void contextBrokerInit(bool ngsi9Only, std::string dbPrefix, bool multite
     LM_I(("Running in NGSI9 only mode"));
   }
 
+  curl_context_pool_set(httpPoolSize, httpPoolIdleTimeout);
   httpRequestInit(httpTimeout);
 }
 
@@ -1226,12 +534,13 @@ static void mongoInit
   long         timeout,
   int          writeConcern,
   int          dbPoolSize,
+  int          dbPoolMin,
   bool         mutexTimeStat
 )
 {
   double tmo = timeout / 1000.0;  // milliseconds to float value in seconds
 
-  if (!mongoStart(dbHost, dbName.c_str(), rplSet, user, pwd, mtenant, tmo, writeConcern, dbPoolSize, mutexTimeStat))
+  if (!mongoStart(dbHost, dbName.c_str(), rplSet, user, pwd, mtenant, tmo, writeConcern, dbPoolSize, mutexTimeStat, dbPoolMin))
   {
     LM_X(1, ("Fatal Error (MongoDB error)"));
   }
@@ -1258,19 +567,23 @@ static void mongoInit
   // "If you call multiple ensureIndex() methods with the same index specification at the same time,
   // only the first operation will succeed, all other operations will have no effect."
   //
-  ensureLocationIndex("");
+  // Tenants created later get their indexes on their first write (see indexManager.h)
+  //
+  indexesEnsure("");
   if (mtenant)
   {
-    /* We get tenant database names and apply ensure the location index in each one */
+    /* We get tenant database names and ensure the indexes in each one */
     std::vector<std::string> orionDbs;
     getOrionDatabases(orionDbs);
     for (unsigned int ix = 0; ix < orionDbs.size(); ++ix)
     {
       std::string orionDb = orionDbs[ix];
       std::string tenant = orionDb.substr(dbName.length() + 1);   // + 1 for the "_" in "orion_tenantA"
-      ensureLocationIndex(tenant);
+      indexesEnsure(tenant);
     }
   }
+
+  setCountCacheTime(countCache);
 }
 
 
@@ -1382,6 +695,10 @@ static SemRequestType policyGet(std::string mutexPolicy)
   {
     return SemNoneOp;
   }
+  else if (mutexPolicy == "entity")
+  {
+    return SemEntityOp;
+  }
 
   //
   // Default is to protect both reads and writes
@@ -1486,6 +803,12 @@ int main(int argC, char* argV[])
     daemonize();
   }
 
+  /* After daemonize(), as the log writer thread wouldn't survive the fork */
+  if ((logAsync == true) && (lmAsyncStart() != LmsOk))
+  {
+    LM_X(1, ("Fatal Error (error starting the log writer thread)"));
+  }
+
 #if 0
   //
   // This 'almost always outdeffed' piece of code is used whenever a change is done to the
@@ -1513,7 +836,7 @@ int main(int argC, char* argV[])
   pidFile();
   SemRequestType policy = policyGet(reqMutexPolicy);
   orionInit(orionExit, ORION_VERSION, policy, mutexTimeStat);
-  mongoInit(dbHost, rplSet, dbName, user, pwd, dbTimeout, writeConcern, dbPoolSize, mutexTimeStat);
+  mongoInit(dbHost, rplSet, dbName, user, pwd, dbTimeout, writeConcern, dbPoolSize, dbPoolMin, mutexTimeStat);
   contextBrokerInit(ngsi9Only, dbName, mtenant);
   curl_global_init(CURL_GLOBAL_NOTHING);
 
@@ -1523,6 +846,11 @@ int main(int argC, char* argV[])
     LM_T(LmtRush, ("rush host: '%s', rush port: %d", rushHost.c_str(), rushPort));
   }
 
+  if (restHttpModeSet(httpMode, httpThreads) == false)
+  {
+    LM_X(1, ("Fatal Error (unsupported value for '-httpMode': '%s')", httpMode));
+  }
+
   if (https)
   {
     char* httpsPrivateServerKey = (char*) malloc(2048);
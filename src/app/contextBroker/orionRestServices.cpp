@@ -0,0 +1,837 @@
+/*
+*
+* Copyright 2013 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include "rest/RestService.h"
+
+#include "serviceRoutines/logTraceTreat.h"
+
+#include "serviceRoutines/getEntityTypes.h"
+#include "serviceRoutines/getAttributesForEntityType.h"
+#include "serviceRoutines/getAllContextEntities.h"
+
+#include "serviceRoutines/versionTreat.h"
+#include "serviceRoutines/statisticsTreat.h"
+#include "serviceRoutines/metricsTreat.h"
+#include "serviceRoutines/indexesTreat.h"
+#include "serviceRoutines/exitTreat.h"
+#include "serviceRoutines/leakTreat.h"
+
+#include "serviceRoutines/postDiscoverContextAvailability.h"
+#include "serviceRoutines/postQueryContext.h"
+#include "serviceRoutines/postRegisterContext.h"
+#include "serviceRoutines/postSubscribeContext.h"
+#include "serviceRoutines/postSubscribeContextAvailability.h"
+#include "serviceRoutines/postUnsubscribeContextAvailability.h"
+#include "serviceRoutines/postUpdateContext.h"
+#include "serviceRoutines/postUpdateContextAvailabilitySubscription.h"
+#include "serviceRoutines/postUpdateContextSubscription.h"
+#include "serviceRoutines/postUnsubscribeContext.h"
+#include "serviceRoutines/postNotifyContext.h"
+#include "serviceRoutines/postNotifyContextAvailability.h"
+
+#include "serviceRoutines/postSubscribeContextConvOp.h"
+#include "serviceRoutines/postSubscribeContextAvailabilityConvOp.h"
+#include "serviceRoutines/getContextEntitiesByEntityId.h"
+#include "serviceRoutines/postContextEntitiesByEntityId.h"
+#include "serviceRoutines/getContextEntityAttributes.h"
+#include "serviceRoutines/postContextEntityAttributes.h"
+#include "serviceRoutines/getEntityByIdAttributeByName.h"
+#include "serviceRoutines/postEntityByIdAttributeByName.h"
+#include "serviceRoutines/getContextEntityTypes.h"
+#include "serviceRoutines/postContextEntityTypes.h"
+#include "serviceRoutines/getContextEntityTypeAttribute.h"
+#include "serviceRoutines/postContextEntityTypeAttribute.h"
+#include "serviceRoutines/putAvailabilitySubscriptionConvOp.h"
+#include "serviceRoutines/deleteAvailabilitySubscriptionConvOp.h"
+
+#include "serviceRoutines/getIndividualContextEntity.h"
+#include "serviceRoutines/putIndividualContextEntity.h"
+#include "serviceRoutines/badVerbPostOnly.h"
+#include "serviceRoutines/badVerbPutDeleteOnly.h"
+#include "serviceRoutines/badVerbGetPostOnly.h"
+#include "serviceRoutines/postIndividualContextEntity.h"
+#include "serviceRoutines/deleteIndividualContextEntity.h"
+#include "serviceRoutines/badVerbAllFour.h"
+#include "serviceRoutines/putIndividualContextEntityAttribute.h"
+#include "serviceRoutines/getIndividualContextEntityAttribute.h"
+#include "serviceRoutines/getNgsi10ContextEntityTypes.h"
+#include "serviceRoutines/getNgsi10ContextEntityTypesAttribute.h"
+#include "serviceRoutines/postIndividualContextEntityAttribute.h"
+#include "serviceRoutines/deleteIndividualContextEntityAttribute.h"
+#include "serviceRoutines/putSubscriptionConvOp.h"
+#include "serviceRoutines/deleteSubscriptionConvOp.h"
+#include "serviceRoutines/getAttributeValueInstance.h"
+#include "serviceRoutines/putAttributeValueInstance.h"
+#include "serviceRoutines/deleteAttributeValueInstance.h"
+#include "serviceRoutines/getAllEntitiesWithTypeAndId.h"
+#include "serviceRoutines/postAllEntitiesWithTypeAndId.h"
+#include "serviceRoutines/putAllEntitiesWithTypeAndId.h"
+#include "serviceRoutines/deleteAllEntitiesWithTypeAndId.h"
+#include "serviceRoutines/getIndividualContextEntityAttributeWithTypeAndId.h"
+#include "serviceRoutines/postIndividualContextEntityAttributeWithTypeAndId.h"
+#include "serviceRoutines/putIndividualContextEntityAttributeWithTypeAndId.h"
+#include "serviceRoutines/deleteIndividualContextEntityAttributeWithTypeAndId.h"
+#include "serviceRoutines/getAttributeValueInstanceWithTypeAndId.h"
+#include "serviceRoutines/deleteAttributeValueInstanceWithTypeAndId.h"
+#include "serviceRoutines/postAttributeValueInstanceWithTypeAndId.h"
+#include "serviceRoutines/putAttributeValueInstanceWithTypeAndId.h"
+#include "serviceRoutines/getContextEntitiesByEntityIdAndType.h"
+#include "serviceRoutines/postContextEntitiesByEntityIdAndType.h"
+#include "serviceRoutines/getEntityByIdAttributeByNameWithTypeAndId.h"
+#include "serviceRoutines/postEntityByIdAttributeByNameWithTypeAndId.h"
+
+#include "serviceRoutines/badVerbGetPutDeleteOnly.h"
+#include "serviceRoutines/badVerbGetPostDeleteOnly.h"
+#include "serviceRoutines/badVerbGetOnly.h"
+#include "serviceRoutines/badVerbGetDeleteOnly.h"
+#include "serviceRoutines/badNgsi9Request.h"
+#include "serviceRoutines/badNgsi10Request.h"
+#include "serviceRoutines/badRequest.h"
+
+#include "serviceRoutinesV2/getEntities.h"
+#include "serviceRoutinesV2/entryPointsTreat.h"
+#include "serviceRoutinesV2/getEntity.h"
+#include "serviceRoutinesV2/getEntityAttribute.h"
+#include "serviceRoutinesV2/postEntities.h"
+
+#include "contextBroker/orionRestServices.h"
+
+
+
+/* ****************************************************************************
+*
+* restService* - vectors of REST services for the context broker
+*
+* This vector matches an incoming REST service, using the path of the URL, to a function
+* to treat the incoming request.
+*
+* The URL path is divided into components (Using '/' as field separator) so that the URL
+* "/ngsi9/registerContext" becomes a component vector of the two components
+* "ngsi9" and "registerContext".
+*
+* Each line contains the necessary information for ONE service:
+*   std::string   verb        - GET/POST/PUT/DELETE
+*   RequestType   request     - The type of the request
+*   int           components  - Number of components in the following URL component vector
+*   std::string   compV       - Component vector of the URL
+*   std::string   payloadWord - first word in the payload for the request (to verify that the payload matches the URL). If empty, no check is performed)
+*   RestTreat     treat       - Function pointer to the function to treat the incoming REST request
+*
+*/
+
+
+//
+// /v2 API
+//
+
+#define EPS                EntryPointsRequest
+#define EPS_COMPS_V2       1, { "v2"             }
+
+#define ENT                EntitiesRequest
+#define ENT_COMPS_V2       2, { "v2", "entities" }
+#define ENT_COMPS_WORD     ""
+
+
+#define IENT                EntityRequest
+#define IENT_COMPS_V2       3, { "v2", "entities", "*" }
+#define IENT_COMPS_WORD     ""
+
+#define IENTATTR                EntityAttributeRequest
+#define IENTATTR_COMPS_V2       5, { "v2", "entities", "*", "attrs", "*" }
+#define IENTATTR_COMPS_WORD     ""
+
+
+
+//
+// NGSI9
+//
+#define RCR                RegisterContext
+#define DCAR               DiscoverContextAvailability
+#define SCAR               SubscribeContextAvailability
+#define UCAR               UnsubscribeContextAvailability
+#define UCAS               UpdateContextAvailabilitySubscription
+#define NCAR               NotifyContextAvailability
+
+#define RCR_COMPS_V0       2, { "ngsi9",          "registerContext" }
+#define RCR_COMPS_V1       3, { "v1", "registry", "registerContext" }
+#define RCR_POST_WORD      "registerContextRequest"
+
+#define DCAR_COMPS_V0      2, { "ngsi9",          "discoverContextAvailability" }
+#define DCAR_COMPS_V1      3, { "v1", "registry", "discoverContextAvailability" }
+#define DCAR_POST_WORD     "discoverContextAvailabilityRequest"
+
+#define SCAR_COMPS_V0      2, { "ngsi9",          "subscribeContextAvailability" }
+#define SCAR_COMPS_V1      3, { "v1", "registry", "subscribeContextAvailability" }
+#define SCAR_POST_WORD     "subscribeContextAvailabilityRequest"
+
+#define UCAR_COMPS_V0      2, { "ngsi9",          "unsubscribeContextAvailability" }
+#define UCAR_COMPS_V1      3, { "v1", "registry", "unsubscribeContextAvailability" }
+#define UCAR_POST_WORD     "unsubscribeContextAvailabilityRequest"
+
+#define UCAS_COMPS_V0      2, { "ngsi9",          "updateContextAvailabilitySubscription" }
+#define UCAS_COMPS_V1      3, { "v1", "registry", "updateContextAvailabilitySubscription" }
+#define UCAS_POST_WORD     "updateContextAvailabilitySubscriptionRequest"
+
+#define NCAR_COMPS_V0      2, { "ngsi9",          "notifyContextAvailability" }
+#define NCAR_COMPS_V1      3, { "v1", "registry", "notifyContextAvailability" }
+#define NCAR_POST_WORD     "notifyContextAvailabilityRequest"
+
+
+
+//
+// NGSI10
+//
+#define UPCR          UpdateContext
+#define QCR           QueryContext
+#define SCR           SubscribeContext
+#define UCSR          UpdateContextSubscription
+#define UNCR          UnsubscribeContext
+#define NCR           NotifyContext
+
+#define UPCR_COMPS_V0       2, { "ngsi10",  "updateContext" }
+#define UPCR_COMPS_V1       2, { "v1",      "updateContext" }
+#define UPCR_POST_WORD     "updateContextRequest"
+
+#define QCR_COMPS_V0        2, { "ngsi10",  "queryContext" }
+#define QCR_COMPS_V1        2, { "v1",      "queryContext" }
+#define QCR_POST_WORD      "queryContextRequest"
+
+#define SCR_COMPS_V0        2, { "ngsi10",  "subscribeContext" }
+#define SCR_COMPS_V1        2, { "v1",      "subscribeContext" }
+#define SCR_POST_WORD      "subscribeContextRequest"
+
+#define UCSR_COMPS_V0       2, { "ngsi10",  "updateContextSubscription" }
+#define UCSR_COMPS_V1       2, { "v1",      "updateContextSubscription" }
+#define UCSR_POST_WORD     "updateContextSubscriptionRequest"
+
+#define UNCR_COMPS_V0       2, { "ngsi10",  "unsubscribeContext" }
+#define UNCR_COMPS_V1       2, { "v1",      "unsubscribeContext" }
+#define UNCR_POST_WORD     "unsubscribeContextRequest"
+
+#define NCR_COMPS_V0        2, { "ngsi10",  "notifyContext" }
+#define NCR_COMPS_V1        2, { "v1",      "notifyContext" }
+#define NCR_POST_WORD      "notifyContextRequest"
+
+
+//
+// NGSI9 Convenience Operations
+//
+#define CE                 ContextEntitiesByEntityId
+#define CE_COMPS_V0        3, { "ngsi9",          "contextEntities", "*" }
+#define CE_COMPS_V1        4, { "v1", "registry", "contextEntities", "*" }
+#define CE_POST_WORD       "registerProviderRequest"
+
+#define CEA                ContextEntityAttributes
+#define CEA_COMPS_V0       4, { "ngsi9",          "contextEntities", "*", "attributes" }
+#define CEA_COMPS_V1       5, { "v1", "registry", "contextEntities", "*", "attributes" }
+#define CEA_POST_WORD      "registerProviderRequest"
+
+#define CEAA               EntityByIdAttributeByName
+#define CEAA_COMPS_V0      5, { "ngsi9",          "contextEntities", "*", "attributes", "*" }
+#define CEAA_COMPS_V1      6, { "v1", "registry", "contextEntities", "*", "attributes", "*" }
+#define CEAA_POST_WORD     "registerProviderRequest"
+
+#define CT                 ContextEntityTypes
+#define CT_COMPS_V0        3, { "ngsi9",          "contextEntityTypes", "*" }
+#define CT_COMPS_V1        4, { "v1", "registry", "contextEntityTypes", "*" }
+#define CT_POST_WORD       "registerProviderRequest"
+
+#define CTA                ContextEntityTypeAttributeContainer
+#define CTA_COMPS_V0       4, { "ngsi9",          "contextEntityTypes", "*", "attributes" }
+#define CTA_COMPS_V1       5, { "v1", "registry", "contextEntityTypes", "*", "attributes" }
+#define CTA_POST_WORD      "registerProviderRequest"
+
+#define CTAA               ContextEntityTypeAttribute
+#define CTAA_COMPS_V0      5, { "ngsi9",          "contextEntityTypes", "*", "attributes", "*" }
+#define CTAA_COMPS_V1      6, { "v1", "registry", "contextEntityTypes", "*", "attributes", "*" }
+#define CTAA_POST_WORD     "registerProviderRequest"
+
+#define SCA                SubscribeContextAvailability
+#define SCA_COMPS_V0       2, { "ngsi9",          "contextAvailabilitySubscriptions" }
+#define SCA_COMPS_V1       3, { "v1", "registry", "contextAvailabilitySubscriptions" }
+#define SCA_POST_WORD      "subscribeContextAvailabilityRequest"
+
+#define SCAS               Ngsi9SubscriptionsConvOp
+#define SCAS_COMPS_V0      3, { "ngsi9",          "contextAvailabilitySubscriptions", "*" }
+#define SCAS_COMPS_V1      4, { "v1", "registry", "contextAvailabilitySubscriptions", "*" }
+#define SCAS_PUT_WORD      "updateContextAvailabilitySubscriptionRequest"
+
+
+
+//
+// NGSI10 Convenience Operations
+//
+#define ICE                IndividualContextEntity
+#define ICE_COMPS_V0       3, { "ngsi10",  "contextEntities", "*" }
+#define ICE_COMPS_V1       3, { "v1",      "contextEntities", "*" }
+#define ICE_POST_WORD      "appendContextElementRequest"
+#define ICE_PUT_WORD       "updateContextElementRequest"
+
+#define ICEA               IndividualContextEntityAttributes
+#define ICEA_COMPS_V0      4, { "ngsi10",  "contextEntities", "*", "attributes" }
+#define ICEA_COMPS_V1      4, { "v1",      "contextEntities", "*", "attributes" }
+#define ICEA_POST_WORD     "appendContextElementRequest"
+#define ICEA_PUT_WORD      "updateContextElementRequest"
+
+#define ICEAA              IndividualContextEntityAttribute
+#define ICEAA_COMPS_V0     5, { "ngsi10",  "contextEntities", "*", "attributes", "*" }
+#define ICEAA_COMPS_V1     5, { "v1",      "contextEntities", "*", "attributes", "*" }
+// FIXME P10: funny having updateContextAttributeRequest for both ... Error in NEC-SPEC?
+#define ICEAA_POST_WORD    "updateContextAttributeRequest"
+#define ICEAA_PUT_WORD     "updateContextAttributeRequest"
+
+#define AVI                AttributeValueInstance
+#define AVI_COMPS_V0       6, { "ngsi10",  "contextEntities", "*", "attributes", "*", "*" }
+#define AVI_COMPS_V1       6, { "v1",      "contextEntities", "*", "attributes", "*", "*" }
+#define AVI_PUT_WORD       "updateContextAttributeRequest"
+
+#define CET                Ngsi10ContextEntityTypes
+#define CET_COMPS_V0       3, { "ngsi10",  "contextEntityTypes", "*" }
+#define CET_COMPS_V1       3, { "v1",      "contextEntityTypes", "*" }
+
+#define CETA               Ngsi10ContextEntityTypesAttributeContainer
+#define CETA_COMPS_V0      4, { "ngsi10",  "contextEntityTypes", "*", "attributes" }
+#define CETA_COMPS_V1      4, { "v1",      "contextEntityTypes", "*", "attributes" }
+
+#define CETAA              Ngsi10ContextEntityTypesAttribute
+#define CETAA_COMPS_V0     5, { "ngsi10",  "contextEntityTypes", "*", "attributes", "*" }
+#define CETAA_COMPS_V1     5, { "v1",      "contextEntityTypes", "*", "attributes", "*" }
+
+#define SC                 SubscribeContext
+#define SC_COMPS_V0        2, { "ngsi10",  "contextSubscriptions" }
+#define SC_COMPS_V1        2, { "v1",      "contextSubscriptions" }
+#define SC_POST_WORD       "subscribeContextRequest"
+
+#define SCS                Ngsi10SubscriptionsConvOp
+#define SCS_COMPS_V0       3, { "ngsi10",  "contextSubscriptions", "*" }
+#define SCS_COMPS_V1       3, { "v1",      "contextSubscriptions", "*" }
+#define SCS_PUT_WORD       "updateContextSubscriptionRequest"
+
+
+
+//
+// TID Convenience Operations
+//
+#define ET                 EntityTypes
+#define ET_COMPS_V1        2, { "v1", "contextTypes" }
+
+#define AFET               AttributesForEntityType
+#define AFET_COMPS_V1      3, { "v1", "contextTypes", "*" }
+
+#define ACE                AllContextEntities
+#define ACE_COMPS_V1       2, { "v1", "contextEntities" }
+#define ACE_POST_WORD     "appendContextElementRequest"
+
+#define ACET               AllEntitiesWithTypeAndId
+#define ACET_COMPS_V1      6, { "v1", "contextEntities", "type", "*", "id", "*" }
+#define ACET_POST_WORD     "appendContextElementRequest"
+#define ACET_PUT_WORD      "updateContextElementRequest"
+
+#define ICEAAT              IndividualContextEntityAttributeWithTypeAndId
+#define ICEAAT_COMPS_V1     8, { "v1", "contextEntities", "type", "*", "id", "*", "attributes", "*" }
+#define ICEAAT_POST_WORD    "updateContextAttributeRequest"
+#define ICEAAT_PUT_WORD     "updateContextAttributeRequest"
+
+#define AVIT                AttributeValueInstanceWithTypeAndId
+#define AVIT_COMPS_V1       9, { "v1",      "contextEntities", "type", "*", "id", "*", "attributes", "*", "*" }
+#define AVIT_PUT_WORD       "updateContextAttributeRequest"
+#define AVIT_POST_WORD      "updateContextAttributeRequest"
+
+#define CEET                ContextEntitiesByEntityIdAndType
+#define CEET_COMPS_V1       7, { "v1", "registry", "contextEntities", "type", "*", "id", "*" }
+#define CEET_POST_WORD      "registerProviderRequest"
+
+#define CEAAT               EntityByIdAttributeByNameIdAndType
+#define CEAAT_COMPS_V1      9, { "v1", "registry", "contextEntities", "type", "*", "id", "*", "attributes", "*" }
+#define CEAAT_POST_WORD     "registerProviderRequest"
+
+
+
+//
+// Log, version, statistics ...
+//
+#define LOG                LogRequest
+#define LOGT_COMPS_V0      2, { "log", "trace"                           }
+#define LOGTL_COMPS_V0     3, { "log", "trace",      "*"                 }
+#define LOG2T_COMPS_V0     2, { "log", "traceLevel"                      }
+#define LOG2TL_COMPS_V0    3, { "log", "traceLevel", "*"                 }
+#define LOGT_COMPS_V1      4, { "v1", "admin", "log", "trace"            }
+#define LOGTL_COMPS_V1     5, { "v1", "admin", "log", "trace",      "*"  }
+#define LOG2T_COMPS_V1     4, { "v1", "admin", "log", "traceLevel"       }
+#define LOG2TL_COMPS_V1    5, { "v1", "admin", "log", "traceLevel", "*"  }
+
+#define STAT               StatisticsRequest
+#define STAT_COMPS_V0      1, { "statistics"                             }
+#define STAT_COMPS_V1      3, { "v1", "admin", "statistics"              }
+
+#define METR               MetricsRequest
+#define METR_COMPS_V0      1, { "metrics"                                }
+#define METR_COMPS_V1      3, { "v1", "admin", "metrics"                 }
+
+#define INDX               IndexesRequest
+#define INDX_COMPS_V1      3, { "v1", "admin", "indexes"                 }
+
+
+
+//
+// Unversioned requests
+//
+#define VERS               VersionRequest
+#define VERS_COMPS         1, { "version"                                }
+
+#define EXIT               ExitRequest
+#define EXIT1_COMPS        1, { "exit"                                   }
+#define EXIT2_COMPS        2, { "exit", "*"                              }
+
+#define LEAK               LeakRequest
+#define LEAK1_COMPS        1, { "leak"                                   }
+#define LEAK2_COMPS        2, { "leak", "*"                              }
+
+#define INV                InvalidRequest
+#define INV9_COMPS         2, { "ngsi9",   "*"                           }
+#define INV10_COMPS        2, { "ngsi10",  "*"                           }
+#define INV_ALL_COMPS      0, { "*", "*", "*", "*", "*", "*"             }
+
+
+
+#define API_V2                                                                                     \
+  { "GET",    EPS,       EPS_COMPS_V2,         ENT_COMPS_WORD,       entryPointsTreat           }, \
+  { "*",      EPS,       EPS_COMPS_V2,         ENT_COMPS_WORD,       badVerbAllFour             }, \
+                                                                                                   \
+  { "GET",    ENT,       ENT_COMPS_V2,         ENT_COMPS_WORD,       getEntities                }, \
+  { "POST",   ENT,       ENT_COMPS_V2,         ENT_COMPS_WORD,       postEntities               }, \
+  { "*",      ENT,       ENT_COMPS_V2,         ENT_COMPS_WORD,       badVerbGetPostOnly         }, \
+                                                                                                   \
+  { "GET",    IENT,      IENT_COMPS_V2,        IENT_COMPS_WORD,      getEntity                  }, \
+  { "*",      IENT,      IENT_COMPS_V2,        IENT_COMPS_WORD,      badVerbGetOnly             }, \
+                                                                                                   \
+  { "GET",    IENTATTR,  IENTATTR_COMPS_V2,    IENTATTR_COMPS_WORD,  getEntityAttribute         }, \
+  { "*",      IENTATTR,  IENTATTR_COMPS_V2,    IENTATTR_COMPS_WORD,  badVerbGetOnly             }
+
+
+
+#define REGISTRY_STANDARD_REQUESTS_V0                                                                    \
+  { "POST",   RCR,   RCR_COMPS_V0,         RCR_POST_WORD,   postRegisterContext                       }, \
+  { "*",      RCR,   RCR_COMPS_V0,         RCR_POST_WORD,   badVerbPostOnly                           }, \
+  { "POST",   DCAR,  DCAR_COMPS_V0,        DCAR_POST_WORD,  postDiscoverContextAvailability           }, \
+  { "*",      DCAR,  DCAR_COMPS_V0,        DCAR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   SCAR,  SCAR_COMPS_V0,        SCAR_POST_WORD,  postSubscribeContextAvailability          }, \
+  { "*",      SCAR,  SCAR_COMPS_V0,        SCAR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   UCAR,  UCAR_COMPS_V0,        UCAR_POST_WORD,  postUnsubscribeContextAvailability        }, \
+  { "*",      UCAR,  UCAR_COMPS_V0,        UCAR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   UCAS,  UCAS_COMPS_V0,        UCAS_POST_WORD,  postUpdateContextAvailabilitySubscription }, \
+  { "*",      UCAS,  UCAS_COMPS_V0,        UCAS_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   NCAR,  NCAR_COMPS_V0,        NCAR_POST_WORD,  postNotifyContextAvailability             }, \
+  { "*",      NCAR,  NCAR_COMPS_V0,        NCAR_POST_WORD,  badVerbPostOnly                           }
+
+
+
+#define REGISTRY_STANDARD_REQUESTS_V1                                                                      \
+  { "POST",   RCR,   RCR_COMPS_V1,           RCR_POST_WORD,   postRegisterContext                       }, \
+  { "*",      RCR,   RCR_COMPS_V1,           RCR_POST_WORD,   badVerbPostOnly                           }, \
+  { "POST",   DCAR,  DCAR_COMPS_V1,          DCAR_POST_WORD,  postDiscoverContextAvailability           }, \
+  { "*",      DCAR,  DCAR_COMPS_V1,          DCAR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   SCAR,  SCAR_COMPS_V1,          SCAR_POST_WORD,  postSubscribeContextAvailability          }, \
+  { "*",      SCAR,  SCAR_COMPS_V1,          SCAR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   UCAR,  UCAR_COMPS_V1,          UCAR_POST_WORD,  postUnsubscribeContextAvailability        }, \
+  { "*",      UCAR,  UCAR_COMPS_V1,          UCAR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   UCAS,  UCAS_COMPS_V1,          UCAS_POST_WORD,  postUpdateContextAvailabilitySubscription }, \
+  { "*",      UCAS,  UCAS_COMPS_V1,          UCAS_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   NCAR,  NCAR_COMPS_V1,          NCAR_POST_WORD,  postNotifyContextAvailability             }, \
+  { "*",      NCAR,  NCAR_COMPS_V1,          NCAR_POST_WORD,  badVerbPostOnly                           }
+
+
+
+#define STANDARD_REQUESTS_V0                                                                             \
+  { "POST",   UPCR,  UPCR_COMPS_V0,        UPCR_POST_WORD,  postUpdateContext                         }, \
+  { "*",      UPCR,  UPCR_COMPS_V0,        UPCR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   QCR,   QCR_COMPS_V0,         QCR_POST_WORD,   postQueryContext                          }, \
+  { "*",      QCR,   QCR_COMPS_V0,         QCR_POST_WORD,   badVerbPostOnly                           }, \
+  { "POST",   SCR,   SCR_COMPS_V0,         SCR_POST_WORD,   postSubscribeContext                      }, \
+  { "*",      SCR,   SCR_COMPS_V0,         SCR_POST_WORD,   badVerbPostOnly                           }, \
+  { "POST",   UCSR,  UCSR_COMPS_V0,        UCSR_POST_WORD,  postUpdateContextSubscription             }, \
+  { "*",      UCSR,  UCSR_COMPS_V0,        UCSR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   UNCR,  UNCR_COMPS_V0,        UNCR_POST_WORD,  postUnsubscribeContext                    }, \
+  { "*",      UNCR,  UNCR_COMPS_V0,        UNCR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   NCR,   NCR_COMPS_V0,         NCR_POST_WORD,   postNotifyContext                         }, \
+  { "*",      NCR,   NCR_COMPS_V0,         NCR_POST_WORD,   badVerbPostOnly                           }
+
+
+
+#define STANDARD_REQUESTS_V1                                                                               \
+  { "POST",   UPCR,  UPCR_COMPS_V1,          UPCR_POST_WORD,  postUpdateContext                         }, \
+  { "*",      UPCR,  UPCR_COMPS_V1,          UPCR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   QCR,   QCR_COMPS_V1,           QCR_POST_WORD,   postQueryContext                          }, \
+  { "*",      QCR,   QCR_COMPS_V1,           QCR_POST_WORD,   badVerbPostOnly                           }, \
+  { "POST",   SCR,   SCR_COMPS_V1,           SCR_POST_WORD,   postSubscribeContext                      }, \
+  { "*",      SCR,   SCR_COMPS_V1,           SCR_POST_WORD,   badVerbPostOnly                           }, \
+  { "POST",   UCSR,  UCSR_COMPS_V1,          UCSR_POST_WORD,  postUpdateContextSubscription             }, \
+  { "*",      UCSR,  UCSR_COMPS_V1,          UCSR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   UNCR,  UNCR_COMPS_V1,          UNCR_POST_WORD,  postUnsubscribeContext                    }, \
+  { "*",      UNCR,  UNCR_COMPS_V1,          UNCR_POST_WORD,  badVerbPostOnly                           }, \
+  { "POST",   NCR,   NCR_COMPS_V1,           NCR_POST_WORD,   postNotifyContext                         }, \
+  { "*",      NCR,   NCR_COMPS_V1,           NCR_POST_WORD,   badVerbPostOnly                           }
+
+
+
+#define REGISTRY_CONVENIENCE_OPERATIONS_V0                                                               \
+  { "GET",    CE,    CE_COMPS_V0,          "",              getContextEntitiesByEntityId              }, \
+  { "POST",   CE,    CE_COMPS_V0,          CE_POST_WORD,    postContextEntitiesByEntityId             }, \
+  { "*",      CE,    CE_COMPS_V0,          "",              badVerbGetPostOnly                        }, \
+                                                                                                         \
+  { "GET",    CEA,   CEA_COMPS_V0,         "",              getContextEntityAttributes                }, \
+  { "POST",   CEA,   CEA_COMPS_V0,         CEA_POST_WORD,   postContextEntityAttributes               }, \
+  { "*",      CEA,   CEA_COMPS_V0,         "",              badVerbGetPostOnly                        }, \
+                                                                                                         \
+  { "GET",    CEAA,  CEAA_COMPS_V0,        "",              getEntityByIdAttributeByName              }, \
+  { "POST",   CEAA,  CEAA_COMPS_V0,        CEAA_POST_WORD,  postEntityByIdAttributeByName             }, \
+  { "*",      CEAA,  CEAA_COMPS_V0,        "",              badVerbGetPostOnly                        }, \
+                                                                                                         \
+  { "GET",    CT,    CT_COMPS_V0,          "",              getContextEntityTypes                     }, \
+  { "POST",   CT,    CT_COMPS_V0,          CT_POST_WORD,    postContextEntityTypes                    }, \
+  { "*",      CT,    CT_COMPS_V0,          "",              badVerbGetPostOnly                        }, \
+                                                                                                         \
+  { "GET",    CTA,   CTA_COMPS_V0,         "",              getContextEntityTypes                     }, \
+  { "POST",   CTA,   CTA_COMPS_V0,         CTA_POST_WORD,   postContextEntityTypes                    }, \
+  { "*",      CTA,   CTA_COMPS_V0,         "",              badVerbGetPostOnly                        }, \
+                                                                                                         \
+  { "GET",    CTAA,  CTAA_COMPS_V0,        "",              getContextEntityTypeAttribute             }, \
+  { "POST",   CTAA,  CTAA_COMPS_V0,        CTAA_POST_WORD,  postContextEntityTypeAttribute            }, \
+  { "*",      CTAA,  CTAA_COMPS_V0,        "",              badVerbGetPostOnly                        }, \
+                                                                                                         \
+  { "POST",   SCA,   SCA_COMPS_V0,         SCA_POST_WORD,   postSubscribeContextAvailabilityConvOp    }, \
+  { "*",      SCA,   SCA_COMPS_V0,         "",              badVerbPostOnly                           }, \
+                                                                                                         \
+  { "PUT",    SCAS,  SCAS_COMPS_V0,        SCAS_PUT_WORD,   putAvailabilitySubscriptionConvOp         }, \
+  { "DELETE", SCAS,  SCAS_COMPS_V0,        "",              deleteAvailabilitySubscriptionConvOp      }, \
+  { "*",      SCAS,  SCAS_COMPS_V0,        "",              badVerbPutDeleteOnly                      }
+
+
+
+#define REGISTRY_CONVENIENCE_OPERATIONS_V1                                                                 \
+  { "GET",    CE,    CE_COMPS_V1,            "",              getContextEntitiesByEntityId              }, \
+  { "POST",   CE,    CE_COMPS_V1,            CE_POST_WORD,    postContextEntitiesByEntityId             }, \
+  { "*",      CE,    CE_COMPS_V1,            "",              badVerbGetPostOnly                        }, \
+                                                                                                           \
+  { "GET",    CEA,   CEA_COMPS_V1,           "",              getContextEntityAttributes                }, \
+  { "POST",   CEA,   CEA_COMPS_V1,           CEA_POST_WORD,   postContextEntityAttributes               }, \
+  { "*",      CEA,   CEA_COMPS_V1,           "",              badVerbGetPostOnly                        }, \
+                                                                                                           \
+  { "GET",    CEAA,  CEAA_COMPS_V1,          "",              getEntityByIdAttributeByName              }, \
+  { "POST",   CEAA,  CEAA_COMPS_V1,          CEAA_POST_WORD,  postEntityByIdAttributeByName             }, \
+  { "*",      CEAA,  CEAA_COMPS_V1,          "",              badVerbGetPostOnly                        }, \
+                                                                                                           \
+  { "GET",    CT,    CT_COMPS_V1,            "",              getContextEntityTypes                     }, \
+  { "POST",   CT,    CT_COMPS_V1,            CT_POST_WORD,    postContextEntityTypes                    }, \
+  { "*",      CT,    CT_COMPS_V1,            "",              badVerbGetPostOnly                        }, \
+                                                                                                           \
+  { "GET",    CTA,   CTA_COMPS_V1,           "",              getContextEntityTypes                     }, \
+  { "POST",   CTA,   CTA_COMPS_V1,           CTA_POST_WORD,   postContextEntityTypes                    }, \
+  { "*",      CTA,   CTA_COMPS_V1,           "",              badVerbGetPostOnly                        }, \
+                                                                                                           \
+  { "GET",    CTAA,  CTAA_COMPS_V1,          "",              getContextEntityTypeAttribute             }, \
+  { "POST",   CTAA,  CTAA_COMPS_V1,          CTAA_POST_WORD,  postContextEntityTypeAttribute            }, \
+  { "*",      CTAA,  CTAA_COMPS_V1,          "",              badVerbGetPostOnly                        }, \
+                                                                                                           \
+  { "POST",   SCA,   SCA_COMPS_V1,           SCA_POST_WORD,   postSubscribeContextAvailability          }, \
+  { "*",      SCA,   SCA_COMPS_V1,           "",              badVerbPostOnly                           }, \
+                                                                                                           \
+  { "PUT",    SCAS,  SCAS_COMPS_V1,          SCAS_PUT_WORD,   putAvailabilitySubscriptionConvOp         }, \
+  { "DELETE", SCAS,  SCAS_COMPS_V1,          "",              deleteAvailabilitySubscriptionConvOp      }, \
+  { "*",      SCAS,  SCAS_COMPS_V1,          "",              badVerbPutDeleteOnly                      }
+
+
+
+#define CONVENIENCE_OPERATIONS_V0                                                                        \
+  { "GET",    ICE,   ICE_COMPS_V0,         "",              getIndividualContextEntity                }, \
+  { "PUT",    ICE,   ICE_COMPS_V0,         ICE_PUT_WORD,    putIndividualContextEntity                }, \
+  { "POST",   ICE,   ICE_COMPS_V0,         ICE_POST_WORD,   postIndividualContextEntity               }, \
+  { "DELETE", ICE,   ICE_COMPS_V0,         "",              deleteIndividualContextEntity             }, \
+  { "*",      ICE,   ICE_COMPS_V0,         "",              badVerbAllFour                            }, \
+                                                                                                         \
+  { "GET",    ICEA,  ICEA_COMPS_V0,        "",              getIndividualContextEntity                }, \
+  { "PUT",    ICEA,  ICEA_COMPS_V0,        ICEA_PUT_WORD,   putIndividualContextEntity                }, \
+  { "POST",   ICEA,  ICEA_COMPS_V0,        ICEA_POST_WORD,  postIndividualContextEntity               }, \
+  { "DELETE", ICEA,  ICEA_COMPS_V0,        "",              deleteIndividualContextEntity             }, \
+  { "*",      ICEA,  ICEA_COMPS_V0,        "",              badVerbAllFour                            }, \
+                                                                                                         \
+  { "GET",    ICEAA, ICEAA_COMPS_V0,       "",              getIndividualContextEntityAttribute       }, \
+  { "PUT",    ICEAA, ICEAA_COMPS_V0,       ICEAA_PUT_WORD,  putIndividualContextEntityAttribute       }, \
+  { "POST",   ICEAA, ICEAA_COMPS_V0,       ICEAA_POST_WORD, postIndividualContextEntityAttribute      }, \
+  { "DELETE", ICEAA, ICEAA_COMPS_V0,       "",              deleteIndividualContextEntityAttribute    }, \
+  { "*",      ICEAA, ICEAA_COMPS_V0,       "",              badVerbGetPostDeleteOnly                  }, \
+                                                                                                         \
+  { "GET",    AVI,   AVI_COMPS_V0,         "",              getAttributeValueInstance                 }, \
+  { "PUT",    AVI,   AVI_COMPS_V0,         AVI_PUT_WORD,    putAttributeValueInstance                 }, \
+  { "DELETE", AVI,   AVI_COMPS_V0,         "",              deleteAttributeValueInstance              }, \
+  { "*",      AVI,   AVI_COMPS_V0,         "",              badVerbGetPutDeleteOnly                   }, \
+                                                                                                         \
+  { "GET",    CET,   CET_COMPS_V0,         "",              getNgsi10ContextEntityTypes               }, \
+  { "*",      CET,   CET_COMPS_V0,         "",              badVerbGetOnly                            }, \
+                                                                                                         \
+  { "GET",    CETA,  CETA_COMPS_V0,        "",              getNgsi10ContextEntityTypes               }, \
+  { "*",      CETA,  CETA_COMPS_V0,        "",              badVerbGetOnly                            }, \
+                                                                                                         \
+  { "GET",    CETAA, CETAA_COMPS_V0,       "",              getNgsi10ContextEntityTypesAttribute      }, \
+  { "*",      CETAA, CETAA_COMPS_V0,       "",              badVerbGetOnly                            }, \
+                                                                                                         \
+  { "POST",   SC,    SC_COMPS_V0,          SC_POST_WORD,    postSubscribeContextConvOp                }, \
+  { "*",      SC,    SC_COMPS_V0,          "",              badVerbPostOnly                           }, \
+                                                                                                         \
+  { "PUT",    SCS,   SCS_COMPS_V0,         SCS_PUT_WORD,    putSubscriptionConvOp                     }, \
+  { "DELETE", SCS,   SCS_COMPS_V0,         "",              deleteSubscriptionConvOp                  }, \
+  { "*",      SCS,   SCS_COMPS_V0,         "",              badVerbPutDeleteOnly                      }
+
+
+
+#define CONVENIENCE_OPERATIONS_V1                                                                          \
+  { "GET",    ICE,   ICE_COMPS_V1,           "",              getIndividualContextEntity                }, \
+  { "PUT",    ICE,   ICE_COMPS_V1,           ICE_PUT_WORD,    putIndividualContextEntity                }, \
+  { "POST",   ICE,   ICE_COMPS_V1,           ICE_POST_WORD,   postIndividualContextEntity               }, \
+  { "DELETE", ICE,   ICE_COMPS_V1,           "",              deleteIndividualContextEntity             }, \
+  { "*",      ICE,   ICE_COMPS_V1,           "",              badVerbAllFour                            }, \
+                                                                                                           \
+  { "GET",    ICEA,  ICEA_COMPS_V1,          "",              getIndividualContextEntity                }, \
+  { "PUT",    ICEA,  ICEA_COMPS_V1,          ICEA_PUT_WORD,   putIndividualContextEntity                }, \
+  { "POST",   ICEA,  ICEA_COMPS_V1,          ICEA_POST_WORD,  postIndividualContextEntity               }, \
+  { "DELETE", ICEA,  ICEA_COMPS_V1,          "",              deleteIndividualContextEntity             }, \
+  { "*",      ICEA,  ICEA_COMPS_V1,          "",              badVerbAllFour                            }, \
+                                                                                                           \
+  { "GET",    ICEAA, ICEAA_COMPS_V1,         "",              getIndividualContextEntityAttribute       }, \
+  { "PUT",    ICEAA, ICEAA_COMPS_V1,         ICEAA_PUT_WORD,  putIndividualContextEntityAttribute       }, \
+  { "POST",   ICEAA, ICEAA_COMPS_V1,         ICEAA_POST_WORD, postIndividualContextEntityAttribute      }, \
+  { "DELETE", ICEAA, ICEAA_COMPS_V1,         "",              deleteIndividualContextEntityAttribute    }, \
+  { "*",      ICEAA, ICEAA_COMPS_V1,         "",              badVerbGetPostDeleteOnly                  }, \
+                                                                                                           \
+  { "GET",    AVI,   AVI_COMPS_V1,           "",              getAttributeValueInstance                 }, \
+  { "PUT",    AVI,   AVI_COMPS_V1,           AVI_PUT_WORD,    putAttributeValueInstance                 }, \
+  { "DELETE", AVI,   AVI_COMPS_V1,           "",              deleteAttributeValueInstance              }, \
+  { "*",      AVI,   AVI_COMPS_V1,           "",              badVerbGetPutDeleteOnly                   }, \
+                                                                                                           \
+  { "GET",    CET,   CET_COMPS_V1,           "",              getNgsi10ContextEntityTypes               }, \
+  { "*",      CET,   CET_COMPS_V1,           "",              badVerbGetOnly                            }, \
+                                                                                                           \
+  { "GET",    CETA,  CETA_COMPS_V1,          "",              getNgsi10ContextEntityTypes               }, \
+  { "*",      CETA,  CETA_COMPS_V1,          "",              badVerbGetOnly                            }, \
+                                                                                                           \
+  { "GET",    CETAA, CETAA_COMPS_V1,         "",              getNgsi10ContextEntityTypesAttribute      }, \
+  { "*",      CETAA, CETAA_COMPS_V1,         "",              badVerbGetOnly                            }, \
+                                                                                                           \
+  { "POST",   SC,    SC_COMPS_V1,            SC_POST_WORD,    postSubscribeContextConvOp                }, \
+  { "*",      SC,    SC_COMPS_V1,            "",              badVerbPostOnly                           }, \
+                                                                                                           \
+  { "PUT",    SCS,   SCS_COMPS_V1,           SCS_PUT_WORD,    putSubscriptionConvOp                     }, \
+  { "DELETE", SCS,   SCS_COMPS_V1,           "",              deleteSubscriptionConvOp                  }, \
+  { "*",      SCS,   SCS_COMPS_V1,           "",              badVerbPutDeleteOnly                      }, \
+                                                                                                           \
+  { "GET",    ET,    ET_COMPS_V1,            "",              getEntityTypes                            }, \
+  { "*",      ET,    ET_COMPS_V1,            "",              badVerbGetOnly                            }, \
+  { "GET",    AFET,  AFET_COMPS_V1,          "",              getAttributesForEntityType                }, \
+  { "*",      AFET,  AFET_COMPS_V1,          "",              badVerbGetOnly                            }, \
+                                                                                                           \
+  { "GET",    ACE,   ACE_COMPS_V1,           "",              getAllContextEntities                     }, \
+  { "POST",   ACE,   ACE_COMPS_V1,           ACE_POST_WORD,   postIndividualContextEntity               }, \
+  { "*",      ACE,   ACE_COMPS_V1,           "",              badVerbGetOnly                            }, \
+                                                                                                           \
+  { "GET",    ACET,  ACET_COMPS_V1,          "",              getAllEntitiesWithTypeAndId               }, \
+  { "POST",   ACET,  ACET_COMPS_V1,          ACET_POST_WORD,  postAllEntitiesWithTypeAndId              }, \
+  { "PUT",    ACET,  ACET_COMPS_V1,          ACET_PUT_WORD,   putAllEntitiesWithTypeAndId               }, \
+  { "DELETE", ACET,  ACET_COMPS_V1,          "",              deleteAllEntitiesWithTypeAndId            }, \
+  { "*",      ACET,  ACET_COMPS_V1,          "",              badVerbAllFour                            }, \
+                                                                                                           \
+  { "GET",    ICEAAT,  ICEAAT_COMPS_V1,      "",               getIndividualContextEntityAttributeWithTypeAndId    }, \
+  { "POST",   ICEAAT,  ICEAAT_COMPS_V1,      ICEAAT_POST_WORD, postIndividualContextEntityAttributeWithTypeAndId   }, \
+  { "PUT",    ICEAAT,  ICEAAT_COMPS_V1,      ICEAAT_PUT_WORD,  putIndividualContextEntityAttributeWithTypeAndId    }, \
+  { "DELETE", ICEAAT,  ICEAAT_COMPS_V1,      "",               deleteIndividualContextEntityAttributeWithTypeAndId }, \
+  { "*",      ICEAAT,  ICEAAT_COMPS_V1,      "",               badVerbAllFour                                      }, \
+                                                                                                                      \
+  { "GET",    AVIT,    AVIT_COMPS_V1,        "",               getAttributeValueInstanceWithTypeAndId              }, \
+  { "POST",   AVIT,    AVIT_COMPS_V1,        AVIT_POST_WORD,   postAttributeValueInstanceWithTypeAndId             }, \
+  { "PUT",    AVIT,    AVIT_COMPS_V1,        AVIT_PUT_WORD,    putAttributeValueInstanceWithTypeAndId              }, \
+  { "DELETE", AVIT,    AVIT_COMPS_V1,        "",               deleteAttributeValueInstanceWithTypeAndId           }, \
+  { "*",      AVIT,    AVIT_COMPS_V1,        "",               badVerbAllFour                                      }, \
+                                                                                                                      \
+  { "GET",    CEET,    CEET_COMPS_V1,        "",               getContextEntitiesByEntityIdAndType                 }, \
+  { "POST",   CEET,    CEET_COMPS_V1,        CEET_POST_WORD,   postContextEntitiesByEntityIdAndType                }, \
+  { "*",      CEET,    CEET_COMPS_V1,        "",               badVerbGetPostOnly                                  }, \
+                                                                                                                      \
+  { "GET",    CEAAT,   CEAAT_COMPS_V1,       "",               getEntityByIdAttributeByNameWithTypeAndId           }, \
+  { "POST",   CEAAT,   CEAAT_COMPS_V1,       CEAAT_POST_WORD,  postEntityByIdAttributeByNameWithTypeAndId          }, \
+  { "*",      CEAAT,   CEAAT_COMPS_V1,       "",               badVerbGetPostOnly                                  }
+
+
+
+/* *****************************************************************************
+*  
+* log requests
+* The documentation (Installation and Admin Guide) says /log/trace ...
+* ... and to maintain backward compatibility we keep supporting /log/traceLevel too
+*/
+#define LOG_REQUESTS_V0                                                              \
+  { "GET",    LOG,  LOGT_COMPS_V0,    "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOGT_COMPS_V0,    "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOGT_COMPS_V0,    "",  badVerbAllFour                         }, \
+  { "PUT",    LOG,  LOGTL_COMPS_V0,   "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOGTL_COMPS_V0,   "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOGTL_COMPS_V0,   "",  badVerbAllFour                         }, \
+  { "GET",    LOG,  LOG2T_COMPS_V0,   "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOG2T_COMPS_V0,   "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOG2T_COMPS_V0,   "",  badVerbAllFour                         }, \
+  { "PUT",    LOG,  LOG2TL_COMPS_V0,  "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOG2TL_COMPS_V0,  "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOG2TL_COMPS_V0,  "",  badVerbAllFour                         }
+
+#define LOG_REQUESTS_V1                                                              \
+  { "GET",    LOG,  LOGT_COMPS_V1,    "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOGT_COMPS_V1,    "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOGT_COMPS_V1,    "",  badVerbAllFour                         }, \
+  { "PUT",    LOG,  LOGTL_COMPS_V1,   "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOGTL_COMPS_V1,   "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOGTL_COMPS_V1,   "",  badVerbAllFour                         }, \
+  { "GET",    LOG,  LOG2T_COMPS_V1,   "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOG2T_COMPS_V1,   "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOG2T_COMPS_V1,   "",  badVerbAllFour                         }, \
+  { "PUT",    LOG,  LOG2TL_COMPS_V1,  "",  logTraceTreat                          }, \
+  { "DELETE", LOG,  LOG2TL_COMPS_V1,  "",  logTraceTreat                          }, \
+  { "*",      LOG,  LOG2TL_COMPS_V1,  "",  badVerbAllFour                         }
+
+#define STAT_REQUESTS_V0                                                             \
+  { "GET",    STAT, STAT_COMPS_V0,    "",  statisticsTreat                        }, \
+  { "DELETE", STAT, STAT_COMPS_V0,    "",  statisticsTreat                        }, \
+  { "*",      STAT, STAT_COMPS_V0,    "",  badVerbGetDeleteOnly                   }
+
+#define STAT_REQUESTS_V1                                                             \
+  { "GET",    STAT, STAT_COMPS_V1,    "",  statisticsTreat                        }, \
+  { "DELETE", STAT, STAT_COMPS_V1,    "",  statisticsTreat                        }, \
+  { "*",      STAT, STAT_COMPS_V1,    "",  badVerbGetDeleteOnly                   }
+
+#define METRICS_REQUESTS_V0                                                          \
+  { "GET",    METR, METR_COMPS_V0,    "",  metricsTreat                           }, \
+  { "*",      METR, METR_COMPS_V0,    "",  badVerbGetOnly                         }
+
+#define METRICS_REQUESTS_V1                                                          \
+  { "GET",    METR, METR_COMPS_V1,    "",  metricsTreat                           }, \
+  { "*",      METR, METR_COMPS_V1,    "",  badVerbGetOnly                         }
+
+#define INDEXES_REQUESTS_V1                                                          \
+  { "GET",    INDX, INDX_COMPS_V1,    "",  indexesTreat                           }, \
+  { "*",      INDX, INDX_COMPS_V1,    "",  badVerbGetOnly                         }
+
+#define VERSION_REQUESTS                                                             \
+  { "GET",    VERS, VERS_COMPS,    "",  versionTreat                              }, \
+  { "*",      VERS, VERS_COMPS,    "",  badVerbGetOnly                            }
+
+#define EXIT_REQUESTS                                                                \
+  { "GET",    EXIT, EXIT2_COMPS,   "",  exitTreat                                 }, \
+  { "GET",    EXIT, EXIT1_COMPS,   "",  exitTreat                                 }
+
+#define LEAK_REQUESTS                                                                \
+  { "GET",    LEAK, LEAK2_COMPS,   "",  leakTreat                                 }, \
+  { "GET",    LEAK, LEAK1_COMPS,   "",  leakTreat                                 }
+
+#define INVALID_REQUESTS                             \
+  { "*", INV, INV9_COMPS,    "", badNgsi9Request  }, \
+  { "*", INV, INV10_COMPS,   "", badNgsi10Request }, \
+  { "*", INV, INV_ALL_COMPS, "", badRequest       }
+
+
+
+/* ****************************************************************************
+*
+* END_REQUEST - End marker for the array
+*/
+#define END_REQUEST  { "", INV,  0, {}, "", NULL }
+
+
+
+/* ****************************************************************************
+*
+* restServiceV - services for BROKER (ngsi9/10)
+*
+* This is the default service vector, that is used if the broker is started without the -ngsi9 option
+*/
+RestService restServiceV[] =
+{
+  API_V2,
+
+  REGISTRY_STANDARD_REQUESTS_V0,
+  REGISTRY_STANDARD_REQUESTS_V1,
+  STANDARD_REQUESTS_V0,
+  STANDARD_REQUESTS_V1,
+
+  REGISTRY_CONVENIENCE_OPERATIONS_V0,
+  REGISTRY_CONVENIENCE_OPERATIONS_V1,
+  CONVENIENCE_OPERATIONS_V0,
+  CONVENIENCE_OPERATIONS_V1,
+  LOG_REQUESTS_V0,
+  LOG_REQUESTS_V1,
+  STAT_REQUESTS_V0,
+  STAT_REQUESTS_V1,
+  METRICS_REQUESTS_V0,
+  METRICS_REQUESTS_V1,
+  INDEXES_REQUESTS_V1,
+  VERSION_REQUESTS,
+
+#ifdef DEBUG
+  EXIT_REQUESTS,
+  LEAK_REQUESTS,
+#endif
+
+  INVALID_REQUESTS,
+  END_REQUEST
+};
+
+
+
+/* ****************************************************************************
+*
+* restServiceNgsi9 - services for CONF MAN
+*
+* This service vector (configuration) is used if the broker is started as
+* CONFIGURATION MANAGER (using the -ngsi9 option) and without using the
+* -multiservice option.
+*/
+RestService restServiceNgsi9[] =
+{
+  REGISTRY_STANDARD_REQUESTS_V0,   // FIXME P10:  NCAR is added here, is that OK?
+  REGISTRY_STANDARD_REQUESTS_V1,
+  REGISTRY_CONVENIENCE_OPERATIONS_V0,
+  REGISTRY_CONVENIENCE_OPERATIONS_V1,
+  LOG_REQUESTS_V0,
+  LOG_REQUESTS_V1,
+  STAT_REQUESTS_V0,
+  STAT_REQUESTS_V1,
+  METRICS_REQUESTS_V0,
+  METRICS_REQUESTS_V1,
+  INDEXES_REQUESTS_V1,
+  VERSION_REQUESTS,
+
+#ifdef DEBUG
+  EXIT_REQUESTS,
+  LEAK_REQUESTS,
+#endif
+
+  INVALID_REQUESTS,
+  END_REQUEST
+};
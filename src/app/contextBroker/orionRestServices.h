@@ -1,5 +1,5 @@
-#ifndef THREAD_DATA_H
-#define THREAD_DATA_H
+#ifndef SRC_APP_CONTEXTBROKER_ORIONRESTSERVICES_H_
+#define SRC_APP_CONTEXTBROKER_ORIONRESTSERVICES_H_
 
 /*
 *
@@ -23,14 +23,24 @@
 * For those usages not covered by this license please contact with
 * iot_support at tid dot es
 *
-* Author: Fermin Galan
+* Author: Ken Zangelin
 */
+#include "rest/RestService.h"
 
-#include "OnIntervalThreadParams.h"
 
-typedef struct ThreadData {
-    pthread_t tid;
-    OnIntervalThreadParams* params;
-} ThreadData;
 
-#endif
+/* ****************************************************************************
+*
+* restServiceV - services for BROKER (ngsi9/10)
+*/
+extern RestService restServiceV[];
+
+
+
+/* ****************************************************************************
+*
+* restServiceNgsi9 - services for CONF MAN (-ngsi9)
+*/
+extern RestService restServiceNgsi9[];
+
+#endif  // SRC_APP_CONTEXTBROKER_ORIONRESTSERVICES_H_
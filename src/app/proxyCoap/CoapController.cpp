@@ -37,6 +37,8 @@
 #include <math.h>
 #include <string>
 #include <string.h>
+#include <unistd.h>
+#include <boost/scoped_ptr.hpp>
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
@@ -46,14 +48,16 @@
 
 #define PORT_STRING_SIZE 6
 
-CoapController::CoapController(const char *_host, unsigned short _httpPort, unsigned short _coapPort)
+CoapController::CoapController(const char *_host, const char* _cbHost, unsigned short _httpPort, unsigned short _coapPort, int _workers)
 {
   // Read host and port values
   httpPort    = _httpPort;
   coapPort    = _coapPort;
+  workers     = (_workers > 0)? _workers : 1;
   host.assign(_host);
+  cbHost.assign(_cbHost);
 
-  char* portString = new char[PORT_STRING_SIZE];
+  char portString[PORT_STRING_SIZE];
   snprintf(portString, PORT_STRING_SIZE, "%d", _coapPort);
   coapPortStr.assign(portString);
 }
@@ -62,7 +66,7 @@ CoapController::CoapController(const char *_host, unsigned short _httpPort, unsi
 *
 * sendDatagram -
 */
-int CoapController::sendDatagram(int sockfd, boost::scoped_ptr<CoapPDU>& res, sockaddr* recvFrom)
+int CoapController::sendDatagram(int sockfd, const uint8_t* pdu, int pduLen, sockaddr* recvFrom)
 {
   socklen_t addrLen = sizeof(struct sockaddr_in);
   if (recvFrom->sa_family == AF_INET6)
@@ -70,7 +74,7 @@ int CoapController::sendDatagram(int sockfd, boost::scoped_ptr<CoapPDU>& res, so
     addrLen = sizeof(struct sockaddr_in6);
   }
 
-  ssize_t sent = sendto(sockfd, res->getPDUPointer(), res->getPDULength(), 0, recvFrom, addrLen);
+  ssize_t sent = sendto(sockfd, pdu, pduLen, 0, recvFrom, addrLen);
 
   if (sent < 0)
   {
@@ -85,9 +89,13 @@ int CoapController::sendDatagram(int sockfd, boost::scoped_ptr<CoapPDU>& res, so
   return 0;
 }
 
-int CoapController::sendError(int sockfd, CoapPDU* req, sockaddr* recvFrom, CoapPDU::Code code)
+/* ****************************************************************************
+*
+* errorResponse -
+*/
+CoapPDU* CoapController::errorResponse(CoapPDU* req, CoapPDU::Code code)
 {
-  boost::scoped_ptr<CoapPDU> res(new CoapPDU());
+  CoapPDU* res = new CoapPDU();
 
   res->setVersion(1);
   res->setMessageID(req->getMessageID());
@@ -95,44 +103,37 @@ int CoapController::sendError(int sockfd, CoapPDU* req, sockaddr* recvFrom, Coap
   res->setType(CoapPDU::COAP_ACKNOWLEDGEMENT);
   res->setToken(req->getTokenPointer(), req->getTokenLength());
 
-  return sendDatagram(sockfd, res, recvFrom);
+  return res;
 }
 
 /* ****************************************************************************
 *
-* callback -
+* callback - the response to a request, NULL if no response is to be sent
 */
-int CoapController::callback(CoapPDU* request, int sockfd, struct sockaddr_storage* recvFrom)
+CoapPDU* CoapController::callback(CoapPDU* request, CURL* curl)
 {
-  // Translate request from CoAP to HTTP and send it to MHD through loopback
-  std::string httpResponse;
-  httpResponse = sendHttpRequest(host.c_str(), httpPort, request);
+  // Translate request from CoAP to HTTP and send it to the broker
+  boost::scoped_ptr<HttpMessage> hm(sendHttpRequest(curl, cbHost.c_str(), httpPort, request));
 
-  if (httpResponse == "")
+  if (!hm)
   {
     // Could not get an answer from HTTP module
-    sendError(sockfd, request, (sockaddr*)recvFrom, CoapPDU::COAP_INTERNAL_SERVER_ERROR);
-    return 1;
+    return errorResponse(request, CoapPDU::COAP_INTERNAL_SERVER_ERROR);
   }
 
-  // Parse HTTP response
-  boost::scoped_ptr<HttpMessage> hm(new HttpMessage(httpResponse));
-
   // If CoAP message is too big, must send error to requester
   if (hm->contentLength() > COAP_BUFFER_SIZE)
   {
-    sendError(sockfd, request, (sockaddr*)recvFrom, CoapPDU::COAP_REQUEST_ENTITY_TOO_LARGE);
-    return 1;
+    return errorResponse(request, CoapPDU::COAP_REQUEST_ENTITY_TOO_LARGE);
   }
 
   // Translate response from HTTP to CoAP
-  boost::scoped_ptr<CoapPDU> coapResponse(hm->toCoap());
+  CoapPDU* coapResponse = hm->toCoap();
 
-  if (!coapResponse)
+  if (coapResponse == NULL)
   {
     // Could not translate HTTP into CoAP
-    sendError(sockfd, request, (sockaddr*)recvFrom, CoapPDU::COAP_INTERNAL_SERVER_ERROR);
-    return 1;
+    return errorResponse(request, CoapPDU::COAP_INTERNAL_SERVER_ERROR);
   }
 
   // Prepare appropriate response in CoAP
@@ -153,22 +154,68 @@ int CoapController::callback(CoapPDU* request, int sockfd, struct sockaddr_stora
     break;
 
   default:
-    return 1;
+    delete coapResponse;
+    return NULL;
     break;
   };
 
-  // Send the packet
-  sendDatagram(sockfd, coapResponse, (sockaddr*) recvFrom);
-  return 0;
+  return coapResponse;
 }
 
 
 
 /* ****************************************************************************
 *
-* serve -
+* socketOpen - a UDP socket bound to the CoAP port, -1 on error
+*
+* With 'reusePort', several sockets are bound to the same port and the kernel
+* distributes the datagrams among them (always the same socket for the same
+* source endpoint).
 */
-void CoapController::serve()
+int CoapController::socketOpen(struct addrinfo* bindAddr, bool reusePort)
+{
+  int sd = socket(bindAddr->ai_family, bindAddr->ai_socktype, bindAddr->ai_protocol);
+
+  if (sd == -1)
+  {
+    return -1;
+  }
+
+  if (reusePort)
+  {
+#ifdef SO_REUSEPORT
+    int on = 1;
+
+    if (setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0)
+    {
+      close(sd);
+      return -1;
+    }
+#else
+    close(sd);
+    return -1;
+#endif
+  }
+
+  if (bind(sd, bindAddr->ai_addr, bindAddr->ai_addrlen) != 0)
+  {
+    close(sd);
+    return -1;
+  }
+
+  return sd;
+}
+
+
+
+/* ****************************************************************************
+*
+* worker -
+*
+* Each worker receives PDUs from its socket and serves them one by one, using its own
+* curl handle (and so its own persistent connection to the broker).
+*/
+void CoapController::worker(int sd)
 {
   // Buffers for UDP and URIs
   char buffer[COAP_BUFFER_SIZE];
@@ -178,32 +225,13 @@ void CoapController::serve()
 
   // Storage for handling receive address
   struct sockaddr_storage recvAddr;
-  socklen_t               recvAddrLen = sizeof(struct sockaddr_storage);
-
-  // Prepare binding address
-  struct addrinfo *bindAddr = NULL;
-  struct addrinfo hints;
-
-  // Setting up bind address
-  memset(&hints, 0, sizeof(struct addrinfo));
-  hints.ai_socktype   = SOCK_DGRAM;
-  hints.ai_flags     |= AI_NUMERICSERV;
-  hints.ai_family     = AF_INET; // ipv4, PF_INET6 for ipv6 or PF_UNSPEC to let OS decide
+  socklen_t               recvAddrLen;
 
-  int error = getaddrinfo(host.c_str(), coapPortStr.c_str(), &hints, &bindAddr);
-  if (error)
-  {
-    LM_W(("Could not start CoAP server: Error getting address info: %s.", gai_strerror(error)));
-    return;
-  }
+  CURL* curl = curl_easy_init();
 
-  // Setting up the UDP socket
-  int sd = socket(bindAddr->ai_family, bindAddr->ai_socktype, bindAddr->ai_protocol);
-
-  // Binding socket
-  if (bind(sd, bindAddr->ai_addr, bindAddr->ai_addrlen) != 0)
+  if (curl == NULL)
   {
-    LM_W(("Could not start CoAP server: Error binding socket"));
+    LM_E(("Runtime Error (could not init a curl handle for a CoAP worker)"));
     return;
   }
 
@@ -213,6 +241,7 @@ void CoapController::serve()
     memset(buffer, 0, COAP_BUFFER_SIZE);
 
     // receive packet
+    recvAddrLen = sizeof(struct sockaddr_storage);
     ret = recvfrom(sd, &buffer, COAP_BUFFER_SIZE, 0, (sockaddr*) &recvAddr, &recvAddrLen);
     if (ret == -1)
     {
@@ -246,25 +275,129 @@ void CoapController::serve()
     if (recvURILen == 0)
     {
       LM_T(LmtCoap, ("There is no URI associated with this Coap PDU"));
+
+      // no URI, handle cases
+
+      // code == 0, no payload, this is a ping request, send RST?
+      if ((recvPDU->getPDULength() == 0) && (recvPDU->getCode() == 0))
+      {
+        LM_T(LmtCoap, ("CoAP ping request"));
+      }
+
+      continue;
+    }
+
+    // Duplicated messages (retransmissions of the client) are not forwarded again
+    std::string  key = CoapMessageCache::key(&recvAddr, recvPDU->getMessageID());
+    std::string  cachedResponse;
+
+    switch (messageCache.lookup(key, &cachedResponse))
+    {
+    case CoapMessageCache::InProcess:
+      LM_T(LmtCoap, ("Duplicated message %d, still in process", recvPDU->getMessageID()));
+      continue;
+
+    case CoapMessageCache::Answered:
+      LM_T(LmtCoap, ("Duplicated message %d, sending the response again", recvPDU->getMessageID()));
+      if (!cachedResponse.empty())
+      {
+        sendDatagram(sd, (const uint8_t*) cachedResponse.data(), cachedResponse.size(), (sockaddr*) &recvAddr);
+      }
+      continue;
+
+    case CoapMessageCache::New:
+      break;
+    }
+
+    boost::scoped_ptr<CoapPDU> response(callback(recvPDU.get(), curl));
+
+    if (response)
+    {
+      // Send the packet
+      sendDatagram(sd, response->getPDUPointer(), response->getPDULength(), (sockaddr*) &recvAddr);
+      messageCache.done(key, response->getPDUPointer(), response->getPDULength());
     }
     else
     {
-      // Invoke a callback thread
-      boost::thread* workerThread = new boost::thread(boost::bind(&CoapController::callback, this, recvPDU.get(), sd, &recvAddr));
+      messageCache.done(key, NULL, 0);
+    }
+  }
+
+  curl_easy_cleanup(curl);
+}
 
-      // Wait for thread to finnish (like using no threads at all) for now
-      workerThread->join();
 
-      continue;
+
+/* ****************************************************************************
+*
+* serve -
+*
+* Starts the workers and waits for them (forever). Each worker gets its own socket if
+* the system supports SO_REUSEPORT, otherwise all of them share the same socket.
+*/
+void CoapController::serve()
+{
+  // Prepare binding address
+  struct addrinfo *bindAddr = NULL;
+  struct addrinfo hints;
+
+  // Setting up bind address
+  memset(&hints, 0, sizeof(struct addrinfo));
+  hints.ai_socktype   = SOCK_DGRAM;
+  hints.ai_flags     |= AI_NUMERICSERV;
+  hints.ai_family     = AF_INET; // ipv4, PF_INET6 for ipv6 or PF_UNSPEC to let OS decide
+
+  int error = getaddrinfo(host.c_str(), coapPortStr.c_str(), &hints, &bindAddr);
+  if (error)
+  {
+    LM_W(("Could not start CoAP server: Error getting address info: %s.", gai_strerror(error)));
+    return;
+  }
+
+  // Setting up the UDP sockets
+  std::vector<int>  sdV;
+  bool              reusePort = (workers > 1);
+
+  for (int ix = 0; ix < workers; ++ix)
+  {
+    int sd = socketOpen(bindAddr, reusePort);
+
+    if ((sd == -1) && (ix == 0) && reusePort)
+    {
+      LM_T(LmtCoap, ("SO_REUSEPORT not available, all the workers share the same socket"));
+      reusePort = false;
+      sd        = socketOpen(bindAddr, false);
+    }
+
+    if (sd == -1)
+    {
+      break;
     }
 
-    // no URI, handle cases
+    sdV.push_back(sd);
 
-    // code == 0, no payload, this is a ping request, send RST?
-    if ((recvPDU->getPDULength() == 0) && (recvPDU->getCode() == 0))
+    if (!reusePort)
     {
-      LM_T(LmtCoap, ("CoAP ping request"));
+      break;
     }
+  }
+
+  freeaddrinfo(bindAddr);
 
+  if (sdV.size() == 0)
+  {
+    LM_W(("Could not start CoAP server: Error binding socket"));
+    return;
   }
+
+  LM_T(LmtCoap, ("CoAP server with %d workers on %d sockets", workers, (int) sdV.size()));
+
+  boost::thread_group threads;
+
+  for (int ix = 0; ix < workers; ++ix)
+  {
+    threads.create_thread(boost::bind(&CoapController::worker, this, sdV[ix % sdV.size()]));
+  }
+
+  threads.join_all();
 }
@@ -26,26 +26,36 @@
 */
 
 #include <netinet/in.h>
+#include <netdb.h>
 #include <boost/thread.hpp>
 #include <string>
+#include <vector>
+
+#include <curl/curl.h>
 
 #include "cantcoap.h"
+#include "proxyCoap/CoapMessageCache.h"
 
 class CoapController
 {
 
-  std::string     host;
-  std::string     coapPortStr;
-  unsigned short  httpPort;
-  unsigned short  coapPort;
+  std::string       host;
+  std::string       cbHost;
+  std::string       coapPortStr;
+  unsigned short    httpPort;
+  unsigned short    coapPort;
+  int               workers;
+  CoapMessageCache  messageCache;
 
-  int sendDatagram(int sockfd, boost::scoped_ptr<CoapPDU>& res, sockaddr* recvFrom);
-  int sendError(int sockfd, CoapPDU* req, sockaddr* recvFrom, CoapPDU::Code code);
+  int sendDatagram(int sockfd, const uint8_t* pdu, int pduLen, sockaddr* recvFrom);
+  CoapPDU* errorResponse(CoapPDU* req, CoapPDU::Code code);
 
-  int callback(CoapPDU* request, int sockfd, struct sockaddr_storage* recvFrom);
+  CoapPDU* callback(CoapPDU* request, CURL* curl);
+  int  socketOpen(struct addrinfo* bindAddr, bool reusePort);
+  void worker(int sd);
 
 public:
-  CoapController(const char* _host, unsigned short _httpPort, unsigned short _coapPort);
+  CoapController(const char* _host, const char* _cbHost, unsigned short _httpPort, unsigned short _coapPort, int _workers);
   void serve();
 };
 
@@ -0,0 +1,177 @@
+/*
+*
+* Copyright 2014 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: TID Developer
+*/
+
+#include "proxyCoap/CoapMessageCache.h"
+
+#include <netinet/in.h>
+#include <string.h>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+
+
+/* ****************************************************************************
+*
+* key - address and port of the source endpoint and message ID, as bytes
+*/
+std::string CoapMessageCache::key(const struct sockaddr_storage* from, unsigned short messageId)
+{
+  std::string k((const char*) &messageId, sizeof(messageId));
+
+  if (from->ss_family == AF_INET6)
+  {
+    const struct sockaddr_in6* in6P = (const struct sockaddr_in6*) from;
+
+    k.append((const char*) &in6P->sin6_port, sizeof(in6P->sin6_port));
+    k.append((const char*) &in6P->sin6_addr, sizeof(in6P->sin6_addr));
+  }
+  else
+  {
+    const struct sockaddr_in* inP = (const struct sockaddr_in*) from;
+
+    k.append((const char*) &inP->sin_port, sizeof(inP->sin_port));
+    k.append((const char*) &inP->sin_addr, sizeof(inP->sin_addr));
+  }
+
+  return k;
+}
+
+
+
+/* ****************************************************************************
+*
+* purge - forget the expired exchanges, and the oldest ones if room is needed in a full cache
+*
+* Exchanges are inserted with increasing expiration, so the expired ones are at the
+* front of 'order'. Exchanges still in process are never forgotten, but they are skipped
+* (and kept at the front), so a request the broker is slow to answer doesn't keep the
+* exchanges after it in the cache. The requests to the broker have a timeout
+* (COAP_HTTP_TIMEOUT), so no exchange stays in process for long.
+*/
+void CoapMessageCache::purge(time_t now, bool makeRoom)
+{
+  std::deque<std::string> inProcess;
+
+  while (!order.empty())
+  {
+    std::map<std::string, Exchange>::iterator it = exchanges.find(order.front());
+
+    if (it != exchanges.end())
+    {
+      bool full = makeRoom && (exchanges.size() >= maxEntries);
+
+      if ((it->second.expiration > now) && !full)
+      {
+        break;
+      }
+
+      if (!it->second.done)
+      {
+        inProcess.push_back(order.front());
+        order.pop_front();
+        continue;
+      }
+
+      exchanges.erase(it);
+    }
+
+    order.pop_front();
+  }
+
+  order.insert(order.begin(), inProcess.begin(), inProcess.end());
+}
+
+
+
+/* ****************************************************************************
+*
+* lookup -
+*/
+CoapMessageCache::Lookup CoapMessageCache::lookup(const std::string& key, std::string* responseP)
+{
+  return lookup(key, responseP, time(NULL));
+}
+
+
+
+/* ****************************************************************************
+*
+* lookup - 'now' is the current time (given by the unit tests)
+*/
+CoapMessageCache::Lookup CoapMessageCache::lookup(const std::string& key, std::string* responseP, time_t now)
+{
+  boost::lock_guard<boost::mutex>  lock(mtx);
+
+  purge(now, false);
+
+  std::map<std::string, Exchange>::iterator it = exchanges.find(key);
+
+  if (it != exchanges.end())
+  {
+    if (!it->second.done)
+    {
+      return InProcess;
+    }
+
+    *responseP = it->second.response;
+    return Answered;
+  }
+
+  purge(now, true);
+
+  Exchange& exchange = exchanges[key];
+
+  exchange.done       = false;
+  exchange.expiration = now + COAP_EXCHANGE_LIFETIME;
+  order.push_back(key);
+
+  return New;
+}
+
+
+
+/* ****************************************************************************
+*
+* done - the exchange has been answered with 'pdu' (NULL if nothing was sent)
+*/
+void CoapMessageCache::done(const std::string& key, const unsigned char* pdu, int pduLen)
+{
+  boost::lock_guard<boost::mutex> lock(mtx);
+
+  std::map<std::string, Exchange>::iterator it = exchanges.find(key);
+
+  if (it == exchanges.end())
+  {
+    return;
+  }
+
+  it->second.done = true;
+
+  if (pdu != NULL)
+  {
+    it->second.response.assign((const char*) pdu, pduLen);
+  }
+}
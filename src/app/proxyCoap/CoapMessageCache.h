@@ -0,0 +1,89 @@
+#ifndef COAP_MESSAGE_CACHE_H
+#define COAP_MESSAGE_CACHE_H
+/*
+*
+* Copyright 2014 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: TID Developer
+*/
+#include <sys/socket.h>
+#include <time.h>
+#include <boost/thread.hpp>
+
+#include <deque>
+#include <map>
+#include <string>
+
+
+
+/* ****************************************************************************
+*
+* COAP_EXCHANGE_LIFETIME - seconds a message ID is remembered (RFC 7252, 4.8.2)
+* COAP_CACHE_MAX_ENTRIES - the oldest exchanges are forgotten before their lifetime, beyond this
+*/
+#define COAP_EXCHANGE_LIFETIME   247
+#define COAP_CACHE_MAX_ENTRIES   65536
+
+
+
+/* ****************************************************************************
+*
+* CoapMessageCache - message deduplication (RFC 7252, 4.5)
+*
+* Exchanges are identified by the source endpoint and the message ID. A duplicate of a
+* message already answered gets the same response again (the response of a CON message
+* is an ACK, that may have been lost); a duplicate of a message still in process is
+* ignored.
+*/
+class CoapMessageCache
+{
+  struct Exchange
+  {
+    bool         done;
+    time_t       expiration;
+    std::string  response;   // the PDU sent as response, if any
+  };
+
+  std::map<std::string, Exchange>  exchanges;
+  std::deque<std::string>          order;      // keys, oldest first
+  unsigned int                     maxEntries;
+  boost::mutex                     mtx;
+
+  void purge(time_t now, bool makeRoom);
+
+public:
+  explicit CoapMessageCache(unsigned int _maxEntries = COAP_CACHE_MAX_ENTRIES): maxEntries(_maxEntries) {}
+
+  typedef enum Lookup
+  {
+    New,         // first time, now in process
+    InProcess,   // duplicate, still in process
+    Answered     // duplicate, 'response' is the response to resend (empty if none was sent)
+  } Lookup;
+
+  static std::string key(const struct sockaddr_storage* from, unsigned short messageId);
+
+  Lookup lookup(const std::string& key, std::string* responseP);
+  Lookup lookup(const std::string& key, std::string* responseP, time_t now);
+  void   done(const std::string& key, const unsigned char* pdu, int pduLen);
+};
+
+#endif // COAP_MESSAGE_CACHE_H
@@ -28,69 +28,11 @@
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
-#include <stdlib.h>  // atoi
-#include <sstream>   // istringstream
-
-HttpMessage::HttpMessage(std::string theMessage)
+HttpMessage::HttpMessage(int httpCode, const std::string& contentType, const std::string& body)
 {
-  _httpCode = 0;
-  _contentLength = 0;
-  _contentType = "";
-  _body = "";
-
-  std::istringstream iss(theMessage);
-  std::string line;
-
-  bool isHeader = true;
-  while (std::getline(iss, line))
-  {
-    // Clean last char in headers
-    if (isHeader)
-    {
-      line = line.substr(0, line.size() - 1);
-    }
-
-    if (line.empty())
-    {
-      isHeader = false;
-    }
-
-    if (isHeader)
-    {
-      // Is it a header or the first line with the HTTP code?
-      int pos = line.find(":");
-      if (pos < 0)
-      {
-        // Get HTTP code
-        // HTTP code is always 3 chars long starting at position 9
-        //
-        //   HTTP/1.1 200 OK
-        //            XXX
-        //
-        _httpCode = atoi(line.substr(9, 3).c_str());
-      }
-      else
-      {
-        // Get other headers
-        int temp = line.find("Content-Length");
-        if (temp >= 0)
-        {
-          _contentLength = atoi(line.substr(pos + 2).c_str());
-        }
-
-        temp = line.find("Content-Type");
-        if (temp >= 0)
-        {
-          _contentType = line.substr(pos + 2);
-        }
-      }
-    }
-    else
-    {
-      // We are parsing the body now (as is)
-      _body += line;
-    }
-  }
+  _httpCode    = httpCode;
+  _contentType = contentType;
+  _body        = body;
 }
 
 CoapPDU* HttpMessage::toCoap()
@@ -118,8 +60,8 @@ CoapPDU* HttpMessage::toCoap()
   std::size_t length = this->_body.length();
   pdu->setPayload(data, length);
 
-  // Set content-type
-  if (this->_contentType == "application/json")
+  // Set content-type (the broker may add parameters, like charset)
+  if (this->_contentType.compare(0, 16, "application/json") == 0)
   {
     pdu->setContentFormat(CoapPDU::COAP_CONTENT_FORMAT_APP_JSON);
   }
@@ -30,15 +30,14 @@
 class HttpMessage
 {
     int          _httpCode;
-    int          _contentLength;
     std::string  _contentType;
     std::string  _body;
 
   public:
-    HttpMessage(std::string theMessage);
+    HttpMessage(int httpCode, const std::string& contentType, const std::string& body);
 
     CoapPDU* toCoap();
-    int      contentLength() { return _contentLength; }
+    int      contentLength() { return _body.size(); }
 };
 
 #endif // HTTP_MESSAGE_H
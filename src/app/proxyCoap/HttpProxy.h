@@ -24,17 +24,15 @@
 *
 * Author: TID Developer
 */
+#include <curl/curl.h>
+
 #include "cantcoap.h"
 #include "proxyCoap/HttpMessage.h"
 
-struct MemoryStruct {
-  char*   memory;
-  size_t  size;
-};
-
 static const int  COAP_URI_BUFFER_SIZE = 255;
 static const int  COAP_BUFFER_SIZE     = 1024;
+static const long COAP_HTTP_TIMEOUT    = 30000;  // milliseconds, well below COAP_EXCHANGE_LIFETIME
 
-extern std::string  sendHttpRequest(const char* host, unsigned short port, CoapPDU* request);
+extern HttpMessage*  sendHttpRequest(CURL* curl, const char* host, unsigned short port, CoapPDU* request);
 
 #endif // HTTP_PROXY_H
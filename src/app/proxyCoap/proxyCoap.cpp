@@ -35,6 +35,8 @@
 #include <signal.h>
 #include <boost/thread.hpp>
 
+#include <curl/curl.h>
+
 #include "parseArgs/parseArgs.h"
 #include "parseArgs/paConfig.h"
 #include "parseArgs/paBuiltin.h"
@@ -63,6 +65,7 @@ char            bindAddress[MAX_LEN_IP];
 int             port;
 char            cbHost[64];
 int             cbPort;
+int             workers;
 bool            useOnlyIPv4;
 bool            useOnlyIPv6;
 
@@ -78,6 +81,7 @@ PaArgument paArgs[] =
 
   { "-cbHost",       cbHost,         "FWD_HOST",       PaString, PaOpt, _i "localhost", PaNL,   PaNL,  "host for forwarding CoAP requests"         },
   { "-cbPort",       &cbPort,        "FWD_PORT",       PaInt,    PaOpt, 1026,              0,  65000,  "HTTP port for forwarding CoAP requests"    },
+  { "-workers",      &workers,       "WORKERS",        PaInt,    PaOpt, 4,                 1,    256,  "number of worker threads"                  },
 
   { "-ipv4",         &useOnlyIPv4,  "USEIPV4",         PaBool,   PaOpt, false,          false,  true,  "use ip v4 only"                            },
   { "-ipv6",         &useOnlyIPv6,  "USEIPV6",         PaBool,   PaOpt, false,          false,  true,  "use ip v6 only"                            },
@@ -196,7 +200,10 @@ int main(int argC, char* argV[])
   if (fg == false)
     daemonize();
 
-  CoapController* cc = new CoapController(bindAddress, cbPort, port);
+  // Before any thread is started, see curl_global_init(3)
+  curl_global_init(CURL_GLOBAL_NOTHING);
+
+  CoapController* cc = new CoapController(bindAddress, cbHost, cbPort, port, workers);
   cc->serve();
 }
 
@@ -0,0 +1,254 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>
+
+#include <new>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/Arena.h"
+
+
+
+/* ****************************************************************************
+*
+* ARENA_ALIGN - alignment of the objects (and size of the header that precedes them)
+*/
+#define ARENA_ALIGN  16
+
+
+
+/* ****************************************************************************
+*
+* ArenaBlock - header of the blocks, the objects follow it
+*/
+struct ArenaBlock
+{
+  ArenaBlock*  next;
+  char         pad[ARENA_ALIGN - sizeof(ArenaBlock*)];
+};
+
+
+
+/* ****************************************************************************
+*
+* arenaCurrentP - the arena of the thread
+*/
+static __thread Arena* arenaCurrentP = NULL;
+
+
+
+/* ****************************************************************************
+*
+* Arena::Arena -
+*/
+Arena::Arena()
+{
+  blockList    = NULL;
+  next         = NULL;
+  left         = 0;
+  total        = 0;
+  allocationNo = 0;
+  blockNo      = 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* Arena::~Arena -
+*/
+Arena::~Arena()
+{
+  reset();
+}
+
+
+
+/* ****************************************************************************
+*
+* Arena::blockAdd - take a block of 'size' bytes from the heap, NULL if not possible
+*/
+void* Arena::blockAdd(size_t size)
+{
+  if (total + size > ARENA_MAX_SIZE)
+  {
+    LM_T(LmtRest, ("arena full (%lu bytes in %d blocks)", (unsigned long) total, blockNo));
+    return NULL;
+  }
+
+  ArenaBlock* blockP = (ArenaBlock*) malloc(sizeof(ArenaBlock) + size);
+
+  if (blockP == NULL)
+  {
+    return NULL;
+  }
+
+  blockP->next = blockList;
+  blockList    = blockP;
+  total       += size;
+  ++blockNo;
+
+  return (char*) blockP + sizeof(ArenaBlock);
+}
+
+
+
+/* ****************************************************************************
+*
+* Arena::allocate - NULL if the arena is full
+*
+* Objects bigger than a quarter of a block get a block of their own, so the space left in
+* the current block is not wasted.
+*/
+void* Arena::allocate(size_t size)
+{
+  void* p;
+
+  size = (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+
+  if (size > ARENA_BLOCK_SIZE / 4)
+  {
+    p = blockAdd(size);
+  }
+  else
+  {
+    if (size > left)
+    {
+      char* blockP = (char*) blockAdd(ARENA_BLOCK_SIZE);
+
+      if (blockP == NULL)
+      {
+        return NULL;
+      }
+
+      next = blockP;
+      left = ARENA_BLOCK_SIZE;
+    }
+
+    p     = next;
+    next += size;
+    left -= size;
+  }
+
+  if (p != NULL)
+  {
+    ++allocationNo;
+  }
+
+  return p;
+}
+
+
+
+/* ****************************************************************************
+*
+* Arena::reset - free all the blocks
+*
+* The objects of the arena must not be used after this, not even deleted.
+*/
+void Arena::reset(void)
+{
+  while (blockList != NULL)
+  {
+    ArenaBlock* blockP = blockList;
+
+    blockList = blockP->next;
+    free(blockP);
+  }
+
+  next         = NULL;
+  left         = 0;
+  total        = 0;
+  allocationNo = 0;
+  blockNo      = 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* arenaActivate -
+*/
+Arena* arenaActivate(Arena* arenaP)
+{
+  Arena* prevP = arenaCurrentP;
+
+  arenaCurrentP = arenaP;
+  return prevP;
+}
+
+
+
+/* ****************************************************************************
+*
+* ArenaObject::operator new -
+*/
+void* ArenaObject::operator new(size_t size)
+{
+  Arena*  arenaP = arenaCurrentP;
+  char*   p      = NULL;
+
+  if (arenaP != NULL)
+  {
+    p = (char*) arenaP->allocate(ARENA_ALIGN + size);
+  }
+
+  if (p == NULL)
+  {
+    arenaP = NULL;
+    p      = (char*) malloc(ARENA_ALIGN + size);
+
+    if (p == NULL)
+    {
+      throw std::bad_alloc();
+    }
+  }
+
+  *((Arena**) p) = arenaP;
+  return p + ARENA_ALIGN;
+}
+
+
+
+/* ****************************************************************************
+*
+* ArenaObject::operator delete -
+*/
+void ArenaObject::operator delete(void* p)
+{
+  if (p == NULL)
+  {
+    return;
+  }
+
+  char* headerP = (char*) p - ARENA_ALIGN;
+
+  if (*((Arena**) headerP) == NULL)
+  {
+    free(headerP);
+  }
+}
@@ -0,0 +1,103 @@
+#ifndef SRC_LIB_COMMON_ARENA_H_
+#define SRC_LIB_COMMON_ARENA_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+
+#include <stddef.h>
+
+
+
+/* ****************************************************************************
+*
+* Arena - memory of the object graph of a request
+*
+* The parse and response objects of a request (context elements, attributes, metadata,
+* compound values, etc.) are allocated from the arena of its ConnectionInfo instead of
+* from the heap. Memory is taken from big blocks and never given back one object at a
+* time: the blocks are freed all together when the connection ends (requestCompleted).
+*
+* ARENA_BLOCK_SIZE - size of the blocks taken from the heap
+* ARENA_MAX_SIZE   - beyond this, the objects of the request come from the heap again
+*/
+#define ARENA_BLOCK_SIZE   (64 * 1024)
+#define ARENA_MAX_SIZE     (64 * 1024 * 1024)
+
+struct ArenaBlock;
+
+class Arena
+{
+ public:
+  Arena();
+  ~Arena();
+
+  void*      allocate(size_t size);
+  void       reset(void);
+  long long  allocations(void) const  { return allocationNo; }
+  int        blocks(void) const       { return blockNo;      }
+
+ private:
+  ArenaBlock*  blockList;
+  char*        next;
+  size_t       left;
+  size_t       total;
+  long long    allocationNo;
+  int          blockNo;
+
+  void*  blockAdd(size_t size);
+
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+};
+
+
+
+/* ****************************************************************************
+*
+* arenaActivate - make 'arenaP' the arena of the calling thread, returns the previous one
+*
+* While a thread has an arena (not NULL), the objects of the classes deriving from
+* ArenaObject it creates are allocated in that arena.
+*/
+extern Arena* arenaActivate(Arena* arenaP);
+
+
+
+/* ****************************************************************************
+*
+* ArenaObject - base class of the objects allocated in the arena of the thread
+*
+* Each object is preceded by the arena it was allocated in (NULL for the heap), so it can
+* be deleted from any thread: deleting an object of an arena only runs its destructor,
+* the memory goes back with the rest of the arena.
+*/
+class ArenaObject
+{
+ public:
+  static void*  operator new(size_t size);
+  static void   operator delete(void* p);
+};
+
+#endif  // SRC_LIB_COMMON_ARENA_H_
@@ -0,0 +1,56 @@
+#ifndef SRC_LIB_COMMON_QUEUEOVERFLOW_H_
+#define SRC_LIB_COMMON_QUEUEOVERFLOW_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <string>
+
+
+
+/* ****************************************************************************
+*
+* QueueOverflow - what to do when a notification arrives and the queue is full
+*
+* Used by the notification sender thread pool and by the asynchronous notification
+* engine (-notificationQueueOverflow CLI option).
+*/
+typedef enum QueueOverflow
+{
+  QoBlock,        // the producer waits until there is room in the queue
+  QoDropOldest,   // the oldest queued notification is discarded
+  QoDropNewest    // the new notification is discarded
+} QueueOverflow;
+
+
+
+/* ****************************************************************************
+*
+* queueOverflowGet - 
+*
+* Returns false if the string is not a valid overflow policy.
+*/
+extern bool queueOverflowGet(const std::string& s, QueueOverflow* overflowP);
+
+#endif  // SRC_LIB_COMMON_QUEUEOVERFLOW_H_
@@ -65,24 +65,21 @@ bool                   semTimeStatistics = false;
 * The whole thing is stored in the thread variable 'transactionId', supported by the
 * logging library 'liblm'.
 *
+* The running number is taken from a 64 bit counter that is incremented atomically, so
+* no semaphore is needed. The counter is split in the 31 bit running number and the number
+* of overflows, that is the number of milliseconds added to the start time. The start time
+* itself is never modified, so every counter value gives a different transaction id.
 */
 void transactionIdSet(void)
 {
-  static int transaction = 0;
-
-  transSemTake("transactionIdSet", "changing the transaction id");
-  ++transaction;
-
-  if (transaction < 0)
-  {
-    logStartTime.tv_usec += 1;
-    transaction = 1;
-  }
+  static unsigned long long  transactionCounter = 0;
+  unsigned long long         counter            = __sync_fetch_and_add(&transactionCounter, 1);
+  int                        transaction        = (int) (counter % 0x7FFFFFFF) + 1;
+  unsigned long long         overflows          = counter / 0x7FFFFFFF;
+  unsigned long long         msecs              = logStartTime.tv_usec / 1000 + overflows;
 
   snprintf(transactionId, sizeof(transactionId), "%lu-%03d-%011d",
-           logStartTime.tv_sec, (int) logStartTime.tv_usec / 1000, transaction);
-
-  transSemGive("transactionIdSet", "changing the transaction id");
+           logStartTime.tv_sec + (unsigned long) (msecs / 1000), (int) (msecs % 1000), transaction);
 }
 
 
@@ -78,6 +78,7 @@ extern int                statisticsTime;
 extern OrionExitFunction  orionExitFunction;
 extern bool               semTimeStatistics;
 extern unsigned           cprForwardLimit;
+extern long               cprForwardTimeout;
 
 
 
@@ -150,6 +151,7 @@ extern int64_t parse8601(const std::string& s);
 * Furthermore, a running number is appended for the transaction.
 * A 32 bit signed number is used, so its max value is 0x7FFFFFFF (2,147,483,647).
 * If the running number overflows, a millisecond is added to the startTime.
+* The running number is incremented atomically, without any semaphore.
 *
 * The whole thing is stored in the thread variable 'transactionId', supported by the
 * logging library 'liblm'.
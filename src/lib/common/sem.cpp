@@ -23,9 +23,11 @@
 * Author: Fermin Galan
 */
 #include <semaphore.h>
+#include <string.h>
 #include <errno.h>
 #include <time.h>
-#include <map>  // for curl contexts
+#include <deque>  // for curl contexts
+#include <map>    // for curl contexts
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
@@ -40,7 +42,7 @@
 * Globals -
 */
 static sem_t           reqSem;
-static sem_t           transSem;
+static sem_t           entitySem[ENTITY_SEM_STRIPES];
 static SemRequestType  reqPolicy;
 
 
@@ -50,7 +52,8 @@ static SemRequestType  reqPolicy;
 * Time measuring variables - 
 */
 static struct timespec accReqSemTime   = { 0, 0 };
-static struct timespec accTransSemTime = { 0, 0 };
+static struct timespec accEntitySemTime[ENTITY_SEM_STRIPES];
+static unsigned long   entitySemTakes[ENTITY_SEM_STRIPES];
 
 
 
@@ -74,12 +77,17 @@ int semInit(SemRequestType _reqPolicy, bool semTimeStat, int shared, int takenIn
     return -1;
   }
 
-  if (sem_init(&transSem, shared, takenInitially) == -1)
+  for (int ix = 0; ix < ENTITY_SEM_STRIPES; ++ix)
   {
-    LM_E(("Runtime Error (error initializing 'transactionId' semaphore: %s)", strerror(errno)));
-    return -1;
+    if (sem_init(&entitySem[ix], shared, takenInitially) == -1)
+    {
+      LM_E(("Runtime Error (error initializing 'entity' semaphore %d: %s)", ix, strerror(errno)));
+      return -1;
+    }
   }
 
+  semTimeEntityReset();
+
   reqPolicy = _reqPolicy;
 
   // Measure accumulated semaphore waiting time?
@@ -97,7 +105,7 @@ int reqSemTake(const char* who, const char* what, SemRequestType reqType, bool*
 {
   int r;
 
-  if (reqPolicy == SemNoneOp)
+  if ((reqPolicy == SemNoneOp) || (reqPolicy == SemEntityOp))
   {
     *taken = false;
     return -1;
@@ -165,17 +173,47 @@ void semTimeReqGet(char* buf, int bufLen)
 /* ****************************************************************************
 *
 * semTimeTransGet - get accumulated trans semaphore waiting time
+*
+* The transaction id is no longer protected by a semaphore (see transactionIdSet), so
+* there is no waiting time. It is still reported, as zero, not to change the statistics.
 */
 void semTimeTransGet(char* buf, int bufLen)
 {
   if (semTimeStatistics)
   {
-    snprintf(buf, bufLen, "%lu.%09d", accTransSemTime.tv_sec, (int) accTransSemTime.tv_nsec);
+    snprintf(buf, bufLen, "0.000000000");
+  }
+  else
+  {
+    snprintf(buf, bufLen, "Disabled");
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* semTimeEntityGet - get accumulated waiting time of one entity semaphore stripe
+*
+* Returns false if the stripe has never been taken, so the caller can skip it.
+*/
+bool semTimeEntityGet(int stripe, char* buf, int bufLen)
+{
+  if ((stripe < 0) || (stripe >= ENTITY_SEM_STRIPES) || (entitySemTakes[stripe] == 0))
+  {
+    return false;
+  }
+
+  if (semTimeStatistics)
+  {
+    snprintf(buf, bufLen, "%lu.%09d", accEntitySemTime[stripe].tv_sec, (int) accEntitySemTime[stripe].tv_nsec);
   }
   else
   {
     snprintf(buf, bufLen, "Disabled");
   }
+
+  return true;
 }
 
 
@@ -194,25 +232,72 @@ void semTimeReqReset(void)
 
 /* ****************************************************************************
 *
-* semTimeTransReset - 
+* semTimeEntityReset - 
+*/
+void semTimeEntityReset(void)
+{
+  for (int ix = 0; ix < ENTITY_SEM_STRIPES; ++ix)
+  {
+    accEntitySemTime[ix].tv_sec  = 0;
+    accEntitySemTime[ix].tv_nsec = 0;
+    entitySemTakes[ix]           = 0;
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* entitySemActive - 
 */
-void semTimeTransReset(void)
+bool entitySemActive(void)
 {
-  accTransSemTime.tv_sec  = 0;
-  accTransSemTime.tv_nsec = 0;
+  return reqPolicy == SemEntityOp;
+}
+
+
+
+/* ****************************************************************************
+*
+* entitySemStripe - hash an entity into the entity semaphore table
+*
+* The entity type is NOT part of the key: an update without entity type affects all
+* the entities with the given id (whatever their type), so it must be serialized with
+* the typed updates of that same id. FNV-1a is used, with a zero byte between fields
+* so that ("ab", "c") and ("a", "bc") don't collide on purpose.
+*/
+static int entitySemStripe(const std::string& tenant, const std::string& servicePath, const std::string& entityId)
+{
+  const std::string*  fieldV[3] = { &tenant, &servicePath, &entityId };
+  unsigned int        hash      = 2166136261U;
+
+  for (int fIx = 0; fIx < 3; ++fIx)
+  {
+    const std::string& field = *fieldV[fIx];
+
+    for (unsigned int cIx = 0; cIx < field.length(); ++cIx)
+    {
+      hash ^= (unsigned char) field[cIx];
+      hash *= 16777619U;
+    }
+
+    hash *= 16777619U;  // the zero byte separator
+  }
+
+  return hash % ENTITY_SEM_STRIPES;
 }
 
 
 
 /* ****************************************************************************
 *
-* transSemTake -
+* stripeTake -
 */
-int transSemTake(const char* who, const char* what)
+static int stripeTake(const char* who, int stripe, const std::string& entityId)
 {
   int r;
 
-  LM_T(LmtTransSem, ("%s taking the 'trans' semaphore for '%s'", who, what));
+  LM_T(LmtReqSem, ("%s taking the 'entity' semaphore %d for entity '%s'", who, stripe, entityId.c_str()));
 
   struct timespec startTime;
   struct timespec endTime;
@@ -223,17 +308,21 @@ int transSemTake(const char* who, const char* what)
     clock_gettime(CLOCK_REALTIME, &startTime);
   }
 
-  r = sem_wait(&transSem);
+  r = sem_wait(&entitySem[stripe]);
 
+  //
+  // The accumulators of a stripe are only modified while holding the stripe, so no extra lock is needed
+  //
   if (semTimeStatistics)
   {
     clock_gettime(CLOCK_REALTIME, &endTime);
 
     clock_difftime(&endTime, &startTime, &diffTime);
-    clock_addtime(&accTransSemTime, &diffTime);
+    clock_addtime(&accEntitySemTime[stripe], &diffTime);
   }
+  ++entitySemTakes[stripe];
 
-  LM_T(LmtTransSem, ("%s has the 'trans' semaphore", who));
+  LM_T(LmtReqSem, ("%s has the 'entity' semaphore %d", who, stripe));
 
   return r;
 }
@@ -242,77 +331,260 @@ int transSemTake(const char* who, const char* what)
 
 /* ****************************************************************************
 *
-* reqSemGive -
+* entitySemTake -
+*
+* Takes the entity semaphore stripe that corresponds to (tenant, servicePath, entityId).
+* If the 'entity' mutex policy is not in use, nothing is taken and *stripeP is set to -1,
+* which makes the corresponding entitySemGive a no-op.
 */
-int reqSemGive(const char* who, const char* what, bool semTaken)
+int entitySemTake
+(
+  const char*         who,
+  const std::string&  tenant,
+  const std::string&  servicePath,
+  const std::string&  entityId,
+  int*                stripeP
+)
 {
-  if (semTaken == false)
+  if (reqPolicy != SemEntityOp)
   {
+    *stripeP = -1;
     return 0;
   }
 
-  if (what != NULL)
+  *stripeP = entitySemStripe(tenant, servicePath, entityId);
+
+  return stripeTake(who, *stripeP, entityId);
+}
+
+
+
+/* ****************************************************************************
+*
+* entitySemTakeMany -
+*
+* Takes the stripes of several entities, in ascending stripe order and each stripe only once.
+* As a single entity update holds one stripe at a time, taking them always in the same order
+* makes the multi-entity updates deadlock free. If the 'entity' mutex policy is not in use,
+* nothing is taken and 'stripeV' is left empty.
+*/
+int entitySemTakeMany
+(
+  const char*                      who,
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::vector<std::string>&  entityIdV,
+  std::vector<int>*                stripeV
+)
+{
+  bool  taken[ENTITY_SEM_STRIPES];
+  int   r = 0;
+
+  stripeV->clear();
+
+  if (reqPolicy != SemEntityOp)
   {
-    LM_T(LmtReqSem, ("%s gives the 'req' semaphore for '%s'", who, what));
+    return 0;
   }
-  else
+
+  memset(taken, 0, sizeof(taken));
+  for (unsigned int ix = 0; ix < entityIdV.size(); ++ix)
   {
-    LM_T(LmtReqSem, ("%s gives the 'req' semaphore", who));
+    taken[entitySemStripe(tenant, servicePath, entityIdV[ix])] = true;
   }
 
-  return sem_post(&reqSem);
+  for (int stripe = 0; stripe < ENTITY_SEM_STRIPES; ++stripe)
+  {
+    if (taken[stripe])
+    {
+      r |= stripeTake(who, stripe, "(several)");
+      stripeV->push_back(stripe);
+    }
+  }
+
+  return r;
+}
+
+
+
+/* ****************************************************************************
+*
+* entitySemGive -
+*/
+int entitySemGive(const char* who, int stripe)
+{
+  if ((stripe < 0) || (stripe >= ENTITY_SEM_STRIPES))
+  {
+    return 0;
+  }
+
+  LM_T(LmtReqSem, ("%s gives the 'entity' semaphore %d", who, stripe));
+
+  return sem_post(&entitySem[stripe]);
+}
+
+
+
+/* ****************************************************************************
+*
+* entitySemGiveMany -
+*/
+int entitySemGiveMany(const char* who, const std::vector<int>& stripeV)
+{
+  int r = 0;
+
+  for (unsigned int ix = 0; ix < stripeV.size(); ++ix)
+  {
+    r |= entitySemGive(who, stripeV[ix]);
+  }
+
+  return r;
 }
 
 
 
 /* ****************************************************************************
 *
-* transSemGive -
+* reqSemGive -
 */
-int transSemGive(const char* who, const char* what)
+int reqSemGive(const char* who, const char* what, bool semTaken)
 {
+  if (semTaken == false)
+  {
+    return 0;
+  }
+
   if (what != NULL)
   {
-    LM_T(LmtTransSem, ("%s gives the 'trans' semaphore for '%s'", who, what));
+    LM_T(LmtReqSem, ("%s gives the 'req' semaphore for '%s'", who, what));
   }
   else
   {
-    LM_T(LmtTransSem, ("%s gives the 'trans' semaphore", who));
+    LM_T(LmtReqSem, ("%s gives the 'req' semaphore", who));
   }
 
-  return sem_post(&transSem);
+  return sem_post(&reqSem);
 }
 
 
+
 /* ****************************************************************************
  *  curl context
+ *
+ *  For each destination (key) a pool of curl easy handles is kept. Handles are
+ *  reset (but not cleaned up) when released, so the connections they keep alive
+ *  are reused by the next request to the same destination. As much as
+ *  'ccMaxPerKey' handles to the same destination may be in use at the same time,
+ *  further requests wait for one of them to be released. Handles not used during
+ *  'ccIdleTimeout' seconds are cleaned up (0: never), in all the pools, whenever
+ *  a handle is got or released.
  */
-
-
-static pthread_mutex_t contexts_mutex = PTHREAD_MUTEX_INITIALIZER;
-static std::map<std::string, struct curl_context> contexts;
+struct curl_pool
+{
+  std::deque<CURL*>   idle;
+  std::deque<time_t>  lastUse;
+  int                 inUse;
+  pthread_cond_t      released;
+};
+
+static pthread_mutex_t                             contexts_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string, struct curl_pool*>    contexts;
+static int                                         ccMaxPerKey    = 1;
+static int                                         ccIdleTimeout  = 0;
+static time_t                                      ccLastExpire   = 0;
 
 // Statistics
 static struct timespec accCCMutexTime = { 0, 0 };
 
 
+
+/* ****************************************************************************
+*
+* curl_context_pool_set -
+*/
+void curl_context_pool_set(int maxPerKey, int idleTimeout)
+{
+  ccMaxPerKey   = (maxPerKey < 1)? 1 : maxPerKey;
+  ccIdleTimeout = (idleTimeout < 0)? 0 : idleTimeout;
+}
+
+
+
 /* ****************************************************************************
 *
 * curl_context_cleanup - 
 */
 void curl_context_cleanup(void)
 {
-  for (std::map<std::string, struct curl_context>::iterator it = contexts.begin(); it != contexts.end(); ++it)
+  pthread_mutex_lock(&contexts_mutex);
+
+  for (std::map<std::string, struct curl_pool*>::iterator it = contexts.begin(); it != contexts.end(); ++it)
+  {
+    struct curl_pool* pool = it->second;
+
+    for (unsigned int ix = 0; ix < pool->idle.size(); ++ix)
+    {
+      curl_easy_cleanup(pool->idle[ix]);
+    }
+
+    //
+    // Handles still in use (if any) are not cleaned up, as we are exiting anyway.
+    // The pool itself is not freed either, to avoid a possible use-after-free.
+    //
+    pool->idle.clear();
+    pool->lastUse.clear();
+  }
+
+  pthread_mutex_unlock(&contexts_mutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* curl_pool_expire - cleanup the idle handles not used during ccIdleTimeout seconds
+*
+* The idle handles are ordered by last use (the oldest first) and contexts_mutex
+* must be taken by the caller.
+*/
+static void curl_pool_expire(struct curl_pool* pool, time_t now)
+{
+  if (ccIdleTimeout == 0)
+  {
+    return;
+  }
+
+  while ((pool->idle.size() > 0) && (now - pool->lastUse.front() > ccIdleTimeout))
+  {
+    curl_easy_cleanup(pool->idle.front());
+    pool->idle.pop_front();
+    pool->lastUse.pop_front();
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* curl_pools_expire - curl_pool_expire for all the pools
+*
+* So the idle handles to destinations not contacted any more are also cleaned up.
+* Called on every get and release of a handle, but the pools are swept at most once
+* per second. contexts_mutex must be taken by the caller.
+*/
+static void curl_pools_expire(time_t now)
+{
+  if ((ccIdleTimeout == 0) || (now == ccLastExpire))
   {
-    curl_easy_reset(it->second.curl);
-    curl_easy_cleanup(it->second.curl);
-    it->second.curl = NULL;
-    release_curl_context(&it->second, true);
-    contexts.erase(it);
+    return;
   }
 
-  contexts.clear();
-  curl_global_cleanup();
+  ccLastExpire = now;
+
+  for (std::map<std::string, struct curl_pool*>::iterator it = contexts.begin(); it != contexts.end(); ++it)
+  {
+    curl_pool_expire(it->second, now);
+  }
 }
 
 
@@ -320,11 +592,22 @@ void curl_context_cleanup(void)
 /* ****************************************************************************
 *
 * get_curl_context - 
+*
+* The time spent waiting for a free handle is accounted in accCCMutexTime.
 */
 int get_curl_context(const std::string& key, struct curl_context* pcc)
 {
-  pcc->curl   = NULL;
-  pcc->pmutex = NULL;
+  struct timespec  startTime;
+  struct timespec  endTime;
+  struct timespec  diffTime;
+
+  pcc->curl  = NULL;
+  pcc->ppool = NULL;
+
+  if (semTimeStatistics)
+  {
+    clock_gettime(CLOCK_REALTIME, &startTime);
+  }
 
   int s = pthread_mutex_lock(&contexts_mutex);
 
@@ -334,42 +617,65 @@ int get_curl_context(const std::string& key, struct curl_context* pcc)
     return s;
   }
 
-  std::map<std::string, struct curl_context>::iterator it;
-  it = contexts.find(key);
+  struct curl_pool*                                  pool;
+  std::map<std::string, struct curl_pool*>::iterator it = contexts.find(key);
+
   if (it == contexts.end())
   {
     // not found, create it
-    pcc->curl = curl_easy_init();
-    if (pcc->curl != NULL)
-    {
-      pthread_mutex_t* pm = (pthread_mutex_t *) malloc(sizeof(*pm));
-
-      if (pm == NULL)
-      {
-        pthread_mutex_unlock(&contexts_mutex);
-        LM_E(("Runtime Error (malloc)"));
-        return -1;
-      }
-
-      int s = pthread_mutex_init(pm, NULL);
-      if (s != 0)
-      {
-        pthread_mutex_unlock(&contexts_mutex);
-        LM_E(("Runtime Error (pthread_mutex_init)"));
-        free(pm);
-        return s;
-      }
-      pcc->pmutex   = pm;
-      contexts[key] = *pcc;
-    }
-    else  // curl_easy returned null
+    pool        = new struct curl_pool;
+    pool->inUse = 0;
+
+    s = pthread_cond_init(&pool->released, NULL);
+    if (s != 0)
     {
-      pcc->pmutex = NULL;    // unnecessary but clearer
+      pthread_mutex_unlock(&contexts_mutex);
+      LM_E(("Runtime Error (pthread_cond_init)"));
+      delete pool;
+      return s;
     }
+
+    contexts[key] = pool;
   }
-  else // previous context found
+  else // previous pool found
   {
-    *pcc = it->second;
+    pool = it->second;
+  }
+
+  // wait until a handle to this destination is available
+  while ((pool->idle.size() == 0) && (pool->inUse >= ccMaxPerKey))
+  {
+    pthread_cond_wait(&pool->released, &contexts_mutex);
+  }
+
+  time_t now = time(NULL);
+
+  curl_pool_expire(pool, now);
+  curl_pools_expire(now);
+
+  if (pool->idle.size() > 0)
+  {
+    // the most recently used handle is the one most likely to have its connection alive
+    pcc->curl = pool->idle.back();
+    pool->idle.pop_back();
+    pool->lastUse.pop_back();
+  }
+  else
+  {
+    pcc->curl = curl_easy_init();
+  }
+
+  if (pcc->curl != NULL)
+  {
+    pcc->ppool = pool;
+    ++pool->inUse;
+  }
+
+  if (semTimeStatistics)
+  {
+    clock_gettime(CLOCK_REALTIME, &endTime);
+    clock_difftime(&endTime, &startTime, &diffTime);
+    clock_addtime(&accCCMutexTime, &diffTime);
   }
 
   s = pthread_mutex_unlock(&contexts_mutex);
@@ -379,48 +685,51 @@ int get_curl_context(const std::string& key, struct curl_context* pcc)
     return s;
   }
 
-  // lock the mutex, if everything was right
-  // and cc is not {NULL, NULl}
-  if (pcc->pmutex != NULL)
-  {
-    struct timespec  startTime;
-    struct timespec  endTime;
-    struct timespec  diffTime;
+  return 0;
+}
 
-    if (semTimeStatistics)
-    {
-      clock_gettime(CLOCK_REALTIME, &startTime);
-    }
 
-    s = pthread_mutex_lock(pcc->pmutex);
+
+/* ****************************************************************************
+*
+* release_curl_context - 
+*/
+int release_curl_context(struct curl_context *pcc)
+{
+  // Give back the handle to its pool if not an empty context
+  if (pcc->ppool != NULL)
+  {
+    int s = pthread_mutex_lock(&contexts_mutex);
+
     if (s != 0)
     {
       LM_E(("Runtime Error (pthread_mutex_lock)"));
       return s;
     }
 
-    if (semTimeStatistics)
+    if (pcc->curl != NULL)
     {
-      clock_gettime(CLOCK_REALTIME, &endTime);
-      clock_difftime(&endTime, &startTime, &diffTime);
-
-      int s = pthread_mutex_lock(&contexts_mutex);
-      if (s != 0)
-      {
-        LM_E(("Runtime Error (pthread_mutex_lock)"));
-        return s;
-      }
-
-      clock_addtime(&accCCMutexTime, &diffTime);
-      s = pthread_mutex_unlock(&contexts_mutex);
-      if (s != 0)
-      {
-        LM_E(("Runtime Error (pthread_mutex_unlock)"));
-        return s;
-      }
+      curl_easy_reset(pcc->curl);
+      pcc->ppool->idle.push_back(pcc->curl);
+      pcc->ppool->lastUse.push_back(time(NULL));
+    }
+
+    --pcc->ppool->inUse;
+    pthread_cond_signal(&pcc->ppool->released);
+
+    curl_pools_expire(time(NULL));
+
+    s = pthread_mutex_unlock(&contexts_mutex);
+    if (s != 0)
+    {
+      LM_E(("Runtime Error (pthread_mutex_unlock)"));
+      return s;
     }
   }
 
+  pcc->curl  = NULL;
+  pcc->ppool = NULL;
+
   return 0;
 }
 
@@ -428,37 +737,24 @@ int get_curl_context(const std::string& key, struct curl_context* pcc)
 
 /* ****************************************************************************
 *
-* release_curl_context - 
+* curl_context_idle_count - number of idle handles in the pool of 'key'
 */
-int release_curl_context(struct curl_context *pcc, bool final)
+int curl_context_idle_count(const std::string& key)
 {
-  // Reset context if not an empty context
-  if (pcc->curl != NULL)
-  {
-    curl_easy_reset(pcc->curl);
-    pcc->curl = NULL; // It will remain in global map
-  }
+  int count = 0;
 
-  // Unlock the mutex if not an empty context
-  if (pcc->pmutex != NULL)
-  {
-    int s = pthread_mutex_unlock(pcc->pmutex);
-    if (final)
-    {
-      free(pcc->pmutex);
-    }
+  pthread_mutex_lock(&contexts_mutex);
 
-    if (s != 0)
-    {
-      LM_E(("Runtime Error (pthread_mutex_unlock)"));
-      return s;
-    }
+  std::map<std::string, struct curl_pool*>::iterator it = contexts.find(key);
 
-    pcc->pmutex = NULL; // It will remain in global map
+  if (it != contexts.end())
+  {
+    count = it->second->idle.size();
   }
 
+  pthread_mutex_unlock(&contexts_mutex);
 
-  return 0;
+  return count;
 }
 
 
@@ -30,6 +30,7 @@
 
 // curl context includes
 #include <string>
+#include <vector>
 
 #include <pthread.h>
 #include <curl/curl.h>
@@ -38,17 +39,30 @@
 /* ****************************************************************************
 *
 * SemRequestType - 
+*
+* SemEntityOp is only used as policy. With it, the global 'req' semaphore is never taken
+* and the read-modify-write of each entity is protected by a striped entity semaphore instead
+* (see entitySemTake).
 */
 typedef enum SemRequestType
 {
   SemReadOp,
   SemWriteOp,
   SemReadWriteOp,
-  SemNoneOp
+  SemNoneOp,
+  SemEntityOp
 } SemRequestType;
 
 
 
+/* ****************************************************************************
+*
+* ENTITY_SEM_STRIPES - number of semaphores in the entity semaphore table
+*/
+#define ENTITY_SEM_STRIPES  64
+
+
+
 /* ****************************************************************************
 *
 * semInit -
@@ -68,7 +82,22 @@ extern int semInit
 * xxxSemTake -
 */
 extern int reqSemTake(const char* who, const char* what, SemRequestType reqType, bool* taken);
-extern int transSemTake(const char* who, const char* what);
+extern int entitySemTake
+(
+  const char*         who,
+  const std::string&  tenant,
+  const std::string&  servicePath,
+  const std::string&  entityId,
+  int*                stripeP
+);
+extern int entitySemTakeMany
+(
+  const char*                      who,
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::vector<std::string>&  entityIdV,
+  std::vector<int>*                stripeV
+);
 
 
 
@@ -77,7 +106,8 @@ extern int transSemTake(const char* who, const char* what);
 * xxxSemGive -
 */
 extern int reqSemGive(const char* who, const char* what = NULL, bool taken = true);
-extern int transSemGive(const char* who, const char* what = NULL);
+extern int entitySemGive(const char* who, int stripe);
+extern int entitySemGiveMany(const char* who, const std::vector<int>& stripeV);
 
 
 
@@ -87,6 +117,7 @@ extern int transSemGive(const char* who, const char* what = NULL);
 */
 extern void semTimeReqGet(char* buf, int bufLen);
 extern void semTimeTransGet(char* buf, int bufLen);
+extern bool semTimeEntityGet(int stripe, char* buf, int bufLen);
 
 
 
@@ -95,22 +126,40 @@ extern void semTimeTransGet(char* buf, int bufLen);
 * semTimeXxxReset - 
 */
 extern void semTimeReqReset(void);
-extern void semTimeTransReset(void);
+extern void semTimeEntityReset(void);
+
+
+
+/* ****************************************************************************
+*
+* entitySemActive - is the striped entity semaphore policy in use?
+*/
+extern bool entitySemActive(void);
 
 
 
 /* ****************************************************************************
 *
 * curl context -
+*
+* 'ppool' is the per-destination pool the handle is given back to when released
 */
 struct curl_context
 {
   CURL *curl;
-  pthread_mutex_t *pmutex;
+  struct curl_pool *ppool;
 };
 
 
 
+/* ****************************************************************************
+*
+* curl_context_pool_set - maximum handles in use per destination and idle timeout (seconds)
+*/
+extern void curl_context_pool_set(int maxPerKey, int idleTimeout);
+
+
+
 /* ****************************************************************************
 *
 * curl_context_cleanup - 
@@ -131,7 +180,15 @@ extern int get_curl_context(const std::string& key, struct curl_context *pcc);
 *
 * release_curl_context -
 */
-extern int release_curl_context(struct curl_context *pcc, bool final = false);
+extern int release_curl_context(struct curl_context *pcc);
+
+
+
+/* ****************************************************************************
+*
+* curl_context_idle_count -
+*/
+extern int curl_context_idle_count(const std::string& key);
 
 
 
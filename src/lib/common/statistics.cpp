@@ -22,6 +22,10 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
 #include "common/statistics.h"
 #include "ngsi/Request.h"
 
@@ -29,103 +33,186 @@
 
 /* ****************************************************************************
 *
-* Statistic counters for NGSI REST requests
-*/
-int noOfJsonRequests                                     = -1;
-int noOfXmlRequests                                      = -1;
-int noOfRegistrations                                    = -1;
-int noOfRegistrationErrors                               = -1;
-int noOfRegistrationUpdates                              = -1;
-int noOfRegistrationUpdateErrors                         = -1;
-int noOfDiscoveries                                      = -1;
-int noOfDiscoveryErrors                                  = -1;
-int noOfAvailabilitySubscriptions                        = -1;
-int noOfAvailabilitySubscriptionErrors                   = -1;
-int noOfAvailabilityUnsubscriptions                      = -1;
-int noOfAvailabilityUnsubscriptionErrors                 = -1;
-int noOfAvailabilitySubscriptionUpdates                  = -1;
-int noOfAvailabilitySubscriptionUpdateErrors             = -1;
-int noOfAvailabilityNotificationsReceived                = -1;
-int noOfAvailabilityNotificationsSent                    = -1;
-
-int noOfQueries                                          = -1;
-int noOfQueryErrors                                      = -1;
-int noOfUpdates                                          = -1;
-int noOfUpdateErrors                                     = -1;
-int noOfSubscriptions                                    = -1;
-int noOfSubscriptionErrors                               = -1;
-int noOfSubscriptionUpdates                              = -1;
-int noOfSubscriptionUpdateErrors                         = -1;
-int noOfUnsubscriptions                                  = -1;
-int noOfUnsubscriptionErrors                             = -1;
-int noOfNotificationsReceived                            = -1;
-int noOfNotificationsSent                                = -1;
-int noOfQueryContextResponses                            = -1;
-int noOfUpdateContextResponses                           = -1;
-
-int noOfContextEntitiesByEntityId                        = -1;
-int noOfContextEntityAttributes                          = -1;
-int noOfEntityByIdAttributeByName                        = -1;
-int noOfContextEntityTypes                               = -1;
-int noOfContextEntityTypeAttributeContainer              = -1;
-int noOfContextEntityTypeAttribute                       = -1;
-int noOfNgsi9SubscriptionsConvOp                         = -1;
-
-int noOfIndividualContextEntity                          = -1;
-int noOfIndividualContextEntityAttributes                = -1;
-int noOfIndividualContextEntityAttribute                 = -1;
-int noOfAttributeValueInstance                           = -1;
-int noOfNgsi10ContextEntityTypes                         = -1;
-int noOfNgsi10ContextEntityTypesAttributeContainer       = -1;
-int noOfNgsi10ContextEntityTypesAttribute                = -1;
-int noOfNgsi10SubscriptionsConvOp                        = -1;
-
-int noOfUpdateContextElement                             = -1;
-int noOfAppendContextElement                             = -1;
-int noOfUpdateContextAttribute                           = -1;
-
-int noOfAllContextEntitiesRequests                       = -1;
-int noOfAllEntitiesWithTypeAndIdRequests                 = -1;
-int noOfIndividualContextEntityAttributeWithTypeAndId    = -1;
-int noOfAttributeValueInstanceWithTypeAndId              = -1;
-int noOfEntityByIdAttributeByNameIdAndType               = -1;
-
-int noOfLogRequests                                      = -1;
-int noOfVersionRequests                                  = -1;
-int noOfExitRequests                                     = -1;
-int noOfLeakRequests                                     = -1;
-int noOfStatisticsRequests                               = -1;
-int noOfInvalidRequests                                  = -1;
-int noOfRegisterResponses                                = -1;
-
-int noOfRtSubscribeContextAvailabilityResponse           = -1;
-int noOfRtUpdateContextAvailabilitySubscriptionResponse  = -1;
-int noOfRtUnsubscribeContextAvailabilityResponse         = -1;
-int noOfRtUnsubscribeContextResponse                     = -1;
-int noOfRtSubscribeResponse                              = -1;
-int noOfRtSubscribeError                                 = -1;
-int noOfContextElementResponse                           = -1;
-int noOfContextAttributeResponse                         = -1;
-
-int noOfEntityTypesRequest                               = -1;
-int noOfEntityTypesResponse                              = -1;
-int noOfAttributesForEntityTypeRequest                   = -1;
-int noOfAttributesForEntityTypeResponse                  = -1;
-int noOfContextEntitiesByEntityIdAndType                 = -1;
-
-int noOfEntitiesRequests                                 = -1;
-int noOfEntitiesResponses                                = -1;
-
-int noOfEntryPointsRequests                              = -1;
-int noOfEntryPointsResponses                             = -1;
-
-int noOfEntityRequests                                   = -1;
-int noOfEntityResponses                                  = -1;
-
-int noOfEntityAttributeRequests                          = -1;
-int noOfEntityAttributeResponses                         = -1;
-
-int noOfPostEntity                                       = -1;
+* StatisticsShard -
+*
+* The latency histograms are allocated the first time a request type (or a backend
+* operation) is measured in the shard, as most request types are never used.
+*/
+typedef struct StatisticsShard
+{
+  unsigned long               requestV[STATISTICS_REQUEST_TYPES];
+  unsigned long               counterV[StatCounters];
+  LatencyHistogram* volatile  latencyV[STATISTICS_REQUEST_TYPES];
+  LatencyHistogram* volatile  backendLatencyV[BackendOperations];
+} __attribute__ ((aligned (64))) StatisticsShard;
+
+
+
+/* ****************************************************************************
+*
+* globals -
+*/
+static StatisticsShard   shardV[STATISTICS_SHARDS];
+static int               shardNext = 0;
+static __thread int      shardIx   = -1;
+
+
+
+/* ****************************************************************************
+*
+* backendOperationNameV -
+*/
+static const char* backendOperationNameV[BackendOperations] =
+{
+  "queryContext",
+  "updateContext",
+  "subscribeContext",
+  "updateContextSubscription",
+  "unsubscribeContext",
+  "notifyContext",
+  "registerContext",
+  "discoverContextAvailability",
+  "subscribeContextAvailability",
+  "updateContextAvailabilitySubscription",
+  "unsubscribeContextAvailability",
+  "notifyContextAvailability",
+  "entityTypes",
+  "attributesForEntityType",
+  "getContextElementResponses"
+};
+
+
+
+/* ****************************************************************************
+*
+* shardGet - the shard of the calling thread
+*/
+static StatisticsShard* shardGet(void)
+{
+  if (shardIx == -1)
+  {
+    shardIx = __sync_fetch_and_add(&shardNext, 1) % STATISTICS_SHARDS;
+  }
+
+  return &shardV[shardIx];
+}
+
+
+
+/* ****************************************************************************
+*
+* histogramGet - the histogram of a slot of a shard, allocated if needed (NULL if out of memory)
+*/
+static LatencyHistogram* histogramGet(LatencyHistogram* volatile* histogramPP)
+{
+  LatencyHistogram* histogramP = *histogramPP;
+
+  if (histogramP == NULL)
+  {
+    histogramP = (LatencyHistogram*) calloc(1, sizeof(LatencyHistogram));
+
+    if ((histogramP != NULL) && (!__sync_bool_compare_and_swap(histogramPP, NULL, histogramP)))
+    {
+      // Some other thread of the shard was faster
+      free(histogramP);
+      histogramP = *histogramPP;
+    }
+  }
+
+  return histogramP;
+}
+
+
+
+/* ****************************************************************************
+*
+* latencyBucket - the bucket of a latency in microseconds
+*/
+static int latencyBucket(unsigned long long usecs)
+{
+  if (usecs < 4)
+  {
+    return (int) usecs;
+  }
+
+  int msb = 63 - __builtin_clzll(usecs);
+
+  if (msb > 31)
+  {
+    return LATENCY_BUCKETS - 1;
+  }
+
+  return 4 + (msb - 2) * 4 + (int) ((usecs >> (msb - 2)) & 3);
+}
+
+
+
+/* ****************************************************************************
+*
+* latencyAdd -
+*/
+static void latencyAdd(LatencyHistogram* volatile* histogramPP, long long usecs)
+{
+  LatencyHistogram* histogramP = histogramGet(histogramPP);
+
+  if (histogramP == NULL)
+  {
+    return;
+  }
+
+  if (usecs < 0)
+  {
+    usecs = 0;
+  }
+
+  __sync_fetch_and_add(&histogramP->bucketV[latencyBucket(usecs)], 1);
+  __sync_fetch_and_add(&histogramP->count, 1);
+  __sync_fetch_and_add(&histogramP->sum, (unsigned long long) usecs);
+}
+
+
+
+/* ****************************************************************************
+*
+* latencyMerge - add the histogram of a shard to the aggregated one
+*/
+static void latencyMerge(LatencyHistogram* histogramP, const LatencyHistogram* shardHistogramP)
+{
+  if (shardHistogramP == NULL)
+  {
+    return;
+  }
+
+  for (int ix = 0; ix < LATENCY_BUCKETS; ++ix)
+  {
+    histogramP->bucketV[ix] += shardHistogramP->bucketV[ix];
+  }
+
+  histogramP->count += shardHistogramP->count;
+  histogramP->sum   += shardHistogramP->sum;
+}
+
+
+
+/* ****************************************************************************
+*
+* latencyReset -
+*/
+static void latencyReset(LatencyHistogram* histogramP)
+{
+  if (histogramP == NULL)
+  {
+    return;
+  }
+
+  for (int ix = 0; ix < LATENCY_BUCKETS; ++ix)
+  {
+    __sync_fetch_and_and(&histogramP->bucketV[ix], 0);
+  }
+
+  __sync_fetch_and_and(&histogramP->count, 0);
+  __sync_fetch_and_and(&histogramP->sum, 0);
+}
 
 
 
@@ -138,92 +225,251 @@ int noOfPostEntity                                       = -1;
 */
 void statisticsUpdate(RequestType request, Format inFormat)
 {
+  StatisticsShard* shardP = shardGet();
+
   if (inFormat == XML)
   {
-     ++noOfXmlRequests;
-  }
-
-  if (inFormat == JSON)
-  {
-    ++noOfJsonRequests;
-  }
-
-  switch (request)
-  {
-  case RegisterContext:                                  ++noOfRegistrations; break;
-  case DiscoverContextAvailability:                      ++noOfDiscoveries; break;
-  case SubscribeContextAvailability:                     ++noOfAvailabilitySubscriptions; break;
-  case UpdateContextAvailabilitySubscription:            ++noOfAvailabilitySubscriptionUpdates; break;
-  case UnsubscribeContextAvailability:                   ++noOfAvailabilityUnsubscriptions; break;
-  case NotifyContextAvailability:                        ++noOfAvailabilityNotificationsReceived; break;
-
-  case QueryContext:                                     ++noOfQueries; break;
-  case SubscribeContext:                                 ++noOfSubscriptions; break;
-  case UpdateContextSubscription:                        ++noOfSubscriptionUpdates; break;
-  case UnsubscribeContext:                               ++noOfUnsubscriptions; break;
-  case NotifyContext:                                    ++noOfNotificationsReceived; break;
-  case UpdateContext:                                    ++noOfUpdates; break;
-  case RtQueryContextResponse:                           ++noOfQueryContextResponses; break;
-  case RtUpdateContextResponse:                          ++noOfUpdateContextResponses; break;
-
-  case ContextEntitiesByEntityId:                        ++noOfContextEntitiesByEntityId; break;
-  case ContextEntityAttributes:                          ++noOfContextEntityAttributes; break;
-  case EntityByIdAttributeByName:                        ++noOfEntityByIdAttributeByName; break;
-  case ContextEntityTypes:                               ++noOfContextEntityTypes; break;
-  case ContextEntityTypeAttributeContainer:              ++noOfContextEntityTypeAttributeContainer; break;
-  case ContextEntityTypeAttribute:                       ++noOfContextEntityTypeAttribute; break;
-  case IndividualContextEntity:                          ++noOfIndividualContextEntity; break;
-  case IndividualContextEntityAttributes:                ++noOfIndividualContextEntityAttributes; break;
-  case AttributeValueInstance:                           ++noOfAttributeValueInstance; break;
-  case IndividualContextEntityAttribute:                 ++noOfIndividualContextEntityAttribute; break;
-  case Ngsi9SubscriptionsConvOp:                         ++noOfNgsi9SubscriptionsConvOp; break;
-
-  case UpdateContextElement:                             ++noOfUpdateContextElement; break;
-  case AppendContextElement:                             ++noOfAppendContextElement; break;
-  case UpdateContextAttribute:                           ++noOfUpdateContextAttribute; break;
-  case Ngsi10ContextEntityTypes:                         ++noOfNgsi10ContextEntityTypes; break;
-  case Ngsi10ContextEntityTypesAttributeContainer:       ++noOfNgsi10ContextEntityTypesAttributeContainer; break;
-  case Ngsi10ContextEntityTypesAttribute:                ++noOfNgsi10ContextEntityTypesAttribute; break;
-  case Ngsi10SubscriptionsConvOp:                        ++noOfNgsi10SubscriptionsConvOp; break;
-
-  case AllContextEntities:                               ++noOfAllContextEntitiesRequests; break;
-  case AllEntitiesWithTypeAndId:                         ++noOfAllEntitiesWithTypeAndIdRequests; break;
-  case IndividualContextEntityAttributeWithTypeAndId:    ++noOfIndividualContextEntityAttributeWithTypeAndId; break;
-  case AttributeValueInstanceWithTypeAndId:              ++noOfAttributeValueInstanceWithTypeAndId; break;
-  case ContextEntitiesByEntityIdAndType:                 ++noOfContextEntitiesByEntityIdAndType; break;
-  case EntityByIdAttributeByNameIdAndType:               ++noOfEntityByIdAttributeByNameIdAndType; break;
-
-  case LogRequest:                                       ++noOfLogRequests; break;
-  case VersionRequest:                                   ++noOfVersionRequests; break;
-  case ExitRequest:                                      ++noOfExitRequests; break;
-  case LeakRequest:                                      ++noOfLeakRequests; break;
-  case StatisticsRequest:                                ++noOfStatisticsRequests; break;
-
-  case InvalidRequest:                                   ++noOfInvalidRequests; break;
-  case RegisterResponse:                                 ++noOfRegisterResponses; break;
-
-  case RtSubscribeContextAvailabilityResponse:           ++noOfRtSubscribeContextAvailabilityResponse; break;
-  case RtUpdateContextAvailabilitySubscriptionResponse:  ++noOfRtUpdateContextAvailabilitySubscriptionResponse; break;
-  case RtUnsubscribeContextAvailabilityResponse:         ++noOfRtUnsubscribeContextAvailabilityResponse; break;
-  case RtUnsubscribeContextResponse:                     ++noOfRtUnsubscribeContextResponse; break;
-  case RtSubscribeResponse:                              ++noOfRtSubscribeResponse; break;
-  case RtSubscribeError:                                 ++noOfRtSubscribeError; break;
-  case RtContextElementResponse:                         ++noOfContextElementResponse; break;
-  case RtContextAttributeResponse:                       ++noOfContextAttributeResponse; break;
-  case EntityTypes:                                      ++noOfEntityTypesRequest; break;
-  case AttributesForEntityType:                          ++noOfAttributesForEntityTypeRequest; break;
-  case RtEntityTypesResponse:                            ++noOfEntityTypesResponse; break;
-  case RtAttributesForEntityTypeResponse:                ++noOfAttributesForEntityTypeResponse; break;
-
-  case EntitiesRequest:                                  ++noOfEntitiesRequests; break;
-  case EntitiesResponse:                                 ++noOfEntitiesResponses; break;
-  case EntryPointsRequest:                               ++noOfEntryPointsRequests; break;
-  case EntryPointsResponse:                              ++noOfEntryPointsResponses; break;
-  case EntityRequest:                                    ++noOfEntityRequests; break;
-  case EntityResponse:                                   ++noOfEntityResponses; break;
-  case EntityAttributeRequest:                           ++noOfEntityAttributeRequests; break;
-  case EntityAttributeResponse:                          ++noOfEntityAttributeResponses; break;
-
-  case PostEntity:                                       ++noOfPostEntity; break;
+    __sync_fetch_and_add(&shardP->counterV[StatXmlRequests], 1);
+  }
+  else if (inFormat == JSON)
+  {
+    __sync_fetch_and_add(&shardP->counterV[StatJsonRequests], 1);
+  }
+
+  if ((request >= 0) && (request < STATISTICS_REQUEST_TYPES))
+  {
+    __sync_fetch_and_add(&shardP->requestV[request], 1);
   }
 }
+
+
+
+/* ****************************************************************************
+*
+* statisticsCount - 
+*/
+void statisticsCount(StatisticsCounter counter)
+{
+  __sync_fetch_and_add(&shardGet()->counterV[counter], 1);
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsUsecsGet - 
+*/
+long long statisticsUsecsGet(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsLatencyAdd - 
+*/
+void statisticsLatencyAdd(RequestType request, long long usecs)
+{
+  if ((request >= 0) && (request < STATISTICS_REQUEST_TYPES))
+  {
+    latencyAdd(&shardGet()->latencyV[request], usecs);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsBackendLatencyAdd - 
+*/
+void statisticsBackendLatencyAdd(BackendOperation operation, long long usecs)
+{
+  latencyAdd(&shardGet()->backendLatencyV[operation], usecs);
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsRequestsGet - 
+*/
+unsigned long statisticsRequestsGet(RequestType request)
+{
+  unsigned long requests = 0;
+
+  for (int ix = 0; ix < STATISTICS_SHARDS; ++ix)
+  {
+    requests += shardV[ix].requestV[request];
+  }
+
+  return requests;
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsCounterGet - 
+*/
+unsigned long statisticsCounterGet(StatisticsCounter counter)
+{
+  unsigned long value = 0;
+
+  for (int ix = 0; ix < STATISTICS_SHARDS; ++ix)
+  {
+    value += shardV[ix].counterV[counter];
+  }
+
+  return value;
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsLatencyGet - 
+*/
+bool statisticsLatencyGet(RequestType request, LatencyHistogram* histogramP)
+{
+  memset(histogramP, 0, sizeof(LatencyHistogram));
+
+  for (int ix = 0; ix < STATISTICS_SHARDS; ++ix)
+  {
+    latencyMerge(histogramP, shardV[ix].latencyV[request]);
+  }
+
+  return histogramP->count != 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsBackendLatencyGet - 
+*/
+bool statisticsBackendLatencyGet(BackendOperation operation, LatencyHistogram* histogramP)
+{
+  memset(histogramP, 0, sizeof(LatencyHistogram));
+
+  for (int ix = 0; ix < STATISTICS_SHARDS; ++ix)
+  {
+    latencyMerge(histogramP, shardV[ix].backendLatencyV[operation]);
+  }
+
+  return histogramP->count != 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* statisticsReset - 
+*
+* The counters are zeroed in place (the histograms are kept allocated), as other
+* threads may be updating them at the same time.
+*/
+void statisticsReset(void)
+{
+  for (int ix = 0; ix < STATISTICS_SHARDS; ++ix)
+  {
+    StatisticsShard* shardP = &shardV[ix];
+
+    for (int rIx = 0; rIx < STATISTICS_REQUEST_TYPES; ++rIx)
+    {
+      __sync_fetch_and_and(&shardP->requestV[rIx], 0);
+      latencyReset(shardP->latencyV[rIx]);
+    }
+
+    for (int cIx = 0; cIx < StatCounters; ++cIx)
+    {
+      __sync_fetch_and_and(&shardP->counterV[cIx], 0);
+    }
+
+    for (int oIx = 0; oIx < BackendOperations; ++oIx)
+    {
+      latencyReset(shardP->backendLatencyV[oIx]);
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* backendOperationName - 
+*/
+const char* backendOperationName(BackendOperation operation)
+{
+  return backendOperationNameV[operation];
+}
+
+
+
+/* ****************************************************************************
+*
+* latencyBucketLimit - 
+*/
+unsigned long long latencyBucketLimit(int bucket)
+{
+  if (bucket < 4)
+  {
+    return bucket + 1;
+  }
+
+  int octave = (bucket - 4) / 4;
+  int sub    = (bucket - 4) % 4;
+
+  return (unsigned long long) (5 + sub) << octave;
+}
+
+
+
+/* ****************************************************************************
+*
+* latencyPercentile - 
+*/
+unsigned long long latencyPercentile(const LatencyHistogram* histogramP, double percentile)
+{
+  unsigned long  wanted = (unsigned long) (histogramP->count * percentile / 100);
+  unsigned long  seen   = 0;
+
+  for (int ix = 0; ix < LATENCY_BUCKETS; ++ix)
+  {
+    seen += histogramP->bucketV[ix];
+
+    if ((seen > wanted) || ((seen == histogramP->count) && (seen != 0)))
+    {
+      return latencyBucketLimit(ix);
+    }
+  }
+
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* BackendTimer::BackendTimer - 
+*/
+BackendTimer::BackendTimer(BackendOperation _operation)
+{
+  operation = _operation;
+  start     = statisticsUsecsGet();
+}
+
+
+
+/* ****************************************************************************
+*
+* BackendTimer::~BackendTimer - 
+*/
+BackendTimer::~BackendTimer()
+{
+  statisticsBackendLatencyAdd(operation, statisticsUsecsGet() - start);
+}
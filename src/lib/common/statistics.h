@@ -32,77 +32,88 @@
 
 /* ****************************************************************************
 *
-* Statistic counters for NGSI REST requests
-*/
-extern int noOfJsonRequests;
-extern int noOfXmlRequests;
-extern int noOfRegistrations;
-extern int noOfRegistrationErrors;
-extern int noOfRegistrationUpdates;
-extern int noOfRegistrationUpdateErrors;
-extern int noOfDiscoveries;
-extern int noOfDiscoveryErrors;
-extern int noOfAvailabilitySubscriptions;
-extern int noOfAvailabilitySubscriptionErrors;
-extern int noOfAvailabilityUnsubscriptions;
-extern int noOfAvailabilityUnsubscriptionErrors;
-extern int noOfAvailabilitySubscriptionUpdates;
-extern int noOfAvailabilitySubscriptionUpdateErrors;
-extern int noOfAvailabilityNotificationsReceived;
-extern int noOfAvailabilityNotificationsSent;
-
-extern int noOfQueries;
-extern int noOfQueryErrors;
-extern int noOfUpdates;
-extern int noOfUpdateErrors;
-extern int noOfSubscriptions;
-extern int noOfSubscriptionErrors;
-extern int noOfSubscriptionUpdates;
-extern int noOfSubscriptionUpdateErrors;
-extern int noOfUnsubscriptions;
-extern int noOfUnsubscriptionErrors;
-extern int noOfNotificationsReceived;
-extern int noOfNotificationsSent;
-extern int noOfQueryContextResponses;
-extern int noOfUpdateContextResponses;
-extern int noOfContextEntitiesByEntityId;
-extern int noOfContextEntityAttributes;
-extern int noOfEntityByIdAttributeByName;
-extern int noOfContextEntityTypes;
-extern int noOfContextEntityTypeAttributeContainer;
-extern int noOfContextEntityTypeAttribute;
-extern int noOfIndividualContextEntity;
-extern int noOfIndividualContextEntityAttributes;
-extern int noOfAttributeValueInstance;
-extern int noOfIndividualContextEntityAttribute;
-extern int noOfUpdateContextElement;
-extern int noOfAppendContextElement;
-extern int noOfUpdateContextAttribute;
-extern int noOfNgsi10ContextEntityTypes;
-extern int noOfNgsi10ContextEntityTypesAttributeContainer;
-extern int noOfNgsi10ContextEntityTypesAttribute;
-extern int noOfNgsi10SubscriptionsConvOp;
-extern int noOfAllContextEntitiesRequests;
-extern int noOfAllEntitiesWithTypeAndIdRequests;
-extern int noOfIndividualContextEntityAttributeWithTypeAndId;
-extern int noOfAttributeValueInstanceWithTypeAndId;
-extern int noOfContextEntitiesByEntityIdAndType;
-extern int noOfEntityByIdAttributeByNameIdAndType;
-
-extern int noOfLogRequests;
-extern int noOfVersionRequests;
-extern int noOfExitRequests;
-extern int noOfLeakRequests;
-extern int noOfStatisticsRequests;
-extern int noOfInvalidRequests;
-extern int noOfRegisterResponses;
-
-extern int noOfRtSubscribeContextAvailabilityResponse;
-extern int noOfRtUpdateContextAvailabilitySubscriptionResponse;
-extern int noOfRtUnsubscribeContextAvailabilityResponse;
-extern int noOfRtUnsubscribeContextResponse;
-extern int noOfRtSubscribeResponse;
-extern int noOfRtSubscribeError;
+* STATISTICS_SHARDS -
+*
+* The counters are spread in shards, each thread using always the same one, so that
+* the threads serving requests don't share the cache lines of the counters. A thread
+* per shard can't be used, as threads come and go in the thread-per-connection mode.
+*/
+#define STATISTICS_SHARDS  16
+
+
+
+/* ****************************************************************************
+*
+* STATISTICS_REQUEST_TYPES - size of the vectors indexed by RequestType
+*/
+#define STATISTICS_REQUEST_TYPES  (InvalidRequest + 1)
+
+
+
+/* ****************************************************************************
+*
+* StatisticsCounter - counters that are not the number of requests of some type
+*/
+typedef enum StatisticsCounter
+{
+  StatXmlRequests = 0,
+  StatJsonRequests,
+  StatRegistrationErrors,
+  StatRegistrationUpdateErrors,
+  StatDiscoveryErrors,
+  StatCounters
+} StatisticsCounter;
+
+
+
+/* ****************************************************************************
+*
+* BackendOperation - operations of mongoBackend whose latency is measured
+*/
+typedef enum BackendOperation
+{
+  BoQueryContext = 0,
+  BoUpdateContext,
+  BoSubscribeContext,
+  BoUpdateContextSubscription,
+  BoUnsubscribeContext,
+  BoNotifyContext,
+  BoRegisterContext,
+  BoDiscoverContextAvailability,
+  BoSubscribeContextAvailability,
+  BoUpdateContextAvailabilitySubscription,
+  BoUnsubscribeContextAvailability,
+  BoNotifyContextAvailability,
+  BoEntityTypes,
+  BoAttributesForEntityType,
+  BoGetContextElementResponses,
+  BackendOperations
+} BackendOperation;
+
+
+
+/* ****************************************************************************
+*
+* LATENCY_BUCKETS -
+*
+* Latencies are kept in microseconds, in log-linear buckets (HDR style): values under 4
+* have a bucket each, and every power of two from 4 on is split in 4 buckets, which
+* keeps the error under 25%, up to 2^32 microseconds (the last bucket takes the rest).
+*/
+#define LATENCY_BUCKETS  124
+
+
+
+/* ****************************************************************************
+*
+* LatencyHistogram -
+*/
+typedef struct LatencyHistogram
+{
+  unsigned long       bucketV[LATENCY_BUCKETS];
+  unsigned long       count;
+  unsigned long long  sum;    // microseconds
+} LatencyHistogram;
 
 
 
@@ -112,4 +123,120 @@ extern int noOfRtSubscribeError;
 */
 extern void statisticsUpdate(RequestType request, Format inFormat);
 
+
+
+/* ****************************************************************************
+*
+* statisticsCount - 
+*/
+extern void statisticsCount(StatisticsCounter counter);
+
+
+
+/* ****************************************************************************
+*
+* statisticsUsecsGet - monotonic clock in microseconds, to measure latencies
+*/
+extern long long statisticsUsecsGet(void);
+
+
+
+/* ****************************************************************************
+*
+* statisticsLatencyAdd - 
+*/
+extern void statisticsLatencyAdd(RequestType request, long long usecs);
+
+
+
+/* ****************************************************************************
+*
+* statisticsBackendLatencyAdd - 
+*/
+extern void statisticsBackendLatencyAdd(BackendOperation operation, long long usecs);
+
+
+
+/* ****************************************************************************
+*
+* statisticsRequestsGet - number of requests of a type since the last reset
+*/
+extern unsigned long statisticsRequestsGet(RequestType request);
+
+
+
+/* ****************************************************************************
+*
+* statisticsCounterGet - 
+*/
+extern unsigned long statisticsCounterGet(StatisticsCounter counter);
+
+
+
+/* ****************************************************************************
+*
+* statisticsLatencyGet - latency of the requests of a type, false if there is none since the last reset
+*/
+extern bool statisticsLatencyGet(RequestType request, LatencyHistogram* histogramP);
+
+
+
+/* ****************************************************************************
+*
+* statisticsBackendLatencyGet - 
+*/
+extern bool statisticsBackendLatencyGet(BackendOperation operation, LatencyHistogram* histogramP);
+
+
+
+/* ****************************************************************************
+*
+* statisticsReset - 
+*/
+extern void statisticsReset(void);
+
+
+
+/* ****************************************************************************
+*
+* backendOperationName - 
+*/
+extern const char* backendOperationName(BackendOperation operation);
+
+
+
+/* ****************************************************************************
+*
+* latencyBucketLimit - upper limit (not included) of a bucket, in microseconds
+*/
+extern unsigned long long latencyBucketLimit(int bucket);
+
+
+
+/* ****************************************************************************
+*
+* latencyPercentile - upper limit of the bucket of a percentile (0-100), in microseconds
+*/
+extern unsigned long long latencyPercentile(const LatencyHistogram* histogramP, double percentile);
+
+
+
+/* ****************************************************************************
+*
+* BackendTimer -
+*
+* Measures the latency of a mongoBackend operation, from its construction to its
+* destruction, so that every return path of the operation is taken into account.
+*/
+class BackendTimer
+{
+ public:
+  explicit BackendTimer(BackendOperation _operation);
+  ~BackendTimer();
+
+ private:
+  BackendOperation  operation;
+  long long         start;
+};
+
 #endif  // SRC_LIB_COMMON_STATISTICS_H_
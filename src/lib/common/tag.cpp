@@ -33,120 +33,67 @@
 
 /* ****************************************************************************
 *
-* htmlEscape - 
-*
-* Allocate a new buffer to hold an escaped version of the input buffer 's'.
-* Escaping characters demands more space in the buffer, for some characters up to six
-* characters - double-quote (") needs SIX chars: &quot;
-* So, when allocating room for the output (escaped) buffer, we need to consider the worst case
-* and six times the length of the input buffer is allocated (plus one byte for the zero-termination.
+* htmlEscapeOf - the escape sequence of a character, NULL if it is not escaped
 *
 * See http://www.anglesanddangles.com/asciichart.php for more info on the 'html-escpaing' of ASCII chars.
 */
-char* htmlEscape(const char* s)
+static inline const char* htmlEscapeOf(char c)
 {
-  int   newLen  = strlen(s) * 6 + 1;  // See function header comment
-  char* out     = (char*) calloc(1, newLen);
-  int   sIx     = 0;
-  int   outIx   = 0;
-  
-  if (out == NULL)
+  switch (c)
   {
-    LM_E(("Internal Error (allocating %d bytes: %s)", newLen, strerror(errno)));
-    return NULL;
+  case '<':   return "&lt;";
+  case '>':   return "&gt;";
+  case '(':   return "&#40;";
+  case ')':   return "&#41;";
+  case '=':   return "&#61;";
+  case '\'':  return "&#39;";
+  case '"':   return "&quot;";
+  case ';':   return "&#59;";
   }
 
-  while (s[sIx] != 0)
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* htmlEscape - 
+*
+* Append an escaped version of 's' to 'out'.
+* The runs of characters that need no escaping are appended in one go, so no
+* intermediate buffer is needed and, once 'out' has grown, nothing is allocated.
+*/
+void htmlEscape(std::string& out, const char* s)
+{
+  const char* runStart = s;
+
+  while (*s != 0)
   {
-    switch (s[sIx])
+    const char* escaped = htmlEscapeOf(*s);
+
+    if (escaped != NULL)
     {
-    case '<':
-      out[outIx++] = '&';
-      out[outIx++] = 'l';
-      out[outIx++] = 't';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    case '>':
-      out[outIx++] = '&';
-      out[outIx++] = 'g';
-      out[outIx++] = 't';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    case '(':
-      out[outIx++] = '&';
-      out[outIx++] = '#';
-      out[outIx++] = '4';
-      out[outIx++] = '0';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    case ')':
-      out[outIx++] = '&';
-      out[outIx++] = '#';
-      out[outIx++] = '4';
-      out[outIx++] = '1';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    case '=':
-      out[outIx++] = '&';
-      out[outIx++] = '#';
-      out[outIx++] = '6';
-      out[outIx++] = '1';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    case '\'':
-      out[outIx++] = '&';
-      out[outIx++] = '#';
-      out[outIx++] = '3';
-      out[outIx++] = '9';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    case '"':
-      out[outIx++] = '&';
-      out[outIx++] = 'q';
-      out[outIx++] = 'u';
-      out[outIx++] = 'o';
-      out[outIx++] = 't';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    case ';':
-      out[outIx++] = '&';
-      out[outIx++] = '#';
-      out[outIx++] = '5';
-      out[outIx++] = '9';
-      out[outIx++] = ';';
-      ++sIx;
-      break;
-
-    default:
-      out[outIx++] = s[sIx++];
+      out.append(runStart, s - runStart);
+      out += escaped;
+      runStart = s + 1;
     }
+
+    ++s;
   }
 
-  return out;
+  out.append(runStart, s - runStart);
 }
 
 
 
 /* ****************************************************************************
 *
-* startTag -  
+* startTagAppend -  
 */
-std::string startTag
+void startTagAppend
 (
+  std::string&        out,
   const std::string&  indent,
   const std::string&  tagName,
   Format              format,
@@ -156,45 +103,51 @@ std::string startTag
 {
   if (format == XML)
   {
-    return indent + "<" + tagName + ">\n";
+    out += indent;
+    out += '<';
+    out += tagName;
+    out += ">\n";
   }
   else if (format == JSON)
   {
     if (isToplevel)
     {
-      if (showTag == false)
-      {
-        return indent + "{\n" + indent + "  {\n";
-      }
-      else
-      {
-        return indent + "{\n" + indent + "  " + "\"" + tagName + "\" : {\n";
-      }
+      out += indent;
+      out += "{\n";
+      out += indent;
+      out += "  ";
     }
     else
     {
-      if (showTag == false)
-      {
-        return indent + "{\n";
-      }
-      else
-      {
-        return indent + "\"" + tagName + "\" : {\n";
-      }
+      out += indent;
     }
-  }
 
-  return "Format not supported";
+    if (showTag == false)
+    {
+      out += "{\n";
+    }
+    else
+    {
+      out += '"';
+      out += tagName;
+      out += "\" : {\n";
+    }
+  }
+  else
+  {
+    out += "Format not supported";
+  }
 }
 
 
 
 /* ****************************************************************************
 *
-* startTag -  
+* startTagAppend -  
 */
-std::string startTag
+void startTagAppend
 (
+  std::string&        out,
   const std::string&  indent,
   const std::string&  xmlTag,
   const std::string&  jsonTag,
@@ -206,44 +159,39 @@ std::string startTag
 {
   if (format == XML)
   {
-    if (isCompoundVector)
-    {
-      return indent + "<" + xmlTag + " type=\"vector\">\n";
-    }
-
-    return indent + "<" + xmlTag + ">\n";
+    out += indent;
+    out += '<';
+    out += xmlTag;
+    out += (isCompoundVector)? " type=\"vector\">\n" : ">\n";
   }
   else if (format == JSON)
   {
-    if (isVector && showTag)
-    {
-       return indent + "\"" + jsonTag + "\" : [\n";
-    }
-    else if (isVector && !showTag)
-    {
-      return indent + "[\n";
-    }
-    else if (!isVector && showTag)
-    {
-      return indent + "\"" + jsonTag + "\" : {\n";
-    }
-    else if (!isVector && !showTag)
+    out += indent;
+
+    if (showTag)
     {
-      return indent + "{\n";
+      out += '"';
+      out += jsonTag;
+      out += "\" : ";
     }
-  }
 
-  return "Format not supported";
+    out += (isVector)? "[\n" : "{\n";
+  }
+  else
+  {
+    out += "Format not supported";
+  }
 }
 
 
 
 /* ****************************************************************************
 *
-* endTag -  
+* endTagAppend -  
 */
-std::string endTag
+void endTagAppend
 (
+  std::string&        out,
   const std::string&  indent,
   const std::string&  tagName,
   Format              format,
@@ -253,38 +201,48 @@ std::string endTag
   bool                isToplevel
 )
 {
+  out += indent;
+
   if (format == XML)
   {
-    return indent + "</" + tagName + ">\n";
+    out += "</";
+    out += tagName;
+    out += ">\n";
+    return;
   }
 
   if (isToplevel)
   {
-    return indent + "}\n}\n";
+    out += "}\n}\n";
+    return;
   }
 
-  std::string out = indent;
+  out += isVector?    ']'  : '}';
 
-  out += isVector?    "]"  : "}";
-  out += comma?       ","  : "";
-  out += nl?          "\n" : "";
-  out += isToplevel?  "}"  : "";
+  if (comma)
+  {
+    out += ',';
+  }
 
-  return out;
+  if (nl)
+  {
+    out += '\n';
+  }
 }
 
 
 
 /* ****************************************************************************
 *
-* valueTag -  
+* valueTagAppend -  
 *
 * NOTE
 * The value of the tag is not HTML-escaped if the value is an Association.
 * In the case of Associations, the specific values must be HTML-escaped instead.
 */
-std::string valueTag
+void valueTagAppend
 (
+  std::string&        out,
   const std::string&  indent,
   const std::string&  tagName,
   const std::string&  unescapedValue,
@@ -294,97 +252,65 @@ std::string valueTag
   bool                isVectorElement
 )
 {
-  char* value;
+  out += indent;
 
-  if (unescapedValue == "")
+  if (format == XML)
   {
-    value = (char*) malloc(1);
-
-    *value = 0;
+    out += '<';
+    out += tagName;
+    out += '>';
   }
-  else
+  else if (isAssociation == true)
   {
-    if (isAssociation == false)
-    {
-      value = htmlEscape(unescapedValue.c_str());
-    }
-    else
-    {
-      // unnecessary malloc, but this way I can always free => easier to read
-      value = strdup(unescapedValue.c_str());
-    }
+    out += '"';
+    out += tagName;
+    out += "\" : ";
   }
-
-  if (value == NULL)
+  else if (isVectorElement == true)
   {
-    return "ERROR: no memory";
+    out += '"';
   }
-
-  if (format == XML)
+  else
   {
-    std::string out = indent + "<" + tagName + ">" + value + "</" + tagName + ">" + "\n";
-
-    free(value);
-    return out;
+    out += '"';
+    out += tagName;
+    out += "\" : \"";
   }
 
-  if (showComma == true)
+  if (isAssociation == true)
   {
-    if (isAssociation == true)
-    {
-      std::string out = indent + "\"" + tagName + "\" : " + value + ",\n";
-
-      free(value);
-      return out;
-    }
-    else if (isVectorElement == true)
-    {
-      std::string out = indent + "\"" + value + "\",\n";
-
-      free(value);
-      return out;
-    }
-    else
-    {
-      std::string out = indent + "\"" + tagName + "\" : \"" + value + "\",\n";
-
-      free(value);
-      return out;
-    }
+    out += unescapedValue;
   }
   else
   {
-    if (isAssociation == true)
-    {
-      std::string out = indent + "\"" + tagName + "\" : " + value + "\n";
-
-      free(value);
-      return out;
-    }
-    else if (isVectorElement == true)
-    {
-      std::string out = indent + "\"" + value + "\"\n";
+    htmlEscape(out, unescapedValue.c_str());
+  }
 
-      free(value);
-      return out;
-    }
-    else
-    {
-      std::string out = indent + "\"" + tagName + "\" : \"" + value + "\"\n";
+  if (format == XML)
+  {
+    out += "</";
+    out += tagName;
+    out += ">\n";
+    return;
+  }
 
-      free(value);
-      return out;
-    }
+  if (isAssociation == false)
+  {
+    out += '"';
   }
+
+  out += (showComma == true)? ",\n" : "\n";
 }
 
 
+
 /* ****************************************************************************
 *
-* valueTag -  
+* valueTagAppend -  
 */
-std::string valueTag
+void valueTagAppend
 (
+  std::string&        out,
   const std::string&  indent,
   const std::string&  tagName,
   int                 value,
@@ -397,27 +323,36 @@ std::string valueTag
 
   snprintf(val, sizeof(val), "%d", value);
 
-  if (format == XML)
-  {
-    return indent + "<" + tagName + ">" + val + "</" + tagName + ">" + "\n";
-  }
+  out += indent;
 
-  if (showComma == true)
+  if (format == XML)
   {
-    return indent + "\"" + tagName + "\" : \"" + val + "\",\n";
+    out += '<';
+    out += tagName;
+    out += '>';
+    out += val;
+    out += "</";
+    out += tagName;
+    out += ">\n";
+    return;
   }
 
-  return indent + "\"" + tagName + "\" : \"" + val + "\"\n";
+  out += '"';
+  out += tagName;
+  out += "\" : \"";
+  out += val;
+  out += (showComma == true)? "\",\n" : "\"\n";
 }
 
 
 
 /* ****************************************************************************
 *
-* valueTag -  
+* valueTagAppend -  
 */
-std::string valueTag
+void valueTagAppend
 (
+  std::string&        out,
   const std::string&  indent,
   const std::string&  xmlTag,
   const std::string&  jsonTag,
@@ -427,27 +362,163 @@ std::string valueTag
   bool                isAssociation
 )
 {
+  out += indent;
+
   if (format == XML)
   {
-    return indent + "<" + xmlTag + ">" + value + "</" + xmlTag + ">" + "\n";
+    out += '<';
+    out += xmlTag;
+    out += '>';
+    out += value;
+    out += "</";
+    out += xmlTag;
+    out += ">\n";
+    return;
   }
 
-  if (jsonTag == "")
-  {
-    if (showComma == true)
-    {
-      return indent + "\"" + value + "\",\n";
-    }
-    else
-    {
-      return indent + "\"" + value + "\"\n";
-    }
-  }
+  out += '"';
 
-  if (showComma == true)
+  if (jsonTag != "")
   {
-    return indent + "\"" + jsonTag + "\" : \"" + value + "\",\n";
+    out += jsonTag;
+    out += "\" : \"";
   }
 
-  return indent + "\"" + jsonTag + "\" : \"" + value + "\"\n";
+  out += value;
+  out += (showComma == true)? "\",\n" : "\"\n";
+}
+
+
+
+/* ****************************************************************************
+*
+* startTag -  
+*/
+std::string startTag
+(
+  const std::string&  indent,
+  const std::string&  tagName,
+  Format              format,
+  bool                showTag,
+  bool                isToplevel
+)
+{
+  std::string out;
+
+  startTagAppend(out, indent, tagName, format, showTag, isToplevel);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* startTag -  
+*/
+std::string startTag
+(
+  const std::string&  indent,
+  const std::string&  xmlTag,
+  const std::string&  jsonTag,
+  Format              format,
+  bool                isVector,
+  bool                showTag,
+  bool                isCompoundVector
+)
+{
+  std::string out;
+
+  startTagAppend(out, indent, xmlTag, jsonTag, format, isVector, showTag, isCompoundVector);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* endTag -  
+*/
+std::string endTag
+(
+  const std::string&  indent,
+  const std::string&  tagName,
+  Format              format,
+  bool                comma,
+  bool                isVector,
+  bool                nl,
+  bool                isToplevel
+)
+{
+  std::string out;
+
+  endTagAppend(out, indent, tagName, format, comma, isVector, nl, isToplevel);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* valueTag -  
+*/
+std::string valueTag
+(
+  const std::string&  indent,
+  const std::string&  tagName,
+  const std::string&  unescapedValue,
+  Format              format,
+  bool                showComma,
+  bool                isAssociation,
+  bool                isVectorElement
+)
+{
+  std::string out;
+
+  valueTagAppend(out, indent, tagName, unescapedValue, format, showComma, isAssociation, isVectorElement);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* valueTag -  
+*/
+std::string valueTag
+(
+  const std::string&  indent,
+  const std::string&  tagName,
+  int                 value,
+  Format              format,
+  bool                showComma,
+  bool                isAssociation
+)
+{
+  std::string out;
+
+  valueTagAppend(out, indent, tagName, value, format, showComma, isAssociation);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* valueTag -  
+*/
+std::string valueTag
+(
+  const std::string&  indent,
+  const std::string&  xmlTag,
+  const std::string&  jsonTag,
+  const std::string&  value,
+  Format              format,
+  bool                showComma,
+  bool                isAssociation
+)
+{
+  std::string out;
+
+  valueTagAppend(out, indent, xmlTag, jsonTag, value, format, showComma, isAssociation);
+  return out;
 }
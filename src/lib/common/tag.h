@@ -48,9 +48,9 @@
 
 /* ****************************************************************************
 *
-* htmlEscape - 
+* htmlEscape - append the HTML-escaped version of 's' to 'out'
 */
-extern char* htmlEscape(const char* s);
+extern void htmlEscape(std::string& out, const char* s);
 
 
 
@@ -135,6 +135,85 @@ extern std::string valueTag
 
 
 
+/* ****************************************************************************
+*
+* startTagAppend, endTagAppend, valueTagAppend -
+*
+* Same as startTag, endTag and valueTag, but the output is appended to 'out' instead
+* of being returned in a new string. Used by the render functions that pass one output
+* buffer down the tree.
+*/
+extern void startTagAppend
+(
+  std::string&        out,
+  const std::string&  indent,
+  const std::string&  tagName,
+  Format              format,
+  bool                showTag    = true,
+  bool                isToplevel = false
+);
+
+extern void startTagAppend
+(
+  std::string&        out,
+  const std::string&  indent,
+  const std::string&  xmlTag,
+  const std::string&  jsonTag,
+  Format              format,
+  bool                isVector         = false,
+  bool                showTag          = true,
+  bool                isCompoundVector = false
+);
+
+extern void endTagAppend
+(
+  std::string&        out,
+  const std::string&  indent,
+  const std::string&  tagName,
+  Format              format,
+  bool                comma      = false,
+  bool                isVector   = false,
+  bool                nl         = true,
+  bool                isToplevel = false
+);
+
+extern void valueTagAppend
+(
+  std::string&        out,
+  const std::string&  indent,
+  const std::string&  tagName,
+  const std::string&  value,
+  Format              format,
+  bool                showComma       = false,
+  bool                isAssociation   = false,
+  bool                isVectorElement = false
+);
+
+extern void valueTagAppend
+(
+  std::string&        out,
+  const std::string&  indent,
+  const std::string&  tagName,
+  int                 value,
+  Format              format,
+  bool                showComma     = false,
+  bool                isAssociation = false
+);
+
+extern void valueTagAppend
+(
+  std::string&        out,
+  const std::string&  indent,
+  const std::string&  xmlTag,
+  const std::string&  jsonTag,
+  const std::string&  value,
+  Format              format,
+  bool                showComma     = false,
+  bool                isAssociation = false
+);
+
+
+
 /* ****************************************************************************
 *
 * startArray -
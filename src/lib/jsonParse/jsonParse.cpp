@@ -22,24 +22,18 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <pthread.h>
 
-//
-// http://www.boost.org/doc/libs/1_31_0/libs/spirit/doc/grammar.html:
-//
-//  if a grammar is intended to be used in multithreaded code, we should then define
-//  BOOST_SPIRIT_THREADSAFE before including any spirit header files.
-//  In this case it will also be required to link against Boost.Threads
-//
-#define BOOST_SPIRIT_THREADSAFE
+#include "rapidjson/reader.h"
+#include "rapidjson/error/en.h"
 
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/foreach.hpp>
-
-#include <set>
+#include <map>
 #include <string>
-#include <exception>
+#include <vector>
+#include <stdexcept>
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
@@ -54,8 +48,6 @@
 #include "jsonParse/JsonNode.h"
 #include "jsonParse/jsonParse.h"
 
-using boost::property_tree::ptree;
-
 
 
 /* ****************************************************************************
@@ -107,6 +99,96 @@ static bool isCompoundPath(const char* path)
 
 
 
+/* ****************************************************************************
+*
+* JsonPathTable -
+*
+* Lookup table from path to index in a parse vector, built the first time a parse vector
+* is used and kept until the broker exits. The tables are kept in a list that is only ever
+* prepended to (under pathTableMutex), so that lookups can walk it without the mutex.
+*/
+typedef struct JsonPathTable
+{
+  JsonNode*                   parseVector;
+  std::map<std::string, int>  pathMap;
+  bool                        empty;
+  JsonPathTable*              next;
+} JsonPathTable;
+
+static JsonPathTable* volatile  pathTableList  = NULL;
+static pthread_mutex_t          pathTableMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/* ****************************************************************************
+*
+* pathTableLookup -
+*/
+static JsonPathTable* pathTableLookup(JsonNode* parseVector)
+{
+  for (JsonPathTable* tableP = pathTableList; tableP != NULL; tableP = tableP->next)
+  {
+    if (tableP->parseVector == parseVector)
+    {
+      return tableP;
+    }
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* pathTableGet -
+*/
+static JsonPathTable* pathTableGet(JsonNode* parseVector)
+{
+  JsonPathTable* tableP;
+
+  if ((tableP = pathTableLookup(parseVector)) != NULL)
+  {
+    return tableP;
+  }
+
+  pthread_mutex_lock(&pathTableMutex);
+
+  if ((tableP = pathTableLookup(parseVector)) != NULL)
+  {
+    pthread_mutex_unlock(&pathTableMutex);
+    return tableP;
+  }
+
+  tableP = new JsonPathTable();
+  tableP->parseVector = parseVector;
+  tableP->empty       = true;
+
+  for (unsigned int ix = 0; parseVector[ix].path != "LAST"; ++ix)
+  {
+    tableP->empty = false;
+
+    // If a path is repeated in the parse vector, the first one is used
+    if (tableP->pathMap.find(parseVector[ix].path) == tableP->pathMap.end())
+    {
+      tableP->pathMap[parseVector[ix].path] = ix;
+    }
+  }
+
+  //
+  // The table must be complete before it is visible to lock-free readers in pathTableLookup
+  //
+  tableP->next = pathTableList;
+  __sync_synchronize();
+  pathTableList = tableP;
+
+  pthread_mutex_unlock(&pathTableMutex);
+
+  return tableP;
+}
+
+
+
 /* ****************************************************************************
 *
 * treat -
@@ -116,38 +198,41 @@ static bool treat
   ConnectionInfo*     ciP,
   const std::string&  path,
   const std::string&  value,
-  JsonNode*           parseVector,
+  JsonPathTable*      tableP,
   ParseData*          parseDataP
 )
 {
   LM_T(LmtTreat, ("Treating path '%s', value '%s'", path.c_str(), value.c_str()));
 
-  for (unsigned int ix = 0; parseVector[ix].path != "LAST"; ++ix)
+  if (tableP->empty)
   {
-    //
-    // Before treating a node, a check is made that the value of the node has no forbidden
-    // characters.
-    // However, if the the node has attributes, then the values of the attributes are checked instead
-    //
-    if (forbiddenChars(value.c_str()) == true)
-    {
-      LM_W(("Bad Input (found a forbidden value in '%s')", value.c_str()));
-      ciP->httpStatusCode = SccBadRequest;
-      ciP->answer = std::string("Illegal value for JSON field");
-      return false;
-    }
+    return false;
+  }
 
-    if (path == parseVector[ix].path)
-    {
-      LM_T(LmtTreat, ("calling treat function for '%s': '%s'", path.c_str(), value.c_str()));
-      std::string res = parseVector[ix].treat(path, value, parseDataP);
-      LM_T(LmtTreat, ("called treat function for '%s'. result: '%s'", path.c_str(), res.c_str()));
+  //
+  // Before treating a node, a check is made that the value of the node has no forbidden
+  // characters.
+  //
+  if (forbiddenChars(value.c_str()) == true)
+  {
+    LM_W(("Bad Input (found a forbidden value in '%s')", value.c_str()));
+    ciP->httpStatusCode = SccBadRequest;
+    ciP->answer = std::string("Illegal value for JSON field");
+    return false;
+  }
 
-      return true;
-    }
+  std::map<std::string, int>::const_iterator it = tableP->pathMap.find(path);
+
+  if (it == tableP->pathMap.end())
+  {
+    return false;
   }
 
-  return false;
+  LM_T(LmtTreat, ("calling treat function for '%s': '%s'", path.c_str(), value.c_str()));
+  std::string res = tableP->parseVector[it->second].treat(path, value, parseDataP);
+  LM_T(LmtTreat, ("called treat function for '%s'. result: '%s'", path.c_str(), res.c_str()));
+
+  return true;
 }
 
 
@@ -179,210 +264,438 @@ static std::string getArrayElementName(const std::string& arrayName)
 
 /* ****************************************************************************
 *
-* nodeType -
+* JsonFrameType -
+*
+* JftTree                 - object/array outside compound values, its children are matched against the parse vector
+* JftCompoundPending      - object/array in a compound path, not known yet whether it has children (then it is a compound value)
+* JftCompound             - object/array inside a compound value
+* JftCompoundItemPending  - name-less object/array inside a compound value, not known yet whether it has children
+*/
+typedef enum JsonFrameType
+{
+  JftTree,
+  JftCompoundPending,
+  JftCompound,
+  JftCompoundItemPending
+} JsonFrameType;
+
+
+
+/* ****************************************************************************
+*
+* JsonFrame - an open object/array
+*
+* 'pathLen' is the length of the path before the object/array was entered.
+* For JftCompoundItemPending, 'containerP' is the container of the item, not the item.
+*/
+typedef struct JsonFrame
+{
+  JsonFrameType               type;
+  bool                        isArray;
+  size_t                      pathLen;
+  std::string                 arrayElementName;
+  bool                        treated;
+  bool                        compoundRoot;
+  orion::CompoundValueNode*   containerP;
+} JsonFrame;
+
+
+
+/* ****************************************************************************
+*
+* JsonSaxHandler -
+*
+* Receives the events of the rapidjson SAX parser and calls the treat functions of the
+* parse vector as the nodes arrive, instead of building a tree of the payload first.
+*
+* Every value is given to the treat functions as the text it had in the payload (numbers
+* included, and 'true', 'false' and 'null' for the literals), an object or array being
+* a node with an empty value, followed by its children.
+*
+* Errors don't stop the parser, the rest of the events are just ignored so that a JSON
+* syntax error anywhere in the payload takes precedence over the errors found by the
+* treat functions.
+*/
+class JsonSaxHandler
+{
+ public:
+  JsonSaxHandler
+  (
+    ConnectionInfo*          _ciP,
+    const char*              _content,
+    rapidjson::StringStream* _streamP,
+    JsonPathTable*           _tableP,
+    ParseData*               _parseDataP
+  ):
+    result("OK"),
+    ciP(_ciP),
+    content(_content),
+    streamP(_streamP),
+    tableP(_tableP),
+    parseDataP(_parseDataP),
+    done(false)
+  {
+  }
+
+  bool Null()                                                  { return value("null");                     }
+  bool Bool(bool b)                                            { return value(b ? "true" : "false");       }
+  bool Int(int i)                                              { return number();                          }
+  bool Uint(unsigned i)                                        { return number();                          }
+  bool Int64(int64_t i)                                        { return number();                          }
+  bool Uint64(uint64_t i)                                      { return number();                          }
+  bool Double(double d)                                        { return number();                          }
+  bool String(const char* s, rapidjson::SizeType len, bool c)  { return value(std::string(s, len));        }
+  bool Key(const char* s, rapidjson::SizeType len, bool c)     { key.assign(s, len); return true;          }
+  bool StartObject(void)                                       { return containerStart(false);             }
+  bool EndObject(rapidjson::SizeType members)                  { return containerEnd();                    }
+  bool StartArray(void)                                        { return containerStart(true);              }
+  bool EndArray(rapidjson::SizeType elements)                  { return containerEnd();                    }
+
+  std::string  result;
+  std::string  logicError;
+
+ private:
+  bool  number(void);
+  bool  value(const std::string& nodeValue);
+  bool  containerStart(bool isArray);
+  bool  containerEnd(void);
+  void  node(const std::string& value, bool isContainer, bool isArray);
+  void  treeNode(const std::string& name, const std::string& value, bool isContainer, bool isArray);
+  void  compoundNode(const std::string& name, const std::string& value, bool isContainer, bool isArray);
+  void  framePush(JsonFrameType type, bool isArray, size_t pathLen, orion::CompoundValueNode* containerP);
+  void  unknownField(void);
+
+  ConnectionInfo*           ciP;
+  const char*               content;
+  rapidjson::StringStream*  streamP;
+  JsonPathTable*            tableP;
+  ParseData*                parseDataP;
+  bool                      done;
+  std::string               key;
+  std::string               path;
+  std::vector<JsonFrame>    frameV;
+};
+
+
+
+/* ****************************************************************************
+*
+* JsonSaxHandler::number -
+*
+* The parser has just consumed the number, the text of the number is found going back
+* from the current position of the stream.
 */
-std::string nodeType(const std::string& nodeName, const std::string& value, orion::ValueType* typeP)
+bool JsonSaxHandler::number(void)
 {
-  bool  isObject  = (nodeName == "") && (value == "");
-  bool  isString  = (nodeName != "") && (value != "");
-  bool  isVector  = (nodeName != "") && (value == "");
+  const char* end   = content + streamP->Tell();
+  const char* start = end;
 
-  if (isObject)
+  while ((start > content) && (strchr("0123456789+-.eE", start[-1]) != NULL))
   {
-    *typeP = orion::ValueTypeObject;
-    return "Object";
+    --start;
   }
 
-  if (isString)
+  return value(std::string(start, end - start));
+}
+
+
+
+/* ****************************************************************************
+*
+* JsonSaxHandler::value -
+*/
+bool JsonSaxHandler::value(const std::string& nodeValue)
+{
+  // Only an object or an array is accepted as payload
+  if (frameV.empty())
   {
-    *typeP = orion::ValueTypeString;
-    return "String";
+    return false;
   }
 
-  if (isVector)
+  if (!done)
   {
-     *typeP = orion::ValueTypeVector;
-     return "Vector";
+    node(nodeValue, false, false);
   }
 
-  // Simple String inside vector
-  return "String";
+  return true;
 }
 
 
 
 /* ****************************************************************************
 *
-* eatCompound -
+* JsonSaxHandler::containerStart -
 */
-void eatCompound
-(
-  ConnectionInfo*                           ciP,
-  orion::CompoundValueNode*                 containerP,
-  boost::property_tree::ptree::value_type&  v,
-  const std::string&                        indent
-)
+bool JsonSaxHandler::containerStart(bool isArray)
 {
-  std::string                  nodeName     = v.first.data();
-  std::string                  nodeValue    = v.second.data();
-  boost::property_tree::ptree  subtree1     = (boost::property_tree::ptree) v.second;
-  int                          noOfChildren = subtree1.size();
+  if (frameV.empty())
+  {
+    framePush(JftTree, isArray, 0, NULL);
+    return true;
+  }
 
-  if (containerP == NULL)
+  if (!done)
   {
-    LM_T(LmtCompoundValue, ("COMPOUND: '%s'", nodeName.c_str()));
-    containerP = new CompoundValueNode(orion::ValueTypeObject);
-    ciP->compoundValueRoot = containerP;
+    node("", true, isArray);
   }
-  else
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* JsonSaxHandler::containerEnd -
+*/
+bool JsonSaxHandler::containerEnd(void)
+{
+  if (done)
   {
-    if ((nodeName != "") && (nodeValue != ""))  // Named String
-    {
-      if (forbiddenChars(nodeValue.c_str()) == true)
-      {
-        LM_W(("Bad Input (found a forbidden value in compound '%s')", nodeValue.c_str()));
-        ciP->httpStatusCode = SccBadRequest;
-        ciP->answer = std::string("Illegal value for JSON field");
-        return;
-      }
-
-      containerP->add(orion::ValueTypeString, nodeName, nodeValue);
-      LM_T(LmtCompoundValue, ("Added string '%s' (value: '%s') under '%s'",
-                              nodeName.c_str(),
-                              nodeValue.c_str(),
-                              containerP->cpath()));
-    }
-    else if ((nodeName == "") && (nodeValue == "") && (noOfChildren == 0))  // Unnamed String with EMPTY VALUE
-    {
-      LM_T(LmtCompoundValue, ("'Bad' input - looks like a container but it is an EMPTY STRING - no name, no value"));
-      containerP->add(orion::ValueTypeString, "item", "");
-    }
-    else if ((nodeName != "") && (nodeValue == ""))  // Named Container
-    {
-      LM_T(LmtCompoundValue, ("Adding container '%s' under '%s'", nodeName.c_str(), containerP->cpath()));
-      containerP = containerP->add(orion::ValueTypeObject, nodeName, "");
-    }
-    else if ((nodeName == "") && (nodeValue == ""))  // Name-Less container
+    return true;
+  }
+
+  JsonFrame* frameP = &frameV.back();
+
+  if (frameP->type == JftCompoundPending)
+  {
+    // An empty object/array in a compound path is not a compound value, but a normal node
+    if (frameP->treated == false)
     {
-      LM_T(LmtCompoundValue, ("Adding name-less container under '%s' (parent may be a Vector!)", containerP->cpath()));
-      containerP->valueType = orion::ValueTypeVector;
-      containerP = containerP->add(orion::ValueTypeObject, "item", "");
+      unknownField();
+      return true;
     }
-    else if ((nodeName == "") && (nodeValue != ""))  // Name-Less String + its container is a vector
+  }
+  else if (frameP->type == JftCompoundItemPending)
+  {
+    LM_T(LmtCompoundValue, ("'Bad' input - looks like a container but it is an EMPTY STRING - no name, no value"));
+    frameP->containerP->add(orion::ValueTypeString, "item", "");
+  }
+  else if ((frameP->type == JftCompound) && (frameP->compoundRoot == true))
+  {
+    compoundValueEnd(ciP, parseDataP);
+
+    if (ciP->httpStatusCode != SccOk)
     {
-      containerP->valueType = orion::ValueTypeVector;
-      LM_T(LmtCompoundValue, ("Set '%s' to be a vector", containerP->cpath()));
-      containerP->add(orion::ValueTypeString, "item", nodeValue);
-      LM_T(LmtCompoundValue, ("Added a name-less string (value: '%s') under '%s'",
-                              nodeValue.c_str(), containerP->cpath()));
+      result = ciP->answer;
+      done   = true;
+      return true;
     }
-    else
-      LM_T(LmtCompoundValue, ("IMPOSSIBLE !!!"));
   }
 
-  boost::property_tree::ptree subtree = (boost::property_tree::ptree) v.second;
-  BOOST_FOREACH(boost::property_tree::ptree::value_type &v2, subtree)
+  path.resize(frameP->pathLen);
+  frameV.pop_back();
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* JsonSaxHandler::node -
+*/
+void JsonSaxHandler::node(const std::string& value, bool isContainer, bool isArray)
+{
+  JsonFrame*   frameP = &frameV.back();
+  std::string  name   = (frameP->isArray == true)? "" : key;
+
+  if (frameP->type == JftTree)
+  {
+    treeNode(name, value, isContainer, isArray);
+    return;
+  }
+
+  //
+  // The first child of a pending object/array decides what it is
+  //
+  if (frameP->type == JftCompoundPending)
   {
-    eatCompound(ciP, containerP, v2, indent + "  ");
+    LM_T(LmtCompoundValue, ("COMPOUND: '%s'", path.c_str()));
+    frameP->containerP     = new orion::CompoundValueNode(orion::ValueTypeObject);
+    frameP->compoundRoot   = true;
+    frameP->type           = JftCompound;
+    ciP->compoundValueRoot = frameP->containerP;
   }
+  else if (frameP->type == JftCompoundItemPending)
+  {
+    LM_T(LmtCompoundValue, ("Adding name-less container under '%s' (parent may be a Vector!)", frameP->containerP->path().c_str()));
+    frameP->containerP->valueType = orion::ValueTypeVector;
+    frameP->containerP            = frameP->containerP->add(orion::ValueTypeObject, "item", "");
+    frameP->type                  = JftCompound;
+  }
+
+  compoundNode(name, value, isContainer, isArray);
 }
 
 
 
 /* ****************************************************************************
 *
-* jsonParse -
+* JsonSaxHandler::treeNode -
 */
-static std::string jsonParse
-(
-  ConnectionInfo*                           ciP,
-  boost::property_tree::ptree::value_type&  v,
-  const std::string&                        _path,
-  JsonNode*                                 parseVector,
-  ParseData*                                parseDataP
-)
+void JsonSaxHandler::treeNode(const std::string& name, const std::string& value, bool isContainer, bool isArray)
 {
-  std::string                     nodeName         = v.first.data();
-  std::string                     nodeValue        = v.second.data();
-  std::string                     arrayElementName = getArrayElementName(_path);
-  std::string                     path             = _path;
-  bool                            treated;
+  size_t       pathLen          = path.length();
+  std::string  arrayElementName = frameV.back().arrayElementName;
+  bool         treated;
 
-  // If the node name is empty, boost will yield an empty name. This will happen only in the case of a vector.
-  // See: http://www.boost.org/doc/libs/1_41_0/doc/html/boost_propertytree/parsers.html#boost_propertytree.parsers.json_parser
-  if (nodeName != "")
+  // An empty name is a member of an array
+  if (name != "")
   {
     // This detects whether we are trying to use an object within an object instead of an one-item array.
-    // We don't allow the first case, hence the exception thrown.
+    // We don't allow the first case, hence the exception thrown (after the parse).
     // However, this restriction is not valid inside Compound Values.
-    if ((nodeName != arrayElementName) || (ciP->inCompoundValue == true))
+    if ((name != arrayElementName) || (ciP->inCompoundValue == true))
     {
-      path = path + "/" + nodeName;
+      path += "/" + name;
     }
     else
     {
-      throw std::logic_error("The object '" + path + "' may not have a child named '" + nodeName + "'");
+      logicError = "The object '" + path + "' may not have a child named '" + name + "'";
+      done       = true;
+      return;
     }
   }
   else
   {
-    path = path + "/" + arrayElementName;
+    path += "/" + arrayElementName;
   }
 
-  treated = treat(ciP, path, nodeValue, parseVector, parseDataP);
+  treated = treat(ciP, path, value, tableP, parseDataP);
 
+  if ((isContainer == true) && (isCompoundPath(path.c_str()) == true))
+  {
+    framePush(JftCompoundPending, isArray, pathLen, NULL);
+    frameV.back().treated = treated;
+    return;
+  }
 
-  boost::property_tree::ptree subtree = (boost::property_tree::ptree) v.second;
-  int                         noOfChildren = subtree.size();
-  if ((isCompoundPath(path.c_str()) == true) && (nodeValue == "") && (noOfChildren != 0))
+  if (treated == false)
   {
-    std::string s;
+    unknownField();
+    return;
+  }
 
-    LM_T(LmtCompoundValue, ("Calling eatCompound for '%s'", path.c_str()));
-    eatCompound(ciP, NULL, v, "");
-    compoundValueEnd(ciP, parseDataP);
+  if (isContainer == true)
+  {
+    framePush(JftTree, isArray, pathLen, NULL);
+    return;
+  }
 
-    if (ciP->httpStatusCode != SccOk)
+  path.resize(pathLen);
+}
+
+
+
+/* ****************************************************************************
+*
+* JsonSaxHandler::compoundNode -
+*
+* An empty string is treated like an empty object/array, so "" is a container if it has
+* a name and a name-less string (an 'item') with empty value otherwise.
+*/
+void JsonSaxHandler::compoundNode(const std::string& name, const std::string& value, bool isContainer, bool isArray)
+{
+  orion::CompoundValueNode* containerP = frameV.back().containerP;
+
+  if ((name != "") && (value != ""))  // Named String
+  {
+    if (forbiddenChars(value.c_str()) == true)
     {
-      return ciP->answer;
+      LM_W(("Bad Input (found a forbidden value in compound '%s')", value.c_str()));
+      ciP->httpStatusCode = SccBadRequest;
+      ciP->answer = std::string("Illegal value for JSON field");
+      return;
     }
 
-    return "OK";
+    containerP->add(orion::ValueTypeString, name, value);
+    LM_T(LmtCompoundValue, ("Added string '%s' (value: '%s') under '%s'", name.c_str(), value.c_str(), containerP->path().c_str()));
   }
-  else if (treated == false)
+  else if ((name == "") && (value == ""))  // Name-Less container or string with EMPTY VALUE
   {
-    ciP->httpStatusCode = SccBadRequest;
-    if (ciP->answer == "")
+    if (isContainer == true)
     {
-      ciP->answer = std::string("JSON Parse Error: unknown field: ") + path.c_str();
+      framePush(JftCompoundItemPending, isArray, path.length(), containerP);
     }
+    else
+    {
+      LM_T(LmtCompoundValue, ("'Bad' input - looks like a container but it is an EMPTY STRING - no name, no value"));
+      containerP->add(orion::ValueTypeString, "item", "");
+    }
+  }
+  else if ((name != "") && (value == ""))  // Named Container
+  {
+    LM_T(LmtCompoundValue, ("Adding container '%s' under '%s'", name.c_str(), containerP->path().c_str()));
+    containerP = containerP->add(orion::ValueTypeObject, name, "");
 
-    LM_W(("Bad Input (%s)", ciP->answer.c_str()));
-    return ciP->answer;
+    if (isContainer == true)
+    {
+      framePush(JftCompound, isArray, path.length(), containerP);
+    }
+  }
+  else  // Name-Less String + its container is a vector
+  {
+    containerP->valueType = orion::ValueTypeVector;
+    LM_T(LmtCompoundValue, ("Set '%s' to be a vector", containerP->path().c_str()));
+    containerP->add(orion::ValueTypeString, "item", value);
+    LM_T(LmtCompoundValue, ("Added a name-less string (value: '%s') under '%s'", value.c_str(), containerP->path().c_str()));
   }
+}
+
+
 
-  if (noOfChildren == 0)
+/* ****************************************************************************
+*
+* JsonSaxHandler::framePush -
+*/
+void JsonSaxHandler::framePush(JsonFrameType type, bool isArray, size_t pathLen, orion::CompoundValueNode* containerP)
+{
+  JsonFrame frame;
+
+  frame.type         = type;
+  frame.isArray      = isArray;
+  frame.pathLen      = pathLen;
+  frame.treated      = true;
+  frame.compoundRoot = false;
+  frame.containerP   = containerP;
+
+  if (type == JftTree)
   {
-    return "OK";
+    frame.arrayElementName = getArrayElementName(path);
   }
 
-  subtree = (boost::property_tree::ptree) v.second;
-  BOOST_FOREACH(boost::property_tree::ptree::value_type &v2, subtree)
+  frameV.push_back(frame);
+}
+
+
+
+/* ****************************************************************************
+*
+* JsonSaxHandler::unknownField -
+*/
+void JsonSaxHandler::unknownField(void)
+{
+  ciP->httpStatusCode = SccBadRequest;
+  if (ciP->answer == "")
   {
-    std::string out = jsonParse(ciP, v2, path, parseVector, parseDataP);
-    if (out != "OK")
-    {
-      LM_W(("Bad Input (JSON parse error: '%s')", out.c_str()));
-      return out;
-    }
+    ciP->answer = std::string("JSON Parse Error: unknown field: ") + path.c_str();
   }
 
-  return "OK";
+  LM_W(("Bad Input (%s)", ciP->answer.c_str()));
+
+  result = ciP->answer;
+  done   = true;
 }
 
+
+
 /* ****************************************************************************
 *
 * jsonParse -
+*
+* Syntax errors in the payload are thrown as exceptions (and so is an object used instead
+* of a one-item array), to be caught by jsonTreat.
 */
 std::string jsonParse
 (
@@ -393,26 +706,29 @@ std::string jsonParse
   ParseData*          parseDataP
 )
 {
-  std::stringstream  ss;
-  ptree              tree;
-  ptree              subtree;
-  std::string        path;
+  rapidjson::Reader        reader;
+  rapidjson::StringStream  ss(content);
+  JsonSaxHandler           handler(ciP, content, &ss, pathTableGet(parseVector), parseDataP);
+
+  reader.Parse(ss, handler);
 
-  ss << content;
-  read_json(ss, subtree);
+  if (reader.HasParseError())
+  {
+    char offset[32];
 
-  tree.put_child(requestType, subtree);
+    snprintf(offset, sizeof(offset), "%lu", (unsigned long) reader.GetErrorOffset());
+    throw std::runtime_error(std::string(rapidjson::GetParseError_En(reader.GetParseErrorCode())) + " (offset " + offset + ")");
+  }
 
-  // LM_T(LmtParse, ("parsing '%s'", content));
-  BOOST_FOREACH(boost::property_tree::ptree::value_type &v, tree.get_child(requestType))
+  if (handler.logicError != "")
   {
-    std::string res = jsonParse(ciP, v, path, parseVector, parseDataP);
-    if (res != "OK")
-    {
-      LM_W(("Bad Input (JSON Parse error: '%s')", res.c_str()));
-      return res;
-    }
+    throw std::logic_error(handler.logicError);
+  }
+
+  if (handler.result != "OK")
+  {
+    LM_W(("Bad Input (JSON Parse error: '%s')", handler.result.c_str()));
   }
 
-  return "OK";
+  return handler.result;
 }
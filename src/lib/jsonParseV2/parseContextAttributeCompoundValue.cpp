@@ -27,6 +27,7 @@
 #include "rapidjson/document.h"
 
 #include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
 #include "ngsi/ContextAttribute.h"
 #include "parse/CompoundValueNode.h"
 #include "jsonParseV2/jsonParseTypeNames.h"
@@ -87,142 +88,87 @@ static char* stringValue(orion::CompoundValueNode* cvnP, char* buffer)
 
 /* ****************************************************************************
 *
-* parseContextAttributeCompoundValue - 
+* compoundNodeAdd - add a child to 'parent', a member of an object or an item of an array (name-less)
 */
-std::string parseContextAttributeCompoundValue
+static orion::CompoundValueNode* compoundNodeAdd
 (
-  const Value::ConstValueIterator&   node,
-  ContextAttribute*                  caP,
-  orion::CompoundValueNode*          parent
-)  
+  orion::CompoundValueNode*  parent,
+  const char*                name,
+  const Value&               value,
+  int                        siblingNo
+)
 {
-  std::string  type   = jsonParseTypeNames[node->GetType()];
+  std::string                nodeType = jsonParseTypeNames[value.GetType()];
+  orion::CompoundValueNode*  cvnP     = new orion::CompoundValueNode();
 
-  LM_M(("Got a node of type %s", type.c_str()));
+  cvnP->name       = name;
+  cvnP->valueType  = stringToCompoundType(nodeType);
+  cvnP->container  = parent;
+  cvnP->siblingNo  = siblingNo;
 
-  if (node->IsObject())
+  if (nodeType == "String")
+  {
+    cvnP->stringValue = value.GetString();
+  }
+  else if (nodeType == "Number")
+  {
+    cvnP->numberValue = value.GetDouble();
+  }
+  else if ((nodeType == "True") || (nodeType == "False"))
   {
-    int counter  = 0;
+    cvnP->boolValue   = (nodeType == "True")? true : false;
+  }
 
-    LM_M(("Got an OBJECT (%d members) in a vector", node->MemberCount(), type.c_str()));
+  parent->childV.push_back(cvnP);
 
-    for (Value::ConstMemberIterator iter = node->MemberBegin(); iter != node->MemberEnd(); ++iter)
-    {
-      char                       buffer[256];
-      std::string                nodeType = jsonParseTypeNames[iter->value.GetType()];
-      orion::CompoundValueNode*  cvnP     = new orion::CompoundValueNode();
+  if (lmTraceIsSet(LmtCompoundValue))
+  {
+    char buffer[256];
 
-      cvnP->valueType  = stringToCompoundType(nodeType);
+    LM_T(LmtCompoundValue, ("pushed %s: %s (%s)", nodeType.c_str(), cvnP->path().c_str(), stringValue(cvnP, buffer)));
+  }
 
-      LM_M(("Object Member: %s", iter->name.GetString()));
+  return cvnP;
+}
 
-      cvnP->name       = iter->name.GetString();
-      cvnP->container  = parent;
-      cvnP->rootP      = parent->rootP;
-      cvnP->level      = parent->level + 1;
-      cvnP->siblingNo  = counter;
-      cvnP->path       = parent->path + cvnP->name;
 
-      if (nodeType == "String")
-      {
-        cvnP->stringValue       = iter->value.GetString();
-      }
-      else if (nodeType == "Number")
-      {
-        cvnP->numberValue = iter->value.GetDouble();
-      }
-      else if ((nodeType == "True") || (nodeType == "False"))
-      {
-        cvnP->boolValue   = (nodeType == "True")? true : false;
-      }
-      else if (nodeType == "Object")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeObject;
-      }
-      else if (nodeType == "Array")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeVector;
-      }
 
-      parent->childV.push_back(cvnP);
-      LM_M(("KZ: pushed %s: %s (%s)", nodeType.c_str(), cvnP->path.c_str(), stringValue(cvnP, buffer)));
-        
-      //
-      // Recursive call if Object or Array
-      //
-      if ((nodeType == "Object") || (nodeType == "Array"))
+/* ****************************************************************************
+*
+* compoundChildrenParse - the members of an object or the items of an array, recursively
+*/
+static void compoundChildrenParse(const Value& value, orion::CompoundValueNode* parent)
+{
+  int counter = 0;
+
+  if (value.IsObject())
+  {
+    for (Value::ConstMemberIterator iter = value.MemberBegin(); iter != value.MemberEnd(); ++iter)
+    {
+      orion::CompoundValueNode* cvnP = compoundNodeAdd(parent, iter->name.GetString(), iter->value, counter);
+
+      if (iter->value.IsObject() || iter->value.IsArray())
       {
-        LM_M(("Recursive call as Object or Array"));
-        parseContextAttributeCompoundValue(iter, caP, cvnP);
+        compoundChildrenParse(iter->value, cvnP);
       }
 
       ++counter;
     }
   }
-  else if (node->IsArray())
+  else if (value.IsArray())
   {
-    LM_M(("Got an ARRAY (size: %d) in a vector - parsing stops here. For now ...", node->Size(), type.c_str()));
-    int counter  = 0;
-
-    for (Value::ConstValueIterator iter = node->Begin(); iter != node->End(); ++iter)
+    for (Value::ConstValueIterator iter = value.Begin(); iter != value.End(); ++iter)
     {
-      char                       buffer[256];
-      std::string                nodeType  = jsonParseTypeNames[iter->GetType()];
-      orion::CompoundValueNode*  cvnP      = new orion::CompoundValueNode();
-      char                       itemNo[4];
-
-      snprintf(itemNo, sizeof(itemNo), "%03d", counter);
-
-      cvnP->valueType  = stringToCompoundType(nodeType);
-      cvnP->container  = parent;
-      cvnP->rootP      = parent->rootP;
-      cvnP->level      = parent->level + 1;
-      cvnP->siblingNo  = counter;
-      cvnP->path       = parent->path + "[" + itemNo + "]";
-
-
-      if (nodeType == "String")
-      {
-        cvnP->stringValue       = iter->GetString();
-      }
-      else if (nodeType == "Number")
-      {
-        cvnP->numberValue = iter->GetDouble();
-      }
-      else if ((nodeType == "True") || (nodeType == "False"))
-      {
-        cvnP->boolValue   = (nodeType == "True")? true : false;
-      }
-      else if (nodeType == "Object")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeObject;
-      }
-      else if (nodeType == "Array")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeVector;
-      }
-
-      parent->childV.push_back(cvnP);
-      LM_M(("KZ: pushed Array-member %d: %s: %s (%s)", counter, nodeType.c_str(), cvnP->path.c_str(), stringValue(cvnP, buffer)));
+      orion::CompoundValueNode* cvnP = compoundNodeAdd(parent, "", *iter, counter);
 
-      //
-      // Recursive call if Object or Array
-      //
-      if ((nodeType == "Object") || (nodeType == "Array"))
+      if (iter->IsObject() || iter->IsArray())
       {
-        LM_M(("Object/Array inside Array"));
-        parseContextAttributeCompoundValue(iter, caP, cvnP);
+        compoundChildrenParse(*iter, cvnP);
       }
 
       ++counter;
     }
   }
-
-  return "OK";
 }
 
 
@@ -239,144 +185,24 @@ std::string parseContextAttributeCompoundValue
 )
 {
   std::string type   = jsonParseTypeNames[node->value.GetType()];
-  std::string name   = node->name.GetString();
 
-  LM_M(("Got: %s (%s)", name.c_str(), type.c_str()));
+  LM_T(LmtCompoundValue, ("Got: %s (%s)", node->name.GetString(), type.c_str()));
 
   if (caP->compoundValueP == NULL)
   {
-    LM_M(("KZ-Comp: Got a TOPLEVEL %s", type.c_str()));
     caP->compoundValueP            = new orion::CompoundValueNode();
     caP->compoundValueP->name      = "TOP";
     caP->compoundValueP->container = caP->compoundValueP;
     caP->compoundValueP->valueType = stringToCompoundType(type);
-    caP->compoundValueP->path      = "/";
-    caP->compoundValueP->rootP     = caP->compoundValueP;
-    caP->compoundValueP->level     = 0;
     caP->compoundValueP->siblingNo = 0;
 
     parent = caP->compoundValueP;
   }
 
-
   //
   // Children of the node
   //
-  if (type == "Array")
-  {
-    int counter  = 0;
-
-    for (Value::ConstValueIterator iter = node->value.Begin(); iter != node->value.End(); ++iter)
-    {
-      char                       buffer[256];
-      std::string                nodeType  = jsonParseTypeNames[iter->GetType()];
-      orion::CompoundValueNode*  cvnP      = new orion::CompoundValueNode();
-      char                       itemNo[4];
-
-      snprintf(itemNo, sizeof(itemNo), "%03d", counter);
-
-      cvnP->valueType  = stringToCompoundType(nodeType);
-      cvnP->container  = parent;
-      cvnP->rootP      = parent->rootP;
-      cvnP->level      = parent->level + 1;
-      cvnP->siblingNo  = counter;
-      cvnP->path       = parent->path + "[" + itemNo + "]";
-
-
-      if (nodeType == "String")
-      {
-        cvnP->stringValue       = iter->GetString();
-      }
-      else if (nodeType == "Number")
-      {
-        cvnP->numberValue = iter->GetDouble();
-      }
-      else if ((nodeType == "True") || (nodeType == "False"))
-      {
-        cvnP->boolValue   = (nodeType == "True")? true : false;
-      }
-      else if (nodeType == "Object")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeObject;
-      }
-      else if (nodeType == "Array")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeVector;
-      }
-
-      parent->childV.push_back(cvnP);
-      LM_M(("KZ: pushed Array-member %d: %s: %s (%s)", counter, nodeType.c_str(), cvnP->path.c_str(), stringValue(cvnP, buffer)));
-
-      //
-      // Recursive call if Object or Array
-      //
-      if ((nodeType == "Object") || (nodeType == "Array"))
-      {
-        LM_M(("Object/Array inside Array"));
-        parseContextAttributeCompoundValue(iter, caP, cvnP);
-      }
-
-      ++counter;
-    }
-  }
-  else if (type == "Object")
-  {
-    int counter  = 0;
-
-    for (Value::ConstMemberIterator iter = node->value.MemberBegin(); iter != node->value.MemberEnd(); ++iter)
-    {
-      char                       buffer[256];
-      std::string                nodeType = jsonParseTypeNames[iter->value.GetType()];
-      orion::CompoundValueNode*  cvnP     = new orion::CompoundValueNode();
-
-      cvnP->name       = iter->name.GetString();
-      cvnP->valueType  = stringToCompoundType(nodeType);
-      cvnP->container  = parent;
-      cvnP->rootP      = parent->rootP;
-      cvnP->level      = parent->level + 1;
-      cvnP->siblingNo  = counter;
-      cvnP->path       = parent->path + cvnP->name;
-
-      if (nodeType == "String")
-      {
-        cvnP->stringValue       = iter->value.GetString();
-      }
-      else if (nodeType == "Number")
-      {
-        cvnP->numberValue = iter->value.GetDouble();
-      }
-      else if ((nodeType == "True") || (nodeType == "False"))
-      {
-        cvnP->boolValue   = (nodeType == "True")? true : false;
-      }
-      else if (nodeType == "Object")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeObject;
-      }
-      else if (nodeType == "Array")
-      {
-        cvnP->path += "/";
-        cvnP->valueType = orion::ValueTypeVector;
-      }
-
-      parent->childV.push_back(cvnP);
-      LM_M(("KZ: pushed %s: %s (%s)", nodeType.c_str(), cvnP->path.c_str(), stringValue(cvnP, buffer)));
-        
-      //
-      // Recursive call if Object or Array
-      //
-      if ((nodeType == "Object") || (nodeType == "Array"))
-      {
-        LM_M(("Recursive call as Object or Array"));
-        parseContextAttributeCompoundValue(iter, caP, cvnP);
-      }
-
-      ++counter;
-    }
-  }
+  compoundChildrenParse(node->value, parent);
 
   return "OK";
 }
@@ -45,6 +45,9 @@
 #include <sys/time.h>           /* gettimeofday                              */
 #include <time.h>               /* time, gmtime_r, ...                       */
 #include <sys/timeb.h>          /* timeb, ftime, ...                         */
+#include <sys/uio.h>            /* writev                                    */
+#include <pthread.h>            /* pthread_create, pthread_key_create, ...   */
+#include <signal.h>             /* sigaction, raise                          */
 
 #undef NDEBUG
 #include <assert.h>
@@ -949,15 +952,13 @@ static char* lmLineFix
   int          fi     = 0;
   Fds*         fdP    = &fds[index];
   char*        format = fdP->format;
+  pid_t        tid    = syscall(SYS_gettid);
 
   memset(line, 0, lineLen);
 
   fLen = strlen(format);
   while (fi < fLen)
   {
-    pid_t tid;
-
-    tid = syscall(SYS_gettid);
     if (strncmp(&format[fi], "TYPE", 4) == 0)
     {
       STRING_ADD(longTypeName(type), 4);
@@ -1748,7 +1749,12 @@ LmStatus lmAux(char* a)
 char* lmTextGet(const char* format, ...)
 {
   va_list  args;
-  char*    vmsg = (char*) calloc(1, LINE_MAX);
+  char*    vmsg = (char*) malloc(LINE_MAX);  /* no need to zero it, vsnprintf terminates the string */
+
+  if (vmsg == NULL)
+  {
+    return NULL;
+  }
 
   /* "Parse" the varible arguments */
   va_start(args, format);
@@ -2082,6 +2088,590 @@ LmStatus lmPathRegister
 
 
 
+/* ****************************************************************************
+*
+* lmLineCompose - compose the line for the fd with index 'i', NULL if not to be written
+*/
+static char* lmLineCompose
+(
+  int          i,
+  char*        line,
+  char*        format,
+  char*        text,
+  char         type,
+  const char*  file,
+  int          lineNo,
+  const char*  fName,
+  int          tLev,
+  const char*  stre
+)
+{
+  if ((fds[i].type == Stdout) && (fds[i].onlyErrorAndVerbose == true))
+  {
+    if ((type == 'T') ||
+        (type == 'D') ||
+        (type == 'H') ||
+        (type == 'M') ||
+        (type == 't')
+      )
+    {
+      return NULL;
+    }
+  }
+
+  line[0] = 0;
+
+  if (type == 'R')
+  {
+    if (text[1] != ':')
+    {
+      snprintf(line, LINE_MAX, "R: %s\n%c", text, 0);
+    }
+    else
+    {
+      snprintf(line, LINE_MAX, "%s\n%c", text, 0);
+    }
+  }
+  else if (type == 'S')
+  {
+    char stampStr[128];
+    snprintf(line, LINE_MAX, "%s:%s", text, timeStampGet(stampStr, 128));
+  }
+  else
+  {
+    /* Danger: 'format' might be too short ... */
+    if (lmLineFix(i, format, FORMAT_LEN, type, file, lineNo, fName, tLev) == NULL)
+    {
+      return NULL;
+    }
+
+    if ((strlen(format) + strlen(text)) > LINE_MAX)
+    {
+      snprintf(line, LINE_MAX, "%s[%d]: %s\n%c", file, lineNo, "LM ERROR: LINE TOO LONG", 0);
+    }
+    else
+    {
+      snprintf(line, LINE_MAX, format, text);
+    }
+  }
+
+  if (stre != NULL)
+  {
+    strncat(line, stre, LINE_MAX - 1);
+  }
+
+  return line;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmFunctionsCall - call the warning/error function (if any) for a line of type 'type'
+*/
+static void lmFunctionsCall(char* text, char type, const char* stre)
+{
+  if (type == 'W')
+  {
+    if (warningFunction != NULL)
+    {
+      fprintf(stderr, "Calling warningFunction (at %p)\n", &warningFunction);
+
+      warningFunction(warningInput, text, (char*) stre);
+      fprintf(stderr, "warningFunction done\n");
+    }
+  }
+  else if ((type == 'E') || (type == 'P'))
+  {
+    if (errorFunction != NULL)
+    {
+      errorFunction(errorInput, text, (char*) stre);
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* lmClearCheck - clear the log files if clearing is on and they have grown too much
+*
+* Called without the semaphore, lmClear takes it.
+*/
+static LmStatus lmClearCheck(void)
+{
+  if ((doClear == false) || (logLines < atLines))
+  {
+    return LmsOk;
+  }
+
+  for (int i = 0; i < FDS_MAX; i++)
+  {
+    LmStatus s;
+
+    if ((fds[i].state != Occupied) || (fds[i].type != Fichero))
+    {
+      continue;
+    }
+
+    if ((s = lmClear(i, keepLines, lastLines)) != LmsOk)
+    {
+      return s;
+    }
+  }
+
+  return LmsOk;
+}
+
+
+
+/* ****************************************************************************
+*
+* Asynchronous output -
+*
+* After lmAsyncStart, lmOut composes the lines in the calling thread (the transaction id is
+* thread local) but, instead of writing them, it copies them into a ring buffer owned by
+* that thread. Each ring has a single producer (its thread) and a single consumer (whoever
+* holds asyncDrainMutex, normally the writer thread), so no lock is taken to log a line.
+* The writer thread drains the rings writing all the pending lines of an fd with a single
+* writev().
+*
+* Rings are never freed: the ring of a finished thread is reused by the next thread asking
+* for one, so there are as many rings as threads logging at the same time.
+*
+* Fatal lines (LM_X) are written synchronously after flushing the rings, and the rings are
+* also flushed at exit and when the process crashes (SIGSEGV, SIGABRT, ...).
+* The warning/error functions are called by the logging thread, and the log files are
+* cleared (lmDoClear) by the thread writing the lines.
+*/
+#define LM_RING_SIZE        (128 * 1024)     /* power of two, bigger than LINE_MAX */
+#define LM_RING_ALIGN       8
+#define LM_ASYNC_IOV        64
+#define LM_ASYNC_IDLE_USEC  5000
+
+typedef struct LmRingEntry
+{
+  int  fdIndex;                   /* -1 for the padding at the end of the buffer */
+  int  len;
+} LmRingEntry;
+
+typedef struct LmRing
+{
+  volatile unsigned int  head;    /* bytes produced, only modified by the owner thread */
+  volatile unsigned int  tail;    /* bytes consumed, only modified by the consumer     */
+  volatile int           inUse;   /* owned by a thread                                 */
+  struct LmRing*         next;
+  char                   line[LINE_MAX];
+  char                   format[FORMAT_LEN + 1];
+  char                   buf[LM_RING_SIZE];
+} LmRing;
+
+static bool               asyncActive     = false;
+static LmRing* volatile   asyncRings      = NULL;
+static pthread_key_t      asyncRingKey;
+static pthread_mutex_t    asyncDrainMutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread LmRing*   asyncRingP      = NULL;
+
+
+
+/* ****************************************************************************
+*
+* lmRingRelease - pthread key destructor, the ring of a finished thread is free for reuse
+*/
+static void lmRingRelease(void* vP)
+{
+  LmRing* ringP = (LmRing*) vP;
+
+  __sync_synchronize();
+  ringP->inUse = 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmRingGet - the ring of the calling thread
+*/
+static LmRing* lmRingGet(void)
+{
+  if (asyncRingP != NULL)
+  {
+    return asyncRingP;
+  }
+
+  for (LmRing* ringP = asyncRings; ringP != NULL; ringP = ringP->next)
+  {
+    if ((ringP->inUse == 0) && __sync_bool_compare_and_swap(&ringP->inUse, 0, 1))
+    {
+      asyncRingP = ringP;
+      break;
+    }
+  }
+
+  if (asyncRingP == NULL)
+  {
+    LmRing* ringP = (LmRing*) calloc(1, sizeof(LmRing));
+
+    if (ringP == NULL)
+    {
+      return NULL;
+    }
+
+    ringP->inUse = 1;
+    do
+    {
+      ringP->next = asyncRings;
+    } while (!__sync_bool_compare_and_swap(&asyncRings, ringP->next, ringP));
+
+    asyncRingP = ringP;
+  }
+
+  pthread_setspecific(asyncRingKey, asyncRingP);
+  return asyncRingP;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmRingPut - false if the ring is full
+*/
+static bool lmRingPut(LmRing* ringP, int fdIndex, const char* line, int len)
+{
+  unsigned int  need = (sizeof(LmRingEntry) + len + LM_RING_ALIGN - 1) & ~(LM_RING_ALIGN - 1);
+  unsigned int  head = ringP->head;
+  unsigned int  tail = ringP->tail;
+  unsigned int  pos  = head % LM_RING_SIZE;
+  unsigned int  pad  = 0;
+  LmRingEntry*  eP;
+
+  /* An entry is never split: the end of the buffer is skipped if it doesn't fit */
+  if (pos + need > LM_RING_SIZE)
+  {
+    pad = LM_RING_SIZE - pos;
+  }
+
+  if (pad + need > LM_RING_SIZE - (head - tail))
+  {
+    return false;
+  }
+
+  if (pad != 0)
+  {
+    eP          = (LmRingEntry*) &ringP->buf[pos];
+    eP->fdIndex = -1;
+    eP->len     = pad - sizeof(LmRingEntry);
+    pos         = 0;
+  }
+
+  eP          = (LmRingEntry*) &ringP->buf[pos];
+  eP->fdIndex = fdIndex;
+  eP->len     = len;
+  memcpy(&ringP->buf[pos + sizeof(LmRingEntry)], line, len);
+
+  /* The entry must be complete before the consumer sees the new head */
+  __sync_synchronize();
+  ringP->head = head + pad + need;
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncWrite -
+*
+* In a crash, the semaphore isn't taken, as the crashing thread could be holding it.
+*/
+static void lmAsyncWrite(int index, struct iovec* iov, int iovs, bool crash)
+{
+  int nb;
+  int sz = 0;
+
+  for (int ix = 0; ix < iovs; ++ix)
+  {
+    sz += iov[ix].iov_len;
+  }
+
+  if (!crash)
+  {
+    semTake();
+  }
+
+  if (fds[index].state == Occupied)
+  {
+    lseek(fds[index].fd, 0, SEEK_END);
+    nb = writev(fds[index].fd, iov, iovs);
+
+    if (nb == -1)
+    {
+      printf("LOG error: writev(%d): %s\n", fds[index].fd, strerror(errno));
+    }
+    else if (nb != sz)
+    {
+      printf("LOG error: written %d bytes only (wanted %d)\n", nb, sz);
+    }
+
+    if (fds[index].type == Fichero)
+    {
+      logLines += iovs;
+    }
+  }
+
+  if (!crash)
+  {
+    semGive();
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncDrain - write the pending lines of all rings, returns the number of lines written
+*
+* The caller must be the only consumer (holding asyncDrainMutex, except in a crash).
+*/
+static int lmAsyncDrain(bool crash)
+{
+  struct iovec  iov[FDS_MAX][LM_ASYNC_IOV];
+  int           iovs[FDS_MAX];
+  int           lines = 0;
+
+  for (LmRing* ringP = asyncRings; ringP != NULL; ringP = ringP->next)
+  {
+    unsigned int head = ringP->head;
+    unsigned int tail = ringP->tail;
+
+    if (head == tail)
+    {
+      continue;
+    }
+
+    /* Entries up to 'head' are complete */
+    __sync_synchronize();
+
+    memset(iovs, 0, sizeof(iovs));
+
+    while (tail != head)
+    {
+      unsigned int  pos = tail % LM_RING_SIZE;
+      LmRingEntry*  eP  = (LmRingEntry*) &ringP->buf[pos];
+      int           ix  = eP->fdIndex;
+
+      if (ix >= 0)
+      {
+        if (iovs[ix] == LM_ASYNC_IOV)
+        {
+          lmAsyncWrite(ix, iov[ix], iovs[ix], crash);
+          iovs[ix] = 0;
+        }
+
+        iov[ix][iovs[ix]].iov_base = &ringP->buf[pos + sizeof(LmRingEntry)];
+        iov[ix][iovs[ix]].iov_len  = eP->len;
+        ++iovs[ix];
+        ++lines;
+      }
+
+      tail += (sizeof(LmRingEntry) + eP->len + LM_RING_ALIGN - 1) & ~(LM_RING_ALIGN - 1);
+    }
+
+    for (int ix = 0; ix < FDS_MAX; ++ix)
+    {
+      if (iovs[ix] != 0)
+      {
+        lmAsyncWrite(ix, iov[ix], iovs[ix], crash);
+      }
+    }
+
+    /* The lines have been written, the producer may reuse their space */
+    __sync_synchronize();
+    ringP->tail = tail;
+  }
+
+  return lines;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncFlush -
+*/
+int lmAsyncFlush(void)
+{
+  int lines;
+
+  pthread_mutex_lock(&asyncDrainMutex);
+  lines = lmAsyncDrain(false);
+
+  /* Under asyncDrainMutex, so that no line is written while the file is being cleared */
+  if (lines != 0)
+  {
+    lmClearCheck();
+  }
+  pthread_mutex_unlock(&asyncDrainMutex);
+
+  return lines;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncWriter - the writer thread
+*/
+static void* lmAsyncWriter(void* vP)
+{
+  while (true)
+  {
+    if (lmAsyncFlush() == 0)
+    {
+      usleep(LM_ASYNC_IDLE_USEC);
+    }
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncCrash - signal handler for crashes, installed with SA_RESETHAND
+*/
+static void lmAsyncCrash(int sigNo)
+{
+  lmAsyncDrain(true);
+
+  /* Default action (core dump) once the handler returns */
+  raise(sigNo);
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncStop - back to synchronous output, at exit
+*/
+static void lmAsyncStop(void)
+{
+  asyncActive = false;
+  __sync_synchronize();
+  lmAsyncFlush();
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncStart -
+*/
+LmStatus lmAsyncStart(void)
+{
+  pthread_t         tid;
+  struct sigaction  sa;
+  int               crashSignals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+
+  if (asyncActive == true)
+  {
+    return LmsInitAlreadyDone;
+  }
+
+  if (pthread_key_create(&asyncRingKey, lmRingRelease) != 0)
+  {
+    return LmsMalloc;
+  }
+
+  if (pthread_create(&tid, NULL, lmAsyncWriter, NULL) != 0)
+  {
+    return LmsMalloc;
+  }
+  pthread_detach(tid);
+
+  memset(&sa, 0, sizeof(sa));
+  sigemptyset(&sa.sa_mask);
+  sa.sa_handler = lmAsyncCrash;
+  sa.sa_flags   = SA_RESETHAND;
+
+  for (unsigned int ix = 0; ix < sizeof(crashSignals) / sizeof(crashSignals[0]); ++ix)
+  {
+    sigaction(crashSignals[ix], &sa, NULL);
+  }
+
+  atexit(lmAsyncStop);
+
+  asyncActive = true;
+  return LmsOk;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncOut - false if the line could not be queued (and must be written synchronously)
+*/
+static bool lmAsyncOut
+(
+  char*        text,
+  char         type,
+  const char*  file,
+  int          lineNo,
+  const char*  fName,
+  int          tLev,
+  const char*  stre
+)
+{
+  LmRing* ringP = lmRingGet();
+
+  if (ringP == NULL)
+  {
+    return false;
+  }
+
+  for (int i = 0; i < FDS_MAX; i++)
+  {
+    char* line;
+
+    if (fds[i].state != Occupied)
+    {
+      continue;
+    }
+
+    line = lmLineCompose(i, ringP->line, ringP->format, text, type, file, lineNo, fName, tLev, stre);
+    if (line == NULL)
+    {
+      continue;
+    }
+
+    if (fds[i].write != NULL)
+    {
+      semTake();
+      fds[i].write(line);
+      semGive();
+      continue;
+    }
+
+    int len = strlen(line);
+
+    if (!lmRingPut(ringP, i, line, len))
+    {
+      /* Ring full, make room (keeping the order of the lines of this thread) */
+      lmAsyncFlush();
+
+      if (!lmRingPut(ringP, i, line, len))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+
 /* ****************************************************************************
 *
 * lmOut -
@@ -2099,9 +2689,9 @@ LmStatus lmOut
 )
 {
   int   i;
-  char* line = (char*) calloc(1, LINE_MAX);
+  char* line;
   int   sz;
-  char* format = (char*) calloc(1, FORMAT_LEN + 1);
+  char* format;
   char* tmP;
 
   tmP = strrchr((char*) file, '/');
@@ -2113,17 +2703,38 @@ LmStatus lmOut
   if (inSigHandler && (type != 'X' || type != 'x'))
   {
     lmAddMsgBuf(text, type, file, lineNo, fName, tLev, (char*) stre);
-    free(line);
-    free(format);
-
     return LmsOk;
   }
 
   INIT_CHECK();
-  POINTER_CHECK(format);
   POINTER_CHECK(text);
 
-  memset(format, 0, FORMAT_LEN + 1);
+  if (asyncActive == true)
+  {
+    bool fatal = (type == 'X') || (type == 'x');
+    bool hook  = (type != 'H') && lmOutHook && (lmOutHookActive == true);
+
+    if (!fatal && !hook && lmAsyncOut(text, type, file, lineNo, fName, tLev, stre))
+    {
+      /* As in synchronous mode, the warning/error functions are called one at a time */
+      if ((type == 'W') || (type == 'E') || (type == 'P'))
+      {
+        semTake();
+        lmFunctionsCall(text, type, stre);
+        semGive();
+      }
+
+      return LmsOk;
+    }
+
+    /* Synchronous output, after the lines already queued */
+    lmAsyncFlush();
+  }
+
+  line   = (char*) calloc(1, LINE_MAX);
+  format = (char*) calloc(1, FORMAT_LEN + 1);
+  POINTER_CHECK(line);
+  POINTER_CHECK(format);
 
   semTake();
 
@@ -2143,56 +2754,9 @@ LmStatus lmOut
       continue;
     }
 
-    if ((fds[i].type == Stdout) && (fds[i].onlyErrorAndVerbose == true))
-    {
-      if ((type == 'T') ||
-          (type == 'D') ||
-          (type == 'H') ||
-          (type == 'M') ||
-          (type == 't')
-        )
-      {
-        continue;
-      }
-    }
-
-    if (type == 'R')
-    {
-      if (text[1] != ':')
-      {
-        snprintf(line, LINE_MAX, "R: %s\n%c", text, 0);
-      }
-      else
-      {
-        snprintf(line, LINE_MAX, "%s\n%c", text, 0);
-      }
-    }
-    else if (type == 'S')
-    {
-      char stampStr[128];
-      snprintf(line, LINE_MAX, "%s:%s", text, timeStampGet(stampStr, 128));
-    }
-    else
-    {
-      /* Danger: 'format' might be too short ... */
-      if (lmLineFix(i, format, FORMAT_LEN, type, file, lineNo, fName, tLev) == NULL)
-      {
-        continue;
-      }
-
-      if ((strlen(format) + strlen(text) + strlen(line)) > LINE_MAX)
-      {
-        snprintf(line, LINE_MAX, "%s[%d]: %s\n%c", file, lineNo, "LM ERROR: LINE TOO LONG", 0);
-      }
-      else
-      {
-        snprintf(line, LINE_MAX, format, text);
-      }
-    }
-
-    if (stre != NULL)
+    if (lmLineCompose(i, line, format, text, type, file, lineNo, fName, tLev, stre) == NULL)
     {
-      strncat(line, stre, LINE_MAX - 1);
+      continue;
     }
 
     sz = strlen(line);
@@ -2222,24 +2786,7 @@ LmStatus lmOut
   ++logLines;
   LOG_OUT(("logLines: %d", logLines));
 
-  if (type == 'W')
-  {
-    if (warningFunction != NULL)
-    {
-      fprintf(stderr, "Calling warningFunction (at %p)\n", &warningFunction);
-
-      warningFunction(warningInput, text, (char*) stre);
-      fprintf(stderr, "warningFunction done\n");
-    }
-  }
-  else if ((type == 'E') || (type == 'P'))
-  {
-    if (errorFunction != NULL)
-    {
-      errorFunction(errorInput, text, (char*) stre);
-    }
-  }
-  else if ((type == 'X') || (type == 'x'))
+  if ((type == 'X') || (type == 'x'))
   {
     semGive();
 
@@ -2259,36 +2806,13 @@ LmStatus lmOut
     exit(tLev);
   }
 
-  if ((doClear == true) && (logLines >= atLines))
-  {
-    int i;
-
-    for (i = 0; i < FDS_MAX; i++)
-    {
-      if (fds[i].state == Occupied)
-      {
-        LmStatus s;
-
-        if (fds[i].type != Fichero)
-        {
-          continue;
-        }
-
-        if ((s = lmClear(i, keepLines, lastLines)) != LmsOk)
-        {
-          free(line);
-          free(format);
-          semGive();
-          return s;
-        }
-      }
-    }
-  }
+  lmFunctionsCall(text, type, stre);
 
   free(line);
   free(format);
   semGive();
-  return LmsOk;
+
+  return lmClearCheck();
 }
 
 
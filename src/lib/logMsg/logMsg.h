@@ -1479,6 +1479,24 @@ extern LmStatus lmOut
 
 
 
+/* ****************************************************************************
+*
+* lmAsyncStart - write the log lines from a writer thread instead of from lmOut
+*
+* Must be called after fork/daemonize, as the writer thread doesn't survive a fork.
+*/
+extern LmStatus lmAsyncStart(void);
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncFlush - write the log lines pending in asynchronous mode, returns the number of lines
+*/
+extern int lmAsyncFlush(void);
+
+
+
 /* ****************************************************************************
 *
 * lmOutHookSet - 
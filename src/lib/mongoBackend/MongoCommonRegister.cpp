@@ -38,6 +38,7 @@
 
 #include "mongoBackend/MongoCommonRegister.h"
 #include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/indexManager.h"
 #include "mongoBackend/TriggeredSubscription.h"
 
 using std::string;
@@ -537,6 +538,8 @@ HttpStatusCode processRegisterContext
 
   BSONObj regDoc = reg.obj();
 
+  indexesEnsure(tenant);
+
   LM_T(LmtMongo, ("upsert update() in '%s' collection: '%s'",
                   getRegistrationsCollectionName(tenant).c_str(),
                   regDoc.toString().c_str()));
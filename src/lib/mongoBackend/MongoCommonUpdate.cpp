@@ -23,6 +23,7 @@
 * Author: Fermín Galán
 *
 */
+#include <algorithm>
 #include <utility>
 #include <map>
 #include <string>
@@ -40,6 +41,10 @@
 #include "orionTypes/OrionValueType.h"
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/TriggeredSubscription.h"
+#include "mongoBackend/entityTypesCache.h"
+#include "mongoBackend/indexManager.h"
+#include "mongoBackend/subscriptionCache.h"
+#include "mongoBackend/subscriptionCounters.h"
 
 #include "ngsi/Scope.h"
 #include "rest/uriParamNames.h"
@@ -53,14 +58,14 @@ using std::auto_ptr;
 /* ****************************************************************************
 * Forward declarations
 */
-static void compoundValueBson(std::vector<orion::CompoundValueNode*> children, BSONObjBuilder& b);
+static void compoundValueBson(const std::vector<orion::CompoundValueNode*>& children, BSONObjBuilder& b);
 
 
 /* ****************************************************************************
 *
 * compoundValueBson (for arrays) -
 */
-static void compoundValueBson(std::vector<orion::CompoundValueNode*> children, BSONArrayBuilder& b)
+static void compoundValueBson(const std::vector<orion::CompoundValueNode*>& children, BSONArrayBuilder& b)
 {
   for (unsigned int ix = 0; ix < children.size(); ++ix)
   {
@@ -104,7 +109,7 @@ static void compoundValueBson(std::vector<orion::CompoundValueNode*> children, B
 *
 * compoundValueBson -
 */
-static void compoundValueBson(std::vector<orion::CompoundValueNode*> children, BSONObjBuilder& b)
+static void compoundValueBson(const std::vector<orion::CompoundValueNode*>& children, BSONObjBuilder& b)
 {
   for (unsigned int ix = 0; ix < children.size(); ++ix)
   {
@@ -925,75 +930,6 @@ static bool deleteAttribute
 }
 
 
-/* ****************************************************************************
-*
-* servicePathSubscriptionRegex -
-*
-* 1. If the incoming request is without service path, then only subscriptions without
-*    service path is a match (without or with '/#', or '/')
-* 2. If the incoming request has a service path, then the REGEX must be created:
-*    - Incoming: /a1/a2/a3
-*    - REGEX: ^/#$ | ^/a1/#$ | | ^/a1/a2/#$ | ^/a1/a2/a3/#$ | ^/a1/a2/a3$
-*
-*/
-std::string servicePathSubscriptionRegex(const std::string servicePath, std::vector<std::string>& spathV)
-{
-  std::string  spathRegex;
-  int          spathComponents = 0;
-
-
-  //
-  // Split Service Path in 'path components'
-  //
-  if (servicePath != "")
-  {
-    spathComponents = stringSplit(servicePath, '/', spathV);
-  }
-
-  if (spathComponents == 0)
-  {
-    spathRegex = "^$|^\\/#$|^\\/$";
-  }
-  else
-  {
-    //
-    // 1. Empty or '/#'
-    //
-    spathRegex = std::string("^$|^\\/#$");
-
-
-
-    //
-    // 2. The whole list /a | /a/b | /a/b/c  etc
-    //
-    for (int ix = 0; ix < spathComponents; ++ix)
-    {
-      spathRegex += std::string("|^");
-
-      for (int cIx = 0; cIx <= ix; ++cIx)
-      {
-        spathRegex += std::string("\\/") + spathV[cIx];
-      }
-
-      spathRegex += std::string("\\/#$");
-    }
-
-
-    //
-    // 3. EXACT service path
-    //
-    spathRegex += std::string("|^");
-    for (int cIx = 0; cIx < spathComponents; ++cIx)
-    {
-      spathRegex += std::string("\\/") + spathV[cIx];
-    }
-    spathRegex += std::string("$");
-  }
-
-  return spathRegex;
-}
-
-
 /* ****************************************************************************
 *
 * addTriggeredSubscriptions
@@ -1007,20 +943,33 @@ static bool addTriggeredSubscriptions
   std::map<string, TriggeredSubscription*>& subs,
   std::string&                              err,
   std::string                               tenant,
-  const std::vector<std::string>&           servicePathV
+  const std::vector<std::string>&           servicePathV,
+  TenantSubCache*                           batchSubsP = NULL
 )
 {
   DBClientBase*             connection      = NULL;
   std::string               servicePath     = (servicePathV.size() > 0)? servicePathV[0] : "";
-  std::string               spathRegex      = "";
-  std::vector<std::string>  spathV;
 
 
   //
-  // Create the REGEX for the Service Path
+  // If the subscription cache is in use, csubs is not queried at all (unless some pattern
+  // can only be evaluated by the database, see subCacheMatch).
+  // Neither it is in the batch write path, that has already read all the candidate subscriptions
   //
-  spathRegex = servicePathSubscriptionRegex(servicePath, spathV);
-  spathRegex = std::string("/") + spathRegex + "/";
+  if (subCacheActive())
+  {
+    if (subCacheMatch(tenant, entityId, entityType, attr, servicePath, subs))
+    {
+      return true;
+    }
+  }
+  else if (batchSubsP != NULL)
+  {
+    if (subCacheBatchMatch(batchSubsP, entityId, entityType, attr, servicePath, subs))
+    {
+      return true;
+    }
+  }
 
 
   /* Build query */
@@ -1029,8 +978,7 @@ static bool addTriggeredSubscriptions
   std::string entPatternQ  = CSUB_ENTITIES   "." CSUB_ENTITY_ISPATTERN;
   std::string condTypeQ    = CSUB_CONDITIONS "." CSUB_CONDITIONS_TYPE;
   std::string condValueQ   = CSUB_CONDITIONS "." CSUB_CONDITIONS_VALUE;
-  std::string inRegex      = "{ $in: [ " + spathRegex + ", null ] }";
-  BSONObj     spBson       = fromjson(inRegex);
+  BSONObj     spBson       = fillQuerySubscriptionServicePath(servicePath);
 
   /* Note the $or on entityType, to take into account matching in subscriptions with no entity type */
   BSONObj queryNoPattern = BSON(
@@ -1163,10 +1111,79 @@ static bool addTriggeredSubscriptions
 }
 
 
+/* ****************************************************************************
+*
+* updatedEntityDoc -
+*
+* The document of an entity as it is after an update, from the document before the update
+* ('r' and its attributes 'attrs') and the attributes in the $set and $unset of the update.
+* Only what is needed to render the entity in notifications is included (_id, attrs and location).
+*/
+static BSONObj updatedEntityDoc
+(
+  const BSONObj&      r,
+  const BSONObj&      attrs,
+  const BSONObj&      toSetObj,
+  const BSONObj&      toUnsetObj,
+  const std::string&  locAttr
+)
+{
+  const std::string                prefix = std::string(ENT_ATTRS) + ".";
+  std::map<std::string, BSONObj>   attrsMap;
+  std::set<std::string>            names;
+
+  attrs.getFieldNames(names);
+  for (std::set<std::string>::iterator it = names.begin(); it != names.end(); ++it)
+  {
+    attrsMap[*it] = attrs.getField(*it).embeddedObject();
+  }
+
+  names.clear();
+  toSetObj.getFieldNames(names);
+  for (std::set<std::string>::iterator it = names.begin(); it != names.end(); ++it)
+  {
+    if (it->compare(0, prefix.length(), prefix) == 0)
+    {
+      attrsMap[it->substr(prefix.length())] = toSetObj.getField(*it).embeddedObject();
+    }
+  }
+
+  names.clear();
+  toUnsetObj.getFieldNames(names);
+  for (std::set<std::string>::iterator it = names.begin(); it != names.end(); ++it)
+  {
+    if (it->compare(0, prefix.length(), prefix) == 0)
+    {
+      attrsMap.erase(it->substr(prefix.length()));
+    }
+  }
+
+  BSONObjBuilder  attrsB;
+  BSONObjBuilder  docB;
+
+  for (std::map<std::string, BSONObj>::iterator it = attrsMap.begin(); it != attrsMap.end(); ++it)
+  {
+    attrsB.append(it->first, it->second);
+  }
+
+  docB.append(r.getField("_id"));
+  docB.append(ENT_ATTRS, attrsB.obj());
+
+  if (locAttr.length() > 0)
+  {
+    docB.append(ENT_LOCATION, BSON(ENT_LOCATION_ATTRNAME << locAttr));
+  }
+
+  return docB.obj();
+}
+
+
 /* ****************************************************************************
 *
 * processSubscriptions
 *
+* entityDocP is the document of the entity after the update (or creation), used to build
+* the notifications instead of querying the entity again for each one of the subscriptions
 */
 static bool processSubscriptions
 (
@@ -1175,7 +1192,8 @@ static bool processSubscriptions
   std::string&                              err,
   std::string                               tenant,
   const std::string&                        xauthToken,
-  std::vector<std::string>                  servicePathV
+  std::vector<std::string>                  servicePathV,
+  const BSONObj*                            entityDocP
 )
 {
   DBClientBase* connection = NULL;
@@ -1189,6 +1207,12 @@ static bool processSubscriptions
     std::string             mapSubId  = it->first;
     TriggeredSubscription*  trigs     = it->second;
 
+    /* A lastNotification not yet flushed to csubs is more recent than the one in the database */
+    if (subCountersActive())
+    {
+      trigs->lastNotification = std::max(trigs->lastNotification, subCountersLastNotificationGet(tenant, mapSubId));
+    }
+
     if (trigs->throttling != 1 && trigs->lastNotification != 1)
     {
       long long current = getCurrentTime();
@@ -1218,45 +1242,59 @@ static bool processSubscriptions
                                  trigs->format,
                                  tenant,
                                  xauthToken,
-                                 servicePathV))
+                                 servicePathV,
+                                 entityDocP))
     {
-      BSONObj query = BSON("_id" << OID(mapSubId));
-      BSONObj update = BSON("$set" << BSON(CSUB_LASTNOTIFICATION << getCurrentTime()) <<
-                            "$inc" << BSON(CSUB_COUNT << 1));
+      long long lastNotification = getCurrentTime();
 
-      try
+      if (subCountersActive())
       {
-        LM_T(LmtMongo, ("update() in '%s' collection: {%s, %s}", getSubscribeContextCollectionName(tenant).c_str(),
-                        query.toString().c_str(),
-                        update.toString().c_str()));
-
-        connection = getMongoConnection();
-        connection->update(getSubscribeContextCollectionName(tenant).c_str(), query, update);
-        releaseMongoConnection(connection);
-
-        LM_I(("Database Operation Successful (update: %s, query: %s)",
-              update.toString().c_str(),
-              query.toString().c_str()));
+        /* Written to csubs by the next flush of the subscription counters */
+        subCountersNotified(tenant, mapSubId, lastNotification);
+        subCacheLastNotificationSet(tenant, mapSubId, lastNotification);
       }
-      catch (const DBException &e)
+      else
       {
-        releaseMongoConnection(connection);
+        BSONObj   query            = BSON("_id" << OID(mapSubId));
+        BSONObj   update           = BSON("$set" << BSON(CSUB_LASTNOTIFICATION << lastNotification) <<
+                                          "$inc" << BSON(CSUB_COUNT << 1));
 
-        err += std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
-          " - query(): " + query.toString() + " - update(): " + update.toString() + " - exception: " + e.what();
+        try
+        {
+          LM_T(LmtMongo, ("update() in '%s' collection: {%s, %s}", getSubscribeContextCollectionName(tenant).c_str(),
+                          query.toString().c_str(),
+                          update.toString().c_str()));
 
-        LM_E(("Database Error (%s)", err.c_str()));
-        ret = false;
-      }
-      catch (...)
-      {
-        releaseMongoConnection(connection);
+          connection = getMongoConnection();
+          connection->update(getSubscribeContextCollectionName(tenant).c_str(), query, update);
+          releaseMongoConnection(connection);
+
+          LM_I(("Database Operation Successful (update: %s, query: %s)",
+                update.toString().c_str(),
+                query.toString().c_str()));
+
+          subCacheLastNotificationSet(tenant, mapSubId, lastNotification);
+        }
+        catch (const DBException &e)
+        {
+          releaseMongoConnection(connection);
+
+          err += std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
+            " - query(): " + query.toString() + " - update(): " + update.toString() + " - exception: " + e.what();
+
+          LM_E(("Database Error (%s)", err.c_str()));
+          ret = false;
+        }
+        catch (...)
+        {
+          releaseMongoConnection(connection);
 
-        err += std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
-          " - query(): " + query.toString() + " - update(): " + update.toString() + " - exception: " + "generic";
+          err += std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
+            " - query(): " + query.toString() + " - update(): " + update.toString() + " - exception: " + "generic";
 
-        LM_E(("Database Error (%s)", err.c_str()));
-        ret = false;
+          LM_E(("Database Error (%s)", err.c_str()));
+          ret = false;
+        }
       }
     }
 
@@ -1388,7 +1426,8 @@ static bool processContextAttributeVector
   double&                                    coordLat,
   double&                                    coordLong,
   std::string                                tenant,
-  const std::vector<std::string>&            servicePathV
+  const std::vector<std::string>&            servicePathV,
+  TenantSubCache*                            batchSubsP = NULL
 )
 {
   EntityId*                            eP              = &cerP->contextElement.entityId;
@@ -1586,7 +1625,7 @@ static bool processContextAttributeVector
     {
       std::string err;
 
-      if (!addTriggeredSubscriptions(entityId, entityType, ca->name, subsToNotify, err, tenant, servicePathV))
+      if (!addTriggeredSubscriptions(entityId, entityType, ca->name, subsToNotify, err, tenant, servicePathV, batchSubsP))
       {
         cerP->statusCode.fill(SccReceiverInternalError, err);
         return false;
@@ -1642,27 +1681,82 @@ static bool processContextAttributeVector
 
 /* ****************************************************************************
 *
-* createEntity -
+* attrNamesGet - the attrNames array of an entity document
+*/
+static void attrNamesGet(const BSONObj& doc, std::vector<std::string>* namesV)
+{
+  BSONObjIterator it(doc.getObjectField(ENT_ATTRNAMES));
+
+  while (it.more())
+  {
+    namesV->push_back(it.next().str());
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* attrNamesDelta - the names an update adds to and removes from the attrNames of an entity
 *
+* 'r' is the entity before the update and 'toPushArr'/'toPullArr' the names of its $addToSet
+* and $pullAll (a name is removed as many times as it is in the attrNames of the entity).
 */
-static bool createEntity
+static void attrNamesDelta
 (
-  EntityId*                        eP,
-  ContextAttributeVector           attrsV,
-  std::string*                     errDetail,
-  std::string                      tenant,
-  const std::vector<std::string>&  servicePathV
+  const BSONObj&             r,
+  const BSONArray&           toPushArr,
+  const BSONArray&           toPullArr,
+  std::vector<std::string>*  addedV,
+  std::vector<std::string>*  removedV
 )
 {
-  DBClientBase* connection = NULL;
+  std::vector<std::string>  currentV;
+  std::set<std::string>     currentSet;
 
-  LM_T(LmtMongo, ("Entity not found in '%s' collection, creating it", getEntitiesCollectionName(tenant).c_str()));
+  attrNamesGet(r, &currentV);
+  currentSet.insert(currentV.begin(), currentV.end());
+
+  BSONObjIterator pushIt(toPushArr);
+  while (pushIt.more())
+  {
+    std::string name = pushIt.next().str();
+
+    if (currentSet.insert(name).second == true)
+    {
+      addedV->push_back(name);
+    }
+  }
 
-  /* Actually we don't know if this is the first entity (thus, the collection is being created) or not. However, we can
-   * invoke ensureLocationIndex() in anycase, given that it is harmless in the case the collection and index already
-   * exits (see docs.mongodb.org/manual/reference/method/db.collection.ensureIndex/)*/
-  ensureLocationIndex(tenant);
+  BSONObjIterator pullIt(toPullArr);
+  while (pullIt.more())
+  {
+    std::string name = pullIt.next().str();
+
+    for (unsigned int ix = 0; ix < currentV.size(); ++ix)
+    {
+      if (currentV[ix] == name)
+      {
+        removedV->push_back(name);
+      }
+    }
+  }
+}
 
+
+/* ****************************************************************************
+*
+* entityDocBuild - the document of a new entity
+*/
+static bool entityDocBuild
+(
+  EntityId*                        eP,
+  ContextAttributeVector           attrsV,
+  std::string*                     errDetail,
+  const std::vector<std::string>&  servicePathV,
+  BSONObj*                         docP
+)
+{
   if (!legalIdUsage(attrsV))
   {
     *errDetail =
@@ -1753,7 +1847,40 @@ static bool createEntity
                                                 "coordinates" << BSON_ARRAY(coordLong << coordLat))));
   }
 
-  BSONObj insertedDoc = insertedDocB.obj();
+  *docP = insertedDocB.obj();
+  return true;
+}
+
+
+/* ****************************************************************************
+*
+* createEntity -
+*
+*/
+static bool createEntity
+(
+  EntityId*                        eP,
+  ContextAttributeVector           attrsV,
+  std::string*                     errDetail,
+  std::string                      tenant,
+  const std::vector<std::string>&  servicePathV,
+  BSONObj*                         insertedDocP
+)
+{
+  DBClientBase* connection = NULL;
+
+  LM_T(LmtMongo, ("Entity not found in '%s' collection, creating it", getEntitiesCollectionName(tenant).c_str()));
+
+  /* The first entity of a new tenant creates its indexes, for the rest of the entities this is a lookup in memory */
+  indexesEnsure(tenant);
+
+  BSONObj insertedDoc;
+
+  if (!entityDocBuild(eP, attrsV, errDetail, servicePathV, &insertedDoc))
+  {
+    return false;
+  }
+
   LM_T(LmtMongo, ("insert() in '%s' collection: '%s'",
                   getEntitiesCollectionName(tenant).c_str(),
                   insertedDoc.toString().c_str()));
@@ -1789,6 +1916,15 @@ static bool createEntity
     return false;
   }
 
+  if (typesCacheActive())
+  {
+    std::vector<std::string> attrNamesV;
+
+    attrNamesGet(insertedDoc, &attrNamesV);
+    typesCacheEntityCreated(tenant, (servicePathV.size() == 0)? "" : servicePathV[0], eP->type, attrNamesV);
+  }
+
+  *insertedDocP = insertedDoc;
   return true;
 }
 
@@ -1949,74 +2085,242 @@ void searchContextProviders
 
 /* ****************************************************************************
 *
-* processContextElement -
+* entitiesFind - the documents of the entities collection matching 'query'
 *
-* 0. Preparations
-* 1. Preconditions
-* 2. Get the complete list of entities from mongo
+* The documents are owned copies, so they can be used after the cursor is gone.
 */
-void processContextElement
+static bool entitiesFind
 (
-  ContextElement*                      ceP,
-  UpdateContextResponse*               responseP,
-  const std::string&                   action,
-  const std::string&                   tenant,
-  const std::vector<std::string>&      servicePathV,
-  std::map<std::string, std::string>&  uriParams,   // FIXME P7: we need this to implement "restriction-based" filters
-  const std::string&                   xauthToken,
-  const std::string&                   caller
+  const std::string&     tenant,
+  const BSONObj&         query,
+  std::vector<BSONObj>*  docV,
+  std::string*           err
 )
 {
-  DBClientBase* connection = NULL;
-
-  /* Getting the entity in the request (helpful in other places) */
-  EntityId* enP = &ceP->entityId;
-
-  /* Not supporting isPattern = true currently */
-  if (isTrue(enP->isPattern))
-  {
-    buildGeneralErrorResponse(ceP, NULL, responseP, SccNotImplemented);
-    return;
-  }
+  DBClientBase*             connection = NULL;
+  auto_ptr<DBClientCursor>  cursor;
 
-  /* Check that UPDATE or APPEND is not used with attributes with empty value */
-  if (strcasecmp(action.c_str(), "update") == 0 || strcasecmp(action.c_str(), "append") == 0)
+  try
   {
-    for (unsigned int ix = 0; ix < ceP->contextAttributeVector.size(); ++ix)
-    {
-      ContextAttribute* aP = ceP->contextAttributeVector[ix];
+    LM_T(LmtMongo, ("query() in '%s' collection: '%s'",
+                    getEntitiesCollectionName(tenant).c_str(),
+                    query.toString().c_str()));
 
-      if (emptyAttributeValue(aP) && (aP->metadataVector.size() == 0))
-      {
-        ContextAttribute* ca = new ContextAttribute(aP);
+    connection = getMongoConnection();
+    cursor     = connection->query(getEntitiesCollectionName(tenant).c_str(), query);
 
-        buildGeneralErrorResponse(ceP, ca, responseP, SccInvalidParameter,
-                                  std::string("action: ") + action +
-                                  " - entity: [" + enP->toString(true) + "]" +
-                                  " - offending attribute: " + aP->toString() +
-                                  " - empty attribute not allowed in APPEND or UPDATE");
-        LM_W(("Bad Input (empty attribute not allowed in APPEND or UPDATE)"));
-        return;
-      }
+    /*
+     * We have observed that in some cases of DB errors (e.g. the database daemon is down) instead of
+     * raising an exception, the query() method sets the cursor to NULL. In this case, we raise the
+     * exception ourselves
+     */
+    if (cursor.get() == NULL)
+    {
+      throw DBException("Null cursor from mongo (details on this is found in the source code)", 0);
     }
-  }
 
-  /* Find entities (could be several, in the case of no type or isPattern=true) */
-  const std::string  idString          = "_id." ENT_ENTITY_ID;
-  const std::string  typeString        = "_id." ENT_ENTITY_TYPE;
-  const std::string  servicePathString = "_id." ENT_SERVICE_PATH;
-  BSONObjBuilder     bob;
-
-  bob.append(idString, enP->id);
+    while (cursor->more())
+    {
+      docV->push_back(cursor->next().getOwned());
+    }
+    releaseMongoConnection(connection);
 
-  if (enP->type != "")
-  {
-    bob.append(typeString, enP->type);
+    LM_I(("Database Operation Successful (%s)", query.toString().c_str()));
   }
+  catch (const DBException &e)
+  {
+    releaseMongoConnection(connection);
 
-  if (servicePathV.size() == 0)
+    *err = std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
+      " - query(): " + query.toString() +
+      " - exception: " + e.what();
+    LM_E(("Database Error ('%s', '%s')", query.toString().c_str(), e.what()));
+    return false;
+  }
+  catch (...)
+  {
+    releaseMongoConnection(connection);
+
+    *err = std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
+      " - query(): " + query.toString() +
+      " - exception: " + "generic";
+    LM_E(("Database Error ('%s', '%s')", query.toString().c_str(), "generic exception"));
+    return false;
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* UPDATE_BATCH_CHUNK - maximum number of operations in each command of the bulk write
+*
+* The same as the maxWriteBatchSize of mongod.
+*/
+#define UPDATE_BATCH_CHUNK  1000
+
+
+
+/* ****************************************************************************
+*
+* updateBatch - is the batch write path for multi-entity updateContext in use?
+*/
+static bool updateBatch = false;
+
+
+
+/* ****************************************************************************
+*
+* setUpdateBatch -
+*/
+void setUpdateBatch(bool active)
+{
+  updateBatch = active;
+}
+
+
+
+/* ****************************************************************************
+*
+* PendingWrite -
+*
+* An entity update or creation deferred by processContextElement in the batch write path,
+* with what is needed to complete its ContextElementResponse once the bulk write is done.
+* 'cerP' is already in the response, so the order of the responses is kept.
+*/
+typedef struct PendingWrite
+{
+  ContextElement*                           ceP;
+  ContextElementResponse*                   cerP;
+  bool                                      isInsert;
+  BSONObj                                   query;      // update only
+  BSONObj                                   doc;        // the update or the inserted document
+  BSONObj                                   notifyDoc;  // update only: the entity after the update
+  std::map<string, TriggeredSubscription*>  subsToNotify;
+  std::string                               err;        // filled by the bulk write in case of error
+  std::string                               subsErr;    // insert only: error getting the triggered subscriptions
+  std::string                               entitySPath;
+  std::string                               entityType;
+  std::vector<std::string>                  attrNamesAddedV;    // for the entity types cache
+  std::vector<std::string>                  attrNamesRemovedV;
+} PendingWrite;
+
+
+
+/* ****************************************************************************
+*
+* UpdateBatch -
+*
+* 'docsV' holds the entity documents found for each one of the context elements of the request
+* and 'subsP' the candidate subscriptions (NULL if the subscription cache is in use).
+*/
+struct UpdateBatch
+{
+  std::vector<std::vector<BSONObj> >  docsV;
+  TenantSubCache*                     subsP;
+  std::vector<PendingWrite*>          writeV;
+};
+
+
+
+/* ****************************************************************************
+*
+* servicePathFilterAppend - the service path part of the query of the entities to update
+*/
+static void servicePathFilterAppend(BSONObjBuilder& bob, const std::vector<std::string>& servicePathV)
+{
+  const std::string servicePathString = "_id." ENT_SERVICE_PATH;
+
+  if (servicePathV.size() == 0)
+  {
+    bob.append(servicePathString, BSON("$exists" << false));
+  }
+  else
+  {
+    bob.append(servicePathString, servicePathV[0]);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* processContextElement -
+*
+* 0. Preparations
+* 1. Preconditions
+* 2. Get the complete list of entities from mongo
+*
+* In the batch write path (batchP != NULL, see processContextElementVector) the entities
+* have already been read, the entity semaphore has already been taken and the writes to
+* the entities collection are deferred to updateBatchFlush
+*/
+void processContextElement
+(
+  ContextElement*                      ceP,
+  UpdateContextResponse*               responseP,
+  const std::string&                   action,
+  const std::string&                   tenant,
+  const std::vector<std::string>&      servicePathV,
+  std::map<std::string, std::string>&  uriParams,   // FIXME P7: we need this to implement "restriction-based" filters
+  const std::string&                   xauthToken,
+  const std::string&                   caller,
+  UpdateBatch*                         batchP,
+  int                                  batchIx
+)
+{
+  DBClientBase*    connection = NULL;
+  TenantSubCache*  batchSubsP = (batchP != NULL)? batchP->subsP : NULL;
+
+  /* Getting the entity in the request (helpful in other places) */
+  EntityId* enP = &ceP->entityId;
+
+  /* Not supporting isPattern = true currently */
+  if (isTrue(enP->isPattern))
+  {
+    buildGeneralErrorResponse(ceP, NULL, responseP, SccNotImplemented);
+    return;
+  }
+
+  /* Check that UPDATE or APPEND is not used with attributes with empty value */
+  if (strcasecmp(action.c_str(), "update") == 0 || strcasecmp(action.c_str(), "append") == 0)
+  {
+    for (unsigned int ix = 0; ix < ceP->contextAttributeVector.size(); ++ix)
+    {
+      ContextAttribute* aP = ceP->contextAttributeVector[ix];
+
+      if (emptyAttributeValue(aP) && (aP->metadataVector.size() == 0))
+      {
+        ContextAttribute* ca = new ContextAttribute(aP);
+
+        buildGeneralErrorResponse(ceP, ca, responseP, SccInvalidParameter,
+                                  std::string("action: ") + action +
+                                  " - entity: [" + enP->toString(true) + "]" +
+                                  " - offending attribute: " + aP->toString() +
+                                  " - empty attribute not allowed in APPEND or UPDATE");
+        LM_W(("Bad Input (empty attribute not allowed in APPEND or UPDATE)"));
+        return;
+      }
+    }
+  }
+
+  /* Find entities (could be several, in the case of no type or isPattern=true) */
+  const std::string  idString          = "_id." ENT_ENTITY_ID;
+  const std::string  typeString        = "_id." ENT_ENTITY_TYPE;
+  const std::string  servicePathString = "_id." ENT_SERVICE_PATH;
+  BSONObjBuilder     bob;
+
+  bob.append(idString, enP->id);
+
+  if (enP->type != "")
+  {
+    bob.append(typeString, enP->type);
+  }
+
+  if (servicePathV.size() == 0)
   {
-    bob.append(servicePathString, BSON("$exists" << false));
     LM_T(LmtServicePath, ("Updating entity '%s' (no Service Path), action '%s'",
                           ceP->entityId.id.c_str(),
                           action.c_str()));
@@ -2027,13 +2331,8 @@ void processContextElement
                           ceP->entityId.id.c_str(),
                           servicePathV[0].c_str(),
                           action.c_str()));
-
-    char               path[MAX_SERVICE_NAME_LEN];
-    slashEscape(servicePathV[0].c_str(), path, sizeof(path));
-
-    const std::string  servicePathValue  = std::string("^") + path + "$";
-    bob.appendRegex(servicePathString, servicePathValue);
   }
+  servicePathFilterAppend(bob, servicePathV);
 
 
   // FIXME P7: we build the filter for '?!exist=entity::type' directly at mongoBackend layer given that
@@ -2051,51 +2350,33 @@ void processContextElement
 
   BSONObj query = bob.obj();
 
-  auto_ptr<DBClientCursor> cursor;
+  //
+  // In the batch write path, the entities have already been read
+  //
+  std::vector<BSONObj>         foundV;
+  const std::vector<BSONObj>*  docVP     = &foundV;
+  int                          entitySem = -1;
 
-  try
+  if (batchP != NULL)
   {
-    LM_T(LmtMongo, ("query() in '%s' collection: '%s'",
-                    getEntitiesCollectionName(tenant).c_str(),
-                    query.toString().c_str()));
-
-    connection = getMongoConnection();
-    cursor     = connection->query(getEntitiesCollectionName(tenant).c_str(), query);
-
-    /*
-     * We have observed that in some cases of DB errors (e.g. the database daemon is down) instead of
-     * raising an exception, the query() method sets the cursor to NULL. In this case, we raise the
-     * exception ourselves
-     */
-    if (cursor.get() == NULL)
-    {
-      throw DBException("Null cursor from mongo (details on this is found in the source code)", 0);
-    }
-    releaseMongoConnection(connection);
-
-    LM_I(("Database Operation Successful (%s)", query.toString().c_str()));
+    docVP = &batchP->docsV[batchIx];
   }
-  catch (const DBException &e)
+  else
   {
-    releaseMongoConnection(connection);
+    std::string err;
 
-    buildGeneralErrorResponse(ceP, NULL, responseP, SccReceiverInternalError,
-                              std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
-                              " - query(): " + query.toString() +
-                              " - exception: " + e.what());
-    LM_E(("Database Error ('%s', '%s')", query.toString().c_str(), e.what()));
-    return;
-  }
-  catch (...)
-  {
-    releaseMongoConnection(connection);
+    //
+    // With the 'entity' mutex policy, the read-modify-write below is serialized per entity
+    // (instead of per request, as the global 'req' semaphore does)
+    //
+    entitySemTake(__FUNCTION__, tenant, (servicePathV.size() == 0)? "" : servicePathV[0], enP->id, &entitySem);
 
-    buildGeneralErrorResponse(ceP, NULL, responseP, SccReceiverInternalError,
-                              std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
-                              " - query(): " + query.toString() +
-                              " - exception: " + "generic");
-    LM_E(("Database Error ('%s', '%s')", query.toString().c_str(), "generic exception"));
-    return;
+    if (!entitiesFind(tenant, query, &foundV, &err))
+    {
+      buildGeneralErrorResponse(ceP, NULL, responseP, SccReceiverInternalError, err);
+      entitySemGive(__FUNCTION__, entitySem);
+      return;
+    }
   }
 
 
@@ -2108,9 +2389,9 @@ void processContextElement
   //
   int docs = 0;
 
-  while (cursor->more())
+  for (unsigned int dIx = 0; dIx < docVP->size(); ++dIx)
   {
-    BSONObj r = cursor->next();
+    const BSONObj& r = (*docVP)[dIx];
 
     LM_T(LmtMongo, ("retrieved document: '%s'", r.toString().c_str()));
     ++docs;
@@ -2141,7 +2422,13 @@ void processContextElement
     /* If the vector of Context Attributes is empty and the operation was DELETE, then delete the entity */
     if (strcasecmp(action.c_str(), "delete") == 0 && ceP->contextAttributeVector.size() == 0) {
       LM_T(LmtServicePath, ("Removing entity"));
-      removeEntity(entityId, entityType, cerP, tenant, entitySPath);
+      if (removeEntity(entityId, entityType, cerP, tenant, entitySPath) && typesCacheActive())
+      {
+        std::vector<std::string> attrNamesV;
+
+        attrNamesGet(r, &attrNamesV);
+        typesCacheEntityRemoved(tenant, entitySPath, entityType, attrNamesV);
+      }
       responseP->contextElementResponseVector.push_back(cerP);
       continue;
     }
@@ -2196,7 +2483,8 @@ void processContextElement
                                        coordLat,
                                        coordLong,
                                        tenant,
-                                       servicePathV))
+                                       servicePathV,
+                                       batchSubsP))
     {
       /* The entity wasn't actually modified, so we don't need to update it and we can continue with next one */
       // FIXME P8: the same three statements are at the end of the while loop. Refactor the code to have this
@@ -2270,22 +2558,43 @@ void processContextElement
       bob.append(typeString, entityType);
     }
 
-    // The servicePath of THIS object is entitySPath
-    char espath[MAX_SERVICE_NAME_LEN];
-    slashEscape(entitySPath.c_str(), espath, sizeof(espath));
-
-    // servicePathString from earlier in this function
+    // The servicePath of THIS object is entitySPath (servicePathString from earlier in this function)
     if (servicePathV.size() == 0)
     {
       bob.append(servicePathString, BSON("$exists" << false));
     }
     else
     {
-      bob.appendRegex(servicePathString, espath);
+      bob.append(servicePathString, entitySPath);
     }
 
     BSONObj query = bob.obj();
 
+    /* In the batch write path, the update is done (and the response completed) by updateBatchFlush */
+    if (batchP != NULL)
+    {
+      PendingWrite* pwP = new PendingWrite();
+
+      pwP->ceP          = ceP;
+      pwP->cerP         = cerP;
+      pwP->isInsert     = false;
+      pwP->query        = query;
+      pwP->doc          = updatedEntityObj;
+      pwP->notifyDoc    = updatedEntityDoc(r, attrs, toSetObj, toUnsetObj, locAttr);
+      pwP->subsToNotify = subsToNotify;
+      pwP->entitySPath  = entitySPath;
+      pwP->entityType   = entityType;
+
+      if (typesCacheActive())
+      {
+        attrNamesDelta(r, toPushArr, toPullArr, &pwP->attrNamesAddedV, &pwP->attrNamesRemovedV);
+      }
+
+      batchP->writeV.push_back(pwP);
+      responseP->contextElementResponseVector.push_back(cerP);
+      continue;
+    }
+
     try
     {
       LM_T(LmtMongo, ("update() in '%s' collection: {%s, %s}", getEntitiesCollectionName(tenant).c_str(),
@@ -2297,6 +2606,15 @@ void processContextElement
       releaseMongoConnection(connection);
 
       LM_I(("Database Operation Successful (update %s)", query.toString().c_str()));
+
+      if (typesCacheActive())
+      {
+        std::vector<std::string> addedV;
+        std::vector<std::string> removedV;
+
+        attrNamesDelta(r, toPushArr, toPullArr, &addedV, &removedV);
+        typesCacheAttrNamesChanged(tenant, entitySPath, entityType, addedV, removedV);
+      }
     }
     catch (const DBException &e)
     {
@@ -2330,9 +2648,12 @@ void processContextElement
     }
 
     /* Send notifications for each one of the ONCHANGE subscriptions accumulated by
-     * previous addTriggeredSubscriptions() invocations */
-    std::string err;
-    processSubscriptions(enP, subsToNotify, err, tenant, xauthToken, servicePathV);
+     * previous addTriggeredSubscriptions() invocations, built from the entity as it is
+     * after the update (no need to read it again from the database) */
+    std::string  err;
+    BSONObj      updatedDoc = updatedEntityDoc(r, attrs, toSetObj, toUnsetObj, locAttr);
+
+    processSubscriptions(enP, subsToNotify, err, tenant, xauthToken, servicePathV, &updatedDoc);
 
     //
     // processSubscriptions cleans up the triggered subscriptions; this call here to
@@ -2397,11 +2718,68 @@ void processContextElement
       cerP->statusCode.fill(SccContextElementNotFound);
       responseP->contextElementResponseVector.push_back(cerP);
     }
+    else if (batchP != NULL)   /* APPEND in the batch write path, the insert is done by updateBatchFlush */
+    {
+      std::string  errDetail;
+      BSONObj      doc;
+
+      if (!entityDocBuild(enP, ceP->contextAttributeVector, &errDetail, servicePathV, &doc))
+      {
+        cerP->statusCode.fill(SccInvalidParameter, errDetail);
+      }
+      else
+      {
+        PendingWrite* pwP = new PendingWrite();
+
+        pwP->ceP         = ceP;
+        pwP->cerP        = cerP;
+        pwP->isInsert    = true;
+        pwP->doc         = doc;
+        pwP->entitySPath = (servicePathV.size() == 0)? "" : servicePathV[0];
+        pwP->entityType  = enP->type;
+
+        if (typesCacheActive())
+        {
+          attrNamesGet(doc, &pwP->attrNamesAddedV);
+        }
+
+        std::string err;
+        bool        subsOk = true;
+
+        for (unsigned int ix = 0; (ix < ceP->contextAttributeVector.size()) && subsOk; ++ix)
+        {
+          subsOk = addTriggeredSubscriptions(enP->id,
+                                             enP->type,
+                                             ceP->contextAttributeVector.get(ix)->name,
+                                             pwP->subsToNotify,
+                                             err,
+                                             tenant,
+                                             servicePathV,
+                                             batchSubsP);
+        }
+
+        /*
+         * As in the non-batch path, an error getting the triggered subscriptions doesn't prevent
+         * the creation of the entity: it is inserted anyway, without notifications, and the error
+         * is reported in its response by updateBatchFlush (if the insert itself succeeds)
+         */
+        if (!subsOk)
+        {
+          releaseTriggeredSubscriptions(pwP->subsToNotify);
+          pwP->subsErr = err;
+        }
+
+        batchP->writeV.push_back(pwP);
+      }
+
+      responseP->contextElementResponseVector.push_back(cerP);
+    }
     else   /* APPEND */
     {
-      std::string errReason, errDetail;
+      std::string  errReason, errDetail;
+      BSONObj      insertedDoc;
 
-      if (!createEntity(enP, ceP->contextAttributeVector, &errDetail, tenant, servicePathV))
+      if (!createEntity(enP, ceP->contextAttributeVector, &errDetail, tenant, servicePathV, &insertedDoc))
       {
         cerP->statusCode.fill(SccInvalidParameter, errDetail);
       }
@@ -2426,14 +2804,425 @@ void processContextElement
           {
             cerP->statusCode.fill(SccReceiverInternalError, err);
             responseP->contextElementResponseVector.push_back(cerP);
+            entitySemGive(__FUNCTION__, entitySem);
             return;
           }
         }
 
-        processSubscriptions(enP, subsToNotify, errReason, tenant, xauthToken, servicePathV);
+        processSubscriptions(enP, subsToNotify, errReason, tenant, xauthToken, servicePathV, &insertedDoc);
       }
 
       responseP->contextElementResponseVector.push_back(cerP);
     }
   }
+
+  entitySemGive(__FUNCTION__, entitySem);
+}
+
+
+/* ****************************************************************************
+*
+* bulkWrite - the updates or inserts of 'writeV' with unordered 'update'/'insert' commands
+*
+* The commands are sent in chunks of UPDATE_BATCH_CHUNK operations. The error of each
+* operation that fails (or of all the operations of a chunk, if the whole command fails)
+* is left in its 'err' field.
+*/
+static void bulkWrite(const std::string& tenant, bool isInsert, const std::vector<PendingWrite*>& writeV)
+{
+  std::string  database   = composeDatabaseName(tenant);
+  std::string  collection = getEntitiesCollectionName(tenant).substr(database.length() + 1);
+
+  for (unsigned int start = 0; start < writeV.size(); start += UPDATE_BATCH_CHUNK)
+  {
+    unsigned int      end        = std::min(start + UPDATE_BATCH_CHUNK, (unsigned int) writeV.size());
+    BSONArrayBuilder  opsB;
+    BSONObj           result;
+    std::string       err;
+    DBClientBase*     connection = NULL;
+
+    for (unsigned int ix = start; ix < end; ++ix)
+    {
+      if (isInsert)
+      {
+        opsB.append(writeV[ix]->doc);
+      }
+      else
+      {
+        opsB.append(BSON("q" << writeV[ix]->query << "u" << writeV[ix]->doc));
+      }
+    }
+
+    BSONObj cmd = isInsert?
+      BSON("insert" << collection << "documents" << opsB.arr() << "ordered" << false) :
+      BSON("update" << collection << "updates"   << opsB.arr() << "ordered" << false);
+
+    LM_T(LmtMongo, ("runCommand() in '%s' database: '%s'", database.c_str(), cmd.toString().c_str()));
+
+    try
+    {
+      connection = getMongoConnection();
+      if (!connection->runCommand(database.c_str(), cmd, result))
+      {
+        err = result.getStringField("errmsg");
+      }
+      releaseMongoConnection(connection);
+
+      LM_I(("Database Operation Successful (%s)", result.toString().c_str()));
+    }
+    catch (const DBException& e)
+    {
+      releaseMongoConnection(connection);
+      err = e.what();
+    }
+    catch (...)
+    {
+      releaseMongoConnection(connection);
+      err = "generic";
+    }
+
+    if ((err == "") && result.hasField("writeConcernError"))
+    {
+      err = result.getObjectField("writeConcernError").getStringField("errmsg");
+    }
+
+    if (err != "")
+    {
+      LM_E(("Database Error ('%s', '%s')", cmd.toString().c_str(), err.c_str()));
+
+      for (unsigned int ix = start; ix < end; ++ix)
+      {
+        writeV[ix]->err = err;
+      }
+
+      continue;
+    }
+
+    if (result.hasField("writeErrors"))
+    {
+      std::vector<BSONElement> errorV = result.getField("writeErrors").Array();
+
+      for (unsigned int eIx = 0; eIx < errorV.size(); ++eIx)
+      {
+        BSONObj       writeError = errorV[eIx].embeddedObject();
+        unsigned int  ix         = start + writeError.getIntField("index");
+
+        if (ix < end)
+        {
+          writeV[ix]->err = writeError.getStringField("errmsg");
+        }
+      }
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* updateBatchFlush -
+*
+* Writes the pending updates and inserts of the batch and completes their responses the same way
+* processContextElement does after a single update or insert: notifications, context providers and
+* status code (including the errors, with the same codes and details).
+*/
+static void updateBatchFlush
+(
+  UpdateBatch*                     batchP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken
+)
+{
+  std::vector<PendingWrite*> updateV;
+  std::vector<PendingWrite*> insertV;
+
+  for (unsigned int ix = 0; ix < batchP->writeV.size(); ++ix)
+  {
+    if (batchP->writeV[ix]->isInsert)
+    {
+      insertV.push_back(batchP->writeV[ix]);
+    }
+    else
+    {
+      updateV.push_back(batchP->writeV[ix]);
+    }
+  }
+
+  bulkWrite(tenant, false, updateV);
+
+  if (insertV.size() > 0)
+  {
+    /* See createEntity */
+    indexesEnsure(tenant);
+    bulkWrite(tenant, true, insertV);
+  }
+
+  for (unsigned int ix = 0; ix < batchP->writeV.size(); ++ix)
+  {
+    PendingWrite*            pwP  = batchP->writeV[ix];
+    ContextElementResponse*  cerP = pwP->cerP;
+    EntityId*                enP  = &pwP->ceP->entityId;
+    std::string              err;
+
+    if (pwP->isInsert && (pwP->err != ""))
+    {
+      cerP->statusCode.fill(SccInvalidParameter,
+                            std::string("Database Error: collection: ") + getEntitiesCollectionName(tenant).c_str() +
+                            " - insert(): " + pwP->doc.toString() +
+                            " - exception: " + pwP->err);
+      LM_E(("Database Error (%s)", cerP->statusCode.details.c_str()));
+    }
+    else if (pwP->isInsert)
+    {
+      typesCacheEntityCreated(tenant, pwP->entitySPath, pwP->entityType, pwP->attrNamesAddedV);
+
+      if (pwP->subsErr != "")
+      {
+        cerP->statusCode.fill(SccReceiverInternalError, pwP->subsErr);
+      }
+      else
+      {
+        cerP->statusCode.fill(SccOk);
+        processSubscriptions(enP, pwP->subsToNotify, err, tenant, xauthToken, servicePathV, &pwP->doc);
+      }
+    }
+    else if (pwP->err != "")
+    {
+      cerP->statusCode.fill(SccReceiverInternalError,
+                            std::string("collection: ") + getEntitiesCollectionName(tenant).c_str() +
+                            " - update() query: " + pwP->query.toString() +
+                            " - update() doc: " + pwP->doc.toString() +
+                            " - exception: " + pwP->err);
+      LM_E(("Database Error (%s)", cerP->statusCode.details.c_str()));
+    }
+    else
+    {
+      typesCacheAttrNamesChanged(tenant, pwP->entitySPath, pwP->entityType, pwP->attrNamesAddedV, pwP->attrNamesRemovedV);
+
+      processSubscriptions(enP, pwP->subsToNotify, err, tenant, xauthToken, servicePathV, &pwP->notifyDoc);
+      searchContextProviders(tenant, servicePathV, *enP, pwP->ceP->contextAttributeVector, cerP);
+
+      // StatusCode may be set already (if so, we keep the existing value)
+      if (cerP->statusCode.code == SccNone)
+      {
+        cerP->statusCode.fill(SccOk);
+      }
+    }
+
+    releaseTriggeredSubscriptions(pwP->subsToNotify);
+    delete pwP;
+  }
+
+  batchP->writeV.clear();
+}
+
+
+
+/* ****************************************************************************
+*
+* updateBatchPossible -
+*
+* The batch write path is used for APPEND and UPDATE of several entities, as long as no entity id
+* is repeated in the request (the processing of an element must see the changes done by the previous
+* ones on the same entity) and no '!exist=entity::type' filter is used.
+*/
+static bool updateBatchPossible
+(
+  ContextElementVector*                cevP,
+  const std::string&                   action,
+  std::map<std::string, std::string>&  uriParams
+)
+{
+  std::set<std::string> idSet;
+
+  if (!updateBatch || (cevP->size() < 2))
+  {
+    return false;
+  }
+
+  if ((strcasecmp(action.c_str(), "update") != 0) && (strcasecmp(action.c_str(), "append") != 0))
+  {
+    return false;
+  }
+
+  if (uriParams[URI_PARAM_NOT_EXIST] == SCOPE_VALUE_ENTITY_TYPE)
+  {
+    return false;
+  }
+
+  for (unsigned int ix = 0; ix < cevP->size(); ++ix)
+  {
+    if (idSet.insert(cevP->get(ix)->entityId.id).second == false)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* updateBatchPrepare -
+*
+* Reads the entities of all the context elements with one single query (a $or of the queries
+* processContextElement would do for each one of them) and, if the subscription cache is not in use,
+* the ONCHANGE subscriptions that the attributes of the request may trigger.
+*
+* Returns false on database error.
+*/
+static bool updateBatchPrepare
+(
+  UpdateBatch*                     batchP,
+  ContextElementVector*            cevP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV
+)
+{
+  const std::string                    idString   = "_id." ENT_ENTITY_ID;
+  const std::string                    typeString = "_id." ENT_ENTITY_TYPE;
+  std::map<std::string, unsigned int>  ixById;
+  std::set<std::string>                attrSet;
+  BSONArrayBuilder                     orB;
+  BSONObjBuilder                       bob;
+  std::vector<BSONObj>                 foundV;
+  std::string                          err;
+
+  batchP->subsP = NULL;
+  batchP->docsV.resize(cevP->size());
+
+  for (unsigned int ix = 0; ix < cevP->size(); ++ix)
+  {
+    ContextElement*  ceP = cevP->get(ix);
+    BSONObjBuilder   entityB;
+
+    for (unsigned int aIx = 0; aIx < ceP->contextAttributeVector.size(); ++aIx)
+    {
+      attrSet.insert(ceP->contextAttributeVector[aIx]->name);
+    }
+
+    /* Not supported, processContextElement just returns an error */
+    if (isTrue(ceP->entityId.isPattern))
+    {
+      continue;
+    }
+
+    entityB.append(idString, ceP->entityId.id);
+    if (ceP->entityId.type != "")
+    {
+      entityB.append(typeString, ceP->entityId.type);
+    }
+
+    orB.append(entityB.obj());
+    ixById[ceP->entityId.id] = ix;
+  }
+
+  bob.append("$or", orB.arr());
+  servicePathFilterAppend(bob, servicePathV);
+
+  if ((ixById.size() > 0) && (!entitiesFind(tenant, bob.obj(), &foundV, &err)))
+  {
+    return false;
+  }
+
+  for (unsigned int ix = 0; ix < foundV.size(); ++ix)
+  {
+    BSONElement idField = foundV[ix].getField("_id");
+
+    if (idField.eoo() == true)
+    {
+      LM_E(("Database Error (error retrieving _id field in doc: %s)", foundV[ix].toString().c_str()));
+      continue;
+    }
+
+    std::string                                    entityId = STR_FIELD(idField.embeddedObject(), ENT_ENTITY_ID);
+    std::map<std::string, unsigned int>::iterator  it       = ixById.find(entityId);
+
+    if (it != ixById.end())
+    {
+      batchP->docsV[it->second].push_back(foundV[ix]);
+    }
+  }
+
+  if (!subCacheActive())
+  {
+    std::vector<std::string> attrV(attrSet.begin(), attrSet.end());
+
+    if ((batchP->subsP = subCacheBatchLoad(tenant, attrV)) == NULL)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* processContextElementVector -
+*
+* processContextElement for each one of the context elements of an updateContext request.
+*
+* With the batch write path (-updateBatch), for APPEND and UPDATE of several entities (see
+* updateBatchPossible), the entities are read with one single query, the subscriptions are
+* evaluated once for the whole request and the writes are sent as unordered bulk writes,
+* instead of a query, a csubs query per attribute and a write for each entity.
+* If the preparation of the batch fails, the elements are processed one by one.
+*/
+void processContextElementVector
+(
+  ContextElementVector*                cevP,
+  UpdateContextResponse*               responseP,
+  const std::string&                   action,
+  const std::string&                   tenant,
+  const std::vector<std::string>&      servicePathV,
+  std::map<std::string, std::string>&  uriParams,
+  const std::string&                   xauthToken,
+  const std::string&                   caller
+)
+{
+  if (updateBatchPossible(cevP, action, uriParams))
+  {
+    UpdateBatch               batch;
+    std::vector<std::string>  idV;
+    std::vector<int>          stripeV;
+
+    for (unsigned int ix = 0; ix < cevP->size(); ++ix)
+    {
+      idV.push_back(cevP->get(ix)->entityId.id);
+    }
+
+    entitySemTakeMany(__FUNCTION__, tenant, (servicePathV.size() == 0)? "" : servicePathV[0], idV, &stripeV);
+
+    if (updateBatchPrepare(&batch, cevP, tenant, servicePathV))
+    {
+      for (unsigned int ix = 0; ix < cevP->size(); ++ix)
+      {
+        processContextElement(cevP->get(ix), responseP, action, tenant, servicePathV, uriParams, xauthToken, caller, &batch, ix);
+      }
+
+      updateBatchFlush(&batch, tenant, servicePathV, xauthToken);
+
+      if (batch.subsP != NULL)
+      {
+        subCacheBatchRelease(batch.subsP);
+      }
+
+      entitySemGiveMany(__FUNCTION__, stripeV);
+      return;
+    }
+
+    LM_W(("Runtime Error (batch write path not possible, processing the entities one by one)"));
+    entitySemGiveMany(__FUNCTION__, stripeV);
+  }
+
+  for (unsigned int ix = 0; ix < cevP->size(); ++ix)
+  {
+    processContextElement(cevP->get(ix), responseP, action, tenant, servicePathV, uriParams, xauthToken, caller);
+  }
 }
@@ -26,11 +26,25 @@
 * Author: Fermín Galán
 */
 
+#include "ngsi/ContextElementVector.h"
 #include "ngsi10/UpdateContextResponse.h"
 #include "mongo/client/dbclient.h"
 
 using namespace mongo;
 
+/* ****************************************************************************
+*
+* UpdateBatch - state of the batch write path, see processContextElementVector
+*/
+struct UpdateBatch;
+
+/* ****************************************************************************
+*
+* setUpdateBatch - use the batch write path for multi-entity APPEND and UPDATE
+*
+*/
+extern void setUpdateBatch(bool active);
+
 /* ****************************************************************************
 *
 * processContextElement -
@@ -43,6 +57,22 @@ extern void processContextElement(ContextElement*                      ceP,
                                   const std::vector<std::string>&      servicePath,
                                   std::map<std::string, std::string>&  uriParams,   // FIXME P7: we need this to implement "restriction-based" filters
                                   const std::string&                   xauthToken,
-                                  const std::string&                   caller = "");
+                                  const std::string&                   caller  = "",
+                                  UpdateBatch*                         batchP  = NULL,
+                                  int                                  batchIx = -1);
+
+/* ****************************************************************************
+*
+* processContextElementVector -
+*
+*/
+extern void processContextElementVector(ContextElementVector*                cevP,
+                                        UpdateContextResponse*               responseP,
+                                        const std::string&                   action,
+                                        const std::string&                   tenant,
+                                        const std::vector<std::string>&      servicePath,
+                                        std::map<std::string, std::string>&  uriParams,
+                                        const std::string&                   xauthToken,
+                                        const std::string&                   caller = "");
 
 #endif
@@ -23,6 +23,7 @@
 * Author: Fermín Galán
 */
 #include <semaphore.h>
+#include <pthread.h>
 #include <regex.h>
 
 #include <string>
@@ -77,6 +78,26 @@ static std::string          subscribeContextAvailabilityCollectionName;
 static std::string          assocationsCollectionName;
 static Notifier*            notifier;
 static bool                 multitenant;
+static int                  countCacheTime = 0;
+
+
+
+/* ****************************************************************************
+*
+* Count cache -
+*
+* count() results of entitiesQuery, by tenant and query, used when countCacheTime > 0
+*/
+typedef struct CountCacheItem
+{
+  long long  count;
+  int        time;
+} CountCacheItem;
+
+#define COUNT_CACHE_MAX_ITEMS  10000
+
+static std::map<std::string, CountCacheItem>  countCache;
+static pthread_mutex_t                        countCacheMutex = PTHREAD_MUTEX_INITIALIZER;
 
 
 /* ****************************************************************************
@@ -119,7 +140,8 @@ bool mongoStart
   double       timeout,
   int          writeConcern,
   int          poolSize,
-  bool         semTimeStat
+  bool         semTimeStat,
+  int          poolMin
 )
 {
   static bool alreadyDone = false;
@@ -150,7 +172,8 @@ bool mongoStart
                               timeout,
                               writeConcern,
                               poolSize,
-                              semTimeStat) != 0)
+                              semTimeStat,
+                              poolMin) != 0)
   {
     LM_E(("Database Startup Error (cannot initialize mongo connection pool)"));
     return false;
@@ -271,6 +294,16 @@ extern void setDbPrefix(std::string _dbPrefix)
 }
 
 
+/*****************************************************************************
+*
+* setCountCacheTime -
+*/
+void setCountCacheTime(int seconds)
+{
+  countCacheTime = seconds;
+}
+
+
 /*****************************************************************************
 *
 * getOrionDatabases -
@@ -455,25 +488,6 @@ bool mongoLocationCapable(void)
 }
 
 
-/*****************************************************************************
-*
-* ensureLocationIndex -
-*/
-void ensureLocationIndex(std::string tenant)
-{
-  /* Ensure index for entity locations, in the case of using 2.4 */
-  if (mongoLocationCapable())
-  {
-    std::string   index      = ENT_LOCATION "." ENT_LOCATION_COORDS;
-    DBClientBase* connection = getMongoConnection();
-
-    connection->createIndex(getEntitiesCollectionName(tenant).c_str(), BSON(index << "2dsphere"));
-    releaseMongoConnection(connection);
-    LM_T(LmtMongo, ("ensuring 2dsphere index on %s (tenant %s)", index.c_str(), tenant.c_str()));
-  }
-}
-
-
 /* ****************************************************************************
 *
 * treatOnTimeIntervalSubscriptions -
@@ -764,84 +778,211 @@ static void fillQueryEntity(BSONArrayBuilder& ba, EntityId* enP)
 }
 
 
+/* ****************************************************************************
+*
+* SERVICE_PATH_FILTER_CACHE_SIZE -
+*
+* The filters of the service paths (or lists of service paths) in use are kept built. The
+* cache is cleared when it gets full, the hottest service paths are back at their next use.
+*/
+#define SERVICE_PATH_FILTER_CACHE_SIZE  1024
+
+
+/* ****************************************************************************
+*
+* Service path filter cache -
+*
+* The key is 'q' (fillQueryServicePath) or 's' (fillQuerySubscriptionServicePath) followed
+* by the service paths, separated by ','. BSONObj copies share the buffer, so the filters
+* are built only once.
+*/
+static std::map<std::string, BSONObj>  servicePathFilterCache;
+static pthread_rwlock_t                servicePathFilterRwlock = PTHREAD_RWLOCK_INITIALIZER;
+
+
+/* ****************************************************************************
+*
+* servicePathFilterLookup -
+*/
+static bool servicePathFilterLookup(const std::string& key, BSONObj* filterP)
+{
+  bool found = false;
+
+  pthread_rwlock_rdlock(&servicePathFilterRwlock);
+
+  std::map<std::string, BSONObj>::iterator it = servicePathFilterCache.find(key);
+
+  if (it != servicePathFilterCache.end())
+  {
+    *filterP = it->second;
+    found    = true;
+  }
+
+  pthread_rwlock_unlock(&servicePathFilterRwlock);
+
+  return found;
+}
+
+
+/* ****************************************************************************
+*
+* servicePathFilterInsert -
+*/
+static void servicePathFilterInsert(const std::string& key, const BSONObj& filter)
+{
+  pthread_rwlock_wrlock(&servicePathFilterRwlock);
+
+  if (servicePathFilterCache.size() >= SERVICE_PATH_FILTER_CACHE_SIZE)
+  {
+    servicePathFilterCache.clear();
+  }
+
+  servicePathFilterCache[key] = filter.getOwned();
+
+  pthread_rwlock_unlock(&servicePathFilterRwlock);
+}
+
+
 /* ****************************************************************************
 *
 * fillQueryServicePath -
 *
-* The regular expression for servicePath.
+* The filter for servicePath, built directly as BSON:
+*
+* o "/a/b":    equality, "/a/b"
+* o "/a/b/#":  "/a/b" and the anchored prefix regex /^\/a\/b\//. Without anything after the
+*              prefix (no '.*'), MongoDB turns the regex into the index range ["/a/b/", "/a/b0")
+*              of the _id.servicePath index, instead of scanning the whole index
+* o "/" or "/#" also match entities without service path (null)
 *
 * If the servicePath is empty, then we return all entities, no matter their servicePath. This
 * can be seen as a query on "/#" considering that entities without servicePath are implicitly
 * assigned to "/" service path.
+*
+* Service path components are alphanumeric (or '_'), no escaping is needed in the regexes.
 */
 BSONObj fillQueryServicePath(const std::vector<std::string>& servicePath)
 {
-  /* Due to limitations in the BSONArrayBuilder class (that hopefully will be solved in legacy-1.0.0
-   * MongoDB driver) we need to compose the JSON string, then apply fromjson() function. Current
-   * implementation uses an array element for each regex tokens, but we could use only
-   * one element, concatenating all regex tokens using "|" (not sure what is more efficient from a
-   * computational point of view). However, note that we need the $in array as "null" has to be added
-   * as element in any case.
-   *
-   * More information on: http://stackoverflow.com/questions/24243276/include-regex-elements-in-bsonarraybuilder
-   *
-   */
+  std::string  key = "q";
+  BSONObj      filter;
 
-  std::string servicePathValue = "";
+  for (unsigned int ix = 0; ix < servicePath.size(); ++ix)
+  {
+    key += servicePath[ix] + ",";
+  }
 
-  if (servicePath.size() > 0)
+  if (servicePathFilterLookup(key, &filter))
   {
-    bool nullAdded = false;
+    return filter;
+  }
 
-    servicePathValue += "{ $in: [ ";
+  BSONArrayBuilder  in;
+  bool              nullAdded = false;
 
-    for (unsigned int ix = 0 ; ix < servicePath.size(); ++ix)
-    {
-      LM_T(LmtServicePath, ("Service Path: '%s'", servicePath[ix].c_str()));
+  if (servicePath.size() == 0)
+  {
+    /* In this case, servicePath match any path, including the case of "null" */
+    in.appendRegex("^/");
+    in.appendNull();
+  }
 
-      //
-      // Add "null" in the following service path cases: / or /#. In order to avoid adding null
-      // several times, the nullAdded flag is used
-      //
-      if (!nullAdded && ((servicePath[ix] == "/") || (servicePath[ix] == "/#")))
-      {
-        servicePathValue += "null, ";
-        nullAdded = true;
-      }
+  for (unsigned int ix = 0; ix < servicePath.size(); ++ix)
+  {
+    const std::string&  path = servicePath[ix];
 
-      char path[MAX_SERVICE_NAME_LEN];
-      slashEscape(servicePath[ix].c_str(), path, sizeof(path));
+    LM_T(LmtServicePath, ("Service Path: '%s'", path.c_str()));
 
-      if (path[strlen(path) - 1] == '#')
-      {
-        /* Remove '\/#' trailing part of the string */
-        int l = strlen(path);
+    //
+    // Add "null" in the following service path cases: / or /#. In order to avoid adding null
+    // several times, the nullAdded flag is used
+    //
+    if (!nullAdded && ((path == "/") || (path == "/#")))
+    {
+      in.appendNull();
+      nullAdded = true;
+    }
 
-        path[l - 3] = 0;
-        servicePathValue += std::string("/^") + path + "$/, " + std::string("/^") + path + "\\/.*/";
-      }
-      else
-      {
-        servicePathValue += std::string("/^") + path + "$/";
-      }
+    if ((path.size() >= 2) && (path.compare(path.size() - 2, 2, "/#") == 0))
+    {
+      std::string base = path.substr(0, path.size() - 2);
 
-      /* Prepare concatenation for next token in regex */
-      if (ix < servicePath.size() - 1)
-      {
-        servicePathValue += std::string(", ");
-      }
+      in.append(base);
+      in.appendRegex("^" + base + "/");
+    }
+    else
+    {
+      in.append(path);
     }
+  }
+
+  filter = BSON("$in" << in.arr());
+  LM_T(LmtServicePath, ("Service Path filter: '%s'", filter.toString().c_str()));
+
+  servicePathFilterInsert(key, filter);
+
+  return filter;
+}
 
-    servicePathValue += " ] }";
-    LM_T(LmtServicePath, ("Service Path JSON string: '%s'", servicePathValue.c_str()));
+
+/* ****************************************************************************
+*
+* fillQuerySubscriptionServicePath -
+*
+* The filter for the servicePath of the subscriptions covering an entity in 'servicePath':
+*
+* 1. If the entity is without service path, then only subscriptions without service
+*    path are a match (without or with '/#', or '/')
+* 2. Otherwise, for entity in /a1/a2/a3:
+*    "", "/#", "/a1/#", "/a1/a2/#", "/a1/a2/a3/#" and "/a1/a2/a3"
+*
+* Subscriptions without servicePath (null) match in any case. All the elements are
+* equality matches.
+*/
+BSONObj fillQuerySubscriptionServicePath(const std::string& servicePath)
+{
+  std::string  key = "s" + servicePath;
+  BSONObj      filter;
+
+  if (servicePathFilterLookup(key, &filter))
+  {
+    return filter;
+  }
+
+  BSONArrayBuilder          in;
+  std::vector<std::string>  spathV;
+  int                       spathComponents = 0;
+
+  if (servicePath != "")
+  {
+    spathComponents = stringSplit(servicePath, '/', spathV);
+  }
+
+  in.append("");
+  in.append("/#");
+
+  if (spathComponents == 0)
+  {
+    in.append("/");
   }
   else
   {
-    /* In this case, servicePath match any path, including the case of "null" */
-    servicePathValue = "{$in: [ /^\\/.*/, null] }";
+    std::string path;
+
+    for (int ix = 0; ix < spathComponents; ++ix)
+    {
+      path += "/" + spathV[ix];
+      in.append(path + "/#");
+    }
+
+    in.append(path);
   }
 
-  return fromjson(servicePathValue);
+  in.appendNull();
+
+  filter = BSON("$in" << in.arr());
+  servicePathFilterInsert(key, filter);
+
+  return filter;
 }
 
 
@@ -1070,6 +1211,397 @@ Metadata* bsonToMetadata(BSONObj& mdB)
   return NULL;  
 }
 
+/* ****************************************************************************
+*
+* pageTokenEncode -
+*
+* The pagination token is the hexadecimal dump of the BSON document {c: <creDate>, i: <_id>}
+* taken from the last entity of a page. Entities created before creDate was introduced
+* don't have it, so 'c' is null for them.
+*/
+static std::string pageTokenEncode(const BSONObj& entity)
+{
+  static const char  hexV[] = "0123456789abcdef";
+  BSONObjBuilder     bob;
+
+  if (entity.hasField(ENT_CREATION_DATE))
+  {
+    bob.appendAs(entity.getField(ENT_CREATION_DATE), "c");
+  }
+  else
+  {
+    bob.appendNull("c");
+  }
+  bob.appendAs(entity.getField("_id"), "i");
+
+  BSONObj               key   = bob.obj();
+  const unsigned char*  dataP = (const unsigned char*) key.objdata();
+  std::string           token;
+
+  token.reserve(key.objsize() * 2);
+  for (int ix = 0; ix < key.objsize(); ++ix)
+  {
+    token += hexV[dataP[ix] >> 4];
+    token += hexV[dataP[ix] & 0x0F];
+  }
+
+  return token;
+}
+
+
+/* ****************************************************************************
+*
+* pageTokenKeyCheck -
+*
+* The token comes from the client, so its key is used in the query only if it has the shape
+* generated by pageTokenEncode: 'c' a number, a date or null and 'i' an entity _id, i.e. an
+* object with a string id and no other fields than type and servicePath, also strings (they are
+* missing in the _id of entities without type or created without service path). Otherwise an
+* operator could be injected in the {creDate: c, _id: {$gt: i}} condition.
+*/
+static bool pageTokenKeyCheck(const BSONObj& key)
+{
+  BSONElement creDate = key.getField("c");
+  BSONElement id      = key.getField("i");
+
+  if (creDate.eoo() || (!creDate.isNumber() && (creDate.type() != Date) && !creDate.isNull()))
+  {
+    return false;
+  }
+
+  if (id.eoo() || (id.type() != Object))
+  {
+    return false;
+  }
+
+  BSONObjIterator  iter(id.embeddedObject());
+  bool             idFound = false;
+
+  while (iter.more())
+  {
+    BSONElement  field = iter.next();
+    std::string  name  = field.fieldName();
+
+    if (((name != ENT_ENTITY_ID) && (name != ENT_ENTITY_TYPE) && (name != ENT_SERVICE_PATH)) || (field.type() != String))
+    {
+      return false;
+    }
+
+    if (name == ENT_ENTITY_ID)
+    {
+      idFound = true;
+    }
+  }
+
+  return idFound;
+}
+
+
+/* ****************************************************************************
+*
+* pageTokenDecode -
+*/
+static bool pageTokenDecode(const std::string& token, BSONObj* keyP)
+{
+  /* The smallest BSON document is 5 bytes long */
+  if ((token.length() < 10) || ((token.length() % 2) != 0))
+  {
+    return false;
+  }
+
+  std::string buf;
+
+  buf.reserve(token.length() / 2);
+  for (unsigned int ix = 0; ix < token.length(); ix += 2)
+  {
+    char hex[3] = { token[ix], token[ix + 1], 0 };
+
+    if (!isxdigit(hex[0]) || !isxdigit(hex[1]))
+    {
+      return false;
+    }
+
+    buf += (char) strtol(hex, NULL, 16);
+  }
+
+  /* The first 4 bytes of a BSON document are its (little endian) size */
+  const unsigned char* sizeP = (const unsigned char*) buf.data();
+  unsigned int         size  = sizeP[0] | (sizeP[1] << 8) | (sizeP[2] << 16) | (sizeP[3] << 24);
+
+  if (size != buf.size())
+  {
+    return false;
+  }
+
+  BSONObj key(buf.data());
+
+  if (!key.valid() || !pageTokenKeyCheck(key))
+  {
+    return false;
+  }
+
+  *keyP = key.getOwned();
+  return true;
+}
+
+
+/* ****************************************************************************
+*
+* pageTokenCheck -
+*/
+bool pageTokenCheck(const std::string& token)
+{
+  BSONObj key;
+
+  return pageTokenDecode(token, &key);
+}
+
+
+/* ****************************************************************************
+*
+* pageTokenQuery -
+*
+* Condition selecting the entities after the one in 'key' in {creDate: 1, _id: 1} order.
+* Entities without creDate come first in that order (as null/missing sort before numbers).
+*/
+static BSONObj pageTokenQuery(const BSONObj& key)
+{
+  BSONElement       creDate = key.getField("c");
+  BSONElement       id      = key.getField("i");
+  BSONArrayBuilder  after;
+
+  if (creDate.isNull())
+  {
+    after.append(BSON(ENT_CREATION_DATE << BSON("$exists" << true)));
+    after.append(BSON(ENT_CREATION_DATE << BSON("$exists" << false) << "_id" << BSON("$gt" << id)));
+  }
+  else
+  {
+    after.append(BSON(ENT_CREATION_DATE << BSON("$gt" << creDate)));
+    after.append(BSON(ENT_CREATION_DATE << creDate << "_id" << BSON("$gt" << id)));
+  }
+
+  return BSON("$or" << after.arr());
+}
+
+
+/* ****************************************************************************
+*
+* entitiesCount -
+*
+* count() of entities matching 'query', reusing a previous result for the same tenant and
+* query if it is not older than countCacheTime seconds. DBException is not catched, as in
+* the case of calling count() directly.
+*/
+static long long entitiesCount(DBClientBase* connection, const std::string& tenant, const BSONObj& query)
+{
+  if (countCacheTime <= 0)
+  {
+    return connection->count(getEntitiesCollectionName(tenant).c_str(), query);
+  }
+
+  std::string  key = tenant + '\0' + std::string(query.objdata(), query.objsize());
+  int          now = getCurrentTime();
+
+  pthread_mutex_lock(&countCacheMutex);
+
+  std::map<std::string, CountCacheItem>::iterator it = countCache.find(key);
+
+  if ((it != countCache.end()) && (now - it->second.time < countCacheTime))
+  {
+    long long count = it->second.count;
+
+    pthread_mutex_unlock(&countCacheMutex);
+    LM_T(LmtPagination, ("count from cache: %lld", count));
+    return count;
+  }
+
+  pthread_mutex_unlock(&countCacheMutex);
+
+  long long count = connection->count(getEntitiesCollectionName(tenant).c_str(), query);
+
+  pthread_mutex_lock(&countCacheMutex);
+
+  if (countCache.size() >= COUNT_CACHE_MAX_ITEMS)
+  {
+    countCache.clear();
+  }
+
+  countCache[key].count = count;
+  countCache[key].time  = now;
+
+  pthread_mutex_unlock(&countCacheMutex);
+
+  return count;
+}
+
+
+/* ****************************************************************************
+*
+* entityDocToContextElementResponse -
+*
+* Fills in 'cer' from a document of the entities collection, with the attributes in attrL
+* (all of them if attrL is empty), see entitiesQuery for 'includeEmpty'. The attributes in
+* attrL not found in the document are added with 'found' set to false.
+*
+* Returns false (with the error in the status code of 'cer') if the document has no attrs.
+*/
+bool entityDocToContextElementResponse
+(
+  const BSONObj&           r,
+  AttributeList&           attrL,
+  bool                     includeEmpty,
+  ContextElementResponse*  cer
+)
+{
+  /* Entity part */
+
+  BSONObj queryEntity = r.getObjectField("_id");
+
+  cer->contextElement.entityId.id          = STR_FIELD(queryEntity, ENT_ENTITY_ID);
+  cer->contextElement.entityId.type        = STR_FIELD(queryEntity, ENT_ENTITY_TYPE);
+  cer->contextElement.entityId.servicePath = STR_FIELD(queryEntity, ENT_SERVICE_PATH);
+  cer->contextElement.entityId.isPattern   = "false";
+
+  /* Get the location attribute (if it exists) */
+  std::string locAttr;
+  if (r.hasElement(ENT_LOCATION))
+  {
+    locAttr = r.getObjectField(ENT_LOCATION).getStringField(ENT_LOCATION_ATTRNAME);
+  }
+
+  /* Attributes part */
+  BSONObj queryAttrs;
+
+  //
+  // This try/catch should not be necessary as all document in the entities collection have an attrs embedded document
+  // from creation time. However, it adds an extra protection, just in case.
+  // Somebody *could* manipulate the mongo database and if so, the broker would crash here.
+  // Better to be on the safe side ...
+  //
+  try
+  {
+    queryAttrs = r.getField(ENT_ATTRS).embeddedObject();
+  }
+  catch (...)
+  {
+    LM_E(("Database Error (no attrs array in document of entities collection)"));
+    cer->statusCode.fill(SccReceiverInternalError, "attrs field missing in entity document");
+
+    return false;
+  }
+
+  std::set<std::string> attrNames;
+
+  queryAttrs.getFieldNames(attrNames);
+  for (std::set<std::string>::iterator i = attrNames.begin(); i != attrNames.end(); ++i)
+  {
+    std::string       attrName   = *i;
+    BSONObj           queryAttr  = queryAttrs.getField(attrName).embeddedObject();
+    ContextAttribute  ca;
+
+    ca.name = dbDotDecode(basePart(attrName));
+    std::string mdId = idPart(attrName);
+    ca.type = STR_FIELD(queryAttr, ENT_ATTRS_TYPE);
+
+    /* Note that includedAttribute decision is based on name and type. Value is set only if
+     * decision is positive
+     */
+    if (includedAttribute(ca, &attrL))
+    {
+      ContextAttribute* caP;
+
+      switch(queryAttr.getField(ENT_ATTRS_VALUE).type())
+      {
+      case String:
+        ca.stringValue = STR_FIELD(queryAttr, ENT_ATTRS_VALUE);
+        if (!includeEmpty && ca.stringValue.length() == 0)
+        {
+          continue;
+        }
+        caP = new ContextAttribute(ca.name, ca.type, ca.stringValue);
+        break;
+      case NumberDouble:
+        ca.numberValue = queryAttr.getField(ENT_ATTRS_VALUE).Number();
+        caP = new ContextAttribute(ca.name, ca.type, ca.numberValue);
+        break;
+      case Bool:
+        ca.boolValue = queryAttr.getBoolField(ENT_ATTRS_VALUE);
+        caP = new ContextAttribute(ca.name, ca.type, ca.boolValue);
+        break;
+      case Object:
+        caP = new ContextAttribute(ca.name, ca.type, "");
+        caP->compoundValueP = new orion::CompoundValueNode(orion::ValueTypeObject);
+        compoundObjectResponse(caP->compoundValueP, queryAttr.getField(ENT_ATTRS_VALUE));
+        break;
+      case Array:
+        caP = new ContextAttribute(ca.name, ca.type, "");
+        caP->compoundValueP = new orion::CompoundValueNode(orion::ValueTypeVector);
+        compoundVectorResponse(caP->compoundValueP, queryAttr.getField(ENT_ATTRS_VALUE));
+        break;
+      default:
+        LM_E(("Runtime Error (unknown attribute value type in DB: %d)", queryAttr.getField(ENT_ATTRS_VALUE).type()));
+        continue;
+      }
+
+      /* Setting ID (if found) */
+      if (mdId != "")
+      {
+        Metadata* md = new Metadata(NGSI_MD_ID, "string", mdId);
+
+        caP->metadataVector.push_back(md);
+      }
+
+      if (locAttr == ca.name)
+      {
+        Metadata* md = new Metadata(NGSI_MD_LOCATION, "string", LOCATION_WGS84);
+
+        caP->metadataVector.push_back(md);
+      }
+
+      /* Setting custom metadata (if any) */
+      if (queryAttr.hasField(ENT_ATTRS_MD))
+      {
+        std::vector<BSONElement> metadataV = queryAttr.getField(ENT_ATTRS_MD).Array();
+
+        for (unsigned int ix = 0; ix < metadataV.size(); ++ix)
+        {
+          BSONObj    metadata = metadataV[ix].embeddedObject();
+          Metadata*  md = bsonToMetadata(metadata);
+          caP->metadataVector.push_back(md);
+        }
+      }
+
+      cer->contextElement.contextAttributeVector.push_back(caP);
+    }
+  }
+
+  /* All the attributes existing in the request but not found in the response are added with 'found' set to false */
+  for (unsigned int ix = 0; ix < attrL.size(); ++ix)
+  {
+    bool         found     = false;
+    std::string  attrName  = attrL.get(ix);
+
+    for (unsigned int jx = 0; jx < cer->contextElement.contextAttributeVector.size(); ++jx)
+    {
+      if (attrName == cer->contextElement.contextAttributeVector.get(jx)->name)
+      {
+        found = true;
+        break;
+      }
+    }
+
+    if (!found)
+    {
+      ContextAttribute* caP = new ContextAttribute(attrName, "", "", false);
+      cer->contextElement.contextAttributeVector.push_back(caP);
+    }
+  }
+
+  return true;
+}
+
+
 /* ****************************************************************************
 *
 * entitiesQuery -
@@ -1083,6 +1615,10 @@ Metadata* bsonToMetadata(BSONObj& mdB)
 * subscribeContext case, as empty values can cause problems in the case of federating Context
 * Brokers (the notifyContext is processed as an updateContext and in the latter case, an
 * empty value causes an error)
+*
+* If pageTokenP is not NULL keyset pagination is used: the result is sorted by {creDate, _id},
+* offset is ignored and the page starts after the entity in the token (an empty token means
+* the first page). Thus, deep pages don't make the database skip 'offset' documents.
 */
 bool entitiesQuery
 (
@@ -1097,7 +1633,9 @@ bool entitiesQuery
   int                              offset,
   int                              limit,
   bool*                            limitReached,
-  long long*                       countP
+  long long*                       countP,
+  const std::string*               pageTokenP,
+  std::string*                     nextPageTokenP
 )
 {
   DBClientBase* connection = NULL;
@@ -1189,13 +1727,46 @@ bool entitiesQuery
     finalQuery.appendElements(filters[ix]);
   }
 
-  LM_T(LmtPagination, ("Offset: %d, Limit: %d, countP: %p", offset, limit, countP));
+  LM_T(LmtPagination, ("Offset: %d, Limit: %d, countP: %p, pageTokenP: %p", offset, limit, countP, pageTokenP));
+
+  /* Part 6: keyset pagination. Note that count() is done on the query without this part */
+  BSONObj bquery = finalQuery.obj();
+  BSONObj pageQuery;
+
+  if (pageTokenP != NULL)
+  {
+    BSONObj key;
+
+    offset = 0;
+    if (*pageTokenP != "")
+    {
+      if (!pageTokenDecode(*pageTokenP, &key))
+      {
+        *err = "bad pagination token";
+        LM_W(("Bad Input (%s)", err->c_str()));
+        return false;
+      }
+
+      BSONObjBuilder pageQueryBuilder;
+
+      pageQueryBuilder.appendElements(bquery);
+      pageQueryBuilder.append("$and", BSON_ARRAY(pageTokenQuery(key)));
+      pageQuery = pageQueryBuilder.obj();
+    }
+  }
 
   /* Do the query on MongoDB */
   auto_ptr<DBClientCursor>  cursor;
-  BSONObj                   bquery = finalQuery.obj();
-  Query                     query(bquery);
-  Query                     sortCriteria  = query.sort(BSON(ENT_CREATION_DATE << 1));
+  Query                     query(pageQuery.isEmpty()? bquery : pageQuery);
+
+  if (pageTokenP != NULL)
+  {
+    query.sort(BSON(ENT_CREATION_DATE << 1 << "_id" << 1));
+  }
+  else
+  {
+    query.sort(BSON(ENT_CREATION_DATE << 1));
+  }
 
   LM_T(LmtMongo, ("query() in '%s' collection: '%s'",
                   getEntitiesCollectionName(tenant).c_str(),
@@ -1206,7 +1777,7 @@ bool entitiesQuery
   {
     if (countP != NULL)
     {
-      *countP = connection->count(getEntitiesCollectionName(tenant).c_str(), bquery);
+      *countP = entitiesCount(connection, tenant, bquery);
     }
 
     cursor = connection->query(getEntitiesCollectionName(tenant).c_str(), query, limit, offset);
@@ -1246,6 +1817,8 @@ bool entitiesQuery
   }
 
   /* Process query result */
+  int docs = 0;
+
   while (cursor->more())
   {
     BSONObj                 r    = cursor->next();
@@ -1297,151 +1870,17 @@ bool entitiesQuery
     LM_T(LmtMongo, ("retrieved document: '%s'", r.toString().c_str()));
     cer->statusCode.fill(SccOk);
 
-    /* Entity part */
-
-    BSONObj queryEntity = r.getObjectField("_id");
-
-    cer->contextElement.entityId.id          = STR_FIELD(queryEntity, ENT_ENTITY_ID);
-    cer->contextElement.entityId.type        = STR_FIELD(queryEntity, ENT_ENTITY_TYPE);
-    cer->contextElement.entityId.servicePath = STR_FIELD(queryEntity, ENT_SERVICE_PATH);
-    cer->contextElement.entityId.isPattern   = "false";
-
-    /* Get the location attribute (if it exists) */
-    std::string locAttr;
-    if (r.hasElement(ENT_LOCATION))
+    if ((pageTokenP != NULL) && (nextPageTokenP != NULL) && (++docs == limit))
     {
-      locAttr = r.getObjectField(ENT_LOCATION).getStringField(ENT_LOCATION_ATTRNAME);
+      *nextPageTokenP = pageTokenEncode(r);
     }
 
-    /* Attributes part */
-    BSONObj queryAttrs;
-
-    //
-    // This try/catch should not be necessary as all document in the entities collection have an attrs embedded document
-    // from creation time. However, it adds an extra protection, just in case.
-    // Somebody *could* manipulate the mongo database and if so, the broker would crash here.
-    // Better to be on the safe side ...
-    //
-    try
-    {
-      queryAttrs = r.getField(ENT_ATTRS).embeddedObject();
-    }
-    catch (...)
+    if (!entityDocToContextElementResponse(r, attrL, includeEmpty, cer))
     {
-      LM_E(("Database Error (no attrs array in document of entities collection)"));
-      cer->statusCode.fill(SccReceiverInternalError, "attrs field missing in entity document");
       cerV->push_back(cer);
-
       return true;
     }
 
-    std::set<std::string> attrNames;
-
-    queryAttrs.getFieldNames(attrNames);
-    for (std::set<std::string>::iterator i = attrNames.begin(); i != attrNames.end(); ++i)
-    {
-      std::string       attrName   = *i;
-      BSONObj           queryAttr  = queryAttrs.getField(attrName).embeddedObject();
-      ContextAttribute  ca;
-
-      ca.name = dbDotDecode(basePart(attrName));
-      std::string mdId = idPart(attrName);
-      ca.type = STR_FIELD(queryAttr, ENT_ATTRS_TYPE);
-
-      /* Note that includedAttribute decision is based on name and type. Value is set only if
-       * decision is positive
-       */
-      if (includedAttribute(ca, &attrL))
-      {
-        ContextAttribute* caP;
-
-        switch(queryAttr.getField(ENT_ATTRS_VALUE).type())
-        {
-        case String:
-          ca.stringValue = STR_FIELD(queryAttr, ENT_ATTRS_VALUE);
-          if (!includeEmpty && ca.stringValue.length() == 0)
-          {
-            continue;
-          }
-          caP = new ContextAttribute(ca.name, ca.type, ca.stringValue);
-          break;
-        case NumberDouble:
-          ca.numberValue = queryAttr.getField(ENT_ATTRS_VALUE).Number();
-          caP = new ContextAttribute(ca.name, ca.type, ca.numberValue);
-          break;
-        case Bool:
-          ca.boolValue = queryAttr.getBoolField(ENT_ATTRS_VALUE);
-          caP = new ContextAttribute(ca.name, ca.type, ca.boolValue);
-          break;
-        case Object:
-          caP = new ContextAttribute(ca.name, ca.type, "");
-          caP->compoundValueP = new orion::CompoundValueNode(orion::ValueTypeObject);
-          compoundObjectResponse(caP->compoundValueP, queryAttr.getField(ENT_ATTRS_VALUE));
-          break;
-        case Array:
-          caP = new ContextAttribute(ca.name, ca.type, "");
-          caP->compoundValueP = new orion::CompoundValueNode(orion::ValueTypeVector);
-          compoundVectorResponse(caP->compoundValueP, queryAttr.getField(ENT_ATTRS_VALUE));
-          break;
-        default:
-          LM_E(("Runtime Error (unknown attribute value type in DB: %d)", queryAttr.getField(ENT_ATTRS_VALUE).type()));
-          continue;
-        }
-
-        /* Setting ID (if found) */
-        if (mdId != "")
-        {
-          Metadata* md = new Metadata(NGSI_MD_ID, "string", mdId);
-
-          caP->metadataVector.push_back(md);
-        }
-
-        if (locAttr == ca.name)
-        {
-          Metadata* md = new Metadata(NGSI_MD_LOCATION, "string", LOCATION_WGS84);
-
-          caP->metadataVector.push_back(md);
-        }
-
-        /* Setting custom metadata (if any) */
-        if (queryAttr.hasField(ENT_ATTRS_MD))
-        {
-          std::vector<BSONElement> metadataV = queryAttr.getField(ENT_ATTRS_MD).Array();
-
-          for (unsigned int ix = 0; ix < metadataV.size(); ++ix)
-          {
-            BSONObj    metadata = metadataV[ix].embeddedObject();
-            Metadata*  md = bsonToMetadata(metadata);
-            caP->metadataVector.push_back(md);
-          }
-        }
-
-        cer->contextElement.contextAttributeVector.push_back(caP);
-      }
-    }
-
-    /* All the attributes existing in the request but not found in the response are added with 'found' set to false */
-    for (unsigned int ix = 0; ix < attrL.size(); ++ix)
-    {
-      bool         found     = false;
-      std::string  attrName  = attrL.get(ix);
-
-      for (unsigned int jx = 0; jx < cer->contextElement.contextAttributeVector.size(); ++jx)
-      {
-        if (attrName == cer->contextElement.contextAttributeVector.get(jx)->name)
-        {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found)
-      {
-        ContextAttribute* caP = new ContextAttribute(attrName, "", "", false);
-        cer->contextElement.contextAttributeVector.push_back(caP);
-      }
-    }
-
     cer->statusCode.fill(SccOk);
     cerV->push_back(cer);
   }
@@ -1956,6 +2395,10 @@ AttributeList subToAttributeList(BSONObj sub)
 * on condValues is omitted (this is the case when this function is called from updateContext,
 * where the previous query on csubs ensures that that condition is true)
 *
+* In case 2, the caller may pass the document of the entity as it is after the update in
+* entityDocP, so the notification is built from it (projecting the attributes in attrL),
+* saving a query per triggered subscription.
+*
 * This method returns true if the notification was actually send. Otherwise, false
 * is returned. This is used in the caller to know if lastNotification field in the
 * subscription document in csubs collection has to be modified or not.
@@ -1970,7 +2413,8 @@ bool processOnChangeCondition
   Format                           format,
   std::string                      tenant,
   const std::string&               xauthToken,
-  const std::vector<std::string>&  servicePathV
+  const std::vector<std::string>&  servicePathV,
+  const BSONObj*                   entityDocP
 )
 {
   // FIXME P10: we are using dummy scope at the moment, until subscription scopes get implemented
@@ -1979,7 +2423,21 @@ bool processOnChangeCondition
   Restriction                   res;
   ContextElementResponseVector  rawCerV;
 
-  if (!entitiesQuery(enV, attrL, res, &rawCerV, &err, false, tenant, servicePathV))
+  if (entityDocP != NULL)
+  {
+    ContextElementResponse* cerP = new ContextElementResponse();
+
+    rawCerV.push_back(cerP);
+
+    if (!entityDocToContextElementResponse(*entityDocP, attrL, false, cerP))
+    {
+      rawCerV.release();
+      return false;
+    }
+
+    cerP->statusCode.fill(SccOk);
+  }
+  else if (!entitiesQuery(enV, attrL, res, &rawCerV, &err, false, tenant, servicePathV))
   {
     ncr.contextElementResponseVector.release();
     rawCerV.release();
@@ -2006,7 +2464,14 @@ bool processOnChangeCondition
 
       // FIXME P10: we are using dummy scope by the moment, until subscription scopes get implemented
       // FIXME P10: we are using an empty service path vector until serive paths get implemented for subscriptions
-      if (!entitiesQuery(enV, emptyList, res, &rawCerV, &err, false, tenant, servicePathV))
+      if (entityDocP != NULL)
+      {
+        ContextElementResponse* cerP = new ContextElementResponse();
+
+        rawCerV.push_back(cerP);
+        entityDocToContextElementResponse(*entityDocP, emptyList, false, cerP);
+      }
+      else if (!entitiesQuery(enV, emptyList, res, &rawCerV, &err, false, tenant, servicePathV))
       {
         rawCerV.release();
         ncr.contextElementResponseVector.release();
@@ -163,7 +163,8 @@ extern bool mongoStart
   double      timeout,
   int         writeConcern = 1,
   int         poolSize     = 10,
-  bool        semTimeStat  = false
+  bool        semTimeStat  = false,
+  int         poolMin      = 1
 );
 
 
@@ -207,6 +208,15 @@ extern void releaseMongoConnection(DBClientBase* connection);
 */
 extern void setDbPrefix(std::string dbPrefix);
 
+/*****************************************************************************
+*
+* setCountCacheTime -
+*
+* Seconds a count() result of entitiesQuery is reused for the same tenant and query.
+* 0 (the default) means that count() is run for every request.
+*/
+extern void setCountCacheTime(int seconds);
+
 /*****************************************************************************
 *
 * getOrionDatabases -
@@ -291,12 +301,6 @@ extern std::string getAssociationsCollectionName(std::string tenant);
 */
 extern bool mongoLocationCapable(void);
 
-/*****************************************************************************
-*
-* ensureLocationIndex -
-*/
-extern void ensureLocationIndex(std::string tenant);
-
 /* ****************************************************************************
 *
 * recoverOntimeIntervalThreads -
@@ -341,10 +345,29 @@ extern bool includedAttribute(ContextAttribute attr, AttributeList* attrsV);
 */
 extern Metadata* bsonToMetadata(BSONObj& mdB);
 
+/* ****************************************************************************
+*
+* entityDocToContextElementResponse -
+*
+* Fills in 'cer' from a document of the entities collection, as entitiesQuery does for each
+* of the documents it finds. Returns false if the document has no attrs field.
+*/
+extern bool entityDocToContextElementResponse
+(
+  const BSONObj&           r,
+  AttributeList&           attrL,
+  bool                     includeEmpty,
+  ContextElementResponse*  cer
+);
+
 /* ****************************************************************************
 *
 * entitiesQuery -
 *
+* If 'pageTokenP' is not NULL, keyset pagination is used instead of offset: entities are sorted
+* by creation date and _id, 'offset' is ignored and the page starts right after the entity
+* identified by *pageTokenP (at the beginning if empty). If a full page is returned, the token
+* of the next page is set in 'nextPageTokenP' (if not NULL).
 */
 extern bool entitiesQuery
 (
@@ -356,12 +379,23 @@ extern bool entitiesQuery
   bool                             includeEmpty,
   std::string                      tenant,
   const std::vector<std::string>&  servicePath,
-  int                              offset       = DEFAULT_PAGINATION_OFFSET_INT,
-  int                              limit        = DEFAULT_PAGINATION_LIMIT_INT,
-  bool*                            limitReached = NULL,
-  long long*                       countP       = NULL
+  int                              offset         = DEFAULT_PAGINATION_OFFSET_INT,
+  int                              limit          = DEFAULT_PAGINATION_LIMIT_INT,
+  bool*                            limitReached   = NULL,
+  long long*                       countP         = NULL,
+  const std::string*               pageTokenP     = NULL,
+  std::string*                     nextPageTokenP = NULL
 );
 
+/* ****************************************************************************
+*
+* pageTokenCheck -
+*
+* Returns true if 'token' is a well formed pagination token, as returned by entitiesQuery
+* in 'nextPageTokenP'
+*/
+extern bool pageTokenCheck(const std::string& token);
+
 /* ****************************************************************************
 *
 * pruneContextElements -
@@ -419,6 +453,8 @@ extern void processOntimeIntervalCondition(std::string subId, int interval, std:
 *
 * processOnChangeCondition -
 *
+* If 'entityDocP' is not NULL, it is the (up to date) document of the only entity in enV,
+* used instead of querying the entities collection.
 */
 extern bool processOnChangeCondition
 (
@@ -430,7 +466,8 @@ extern bool processOnChangeCondition
   Format                           format,
   std::string                      tenant,
   const std::string&               xauthToken,
-  const std::vector<std::string>&  servicePathV
+  const std::vector<std::string>&  servicePathV,
+  const BSONObj*                   entityDocP = NULL
 );
 
 /* ****************************************************************************
@@ -484,6 +521,13 @@ extern void releaseTriggeredSubscriptions(std::map<std::string, TriggeredSubscri
 */
 extern BSONObj fillQueryServicePath(const std::vector<std::string>& servicePath);
 
+/* ****************************************************************************
+*
+* fillQuerySubscriptionServicePath -
+*
+*/
+extern BSONObj fillQuerySubscriptionServicePath(const std::string& servicePath);
+
 /* ****************************************************************************
 *
 * fillContextProviders -
@@ -0,0 +1,417 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/entityTypesCache.h"
+
+
+
+/* ****************************************************************************
+*
+* TypeSummary - the entities of a type in a service path
+*
+* 'attrs' holds, for each attribute name, the number of times it appears in the attrNames
+* of those entities (the same that $unwind of attrNames would give).
+*/
+typedef struct TypeSummary
+{
+  long long                         entities;
+  std::map<std::string, long long>  attrs;
+
+  TypeSummary(): entities(0) {}
+} TypeSummary;
+
+typedef std::map<std::string, TypeSummary>  TypeMap;         // entity type -> summary
+typedef std::map<std::string, TypeMap>      ServicePathMap;  // service path -> types
+
+
+
+/* ****************************************************************************
+*
+* Globals -
+*/
+static bool                                   cacheActive = false;
+static std::map<std::string, ServicePathMap>  cache;
+static std::set<std::string>                  failedTenants;
+static pthread_mutex_t                        cacheMutex  = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/* ****************************************************************************
+*
+* typesCacheInit -
+*/
+void typesCacheInit(bool active)
+{
+  cacheActive = active;
+}
+
+
+
+/* ****************************************************************************
+*
+* typesCacheActive -
+*/
+bool typesCacheActive(void)
+{
+  return cacheActive;
+}
+
+
+
+/* ****************************************************************************
+*
+* aggregate - run an aggregation on the entities collection of a tenant, returning its result array
+*/
+static bool aggregate(const std::string& tenant, const BSONArray& pipeline, std::vector<BSONElement>* resultV, BSONObj* resultP)
+{
+  DBClientBase*  connection = NULL;
+  BSONObj        cmd        = BSON("aggregate" << COL_ENTITIES << "pipeline" << pipeline);
+
+  LM_T(LmtMongo, ("runCommand() in '%s' database: '%s'", composeDatabaseName(tenant).c_str(), cmd.toString().c_str()));
+
+  try
+  {
+    connection = getMongoConnection();
+    connection->runCommand(composeDatabaseName(tenant).c_str(), cmd, *resultP);
+    releaseMongoConnection(connection);
+
+    *resultV = resultP->getField("result").Array();
+    LM_I(("Database Operation Successful (%s)", cmd.toString().c_str()));
+  }
+  catch (const DBException& e)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (database: %s - command: %s - exception: %s)",
+          composeDatabaseName(tenant).c_str(), cmd.toString().c_str(), e.what()));
+    return false;
+  }
+  catch (...)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (database: %s - command: %s - exception: generic)",
+          composeDatabaseName(tenant).c_str(), cmd.toString().c_str()));
+    return false;
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* typesCacheLoad -
+*
+* db.runCommand({aggregate: "entities",
+*                pipeline: [ {$group: {_id: {type: "$_id.type", servicePath: "$_id.servicePath"}, n: {$sum: 1}}} ]})
+*
+* db.runCommand({aggregate: "entities",
+*                pipeline: [ {$project: {_id: 1, attrNames: 1}},
+*                            {$unwind: "$attrNames"},
+*                            {$group: {_id: {type: "$_id.type", servicePath: "$_id.servicePath", attr: "$attrNames"},
+*                                      n: {$sum: 1}}} ]})
+*
+* It is done at startup, before any request is served, so no update of the summary can be lost.
+*/
+void typesCacheLoad(const std::string& tenant)
+{
+  if (!cacheActive)
+  {
+    return;
+  }
+
+  const std::string         typeField  = "$_id." ENT_ENTITY_TYPE;
+  const std::string         spathField = "$_id." ENT_SERVICE_PATH;
+  const std::string         attrField  = "$" ENT_ATTRNAMES;
+  std::vector<BSONElement>  entitiesV;
+  std::vector<BSONElement>  attrsV;
+  BSONObj                   entitiesResult;
+  BSONObj                   attrsResult;
+  ServicePathMap            spMap;
+  long long                 entities   = 0;
+
+  BSONArray entitiesPipeline = BSON_ARRAY(
+    BSON("$group" << BSON("_id" << BSON("type" << typeField << "servicePath" << spathField) <<
+                          "n"   << BSON("$sum" << 1))));
+
+  BSONArray attrsPipeline = BSON_ARRAY(
+    BSON("$project" << BSON("_id" << 1 << ENT_ATTRNAMES << 1)) <<
+    BSON("$unwind"  << attrField) <<
+    BSON("$group"   << BSON("_id" << BSON("type" << typeField << "servicePath" << spathField << "attr" << attrField) <<
+                            "n"   << BSON("$sum" << 1))));
+
+  if (!aggregate(tenant, entitiesPipeline, &entitiesV, &entitiesResult) ||
+      !aggregate(tenant, attrsPipeline, &attrsV, &attrsResult))
+  {
+    LM_E(("Runtime Error (entity types cache not loaded for tenant '%s', contextTypes requests will aggregate)", tenant.c_str()));
+
+    pthread_mutex_lock(&cacheMutex);
+    failedTenants.insert(tenant);
+    cache.erase(tenant);
+    pthread_mutex_unlock(&cacheMutex);
+    return;
+  }
+
+  for (unsigned int ix = 0; ix < entitiesV.size(); ++ix)
+  {
+    BSONObj      item = entitiesV[ix].embeddedObject();
+    BSONObj      id   = item.getObjectField("_id");
+    TypeSummary& ts   = spMap[id.getStringField("servicePath")][id.getStringField("type")];
+
+    ts.entities  = item.getField("n").numberLong();
+    entities    += ts.entities;
+  }
+
+  for (unsigned int ix = 0; ix < attrsV.size(); ++ix)
+  {
+    BSONObj      item = attrsV[ix].embeddedObject();
+    BSONObj      id   = item.getObjectField("_id");
+    TypeSummary& ts   = spMap[id.getStringField("servicePath")][id.getStringField("type")];
+
+    ts.attrs[id.getStringField("attr")] = item.getField("n").numberLong();
+  }
+
+  pthread_mutex_lock(&cacheMutex);
+  failedTenants.erase(tenant);
+  cache[tenant].swap(spMap);
+  pthread_mutex_unlock(&cacheMutex);
+
+  LM_I(("Entity types cache loaded: %lld entities (tenant '%s')", entities, tenant.c_str()));
+}
+
+
+
+/* ****************************************************************************
+*
+* summaryUpdate -
+*/
+static void summaryUpdate
+(
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::string&               entityType,
+  int                              entitiesDelta,
+  const std::vector<std::string>&  addedV,
+  const std::vector<std::string>&  removedV
+)
+{
+  if (!cacheActive)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&cacheMutex);
+
+  TypeMap&      types = cache[tenant][servicePath];
+  TypeSummary&  ts    = types[entityType];
+
+  ts.entities += entitiesDelta;
+
+  for (unsigned int ix = 0; ix < addedV.size(); ++ix)
+  {
+    ++ts.attrs[addedV[ix]];
+  }
+
+  for (unsigned int ix = 0; ix < removedV.size(); ++ix)
+  {
+    std::map<std::string, long long>::iterator it = ts.attrs.find(removedV[ix]);
+
+    if ((it != ts.attrs.end()) && (--it->second <= 0))
+    {
+      ts.attrs.erase(it);
+    }
+  }
+
+  if (ts.entities <= 0)
+  {
+    types.erase(entityType);
+
+    if (types.size() == 0)
+    {
+      cache[tenant].erase(servicePath);
+    }
+  }
+
+  pthread_mutex_unlock(&cacheMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* typesCacheEntityCreated -
+*/
+void typesCacheEntityCreated
+(
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::string&               entityType,
+  const std::vector<std::string>&  attrNamesV
+)
+{
+  summaryUpdate(tenant, servicePath, entityType, 1, attrNamesV, std::vector<std::string>());
+}
+
+
+
+/* ****************************************************************************
+*
+* typesCacheEntityRemoved -
+*/
+void typesCacheEntityRemoved
+(
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::string&               entityType,
+  const std::vector<std::string>&  attrNamesV
+)
+{
+  summaryUpdate(tenant, servicePath, entityType, -1, std::vector<std::string>(), attrNamesV);
+}
+
+
+
+/* ****************************************************************************
+*
+* typesCacheAttrNamesChanged -
+*/
+void typesCacheAttrNamesChanged
+(
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::string&               entityType,
+  const std::vector<std::string>&  addedV,
+  const std::vector<std::string>&  removedV
+)
+{
+  if ((addedV.size() == 0) && (removedV.size() == 0))
+  {
+    return;
+  }
+
+  summaryUpdate(tenant, servicePath, entityType, 0, addedV, removedV);
+}
+
+
+
+/* ****************************************************************************
+*
+* servicePathMatch -
+*
+* Same semantics as fillQueryServicePath: no service path matches every entity, "/x/#" matches
+* "/x" and its descendants and anything else matches exactly. Entities without service path
+* ("" here) are matched by "/" and "/#".
+*/
+static bool servicePathMatch(const std::string& entitySPath, const std::vector<std::string>& servicePathV)
+{
+  if (servicePathV.size() == 0)
+  {
+    return true;
+  }
+
+  for (unsigned int ix = 0; ix < servicePathV.size(); ++ix)
+  {
+    const std::string& servicePath = servicePathV[ix];
+
+    if (entitySPath == "")
+    {
+      if ((servicePath == "/") || (servicePath == "/#"))
+      {
+        return true;
+      }
+    }
+    else if ((servicePath.length() >= 2) && (servicePath.compare(servicePath.length() - 2, 2, "/#") == 0))
+    {
+      std::string base = servicePath.substr(0, servicePath.length() - 2);
+
+      if ((entitySPath == base) || (entitySPath.compare(0, base.length() + 1, base + "/") == 0))
+      {
+        return true;
+      }
+    }
+    else if (entitySPath == servicePath)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+
+/* ****************************************************************************
+*
+* typesCacheGet -
+*/
+bool typesCacheGet
+(
+  const std::string&                                tenant,
+  const std::vector<std::string>&                   servicePathV,
+  std::map<std::string, std::set<std::string> >*    typesP
+)
+{
+  pthread_mutex_lock(&cacheMutex);
+
+  if (failedTenants.count(tenant) != 0)
+  {
+    pthread_mutex_unlock(&cacheMutex);
+    return false;
+  }
+
+  ServicePathMap& spMap = cache[tenant];
+
+  for (ServicePathMap::iterator spIt = spMap.begin(); spIt != spMap.end(); ++spIt)
+  {
+    if (!servicePathMatch(spIt->first, servicePathV))
+    {
+      continue;
+    }
+
+    for (TypeMap::iterator tIt = spIt->second.begin(); tIt != spIt->second.end(); ++tIt)
+    {
+      std::set<std::string>& attrSet = (*typesP)[tIt->first];
+
+      for (std::map<std::string, long long>::iterator aIt = tIt->second.attrs.begin(); aIt != tIt->second.attrs.end(); ++aIt)
+      {
+        attrSet.insert(aIt->first);
+      }
+    }
+  }
+
+  pthread_mutex_unlock(&cacheMutex);
+
+  return true;
+}
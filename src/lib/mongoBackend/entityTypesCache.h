@@ -0,0 +1,140 @@
+#ifndef SRC_LIB_MONGOBACKEND_ENTITYTYPESCACHE_H_
+#define SRC_LIB_MONGOBACKEND_ENTITYTYPESCACHE_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+
+/* ****************************************************************************
+*
+* Entity types cache -
+*
+* In-memory summary of the entities collection of each tenant: for each service path and
+* entity type, the number of entities and, for each attribute name, the number of entities
+* having it in their attrNames. The summary is built at startup (two aggregations per tenant)
+* and kept up to date by the entity creations, updates and removals of this broker, so the
+* /v1/contextTypes requests don't need to aggregate the whole entities collection.
+*
+* Entities without service path (or without type) are kept under "" as service path (type).
+*
+* Like the subscription cache, it must not be used when several brokers share the same
+* database or when the entities collection is modified out of band.
+*/
+
+
+
+/* ****************************************************************************
+*
+* typesCacheInit -
+*/
+extern void typesCacheInit(bool active);
+
+
+
+/* ****************************************************************************
+*
+* typesCacheActive -
+*/
+extern bool typesCacheActive(void);
+
+
+
+/* ****************************************************************************
+*
+* typesCacheLoad - (re)build the summary of a tenant from its entities collection
+*/
+extern void typesCacheLoad(const std::string& tenant);
+
+
+
+/* ****************************************************************************
+*
+* typesCacheEntityCreated -
+*
+* 'attrNamesV' is the attrNames array of the entity (names may be repeated, when the
+* same attribute is created with several metadata ID).
+*/
+extern void typesCacheEntityCreated
+(
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::string&               entityType,
+  const std::vector<std::string>&  attrNamesV
+);
+
+
+
+/* ****************************************************************************
+*
+* typesCacheEntityRemoved -
+*/
+extern void typesCacheEntityRemoved
+(
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::string&               entityType,
+  const std::vector<std::string>&  attrNamesV
+);
+
+
+
+/* ****************************************************************************
+*
+* typesCacheAttrNamesChanged - names added to and removed from the attrNames of an entity
+*/
+extern void typesCacheAttrNamesChanged
+(
+  const std::string&               tenant,
+  const std::string&               servicePath,
+  const std::string&               entityType,
+  const std::vector<std::string>&  addedV,
+  const std::vector<std::string>&  removedV
+);
+
+
+
+/* ****************************************************************************
+*
+* typesCacheGet -
+*
+* The entity types (and the names of their attributes) of the entities in the service paths
+* in 'servicePathV' (same semantics as fillQueryServicePath), sorted by type and by name.
+*
+* Returns false if the summary of the tenant could not be loaded at startup (then the
+* caller has to aggregate the entities collection as usual).
+*/
+extern bool typesCacheGet
+(
+  const std::string&                                tenant,
+  const std::vector<std::string>&                   servicePathV,
+  std::map<std::string, std::set<std::string> >*    typesP
+);
+
+#endif  // SRC_LIB_MONGOBACKEND_ENTITYTYPESCACHE_H_
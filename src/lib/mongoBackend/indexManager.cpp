@@ -0,0 +1,353 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/globals.h"
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/indexManager.h"
+
+#include "mongo/client/dbclient.h"
+
+using namespace mongo;
+
+
+
+/* ****************************************************************************
+*
+* IndexCollection -
+*/
+typedef enum IndexCollection
+{
+  IcEntities,
+  IcCsubs,
+  IcRegistrations
+} IndexCollection;
+
+
+
+/* ****************************************************************************
+*
+* IndexDecl - a declared index (not called IndexSpec, to avoid a clash with mongo::IndexSpec)
+*
+* 'geo' indexes are 2dsphere indexes on 'key', the rest are ascending indexes on 'key'
+* (and on 'key2', when not NULL).
+*/
+typedef struct IndexDecl
+{
+  IndexCollection  collection;
+  const char*      key;
+  const char*      key2;
+  bool             geo;
+} IndexDecl;
+
+
+
+/* ****************************************************************************
+*
+* indexDeclV - the indexes ensured in each tenant
+*
+* o location:       geo queries (scope FIWARE::Location)
+* o creDate, _id:   the sort order of the pagination of queryContext
+* o _id.*:          queries by entity id, type and service path not using the whole _id
+* o attrNames:      queries by attribute and the entity types requests
+* o conditions:     the subscriptions triggered by an update (ONCHANGE conditions)
+* o expiration:     active subscriptions and registrations
+*/
+static const IndexDecl indexDeclV[] =
+{
+  { IcEntities,       ENT_LOCATION "." ENT_LOCATION_COORDS,       NULL,   true  },
+  { IcEntities,       ENT_CREATION_DATE,                          "_id",  false },
+  { IcEntities,       "_id." ENT_ENTITY_ID,                       NULL,   false },
+  { IcEntities,       "_id." ENT_ENTITY_TYPE,                     NULL,   false },
+  { IcEntities,       "_id." ENT_SERVICE_PATH,                    NULL,   false },
+  { IcEntities,       ENT_ATTRNAMES,                              NULL,   false },
+  { IcCsubs,          CSUB_CONDITIONS "." CSUB_CONDITIONS_VALUE,  NULL,   false },
+  { IcCsubs,          CSUB_EXPIRATION,                            NULL,   false },
+  { IcRegistrations,  REG_EXPIRATION,                             NULL,   false }
+};
+
+#define INDEX_DECLS  ((int) (sizeof(indexDeclV) / sizeof(indexDeclV[0])))
+
+
+
+/* ****************************************************************************
+*
+* TenantIndexes - what is known about the indexes of a tenant
+*
+* 'statusV' follows the order of indexDeclV. 'busy' is set while some thread is creating
+* the indexes of the tenant.
+*/
+typedef struct TenantIndexes
+{
+  bool                      complete;
+  bool                      busy;
+  int                       lastAttempt;
+  std::vector<std::string>  statusV;
+
+  TenantIndexes(): complete(false), busy(false), lastAttempt(0), statusV(INDEX_DECLS, "pending") {}
+} TenantIndexes;
+
+
+
+/* ****************************************************************************
+*
+* Globals -
+*/
+static std::map<std::string, TenantIndexes>  tenantMap;
+static unsigned long                         resetNo    = 0;
+static pthread_mutex_t                       indexMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/* ****************************************************************************
+*
+* collectionName -
+*/
+static std::string collectionName(IndexCollection collection, const std::string& tenant)
+{
+  switch (collection)
+  {
+  case IcEntities:       return getEntitiesCollectionName(tenant);
+  case IcCsubs:          return getSubscribeContextCollectionName(tenant);
+  case IcRegistrations:  return getRegistrationsCollectionName(tenant);
+  }
+
+  return "";
+}
+
+
+
+/* ****************************************************************************
+*
+* collectionTag - the collection name without database, for the status
+*/
+static const char* collectionTag(IndexCollection collection)
+{
+  switch (collection)
+  {
+  case IcEntities:       return COL_ENTITIES;
+  case IcCsubs:          return COL_CSUBS;
+  case IcRegistrations:  return COL_REGISTRATIONS;
+  }
+
+  return "";
+}
+
+
+
+/* ****************************************************************************
+*
+* indexName - the default name MongoDB gives to the index
+*/
+static std::string indexName(const IndexDecl* specP)
+{
+  std::string name = std::string(specP->key) + (specP->geo? "_2dsphere" : "_1");
+
+  if (specP->key2 != NULL)
+  {
+    name += std::string("_") + specP->key2 + "_1";
+  }
+
+  return name;
+}
+
+
+
+/* ****************************************************************************
+*
+* indexCreate - returns the status of the index
+*
+* The index is built in background, so a tenant with a big collection doesn't lock its
+* database (or, at startup, delay the broker) while the index is built.
+*/
+static std::string indexCreate(const std::string& tenant, const IndexDecl* specP)
+{
+  BSONObjBuilder  keys;
+  std::string     ns = collectionName(specP->collection, tenant);
+
+  if (specP->geo)
+  {
+    /* Geo location based on 2dsphere indexes was introduced in MongoDB 2.4 */
+    if (!mongoLocationCapable())
+    {
+      return "unsupported";
+    }
+
+    keys.append(specP->key, "2dsphere");
+  }
+  else
+  {
+    keys.append(specP->key, 1);
+  }
+
+  if (specP->key2 != NULL)
+  {
+    keys.append(specP->key2, 1);
+  }
+
+  DBClientBase* connection = getMongoConnection();
+
+  try
+  {
+    connection->createIndex(ns.c_str(), mongo::IndexSpec().addKeys(keys.obj()).background());
+    releaseMongoConnection(connection);
+  }
+  catch (const DBException& e)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (creating index %s in %s: %s)", indexName(specP).c_str(), ns.c_str(), e.what()));
+    return e.what();
+  }
+  catch (...)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (creating index %s in %s: generic exception)", indexName(specP).c_str(), ns.c_str()));
+    return "generic exception";
+  }
+
+  LM_T(LmtMongo, ("index %s ensured in %s", indexName(specP).c_str(), ns.c_str()));
+  return "ok";
+}
+
+
+
+/* ****************************************************************************
+*
+* indexesEnsure -
+*
+* Only one thread creates the indexes of a tenant; the rest of the threads using the tenant
+* in the meantime don't wait for it (the indexes are not needed for the requests to work).
+* Creating an index that already exists is harmless, so several brokers sharing the database
+* don't need to coordinate.
+*/
+void indexesEnsure(const std::string& tenant)
+{
+  int now = getCurrentTime();
+
+  pthread_mutex_lock(&indexMutex);
+
+  TenantIndexes* tiP = &tenantMap[tenant];
+
+  if ((tiP->complete) || (tiP->busy) ||
+      ((tiP->lastAttempt != 0) && (now - tiP->lastAttempt < INDEX_RETRY_INTERVAL)))
+  {
+    pthread_mutex_unlock(&indexMutex);
+    return;
+  }
+
+  std::vector<std::string>  statusV = tiP->statusV;
+  unsigned long             myReset = resetNo;
+
+  tiP->busy = true;
+  pthread_mutex_unlock(&indexMutex);
+
+  bool complete = true;
+
+  for (int ix = 0; ix < INDEX_DECLS; ++ix)
+  {
+    if ((statusV[ix] == "ok") || (statusV[ix] == "unsupported"))
+    {
+      continue;
+    }
+
+    statusV[ix] = indexCreate(tenant, &indexDeclV[ix]);
+
+    if ((statusV[ix] != "ok") && (statusV[ix] != "unsupported"))
+    {
+      complete = false;
+    }
+  }
+
+  //
+  // The entry is looked up again: indexesReset may have freed it while the indexes were
+  // being created, and in that case the results are discarded
+  //
+  pthread_mutex_lock(&indexMutex);
+  if (myReset == resetNo)
+  {
+    tiP = &tenantMap[tenant];
+
+    tiP->statusV     = statusV;
+    tiP->complete    = complete;
+    tiP->busy        = false;
+    tiP->lastAttempt = now;
+  }
+  pthread_mutex_unlock(&indexMutex);
+
+  if (!complete)
+  {
+    LM_W(("Database Error (not all the indexes of tenant '%s' could be created, retrying in %d seconds)",
+          tenant.c_str(), INDEX_RETRY_INTERVAL));
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* indexesStatusGet -
+*/
+void indexesStatusGet(std::vector<IndexStatus>* statusV)
+{
+  pthread_mutex_lock(&indexMutex);
+
+  for (std::map<std::string, TenantIndexes>::iterator it = tenantMap.begin(); it != tenantMap.end(); ++it)
+  {
+    for (int ix = 0; ix < INDEX_DECLS; ++ix)
+    {
+      IndexStatus status;
+
+      status.tenant     = it->first;
+      status.collection = collectionTag(indexDeclV[ix].collection);
+      status.name       = indexName(&indexDeclV[ix]);
+      status.status     = it->second.statusV[ix];
+
+      statusV->push_back(status);
+    }
+  }
+
+  pthread_mutex_unlock(&indexMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* indexesReset -
+*/
+void indexesReset(void)
+{
+  pthread_mutex_lock(&indexMutex);
+  tenantMap.clear();
+  ++resetNo;
+  pthread_mutex_unlock(&indexMutex);
+}
@@ -0,0 +1,88 @@
+#ifndef SRC_LIB_MONGOBACKEND_INDEXMANAGER_H_
+#define SRC_LIB_MONGOBACKEND_INDEXMANAGER_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <string>
+#include <vector>
+
+
+
+/* ****************************************************************************
+*
+* Index manager -
+*
+* The broker declares the indexes its queries rely on (entities, csubs and registrations
+* collections) and ensures them once per tenant database: at startup for the existing
+* tenants and on the first write of a new tenant. The result is kept in memory, so
+* creating an entity doesn't cost a createIndex round trip anymore.
+*
+* If the creation of some index fails, it is retried on a later use of the tenant, not
+* before INDEX_RETRY_INTERVAL seconds.
+*/
+#define INDEX_RETRY_INTERVAL  60
+
+
+
+/* ****************************************************************************
+*
+* IndexStatus - status of a declared index in a tenant
+*
+* 'status' is "ok", "unsupported" (2dsphere index in MongoDB before 2.4), "pending" or the
+* error of the last attempt.
+*/
+typedef struct IndexStatus
+{
+  std::string  tenant;
+  std::string  collection;
+  std::string  name;
+  std::string  status;
+} IndexStatus;
+
+
+
+/* ****************************************************************************
+*
+* indexesEnsure - ensure the declared indexes of a tenant, only the first time
+*/
+extern void indexesEnsure(const std::string& tenant);
+
+
+
+/* ****************************************************************************
+*
+* indexesStatusGet - the status of the indexes of all the tenants seen so far
+*/
+extern void indexesStatusGet(std::vector<IndexStatus>* statusV);
+
+
+
+/* ****************************************************************************
+*
+* indexesReset - forget all the tenants (for the unit tests)
+*/
+extern void indexesReset(void);
+
+#endif  // SRC_LIB_MONGOBACKEND_INDEXMANAGER_H_
@@ -23,6 +23,9 @@
 * Author: Ken Zangelin
 */
 #include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <semaphore.h>
 #include <string>
 #include <vector>
@@ -30,7 +33,6 @@
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
-#include "common/clockFunctions.h"
 #include "common/string.h"
 #include "mongoBackend/mongoConnectionPool.h"
 #include "mongoBackend/MongoGlobal.h"
@@ -49,28 +51,93 @@
 
 /* ****************************************************************************
 *
-* MongoConnection - 
+* POOL_HEALTH_INTERVAL - number of seconds between two checks of the idle connections
+* POOL_GROW_RETRY      - number of seconds to wait for a released connection before trying to grow again
 */
-typedef struct MongoConnection
+#define POOL_HEALTH_INTERVAL 10
+#define POOL_GROW_RETRY      1
+
+
+
+/* ****************************************************************************
+*
+* PoolSlot -
+*
+* The slots of the pool are linked in two lock-free stacks, using the index of the
+* next slot (-1 for the last one):
+* - freeHead:  connected slots not in use
+* - spareHead: slots not connected yet (the pool grows lazily taking them)
+*
+* A slot that has been taken from a stack is owned by the taker until it pushes it back,
+* so only the taker touches the connection of a slot. 'inUse' is set while the connection
+* is in the hands of a caller of mongoPoolConnectionGet, so that releasing a connection
+* twice doesn't push its slot twice.
+*/
+typedef struct PoolSlot
 {
   DBClientBase*  connection;
-  bool           free;
-} MongoConnection;
+  volatile int   next;
+  volatile int   inUse;
+} PoolSlot;
+
+
+
+/* ****************************************************************************
+*
+* ConnectParams - the parameters of mongoConnect, kept for the lazy growth of the pool
+*/
+typedef struct ConnectParams
+{
+  std::string  host;
+  std::string  db;
+  std::string  rplSet;
+  std::string  username;
+  std::string  passwd;
+  bool         multitenant;
+  int          writeConcern;
+  double       timeout;
+} ConnectParams;
+
+
+
+/* ****************************************************************************
+*
+* Wait buckets - upper limit (in microseconds) of each bucket of the waiting time histogram
+*/
+static const long long waitBucketLimit[MONGO_POOL_WAIT_BUCKETS] = { 1000, 10000, 100000, 1000000, -1 };
+static const char*     waitBucketName[MONGO_POOL_WAIT_BUCKETS]  = { "upTo1ms", "upTo10ms", "upTo100ms", "upTo1s", "over1s" };
 
 
 
 /* ****************************************************************************
 *
 * globals - 
+*
+* The head of a stack holds the index of the first slot plus one (0: empty stack) in its
+* lower 32 bits and a tag in its upper 32 bits, that is incremented in every change of the
+* head to avoid the ABA problem of lock-free stacks.
+*
+* poolMutex is not used to get or release connections; it only protects the waits on
+* slotCond (callers holding a semaphore token waiting for a slot to be pushed back) and
+* on healthCond (the health check thread, between two checks).
 */
-static MongoConnection* connectionPool     = NULL;
-static int              connectionPoolSize = 0;
-static sem_t            connectionPoolSem;
-static sem_t            connectionSem;
-static struct timespec  semWaitingTime     = { 0, 0 };
-static bool             semStatistics      = false;
-static int              mongoVersionMayor = -1;
-static int              mongoVersionMinor = -1;
+static PoolSlot*                    connectionPool     = NULL;
+static int                          connectionPoolSize = 0;
+static volatile unsigned long long  freeHead           = 0;
+static volatile unsigned long long  spareHead          = 0;
+static sem_t                        connectionSem;
+static ConnectParams                connectParams;
+static volatile long long           semWaitingTime     = 0;  // nanoseconds
+static volatile long                waitV[MONGO_POOL_WAIT_BUCKETS];
+static bool                         semStatistics      = false;
+static volatile int                 slotWaiters        = 0;
+static pthread_mutex_t              poolMutex          = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t               slotCond           = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t               healthCond         = PTHREAD_COND_INITIALIZER;
+static bool                         healthStop         = false;
+static pthread_t                    healthTid;
+static int                          mongoVersionMayor = -1;
+static int                          mongoVersionMinor = -1;
 
 
 
@@ -91,6 +158,8 @@ void mongoVersionGet(int* mayor, int* minor)
 * mongoConnect - 
 *
 * Default value for writeConcern == 1 (0: unacknowledged, 1: acknowledged)
+*
+* 'retries' is the number of connection attempts, with RECONNECT_DELAY milliseconds between them.
 */
 static DBClientBase* mongoConnect
 (
@@ -101,7 +170,8 @@ static DBClientBase* mongoConnect
   const char*  passwd,
   bool         multitenant,
   int          writeConcern,
-  double       timeout
+  double       timeout,
+  int          retries
 )
 {
   std::string   err;
@@ -110,7 +180,6 @@ static DBClientBase* mongoConnect
   LM_T(LmtMongo, ("Connection info: dbName='%s', rplSet='%s', timeout=%f", db, rplSet, timeout));
 
   bool connected     = false;
-  int  retries       = RECONNECT_RETRIES;
 
   if (strlen(rplSet) == 0)
   {
@@ -129,6 +198,11 @@ static DBClientBase* mongoConnect
         break;
       }
 
+      if (tryNo + 1 == retries)
+      {
+        break;
+      }
+
       if (tryNo == 0)
       {
         LM_E(("Database Startup Error (cannot connect to mongo - doing %d retries with a %d microsecond interval)",
@@ -172,6 +246,11 @@ static DBClientBase* mongoConnect
         break;
       }
 
+      if (tryNo + 1 == retries)
+      {
+        break;
+      }
+
       if (tryNo == 0)
       {
         LM_E(("Database Startup Error (cannot connect to mongo - doing %d retries with a %d microsecond interval)",
@@ -190,6 +269,7 @@ static DBClientBase* mongoConnect
   if (connected == false)
   {
     LM_E(("Database Error (connection failed, after %d retries: '%s')", retries, err.c_str()));
+    delete connection;
     return NULL;
   }
 
@@ -212,6 +292,7 @@ static DBClientBase* mongoConnect
   if (writeConcernCheck.nodes() != wc.nodes())
   {
     LM_E(("Database Error (Write Concern not set as desired)"));
+    delete connection;
     return NULL;
   }
   LM_T(LmtMongo, ("Active DB Write Concern mode: %d", writeConcern));
@@ -231,6 +312,7 @@ static DBClientBase* mongoConnect
               username,
               err.c_str()));
 
+        delete connection;
         return NULL;
       }
     }
@@ -246,35 +328,295 @@ static DBClientBase* mongoConnect
               username,
               err.c_str()));
 
+        delete connection;
         return NULL;
       }
     }
   }
 
-  /* Get mongo version with the 'buildinfo' command */
+  /* Get mongo version with the 'buildinfo' command (connections may be done in parallel, so locals are used) */
   BSONObj result;
   std::string extra;
+  int mayor;
+  int minor;
   connection->runCommand("admin", BSON("buildinfo" << 1), result);
   std::string versionString = std::string(result.getStringField("version"));
-  if (!versionParse(versionString, mongoVersionMayor, mongoVersionMinor, extra))
+  if (!versionParse(versionString, mayor, minor, extra))
   {
     LM_E(("Database Startup Error (invalid version format: %s)", versionString.c_str()));
+    delete connection;
     return NULL;
   }
   LM_T(LmtMongo, ("mongo version server: %s (mayor: %d, minor: %d, extra: %s)",
                   versionString.c_str(),
-                  mongoVersionMayor,
-                  mongoVersionMinor,
+                  mayor,
+                  minor,
                   extra.c_str()));
 
+  mongoVersionMayor = mayor;
+  mongoVersionMinor = minor;
+
   return connection;
 }
 
 
 
+
+
+
+/* ****************************************************************************
+*
+* slotPush - push the slot 'ix' in the stack whose head is 'headP'
+*/
+static void slotPush(volatile unsigned long long* headP, int ix)
+{
+  unsigned long long oldHead;
+  unsigned long long newHead;
+
+  do
+  {
+    oldHead = *headP;
+    connectionPool[ix].next = (int) (oldHead & 0xFFFFFFFF) - 1;
+    newHead = (((oldHead >> 32) + 1) << 32) | (unsigned long long) (ix + 1);
+  } while (!__sync_bool_compare_and_swap(headP, oldHead, newHead));
+}
+
+
+
+/* ****************************************************************************
+*
+* slotPop - pop a slot from the stack whose head is 'headP', -1 if the stack is empty
+*/
+static int slotPop(volatile unsigned long long* headP)
+{
+  unsigned long long oldHead;
+  unsigned long long newHead;
+  int                ix;
+
+  do
+  {
+    oldHead = *headP;
+    ix      = (int) (oldHead & 0xFFFFFFFF) - 1;
+
+    if (ix == -1)
+    {
+      return -1;
+    }
+
+    newHead = (((oldHead >> 32) + 1) << 32) | (unsigned long long) (connectionPool[ix].next + 1);
+  } while (!__sync_bool_compare_and_swap(headP, oldHead, newHead));
+
+  return ix;
+}
+
+
+
+/* ****************************************************************************
+*
+* slotWakeUp - wake up the callers waiting for a slot, if any, after pushing one
+*
+* The waiters are counted before checking the stacks for the last time (slotWait), and
+* the slot is pushed (with a full barrier) before looking at the counter, so either the
+* waiter sees the slot or the pusher sees the waiter.
+*/
+static void slotWakeUp(void)
+{
+  if (__sync_fetch_and_add(&slotWaiters, 0) == 0)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&poolMutex);
+  pthread_cond_broadcast(&slotCond);
+  pthread_mutex_unlock(&poolMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* slotWait - wait until a slot is pushed back, at most POOL_GROW_RETRY seconds
+*
+* If 'spareToo' is true, a spare slot is also good for the caller (it hasn't tried
+* to grow the pool yet). Returns false if the wait timed out.
+*/
+static bool slotWait(bool spareToo)
+{
+  struct timespec deadline;
+  int             ret = 0;
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += POOL_GROW_RETRY;
+
+  pthread_mutex_lock(&poolMutex);
+  __sync_fetch_and_add(&slotWaiters, 1);
+
+  if (((freeHead & 0xFFFFFFFF) == 0) && ((spareToo == false) || ((spareHead & 0xFFFFFFFF) == 0)))
+  {
+    ret = pthread_cond_timedwait(&slotCond, &poolMutex, &deadline);
+  }
+
+  __sync_fetch_and_sub(&slotWaiters, 1);
+  pthread_mutex_unlock(&poolMutex);
+
+  return (ret != ETIMEDOUT);
+}
+
+
+
+/* ****************************************************************************
+*
+* poolConnect - new connection with the parameters of the pool
+*/
+static DBClientBase* poolConnect(int retries)
+{
+  return mongoConnect(connectParams.host.c_str(),
+                      connectParams.db.c_str(),
+                      connectParams.rplSet.c_str(),
+                      connectParams.username.c_str(),
+                      connectParams.passwd.c_str(),
+                      connectParams.multitenant,
+                      connectParams.writeConcern,
+                      connectParams.timeout,
+                      retries);
+}
+
+
+
+/* ****************************************************************************
+*
+* poolConnectThread - connect one of the initial slots of the pool
+*/
+static void* poolConnectThread(void* vP)
+{
+  PoolSlot* slotP = (PoolSlot*) vP;
+
+  slotP->connection = poolConnect(RECONNECT_RETRIES);
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* connectionAlive - ping the database through a connection
+*/
+static bool connectionAlive(DBClientBase* connection)
+{
+  BSONObj result;
+
+  try
+  {
+    return connection->runCommand("admin", BSON("ping" << 1), result);
+  }
+  catch (const DBException& e)
+  {
+    LM_W(("Database Error (ping of pool connection failed: %s)", e.what()));
+  }
+  catch (...)
+  {
+    LM_W(("Database Error (ping of pool connection failed: generic exception)"));
+  }
+
+  return false;
+}
+
+
+
+/* ****************************************************************************
+*
+* mongoConnectionPoolHealthCheck - ping the idle connections of the pool
+*
+* The idle connections are taken out of the pool (with their semaphore token, so that
+* the pool is never seen with less connections than tokens) and checked one by one.
+* A broken connection is replaced by a new one. If the database cannot be reached, the
+* broken connection is kept, as its auto-reconnect will work once the database is back.
+*/
+void mongoConnectionPoolHealthCheck(void)
+{
+  std::vector<int> idleV;
+
+  while (sem_trywait(&connectionSem) == 0)
+  {
+    int ix = slotPop(&freeHead);
+
+    if (ix == -1)
+    {
+      sem_post(&connectionSem);
+      break;
+    }
+
+    idleV.push_back(ix);
+  }
+
+  for (unsigned int ix = 0; ix < idleV.size(); ++ix)
+  {
+    PoolSlot* slotP = &connectionPool[idleV[ix]];
+
+    if (connectionAlive(slotP->connection) == false)
+    {
+      DBClientBase* connection = poolConnect(1);
+
+      if (connection != NULL)
+      {
+        LM_I(("Broken database connection of the pool replaced"));
+        delete slotP->connection;
+        slotP->connection = connection;
+      }
+    }
+
+    slotPush(&freeHead, idleV[ix]);
+    sem_post(&connectionSem);
+    slotWakeUp();
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* poolHealthCheck - thread checking the idle connections every POOL_HEALTH_INTERVAL seconds
+*/
+static void* poolHealthCheck(void* vP)
+{
+  pthread_mutex_lock(&poolMutex);
+
+  while (healthStop == false)
+  {
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += POOL_HEALTH_INTERVAL;
+
+    while ((healthStop == false) && (pthread_cond_timedwait(&healthCond, &poolMutex, &deadline) != ETIMEDOUT))
+    {
+    }
+
+    if (healthStop == true)
+    {
+      break;
+    }
+
+    pthread_mutex_unlock(&poolMutex);
+    mongoConnectionPoolHealthCheck();
+    pthread_mutex_lock(&poolMutex);
+  }
+
+  pthread_mutex_unlock(&poolMutex);
+
+  return NULL;
+}
+
+
+
 /* ****************************************************************************
 *
 * mongoConnectionPoolInit - 
+*
+* The first 'poolMin' connections are established in parallel, one thread each. The rest
+* of the slots, up to 'poolSize', are connected on demand by mongoPoolConnectionGet.
+* At least one connection must succeed for the pool to be usable.
 */
 int mongoConnectionPoolInit
 (
@@ -287,13 +629,23 @@ int mongoConnectionPoolInit
   double       timeout,
   int          writeConcern,
   int          poolSize,
-  bool         semTimeStat
+  bool         semTimeStat,
+  int          poolMin
 )
 {
+  connectParams.host         = host;
+  connectParams.db           = db;
+  connectParams.rplSet       = rplSet;
+  connectParams.username     = username;
+  connectParams.passwd       = passwd;
+  connectParams.multitenant  = multitenant;
+  connectParams.writeConcern = writeConcern;
+  connectParams.timeout      = timeout;
+
   //
   // Create the pool
   //
-  connectionPool  = (MongoConnection*) calloc(sizeof(MongoConnection), poolSize);
+  connectionPool  = (PoolSlot*) calloc(sizeof(PoolSlot), poolSize);
   if (connectionPool == NULL)
   {
     LM_E(("Runtime Error (insufficient memory to create connection pool of %d connections)", poolSize));
@@ -301,41 +653,92 @@ int mongoConnectionPoolInit
   }
   connectionPoolSize = poolSize;
 
+  if (poolMin < 1)
+  {
+    poolMin = 1;
+  }
+  else if (poolMin > poolSize)
+  {
+    poolMin = poolSize;
+  }
+
   //
-  // Initialize (connect) the pool
+  // Connect the initial slots of the pool, in parallel
   //
-  for (int ix = 0; ix < connectionPoolSize; ++ix)
+  std::vector<pthread_t> tidV;
+
+  for (int ix = 0; ix < poolMin; ++ix)
+  {
+    pthread_t tid;
+
+    if (pthread_create(&tid, NULL, poolConnectThread, &connectionPool[ix]) != 0)
+    {
+      LM_W(("Runtime Error (cannot create connection thread - connecting sequentially)"));
+      poolConnectThread(&connectionPool[ix]);
+      continue;
+    }
+
+    tidV.push_back(tid);
+  }
+
+  for (unsigned int ix = 0; ix < tidV.size(); ++ix)
   {
-    connectionPool[ix].free       = true;
-    connectionPool[ix].connection =
-        mongoConnect(host, db, rplSet, username, passwd, multitenant, writeConcern, timeout);
+    pthread_join(tidV[ix], NULL);
   }
 
   //
-  // Set up the semaphore protecting the pool itself (connectionPoolSem)
+  // Set up the stacks (in reverse order, so that the slots are taken in ascending order)
   //
-  int r = sem_init(&connectionPoolSem, 0, 1);
+  int connected = 0;
+
+  for (int ix = poolSize - 1; ix >= 0; --ix)
+  {
+    if (connectionPool[ix].connection != NULL)
+    {
+      slotPush(&freeHead, ix);
+      ++connected;
+    }
+    else
+    {
+      slotPush(&spareHead, ix);
+    }
+  }
 
-  if (r != 0)
+  if (connected == 0)
   {
-    LM_E(("Runtime Error (cannot create connection pool semaphore)"));
+    LM_E(("Database Startup Error (no connection to the database could be established)"));
     return -1;
   }
 
+  LM_T(LmtMongo, ("Connection pool: %d connections out of %d", connected, poolSize));
+
   //
   // Set up the semaphore protecting the set of connections of the pool (connectionSem)
-  // Note that this is a counting semaphore, initialized to connectionPoolSize.
+  // Note that this is a counting semaphore, initialized to connectionPoolSize, as the
+  // pool grows up to connectionPoolSize connections.
   //
-  r = sem_init(&connectionSem, 0, connectionPoolSize);
-  if (r != 0)
+  if (sem_init(&connectionSem, 0, connectionPoolSize) != 0)
   {
     LM_E(("Runtime Error (cannot create connection semaphore-set)"));
     return -1;
   }
 
-  // Measure accumulated semaphore waiting time?
+  // Measure semaphore waiting time?
   semStatistics = semTimeStat;
 
+  //
+  // Health check of the idle connections
+  //
+  healthStop = false;
+
+  int ret = pthread_create(&healthTid, NULL, poolHealthCheck, NULL);
+
+  if (ret != 0)
+  {
+    LM_E(("Runtime Error (error creating thread: %d)", ret));
+    return -1;
+  }
+
   return 0;
 }
 
@@ -343,64 +746,153 @@ int mongoConnectionPoolInit
 
 /* ****************************************************************************
 *
-* mongoPoolConnectionGet - 
-*
-* There are two semaphores to get a connection.
-* - One binary semaphore that protects the connection-vector itself (connectionPoolSem)
-* - One counting semaphore that makes the caller wait until there is at least one free connection (connectionSem)
+* mongoConnectionPoolShutdown - 
 *
-* There is a limited number of connections and the first thing to do is to wait for a connection
-* to become avilable (any of the N connections in the pool) - this is done waiting on the counting semaphore that is 
-* initialized with "POOL SIZE" - meaning the semaphore can be taken N times if the pool size is N.
-* 
-* Once a connection is free, 'sem_wait(&connectionSem)' returns and we now have to take the semaphore 
-* that protects for pool itself (we *are* going to modify the vector of the pool - can only do it in
-* one thread at a time ...)
+* Stops the health check thread and closes the connections. None of them may be in use.
+*/
+void mongoConnectionPoolShutdown(void)
+{
+  if (connectionPool == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&poolMutex);
+  healthStop = true;
+  pthread_cond_broadcast(&healthCond);
+  pthread_mutex_unlock(&poolMutex);
+
+  pthread_join(healthTid, NULL);
+
+  for (int ix = 0; ix < connectionPoolSize; ++ix)
+  {
+    delete connectionPool[ix].connection;
+  }
+
+  free(connectionPool);
+  sem_destroy(&connectionSem);
+
+  connectionPool     = NULL;
+  connectionPoolSize = 0;
+  freeHead           = 0;
+  spareHead          = 0;
+}
+
+
+
+/* ****************************************************************************
 *
-* After taking a connection, the semaphore 'connectionPoolSem' is freed, as all modifications to the connection pool
-* have finished.
-* The other semaphore however, 'connectionSem', is kept and it is not freed until we finish using the connection.
+* mongoConnectionPoolConnected - 
+*/
+int mongoConnectionPoolConnected(void)
+{
+  int connected = 0;
+
+  for (int ix = 0; ix < connectionPoolSize; ++ix)
+  {
+    if (connectionPool[ix].connection != NULL)
+    {
+      ++connected;
+    }
+  }
+
+  return connected;
+}
+
+
+
+/* ****************************************************************************
 *
-* The function mongoPoolConnectionRelease releases the counting semaphore 'connectionSem'.
-* Very important to call the function 'mongoPoolConnectionRelease' after finishing using the connection !
+* nsecsGet -
+*/
+static long long nsecsGet(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+
+
+/* ****************************************************************************
 *
+* waitRecord - add a wait for a free connection to the waiting time and its histogram
 */
-DBClientBase* mongoPoolConnectionGet(void)
+static void waitRecord(long long nsecs)
 {
-  DBClientBase*    connection = NULL;
-  struct timespec  startTime;
-  struct timespec  endTime;
-  struct timespec  diffTime;
+  int bucket = 0;
 
-  if (semStatistics)
+  while ((waitBucketLimit[bucket] != -1) && (nsecs / 1000 > waitBucketLimit[bucket]))
   {
-    clock_gettime(CLOCK_REALTIME, &startTime);
+    ++bucket;
   }
 
-  sem_wait(&connectionSem);
-  sem_wait(&connectionPoolSem);
+  __sync_fetch_and_add(&semWaitingTime, nsecs);
+  __sync_fetch_and_add(&waitV[bucket], 1);
+}
 
-  if (semStatistics)
+
+
+/* ****************************************************************************
+*
+* mongoPoolConnectionGet - 
+*
+* The counting semaphore 'connectionSem', initialized to the maximum size of the pool, makes
+* the caller wait until there is at least one connection for it, either an idle one or a slot
+* that is not connected yet. The semaphore is kept until the connection is released by
+* mongoPoolConnectionRelease - very important to call it after finishing using the connection !
+*
+* With the semaphore taken, the connection itself is taken from the lock-free stack of idle
+* connections. If there is none, the pool grows, connecting a spare slot. If that fails (e.g. the
+* database is down), the caller waits (on a condition variable, not polling) for one of the existing
+* connections to be released, trying to grow again every POOL_GROW_RETRY seconds.
+*
+* Only the calls that have to wait for the semaphore are measured (if -mutexTimeStat is used).
+*/
+DBClientBase* mongoPoolConnectionGet(void)
+{
+  int   ix;
+  bool  growTried = false;
+
+  if (sem_trywait(&connectionSem) != 0)
   {
-    clock_gettime(CLOCK_REALTIME, &endTime);
+    long long start = (semStatistics == true)? nsecsGet() : 0;
 
-    clock_difftime(&endTime, &startTime, &diffTime);
-    clock_addtime(&semWaitingTime, &diffTime);
+    sem_wait(&connectionSem);
+
+    if (semStatistics)
+    {
+      waitRecord(nsecsGet() - start);
+    }
   }
 
-  for (int ix = 0; ix < connectionPoolSize; ++ix)
+  while ((ix = slotPop(&freeHead)) == -1)
   {
-    if (connectionPool[ix].free == true)
+    if ((growTried == false) && ((ix = slotPop(&spareHead)) != -1))
     {
-      connectionPool[ix].free = false;
-      connection = connectionPool[ix].connection;
-      break;
+      growTried = true;
+
+      if ((connectionPool[ix].connection = poolConnect(1)) != NULL)
+      {
+        LM_T(LmtMongo, ("Connection pool grown (slot %d)", ix));
+        break;
+      }
+
+      slotPush(&spareHead, ix);
+      slotWakeUp();
+      continue;
+    }
+
+    if (slotWait(!growTried) == false)
+    {
+      growTried = false;
     }
   }
 
-  sem_post(&connectionPoolSem);
+  connectionPool[ix].inUse = 1;
 
-  return connection;
+  return connectionPool[ix].connection;
 }
 
 
@@ -408,22 +900,26 @@ DBClientBase* mongoPoolConnectionGet(void)
 /* ****************************************************************************
 *
 * mongoPoolConnectionRelease - 
+*
+* The slot of the connection is looked up without any lock, as the connection of a slot
+* only changes while the slot is out of the stacks and not in the hands of the caller.
+* Releasing a connection that is not in use (e.g. twice) does nothing.
 */
 void mongoPoolConnectionRelease(DBClientBase* connection)
 {
-  sem_wait(&connectionPoolSem);
-
   for (int ix = 0; ix < connectionPoolSize; ++ix)
   {
     if (connectionPool[ix].connection == connection)
     {
-      connectionPool[ix].free = true;
-      sem_post(&connectionSem);
+      if (__sync_bool_compare_and_swap(&connectionPool[ix].inUse, 1, 0))
+      {
+        slotPush(&freeHead, ix);
+        sem_post(&connectionSem);
+        slotWakeUp();
+      }
       break;
     }
   }
-
-  sem_post(&connectionPoolSem);
 }
 
 
@@ -436,7 +932,9 @@ char* mongoPoolConnectionSemWaitingTimeGet(char* buf, int bufLen)
 {
   if (semStatistics)
   {
-    snprintf(buf, bufLen, "%lu.%09d", semWaitingTime.tv_sec, (int) semWaitingTime.tv_nsec);
+    long long nsecs = semWaitingTime;
+
+    snprintf(buf, bufLen, "%lld.%09d", nsecs / 1000000000, (int) (nsecs % 1000000000));
   }
   else
   {
@@ -450,13 +948,34 @@ char* mongoPoolConnectionSemWaitingTimeGet(char* buf, int bufLen)
 
 /* ****************************************************************************
 *
-* mongoPoolConnectionSemWaitingTimeReset - 
+* mongoPoolConnectionWaitsGet - 
 */
-void mongoPoolConnectionSemWaitingTimeReset(void)
+long mongoPoolConnectionWaitsGet(const char** nameV, long* countV)
 {
-  semWaitingTime.tv_sec  = 0;
-  semWaitingTime.tv_nsec = 0;
+  long total = 0;
+
+  for (int ix = 0; ix < MONGO_POOL_WAIT_BUCKETS; ++ix)
+  {
+    nameV[ix]  = waitBucketName[ix];
+    countV[ix] = waitV[ix];
+    total     += countV[ix];
+  }
+
+  return total;
 }
 
 
 
+/* ****************************************************************************
+*
+* mongoPoolConnectionSemWaitingTimeReset - 
+*/
+void mongoPoolConnectionSemWaitingTimeReset(void)
+{
+  semWaitingTime = 0;
+
+  for (int ix = 0; ix < MONGO_POOL_WAIT_BUCKETS; ++ix)
+  {
+    waitV[ix] = 0;
+  }
+}
@@ -33,6 +33,14 @@ using namespace mongo;
 
 
 
+/* ****************************************************************************
+*
+* MONGO_POOL_WAIT_BUCKETS - number of buckets of the histogram of waits for a connection
+*/
+#define MONGO_POOL_WAIT_BUCKETS 5
+
+
+
 /* ****************************************************************************
 *
 * mongoVersionGet - 
@@ -56,11 +64,42 @@ extern int mongoConnectionPoolInit
   double      timeout,
   int         writeConcern,
   int         poolSize,
-  bool        semTimeStat
+  bool        semTimeStat,
+  int         poolMin
 );
 
 
 
+/* ****************************************************************************
+*
+* mongoConnectionPoolShutdown - 
+*
+* Stops the health check thread and closes all the connections, which must have been
+* released. Afterwards, mongoConnectionPoolInit can be called again (used by the unit tests).
+*/
+extern void mongoConnectionPoolShutdown(void);
+
+
+
+/* ****************************************************************************
+*
+* mongoConnectionPoolHealthCheck - 
+*
+* Ping the idle connections, replacing the broken ones. Done every 10 seconds by the
+* health check thread of the pool, it can also be called directly (unit tests).
+*/
+extern void mongoConnectionPoolHealthCheck(void);
+
+
+
+/* ****************************************************************************
+*
+* mongoConnectionPoolConnected - number of slots of the pool with a connection
+*/
+extern int mongoConnectionPoolConnected(void);
+
+
+
 /* ****************************************************************************
 *
 * mongoPoolConnectionGet - 
@@ -85,6 +124,17 @@ extern char* mongoPoolConnectionSemWaitingTimeGet(char* buf, int bufLen);
 
 
 
+/* ****************************************************************************
+*
+* mongoPoolConnectionWaitsGet - 
+*
+* Histogram of the waits for a free connection since the last reset: fills the
+* MONGO_POOL_WAIT_BUCKETS names and counters and returns the total number of waits.
+*/
+extern long mongoPoolConnectionWaitsGet(const char** nameV, long* countV);
+
+
+
 /* ****************************************************************************
 *
 * mongoPoolConnectionSemWaitingTimeReset - 
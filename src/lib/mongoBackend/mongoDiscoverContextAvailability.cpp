@@ -397,6 +397,8 @@ HttpStatusCode mongoDiscoverContextAvailability
   const std::vector<std::string>&       servicePathV
 )
 {
+  BackendTimer  timer(BoDiscoverContextAvailability);
+
   int          offset         = atoi(uriParams[URI_PARAM_PAGINATION_OFFSET].c_str());
   int          limit          = atoi(uriParams[URI_PARAM_PAGINATION_LIMIT].c_str());
   std::string  detailsString  = uriParams[URI_PARAM_PAGINATION_DETAILS];
@@ -452,7 +454,7 @@ HttpStatusCode mongoDiscoverContextAvailability
                                                                   servicePathV);
   if (hsCode != SccOk)
   {
-    ++noOfDiscoveryErrors;
+    statisticsCount(StatDiscoveryErrors);
   }
 
   reqSemGive(__FUNCTION__, "mongo ngsi9 discovery request", reqSemTaken);
@@ -24,6 +24,7 @@
 */
 
 #include "common/sem.h"
+#include "common/statistics.h"
 
 #include "mongoBackend/mongoNotifyContext.h"
 #include "mongoBackend/MongoGlobal.h"
@@ -43,6 +44,8 @@ HttpStatusCode mongoNotifyContext
   const std::vector<std::string>&  servicePathV
 )
 {
+    BackendTimer  timer(BoNotifyContext);
+
     bool reqSemTaken;
 
     reqSemTake(__FUNCTION__, "ngsi10 notification", SemWriteOp, &reqSemTaken);
@@ -24,6 +24,7 @@
 */
 
 #include "common/sem.h"
+#include "common/statistics.h"
 #include "logMsg/traceLevels.h"
 
 #include "mongoBackend/mongoNotifyContextAvailability.h"
@@ -45,6 +46,8 @@ HttpStatusCode mongoNotifyContextAvailability
   const std::string&                   servicePath
 )
 {
+    BackendTimer  timer(BoNotifyContextAvailability);
+
     const std::string notifyFormat = uriParam[URI_PARAM_NOTIFY_FORMAT];
     bool              reqSemTaken;
 
@@ -29,9 +29,12 @@
 
 #include "common/globals.h"
 #include "common/sem.h"
+#include "common/statistics.h"
 
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/mongoOntimeintervalOperations.h"
+#include "mongoBackend/subscriptionCache.h"
+#include "mongoBackend/subscriptionCounters.h"
 
 using namespace mongo;
 
@@ -113,6 +116,15 @@ HttpStatusCode mongoGetContextSubscriptionInfo(const std::string& subId, Context
         csiP->lastNotification = -1;
     }
 
+    /* A lastNotification not yet flushed to csubs is more recent than the one in the database */
+    if (subCountersActive()) {
+        long long pendingLastNotification = subCountersLastNotificationGet(tenant, subId);
+
+        if (pendingLastNotification > csiP->lastNotification) {
+            csiP->lastNotification = pendingLastNotification;
+        }
+    }
+
     csiP->throttling = sub.hasField(CSUB_THROTTLING) ? sub.getField(CSUB_THROTTLING).numberLong() : -1;
 
     /* Get format. If not found in the csubs document (it could happen in the case of updating Orion using an existing database) we use XML */
@@ -131,6 +143,8 @@ HttpStatusCode mongoGetContextSubscriptionInfo(const std::string& subId, Context
 */
 HttpStatusCode mongoGetContextElementResponses(const EntityIdVector& enV, const AttributeList& attrL, ContextElementResponseVector* cerV, std::string* err, const std::string& tenant)
 {
+    BackendTimer  timer(BoGetContextElementResponses);
+
     bool reqSemTaken;
 
     reqSemTake(__FUNCTION__, "get context-element responses", SemReadOp, &reqSemTaken);
@@ -165,6 +179,14 @@ HttpStatusCode mongoUpdateCsubNewNotification(const std::string& subId, std::str
 {
     DBClientBase*  connection  = NULL;
     bool           reqSemTaken = false;
+    long long      lastNotification = getCurrentTime();
+
+    /* Written to csubs by the next flush of the subscription counters */
+    if (subCountersActive()) {
+        subCountersNotified(tenant, subId, lastNotification);
+        subCacheLastNotificationSet(tenant, subId, lastNotification);
+        return SccOk;
+    }
 
     reqSemTake(__FUNCTION__, "update subscription notifications", SemWriteOp, &reqSemTaken);
 
@@ -172,7 +194,7 @@ HttpStatusCode mongoUpdateCsubNewNotification(const std::string& subId, std::str
 
     /* Update the document */
     BSONObj query  = BSON("_id" << OID(subId));
-    BSONObj update = BSON("$set" << BSON(CSUB_LASTNOTIFICATION << getCurrentTime()) << "$inc" << BSON(CSUB_COUNT << 1));
+    BSONObj update = BSON("$set" << BSON(CSUB_LASTNOTIFICATION << lastNotification) << "$inc" << BSON(CSUB_COUNT << 1));
 
     LM_T(LmtMongo, ("update() in '%s' collection: (%s,%s)", getSubscribeContextCollectionName(tenant).c_str(),
                     query.toString().c_str(),
@@ -185,6 +207,8 @@ HttpStatusCode mongoUpdateCsubNewNotification(const std::string& subId, std::str
         releaseMongoConnection(connection);
 
         LM_I(("Database Operation Successful (update: %s, query %s)", update.toString().c_str(), query.toString().c_str()));
+
+        subCacheLastNotificationSet(tenant, subId, lastNotification);
     }
     catch (const DBException &e)
     {
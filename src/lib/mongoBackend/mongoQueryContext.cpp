@@ -28,6 +28,7 @@
 #include "logMsg/traceLevels.h"
 
 #include "common/sem.h"
+#include "common/statistics.h"
 
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/mongoQueryContext.h"
@@ -266,6 +267,9 @@ void processGenericEntities(EntityIdVector& enV, ContextElementResponseVector& c
 *
 *   This replaces the 'uriParams[URI_PARAM_PAGINATION_DETAILS]' way of passing this information.
 *   The old method was one-way, using the new method 
+*
+*   If the URI parameter pageToken is present, keyset pagination is used instead of offset and,
+*   if nextPageTokenP is non-NULL, the token for the next page (if any) is returned in it.
 */
 HttpStatusCode mongoQueryContext
 (
@@ -274,16 +278,37 @@ HttpStatusCode mongoQueryContext
   const std::string&                   tenant,
   const std::vector<std::string>&      servicePathV,
   std::map<std::string, std::string>&  uriParams,
-  long long*                           countP
+  long long*                           countP,
+  std::string*                         nextPageTokenP
 )
 {
+    BackendTimer  timer(BoQueryContext);
+
     int         offset         = atoi(uriParams[URI_PARAM_PAGINATION_OFFSET].c_str());
     int         limit          = atoi(uriParams[URI_PARAM_PAGINATION_LIMIT].c_str());
     std::string detailsString  = uriParams[URI_PARAM_PAGINATION_DETAILS];
     bool        details        = (strcasecmp("on", detailsString.c_str()) == 0)? true : false;
 
+    std::map<std::string, std::string>::const_iterator  tokenIter  = uriParams.find(URI_PARAM_PAGINATION_TOKEN);
+    const std::string*                                   pageTokenP = (tokenIter != uriParams.end())? &tokenIter->second : NULL;
+
     LM_T(LmtMongo, ("QueryContext Request"));    
-    LM_T(LmtPagination, ("Offset: %d, Limit: %d, Details: %s", offset, limit, (details == true)? "true" : "false"));
+    LM_T(LmtPagination, ("Offset: %d, Limit: %d, Details: %s, PageToken: %s",
+                         offset,
+                         limit,
+                         (details == true)? "true" : "false",
+                         (pageTokenP != NULL)? pageTokenP->c_str() : "none"));
+
+    if (pageTokenP != NULL)
+    {
+      if ((*pageTokenP != "") && !pageTokenCheck(*pageTokenP))
+      {
+        responseP->errorCode.fill(SccBadRequest, "Bad pagination token");
+        return SccOk;
+      }
+
+      offset = 0;
+    }
 
     /* FIXME: restriction not supported for the moment */
     if (!requestP->restriction.attributeExpression.isEmpty())
@@ -309,7 +334,9 @@ HttpStatusCode mongoQueryContext
                        offset,
                        limit,
                        &limitReached,
-                       countP);
+                       countP,
+                       pageTokenP,
+                       (pageTokenP != NULL)? nextPageTokenP : NULL);
     reqSemGive(__FUNCTION__, "ngsi10 query request", reqSemTaken);
 
     if (!ok)
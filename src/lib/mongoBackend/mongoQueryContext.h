@@ -44,7 +44,8 @@ extern HttpStatusCode mongoQueryContext
   const std::string&                    tenant,
   const std::vector<std::string>&       servicePathV,
   std::map<std::string, std::string>&   uriParams,
-  long long*                            countP = NULL
+  long long*                            countP         = NULL,
+  std::string*                          nextPageTokenP = NULL
 );
 
 #endif
@@ -22,16 +22,145 @@
 *
 * Author: Fermin Galan Marquez
 */
+#include <map>
+#include <set>
 #include <string>
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
 #include "common/sem.h"
+#include "common/statistics.h"
 
 #include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/entityTypesCache.h"
 #include "mongoBackend/mongoQueryTypes.h"
 
+/* ****************************************************************************
+*
+* paginationStatusFill -
+*
+* 'shown' is the number of items in the response and 'total' the number of items
+* before pagination, 'what' is "types" or "attributes" (for the details of the "not found" case)
+*/
+static void paginationStatusFill
+(
+  StatusCode*    scP,
+  unsigned int   shown,
+  unsigned int   total,
+  unsigned int   offset,
+  bool           details,
+  const char*    what
+)
+{
+  char detailsMsg[256];
+
+  if (shown > 0)
+  {
+    if (details)
+    {
+      snprintf(detailsMsg, sizeof(detailsMsg), "Count: %d", (int) total);
+      scP->fill(SccOk, detailsMsg);
+    }
+    else
+    {
+      scP->fill(SccOk);
+    }
+  }
+  else
+  {
+    if (details)
+    {
+      snprintf(detailsMsg, sizeof(detailsMsg), "Number of %s: %d. Offset is %d", what, (int) total, offset);
+      scP->fill(SccContextElementNotFound, detailsMsg);
+    }
+    else
+    {
+      scP->fill(SccContextElementNotFound);
+    }
+  }
+}
+
+/* ****************************************************************************
+*
+* entityTypesFromCache - mongoEntityTypes response from the entity types cache
+*/
+static void entityTypesFromCache
+(
+  EntityTypesResponse*                             responseP,
+  std::map<std::string, std::set<std::string> >&  typesMap,
+  unsigned int                                     offset,
+  unsigned int                                     limit,
+  bool                                             details
+)
+{
+  if (typesMap.size() == 0)
+  {
+    responseP->statusCode.fill(SccContextElementNotFound);
+    return;
+  }
+
+  unsigned int ix = 0;
+  for (std::map<std::string, std::set<std::string> >::iterator it = typesMap.begin(); it != typesMap.end(); ++it, ++ix)
+  {
+    if (ix < offset)
+    {
+      continue;
+    }
+
+    if (ix >= offset + limit)
+    {
+      break;
+    }
+
+    TypeEntity* type = new TypeEntity(it->first);
+
+    for (std::set<std::string>::iterator aIt = it->second.begin(); aIt != it->second.end(); ++aIt)
+    {
+      type->contextAttributeVector.push_back(new ContextAttribute(*aIt, "", ""));
+    }
+
+    responseP->typeEntityVector.push_back(type);
+  }
+
+  paginationStatusFill(&responseP->statusCode, responseP->typeEntityVector.size(), typesMap.size(), offset, details, "types");
+}
+
+/* ****************************************************************************
+*
+* attributesFromCache - mongoAttributesForEntityType response from the entity types cache
+*/
+static void attributesFromCache
+(
+  const std::string&                               entityType,
+  EntityTypeAttributesResponse*                    responseP,
+  std::map<std::string, std::set<std::string> >&  typesMap,
+  unsigned int                                     offset,
+  unsigned int                                     limit,
+  bool                                             details
+)
+{
+  /* The "" key holds the entities without type, not matched by {"_id.type": ""} in the aggregation */
+  if ((entityType == "") || (typesMap.count(entityType) == 0) || (typesMap[entityType].size() == 0))
+  {
+    responseP->statusCode.fill(SccContextElementNotFound);
+    return;
+  }
+
+  std::set<std::string>&  attrSet = typesMap[entityType];
+  unsigned int            ix      = 0;
+
+  for (std::set<std::string>::iterator it = attrSet.begin(); (it != attrSet.end()) && (ix < offset + limit); ++it, ++ix)
+  {
+    if (ix >= offset)
+    {
+      responseP->entityType.contextAttributeVector.push_back(new ContextAttribute(*it, "", ""));
+    }
+  }
+
+  paginationStatusFill(&responseP->statusCode, responseP->entityType.contextAttributeVector.size(), attrSet.size(), offset, details, "attributes");
+}
+
 /* ****************************************************************************
 *
 * mongoEntityTypes -
@@ -44,6 +173,8 @@ HttpStatusCode mongoEntityTypes
   std::map<std::string, std::string>&   uriParams
 )
 {
+  BackendTimer  timer(BoEntityTypes);
+
   unsigned int   offset         = atoi(uriParams[URI_PARAM_PAGINATION_OFFSET].c_str());
   unsigned int   limit          = atoi(uriParams[URI_PARAM_PAGINATION_LIMIT].c_str());
   std::string    detailsString  = uriParams[URI_PARAM_PAGINATION_DETAILS];
@@ -56,6 +187,16 @@ HttpStatusCode mongoEntityTypes
 
   reqSemTake(__FUNCTION__, "query types request", SemReadOp, &reqSemTaken);
 
+  /* With the entity types cache, the collection is not aggregated at all */
+  std::map<std::string, std::set<std::string> > typesMap;
+
+  if (typesCacheActive() && typesCacheGet(tenant, servicePathV, &typesMap))
+  {
+    entityTypesFromCache(responseP, typesMap, offset, limit, details);
+    reqSemGive(__FUNCTION__, "query types request", reqSemTaken);
+    return SccOk;
+  }
+
   /* Compose query based on this aggregation command:  
    *
    * db.runCommand({aggregate: "entities",
@@ -196,31 +337,7 @@ HttpStatusCode mongoEntityTypes
     responseP->typeEntityVector.push_back(type);
   }
 
-  char detailsMsg[256];
-  if (responseP->typeEntityVector.size() > 0)
-  {
-    if (details)
-    {
-      snprintf(detailsMsg, sizeof(detailsMsg), "Count: %d", (int) resultsArray.size());
-      responseP->statusCode.fill(SccOk, detailsMsg);
-    }
-    else
-    {
-      responseP->statusCode.fill(SccOk);
-    }
-  }
-  else
-  {
-    if (details)
-    {      
-      snprintf(detailsMsg, sizeof(detailsMsg), "Number of types: %d. Offset is %d", (int) resultsArray.size(), offset);
-      responseP->statusCode.fill(SccContextElementNotFound, detailsMsg);
-    }
-    else
-    {
-      responseP->statusCode.fill(SccContextElementNotFound);
-    }
-  }
+  paginationStatusFill(&responseP->statusCode, responseP->typeEntityVector.size(), resultsArray.size(), offset, details, "types");
 
   reqSemGive(__FUNCTION__, "query types request", reqSemTaken);
 
@@ -241,6 +358,8 @@ HttpStatusCode mongoAttributesForEntityType
   std::map<std::string, std::string>&   uriParams
 )
 {
+  BackendTimer  timer(BoAttributesForEntityType);
+
   DBClientBase*  connection     = NULL;
   unsigned int   offset         = atoi(uriParams[URI_PARAM_PAGINATION_OFFSET].c_str());
   unsigned int   limit          = atoi(uriParams[URI_PARAM_PAGINATION_LIMIT].c_str());
@@ -256,6 +375,16 @@ HttpStatusCode mongoAttributesForEntityType
 
   reqSemTake(__FUNCTION__, "query types attributes request", SemReadOp, &reqSemTaken);
 
+  /* With the entity types cache, the collection is not aggregated at all */
+  std::map<std::string, std::set<std::string> > typesMap;
+
+  if (typesCacheActive() && typesCacheGet(tenant, servicePathV, &typesMap))
+  {
+    attributesFromCache(entityType, responseP, typesMap, offset, limit, details);
+    reqSemGive(__FUNCTION__, "query types request", reqSemTaken);
+    return SccOk;
+  }
+
 
   /* Compose query based on this aggregation command:   
    *
@@ -355,31 +484,7 @@ HttpStatusCode mongoAttributesForEntityType
     responseP->entityType.contextAttributeVector.push_back(ca);
   }
 
-  char detailsMsg[256];
-  if (responseP->entityType.contextAttributeVector.size() > 0)
-  {
-    if (details)
-    {
-      snprintf(detailsMsg, sizeof(detailsMsg), "Count: %d", (int) resultsArray.size());
-      responseP->statusCode.fill(SccOk, detailsMsg);
-    }
-    else
-    {
-      responseP->statusCode.fill(SccOk);
-    }
-  }
-  else
-  {
-    if (details)
-    {
-      snprintf(detailsMsg, sizeof(detailsMsg), "Number of attributes: %d. Offset is %d", (int) resultsArray.size(), offset);
-      responseP->statusCode.fill(SccContextElementNotFound, detailsMsg);
-    }
-    else
-    {
-      responseP->statusCode.fill(SccContextElementNotFound);
-    }
-  }
+  paginationStatusFill(&responseP->statusCode, responseP->entityType.contextAttributeVector.size(), resultsArray.size(), offset, details, "attributes");
 
   reqSemGive(__FUNCTION__, "query types request", reqSemTaken);
 
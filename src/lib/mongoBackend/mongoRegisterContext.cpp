@@ -54,6 +54,8 @@ HttpStatusCode mongoRegisterContext
   const std::string&                   servicePath
 )
 {
+    BackendTimer  timer(BoRegisterContext);
+
     DBClientBase*      connection    = NULL;
     std::string        sPath         = servicePath;
     const std::string  notifyFormat  = uriParam[URI_PARAM_NOTIFY_FORMAT];
@@ -100,7 +102,7 @@ HttpStatusCode mongoRegisterContext
         // mongoBackend. By the moment we can live this here, but we should remove in the future
         responseP->errorCode.fill(SccContextElementNotFound);
         responseP->registrationId = requestP->registrationId;
-        ++noOfRegistrationUpdateErrors;
+        statisticsCount(StatRegistrationUpdateErrors);
         LM_W(("Bad Input (invalid OID format)"));
         return SccOk;
     }
@@ -113,7 +115,7 @@ HttpStatusCode mongoRegisterContext
                                   std::string("collection: ") + getRegistrationsCollectionName(tenant).c_str() +
                                   " - findOne() _id: " + requestP->registrationId.get() +
                                   " - exception: " + e.what());
-        ++noOfRegistrationUpdateErrors;
+        statisticsCount(StatRegistrationUpdateErrors);
         LM_E(("Database Error (%s)", responseP->errorCode.details.c_str()));
         return SccOk;
     }
@@ -126,7 +128,7 @@ HttpStatusCode mongoRegisterContext
                                   std::string("collection: ") + getRegistrationsCollectionName(tenant).c_str() +
                                   " - findOne() _id: " + requestP->registrationId.get() +
                                   " - exception: " + "generic");
-        ++noOfRegistrationUpdateErrors;
+        statisticsCount(StatRegistrationUpdateErrors);
         LM_E(("Database Error (%s)", responseP->errorCode.details.c_str()));
         return SccOk;
     }
@@ -136,7 +138,7 @@ HttpStatusCode mongoRegisterContext
        reqSemGive(__FUNCTION__, "ngsi9 register request (no registrations found)", reqSemTaken);
        responseP->errorCode.fill(SccContextElementNotFound, std::string("registration id: /") + requestP->registrationId.get() + "/");
        responseP->registrationId = requestP->registrationId;
-       ++noOfRegistrationUpdateErrors;
+       statisticsCount(StatRegistrationUpdateErrors);
        return SccOk;
     }
 
@@ -29,8 +29,11 @@
 #include "common/globals.h"
 #include "common/Format.h"
 #include "common/sem.h"
+#include "common/statistics.h"
 #include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/indexManager.h"
 #include "mongoBackend/mongoSubscribeContext.h"
+#include "mongoBackend/subscriptionCache.h"
 #include "ngsi10/SubscribeContextRequest.h"
 #include "ngsi10/SubscribeContextResponse.h"
 #include "ngsi/StatusCode.h"
@@ -50,6 +53,8 @@ HttpStatusCode mongoSubscribeContext
   const std::vector<std::string>&      servicePathV
 )
 {
+    BackendTimer  timer(BoSubscribeContext);
+
     const std::string  notifyFormatAsString  = uriParam[URI_PARAM_NOTIFY_FORMAT];
     Format             notifyFormat          = stringToFormat(notifyFormatAsString);
     std::string        servicePath           = (servicePathV.size() == 0)? "" : servicePathV[0];
@@ -137,6 +142,8 @@ HttpStatusCode mongoSubscribeContext
 
     /* Insert document in database */
     BSONObj subDoc = sub.obj();
+
+    indexesEnsure(tenant);
     LM_T(LmtMongo, ("insert() in '%s' collection: '%s'", getSubscribeContextCollectionName(tenant).c_str(), subDoc.toString().c_str()));
 
     try
@@ -145,6 +152,8 @@ HttpStatusCode mongoSubscribeContext
         connection->insert(getSubscribeContextCollectionName(tenant).c_str(), subDoc);
         releaseMongoConnection(connection);
         LM_I(("Database Operation Successful (insert %s)", subDoc.toString().c_str()));
+
+        subCacheInsert(tenant, oid.toString(), subDoc);
     }
     catch (const DBException &e)
     {
@@ -38,6 +38,7 @@
 
 #include "common/Format.h"
 #include "common/sem.h"
+#include "common/statistics.h"
 
 /* ****************************************************************************
 *
@@ -52,6 +53,8 @@ HttpStatusCode mongoSubscribeContextAvailability
   const std::string&                     tenant
 )
 {
+    BackendTimer  timer(BoSubscribeContextAvailability);
+
     DBClientBase*  connection = NULL;
     bool           reqSemTaken;
 
@@ -28,9 +28,11 @@
 #include "logMsg/traceLevels.h"
 
 #include "common/sem.h"
+#include "common/statistics.h"
 
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/mongoUnsubscribeContext.h"
+#include "mongoBackend/subscriptionCache.h"
 #include "ngsi10/UnsubscribeContextRequest.h"
 #include "ngsi10/UnsubscribeContextResponse.h"
 
@@ -40,6 +42,8 @@
 */
 HttpStatusCode mongoUnsubscribeContext(UnsubscribeContextRequest* requestP, UnsubscribeContextResponse* responseP, const std::string& tenant)
 {
+    BackendTimer  timer(BoUnsubscribeContext);
+
     bool           reqSemTaken;
     BSONObj        sub;
     DBClientBase*  connection = NULL;
@@ -134,6 +138,8 @@ HttpStatusCode mongoUnsubscribeContext(UnsubscribeContextRequest* requestP, Unsu
         releaseMongoConnection(connection);
         
         LM_I(("Database Operation Successful (remove _id: %s)", requestP->subscriptionId.get().c_str()));
+
+        subCacheRemove(tenant, requestP->subscriptionId.get());
     }
     catch (const DBException &e)
     {
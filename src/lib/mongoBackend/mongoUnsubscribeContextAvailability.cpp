@@ -33,6 +33,7 @@
 #include "ngsi9/UnsubscribeContextAvailabilityResponse.h"
 
 #include "common/sem.h"
+#include "common/statistics.h"
 
 /* ****************************************************************************
 *
@@ -45,6 +46,8 @@ HttpStatusCode mongoUnsubscribeContextAvailability
   const std::string&                       tenant
 )
 {
+  BackendTimer  timer(BoUnsubscribeContextAvailability);
+
   DBClientBase*  connection = NULL;
   bool           reqSemTaken;
 
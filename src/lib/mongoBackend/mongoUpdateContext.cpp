@@ -31,6 +31,7 @@
 
 #include "common/globals.h"
 #include "common/sem.h"
+#include "common/statistics.h"
 
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/MongoCommonUpdate.h"
@@ -55,6 +56,8 @@ HttpStatusCode mongoUpdateContext
   const std::string&                    caller
 )
 {
+    BackendTimer  timer(BoUpdateContext);
+
     bool reqSemTaken;
 
     reqSemTake(__FUNCTION__, "ngsi10 update request", SemWriteOp, &reqSemTaken);
@@ -68,17 +71,14 @@ HttpStatusCode mongoUpdateContext
     else
     {
         /* Process each ContextElement */
-        for (unsigned int ix= 0; ix < requestP->contextElementVector.size(); ++ix)
-        {
-          processContextElement(requestP->contextElementVector.get(ix),
-                                responseP,
-                                requestP->updateActionType.get(),
-                                tenant,
-                                servicePathV,
-                                uriParams,
-                                xauthToken,
-                                caller);
-        }
+        processContextElementVector(&requestP->contextElementVector,
+                                    responseP,
+                                    requestP->updateActionType.get(),
+                                    tenant,
+                                    servicePathV,
+                                    uriParams,
+                                    xauthToken,
+                                    caller);
 
         /* Note that although individual processContextElements() invocations return ConnectionError, this
            error gets "encapsulated" in the StatusCode of the corresponding ContextElementResponse and we
@@ -30,6 +30,7 @@
 #include "common/globals.h"
 #include "common/Format.h"
 #include "common/sem.h"
+#include "common/statistics.h"
 
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/mongoUpdateContextAvailabilitySubscription.h"
@@ -48,6 +49,8 @@ HttpStatusCode mongoUpdateContextAvailabilitySubscription
   const std::string&                              tenant
 )
 {
+  BackendTimer  timer(BoUpdateContextAvailabilitySubscription);
+
   bool reqSemTaken;
 
   LM_T(LmtMongo, ("Update Context Subscription, notifyFormat: '%s'", formatToString(notifyFormat)));
@@ -30,11 +30,13 @@
 
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/mongoUpdateContextSubscription.h"
+#include "mongoBackend/subscriptionCache.h"
 #include "ngsi10/UpdateContextSubscriptionRequest.h"
 #include "ngsi10/UpdateContextSubscriptionResponse.h"
 
 #include "common/Format.h"
 #include "common/sem.h"
+#include "common/statistics.h"
 
 /* ****************************************************************************
 *
@@ -50,6 +52,8 @@ HttpStatusCode mongoUpdateContextSubscription
   const std::vector<std::string>&     servicePathV
 )
 {
+  BackendTimer  timer(BoUpdateContextSubscription);
+
   DBClientBase* connection = NULL;
   bool          reqSemTaken;
 
@@ -225,6 +229,8 @@ HttpStatusCode mongoUpdateContextSubscription
       releaseMongoConnection(connection);
 
       LM_I(("Database Operation Successful (update _id: %s, %s)", requestP->subscriptionId.get().c_str(), update.toString().c_str()));
+
+      subCacheInsert(tenant, requestP->subscriptionId.get(), update);
   }
   catch (const DBException &e)
   {
@@ -0,0 +1,945 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+#include <regex.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/globals.h"
+#include "common/string.h"
+#include "common/Format.h"
+#include "ngsi/AttributeList.h"
+#include "ngsi/NotifyCondition.h"
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/TriggeredSubscription.h"
+#include "mongoBackend/subscriptionCache.h"
+
+using std::auto_ptr;
+
+
+
+/* ****************************************************************************
+*
+* CachedSubEntity -
+*
+* 'regexOk' is false for the patterns that can't be evaluated in memory (see patternPortable)
+*/
+typedef struct CachedSubEntity
+{
+  std::string  id;
+  std::string  type;
+  bool         isPattern;
+  bool         regexOk;
+  regex_t      regex;
+} CachedSubEntity;
+
+
+
+/* ****************************************************************************
+*
+* CachedSubscription -
+*/
+typedef struct CachedSubscription
+{
+  std::string                    subId;
+  bool                           hasServicePath;
+  std::string                    servicePath;
+  long long                      expiration;
+  long long                      throttling;
+  long long                      lastNotification;
+  Format                         format;
+  std::string                    reference;
+  AttributeList                  attrL;
+  std::vector<std::string>       condAttrV;
+  std::vector<CachedSubEntity*>  entityV;
+  bool                           hasPattern;
+} CachedSubscription;
+
+
+
+/* ****************************************************************************
+*
+* TenantSubCache -
+*
+* 'byIdAndAttr' indexes non-pattern entities by (entity id, ONCHANGE condition attribute).
+* 'patternV' holds the subscriptions having at least one pattern entity.
+*/
+typedef std::pair<std::string, std::string>                 IdAttrKey;
+typedef std::multimap<IdAttrKey, CachedSubscription*>        IdAttrIndex;
+
+typedef struct TenantSubCache
+{
+  std::map<std::string, CachedSubscription*>  subs;
+  IdAttrIndex                                 byIdAndAttr;
+  std::vector<CachedSubscription*>            patternV;
+} TenantSubCache;
+
+
+
+/* ****************************************************************************
+*
+* Globals -
+*/
+static bool                                   cacheActive = false;
+static std::map<std::string, TenantSubCache>  cache;
+static pthread_mutex_t                        cacheMutex  = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/* ****************************************************************************
+*
+* subCacheInit -
+*/
+void subCacheInit(bool active)
+{
+  cacheActive = active;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheActive -
+*/
+bool subCacheActive(void)
+{
+  return cacheActive;
+}
+
+
+
+/* ****************************************************************************
+*
+* cachedSubscriptionRelease -
+*/
+static void cachedSubscriptionRelease(CachedSubscription* cSubP)
+{
+  for (unsigned int ix = 0; ix < cSubP->entityV.size(); ++ix)
+  {
+    CachedSubEntity* cEnP = cSubP->entityV[ix];
+
+    if (cEnP->regexOk)
+    {
+      regfree(&cEnP->regex);
+    }
+
+    delete cEnP;
+  }
+
+  cSubP->entityV.clear();
+  cSubP->attrL.release();
+  delete cSubP;
+}
+
+
+
+/* ****************************************************************************
+*
+* patternPortable - is the pattern the same regular expression in POSIX ERE and in JavaScript?
+*
+* The patterns of the subscriptions are JavaScript regular expressions (they were evaluated by
+* the $where function of the csubs query), but the cache evaluates them with regcomp/regexec.
+* Only the patterns built with the constructs having the same meaning in both syntaxes are
+* evaluated in memory: literals, '.', bracket expressions without escapes nor POSIX classes,
+* groups, alternatives, anchors, the greedy quantifiers and escaped special characters.
+* Shorthands as \d or \w, lazy quantifiers, '(?' groups, backreferences, etc. are not.
+*/
+static bool patternPortable(const std::string& pattern)
+{
+  const char*  p       = pattern.c_str();
+  bool         quantOk = false;  // a quantifier may follow
+
+  while (*p != 0)
+  {
+    switch (*p)
+    {
+    case '\\':
+      if ((p[1] == 0) || (strchr(".[]{}()*+?|^$\\/", p[1]) == NULL))
+      {
+        return false;
+      }
+      p      += 2;
+      quantOk = true;
+      continue;
+
+    case '[':
+      ++p;
+      if (*p == '^')
+      {
+        ++p;
+      }
+
+      if (*p == ']')  // literal ']' in ERE, empty class in JavaScript
+      {
+        return false;
+      }
+
+      while ((*p != 0) && (*p != ']'))
+      {
+        if ((*p == '\\') || ((*p == '[') && ((p[1] == ':') || (p[1] == '=') || (p[1] == '.'))))
+        {
+          return false;
+        }
+        ++p;
+      }
+
+      if (*p == 0)
+      {
+        return false;
+      }
+      break;
+
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+      if (!quantOk)
+      {
+        return false;
+      }
+
+      if (*p == '{')  // {n}, {n,} or {n,m}, anything else is not an interval in JavaScript
+      {
+        size_t digits = strspn(p + 1, "0123456789");
+
+        if (digits == 0)
+        {
+          return false;
+        }
+
+        p += digits + 1;
+        if (*p == ',')
+        {
+          p += strspn(p + 1, "0123456789") + 1;
+        }
+
+        if (*p != '}')
+        {
+          return false;
+        }
+      }
+
+      if ((p[1] == '?') || (p[1] == '*') || (p[1] == '+') || (p[1] == '{'))  // lazy or stacked quantifiers
+      {
+        return false;
+      }
+
+      ++p;
+      quantOk = false;
+      continue;
+
+    case '(':
+      if ((p[1] == '?') || (p[1] == ')') || (p[1] == '|'))
+      {
+        return false;
+      }
+      ++p;
+      quantOk = false;
+      continue;
+
+    case '|':
+      if ((p == pattern.c_str()) || (p[1] == 0) || (p[1] == '|') || (p[1] == ')'))
+      {
+        return false;
+      }
+      ++p;
+      quantOk = false;
+      continue;
+
+    case '^':
+    case '$':
+      ++p;
+      quantOk = false;
+      continue;
+
+    case '}':
+    case ']':
+      return false;
+    }
+
+    ++p;
+    quantOk = true;
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* cachedSubscriptionCreate -
+*
+* Returns NULL if the subscription has no ONCHANGE condition attributes
+*/
+static CachedSubscription* cachedSubscriptionCreate(const std::string& subId, const BSONObj& sub)
+{
+  std::vector<std::string> condAttrV;
+
+  if (!sub.hasField(CSUB_CONDITIONS))
+  {
+    return NULL;
+  }
+
+  std::vector<BSONElement> condV = sub.getField(CSUB_CONDITIONS).Array();
+  for (unsigned int ix = 0; ix < condV.size(); ++ix)
+  {
+    BSONObj condition = condV[ix].embeddedObject();
+
+    if (STR_FIELD(condition, CSUB_CONDITIONS_TYPE) != ON_CHANGE_CONDITION)
+    {
+      continue;
+    }
+
+    std::vector<BSONElement> valueV = condition.getField(CSUB_CONDITIONS_VALUE).Array();
+    for (unsigned int vIx = 0; vIx < valueV.size(); ++vIx)
+    {
+      condAttrV.push_back(valueV[vIx].String());
+    }
+  }
+
+  if (condAttrV.size() == 0)
+  {
+    return NULL;
+  }
+
+  CachedSubscription* cSubP = new CachedSubscription();
+
+  cSubP->subId            = subId;
+  cSubP->hasServicePath   = sub.hasField(CSUB_SERVICE_PATH);
+  cSubP->servicePath      = cSubP->hasServicePath? STR_FIELD(sub, CSUB_SERVICE_PATH) : "";
+  cSubP->expiration       = sub.getField(CSUB_EXPIRATION).numberLong();
+  cSubP->throttling       = sub.hasField(CSUB_THROTTLING)? sub.getField(CSUB_THROTTLING).numberLong() : -1;
+  cSubP->lastNotification = sub.hasField(CSUB_LASTNOTIFICATION)? sub.getIntField(CSUB_LASTNOTIFICATION) : -1;
+  cSubP->format           = sub.hasField(CSUB_FORMAT)? stringToFormat(STR_FIELD(sub, CSUB_FORMAT)) : XML;
+  cSubP->reference        = STR_FIELD(sub, CSUB_REFERENCE);
+  cSubP->attrL            = subToAttributeList(sub);
+  cSubP->condAttrV        = condAttrV;
+  cSubP->hasPattern       = false;
+
+  std::vector<BSONElement> entV = sub.getField(CSUB_ENTITIES).Array();
+  for (unsigned int ix = 0; ix < entV.size(); ++ix)
+  {
+    BSONObj           entity = entV[ix].embeddedObject();
+    CachedSubEntity*  cEnP   = new CachedSubEntity();
+
+    cEnP->id        = STR_FIELD(entity, CSUB_ENTITY_ID);
+    cEnP->type      = entity.hasField(CSUB_ENTITY_TYPE)? STR_FIELD(entity, CSUB_ENTITY_TYPE) : "";
+    cEnP->isPattern = (STR_FIELD(entity, CSUB_ENTITY_ISPATTERN) == "true");
+    cEnP->regexOk   = false;
+
+    if (cEnP->isPattern)
+    {
+      cSubP->hasPattern = true;
+
+      if (!patternPortable(cEnP->id))
+      {
+        LM_T(LmtMongo, ("pattern '%s' of subscription '%s' is matched in the database", cEnP->id.c_str(), subId.c_str()));
+      }
+      else if (regcomp(&cEnP->regex, cEnP->id.c_str(), REG_EXTENDED | REG_NOSUB) == 0)
+      {
+        cEnP->regexOk = true;
+      }
+      else
+      {
+        LM_W(("Bad Input (error compiling regex '%s' of subscription '%s')", cEnP->id.c_str(), subId.c_str()));
+      }
+    }
+
+    cSubP->entityV.push_back(cEnP);
+  }
+
+  return cSubP;
+}
+
+
+
+/* ****************************************************************************
+*
+* cacheRemove - remove a subscription from the tenant cache (cacheMutex must be taken)
+*/
+static void cacheRemove(TenantSubCache& tCache, const std::string& subId)
+{
+  std::map<std::string, CachedSubscription*>::iterator it = tCache.subs.find(subId);
+
+  if (it == tCache.subs.end())
+  {
+    return;
+  }
+
+  CachedSubscription* cSubP = it->second;
+
+  tCache.subs.erase(it);
+
+  for (unsigned int eIx = 0; eIx < cSubP->entityV.size(); ++eIx)
+  {
+    if (cSubP->entityV[eIx]->isPattern)
+    {
+      continue;
+    }
+
+    for (unsigned int aIx = 0; aIx < cSubP->condAttrV.size(); ++aIx)
+    {
+      IdAttrKey                                             key(cSubP->entityV[eIx]->id, cSubP->condAttrV[aIx]);
+      std::pair<IdAttrIndex::iterator, IdAttrIndex::iterator>  range = tCache.byIdAndAttr.equal_range(key);
+
+      for (IdAttrIndex::iterator iIt = range.first; iIt != range.second; ++iIt)
+      {
+        if (iIt->second == cSubP)
+        {
+          tCache.byIdAndAttr.erase(iIt);
+          break;
+        }
+      }
+    }
+  }
+
+  for (unsigned int ix = 0; ix < tCache.patternV.size(); ++ix)
+  {
+    if (tCache.patternV[ix] == cSubP)
+    {
+      tCache.patternV.erase(tCache.patternV.begin() + ix);
+      break;
+    }
+  }
+
+  cachedSubscriptionRelease(cSubP);
+}
+
+
+
+/* ****************************************************************************
+*
+* cacheInsert - insert a subscription in the tenant cache (cacheMutex must be taken)
+*/
+static void cacheInsert(TenantSubCache& tCache, CachedSubscription* cSubP)
+{
+  tCache.subs[cSubP->subId] = cSubP;
+
+  for (unsigned int eIx = 0; eIx < cSubP->entityV.size(); ++eIx)
+  {
+    if (cSubP->entityV[eIx]->isPattern)
+    {
+      continue;
+    }
+
+    for (unsigned int aIx = 0; aIx < cSubP->condAttrV.size(); ++aIx)
+    {
+      IdAttrKey key(cSubP->entityV[eIx]->id, cSubP->condAttrV[aIx]);
+
+      tCache.byIdAndAttr.insert(std::pair<IdAttrKey, CachedSubscription*>(key, cSubP));
+    }
+  }
+
+  if (cSubP->hasPattern)
+  {
+    tCache.patternV.push_back(cSubP);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheInsert -
+*/
+void subCacheInsert(const std::string& tenant, const std::string& subId, const BSONObj& sub)
+{
+  if (!cacheActive)
+  {
+    return;
+  }
+
+  CachedSubscription* cSubP = cachedSubscriptionCreate(subId, sub);
+
+  pthread_mutex_lock(&cacheMutex);
+
+  std::map<std::string, TenantSubCache>::iterator it = cache.find(tenant);
+
+  if (it != cache.end())
+  {
+    cacheRemove(it->second, subId);
+  }
+
+  if (cSubP != NULL)
+  {
+    cacheInsert(cache[tenant], cSubP);
+  }
+
+  pthread_mutex_unlock(&cacheMutex);
+
+  LM_T(LmtMongo, ("subscription cache: '%s' %s (tenant '%s')", subId.c_str(), (cSubP != NULL)? "inserted" : "not cached", tenant.c_str()));
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheRemove -
+*/
+void subCacheRemove(const std::string& tenant, const std::string& subId)
+{
+  if (!cacheActive)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&cacheMutex);
+
+  std::map<std::string, TenantSubCache>::iterator it = cache.find(tenant);
+
+  if (it != cache.end())
+  {
+    cacheRemove(it->second, subId);
+  }
+
+  pthread_mutex_unlock(&cacheMutex);
+
+  LM_T(LmtMongo, ("subscription cache: '%s' removed (tenant '%s')", subId.c_str(), tenant.c_str()));
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheLastNotificationSet -
+*/
+void subCacheLastNotificationSet(const std::string& tenant, const std::string& subId, long long lastNotification)
+{
+  if (!cacheActive)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&cacheMutex);
+
+  std::map<std::string, TenantSubCache>::iterator tIt = cache.find(tenant);
+
+  if (tIt != cache.end())
+  {
+    std::map<std::string, CachedSubscription*>::iterator it = tIt->second.subs.find(subId);
+
+    if (it != tIt->second.subs.end())
+    {
+      it->second->lastNotification = lastNotification;
+    }
+  }
+
+  pthread_mutex_unlock(&cacheMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheLoad -
+*/
+void subCacheLoad(const std::string& tenant)
+{
+  if (!cacheActive)
+  {
+    return;
+  }
+
+  std::string               condType   = CSUB_CONDITIONS "." CSUB_CONDITIONS_TYPE;
+  BSONObj                   query      = BSON(condType << ON_CHANGE_CONDITION);
+  DBClientBase*             connection = getMongoConnection();
+  auto_ptr<DBClientCursor>  cursor;
+
+  LM_T(LmtMongo, ("query() in '%s' collection: '%s'",
+                  getSubscribeContextCollectionName(tenant).c_str(),
+                  query.toString().c_str()));
+
+  try
+  {
+    cursor = connection->query(getSubscribeContextCollectionName(tenant).c_str(), query);
+
+    /*
+     * We have observed that in some cases of DB errors (e.g. the database daemon is down) instead of
+     * raising an exception, the query() method sets the cursor to NULL. In this case, we raise the
+     * exception ourselves
+     */
+    if (cursor.get() == NULL)
+    {
+      throw DBException("Null cursor from mongo (details on this is found in the source code)", 0);
+    }
+    releaseMongoConnection(connection);
+
+    LM_I(("Database Operation Successful (%s)", query.toString().c_str()));
+  }
+  catch (const DBException &e)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (DBException: %s)", e.what()));
+    return;
+  }
+  catch (...)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (generic exception)"));
+    return;
+  }
+
+  int subs = 0;
+  while (cursor->more())
+  {
+    BSONObj      sub     = cursor->next();
+    BSONElement  idField = sub.getField("_id");
+
+    if (idField.eoo() == true)
+    {
+      LM_E(("Database Error (error retrieving _id field in doc: '%s')", sub.toString().c_str()));
+      continue;
+    }
+
+    subCacheInsert(tenant, idField.OID().toString(), sub);
+    ++subs;
+  }
+
+  LM_I(("Subscription cache loaded: %d ONCHANGE subscriptions (tenant '%s')", subs, tenant.c_str()));
+}
+
+
+
+/* ****************************************************************************
+*
+* servicePathMatch -
+*
+* Same semantics as fillQuerySubscriptionServicePath: a subscription without service path
+* matches always; otherwise its service path must be "/#", "" (or "/" if the entity has no
+* service path), the exact service path of the entity or one of its ancestors followed by "/#"
+*/
+static bool servicePathMatch(const CachedSubscription* cSubP, const std::string& servicePath)
+{
+  if (!cSubP->hasServicePath)
+  {
+    return true;
+  }
+
+  const std::string& subPath = cSubP->servicePath;
+
+  if ((subPath == "") || (subPath == "/#"))
+  {
+    return true;
+  }
+
+  std::vector<std::string>  spathV;
+  int                       components = 0;
+
+  if (servicePath != "")
+  {
+    components = stringSplit(servicePath, '/', spathV);
+  }
+
+  if (components == 0)
+  {
+    return (subPath == "/");
+  }
+
+  std::string path = "";
+  for (int ix = 0; ix < components; ++ix)
+  {
+    path += "/" + spathV[ix];
+
+    if (subPath == path + "/#")
+    {
+      return true;
+    }
+  }
+
+  return (subPath == path);
+}
+
+
+
+/* ****************************************************************************
+*
+* triggeredAdd -
+*/
+static void triggeredAdd(CachedSubscription* cSubP, std::map<std::string, TriggeredSubscription*>& subs)
+{
+  if (subs.count(cSubP->subId) != 0)
+  {
+    return;
+  }
+
+  AttributeList attrL;
+  attrL.clone(cSubP->attrL);
+
+  TriggeredSubscription* trigs = new TriggeredSubscription(cSubP->throttling,
+                                                           cSubP->lastNotification,
+                                                           cSubP->format,
+                                                           cSubP->reference,
+                                                           attrL);
+
+  subs.insert(std::pair<std::string, TriggeredSubscription*>(cSubP->subId, trigs));
+}
+
+
+
+/* ****************************************************************************
+*
+* cacheMatch - the subscriptions of 'tCache' triggered by a change in 'attr' of an entity
+*
+* Returns false if some candidate subscription has a pattern that can't be evaluated in memory
+*/
+static bool cacheMatch
+(
+  TenantSubCache&                                tCache,
+  const std::string&                             entityId,
+  const std::string&                             entityType,
+  const std::string&                             attr,
+  const std::string&                             servicePath,
+  std::map<std::string, TriggeredSubscription*>& subs
+)
+{
+  long long  now      = getCurrentTime();
+  bool       resolved = true;
+
+  /* 1. Non-pattern entities, through the index */
+  std::pair<IdAttrIndex::iterator, IdAttrIndex::iterator> range = tCache.byIdAndAttr.equal_range(IdAttrKey(entityId, attr));
+
+  for (IdAttrIndex::iterator it = range.first; it != range.second; ++it)
+  {
+    CachedSubscription* cSubP = it->second;
+
+    if ((cSubP->expiration <= now) || !servicePathMatch(cSubP, servicePath))
+    {
+      continue;
+    }
+
+    for (unsigned int eIx = 0; eIx < cSubP->entityV.size(); ++eIx)
+    {
+      CachedSubEntity* cEnP = cSubP->entityV[eIx];
+
+      if (!cEnP->isPattern && (cEnP->id == entityId) && ((cEnP->type == "") || (cEnP->type == entityType)))
+      {
+        triggeredAdd(cSubP, subs);
+        break;
+      }
+    }
+  }
+
+  /* 2. Pattern entities, a regex scan */
+  for (unsigned int ix = 0; ix < tCache.patternV.size(); ++ix)
+  {
+    CachedSubscription* cSubP    = tCache.patternV[ix];
+    bool                attrHit  = false;
+
+    for (unsigned int aIx = 0; aIx < cSubP->condAttrV.size(); ++aIx)
+    {
+      if (cSubP->condAttrV[aIx] == attr)
+      {
+        attrHit = true;
+        break;
+      }
+    }
+
+    if (!attrHit || (cSubP->expiration <= now) || !servicePathMatch(cSubP, servicePath))
+    {
+      continue;
+    }
+
+    for (unsigned int eIx = 0; eIx < cSubP->entityV.size(); ++eIx)
+    {
+      CachedSubEntity* cEnP = cSubP->entityV[eIx];
+
+      if (!cEnP->isPattern || ((cEnP->type != "") && (cEnP->type != entityType)))
+      {
+        continue;
+      }
+
+      if (!cEnP->regexOk)
+      {
+        resolved = false;
+      }
+      else if (regexec(&cEnP->regex, entityId.c_str(), 0, NULL, 0) == 0)
+      {
+        triggeredAdd(cSubP, subs);
+        break;
+      }
+    }
+  }
+
+  return resolved;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheMatch -
+*/
+bool subCacheMatch
+(
+  const std::string&                             tenant,
+  const std::string&                             entityId,
+  const std::string&                             entityType,
+  const std::string&                             attr,
+  const std::string&                             servicePath,
+  std::map<std::string, TriggeredSubscription*>& subs
+)
+{
+  bool resolved = true;
+
+  pthread_mutex_lock(&cacheMutex);
+
+  std::map<std::string, TenantSubCache>::iterator it = cache.find(tenant);
+
+  if (it != cache.end())
+  {
+    resolved = cacheMatch(it->second, entityId, entityType, attr, servicePath, subs);
+  }
+
+  pthread_mutex_unlock(&cacheMutex);
+
+  return resolved;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheBatchLoad -
+*/
+TenantSubCache* subCacheBatchLoad(const std::string& tenant, const std::vector<std::string>& attrV)
+{
+  std::string               condType   = CSUB_CONDITIONS "." CSUB_CONDITIONS_TYPE;
+  std::string               condValue  = CSUB_CONDITIONS "." CSUB_CONDITIONS_VALUE;
+  BSONArrayBuilder          attrsB;
+  DBClientBase*             connection = NULL;
+  auto_ptr<DBClientCursor>  cursor;
+
+  for (unsigned int ix = 0; ix < attrV.size(); ++ix)
+  {
+    attrsB.append(attrV[ix]);
+  }
+
+  BSONObj query = BSON(condType  << ON_CHANGE_CONDITION <<
+                       condValue << BSON("$in" << attrsB.arr()) <<
+                       CSUB_EXPIRATION << BSON("$gt" << (long long) getCurrentTime()));
+
+  LM_T(LmtMongo, ("query() in '%s' collection: '%s'",
+                  getSubscribeContextCollectionName(tenant).c_str(),
+                  query.toString().c_str()));
+
+  TenantSubCache* batchP = new TenantSubCache();
+
+  try
+  {
+    connection = getMongoConnection();
+    cursor     = connection->query(getSubscribeContextCollectionName(tenant).c_str(), query);
+
+    /*
+     * We have observed that in some cases of DB errors (e.g. the database daemon is down) instead of
+     * raising an exception, the query() method sets the cursor to NULL. In this case, we raise the
+     * exception ourselves
+     */
+    if (cursor.get() == NULL)
+    {
+      throw DBException("Null cursor from mongo (details on this is found in the source code)", 0);
+    }
+
+    while (cursor->more())
+    {
+      BSONObj      sub     = cursor->next();
+      BSONElement  idField = sub.getField("_id");
+
+      if (idField.eoo() == true)
+      {
+        LM_E(("Database Error (error retrieving _id field in doc: '%s')", sub.toString().c_str()));
+        continue;
+      }
+
+      CachedSubscription* cSubP = cachedSubscriptionCreate(idField.OID().toString(), sub);
+
+      if (cSubP != NULL)
+      {
+        cacheInsert(*batchP, cSubP);
+      }
+    }
+
+    releaseMongoConnection(connection);
+    LM_I(("Database Operation Successful (%s)", query.toString().c_str()));
+  }
+  catch (const DBException &e)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error ('%s', '%s')", query.toString().c_str(), e.what()));
+    subCacheBatchRelease(batchP);
+    return NULL;
+  }
+  catch (...)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error ('%s', '%s')", query.toString().c_str(), "generic exception"));
+    subCacheBatchRelease(batchP);
+    return NULL;
+  }
+
+  return batchP;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheBatchMatch -
+*/
+bool subCacheBatchMatch
+(
+  TenantSubCache*                                batchP,
+  const std::string&                             entityId,
+  const std::string&                             entityType,
+  const std::string&                             attr,
+  const std::string&                             servicePath,
+  std::map<std::string, TriggeredSubscription*>& subs
+)
+{
+  return cacheMatch(*batchP, entityId, entityType, attr, servicePath, subs);
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheBatchRelease -
+*/
+void subCacheBatchRelease(TenantSubCache* batchP)
+{
+  for (std::map<std::string, CachedSubscription*>::iterator it = batchP->subs.begin(); it != batchP->subs.end(); ++it)
+  {
+    cachedSubscriptionRelease(it->second);
+  }
+
+  delete batchP;
+}
@@ -0,0 +1,176 @@
+#ifndef SRC_LIB_MONGOBACKEND_SUBSCRIPTIONCACHE_H_
+#define SRC_LIB_MONGOBACKEND_SUBSCRIPTIONCACHE_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/client/dbclient.h"
+
+#include "mongoBackend/TriggeredSubscription.h"
+
+using namespace mongo;
+
+
+
+/* ****************************************************************************
+*
+* Subscription cache -
+*
+* In-memory copy of the ONCHANGE subscriptions in the csubs collection (one per tenant),
+* used by addTriggeredSubscriptions() instead of querying csubs (with its $where JavaScript
+* function for patterns) for every updated attribute.
+*
+* Non-pattern subscriptions are indexed by (entity id, condition attribute) and pattern
+* subscriptions are kept apart with their regular expressions already compiled. Patterns
+* that POSIX regular expressions can't evaluate as JavaScript does are left to the database.
+*
+* The cache is kept coherent by the subscribe, update subscription and unsubscribe operations
+* of this broker, so it must not be used when several brokers share the same database
+* (Active-Active configurations) or when csubs is modified out of band.
+*/
+
+
+
+/* ****************************************************************************
+*
+* subCacheInit -
+*/
+extern void subCacheInit(bool active);
+
+
+
+/* ****************************************************************************
+*
+* subCacheActive -
+*/
+extern bool subCacheActive(void);
+
+
+
+/* ****************************************************************************
+*
+* subCacheLoad - load the ONCHANGE subscriptions of a tenant from the csubs collection
+*/
+extern void subCacheLoad(const std::string& tenant);
+
+
+
+/* ****************************************************************************
+*
+* subCacheInsert - insert (or replace) a subscription, given its csubs document
+*
+* The _id of 'sub' is not used (the document used in update() doesn't have it), the
+* subscription id is given in 'subId'. Subscriptions without ONCHANGE conditions are
+* not cached (and a replaced subscription that lost its ONCHANGE conditions is removed).
+*/
+extern void subCacheInsert(const std::string& tenant, const std::string& subId, const BSONObj& sub);
+
+
+
+/* ****************************************************************************
+*
+* subCacheRemove -
+*/
+extern void subCacheRemove(const std::string& tenant, const std::string& subId);
+
+
+
+/* ****************************************************************************
+*
+* subCacheLastNotificationSet -
+*/
+extern void subCacheLastNotificationSet(const std::string& tenant, const std::string& subId, long long lastNotification);
+
+
+
+/* ****************************************************************************
+*
+* subCacheMatch -
+*
+* Adds to 'subs' the (not expired) subscriptions triggered by a change in attribute 'attr'
+* of the entity (entityId, entityType) in 'servicePath' (the same semantics of the csubs
+* query in addTriggeredSubscriptions).
+*
+* Returns false if some candidate subscription has an entity pattern that is not evaluated in
+* memory (JavaScript regular expressions not having the same meaning in POSIX, e.g. using \d or
+* lazy quantifiers): the caller has to query csubs then.
+*/
+extern bool subCacheMatch
+(
+  const std::string&                             tenant,
+  const std::string&                             entityId,
+  const std::string&                             entityType,
+  const std::string&                             attr,
+  const std::string&                             servicePath,
+  std::map<std::string, TriggeredSubscription*>& subs
+);
+
+
+
+/* ****************************************************************************
+*
+* subCacheBatchLoad -
+*
+* When the cache is not in use, the ONCHANGE subscriptions that may be triggered by an update
+* of several entities are read from csubs with one single query (the not expired subscriptions
+* having any of the attributes in 'attrV' in their conditions) into a private set, which is then
+* matched in memory for each updated attribute with subCacheBatchMatch.
+*
+* Returns NULL on database error.
+*/
+struct TenantSubCache;
+
+extern TenantSubCache* subCacheBatchLoad(const std::string& tenant, const std::vector<std::string>& attrV);
+
+
+
+/* ****************************************************************************
+*
+* subCacheBatchMatch - same as subCacheMatch, in a set loaded by subCacheBatchLoad
+*
+* Also returns false if csubs has to be queried for the patterns not evaluated in memory.
+*/
+extern bool subCacheBatchMatch
+(
+  TenantSubCache*                                batchP,
+  const std::string&                             entityId,
+  const std::string&                             entityType,
+  const std::string&                             attr,
+  const std::string&                             servicePath,
+  std::map<std::string, TriggeredSubscription*>& subs
+);
+
+
+
+/* ****************************************************************************
+*
+* subCacheBatchRelease -
+*/
+extern void subCacheBatchRelease(TenantSubCache* batchP);
+
+#endif  // SRC_LIB_MONGOBACKEND_SUBSCRIPTIONCACHE_H_
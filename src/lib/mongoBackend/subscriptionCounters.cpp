@@ -0,0 +1,390 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/globals.h"
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/subscriptionCounters.h"
+
+
+
+/* ****************************************************************************
+*
+* SubCounter -
+*/
+typedef struct SubCounter
+{
+  long long  lastNotification;
+  int        count;
+} SubCounter;
+
+
+
+/* ****************************************************************************
+*
+* CounterMap - counters by tenant and subscription id
+*/
+typedef std::map<std::string, std::map<std::string, SubCounter> > CounterMap;
+
+
+
+/* ****************************************************************************
+*
+* Globals -
+*
+* 'pending' holds the counters accumulated since the last flush, 'flushing' the ones
+* being written by the ongoing flush (still to be taken into account for throttling).
+*/
+static int              flushInterval  = 0;
+static CounterMap       pending;
+static CounterMap       flushing;
+static pthread_mutex_t  countersMutex  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t  flushMutex     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t  threadMutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   threadCond     = PTHREAD_COND_INITIALIZER;
+static bool             threadStop     = false;
+static pthread_t        flushTid;
+
+
+
+/* ****************************************************************************
+*
+* subCountersFlushThread -
+*/
+static void* subCountersFlushThread(void* p)
+{
+  int interval = (int) (long) p;
+
+  pthread_mutex_lock(&threadMutex);
+
+  while (threadStop == false)
+  {
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += interval;
+
+    while ((threadStop == false) && (pthread_cond_timedwait(&threadCond, &threadMutex, &deadline) != ETIMEDOUT))
+    {
+    }
+
+    if (threadStop == true)
+    {
+      break;
+    }
+
+    pthread_mutex_unlock(&threadMutex);
+    subCountersFlush();
+    pthread_mutex_lock(&threadMutex);
+  }
+
+  pthread_mutex_unlock(&threadMutex);
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCountersInit -
+*/
+void subCountersInit(int _flushInterval)
+{
+  flushInterval = _flushInterval;
+  threadStop    = false;
+
+  if (flushInterval <= 0)
+  {
+    return;
+  }
+
+  if (pthread_create(&flushTid, NULL, subCountersFlushThread, (void*) (long) flushInterval) != 0)
+  {
+    LM_E(("Runtime Error (error creating subscription counters flush thread, counters written for each notification)"));
+    flushInterval = 0;
+    return;
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subCountersShutdown -
+*/
+void subCountersShutdown(void)
+{
+  if (flushInterval <= 0)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&threadMutex);
+  threadStop = true;
+  pthread_cond_signal(&threadCond);
+  pthread_mutex_unlock(&threadMutex);
+
+  pthread_join(flushTid, NULL);
+  flushInterval = 0;
+
+  subCountersFlush();
+}
+
+
+
+/* ****************************************************************************
+*
+* subCountersActive -
+*/
+bool subCountersActive(void)
+{
+  return flushInterval > 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* counterAdd - (countersMutex taken)
+*/
+static void counterAdd(CounterMap& counters, const std::string& tenant, const std::string& subId, long long lastNotification, int count)
+{
+  std::map<std::string, SubCounter>&           tenantCounters = counters[tenant];
+  std::map<std::string, SubCounter>::iterator  it             = tenantCounters.find(subId);
+
+  if (it == tenantCounters.end())
+  {
+    SubCounter counter = { lastNotification, count };
+
+    tenantCounters[subId] = counter;
+    return;
+  }
+
+  if (lastNotification > it->second.lastNotification)
+  {
+    it->second.lastNotification = lastNotification;
+  }
+
+  it->second.count += count;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCountersNotified -
+*/
+void subCountersNotified(const std::string& tenant, const std::string& subId, long long lastNotification)
+{
+  pthread_mutex_lock(&countersMutex);
+  counterAdd(pending, tenant, subId, lastNotification, 1);
+  pthread_mutex_unlock(&countersMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* lastNotificationLookup - (countersMutex taken)
+*/
+static long long lastNotificationLookup(CounterMap& counters, const std::string& tenant, const std::string& subId)
+{
+  CounterMap::iterator tIt = counters.find(tenant);
+
+  if (tIt == counters.end())
+  {
+    return -1;
+  }
+
+  std::map<std::string, SubCounter>::iterator sIt = tIt->second.find(subId);
+
+  return (sIt == tIt->second.end())? -1 : sIt->second.lastNotification;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCountersLastNotificationGet -
+*/
+long long subCountersLastNotificationGet(const std::string& tenant, const std::string& subId)
+{
+  long long lastNotification;
+
+  pthread_mutex_lock(&countersMutex);
+
+  lastNotification = lastNotificationLookup(pending, tenant, subId);
+
+  if (lastNotification == -1)
+  {
+    lastNotification = lastNotificationLookup(flushing, tenant, subId);
+  }
+
+  pthread_mutex_unlock(&countersMutex);
+
+  return lastNotification;
+}
+
+
+
+/* ****************************************************************************
+*
+* tenantFlush - one unordered bulk update of the csubs collection of a tenant
+*
+* As count is incremented ($inc), an update that has been applied must not be retried.
+* The bulk is always acknowledged (whatever the -writeConcern), as its result is what
+* tells the updates that failed.
+* The ids of the subscriptions whose update failed (and only those) are returned in
+* 'failedV', to be retried in the next flush:
+*
+* o If the bulk fails with write errors, the updates not listed as failed by the write
+*   result have been applied.
+* o If the bulk fails otherwise (e.g. the connection is lost) and the write result says
+*   nothing was applied, all the updates are retried. If some were applied, there is no
+*   way to know which ones, so none is retried (the counters of this flush may be lost,
+*   but never counted twice).
+*/
+static void tenantFlush(const std::string& tenant, std::map<std::string, SubCounter>& counters, std::vector<std::string>& failedV)
+{
+  DBClientBase*             connection = NULL;
+  std::string               collection = getSubscribeContextCollectionName(tenant);
+  std::vector<std::string>  subIdV;
+  WriteResult               result;
+
+  try
+  {
+    connection = getMongoConnection();
+
+    BulkOperationBuilder bulk = connection->initializeUnorderedBulkOp(collection);
+
+    for (std::map<std::string, SubCounter>::iterator it = counters.begin(); it != counters.end(); ++it)
+    {
+      BSONObj query  = BSON("_id" << OID(it->first));
+      BSONObj update = BSON("$set" << BSON(CSUB_LASTNOTIFICATION << it->second.lastNotification) <<
+                            "$inc" << BSON(CSUB_COUNT << it->second.count));
+
+      bulk.find(query).updateOne(update);
+      subIdV.push_back(it->first);
+    }
+
+    LM_T(LmtMongo, ("bulk update() in '%s' collection: %d subscriptions", collection.c_str(), (int) counters.size()));
+    bulk.execute(&WriteConcern::acknowledged, &result);
+    releaseMongoConnection(connection);
+
+    LM_I(("Database Operation Successful (bulk update of %d subscriptions in '%s')", (int) counters.size(), collection.c_str()));
+    return;
+  }
+  catch (const DBException& e)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (collection: %s - bulk update() - exception: %s)", collection.c_str(), e.what()));
+  }
+  catch (...)
+  {
+    releaseMongoConnection(connection);
+    LM_E(("Database Error (collection: %s - bulk update() - exception: generic)", collection.c_str()));
+  }
+
+  const std::vector<BSONObj>& writeErrors = result.writeErrors();
+
+  if (!writeErrors.empty())
+  {
+    for (unsigned int ix = 0; ix < writeErrors.size(); ++ix)
+    {
+      int opIx = writeErrors[ix].getIntField("index");
+
+      if ((opIx >= 0) && (opIx < (int) subIdV.size()))
+      {
+        failedV.push_back(subIdV[opIx]);
+      }
+    }
+  }
+  else if (result.nMatched() == 0)
+  {
+    failedV = subIdV;
+  }
+  else
+  {
+    LM_W(("Database Error (collection: %s - bulk update() partially applied, the counters of %d subscriptions may be lost)",
+          collection.c_str(), (int) (subIdV.size() - result.nMatched())));
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subCountersFlush -
+*
+* The counters that could not be written are merged back into 'pending', to be
+* retried in the next flush.
+*/
+void subCountersFlush(void)
+{
+  pthread_mutex_lock(&flushMutex);
+
+  pthread_mutex_lock(&countersMutex);
+  flushing.swap(pending);
+  pthread_mutex_unlock(&countersMutex);
+
+  for (CounterMap::iterator tIt = flushing.begin(); tIt != flushing.end(); ++tIt)
+  {
+    std::vector<std::string> failedV;
+
+    tenantFlush(tIt->first, tIt->second, failedV);
+
+    if (failedV.empty())
+    {
+      continue;
+    }
+
+    pthread_mutex_lock(&countersMutex);
+
+    for (unsigned int ix = 0; ix < failedV.size(); ++ix)
+    {
+      SubCounter& counter = tIt->second[failedV[ix]];
+
+      counterAdd(pending, tIt->first, failedV[ix], counter.lastNotification, counter.count);
+    }
+
+    pthread_mutex_unlock(&countersMutex);
+  }
+
+  pthread_mutex_lock(&countersMutex);
+  flushing.clear();
+  pthread_mutex_unlock(&countersMutex);
+
+  pthread_mutex_unlock(&flushMutex);
+}
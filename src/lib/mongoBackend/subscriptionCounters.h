@@ -0,0 +1,92 @@
+#ifndef SRC_LIB_MONGOBACKEND_SUBSCRIPTIONCOUNTERS_H_
+#define SRC_LIB_MONGOBACKEND_SUBSCRIPTIONCOUNTERS_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <string>
+
+
+
+/* ****************************************************************************
+*
+* Subscription counters -
+*
+* The lastNotification and count fields of the csubs documents are not updated for each
+* notification sent, but accumulated in memory and written with one unordered bulk update
+* per tenant every 'flushInterval' seconds (and at exit). Meanwhile, the lastNotification in
+* memory is the one used for throttling.
+*/
+
+
+
+/* ****************************************************************************
+*
+* subCountersInit - start the flush thread (flushInterval 0: counters not in use)
+*/
+extern void subCountersInit(int flushInterval);
+
+
+
+/* ****************************************************************************
+*
+* subCountersShutdown - stop the flush thread, after writing the pending counters
+*
+* Afterwards, subCountersInit can be called again (used by the unit tests).
+*/
+extern void subCountersShutdown(void);
+
+
+
+/* ****************************************************************************
+*
+* subCountersActive -
+*/
+extern bool subCountersActive(void);
+
+
+
+/* ****************************************************************************
+*
+* subCountersNotified - a notification of the subscription has been sent at 'lastNotification'
+*/
+extern void subCountersNotified(const std::string& tenant, const std::string& subId, long long lastNotification);
+
+
+
+/* ****************************************************************************
+*
+* subCountersLastNotificationGet - the lastNotification not yet in csubs (-1 if none)
+*/
+extern long long subCountersLastNotificationGet(const std::string& tenant, const std::string& subId);
+
+
+
+/* ****************************************************************************
+*
+* subCountersFlush - write the accumulated counters to the csubs collections
+*/
+extern void subCountersFlush(void);
+
+#endif  // SRC_LIB_MONGOBACKEND_SUBSCRIPTIONCOUNTERS_H_
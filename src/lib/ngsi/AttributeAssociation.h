@@ -27,6 +27,7 @@
 */
 #include <string>
 
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "ngsi/Request.h"
 
@@ -36,7 +37,7 @@
 *
 * AttributeAssociation -
 */
-typedef struct AttributeAssociation
+typedef struct AttributeAssociation : public ArenaObject
 {
   std::string  source;
   std::string  target;
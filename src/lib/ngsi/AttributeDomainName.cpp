@@ -125,6 +125,20 @@ std::string AttributeDomainName::render(Format format, const std::string& indent
 
 
 
+/* ****************************************************************************
+*
+* AttributeDomainName::render - 
+*/
+void AttributeDomainName::render(std::string& out, Format format, const std::string& indent, bool comma)
+{
+  if (string != "")
+  {
+    valueTagAppend(out, indent, "attributeDomainName", string, format, comma);
+  }
+}
+
+
+
 /* ****************************************************************************
 *
 * AttributeDomainName::c_str - 
@@ -44,6 +44,7 @@ typedef struct AttributeDomainName
   std::string   get(void);
   bool          isEmpty(void);
   std::string   render(Format format, const std::string& indent, bool comma = false);
+  void          render(std::string& out, Format format, const std::string& indent, bool comma = false);
   void          present(const std::string& indent);
   const char*   c_str();
   void          release(void);
@@ -398,7 +398,29 @@ std::string ContextAttribute::render
   bool                omitValue
 )
 {
-  std::string  out                    = "";
+  std::string out;
+
+  render(out, ciP, request, indent, comma, omitValue);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* render - 
+*/
+void ContextAttribute::render
+(
+  std::string&        out,
+  ConnectionInfo*     ciP,
+  RequestType         request,
+  const std::string&  indent,
+  bool                comma,
+  bool                omitValue
+)
+{
+  std::string  indent2                = indent + "  ";
   std::string  xmlTag                 = "contextAttribute";
   std::string  jsonTag                = "attribute";
   bool         valueRendered          = (compoundValueP != NULL) || (omitValue == false) || (request == RtUpdateContextResponse);
@@ -409,12 +431,13 @@ std::string ContextAttribute::render
 
   if ((ciP->uriParam[URI_PARAM_ATTRIBUTE_FORMAT] == "object") && (ciP->outFormat == JSON))
   {
-    return renderAsJsonObject(ciP, request, indent, comma, omitValue);
+    out += renderAsJsonObject(ciP, request, indent, comma, omitValue);
+    return;
   }
 
-  out += startTag(indent, xmlTag, jsonTag, ciP->outFormat, false, false);
-  out += valueTag(indent + "  ", "name",         name,  ciP->outFormat, true);  // attribute.type is always rendered
-  out += valueTag(indent + "  ", "type",         type,  ciP->outFormat, commaAfterType);
+  startTagAppend(out, indent, xmlTag, jsonTag, ciP->outFormat, false, false);
+  valueTagAppend(out, indent2, "name",         name,  ciP->outFormat, true);  // attribute.type is always rendered
+  valueTagAppend(out, indent2, "type",         type,  ciP->outFormat, commaAfterType);
 
   if (compoundValueP == NULL)
   {
@@ -422,15 +445,15 @@ std::string ContextAttribute::render
     {
       if ((valueType == orion::ValueTypeString) || (ciP->apiVersion != "v2"))
       {
-        out += valueTag(indent + "  ", ((ciP->outFormat == XML)? "contextValue" : "value"),
-                        (request != RtUpdateContextResponse)? stringValue : "",
-                        ciP->outFormat, commaAfterContextValue);
+        valueTagAppend(out, indent2, ((ciP->outFormat == XML)? "contextValue" : "value"),
+                       (request != RtUpdateContextResponse)? stringValue : "",
+                       ciP->outFormat, commaAfterContextValue);
       }
     }
     else if (request == RtUpdateContextResponse)
     {
-      out += valueTag(indent + "  ", ((ciP->outFormat == XML)? "contextValue" : "value"),
-                      "", ciP->outFormat, commaAfterContextValue);
+      valueTagAppend(out, indent2, ((ciP->outFormat == XML)? "contextValue" : "value"),
+                     "", ciP->outFormat, commaAfterContextValue);
     }
   }
   else
@@ -442,15 +465,13 @@ std::string ContextAttribute::render
       isCompoundVector = true;
     }
 
-    out += startTag(indent + "  ", "contextValue", "value", ciP->outFormat, isCompoundVector, true, isCompoundVector);
+    startTagAppend(out, indent2, "contextValue", "value", ciP->outFormat, isCompoundVector, true, isCompoundVector);
     out += compoundValueP->render(ciP, ciP->outFormat, indent + "    ");
-    out += endTag(indent + "  ", "contextValue", ciP->outFormat, commaAfterContextValue, isCompoundVector);
+    endTagAppend(out, indent2, "contextValue", ciP->outFormat, commaAfterContextValue, isCompoundVector);
   }
 
-  out += metadataVector.render(ciP->outFormat, indent + "  ", false);
-  out += endTag(indent, xmlTag, ciP->outFormat, comma);
-
-  return out;
+  metadataVector.render(out, ciP->outFormat, indent2, false);
+  endTagAppend(out, indent, xmlTag, ciP->outFormat, comma);
 }
 
 
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "ngsi/MetadataVector.h"
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "orionTypes/OrionValueType.h"
 #include "ngsi/Request.h"
@@ -42,7 +43,7 @@
 *
 * ContextAttribute -
 */
-typedef struct ContextAttribute
+typedef struct ContextAttribute : public ArenaObject
 {
   std::string     name;                    // Mandatory
   std::string     type;                    // Optional
@@ -80,6 +81,7 @@ typedef struct ContextAttribute
   std::string  getLocation();
 
   std::string  render(ConnectionInfo* ciP, RequestType request, const std::string& indent, bool comma = false, bool omitValue = false);
+  void         render(std::string& out, ConnectionInfo* ciP, RequestType request, const std::string& indent, bool comma = false, bool omitValue = false);
   std::string  renderAsJsonObject(ConnectionInfo* ciP, RequestType request, const std::string& indent, bool comma, bool omitValue = false);
   std::string  renderAsNameString(ConnectionInfo* ciP, RequestType request, const std::string& indent, bool comma = false);
   std::string  toJson(bool isLastElement);
@@ -149,7 +149,30 @@ std::string ContextAttributeVector::render
   bool                attrsAsName
 )
 {
-  std::string out      = "";
+  std::string out;
+
+  render(out, ciP, request, indent, comma, omitValue, attrsAsName);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* ContextAttributeVector::render - 
+*/
+void ContextAttributeVector::render
+(
+  std::string&        out,
+  ConnectionInfo*     ciP,
+  RequestType         request,
+  const std::string&  indent,
+  bool                comma,
+  bool                omitValue,
+  bool                attrsAsName
+)
+{
+  std::string indent2  = indent + "  ";
   std::string xmlTag   = "contextAttributeList";
   std::string jsonTag  = "attributes";
 
@@ -161,11 +184,11 @@ std::string ContextAttributeVector::render
            (request == AttributeValueInstance)              ||
            (request == IndividualContextEntityAttributes)))
       {
-        return indent + "<contextAttributeList></contextAttributeList>\n";
+        out += indent + "<contextAttributeList></contextAttributeList>\n";
       }
     }
 
-    return "";
+    return;
   }
 
   //
@@ -200,38 +223,36 @@ std::string ContextAttributeVector::render
     // 2. Now it's time to render
     // Note that in the case of attribute as name, we have to use a vector, thus using
     // attrsAsName variable as value for isVector parameter
-    out += startTag(indent, xmlTag, jsonTag, ciP->outFormat, attrsAsName, true);
+    startTagAppend(out, indent, xmlTag, jsonTag, ciP->outFormat, attrsAsName, true);
     for (unsigned int ix = 0; ix < vec.size(); ++ix)
     {
       if (attrsAsName)
       {
-        out += vec[ix]->renderAsNameString(ciP, request, indent + "  ", ix != vec.size() - 1);
+        out += vec[ix]->renderAsNameString(ciP, request, indent2, ix != vec.size() - 1);
       }
       else
       {
-        out += vec[ix]->render(ciP, request, indent + "  ", ix != vec.size() - 1, omitValue);
+        vec[ix]->render(out, ciP, request, indent2, ix != vec.size() - 1, omitValue);
       }
     }
-    out += endTag(indent, xmlTag, ciP->outFormat, comma, attrsAsName);
+    endTagAppend(out, indent, xmlTag, ciP->outFormat, comma, attrsAsName);
   }
   else
   {
-    out += startTag(indent, xmlTag, jsonTag, ciP->outFormat, true, true);
+    startTagAppend(out, indent, xmlTag, jsonTag, ciP->outFormat, true, true);
     for (unsigned int ix = 0; ix < vec.size(); ++ix)
     {
       if (attrsAsName)
       {
-        out += vec[ix]->renderAsNameString(ciP, request, indent + "  ", ix != vec.size() - 1);
+        out += vec[ix]->renderAsNameString(ciP, request, indent2, ix != vec.size() - 1);
       }
       else
       {
-        out += vec[ix]->render(ciP, request, indent + "  ", ix != vec.size() - 1, omitValue);
+        vec[ix]->render(out, ciP, request, indent2, ix != vec.size() - 1, omitValue);
       }
     }
-    out += endTag(indent, xmlTag, ciP->outFormat, comma, true);
+    endTagAppend(out, indent, xmlTag, ciP->outFormat, comma, true);
   }
-
-  return out;
 }
 
 
@@ -74,6 +74,13 @@ typedef struct ContextAttributeVector
                             bool                comma     = false,
                             bool                omitValue = false,
                             bool                attrsAsName = false);
+  void               render(std::string&        out,
+                            ConnectionInfo*     ciP,
+                            RequestType         requestType,
+                            const std::string&  indent,
+                            bool                comma     = false,
+                            bool                omitValue = false,
+                            bool                attrsAsName = false);
   std::string        toJson(bool isLastElement);
 } ContextAttributeVector;
 
@@ -77,7 +77,29 @@ ContextElement::ContextElement(const std::string& id, const std::string& type, c
 */
 std::string ContextElement::render(ConnectionInfo* ciP, RequestType requestType, const std::string& indent, bool comma, bool omitAttributeValues)
 {
-  std::string  out                              = "";
+  std::string out;
+
+  render(out, ciP, requestType, indent, comma, omitAttributeValues);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* ContextElement::render - 
+*/
+void ContextElement::render
+(
+  std::string&        out,
+  ConnectionInfo*     ciP,
+  RequestType         requestType,
+  const std::string&  indent,
+  bool                comma,
+  bool                omitAttributeValues
+)
+{
+  std::string  indent2                          = indent + "  ";
   std::string  xmlTag                           = "contextElement";
   std::string  jsonTag                          = "contextElement";
   bool         attributeDomainNameRendered      = attributeDomainName.get() != "";
@@ -91,21 +113,19 @@ std::string ContextElement::render(ConnectionInfo* ciP, RequestType requestType,
 
   if (requestType == UpdateContext)
   {
-    out += startTag(indent, xmlTag, jsonTag, ciP->outFormat, false, false);
+    startTagAppend(out, indent, xmlTag, jsonTag, ciP->outFormat, false, false);
   }
   else
   {
-    out += startTag(indent, xmlTag, jsonTag, ciP->outFormat, false, true);
+    startTagAppend(out, indent, xmlTag, jsonTag, ciP->outFormat, false, true);
   }
 
-  out += entityId.render(ciP->outFormat, indent + "  ", commaAfterEntityId, false);
-  out += attributeDomainName.render(ciP->outFormat, indent + "  ", commaAfterAttributeDomainName);
-  out += contextAttributeVector.render(ciP, requestType, indent + "  ", commaAfterContextAttributeVector, omitAttributeValues);
-  out += domainMetadataVector.render(ciP->outFormat, indent + "  ", commaAfterDomainMetadataVector);
+  entityId.render(out, ciP->outFormat, indent2, commaAfterEntityId, false);
+  attributeDomainName.render(out, ciP->outFormat, indent2, commaAfterAttributeDomainName);
+  contextAttributeVector.render(out, ciP, requestType, indent2, commaAfterContextAttributeVector, omitAttributeValues);
+  domainMetadataVector.render(out, ciP->outFormat, indent2, commaAfterDomainMetadataVector);
 
-  out += endTag(indent, xmlTag, ciP->outFormat, comma, false);
-
-  return out;
+  endTagAppend(out, indent, xmlTag, ciP->outFormat, comma, false);
 }
 
 
@@ -28,6 +28,7 @@
 #include <string>
 
 #include "ngsi/Request.h"
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "ngsi/EntityId.h"
 #include "ngsi/AttributeDomainName.h"
@@ -41,7 +42,7 @@
 *
 * ContextElement -
 */
-typedef struct ContextElement
+typedef struct ContextElement : public ArenaObject
 {
   EntityId                 entityId;                // Mandatory
   AttributeDomainName      attributeDomainName;     // Optional
@@ -55,6 +56,7 @@ typedef struct ContextElement
   ContextElement(EntityId* eP);
 
   std::string  render(ConnectionInfo* ciP, RequestType requestType, const std::string& indent, bool comma, bool omitAttributeValues = false);
+  void         render(std::string& out, ConnectionInfo* ciP, RequestType requestType, const std::string& indent, bool comma, bool omitAttributeValues = false);
   void         present(const std::string& indent, int ix);
   void         release(void);
   void         fill(const struct ContextElement& ce);
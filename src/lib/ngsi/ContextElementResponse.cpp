@@ -89,17 +89,37 @@ std::string ContextElementResponse::render
   bool                comma,
   bool                omitAttributeValues
 )
+{
+  std::string out;
+
+  render(out, ciP, requestType, indent, comma, omitAttributeValues);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* ContextElementResponse::render - 
+*/
+void ContextElementResponse::render
+(
+  std::string&        out,
+  ConnectionInfo*     ciP,
+  RequestType         requestType,
+  const std::string&  indent,
+  bool                comma,
+  bool                omitAttributeValues
+)
 {
   std::string xmlTag   = "contextElementResponse";
   std::string jsonTag  = "contextElement";
-  std::string out      = "";
+  std::string indent2  = indent + "  ";
 
-  out += startTag(indent, xmlTag, jsonTag, ciP->outFormat, false, false);
-  out += contextElement.render(ciP, requestType, indent + "  ", true, omitAttributeValues);
-  out += statusCode.render(ciP->outFormat, indent + "  ", false);
-  out += endTag(indent, xmlTag, ciP->outFormat, comma, false);
-
-  return out;
+  startTagAppend(out, indent, xmlTag, jsonTag, ciP->outFormat, false, false);
+  contextElement.render(out, ciP, requestType, indent2, true, omitAttributeValues);
+  statusCode.render(out, ciP->outFormat, indent2, false);
+  endTagAppend(out, indent, xmlTag, ciP->outFormat, comma, false);
 }
 
 
@@ -27,6 +27,7 @@
 */
 #include <string>
 
+#include "common/Arena.h"
 #include "ngsi/ContextElement.h"
 #include "ngsi/StatusCode.h"
 #include "rest/ConnectionInfo.h"
@@ -44,7 +45,7 @@ struct QueryContextResponse;
 *
 * ContextElementResponse -
 */
-typedef struct ContextElementResponse
+typedef struct ContextElementResponse : public ArenaObject
 {
   ContextElement   contextElement;             // Mandatory
   StatusCode       statusCode;                 // Mandatory
@@ -57,6 +58,7 @@ typedef struct ContextElementResponse
   ContextElementResponse(ContextElementResponse* cerP);
 
   std::string  render(ConnectionInfo* ciP, RequestType requestType, const std::string& indent, bool comma = false, bool omitAttributeValues = false);
+  void         render(std::string& out, ConnectionInfo* ciP, RequestType requestType, const std::string& indent, bool comma = false, bool omitAttributeValues = false);
   void         present(const std::string& indent, int ix);
   void         release(void);
 
@@ -47,26 +47,49 @@ std::string ContextElementResponseVector::render
   bool                comma,
   bool                omitAttributeValues
 )
+{
+  std::string out;
+
+  render(out, ciP, requestType, indent, comma, omitAttributeValues);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* ContextElementResponseVector::render -
+*
+* The rendering is appended to 'out', which is passed down to the context element
+* responses, so the whole vector is rendered into a single buffer.
+*/
+void ContextElementResponseVector::render
+(
+  std::string&        out,
+  ConnectionInfo*     ciP,
+  RequestType         requestType,
+  const std::string&  indent,
+  bool                comma,
+  bool                omitAttributeValues
+)
 {
   std::string xmlTag   = "contextResponseList";
   std::string jsonTag  = "contextResponses";
-  std::string out      = "";
+  std::string indent2  = indent + "  ";
 
   if (vec.size() == 0)
   {
-    return "";
+    return;
   }
 
-  out += startTag(indent, xmlTag, jsonTag, ciP->outFormat, true, true);
+  startTagAppend(out, indent, xmlTag, jsonTag, ciP->outFormat, true, true);
 
   for (unsigned int ix = 0; ix < vec.size(); ++ix)
   {
-    out += vec[ix]->render(ciP, requestType, indent + "  ", ix < (vec.size() - 1), omitAttributeValues);
+    vec[ix]->render(out, ciP, requestType, indent2, ix < (vec.size() - 1), omitAttributeValues);
   }
 
-  out += endTag(indent, xmlTag, ciP->outFormat, comma, true);
-
-  return out;
+  endTagAppend(out, indent, xmlTag, ciP->outFormat, comma, true);
 }
 
 
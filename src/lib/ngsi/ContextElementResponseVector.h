@@ -46,6 +46,12 @@ typedef struct ContextElementResponseVector
                                   const std::string&  indent,
                                   bool                comma               = false,
                                   bool                omitAttributeValues = false);
+  void                     render(std::string&        out,
+                                  ConnectionInfo*     ciP,
+                                  RequestType         requestType,
+                                  const std::string&  indent,
+                                  bool                comma               = false,
+                                  bool                omitAttributeValues = false);
 
   void                     present(const std::string& indent);
   void                     push_back(ContextElementResponse* item);
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "ngsi/EntityIdVector.h"
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "ngsi/ProvidingApplication.h"
 #include "ngsi/ContextRegistrationAttributeVector.h"
@@ -40,7 +41,7 @@
 *
 * ContextRegistration - 
 */
-typedef struct ContextRegistration
+typedef struct ContextRegistration : public ArenaObject
 {
   EntityIdVector                      entityIdVector;                        // Optional
   ContextRegistrationAttributeVector  contextRegistrationAttributeVector;    // Optional
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "ngsi/MetadataVector.h"
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "ngsi/Request.h"
 
@@ -38,7 +39,7 @@
 *
 * ContextRegistrationAttribute -
 */
-typedef struct ContextRegistrationAttribute
+typedef struct ContextRegistrationAttribute : public ArenaObject
 {
   std::string     name;            // Mandatory
   std::string     type;            // Optional
@@ -27,6 +27,7 @@
 */
 #include <string>
 
+#include "common/Arena.h"
 #include "ngsi/ContextRegistration.h"
 #include "ngsi/StatusCode.h"
 #include "ngsi/Request.h"
@@ -37,7 +38,7 @@
 *
 * ContextRegistrationResponse -
 */
-typedef struct ContextRegistrationResponse
+typedef struct ContextRegistrationResponse : public ArenaObject
 {
   ContextRegistration   contextRegistration;    // Mandatory
   StatusCode            errorCode;              // Optional
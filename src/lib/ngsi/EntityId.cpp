@@ -100,15 +100,40 @@ std::string EntityId::render
   const std::string&  assocTag
 )
 {
-  std::string  out              = "";
-  char*        isPatternEscaped = htmlEscape(isPattern.c_str());
-  char*        typeEscaped      = htmlEscape(type.c_str());
-  char*        idEscaped        = htmlEscape(id.c_str());
+  std::string out;
 
+  render(out, format, indent, comma, isInVector, assocTag);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* EntityId::render -
+*
+* Same as above, but appending to 'out'. The fields are HTML-escaped directly into 'out'.
+*/
+void EntityId::render
+(
+  std::string&        out,
+  Format              format,
+  const std::string&  indent,
+  bool                comma,
+  bool                isInVector,
+  const std::string&  assocTag
+)
+{
   if (format == XML)
   {
-    out += indent + "<"  + tag + " type=\"" + typeEscaped + "\" isPattern=\"" + isPatternEscaped + "\">\n";
-    out += indent + "  " + "<id>"           + idEscaped   + "</id>"           + "\n";
+    out += indent + "<"  + tag + " type=\"";
+    htmlEscape(out, type.c_str());
+    out += "\" isPattern=\"";
+    htmlEscape(out, isPattern.c_str());
+    out += "\">\n";
+    out += indent + "  <id>";
+    htmlEscape(out, id.c_str());
+    out += "</id>\n";
     out += indent + "</" + tag + ">\n";
   }
   else
@@ -122,9 +147,15 @@ std::string EntityId::render
     }
 
     out += (isInVector? indent + (isAssoc? "\"" + assocTag + "\" : ": "") + "{\n": "");
-    out += indent2 + "\"type\" : \""      + typeEscaped      + "\","  + "\n";
-    out += indent2 + "\"isPattern\" : \"" + isPatternEscaped + "\","  + "\n";
-    out += indent2 + "\"id\" : \""        + idEscaped        + "\"";
+    out += indent2 + "\"type\" : \"";
+    htmlEscape(out, type.c_str());
+    out += "\",\n";
+    out += indent2 + "\"isPattern\" : \"";
+    htmlEscape(out, isPattern.c_str());
+    out += "\",\n";
+    out += indent2 + "\"id\" : \"";
+    htmlEscape(out, id.c_str());
+    out += "\"";
 
     if ((comma == true) && (isInVector == false))
     {
@@ -137,12 +168,6 @@ std::string EntityId::render
       out += (comma == true)? ",\n" : (isInVector? "\n" : "");
     }
   }
-
-  free(typeEscaped);
-  free(idEscaped);
-  free(isPatternEscaped);
-
-  return out;
 }
 
 
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "ngsi/Request.h"
+#include "common/Arena.h"
 #include "common/Format.h"
 
 
@@ -37,7 +38,7 @@
 *
 * EntityId - 
 */
-class EntityId
+class EntityId : public ArenaObject
 {
  public:
   std::string  id;           // Mandatory
@@ -68,6 +69,12 @@ class EntityId
                       bool                comma      = false,
                       bool                isInVector = false,
                       const std::string&  assocTag   = "");
+  void         render(std::string&        out,
+                      Format              format,
+                      const std::string&  indent,
+                      bool                comma      = false,
+                      bool                isInVector = false,
+                      const std::string&  assocTag   = "");
 
   std::string  check(RequestType          requestType,
                      Format               format,
@@ -130,23 +130,39 @@ Metadata::Metadata(const std::string& _name, const std::string& _type, bool _val
 */
 std::string Metadata::render(Format format, const std::string& indent, bool comma)
 {
-  std::string out     = "";
+  std::string out;
+
+  render(out, format, indent, comma);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* Metadata::render -
+*/
+void Metadata::render(std::string& out, Format format, const std::string& indent, bool comma)
+{
   std::string tag     = "contextMetadata";
-  std::string xValue  = stringValue;
+  std::string indent2 = indent + "  ";
 
-  out += startTag(indent, tag, tag, format, false, false);
-  out += valueTag(indent + "  ", "name", name, format, true);
-  out += valueTag(indent + "  ", "type", type, format, true);
+  startTagAppend(out, indent, tag, tag, format, false, false);
+  valueTagAppend(out, indent2, "name", name, format, true);
+  valueTagAppend(out, indent2, "type", type, format, true);
 
   if (type == "Association")
   {
-    xValue = std::string("\n") + association.render(format, indent + "  ", false);
-  }
+    std::string xValue = std::string("\n") + association.render(format, indent2, false);
 
-  out += valueTag(indent + "  ", "value", xValue, format, false, (type == "Association"));
-  out += endTag(indent, tag, format, comma);
+    valueTagAppend(out, indent2, "value", xValue, format, false, true);
+  }
+  else
+  {
+    valueTagAppend(out, indent2, "value", stringValue, format, false, false);
+  }
 
-  return out;
+  endTagAppend(out, indent, tag, format, comma);
 }
 
 
@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "orionTypes/OrionValueType.h"
 #include "ngsi/Request.h"
@@ -57,7 +58,7 @@
 *   from Metadata.
 *    Once we start the next refactoring ...
 */
-typedef struct Metadata
+typedef struct Metadata : public ArenaObject
 {
   std::string  name;         // Mandatory
   std::string  type;         // Optional  
@@ -77,6 +78,7 @@ typedef struct Metadata
   Metadata(const std::string& _name, const std::string& _type, bool _value);
 
   std::string  render(Format format, const std::string& indent, bool comma = false);
+  void         render(std::string& out, Format format, const std::string& indent, bool comma = false);
   std::string  toJson(bool isLastElement);
   void         present(const std::string& metadataType, int ix, const std::string& indent);
   void         release(void);
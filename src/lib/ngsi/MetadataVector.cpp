@@ -64,23 +64,34 @@ void MetadataVector::tagSet(const std::string& tagName)
 */
 std::string MetadataVector::render(Format format, const std::string& indent, bool comma)
 {
-  std::string out     = "";
+  std::string out;
+
+  render(out, format, indent, comma);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* MetadataVector::render -
+*/
+void MetadataVector::render(std::string& out, Format format, const std::string& indent, bool comma)
+{
   std::string jsonTag = "metadatas";
+  std::string indent2 = indent + "  ";
 
   if (vec.size() == 0)
   {
-    return "";
+    return;
   }
 
-  out += startTag(indent, tag, jsonTag, format, true);
+  startTagAppend(out, indent, tag, jsonTag, format, true);
   for (unsigned int ix = 0; ix < vec.size(); ++ix)
   {
-    out += vec[ix]->render(format, indent + "  ", ix != vec.size() - 1);
+    vec[ix]->render(out, format, indent2, ix != vec.size() - 1);
   }
-  out += endTag(indent, tag, format, comma, true);
-
-
-  return out;
+  endTagAppend(out, indent, tag, format, comma, true);
 }
 
 
@@ -46,6 +46,7 @@ typedef struct MetadataVector
 
   void          tagSet(const std::string& tagName);
   std::string   render(Format format, const std::string& indent, bool comma = false);
+  void          render(std::string& out, Format format, const std::string& indent, bool comma = false);
   std::string   toJson(bool isLastElement);
   std::string   check(RequestType requestType,
                       Format format,
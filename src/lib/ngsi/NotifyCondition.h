@@ -27,6 +27,7 @@
 */
 #include <string>
 
+#include "common/Arena.h"
 #include "ngsi/Request.h"
 #include "ngsi/RestrictionString.h"
 #include "ngsi/ConditionValueList.h"
@@ -41,7 +42,7 @@
 *
 * NotifyCondition - 
 */
-typedef struct NotifyCondition
+typedef struct NotifyCondition : public ArenaObject
 {
   std::string               type;            // Mandatory
   ConditionValueList        condValueList;   // Optional
@@ -75,6 +75,8 @@ const char* requestType(RequestType rt)
   case LogRequest:                                  return "Log";
   case VersionRequest:                              return "Version";
   case StatisticsRequest:                           return "Statistics";
+  case MetricsRequest:                              return "Metrics";
+  case IndexesRequest:                              return "Indexes";
   case ExitRequest:                                 return "Exit";
   case LeakRequest:                                 return "Leak";
   case InvalidRequest:                              return "InvalidRequest";
@@ -112,6 +112,9 @@ typedef enum RequestType
   EntityAttributeResponse,
   PostEntity,
 
+  MetricsRequest = 90,
+  IndexesRequest,
+
   InvalidRequest = 100
 } RequestType;
 
@@ -28,6 +28,7 @@
 #include <string>
 
 #include "ngsi/Request.h"
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "orionTypes/areas.h"
 
@@ -58,7 +59,7 @@ using namespace orion;
 *
 * Scope -
 */
-typedef struct Scope
+typedef struct Scope : public ArenaObject
 {
   std::string  type;     // Mandatory
   std::string  value;    // Mandatory
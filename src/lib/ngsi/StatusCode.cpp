@@ -88,7 +88,21 @@ StatusCode::StatusCode(HttpStatusCode _code, const std::string& _details, const
 */
 std::string StatusCode::render(Format format, const std::string& indent, bool comma, bool showTag)
 {
-  std::string  out  = "";
+  std::string out;
+
+  render(out, format, indent, comma, showTag);
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* StatusCode::render -
+*/
+void StatusCode::render(std::string& out, Format format, const std::string& indent, bool comma, bool showTag)
+{
+  std::string  indent2 = indent + "  ";
 
   if (strstr(details.c_str(), "\"") != NULL)
   {
@@ -106,18 +120,16 @@ std::string StatusCode::render(Format format, const std::string& indent, bool co
     details += " - ZERO code set to 500";
   }
 
-  out += startTag(indent, tag, format, showTag);
-  out += valueTag(indent + "  ", "code", code, format, true);
-  out += valueTag(indent + "  ", "reasonPhrase", reasonPhrase, format, details != "");
+  startTagAppend(out, indent, tag, format, showTag);
+  valueTagAppend(out, indent2, "code", code, format, true);
+  valueTagAppend(out, indent2, "reasonPhrase", reasonPhrase, format, details != "");
 
   if (details != "")
   {
-    out += valueTag(indent + "  ", "details", details, format, false);
+    valueTagAppend(out, indent2, "details", details, format, false);
   }
 
-  out += endTag(indent, tag, format, comma);
-
-  return out;
+  endTagAppend(out, indent, tag, format, comma);
 }
 
 
@@ -58,6 +58,7 @@ typedef struct StatusCode
   StatusCode(HttpStatusCode _code, const std::string& _details, const std::string& _tag = "statusCode");
 
   std::string  render(Format format, const std::string& indent, bool comma = false, bool showTag = true);
+  void         render(std::string& out, Format format, const std::string& indent, bool comma = false, bool showTag = true);
   std::string  toJson(bool isLastElement);
   void         fill(HttpStatusCode _code, const std::string& _details = "");
   void         fill(StatusCode* scP);
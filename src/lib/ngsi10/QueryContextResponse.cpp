@@ -124,16 +124,16 @@ std::string QueryContextResponse::render(ConnectionInfo* ciP, RequestType reques
   //
   // 02. render 
   //
-  out += startTag(indent, tag, ciP->outFormat, false);
+  startTagAppend(out, indent, tag, ciP->outFormat, false);
 
   if (contextElementResponseVector.size() > 0)
   {
-    out += contextElementResponseVector.render(ciP, QueryContext, indent + "  ", errorCodeRendered);
+    contextElementResponseVector.render(out, ciP, QueryContext, indent + "  ", errorCodeRendered);
   }
 
   if (errorCodeRendered == true)
   {
-    out += errorCode.render(ciP->outFormat, indent + "  ");
+    errorCode.render(out, ciP->outFormat, indent + "  ");
   }
 
 
@@ -147,10 +147,10 @@ std::string QueryContextResponse::render(ConnectionInfo* ciP, RequestType reques
   {
     LM_W(("Internal Error (Both error-code and response vector empty)"));
     errorCode.fill(SccReceiverInternalError, "Both the error-code structure and the response vector were empty");
-    out += errorCode.render(ciP->outFormat, indent + "  ");
+    errorCode.render(out, ciP->outFormat, indent + "  ");
   }
 
-  out += endTag(indent, tag, ciP->outFormat);
+  endTagAppend(out, indent, tag, ciP->outFormat);
 
   return out;
 }
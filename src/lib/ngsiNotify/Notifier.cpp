@@ -32,7 +32,9 @@
 
 #include "onTimeIntervalThread.h"
 #include "senderThread.h"
+#include "senderThreadPool.h"
 #include "rest/httpRequestSend.h"
+#include "rest/httpRequestAsync.h"
 
 
 /* ****************************************************************************
@@ -44,6 +46,53 @@
 
 
 
+/* ****************************************************************************
+*
+* senderLaunch - 
+*
+* Hand the notification over to the asynchronous (curl_multi) engine, to the sender
+* thread pool or, if none of them is in use, to a new (detached) sender thread
+*/
+static void senderLaunch(SenderThreadParams* params)
+{
+  if (httpRequestAsyncActive())
+  {
+    httpRequestSendAsync(params->ip,
+                         params->port,
+                         params->protocol,
+                         params->verb,
+                         params->tenant,
+                         params->servicePath,
+                         params->xauthToken,
+                         params->resource,
+                         params->content_type,
+                         params->content,
+                         true);
+    delete params;
+    return;
+  }
+
+  if (senderThreadPoolActive())
+  {
+    senderThreadPoolEnqueue(params);
+    return;
+  }
+
+  pthread_t tid;
+  int       ret = pthread_create(&tid, NULL, startSenderThread, params);
+
+  if (ret != 0)
+  {
+    LM_E(("Runtime Error (error creating thread: %d)", ret));
+    delete params;
+    return;
+  }
+
+  pthread_detach(tid);
+}
+
+
+
 /* ****************************************************************************
 *
 * ~Notifier -
@@ -128,7 +177,6 @@ void Notifier::sendNotifyContextRequest(NotifyContextRequest* ncr, const std::st
 
 #ifdef SEND_IN_NEW_THREAD
     /* Send the message (no wait for response), in a separate thread to avoid blocking */
-    pthread_t tid;
     SenderThreadParams* params = new SenderThreadParams();
     params->ip            = host;
     params->port          = port;
@@ -142,13 +190,7 @@ void Notifier::sendNotifyContextRequest(NotifyContextRequest* ncr, const std::st
     params->content       = payload;
     strncpy(params->transactionId, transactionId, sizeof(params->transactionId));
 
-    int ret = pthread_create(&tid, NULL, startSenderThread, params);
-    if (ret != 0)
-    {
-      LM_E(("Runtime Error (error creating thread: %d)", ret));
-      return;
-    }
-    pthread_detach(tid);
+    senderLaunch(params);
 #endif
 }
 
@@ -187,7 +229,6 @@ void Notifier::sendNotifyContextAvailabilityRequest(NotifyContextAvailabilityReq
 #endif
 
 #ifdef SEND_IN_NEW_THREAD
-    pthread_t tid;
     SenderThreadParams* params = new SenderThreadParams();
 
     params->ip           = host;
@@ -199,43 +240,20 @@ void Notifier::sendNotifyContextAvailabilityRequest(NotifyContextAvailabilityReq
     params->content      = payload;
     strncpy(params->transactionId, transactionId, sizeof(params->transactionId));
 
-    int ret = pthread_create(&tid, NULL, startSenderThread, params);
-    if (ret != 0)
-    {
-      LM_E(("Runtime Error (error creating thread: %d)", ret));
-      return;
-    }
-    pthread_detach(tid);
+    senderLaunch(params);
 #endif
 }
 
 /* ****************************************************************************
 *
 * Notifier::createIntervalThread -
+*
+* No thread is created any longer, the condition is added to the schedule served by
+* the ONTIMEINTERVAL scheduler thread (see onTimeIntervalThread.cpp)
 */
 void Notifier::createIntervalThread(const std::string& subId, int interval, const std::string& tenant) {
 
-    /* Create params dynamically. Note that the first action that thread does
-     * if */
-    ThreadData td;
-    td.params = new OnIntervalThreadParams();
-    td.params->tenant = tenant;
-    td.params->subId = subId;
-    td.params->interval = interval;
-    td.params->notifier = this;
-
-    int ret = pthread_create(&(td.tid), NULL, startOnIntervalThread, td.params);
-    if (ret != 0)
-    {
-      LM_E(("Runtime Error (error creating thread: %d)", ret));
-      return;
-    }
-
-    pthread_detach(td.tid);
-
-    /* Put the id in the list associate to subId */
-    LM_T(LmtNotifier, ("created thread: %lu", (unsigned long) td.tid));
-    this->threadsMap.insert(std::pair<std::string,ThreadData>(subId,td));
+    onTimeIntervalSchedule(subId, interval, tenant, this);
 }
 
 /* ****************************************************************************
@@ -244,60 +262,5 @@ void Notifier::createIntervalThread(const std::string& subId, int interval, cons
 */
 void Notifier::destroyOntimeIntervalThreads(const std::string& subId) {
 
-    std::vector<pthread_t> canceled;
-
-    /* Get all the ThreadParams associated to the given subId. Inspired in
-     * http://advancedcppwithexamples.blogspot.com.es/2009/04/example-of-c-multimap.html
-     */
-    std::pair<std::multimap<std::string, ThreadData>::iterator, std::multimap<std::string, ThreadData>::iterator> ii;
-    std::multimap<std::string, ThreadData>::iterator it;
-    ii = this->threadsMap.equal_range(subId);
-    for (it = ii.first; it != ii.second; ++it) {
-
-        ThreadData td = it->second;
-
-        /* Destroy thread */        
-        int ret = pthread_cancel(td.tid);
-        if (ret != 0)
-        {
-          LM_E(("Runtime Error (error canceling thread %lu: %d)", (unsigned long) td.tid, ret));
-          return;
-        }
-
-        /* Note that we do the cancelation in parallel, storing the thread ID. This
-         * vector is processed afterwards to wait for every thread to finish */
-        canceled.push_back(td.tid);
-
-        /* Release memory */
-        delete td.params;
-
-    }
-
-    /* Remove key from the hashmap */
-    threadsMap.erase(subId);
-
-    /* Wait for all the cancelation to end */
-    for (unsigned int ix = 0; ix < canceled.size(); ++ix) {
-        void* res;
-
-        /* pthread_join in blocking */
-        int ret = pthread_join(canceled[ix], &res);
-        if (ret != 0)
-        {
-          LM_E(("Runtime Error (error joining thread %lu: %d)", (unsigned long) canceled[ix], ret));
-          return;
-        }
-
-        if (res == PTHREAD_CANCELED)
-        {
-            LM_T(LmtNotifier, ("canceled thread: %lu", (unsigned long) canceled[ix]));
-        }
-        else
-        {
-          LM_E(("Runtime Error (unexpected error: thread can not be canceled)"));
-          return;
-        }
-    }
-
-    canceled.clear();
+    onTimeIntervalUnschedule(subId);
 }
@@ -26,22 +26,11 @@
 * Author: Fermin Galan
 */
 
-#include <map>
-#include <pthread.h>
-
 #include "ngsi9/NotifyContextAvailabilityRequest.h"
 #include "ngsi10/NotifyContextRequest.h"
 
-#include "ThreadData.h"
-
 class Notifier {
 
-private:
-    /* This field is used to store the list of existing thread, ordered by subscrition ID
-     * (the key in the map). Note that each subscription can include several threads (one
-     * for each ONTIMEINTERVAL notific contition) so we are using a multimap */
-    std::multimap<std::string, ThreadData> threadsMap;
-
 public:
    
     virtual ~Notifier(void);
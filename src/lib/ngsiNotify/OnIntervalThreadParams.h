@@ -33,6 +33,8 @@ typedef struct OnIntervalThreadParams {
     int             interval;
     std::string     tenant;
     Notifier*       notifier;
+    int             dueTime;     // when the next notification is due
+    bool            removed;     // unscheduled, to be freed when reaching the top of the schedule
 } OnIntervalThreadParams;
 
 #endif
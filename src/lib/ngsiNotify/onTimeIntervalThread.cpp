@@ -23,8 +23,12 @@
 * Author: Fermin Galan
 */
 #include <string>
+#include <vector>
+#include <queue>
+#include <map>
 #include <stdio.h>
-#include <unistd.h>      // needed for sleep in Debian 7
+#include <time.h>
+#include <pthread.h>
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
@@ -37,133 +41,435 @@
 #include "ngsi/NotifyCondition.h"
 #include "ngsiNotify/ContextSubscriptionInfo.h"
 #include "ngsiNotify/Notifier.h"
+#include "ngsiNotify/OnIntervalThreadParams.h"
 #include "ngsiNotify/onTimeIntervalThread.h"
 
+
+
 /* ****************************************************************************
 *
-* doNotification -
+* DueLater - order of the schedule, the condition due first on top
+*/
+struct DueLater
+{
+  bool operator()(const OnIntervalThreadParams* a, const OnIntervalThreadParams* b) const
+  {
+    return a->dueTime > b->dueTime;
+  }
+};
+
+
+
+/* ****************************************************************************
+*
+* The schedule -
+*
+* A min-heap of all the ONTIMEINTERVAL conditions, ordered by due time, and an index
+* by subscription id. Unscheduling just marks the conditions as removed (the thread
+* frees them when they reach the top of the heap), so there is no thread to cancel and join.
+*
+* If schedulerThreadOff is set (unit tests), the thread is not started and the due conditions
+* are served by onTimeIntervalRun.
 */
-static void doNotification(OnIntervalThreadParams* params, const std::string& tenant) {
+typedef std::priority_queue<OnIntervalThreadParams*, std::vector<OnIntervalThreadParams*>, DueLater> Schedule;
 
-    std::string err;
+static Schedule                                              schedule;
+static std::multimap<std::string, OnIntervalThreadParams*>  scheduledBySubId;
+static pthread_mutex_t                                       scheduleMutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t                                        scheduleCond    = PTHREAD_COND_INITIALIZER;
+static bool                                                  schedulerActive = false;
+static bool                                                  schedulerThreadOff = false;
 
-    /* Get document from database. Note that although we can include some parameters in
-     * OnIntervalThreadParams coming for the csubs document at thread creation time
-     * from mongoBackend, we always needs that to get fresh lastNotification */
-    ContextSubscriptionInfo csi;
-    if (mongoGetContextSubscriptionInfo(params->subId, &csi, &err, tenant) != SccOk)
+
+
+/* ****************************************************************************
+*
+* DueNotification - a condition that is due, as taken out of the schedule
+*/
+typedef struct DueNotification
+{
+  std::string              subId;
+  std::string              tenant;
+  Notifier*                notifier;
+  ContextSubscriptionInfo  csi;
+} DueNotification;
+
+
+
+/* ****************************************************************************
+*
+* entitySetKey - key of the entities and attributes of a subscription
+*
+* Due subscriptions with the same key (and tenant) are served with one single query
+*/
+static std::string entitySetKey(const std::string& tenant, ContextSubscriptionInfo* csiP)
+{
+  std::string key = tenant;
+
+  for (unsigned int ix = 0; ix < csiP->entityIdVector.size(); ++ix)
+  {
+    EntityId* eP = csiP->entityIdVector[ix];
+
+    key += '\n' + eP->id + '\t' + eP->type + '\t' + eP->isPattern;
+  }
+
+  key += '\n';
+
+  for (unsigned int ix = 0; ix < csiP->attributeList.size(); ++ix)
+  {
+    key += '\t' + csiP->attributeList[ix];
+  }
+
+  return key;
+}
+
+
+
+/* ****************************************************************************
+*
+* notificationDue - is a notification to be sent for this subscription?
+*
+* Only if the subscription is not expired and not throttled (throttling is only checked
+* if used and at least one notification has been sent)
+*/
+static bool notificationDue(const std::string& subId, ContextSubscriptionInfo* csiP, int current)
+{
+  if (current >= csiP->expiration)
+  {
+    LM_T(LmtNotifier, ("notification not sent as subscription %s is expired", subId.c_str()));
+    return false;
+  }
+
+  if ((csiP->throttling >= 0) && (csiP->lastNotification >= 0) && (csiP->lastNotification + csiP->throttling >= current))
+  {
+    LM_T(LmtNotifier, ("notification not sent due to throttling (current time: %d)", current));
+    return false;
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* doNotifications -
+*
+* The csubs documents are read for every due subscription, as we need fresh lastNotification.
+* Then the subscriptions are grouped by entity set and one query per group is done, its
+* result sent to all the subscriptions of the group.
+*
+* All of this is done by the scheduler thread, one subscription after the other, so a slow
+* database delays all the ONTIMEINTERVAL notifications. The notifications themselves are
+* only handed over to Notifier::sendNotifyContextRequest, which sends them from another thread
+* (a new one per notification, the sender pool or the asynchronous engine), so a slow receiver
+* doesn't delay the scheduler, except with a full notification queue and the 'block' policy.
+*/
+static void doNotifications(std::vector<DueNotification*>& dueV)
+{
+  std::string                                            err;
+  int                                                    current = getCurrentTime();
+  std::map<std::string, std::vector<DueNotification*> >  groups;
+
+  for (unsigned int ix = 0; ix < dueV.size(); ++ix)
+  {
+    DueNotification* dP = dueV[ix];
+
+    if (mongoGetContextSubscriptionInfo(dP->subId, &dP->csi, &err, dP->tenant) != SccOk)
     {
       //
       // FIXME P6: mongoGetContextSubscriptionInfo ALWAYS returns SccOk
       //           github issue #575.
-      //           If it didn't we would have a leak right here, as mongoGetContextSubscriptionInfo
-      //           allocates entities and pushes them to 'csi', which is lost leaving this function.
       //
       LM_E(("Database Error (error invoking mongoGetContextSubscriptionInfo"));
-      return;
+      continue;
+    }
+
+    if (notificationDue(dP->subId, &dP->csi, current) == true)
+    {
+      groups[entitySetKey(dP->tenant, &dP->csi)].push_back(dP);
+    }
+  }
+
+  for (std::map<std::string, std::vector<DueNotification*> >::iterator it = groups.begin(); it != groups.end(); ++it)
+  {
+    std::vector<DueNotification*>&  groupV = it->second;
+    DueNotification*                firstP = groupV[0];
+    NotifyContextRequest            ncr;
+
+    // FIXME P7: mongoGetContextElementResponses ALWAYS returns SccOk !!!
+    if (mongoGetContextElementResponses(firstP->csi.entityIdVector, firstP->csi.attributeList, &ncr.contextElementResponseVector, &err, firstP->tenant) != SccOk)
+    {
+      ncr.contextElementResponseVector.release();
+      LM_E(("Database Error (error invoking mongoGetContextElementResponses"));
+      continue;
+    }
+
+    if (ncr.contextElementResponseVector.size() == 0)
+    {
+      LM_T(LmtNotifier, ("notification not sent due to empty context elements response vector)"));
+      continue;
     }
 
-    int current = getCurrentTime();
+    // FIXME: implement a proper originator string
+    ncr.originator.set("localhost");
 
-    /* Send notification (only if subscription is not expired and there is actual data)*/
-    if (current < csi.expiration)
+    for (unsigned int ix = 0; ix < groupV.size(); ++ix)
     {
-        /* Throttling check (only if throttling is used and at least one notification has been sent) */
-        if (csi.throttling < 0 || csi.lastNotification < 0 || csi.lastNotification + csi.throttling <  current)
-        {
-            /* Query database for data */
-            NotifyContextRequest ncr;
-
-            // FIXME P7: mongoGetContextElementResponses ALWAYS returns SccOk !!!
-            if (mongoGetContextElementResponses(csi.entityIdVector, csi.attributeList, &(ncr.contextElementResponseVector), &err, tenant) != SccOk)
-            {
-              csi.release();
-              ncr.contextElementResponseVector.release();
-              LM_E(("Database Error (error invoking mongoGetContextElementResponses"));
-              return;
-            }
-
-            if (ncr.contextElementResponseVector.size() > 0)
-            {
-                /* Complete NotifyContextRequest */
-                // FIXME: implement a proper originator string
-                ncr.originator.set("localhost");
-                ncr.subscriptionId.set(params->subId);
-
-                // Update database fields due to new notification
-                HttpStatusCode s = mongoUpdateCsubNewNotification(params->subId, &err, tenant);
-                if (s == SccOk)
-                {
-                  // FIXME P6: Note that the X-Auth-Token is left blank in this case.
-                  //           In the future, the ONTIMEINTERVAL notification struture *could* include it
-                  //           (and a TRUST_TOKEN to re-negotiate X-Auth-Token if it gets expired)"
-                  //
-                  params->notifier->sendNotifyContextRequest(&ncr, csi.url, tenant, "", csi.format);
-                }
-
-                ncr.contextElementResponseVector.release();
-                csi.release();
-            }
-            else
-            {
-              LM_T(LmtNotifier, ("notification not sent due to empty context elements response vector)"));
-            }
-        }
-        else
-        {
-          LM_T(LmtNotifier, ("notification not sent due to throttling (current time: %d)", current));
-        }
+      DueNotification* dP = groupV[ix];
+
+      // Update database fields due to new notification
+      if (mongoUpdateCsubNewNotification(dP->subId, &err, dP->tenant) == SccOk)
+      {
+        //
+        // The payload is rendered by sendNotifyContextRequest before returning, so
+        // the same NotifyContextRequest is used for all the subscriptions of the group
+        //
+        // FIXME P6: Note that the X-Auth-Token is left blank in this case.
+        //           In the future, the ONTIMEINTERVAL notification struture *could* include it
+        //           (and a TRUST_TOKEN to re-negotiate X-Auth-Token if it gets expired)"
+        //
+        ncr.subscriptionId.set(dP->subId);
+        dP->notifier->sendNotifyContextRequest(&ncr, dP->csi.url, dP->tenant, "", dP->csi.format);
+      }
     }
 
-    //
-    // FIXME P3: mongoGetContextSubscriptionInfo allocates an EntityId and pushes it to csi.
-    //           github issue #576.
-    //           Here that entity is released, but this is running in a separate thread.
-    //           Sometimes, when the broker is killed, this thread is inside the mongoGetContextSubscriptionInfo
-    //           and the new entityId is considered a memory leak by valgrind.
-    //           This is no mempry leak, Everything is under control, but as Jenkins complains about a leak,
-    //           it is annoying.
-    //           What we need to do is to make the broker die in a more controlled manner, making the threads
-    //           exit and wait for them to exit, before the broker itself exits.
-    //           This should be done when receiving an /exit (only valid for DEBUG compilations).
-    //
-    csi.release();
+    ncr.contextElementResponseVector.release();
+  }
+
+  for (unsigned int ix = 0; ix < dueV.size(); ++ix)
+  {
+    dueV[ix]->csi.release();
+    delete dueV[ix];
+  }
+
+  dueV.clear();
 }
 
+
+
 /* ****************************************************************************
 *
-* startOnIntervalThread -
-*
-* About pthread_setcancelstate:
-* The problem with this ontimeinterval subscription thread is that during valgrind tests,
-* the broker if started and killed and if this thread is running, it it sometimes cancelled 
-* with buffers allocated and valgrind will flag this as a memory leak.
-* Using the function pthread_setcancelstate, we can decide when the thread is cancelable and
-* thus avoid to be cancelled with memory allocated.
-* The function 'doNotification' allocates and releases its own memory buffers so if this thread
-* is never cancelled inside 'doNotification', this "false leak" should disappear.
-* 
+* dueTake - take out of the schedule the conditions due at 'now'
+*
+* They are rescheduled for their next interval. To be called with the schedule locked.
 */
-void* startOnIntervalThread(void* p)
+static void dueTake(int now, std::vector<DueNotification*>& dueV)
 {
-  OnIntervalThreadParams* params = (OnIntervalThreadParams*) p;
-  int                     oldState;
+  std::vector<OnIntervalThreadParams*> rescheduleV;
+
+  while (!schedule.empty() && (schedule.top()->dueTime <= now))
+  {
+    OnIntervalThreadParams* topP = schedule.top();
+
+    schedule.pop();
+
+    if (topP->removed == true)
+    {
+      delete topP;
+      continue;
+    }
+
+    DueNotification* dP = new DueNotification();
+
+    dP->subId    = topP->subId;
+    dP->tenant   = topP->tenant;
+    dP->notifier = topP->notifier;
+    dueV.push_back(dP);
 
-  pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, &oldState);
+    topP->dueTime = now + topP->interval;
+    rescheduleV.push_back(topP);
+  }
+
+  for (unsigned int ix = 0; ix < rescheduleV.size(); ++ix)
+  {
+    schedule.push(rescheduleV[ix]);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalScheduler - the thread serving all the ONTIMEINTERVAL conditions
+*
+* Sleeps until the condition on top of the schedule is due (or a new condition is scheduled),
+* takes out of the schedule all the conditions that are due, rescheduling them for their
+* next interval, and does the notifications with the schedule unlocked.
+*/
+static void* onTimeIntervalScheduler(void* p)
+{
+  std::vector<DueNotification*> dueV;
+
+  pthread_mutex_lock(&scheduleMutex);
 
   while (true)
   {
-    strncpy(transactionId, "N/A", sizeof(transactionId));
-    LM_T(LmtNotifier, ("ONTIMEINTERVAL thread wakes up (%s)", params->subId.c_str()));
+    if (schedule.empty())
+    {
+      pthread_cond_wait(&scheduleCond, &scheduleMutex);
+      continue;
+    }
+
+    OnIntervalThreadParams*  topP = schedule.top();
+    int                      now  = time(NULL);
+
+    if (topP->removed == true)
+    {
+      schedule.pop();
+      delete topP;
+      continue;
+    }
 
-    // Do the work (we put this in a function as error conditions would produce an
-    // early interruption of the process)
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &oldState);
-    doNotification(params, params->tenant);
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &oldState);
+    if (topP->dueTime > now)
+    {
+      struct timespec dueTime = { topP->dueTime, 0 };
+
+      pthread_cond_timedwait(&scheduleCond, &scheduleMutex, &dueTime);
+      continue;
+    }
+
+    dueTake(now, dueV);
+    pthread_mutex_unlock(&scheduleMutex);
+
+    strncpy(transactionId, "N/A", sizeof(transactionId));
+    LM_T(LmtNotifier, ("ONTIMEINTERVAL scheduler wakes up (%d conditions due)", (int) dueV.size()));
+    doNotifications(dueV);
 
-    sleep(params->interval);
+    pthread_mutex_lock(&scheduleMutex);
   }
 
   return NULL;
 }
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalSchedule -
+*/
+void onTimeIntervalSchedule(const std::string& subId, int interval, const std::string& tenant, Notifier* notifierP)
+{
+  OnIntervalThreadParams* paramsP = new OnIntervalThreadParams();
+
+  paramsP->subId    = subId;
+  paramsP->interval = (interval > 0)? interval : 1;
+  paramsP->tenant   = tenant;
+  paramsP->notifier = notifierP;
+  paramsP->dueTime  = time(NULL);
+  paramsP->removed  = false;
+
+  pthread_mutex_lock(&scheduleMutex);
+
+  if ((schedulerActive == false) && (schedulerThreadOff == false))
+  {
+    pthread_t  tid;
+    int        ret = pthread_create(&tid, NULL, onTimeIntervalScheduler, NULL);
+
+    if (ret != 0)
+    {
+      pthread_mutex_unlock(&scheduleMutex);
+      delete paramsP;
+      LM_E(("Runtime Error (error creating thread: %d)", ret));
+      return;
+    }
+
+    pthread_detach(tid);
+    schedulerActive = true;
+  }
+
+  schedule.push(paramsP);
+  scheduledBySubId.insert(std::pair<std::string, OnIntervalThreadParams*>(subId, paramsP));
+  pthread_cond_signal(&scheduleCond);
+
+  pthread_mutex_unlock(&scheduleMutex);
+
+  LM_T(LmtNotifier, ("scheduled ONTIMEINTERVAL condition of subscription %s every %d seconds", subId.c_str(), interval));
+}
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalUnschedule -
+*
+* Notifications of the subscription already taken out of the schedule by the scheduler
+* thread (i.e. being sent right now) are not stopped.
+*/
+void onTimeIntervalUnschedule(const std::string& subId)
+{
+  std::multimap<std::string, OnIntervalThreadParams*>::iterator it;
+
+  pthread_mutex_lock(&scheduleMutex);
+
+  std::pair<std::multimap<std::string, OnIntervalThreadParams*>::iterator,
+            std::multimap<std::string, OnIntervalThreadParams*>::iterator> range = scheduledBySubId.equal_range(subId);
+
+  for (it = range.first; it != range.second; ++it)
+  {
+    it->second->removed = true;
+  }
+
+  scheduledBySubId.erase(subId);
+
+  pthread_mutex_unlock(&scheduleMutex);
+
+  LM_T(LmtNotifier, ("unscheduled ONTIMEINTERVAL conditions of subscription %s", subId.c_str()));
+}
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalScheduled -
+*/
+int onTimeIntervalScheduled(const std::string& subId)
+{
+  int scheduled;
+
+  pthread_mutex_lock(&scheduleMutex);
+  scheduled = scheduledBySubId.count(subId);
+  pthread_mutex_unlock(&scheduleMutex);
+
+  return scheduled;
+}
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalRun -
+*/
+void onTimeIntervalRun(int now)
+{
+  std::vector<DueNotification*> dueV;
+
+  pthread_mutex_lock(&scheduleMutex);
+  dueTake(now, dueV);
+  pthread_mutex_unlock(&scheduleMutex);
+
+  doNotifications(dueV);
+}
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalResetForUnitTest -
+*/
+void onTimeIntervalResetForUnitTest(void)
+{
+  pthread_mutex_lock(&scheduleMutex);
+
+  schedulerThreadOff = true;
+
+  while (!schedule.empty())
+  {
+    delete schedule.top();
+    schedule.pop();
+  }
+
+  scheduledBySubId.clear();
+
+  pthread_mutex_unlock(&scheduleMutex);
+}
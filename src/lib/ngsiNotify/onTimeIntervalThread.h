@@ -28,10 +28,55 @@
 
 #include <string>
 
+class Notifier;     // actually defined in Notifier.h
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalSchedule - schedule the notifications of an ONTIMEINTERVAL condition
+*
+* The first notification is due right away, the next ones every 'interval' seconds.
+* All the scheduled conditions are served by one single thread, started on the first call.
+* That thread reads csubs and queries the entities of the due subscriptions one after the
+* other, but it doesn't send the notifications itself (see Notifier::sendNotifyContextRequest).
+*/
+extern void onTimeIntervalSchedule(const std::string& subId, int interval, const std::string& tenant, Notifier* notifierP);
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalUnschedule - remove all the ONTIMEINTERVAL conditions of a subscription
+*/
+extern void onTimeIntervalUnschedule(const std::string& subId);
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalScheduled - number of ONTIMEINTERVAL conditions scheduled for a subscription
+*/
+extern int onTimeIntervalScheduled(const std::string& subId);
+
+
+
 /* ****************************************************************************
 *
-* startOnIntervalThread -
+* onTimeIntervalRun - serve, in the calling thread, the conditions due at 'now'
+*
+* This is what the scheduler thread does when it wakes up.
+*/
+extern void onTimeIntervalRun(int now);
+
+
+
+/* ****************************************************************************
+*
+* onTimeIntervalResetForUnitTest - empty the schedule, and never start the scheduler thread
+*
+* The due conditions are then served by onTimeIntervalRun.
 */
-extern void* startOnIntervalThread(void* params);
+extern void onTimeIntervalResetForUnitTest(void);
 
 #endif
@@ -28,12 +28,10 @@
 
 /* ****************************************************************************
 *
-* startSenderThread -
+* senderThreadSend -
 */
-void* startSenderThread(void* p)
+void senderThreadSend(SenderThreadParams* params)
 {
-    SenderThreadParams* params = (SenderThreadParams*) p;
-
     strncpy(transactionId, params->transactionId, sizeof(transactionId));
 
     LM_T(LmtNotifier, ("sending to: host='%s', port=%d, verb=%s, tenant='%s', service-path: '%s', xauthToken: '%s', path='%s', content-type: %s", 
@@ -62,6 +60,17 @@ void* startSenderThread(void* p)
 
     /* Delete the parameters after using them */
     delete params;
+}
+
+
+
+/* ****************************************************************************
+*
+* startSenderThread -
+*/
+void* startSenderThread(void* p)
+{
+    senderThreadSend((SenderThreadParams*) p);
 
     pthread_exit(NULL);
     return NULL;
@@ -24,6 +24,8 @@
  * Author: Fermín Galán Márquez
  */
 
+#include <time.h>
+
 #include <string>
 
 #define NOTIFICATION_WAIT_MODE false
@@ -41,8 +43,17 @@ typedef struct SenderThreadParams
     std::string    content_type;
     std::string    content;
     char           transactionId[64];
+    struct timespec enqueueTime;     // only used when the sender thread pool is active
 } SenderThreadParams;
 
+
+
+/* ****************************************************************************
+*
+* senderThreadSend - send the notification described by 'params' and free 'params'
+*/
+extern void senderThreadSend(SenderThreadParams* params);
+
 /* ****************************************************************************
 *
 * startSenderThread -
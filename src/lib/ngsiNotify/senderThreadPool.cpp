@@ -0,0 +1,331 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+#include <time.h>
+#include <stdio.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/clockFunctions.h"
+#include "ngsiNotify/senderThread.h"
+#include "ngsiNotify/senderThreadPool.h"
+
+
+
+/* ****************************************************************************
+*
+* Globals -
+*
+* The queue is a plain std::deque protected by a mutex, with one condition variable
+* for 'not empty' (waited by the workers) and another one for 'not full' (waited by
+* producers when the overflow policy is 'block').
+*/
+static bool                             poolActive    = false;
+static bool                             poolStop      = false;
+static std::vector<pthread_t>           workerV;
+static void                             (*sendFunction)(SenderThreadParams*) = senderThreadSend;
+static unsigned int                     queueMax      = 0;
+static QueueOverflow                    queueOverflow = QoDropOldest;
+static std::deque<SenderThreadParams*>  queue;
+static pthread_mutex_t                  queueMutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t                   queueNotEmpty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t                   queueNotFull  = PTHREAD_COND_INITIALIZER;
+
+
+
+/* ****************************************************************************
+*
+* Statistics - protected by queueMutex
+*/
+static unsigned long    queueIn           = 0;
+static unsigned long    queueDrops        = 0;
+static int              queueMaxDepth     = 0;
+static struct timespec  accQueueWaitTime  = { 0, 0 };
+
+
+
+/* ****************************************************************************
+*
+* senderWorker - 
+*/
+static void* senderWorker(void* p)
+{
+  while (true)
+  {
+    struct timespec      now;
+    struct timespec      diffTime;
+    SenderThreadParams*  params;
+
+    pthread_mutex_lock(&queueMutex);
+
+    while (queue.empty() && !poolStop)
+    {
+      pthread_cond_wait(&queueNotEmpty, &queueMutex);
+    }
+
+    if (poolStop)
+    {
+      pthread_mutex_unlock(&queueMutex);
+      break;
+    }
+
+    params = queue.front();
+    queue.pop_front();
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    clock_difftime(&now, &params->enqueueTime, &diffTime);
+    clock_addtime(&accQueueWaitTime, &diffTime);
+
+    pthread_cond_signal(&queueNotFull);
+    pthread_mutex_unlock(&queueMutex);
+
+    sendFunction(params);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolInit - 
+*/
+int senderThreadPoolInit(int workers, int queueSize, QueueOverflow overflow)
+{
+  if (workers <= 0)
+  {
+    LM_I(("Notifications are sent in one thread per notification"));
+    return 0;
+  }
+
+  queueMax      = (queueSize > 0)? queueSize : 1;
+  queueOverflow = overflow;
+  poolStop      = false;
+
+  for (int ix = 0; ix < workers; ++ix)
+  {
+    pthread_t tid;
+    int       ret = pthread_create(&tid, NULL, senderWorker, NULL);
+
+    if (ret != 0)
+    {
+      LM_E(("Runtime Error (error creating notification sender thread: %d)", ret));
+      return -1;
+    }
+
+    workerV.push_back(tid);
+  }
+
+  poolActive = true;
+  LM_I(("Notification sender pool started: %d workers, queue size %d", workers, queueMax));
+
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolShutdown - 
+*
+* The workers finish the notification they are sending (if any) and exit. The notifications
+* still in the queue are not sent. A producer blocked by a full queue returns without
+* queueing its notification.
+*/
+void senderThreadPoolShutdown(void)
+{
+  std::deque<SenderThreadParams*> pending;
+
+  if (!poolActive)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&queueMutex);
+  poolStop = true;
+  pthread_cond_broadcast(&queueNotEmpty);
+  pthread_cond_broadcast(&queueNotFull);
+  pthread_mutex_unlock(&queueMutex);
+
+  for (unsigned int ix = 0; ix < workerV.size(); ++ix)
+  {
+    pthread_join(workerV[ix], NULL);
+  }
+  workerV.clear();
+
+  pthread_mutex_lock(&queueMutex);
+  pending.swap(queue);
+  poolActive = false;
+  pthread_mutex_unlock(&queueMutex);
+
+  for (unsigned int ix = 0; ix < pending.size(); ++ix)
+  {
+    delete pending[ix];
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolSendFunctionSet - 
+*/
+void senderThreadPoolSendFunctionSet(void (*sendFn)(SenderThreadParams* params))
+{
+  sendFunction = (sendFn != NULL)? sendFn : senderThreadSend;
+}
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolActive - 
+*/
+bool senderThreadPoolActive(void)
+{
+  return poolActive;
+}
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolEnqueue - 
+*/
+void senderThreadPoolEnqueue(SenderThreadParams* params)
+{
+  SenderThreadParams* dropped = NULL;
+
+  clock_gettime(CLOCK_REALTIME, &params->enqueueTime);
+
+  pthread_mutex_lock(&queueMutex);
+
+  ++queueIn;
+
+  if (queue.size() >= queueMax)
+  {
+    if (queueOverflow == QoBlock)
+    {
+      while ((queue.size() >= queueMax) && !poolStop)
+      {
+        pthread_cond_wait(&queueNotFull, &queueMutex);
+      }
+
+      if (poolStop)
+      {
+        dropped = params;
+        params  = NULL;
+      }
+    }
+    else if (queueOverflow == QoDropOldest)
+    {
+      dropped = queue.front();
+      queue.pop_front();
+      ++queueDrops;
+    }
+    else
+    {
+      dropped = params;
+      params  = NULL;
+      ++queueDrops;
+    }
+  }
+
+  if (params != NULL)
+  {
+    queue.push_back(params);
+
+    if ((int) queue.size() > queueMaxDepth)
+    {
+      queueMaxDepth = queue.size();
+    }
+
+    pthread_cond_signal(&queueNotEmpty);
+  }
+
+  pthread_mutex_unlock(&queueMutex);
+
+  if (dropped != NULL)
+  {
+    LM_W(("Notification Failure (notification queue full, notification to %s:%d%s dropped)",
+          dropped->ip.c_str(), dropped->port, dropped->resource.c_str()));
+    delete dropped;
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolStatistics - 
+*/
+unsigned long senderThreadPoolStatistics
+(
+  int*            depthP,
+  int*            maxDepthP,
+  unsigned long*  dropsP,
+  char*           waitBuf,
+  int             waitBufLen
+)
+{
+  unsigned long in;
+
+  pthread_mutex_lock(&queueMutex);
+
+  in         = queueIn;
+  *depthP    = queue.size();
+  *maxDepthP = queueMaxDepth;
+  *dropsP    = queueDrops;
+  snprintf(waitBuf, waitBufLen, "%lu.%09d", accQueueWaitTime.tv_sec, (int) accQueueWaitTime.tv_nsec);
+
+  pthread_mutex_unlock(&queueMutex);
+
+  return in;
+}
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolStatisticsReset - 
+*/
+void senderThreadPoolStatisticsReset(void)
+{
+  pthread_mutex_lock(&queueMutex);
+
+  queueIn                   = 0;
+  queueDrops                = 0;
+  queueMaxDepth             = queue.size();
+  accQueueWaitTime.tv_sec   = 0;
+  accQueueWaitTime.tv_nsec  = 0;
+
+  pthread_mutex_unlock(&queueMutex);
+}
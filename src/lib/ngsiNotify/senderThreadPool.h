@@ -0,0 +1,111 @@
+#ifndef SRC_LIB_NGSINOTIFY_SENDERTHREADPOOL_H_
+#define SRC_LIB_NGSINOTIFY_SENDERTHREADPOOL_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <string>
+
+#include "common/QueueOverflow.h"
+#include "ngsiNotify/senderThread.h"
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolInit - 
+*
+* A pool of 'workers' sender threads, fed by a queue of at most 'queueSize' notifications.
+* If 'workers' is 0, the pool is not started and each notification is sent in a
+* thread of its own (see startSenderThread).
+*/
+extern int senderThreadPoolInit(int workers, int queueSize, QueueOverflow overflow);
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolShutdown - 
+*
+* Stops the workers and frees the notifications left in the queue. Afterwards,
+* senderThreadPoolInit can be called again (used by the unit tests).
+*/
+extern void senderThreadPoolShutdown(void);
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolSendFunctionSet - 
+*
+* The function used by the workers to send a notification (and free its params),
+* senderThreadSend unless changed (NULL: back to senderThreadSend). Used by the unit tests.
+*/
+extern void senderThreadPoolSendFunctionSet(void (*sendFn)(SenderThreadParams* params));
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolActive - 
+*/
+extern bool senderThreadPoolActive(void);
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolEnqueue - 
+*
+* The pool takes ownership of 'params' (it is freed after sending or when dropped).
+*/
+extern void senderThreadPoolEnqueue(SenderThreadParams* params);
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolStatistics - 
+*
+* Returns the number of notifications queued since the last reset (current queue size
+* and max queue size, drops and accumulated time in queue are output parameters).
+*/
+extern unsigned long senderThreadPoolStatistics
+(
+  int*            depthP,
+  int*            maxDepthP,
+  unsigned long*  dropsP,
+  char*           waitBuf,
+  int             waitBufLen
+);
+
+
+
+/* ****************************************************************************
+*
+* senderThreadPoolStatisticsReset - 
+*/
+extern void senderThreadPoolStatisticsReset(void);
+
+#endif  // SRC_LIB_NGSINOTIFY_SENDERTHREADPOOL_H_
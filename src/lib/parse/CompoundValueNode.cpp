@@ -44,13 +44,11 @@ namespace orion
 */
 CompoundValueNode::CompoundValueNode()
 {
-  rootP      = NULL;
-  valueType  = orion::ValueTypeUnknown;
-  container  = NULL;
-  level      = 0;
-  name       = "Unset";
-  path       = "Unset";
-  siblingNo  = 0;
+  valueType    = orion::ValueTypeUnknown;
+  container    = NULL;
+  name         = "Unset";
+  numberValue  = 0;
+  siblingNo    = 0;
 
   LM_T(LmtCompoundValue, ("Created EMPTY compound node at %p", this));
 }
@@ -63,13 +61,11 @@ CompoundValueNode::CompoundValueNode()
 */
 CompoundValueNode::CompoundValueNode(orion::ValueType _type)
 {
-  rootP      = this;
-  valueType  = _type;
-  container  = this;
-  level      = 0;
-  name       = "toplevel";
-  path       = "/";
-  siblingNo  = 0;
+  valueType    = _type;
+  container    = this;
+  name         = "toplevel";
+  numberValue  = 0;
+  siblingNo    = 0;
 
   LM_T(LmtCompoundValue, ("Created TOPLEVEL compound node (a %s) at %p", (valueType == orion::ValueTypeVector)? "Vector" : "Object", this));
 }
@@ -83,26 +79,20 @@ CompoundValueNode::CompoundValueNode(orion::ValueType _type)
 CompoundValueNode::CompoundValueNode
 (
   CompoundValueNode*  _container,
-  const std::string&  _path,
   const std::string&  _name,
   const std::string&  _value,
   int                 _siblingNo,
-  orion::ValueType    _type,
-  int                 _level
+  orion::ValueType    _type
 )
 {
   container    = _container;
-  rootP        = container->rootP;
   name         = _name;
   stringValue  = _value;
-  path         = _path;
-  level        = container->level + 1;
   siblingNo    = _siblingNo;
   valueType    = _type;
 
-  LM_T(LmtCompoundValue, ("Created compound node '%s' at level %d, sibling number %d, type %s at %p",
+  LM_T(LmtCompoundValue, ("Created compound node '%s', sibling number %d, type %s at %p",
                           name.c_str(),
-                          level,
                           siblingNo,
                           orion::valueTypeName(valueType),
                           this));
@@ -115,26 +105,20 @@ CompoundValueNode::CompoundValueNode
 CompoundValueNode::CompoundValueNode
 (
   CompoundValueNode*  _container,
-  const std::string&  _path,
   const std::string&  _name,
   const char*         _value,
   int                 _siblingNo,
-  orion::ValueType    _type,
-  int                 _level
+  orion::ValueType    _type
 )
 {
   container    = _container;
-  rootP        = container->rootP;
   name         = _name;
   stringValue  = std::string(_value);
-  path         = _path;
-  level        = container->level + 1;
   siblingNo    = _siblingNo;
   valueType    = _type;
 
-  LM_T(LmtCompoundValue, ("Created compound node '%s' at level %d, sibling number %d, type %s at %p",
+  LM_T(LmtCompoundValue, ("Created compound node '%s', sibling number %d, type %s at %p",
                           name.c_str(),
-                          level,
                           siblingNo,
                           orion::valueTypeName(valueType),
                           this));
@@ -147,26 +131,20 @@ CompoundValueNode::CompoundValueNode
 CompoundValueNode::CompoundValueNode
 (
   CompoundValueNode*  _container,
-  const std::string&  _path,
   const std::string&  _name,
   double              _value,
   int                 _siblingNo,
-  orion::ValueType    _type,
-  int                 _level
+  orion::ValueType    _type
 )
 {
   container    = _container;
-  rootP        = container->rootP;
   name         = _name;
   numberValue  = _value;
-  path         = _path;
-  level        = container->level + 1;
   siblingNo    = _siblingNo;
   valueType    = _type;
 
-  LM_T(LmtCompoundValue, ("Created compound node '%s' at level %d, sibling number %d, type %s at %p",
+  LM_T(LmtCompoundValue, ("Created compound node '%s', sibling number %d, type %s at %p",
                           name.c_str(),
-                          level,
                           siblingNo,
                           orion::valueTypeName(valueType),
                           this));
@@ -179,26 +157,20 @@ CompoundValueNode::CompoundValueNode
 CompoundValueNode::CompoundValueNode
 (
   CompoundValueNode*  _container,
-  const std::string&  _path,
   const std::string&  _name,
   bool                _value,
   int                 _siblingNo,
-  orion::ValueType    _type,
-  int                 _level
+  orion::ValueType    _type
 )
 {
   container  = _container;
-  rootP      = container->rootP;
   name       = _name;
   boolValue  = _value;
-  path       = _path;
-  level      = container->level + 1;
   siblingNo  = _siblingNo;
   valueType  = _type;
 
-  LM_T(LmtCompoundValue, ("Created compound node '%s' at level %d, sibling number %d, type %s at %p",
+  LM_T(LmtCompoundValue, ("Created compound node '%s', sibling number %d, type %s at %p",
                           name.c_str(),
-                          level,
                           siblingNo,
                           orion::valueTypeName(valueType),
                           this));
@@ -212,7 +184,7 @@ CompoundValueNode::CompoundValueNode
 */
 CompoundValueNode::~CompoundValueNode()
 {
-  LM_T(LmtCompoundValue, ("Destroying node %p: name: '%s', path '%s' at %p (with %d children)", this, name.c_str(), path.c_str(), this, childV.size()));
+  LM_T(LmtCompoundValue, ("Destroying node %p: name: '%s' (with %d children)", this, name.c_str(), childV.size()));
 
   for (uint64_t ix = 0; ix < childV.size(); ++ix)
   {
@@ -235,8 +207,6 @@ CompoundValueNode::~CompoundValueNode()
 */
 std::string CompoundValueNode::finish(void)
 {
-  error = "OK";
-
   LM_T(LmtCompoundValue, ("Finishing a compound"));
 
   if (lmTraceIsSet(LmtCompoundValueShow))
@@ -244,9 +214,7 @@ std::string CompoundValueNode::finish(void)
     show("");
   }
 
-  check();  // sets 'error' for toplevel node
-
-  return error;
+  return check();
 }
 
 
@@ -258,19 +226,17 @@ std::string CompoundValueNode::finish(void)
 CompoundValueNode* CompoundValueNode::add(CompoundValueNode* node)
 {
   node->container = this;
-  node->level     = level + 1;
   node->siblingNo = childV.size();
-  node->rootP     = rootP;
 
   if (node->valueType == orion::ValueTypeString)
     LM_T(LmtCompoundValueAdd, ("Adding String '%s', with value '%s' under '%s' (%s)",
                                node->name.c_str(),
                                node->stringValue.c_str(),
-                               node->container->path.c_str(),
+                               path().c_str(),
                                node->container->name.c_str()));
   else
     LM_T(LmtCompoundValueAdd, ("Adding %s '%s' under '%s' (%s)", orion::valueTypeName(node->valueType), node->name.c_str(),
-                               node->container->path.c_str(),
+                               path().c_str(),
                                node->container->name.c_str()));
 
   childV.push_back(node);
@@ -290,18 +256,7 @@ CompoundValueNode* CompoundValueNode::add
   const std::string&      _value
 )
 {
-  std::string newPath = path;
-
-  if (newPath == "/")
-  {
-    newPath += _name;
-  }
-  else
-  {
-    newPath += "/" + _name;
-  }
-
-  CompoundValueNode* node = new CompoundValueNode(this, newPath, _name, _value, childV.size(), _type, level + 1);
+  CompoundValueNode* node = new CompoundValueNode(this, _name, _value, childV.size(), _type);
 
   return add(node);
 }
@@ -319,18 +274,7 @@ CompoundValueNode* CompoundValueNode::add
   const char*             _value
 )
 {
-  std::string newPath = path;
-
-  if (newPath == "/")
-  {
-    newPath += _name;
-  }
-  else
-  {
-    newPath += "/" + _name;
-  }
-
-  CompoundValueNode* node = new CompoundValueNode(this, newPath, _name, _value, childV.size(), _type, level + 1);
+  CompoundValueNode* node = new CompoundValueNode(this, _name, _value, childV.size(), _type);
 
   return add(node);
 }
@@ -348,18 +292,7 @@ CompoundValueNode* CompoundValueNode::add
   double                  _value
 )
 {
-  std::string newPath = path;
-
-  if (newPath == "/")
-  {
-    newPath += _name;
-  }
-  else
-  {
-    newPath += "/" + _name;
-  }
-
-  CompoundValueNode* node = new CompoundValueNode(this, newPath, _name, _value, childV.size(), _type, level + 1);
+  CompoundValueNode* node = new CompoundValueNode(this, _name, _value, childV.size(), _type);
 
   return add(node);
 }
@@ -377,18 +310,7 @@ CompoundValueNode* CompoundValueNode::add
   bool                    _value
 )
 {
-  std::string newPath = path;
-
-  if (newPath == "/")
-  {
-    newPath += _name;
-  }
-  else
-  {
-    newPath += "/" + _name;
-  }
-
-  CompoundValueNode* node = new CompoundValueNode(this, newPath, _name, _value, childV.size(), _type, level + 1);
+  CompoundValueNode* node = new CompoundValueNode(this, _name, _value, childV.size(), _type);
 
   return add(node);
 }
@@ -401,11 +323,11 @@ CompoundValueNode* CompoundValueNode::add
 */
 void CompoundValueNode::shortShow(const std::string& indent)
 {
-  if ((rootP == this) && (valueType == orion::ValueTypeVector))
+  if (isRoot() && (valueType == orion::ValueTypeVector))
   {
     LM_F(("%s%s (toplevel vector)", indent.c_str(), name.c_str()));
   }
-  else if (rootP == this)
+  else if (isRoot())
   {
     LM_F(("%s%s (toplevel object)", indent.c_str(), name.c_str()));
   }
@@ -453,11 +375,11 @@ void CompoundValueNode::show(const std::string& indent)
   }
 
   LM_F(("%scontainer: %s", indent.c_str(), container->name.c_str()));
-  LM_F(("%slevel:     %d", indent.c_str(), level));
+  LM_F(("%slevel:     %d", indent.c_str(), level()));
   LM_F(("%ssibling:   %d", indent.c_str(), siblingNo));
   LM_F(("%stype:      %s", indent.c_str(), orion::valueTypeName(valueType)));
-  LM_F(("%spath:      %s", indent.c_str(), path.c_str()));
-  LM_F(("%srootP:     %s", indent.c_str(), rootP->name.c_str()));
+  LM_F(("%spath:      %s", indent.c_str(), path().c_str()));
+  LM_F(("%sroot:      %s", indent.c_str(), root()->name.c_str()));
 
   if (valueType == orion::ValueTypeString)
   {
@@ -504,26 +426,27 @@ void CompoundValueNode::show(const std::string& indent)
 * A vector must have all its children with the same name.
 * An object cannot have two children with the same name.
 *
-* Encountered errors are saved in the 'error' field of the root of the tree (rootP->error).
+* Returns "OK" or the error encountered in the (sub)tree.
 */
-void CompoundValueNode::check(void)
+std::string CompoundValueNode::check(void)
 {
+  std::string error;
+
   if (valueType == orion::ValueTypeVector)
   {
     if (childV.size() == 0)
     {
-      return;
+      return "OK";
     }
 
     for (uint64_t ix = 1; ix < childV.size(); ++ix)
     {
       if (childV[ix]->name != childV[0]->name)
       {
-        rootP->error =
-          std::string("bad tag-name of vector item: /") + childV[ix]->name + "/, should be /" + childV[0]->name + "/";
+        error = std::string("bad tag-name of vector item: /") + childV[ix]->name + "/, should be /" + childV[0]->name + "/";
 
-        LM_W(("Bad Input (%s)", rootP->error.c_str()));
-        return;
+        LM_W(("Bad Input (%s)", error.c_str()));
+        return error;
       }
     }
   }
@@ -531,7 +454,7 @@ void CompoundValueNode::check(void)
   {
     if (childV.size() == 0)
     {
-      return;
+      return "OK";
     }
 
     for (uint64_t ix = 0; ix < childV.size() - 1; ++ix)
@@ -540,10 +463,10 @@ void CompoundValueNode::check(void)
       {
         if (childV[ix]->name == childV[ix2]->name)
         {
-          rootP->error = std::string("duplicated tag-name: /") + childV[ix]->name + "/ in path: " + path;
-          LM_W(("Bad Input (%s)", rootP->error.c_str()));
+          error = std::string("duplicated tag-name: /") + childV[ix]->name + "/ in path: " + path();
+          LM_W(("Bad Input (%s)", error.c_str()));
 
-          return;
+          return error;
         }
       }
     }
@@ -551,14 +474,22 @@ void CompoundValueNode::check(void)
   else
   {
     // No check made for Strings
-    return;
+    return "OK";
   }
 
-  // 'recursively' call the check method for all children
+  // 'recursively' call the check method for all children (the last error found is the one returned)
+  error = "OK";
   for (uint64_t ix = 0; ix < childV.size(); ++ix)
   {
-    childV[ix]->check();
+    std::string childError = childV[ix]->check();
+
+    if (childError != "OK")
+    {
+      error = childError;
+    }
   }
+
+  return error;
 }
 
 
@@ -618,7 +549,7 @@ std::string CompoundValueNode::render(ConnectionInfo* ciP, Format format, const
   }
   else if (valueType == orion::ValueTypeObject)
   {
-    if (rootP != this)
+    if (!isRoot())
     {
       LM_T(LmtCompoundValueRender, ("I am an Object (%s) and my container is NOT a Vector", name.c_str()));
       out += startTag(indent, tagName, tagName, format, false, true);
@@ -751,7 +682,7 @@ std::string CompoundValueNode::toJson(bool isLastElement)
   }
   else if (valueType == orion::ValueTypeObject)
   {
-    if (rootP != this)
+    if (!isRoot())
     {
       LM_T(LmtCompoundValueRender, ("I am an Object (%s) and my container is NOT a Vector", name.c_str()));
       out += JSON_STR(name) + ":{";
@@ -792,7 +723,7 @@ CompoundValueNode* CompoundValueNode::clone(void)
 
   LM_T(LmtCompoundValue, ("cloning '%s'", name.c_str()));
 
-  if (rootP == this)
+  if (isRoot())
   {
     me = new CompoundValueNode(valueType);
   }
@@ -803,15 +734,15 @@ CompoundValueNode* CompoundValueNode::clone(void)
     case orion::ValueTypeString:
     case orion::ValueTypeObject:
     case orion::ValueTypeVector:
-      me = new CompoundValueNode(container, path, name, stringValue, siblingNo, valueType, level);
+      me = new CompoundValueNode(container, name, stringValue, siblingNo, valueType);
       break;
 
     case orion::ValueTypeNumber:
-      me = new CompoundValueNode(container, path, name, numberValue, siblingNo, valueType, level);
+      me = new CompoundValueNode(container, name, numberValue, siblingNo, valueType);
       break;
 
     case orion::ValueTypeBoolean:
-      me = new CompoundValueNode(container, path, name, boolValue, siblingNo, valueType, level);
+      me = new CompoundValueNode(container, name, boolValue, siblingNo, valueType);
       break;
     default:
       me = NULL;
@@ -887,10 +818,83 @@ const char* CompoundValueNode::cvalue(void)
 
 /* ****************************************************************************
 *
-* cpath -
+* isRoot -
+*/
+bool CompoundValueNode::isRoot(void)
+{
+  return (container == this) || (container == NULL);
+}
+
+
+
+/* ****************************************************************************
+*
+* root -
+*/
+CompoundValueNode* CompoundValueNode::root(void)
+{
+  CompoundValueNode* nodeP = this;
+
+  while (!nodeP->isRoot())
+  {
+    nodeP = nodeP->container;
+  }
+
+  return nodeP;
+}
+
+
+
+/* ****************************************************************************
+*
+* level - the depth of the node, 0 for the root
 */
-const char* CompoundValueNode::cpath(void)
+int CompoundValueNode::level(void)
 {
-  return path.c_str();
+  int                 depth = 0;
+  CompoundValueNode*  nodeP = this;
+
+  while (!nodeP->isRoot())
+  {
+    nodeP = nodeP->container;
+    ++depth;
+  }
+
+  return depth;
+}
+
+
+
+/* ****************************************************************************
+*
+* path - absolute path of the node in the tree
+*
+* The root is "/" and the rest of the nodes add "/name" to the path of their container.
+* Name-less nodes (items of JSON arrays) use their sibling number as name: "[3]".
+*/
+std::string CompoundValueNode::path(void)
+{
+  if (isRoot())
+  {
+    return "/";
+  }
+
+  std::string containerPath = container->path();
+  std::string nodeName      = name;
+
+  if (nodeName == "")
+  {
+    char itemNo[16];
+
+    snprintf(itemNo, sizeof(itemNo), "[%d]", siblingNo);
+    nodeName = itemNo;
+  }
+
+  if (containerPath == "/")
+  {
+    return containerPath + nodeName;
+  }
+
+  return containerPath + "/" + nodeName;
 }
 }
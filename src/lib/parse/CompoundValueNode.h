@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "orionTypes/OrionValueType.h"
 
@@ -49,61 +50,50 @@ namespace orion
 *                Also, when creating the tree from mongo BSON, there will often
 *                be no 'name', just like the case of JSON payload parsing.
 *
-* o valueType    There are the following types of nodes: Vectors, Objects, Strings, Numbers and Bools
-*                The root node is somehow special, but is always either Vector or Object.
-*
 * o stringValue  The value of a String in the tree.
 *
 * o numberValue  The value of a Number in the tree.
 *
 * o boolValue    The value of a Bool in the tree.
+*                numberValue and boolValue share their memory, 'valueType' tells which one is in use.
 *
 * o childV       A vector of the children of a Vector or Object.
 *                Contains pointers to CompoundValueNode.
 *
 * o container    A pointer to the father of the node. The father is the Object/Vector node
-*                that owns this node.
-*
-* o rootP        A pointer to the owner of the entire tree
+*                that owns this node. The root of the tree is its own container.
 *
-* o error        This string is used by the 'check' function to save any errors detected during
-*                the 'check' phase.
-*                FIXME P1: May be removed if the check function is modified.
-*
-* o path         Absolute path of the node in the tree.
-*                Used for error messages, e.g. duplicated tag-name in a struct.
-*
-* o level        The depth or nesting level in which this node lives.
+* o valueType    There are the following types of nodes: Vectors, Objects, Strings, Numbers and Bools
+*                The root node is somehow special, but is always either Vector or Object.
 *
 * o siblingNo:   This field is used for rendering JSON. It tells us whether a comma should
 *                be added after a field (a comma is added unless the sibling number is
 *                equal to the number of siblings (the size of the containers child vector).
+*
+* The root of the tree, the nesting level and the absolute path of a node (used for error
+* messages, e.g. duplicated tag-name in a struct) are not kept in the nodes, but found
+* following the container pointers (root(), level() and path()), as they are seldom needed
+* and a copy of the path in each node made big compound values take many times the size of
+* the payload.
 */
-class CompoundValueNode
+class CompoundValueNode : public ArenaObject
 {
  public:
   // Tree fields
   std::string                        name;
-  orion::ValueType                   valueType;
   std::string                        stringValue;
-  double                             numberValue;
-  bool                               boolValue;
+  union
+  {
+    double                           numberValue;
+    bool                             boolValue;
+  };
   std::vector<CompoundValueNode*>    childV;
-
-
-  // Auxiliar fields for creation of the tree
   CompoundValueNode*                 container;
-  CompoundValueNode*                 rootP;
-  std::string                        error;
+  orion::ValueType                   valueType;
 
   // Needed for JSON rendering
   int                                siblingNo;
 
-  // Fields that may not be necessary
-  // FIXME P4: when finally sure, remove the unnecessary fields
-  std::string                        path;
-  int                                level;
-
   // Constructors/Destructors
   CompoundValueNode();
   explicit CompoundValueNode(orion::ValueType _type);
@@ -111,45 +101,37 @@ class CompoundValueNode
   CompoundValueNode
   (
     CompoundValueNode*  _container,
-    const std::string&  _path,
     const std::string&  _name,
     const std::string&  _value,
     int                 _siblingNo,
-    orion::ValueType    _type,
-    int                 _level = -1
+    orion::ValueType    _type
   );
 
   CompoundValueNode
   (
     CompoundValueNode*  _container,
-    const std::string&  _path,
     const std::string&  _name,
     const char*         _value,
     int                 _siblingNo,
-    orion::ValueType    _type,
-    int                 _level = -1
+    orion::ValueType    _type
   );
 
   CompoundValueNode
   (
     CompoundValueNode*  _container,
-    const std::string&  _path,
     const std::string&  _name,
     double              _value,
     int                 _siblingNo,
-    orion::ValueType    _type,
-    int                 _level = -1
+    orion::ValueType    _type
   );
 
   CompoundValueNode
   (
     CompoundValueNode*  _container,
-    const std::string&  _path,
     const std::string&  _name,
-    bool                 _value,
+    bool                _value,
     int                 _siblingNo,
-    orion::ValueType    _type,
-    int                 _level = -1
+    orion::ValueType    _type
   );
 
   ~CompoundValueNode();
@@ -160,7 +142,7 @@ class CompoundValueNode
   CompoundValueNode*  add(const orion::ValueType _type, const std::string& _name, const char* _value);
   CompoundValueNode*  add(const orion::ValueType _type, const std::string& _name, double _value);
   CompoundValueNode*  add(const orion::ValueType _type, const std::string& _name, bool _value);
-  void                check(void);
+  std::string         check(void);
   std::string         finish(void);
   std::string         render(ConnectionInfo* ciP, Format format, const std::string& indent);
   std::string         toJson(bool isLastElement);
@@ -168,13 +150,17 @@ class CompoundValueNode
   void                shortShow(const std::string& indent);
   void                show(const std::string& indent);
 
+  bool                isRoot(void);
   bool                isVector(void);
   bool                isObject(void);
   bool                isString(void);
 
+  CompoundValueNode*  root(void);
+  int                 level(void);
+  std::string         path(void);
+
   const char*         cname(void);
   const char*         cvalue(void);
-  const char*         cpath(void);
 };
 
 }  // namespace orion
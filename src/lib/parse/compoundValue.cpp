@@ -62,7 +62,7 @@ void compoundValueStart
   ciP->compoundValueRoot = ciP->compoundValueP;
 
   LM_T(LmtCompoundValueContainer, ("Set current container to '%s' (%s)",
-                                   ciP->compoundValueP->path.c_str(),
+                                   ciP->compoundValueP->path().c_str(),
                                    ciP->compoundValueP->name.c_str()));
 
 
@@ -123,7 +123,7 @@ void compoundValueMiddle
     ciP->compoundValueP = ciP->compoundValueP->add(type, name, "");
 
     LM_T(LmtCompoundValueContainer, ("Set current container to '%s' (%s)",
-                                     ciP->compoundValueP->path.c_str(),
+                                     ciP->compoundValueP->path().c_str(),
                                      ciP->compoundValueP->name.c_str()));
   }
   else
@@ -32,6 +32,7 @@
 
 #include "logMsg/logMsg.h"
 
+#include "common/Arena.h"
 #include "common/Format.h"
 #include "parse/CompoundValueNode.h"
 #include "rest/HttpStatusCode.h"
@@ -150,6 +151,7 @@ public:
   unsigned short             port;
   std::string                ip;
   std::string                apiVersion;
+  std::string                transactionId;     // restored in each call to connectionTreat
 
   std::map<std::string, std::string>   uriParam;
 
@@ -158,6 +160,8 @@ public:
   orion::CompoundValueNode*  compoundValueRoot; // Points to the root of the tree
   ::std::vector<orion::CompoundValueNode*> compoundValueVector;
 
+  Arena                      arena;             // Parse and response objects of the request (see serve() in rest.cpp)
+
   // Outgoing
   HttpStatusCode            httpStatusCode;
   std::vector<std::string>  httpHeader;
@@ -38,6 +38,7 @@
 #include "rest/ConnectionInfo.h"
 #include "rest/OrionError.h"
 #include "rest/RestService.h"
+#include "rest/RestServiceTrie.h"
 #include "rest/restReply.h"
 #include "rest/rest.h"
 #include "rest/uriParamNames.h"
@@ -320,9 +321,11 @@ std::string restService(ConnectionInfo* ciP, RestService* serviceV)
 {
   std::vector<std::string>  compV;
   int                       components;
+  int                       ix;
   XmlRequest*               reqP       = NULL;
   JsonRequest*              jsonReqP   = NULL;
   ParseData                 parseData;
+  long long                 start      = statisticsUsecsGet();
 
   if ((ciP->url.length() == 0) || ((ciP->url.length() == 1) && (ciP->url.c_str()[0] == '/')))
   {
@@ -339,38 +342,11 @@ std::string restService(ConnectionInfo* ciP, RestService* serviceV)
 
   components = stringSplit(ciP->url, '/', compV);
 
-  for (unsigned int ix = 0; serviceV[ix].treat != NULL; ++ix)
-  {
-    if ((serviceV[ix].components != 0) && (serviceV[ix].components != components))
-    {
-      continue;
-    }
-
-    if ((ciP->method != serviceV[ix].verb) && (serviceV[ix].verb != "*"))
-    {
-      continue;
-    }
+  ix = restServiceTrieLookup(serviceV, ciP->method, compV);
 
+  if (ix != -1)
+  {
     strncpy(ciP->payloadWord, serviceV[ix].payloadWord.c_str(), sizeof(ciP->payloadWord));
-    bool match = true;
-    for (int compNo = 0; compNo < components; ++compNo)
-    {
-      if (serviceV[ix].compV[compNo] == "*")
-      {
-        continue;
-      }
-
-      if (strcasecmp(serviceV[ix].compV[compNo].c_str(), compV[compNo].c_str()) != 0)
-      {
-        match = false;
-        break;
-      }
-    }
-
-    if (match == false)
-    {
-      continue;
-    }
 
     if ((ciP->payload != NULL) && (ciP->payloadSize != 0) && (ciP->payload[0] != 0) && (serviceV[ix].verb != "*"))
     {
@@ -470,9 +446,30 @@ std::string restService(ConnectionInfo* ciP, RestService* serviceV)
     }
 
     restReply(ciP, response);
+    statisticsLatencyAdd(serviceV[ix].request, statisticsUsecsGet() - start);
+
     return response;
   }
 
+  //
+  // The error reply uses the payload word of the last service with the same verb and
+  // number of components as the request (as the linear scan of serviceV used to leave it)
+  //
+  for (ix = 0; serviceV[ix].treat != NULL; ++ix)
+  {
+    if ((serviceV[ix].components != 0) && (serviceV[ix].components != components))
+    {
+      continue;
+    }
+
+    if ((ciP->method != serviceV[ix].verb) && (serviceV[ix].verb != "*"))
+    {
+      continue;
+    }
+
+    strncpy(ciP->payloadWord, serviceV[ix].payloadWord.c_str(), sizeof(ciP->payloadWord));
+  }
+
   LM_W(("Bad Input (service '%s' not recognized)", ciP->url.c_str()));
   ciP->httpStatusCode = SccBadRequest;
   std::string answer = restErrorReplyGet(ciP, ciP->outFormat, "", ciP->payloadWord, SccBadRequest, std::string("unrecognized request"));
@@ -0,0 +1,345 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "rest/RestService.h"
+#include "rest/RestServiceTrie.h"
+
+
+
+/* ****************************************************************************
+*
+* MAX_COMPONENTS - size of the compV array in RestService
+*/
+#define MAX_COMPONENTS  ((int) (sizeof(((RestService*) NULL)->compV) / sizeof(std::string)))
+
+
+
+/* ****************************************************************************
+*
+* CaseInsensitiveLess - URL components are matched ignoring case
+*/
+struct CaseInsensitiveLess
+{
+  bool operator()(const std::string& a, const std::string& b) const
+  {
+    return strcasecmp(a.c_str(), b.c_str()) < 0;
+  }
+};
+
+
+
+/* ****************************************************************************
+*
+* TrieNode -
+*
+* One node per URL component. The services ending in a node are kept in 'verbs', by verb
+* ("*" included), and only the first service (lowest index in the service vector) for
+* each verb is kept, as the rest of the services for that verb can never be reached.
+*/
+typedef struct TrieNode
+{
+  std::map<std::string, TrieNode*, CaseInsensitiveLess>  children;
+  TrieNode*                                              wildcard;
+  std::map<std::string, int>                             verbs;
+
+  TrieNode(): wildcard(NULL) {}
+} TrieNode;
+
+
+
+/* ****************************************************************************
+*
+* RestServiceTrie -
+*
+* Services with 'components' set to 0 (any number of components, e.g. the 'badRequest'
+* service at the end of the broker service vector) are not put in the trie, but kept in
+* 'anyV' (in service vector order) and checked linearly.
+*/
+typedef struct RestServiceTrie
+{
+  RestService*      serviceV;
+  TrieNode          root;
+  std::vector<int>  anyV;
+  RestServiceTrie*  next;
+} RestServiceTrie;
+
+
+
+/* ****************************************************************************
+*
+* Globals -
+*
+* The tries are kept in a list that is only ever prepended to (under trieMutex), so that
+* lookups can walk it without taking the mutex.
+*/
+static RestServiceTrie* volatile  trieList   = NULL;
+static pthread_mutex_t            trieMutex  = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/* ****************************************************************************
+*
+* trieGet -
+*/
+static RestServiceTrie* trieGet(RestService* serviceV)
+{
+  for (RestServiceTrie* trieP = trieList; trieP != NULL; trieP = trieP->next)
+  {
+    if (trieP->serviceV == serviceV)
+    {
+      return trieP;
+    }
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* trieInsert -
+*/
+static void trieInsert(RestServiceTrie* trieP, int ix)
+{
+  RestService*  serviceP = &trieP->serviceV[ix];
+  TrieNode*     nodeP    = &trieP->root;
+
+  if (serviceP->components == 0)
+  {
+    trieP->anyV.push_back(ix);
+    return;
+  }
+
+  if ((serviceP->components < 0) || (serviceP->components > MAX_COMPONENTS))
+  {
+    LM_E(("Runtime Error (bad number of components (%d) in REST service %d)", serviceP->components, ix));
+    return;
+  }
+
+  for (int compNo = 0; compNo < serviceP->components; ++compNo)
+  {
+    const std::string& comp = serviceP->compV[compNo];
+
+    if (comp == "*")
+    {
+      if (nodeP->wildcard == NULL)
+      {
+        nodeP->wildcard = new TrieNode();
+      }
+
+      nodeP = nodeP->wildcard;
+    }
+    else
+    {
+      TrieNode*& childP = nodeP->children[comp];
+
+      if (childP == NULL)
+      {
+        childP = new TrieNode();
+      }
+
+      nodeP = childP;
+    }
+  }
+
+  if (nodeP->verbs.find(serviceP->verb) == nodeP->verbs.end())
+  {
+    nodeP->verbs[serviceP->verb] = ix;
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* restServiceTrieBuild -
+*/
+void restServiceTrieBuild(RestService* serviceV)
+{
+  pthread_mutex_lock(&trieMutex);
+
+  if (trieGet(serviceV) != NULL)
+  {
+    pthread_mutex_unlock(&trieMutex);
+    return;
+  }
+
+  RestServiceTrie* trieP = new RestServiceTrie();
+  int              ix;
+
+  trieP->serviceV = serviceV;
+
+  for (ix = 0; serviceV[ix].treat != NULL; ++ix)
+  {
+    trieInsert(trieP, ix);
+  }
+
+  LM_T(LmtService, ("REST service trie built for %d services", ix));
+
+  //
+  // The trie must be complete before it is visible to lock-free readers in trieGet
+  //
+  trieP->next = trieList;
+  __sync_synchronize();
+  trieList = trieP;
+
+  pthread_mutex_unlock(&trieMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* nodeLookup - lowest service index reachable from 'nodeP' for the components from 'compNo'
+*/
+static void nodeLookup
+(
+  const TrieNode*                  nodeP,
+  const std::vector<std::string>&  compV,
+  unsigned int                     compNo,
+  const std::string&               verb,
+  int*                             bestP
+)
+{
+  static const std::string anyVerb("*");
+
+  if (compNo == compV.size())
+  {
+    std::map<std::string, int>::const_iterator it;
+
+    if (((it = nodeP->verbs.find(verb)) != nodeP->verbs.end()) && ((*bestP == -1) || (it->second < *bestP)))
+    {
+      *bestP = it->second;
+    }
+
+    if (((it = nodeP->verbs.find(anyVerb)) != nodeP->verbs.end()) && ((*bestP == -1) || (it->second < *bestP)))
+    {
+      *bestP = it->second;
+    }
+
+    return;
+  }
+
+  std::map<std::string, TrieNode*, CaseInsensitiveLess>::const_iterator child = nodeP->children.find(compV[compNo]);
+
+  if (child != nodeP->children.end())
+  {
+    nodeLookup(child->second, compV, compNo + 1, verb, bestP);
+  }
+
+  if (nodeP->wildcard != NULL)
+  {
+    nodeLookup(nodeP->wildcard, compV, compNo + 1, verb, bestP);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* anyMatch - match of a service with any number of components
+*
+* Components beyond the ones given in the service vector are empty strings in the
+* RestService, so they only match empty URL components.
+*/
+static bool anyMatch(RestService* serviceP, const std::string& verb, const std::vector<std::string>& compV)
+{
+  if ((serviceP->verb != verb) && (serviceP->verb != "*"))
+  {
+    return false;
+  }
+
+  if ((int) compV.size() > MAX_COMPONENTS)
+  {
+    return false;
+  }
+
+  for (unsigned int compNo = 0; compNo < compV.size(); ++compNo)
+  {
+    if (serviceP->compV[compNo] == "*")
+    {
+      continue;
+    }
+
+    if (strcasecmp(serviceP->compV[compNo].c_str(), compV[compNo].c_str()) != 0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* restServiceTrieLookup -
+*/
+int restServiceTrieLookup(RestService* serviceV, const std::string& verb, const std::vector<std::string>& compV)
+{
+  RestServiceTrie* trieP = trieGet(serviceV);
+  int              best  = -1;
+
+  if (trieP == NULL)
+  {
+    restServiceTrieBuild(serviceV);
+    trieP = trieGet(serviceV);
+  }
+
+  if (compV.size() != 0)
+  {
+    nodeLookup(&trieP->root, compV, 0, verb, &best);
+  }
+
+  for (unsigned int ix = 0; ix < trieP->anyV.size(); ++ix)
+  {
+    int serviceIx = trieP->anyV[ix];
+
+    if ((best != -1) && (serviceIx > best))
+    {
+      break;
+    }
+
+    if (anyMatch(&serviceV[serviceIx], verb, compV))
+    {
+      best = serviceIx;
+      break;
+    }
+  }
+
+  return best;
+}
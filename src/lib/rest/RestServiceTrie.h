@@ -0,0 +1,59 @@
+#ifndef SRC_LIB_REST_RESTSERVICETRIE_H_
+#define SRC_LIB_REST_RESTSERVICETRIE_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+
+#include "rest/RestService.h"
+
+
+
+/* ****************************************************************************
+*
+* restServiceTrieBuild - compile a service vector into a URL component trie
+*
+* The trie is kept (one per service vector) until the broker exits and building it twice
+* for the same vector is a no-op. restInit builds the trie of the broker service vector
+* before any connection is accepted. Vectors that are not built beforehand (unit tests)
+* are built on their first lookup.
+*/
+extern void restServiceTrieBuild(RestService* serviceV);
+
+
+
+/* ****************************************************************************
+*
+* restServiceTrieLookup - index of the service treating (verb, compV), -1 if none
+*
+* The result is the same as the one of a linear scan of 'serviceV' looking for the first
+* service whose verb is 'verb' or "*", whose number of components is the size of 'compV'
+* or 0 (any number of components) and whose components are all "*" or equal (ignoring
+* case) to the components in 'compV'.
+*/
+extern int restServiceTrieLookup(RestService* serviceV, const std::string& verb, const std::vector<std::string>& compV);
+
+#endif  // SRC_LIB_REST_RESTSERVICETRIE_H_
@@ -0,0 +1,710 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <curl/curl.h>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/QueueOverflow.h"
+#include "rest/httpRequestAsync.h"
+
+
+
+/* ****************************************************************************
+*
+* AsyncRequest - 
+*/
+typedef struct AsyncRequest
+{
+  CURL*                 curl;
+  HttpRequestAsyncDone  done;
+  void*                 data;
+} AsyncRequest;
+
+
+
+/* ****************************************************************************
+*
+* IdleHandle - a finished easy handle kept to be reused for the same destination
+*/
+typedef struct IdleHandle
+{
+  CURL*   curl;
+  time_t  lastUse;
+} IdleHandle;
+
+
+
+/* ****************************************************************************
+*
+* Globals -
+*
+* Requests are put in 'waiting' by httpRequestAsyncAdd and moved to the multi handle by
+* the event loop thread while less than 'maxInFlight' requests are in flight.
+*
+* The multi handle is driven with curl_multi_socket_action: libcurl tells which sockets to
+* watch (asyncSocket) and when to time out (asyncTimer), the loop thread sleeps in
+* epoll_wait on those sockets and on a pipe that is written to every time a new request is
+* added. Unlike select(), there is no limit in the number or value of the descriptors, so
+* thousands of notifications can be in flight.
+*
+* Only the loop thread touches the multi handle, the epoll descriptor, 'timerDeadline' and
+* 'running' (the requests in flight).
+*/
+static bool                       asyncActive   = false;
+static bool                       asyncStop     = false;
+static pthread_t                  asyncTid;
+static CURLM*                     multi         = NULL;
+static int                        epollFd       = -1;
+static long long                  timerDeadline = -1;
+static int                        maxInFlight   = 0;
+static unsigned int               queueMax      = 0;
+static QueueOverflow              queueOverflow = QoDropNewest;
+static int                        inFlight      = 0;
+static std::deque<AsyncRequest*>  waiting;
+static std::set<AsyncRequest*>    running;
+static pthread_mutex_t            asyncMutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t             queueNotFull  = PTHREAD_COND_INITIALIZER;
+static int                        wakeupPipe[2] = { -1, -1 };
+static unsigned long              asyncAdded    = 0;
+static unsigned long              asyncDrops    = 0;
+static int                        idleTimeout   = 0;
+static time_t                     idleExpired   = 0;
+
+// Idle handles per destination, the oldest first (protected by asyncMutex)
+static std::map<std::string, std::deque<IdleHandle> >  idleHandles;
+
+
+
+/* ****************************************************************************
+*
+* WAIT_MAX_MS - maximum time the event loop sleeps in epoll_wait (milliseconds)
+* MAX_EVENTS  - maximum number of events got from each epoll_wait
+*/
+#define WAIT_MAX_MS  1000
+#define MAX_EVENTS   64
+
+
+
+/* ****************************************************************************
+*
+* msNow - milliseconds of the monotonic clock
+*/
+static long long msNow(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncSocket - libcurl's socket callback: start, change or stop watching a socket
+*/
+static int asyncSocket(CURL* easy, curl_socket_t s, int what, void* userp, void* socketp)
+{
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = s;
+
+  if (what == CURL_POLL_REMOVE)
+  {
+    // The socket may be closed already (and so removed from the epoll set), no error check
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, s, &ev);
+    return 0;
+  }
+
+  ev.events = ((what & CURL_POLL_IN)? EPOLLIN : 0) | ((what & CURL_POLL_OUT)? EPOLLOUT : 0);
+
+  if ((epoll_ctl(epollFd, EPOLL_CTL_MOD, s, &ev) != 0) && (errno == ENOENT))
+  {
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, s, &ev) != 0)
+    {
+      LM_E(("Runtime Error (epoll_ctl: %s)", strerror(errno)));
+    }
+  }
+
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncTimer - libcurl's timer callback: -1 means no timeout
+*/
+static int asyncTimer(CURLM* multiP, long timeoutMs, void* userp)
+{
+  timerDeadline = (timeoutMs < 0)? -1 : msNow() + timeoutMs;
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncWait - wait for activity in the sockets of the multi handle or in the wakeup pipe
+*
+* Sockets with activity are handed over to libcurl, as well as the expiration of its timer.
+*/
+static void asyncWait(void)
+{
+  struct epoll_event  events[MAX_EVENTS];
+  long long           timeout = WAIT_MAX_MS;
+  int                 stillRunning;
+  int                 n;
+
+  if (timerDeadline != -1)
+  {
+    timeout = timerDeadline - msNow();
+
+    if (timeout < 0)
+    {
+      timeout = 0;
+    }
+    else if (timeout > WAIT_MAX_MS)
+    {
+      timeout = WAIT_MAX_MS;
+    }
+  }
+
+  n = epoll_wait(epollFd, events, MAX_EVENTS, (int) timeout);
+
+  for (int ix = 0; ix < n; ++ix)
+  {
+    int fd = events[ix].data.fd;
+
+    if (fd == wakeupPipe[0])
+    {
+      char buf[64];
+
+      while (read(wakeupPipe[0], buf, sizeof(buf)) > 0)
+      {
+        ;
+      }
+
+      continue;
+    }
+
+    int mask = 0;
+
+    mask |= (events[ix].events & EPOLLIN)?  CURL_CSELECT_IN  : 0;
+    mask |= (events[ix].events & EPOLLOUT)? CURL_CSELECT_OUT : 0;
+    mask |= (events[ix].events & (EPOLLERR | EPOLLHUP))? CURL_CSELECT_ERR : 0;
+
+    curl_multi_socket_action(multi, fd, mask, &stillRunning);
+  }
+
+  if ((timerDeadline != -1) && (msNow() >= timerDeadline))
+  {
+    timerDeadline = -1;
+    curl_multi_socket_action(multi, CURL_SOCKET_TIMEOUT, 0, &stillRunning);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncDone - finish the requests libcurl is done with
+*/
+static void asyncDone(void)
+{
+  CURLMsg*  msg;
+  int       left;
+
+  while ((msg = curl_multi_info_read(multi, &left)) != NULL)
+  {
+    if (msg->msg != CURLMSG_DONE)
+    {
+      continue;
+    }
+
+    CURL*          curl = msg->easy_handle;
+    CURLcode       res  = msg->data.result;
+    AsyncRequest*  reqP = NULL;
+
+    curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**) &reqP);
+    curl_multi_remove_handle(multi, curl);
+    running.erase(reqP);
+
+    pthread_mutex_lock(&asyncMutex);
+    --inFlight;
+    pthread_mutex_unlock(&asyncMutex);
+
+    reqP->done(curl, res, reqP->data);
+    delete reqP;
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncIdleExpire - cleanup the idle handles not used during idleTimeout seconds
+*
+* Done by the loop thread, at most once per second. asyncMutex must be taken by the caller.
+*/
+static void asyncIdleExpire(void)
+{
+  time_t now = time(NULL);
+
+  if ((idleTimeout == 0) || (now == idleExpired))
+  {
+    return;
+  }
+
+  idleExpired = now;
+
+  std::map<std::string, std::deque<IdleHandle> >::iterator it = idleHandles.begin();
+
+  while (it != idleHandles.end())
+  {
+    std::deque<IdleHandle>& idle = it->second;
+
+    while ((idle.size() > 0) && (now - idle.front().lastUse > idleTimeout))
+    {
+      curl_easy_cleanup(idle.front().curl);
+      idle.pop_front();
+    }
+
+    if (idle.size() == 0)
+    {
+      idleHandles.erase(it++);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncIdleCleanup - cleanup all the idle handles (asyncMutex taken by the caller)
+*/
+static void asyncIdleCleanup(void)
+{
+  std::map<std::string, std::deque<IdleHandle> >::iterator it;
+
+  for (it = idleHandles.begin(); it != idleHandles.end(); ++it)
+  {
+    for (unsigned int ix = 0; ix < it->second.size(); ++ix)
+    {
+      curl_easy_cleanup(it->second[ix].curl);
+    }
+  }
+
+  idleHandles.clear();
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncLoop - 
+*/
+static void* asyncLoop(void* p)
+{
+  while (true)
+  {
+    //
+    // 1. Start waiting requests, as long as there is room for them
+    //    (adding a handle sets the timer of libcurl, to start the request right away)
+    //
+    pthread_mutex_lock(&asyncMutex);
+
+    if (asyncStop)
+    {
+      pthread_mutex_unlock(&asyncMutex);
+      break;
+    }
+
+    while ((waiting.size() > 0) && (inFlight < maxInFlight))
+    {
+      AsyncRequest* reqP = waiting.front();
+
+      waiting.pop_front();
+      curl_easy_setopt(reqP->curl, CURLOPT_PRIVATE, (char*) reqP);
+      curl_multi_add_handle(multi, reqP->curl);
+      running.insert(reqP);
+      ++inFlight;
+
+      pthread_cond_signal(&queueNotFull);
+    }
+
+    asyncIdleExpire();
+
+    pthread_mutex_unlock(&asyncMutex);
+
+
+    //
+    // 2. Sleep until there is something to do, and let libcurl do it
+    //
+    asyncWait();
+
+
+    //
+    // 3. Requests done
+    //
+    asyncDone();
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncInit - 
+*/
+int httpRequestAsyncInit(int _maxInFlight, int queueSize, QueueOverflow overflow, int _idleTimeout)
+{
+  if (_maxInFlight <= 0)
+  {
+    return 0;
+  }
+
+  maxInFlight   = _maxInFlight;
+  queueMax      = (queueSize < 1)? 1 : queueSize;
+  queueOverflow = overflow;
+  idleTimeout   = (_idleTimeout < 0)? 0 : _idleTimeout;
+  asyncStop     = false;
+  timerDeadline = -1;
+
+  if (pipe(wakeupPipe) != 0)
+  {
+    LM_E(("Runtime Error (pipe: %s)", strerror(errno)));
+    return -1;
+  }
+
+  fcntl(wakeupPipe[0], F_SETFL, fcntl(wakeupPipe[0], F_GETFL) | O_NONBLOCK);
+  fcntl(wakeupPipe[1], F_SETFL, fcntl(wakeupPipe[1], F_GETFL) | O_NONBLOCK);
+
+  if ((epollFd = epoll_create(MAX_EVENTS)) == -1)
+  {
+    LM_E(("Runtime Error (epoll_create: %s)", strerror(errno)));
+    return -1;
+  }
+
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events  = EPOLLIN;
+  ev.data.fd = wakeupPipe[0];
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupPipe[0], &ev);
+
+  if ((multi = curl_multi_init()) == NULL)
+  {
+    LM_E(("Runtime Error (curl_multi_init)"));
+    return -1;
+  }
+
+  curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, asyncSocket);
+  curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION,  asyncTimer);
+
+  int ret = pthread_create(&asyncTid, NULL, asyncLoop, NULL);
+
+  if (ret != 0)
+  {
+    LM_E(("Runtime Error (error creating notification event loop thread: %d)", ret));
+    return -1;
+  }
+
+  asyncActive = true;
+
+  LM_I(("Asynchronous notifications: at most %d in flight, %d waiting", maxInFlight, queueMax));
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncShutdown - 
+*/
+void httpRequestAsyncShutdown(void)
+{
+  if (!asyncActive)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&asyncMutex);
+  asyncStop = true;
+  pthread_cond_broadcast(&queueNotFull);
+  pthread_mutex_unlock(&asyncMutex);
+
+  if (write(wakeupPipe[1], "x", 1) == -1)
+  {
+    LM_T(LmtNotifier, ("wakeup pipe full"));
+  }
+
+  pthread_join(asyncTid, NULL);
+
+  //
+  // The loop thread is gone, what is left is finished by this thread
+  //
+  asyncDone();
+
+  for (std::set<AsyncRequest*>::iterator it = running.begin(); it != running.end(); ++it)
+  {
+    curl_multi_remove_handle(multi, (*it)->curl);
+    (*it)->done((*it)->curl, CURLE_ABORTED_BY_CALLBACK, (*it)->data);
+    delete *it;
+  }
+  running.clear();
+
+  pthread_mutex_lock(&asyncMutex);
+
+  std::deque<AsyncRequest*> left;
+
+  left.swap(waiting);
+  inFlight    = 0;
+  asyncActive = false;
+
+  pthread_mutex_unlock(&asyncMutex);
+
+  for (unsigned int ix = 0; ix < left.size(); ++ix)
+  {
+    left[ix]->done(left[ix]->curl, CURLE_FAILED_INIT, left[ix]->data);
+    delete left[ix];
+  }
+
+  // Including the handles given back by the 'done' callbacks above
+  pthread_mutex_lock(&asyncMutex);
+  asyncIdleCleanup();
+  pthread_mutex_unlock(&asyncMutex);
+
+  curl_multi_cleanup(multi);
+  multi = NULL;
+
+  close(epollFd);
+  close(wakeupPipe[0]);
+  close(wakeupPipe[1]);
+  epollFd       = -1;
+  wakeupPipe[0] = -1;
+  wakeupPipe[1] = -1;
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncActive - 
+*/
+bool httpRequestAsyncActive(void)
+{
+  return asyncActive;
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncAdd - 
+*/
+void httpRequestAsyncAdd(CURL* curl, HttpRequestAsyncDone done, void* data)
+{
+  AsyncRequest* dropped = NULL;
+  AsyncRequest* reqP    = new AsyncRequest;
+
+  reqP->curl = curl;
+  reqP->done = done;
+  reqP->data = data;
+
+  pthread_mutex_lock(&asyncMutex);
+
+  ++asyncAdded;
+
+  if (queueOverflow == QoBlock)
+  {
+    while ((waiting.size() >= queueMax) && !asyncStop)
+    {
+      pthread_cond_wait(&queueNotFull, &asyncMutex);
+    }
+
+    if (asyncStop)
+    {
+      dropped = reqP;
+      reqP    = NULL;
+    }
+  }
+  else if (waiting.size() >= queueMax)
+  {
+    if (queueOverflow == QoDropOldest)
+    {
+      dropped = waiting.front();
+      waiting.pop_front();
+    }
+    else
+    {
+      dropped = reqP;
+      reqP    = NULL;
+    }
+
+    ++asyncDrops;
+  }
+
+  if (reqP != NULL)
+  {
+    waiting.push_back(reqP);
+  }
+
+  pthread_mutex_unlock(&asyncMutex);
+
+  if (dropped != NULL)
+  {
+    LM_W(("Notification discarded (%d notifications waiting to be sent)", queueMax));
+    dropped->done(dropped->curl, CURLE_FAILED_INIT, dropped->data);
+    delete dropped;
+  }
+
+  if (reqP == NULL)
+  {
+    return;
+  }
+
+  // Wake up the event loop. If the pipe is full, the loop is awake anyway
+  if (write(wakeupPipe[1], "x", 1) == -1)
+  {
+    LM_T(LmtNotifier, ("wakeup pipe full"));
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncHandleGet - 
+*/
+CURL* httpRequestAsyncHandleGet(const std::string& key)
+{
+  CURL* curl = NULL;
+
+  pthread_mutex_lock(&asyncMutex);
+
+  std::map<std::string, std::deque<IdleHandle> >::iterator it = idleHandles.find(key);
+
+  if ((it != idleHandles.end()) && (it->second.size() > 0))
+  {
+    // The most recently used handle is the one most likely to have its connection alive
+    curl = it->second.back().curl;
+    it->second.pop_back();
+  }
+
+  pthread_mutex_unlock(&asyncMutex);
+
+  return (curl != NULL)? curl : curl_easy_init();
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncHandleRelease - 
+*/
+void httpRequestAsyncHandleRelease(const std::string& key, CURL* curl)
+{
+  curl_easy_reset(curl);
+
+  pthread_mutex_lock(&asyncMutex);
+
+  std::deque<IdleHandle>& idle = idleHandles[key];
+
+  if (asyncActive && !asyncStop && (idle.size() < (unsigned int) maxInFlight))
+  {
+    IdleHandle ih;
+
+    ih.curl    = curl;
+    ih.lastUse = time(NULL);
+    idle.push_back(ih);
+    curl = NULL;
+  }
+  else if (idle.size() == 0)
+  {
+    idleHandles.erase(key);
+  }
+
+  pthread_mutex_unlock(&asyncMutex);
+
+  if (curl != NULL)
+  {
+    curl_easy_cleanup(curl);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncStatistics - 
+*/
+unsigned long httpRequestAsyncStatistics(int* inFlightP, unsigned long* dropsP)
+{
+  pthread_mutex_lock(&asyncMutex);
+
+  unsigned long added = asyncAdded;
+
+  *inFlightP = inFlight;
+  *dropsP    = asyncDrops;
+
+  pthread_mutex_unlock(&asyncMutex);
+
+  return added;
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncStatisticsReset - 
+*/
+void httpRequestAsyncStatisticsReset(void)
+{
+  pthread_mutex_lock(&asyncMutex);
+  asyncAdded = 0;
+  asyncDrops = 0;
+  pthread_mutex_unlock(&asyncMutex);
+}
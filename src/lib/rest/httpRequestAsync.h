@@ -0,0 +1,134 @@
+#ifndef SRC_LIB_REST_HTTPREQUESTASYNC_H_
+#define SRC_LIB_REST_HTTPREQUESTASYNC_H_
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <curl/curl.h>
+
+#include <string>
+
+#include "common/QueueOverflow.h"
+
+
+
+/* ****************************************************************************
+*
+* HttpRequestAsyncDone - called (from the event loop thread) when a request is done
+*
+* 'res' is CURLE_OK if the request was sent and its response received. The callback
+* owns 'curl' (it must curl_easy_cleanup it or give it back with httpRequestAsyncHandleRelease)
+* and whatever 'data' points to.
+*/
+typedef void (*HttpRequestAsyncDone)(CURL* curl, CURLcode res, void* data);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncInit - 
+*
+* Starts the thread driving a curl multi handle, with at most 'maxInFlight' requests
+* being sent at the same time and at most 'queueSize' requests waiting for their turn.
+* What happens to a request arriving when the queue is full depends on 'overflow'.
+* Idle handles not reused during 'idleTimeout' seconds are cleaned up (0: never).
+* If 'maxInFlight' is 0, the asynchronous engine is not started.
+*/
+extern int httpRequestAsyncInit(int maxInFlight, int queueSize, QueueOverflow overflow, int idleTimeout = 0);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncShutdown - 
+*
+* Stops the event loop thread. The requests in flight and the waiting ones are finished
+* (their 'done' is called with CURLE_ABORTED_BY_CALLBACK and CURLE_FAILED_INIT).
+* Afterwards, httpRequestAsyncInit can be called again (used by the unit tests).
+*/
+extern void httpRequestAsyncShutdown(void);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncActive - 
+*/
+extern bool httpRequestAsyncActive(void);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncAdd - 
+*
+* Hand a ready-to-perform easy handle over to the event loop. 'done' is always
+* called, also if the request is discarded (with CURLE_FAILED_INIT as result).
+* With the 'block' overflow policy, the caller waits until there is room in the queue.
+*/
+extern void httpRequestAsyncAdd(CURL* curl, HttpRequestAsyncDone done, void* data);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncHandleGet - 
+*
+* An easy handle to the destination 'key', reused from a finished request (so its
+* connection may be kept alive) or a new one if there is none idle.
+*/
+extern CURL* httpRequestAsyncHandleGet(const std::string& key);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncHandleRelease - 
+*
+* Give back the handle of a finished request to the destination 'key', to be reused by
+* httpRequestAsyncHandleGet. At most 'maxInFlight' handles per destination are kept, the
+* rest (and all of them once the engine is stopped) are cleaned up.
+*/
+extern void httpRequestAsyncHandleRelease(const std::string& key, CURL* curl);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncStatistics - 
+*
+* Returns the number of requests handed over since the last reset (requests in flight
+* and discarded requests are output parameters).
+*/
+extern unsigned long httpRequestAsyncStatistics(int* inFlightP, unsigned long* dropsP);
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncStatisticsReset - 
+*/
+extern void httpRequestAsyncStatisticsReset(void);
+
+#endif  // SRC_LIB_REST_HTTPREQUESTASYNC_H_
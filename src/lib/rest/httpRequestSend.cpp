@@ -30,6 +30,10 @@
 #include <netdb.h>                              // gethostbyname
 #include <arpa/inet.h>                          // inet_ntoa
 #include <netinet/tcp.h>                        // TCP_NODELAY
+#include <sys/epoll.h>                          // epoll_create, epoll_ctl, epoll_wait
+#include <time.h>                               // clock_gettime
+#include <string.h>                             // memset, strerror
+#include <errno.h>
 #include <curl/curl.h>
 
 #include <string>
@@ -43,6 +47,7 @@
 #include "logMsg/traceLevels.h"
 #include "rest/ConnectionInfo.h"
 #include "rest/httpRequestSend.h"
+#include "rest/httpRequestAsync.h"
 #include "rest/rest.h"
 #include "serviceRoutines/versionTreat.h"
 
@@ -91,10 +96,10 @@ void httpRequestInit(long defaultTimeoutInMilliseconds)
 
 /* **************************************************************************** 
 *
-* See [1] for a discussion on how curl_multi is to be used. Libcurl does not seem
-* to provide a way to do asynchronous HTTP transactions in the way we intended
-* with the previous version of httpRequestSend. To enable the old behavior of asynchronous
-* HTTP requests uncomment the following #define line.
+* See [1] for a discussion on how curl_multi is to be used. Notifications can be sent
+* asynchronously using httpRequestSendAsync, which hands the request over to the
+* curl_multi event loop in httpRequestAsync.cpp. To enable the old behavior of asynchronous
+* HTTP requests (raw sockets) uncomment the following #define line.
 *
 * [1] http://stackoverflow.com/questions/24288513/how-to-do-curl-multi-perform-asynchronously-in-c
 */
@@ -149,128 +154,44 @@ static char* curlVersionGet(char* buf, int bufLen)
   return buf;
 }
 
+
+
 /* ****************************************************************************
 *
-* httpRequestSend -
+* httpRequestPrepare -
+*
+* Set up the curl handle for a request (headers, URL, payload and timeout), common
+* to httpRequestSend and httpRequestSendAsync. The write callback is set by the caller.
+*
+* 'ip' and 'port' are changed to the ones of rush, if rush is used. The headers list
+* in '*headersP' is to be freed by the caller (also when false is returned, meaning
+* the request is too big).
 */
-std::string httpRequestSend
+static bool httpRequestPrepare
 (
-   const std::string&     _ip,
-   unsigned short         port,
-   const std::string&     protocol,
-   const std::string&     verb,
-   const std::string&     tenant,
-   const std::string&     servicePath,
-   const std::string&     xauthToken,
-   const std::string&     resource,
-   const std::string&     content_type,
-   const std::string&     content,
-   bool                   useRush,
-   bool                   waitForResponse,
-   const std::string&     acceptFormat,
-   long                   timeoutInMilliseconds
+  CURL*                  curl,
+  std::string&           ip,
+  unsigned short&        port,
+  char*                  portAsString,
+  int                    portAsStringLen,
+  const std::string&     protocol,
+  const std::string&     verb,
+  const std::string&     tenant,
+  const std::string&     servicePath,
+  const std::string&     xauthToken,
+  const std::string&     resource,
+  const std::string&     content_type,
+  const std::string&     content,
+  bool                   useRush,
+  const std::string&     acceptFormat,
+  long                   timeoutInMilliseconds,
+  struct curl_slist**    headersP,
+  std::string*           urlP,
+  int*                   outgoingMsgSizeP
 )
 {
-  char                       portAsString[16];
-  static unsigned long long  callNo             = 0;
-  std::string                result;
-  std::string                ip                 = _ip;
-  struct curl_slist*         headers            = NULL;
-  MemoryStruct*              httpResponse       = NULL;
-  CURLcode                   res;
-  int                        outgoingMsgSize       = 0;
-  CURL*                      curl;
-  struct curl_context        cc;
-
-  ++callNo;
-
-  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
-
-  if (timeoutInMilliseconds == -1)
-  {
-    timeoutInMilliseconds = defaultTimeout;
-  }
-
-  LM_TRANSACTION_START("to", ip.c_str(), port, resource.c_str());
-
-  // Preconditions check
-  if (port == 0)
-  {
-    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
-    LM_E(("Runtime Error (port is ZERO)"));
-    LM_TRANSACTION_END();
-    return "error";
-  }
-
-  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
-
-  if (ip.empty())
-  {
-    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
-    LM_E(("Runtime Error (ip is empty)"));
-    LM_TRANSACTION_END();
-    return "error";
-  }
-
-  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
-
-  if (verb.empty())
-  {
-    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
-    LM_E(("Runtime Error (verb is empty)"));
-    LM_TRANSACTION_END();
-    return "error";
-  }
-
-  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
-
-  if (resource.empty())
-  {
-    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
-    LM_E(("Runtime Error (resource is empty)"));
-    LM_TRANSACTION_END();
-    return "error";
-  }
-
-  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
-
-  if ((content_type.empty()) && (!content.empty()))
-  {
-    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
-    LM_E(("Runtime Error (Content-Type is empty but there is actual content)"));
-    LM_TRANSACTION_END();
-    return "error";
-  }
-
-  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
-
-  if ((!content_type.empty()) && (content.empty()))
-  {
-    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
-    LM_E(("Runtime Error (Content-Type non-empty but there is no content)"));
-    LM_TRANSACTION_END();
-    return "error";
-  }
-
-  LM_M(("KZ: Sending a message to %s:%d (calling get_curl_context)", ip.c_str(), port));
-
-  get_curl_context(ip, &cc);
-  LM_M(("KZ: Sending a message to %s:%d (after get_curl_context)", ip.c_str(), port));
-  if ((curl = cc.curl) == NULL)
-  {
-    release_curl_context(&cc);
-    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
-    LM_E(("Runtime Error (could not init libcurl)"));
-    LM_TRANSACTION_END();
-    return "error";
-  }
-
-  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
-
-  // Allocate to hold HTTP response
-  httpResponse = new MemoryStruct;
-  httpResponse->memory = (char*) malloc(1); // will grow as needed
-  httpResponse->size = 0; // no data at this point
+  struct curl_slist*  headers         = NULL;
+  int                 outgoingMsgSize = 0;
 
   //
   // Rush
@@ -313,7 +234,7 @@ std::string httpRequestSend
     }
   }
 
-  snprintf(portAsString, sizeof(portAsString), "%d", port);
+  snprintf(portAsString, portAsStringLen, "%d", port);
 
   // ----- User Agent
   char cvBuf[CURL_VERSION_MAX_LENGTH];
@@ -390,23 +311,16 @@ std::string httpRequestSend
     LM_M(("KZ: NOT Sending a message to %s:%d - too big!", ip.c_str(), port));
     LM_E(("Runtime Error (HTTP request to send is too large: %d bytes)", outgoingMsgSize));
 
-    // Cleanup curl environment
-    release_curl_context(&cc);
-    curl_slist_free_all(headers);
-
-    free(httpResponse->memory);
-    delete httpResponse;
-
-    LM_TRANSACTION_END();
-    return "error";
+    *headersP = headers;
+    return false;
   }
 
-  // Contents
+  // Contents (not copied by libcurl, 'content' must live until the request is done)
   const char* payload = content.c_str();
   curl_easy_setopt(curl, CURLOPT_POSTFIELDS, (u_int8_t*) payload);
 
   // Set up URL
-  std::string url;
+  std::string& url = *urlP;
   if (isIPv6(ip))
     url = "[" + ip + "]";
   else
@@ -419,8 +333,6 @@ std::string httpRequestSend
   curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L); // Allow redirection (?)
   curl_easy_setopt(curl, CURLOPT_HEADER, 1); // Activate include the header in the body output
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers); // Put headers in place
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &writeMemoryCallback); // Send data here
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*) httpResponse); // Custom data for response handling
 
   //
   // There is a known problem in libcurl (see http://stackoverflow.com/questions/9191668/error-longjmp-causes-uninitialized-stack-frame)
@@ -441,6 +353,156 @@ std::string httpRequestSend
     curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutInMilliseconds);
   }
 
+  *headersP         = headers;
+  *outgoingMsgSizeP = outgoingMsgSize;
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestSend -
+*/
+std::string httpRequestSend
+(
+   const std::string&     _ip,
+   unsigned short         port,
+   const std::string&     protocol,
+   const std::string&     verb,
+   const std::string&     tenant,
+   const std::string&     servicePath,
+   const std::string&     xauthToken,
+   const std::string&     resource,
+   const std::string&     content_type,
+   const std::string&     content,
+   bool                   useRush,
+   bool                   waitForResponse,
+   const std::string&     acceptFormat,
+   long                   timeoutInMilliseconds
+)
+{
+  char                       portAsString[16];
+  static unsigned long long  callNo             = 0;
+  std::string                result;
+  std::string                ip                 = _ip;
+  struct curl_slist*         headers            = NULL;
+  MemoryStruct*              httpResponse       = NULL;
+  CURLcode                   res;
+  int                        outgoingMsgSize       = 0;
+  CURL*                      curl;
+  struct curl_context        cc;
+
+  ++callNo;
+
+  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
+
+  if (timeoutInMilliseconds == -1)
+  {
+    timeoutInMilliseconds = defaultTimeout;
+  }
+
+  LM_TRANSACTION_START("to", ip.c_str(), port, resource.c_str());
+
+  // Preconditions check
+  if (port == 0)
+  {
+    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
+    LM_E(("Runtime Error (port is ZERO)"));
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
+
+  if (ip.empty())
+  {
+    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
+    LM_E(("Runtime Error (ip is empty)"));
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
+
+  if (verb.empty())
+  {
+    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
+    LM_E(("Runtime Error (verb is empty)"));
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
+
+  if (resource.empty())
+  {
+    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
+    LM_E(("Runtime Error (resource is empty)"));
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
+
+  if ((content_type.empty()) && (!content.empty()))
+  {
+    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
+    LM_E(("Runtime Error (Content-Type is empty but there is actual content)"));
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
+
+  if ((!content_type.empty()) && (content.empty()))
+  {
+    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
+    LM_E(("Runtime Error (Content-Type non-empty but there is no content)"));
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  LM_M(("KZ: Sending a message to %s:%d (calling get_curl_context)", ip.c_str(), port));
+
+  get_curl_context(ip, &cc);
+  LM_M(("KZ: Sending a message to %s:%d (after get_curl_context)", ip.c_str(), port));
+  if ((curl = cc.curl) == NULL)
+  {
+    release_curl_context(&cc);
+    LM_M(("KZ: ERROR Sending a message to %s:%d", ip.c_str(), port));
+    LM_E(("Runtime Error (could not init libcurl)"));
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  LM_M(("KZ: Sending a message to %s:%d", ip.c_str(), port));
+
+  // Allocate to hold HTTP response
+  httpResponse = new MemoryStruct;
+  httpResponse->memory = (char*) malloc(1); // will grow as needed
+  httpResponse->size = 0; // no data at this point
+
+  std::string url;
+  if (httpRequestPrepare(curl, ip, port, portAsString, sizeof(portAsString), protocol, verb, tenant, servicePath, xauthToken,
+                         resource, content_type, content, useRush, acceptFormat, timeoutInMilliseconds,
+                         &headers, &url, &outgoingMsgSize) == false)
+  {
+    // Cleanup curl environment
+    release_curl_context(&cc);
+    curl_slist_free_all(headers);
+
+    free(httpResponse->memory);
+    delete httpResponse;
+
+    LM_TRANSACTION_END();
+    return "error";
+  }
+
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &writeMemoryCallback); // Send data here
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*) httpResponse); // Custom data for response handling
+
 
   // Synchronous HTTP request
   LM_T(LmtClientOutputPayload, ("Sending message %lu to HTTP server: sending message of %d bytes to HTTP server", callNo, outgoingMsgSize));
@@ -477,6 +539,142 @@ std::string httpRequestSend
 }
 
 
+
+/* ****************************************************************************
+*
+* AsyncContext - what is needed after an asynchronous request is done
+*/
+typedef struct AsyncContext
+{
+  std::string         ip;
+  char                portAsString[16];
+  std::string         url;
+  std::string         content;         // the payload, not copied by libcurl
+  struct curl_slist*  headers;
+  MemoryStruct        response;
+  char                transactionId[64];
+} AsyncContext;
+
+
+
+/* ****************************************************************************
+*
+* httpRequestAsyncDone - 
+*
+* Called from the event loop thread, in the transaction of the request.
+*/
+static void httpRequestAsyncDone(CURL* curl, CURLcode res, void* data)
+{
+  AsyncContext* ctxP = (AsyncContext*) data;
+
+  strncpy(transactionId, ctxP->transactionId, sizeof(transactionId));
+
+  if (res != CURLE_OK)
+  {
+    //
+    // NOTE: Same log line as in httpRequestSend, used by the functional tests in
+    //       cases/880_timeout_for_forward_and_notifications/
+    //
+    LM_W(("Notification failure for %s:%s (curl_easy_perform failed: %s)", ctxP->ip.c_str(), ctxP->portAsString, curl_easy_strerror(res)));
+  }
+  else
+  {
+    LM_I(("Notification Successfully Sent to %s", ctxP->url.c_str()));
+  }
+
+  httpRequestAsyncHandleRelease(ctxP->ip, curl);
+  curl_slist_free_all(ctxP->headers);
+  free(ctxP->response.memory);
+  delete ctxP;
+
+  LM_TRANSACTION_END();
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestSendAsync -
+*
+* The request is prepared in the calling thread (in a transaction of its own, the
+* transactionId of the caller is restored before returning) and sent by the curl_multi
+* event loop. The response is not waited for.
+*/
+int httpRequestSendAsync
+(
+   const std::string&     _ip,
+   unsigned short         port,
+   const std::string&     protocol,
+   const std::string&     verb,
+   const std::string&     tenant,
+   const std::string&     servicePath,
+   const std::string&     xauthToken,
+   const std::string&     resource,
+   const std::string&     content_type,
+   const std::string&     content,
+   bool                   useRush,
+   long                   timeoutInMilliseconds
+)
+{
+  char  callerTransactionId[64];
+  int   outgoingMsgSize = 0;
+
+  if ((port == 0) || _ip.empty() || verb.empty() || resource.empty() || (content_type.empty() != content.empty()))
+  {
+    LM_E(("Runtime Error (bad parameters for HTTP request to '%s:%d%s')", _ip.c_str(), port, resource.c_str()));
+    return -1;
+  }
+
+  if (timeoutInMilliseconds == -1)
+  {
+    timeoutInMilliseconds = defaultTimeout;
+  }
+
+  CURL* curl = httpRequestAsyncHandleGet(_ip);
+
+  if (curl == NULL)
+  {
+    LM_E(("Runtime Error (could not init libcurl)"));
+    return -1;
+  }
+
+  strncpy(callerTransactionId, transactionId, sizeof(callerTransactionId));
+  LM_TRANSACTION_START("to", _ip.c_str(), port, resource.c_str());
+
+  AsyncContext* ctxP = new AsyncContext;
+
+  ctxP->ip              = _ip;
+  ctxP->content         = content;
+  ctxP->headers         = NULL;
+  ctxP->response.memory = (char*) malloc(1); // will grow as needed
+  ctxP->response.size   = 0;
+  strncpy(ctxP->transactionId, transactionId, sizeof(ctxP->transactionId));
+
+  if (httpRequestPrepare(curl, ctxP->ip, port, ctxP->portAsString, sizeof(ctxP->portAsString), protocol, verb, tenant, servicePath,
+                         xauthToken, resource, content_type, ctxP->content, useRush, "", timeoutInMilliseconds,
+                         &ctxP->headers, &ctxP->url, &outgoingMsgSize) == false)
+  {
+    httpRequestAsyncHandleRelease(ctxP->ip, curl);
+    curl_slist_free_all(ctxP->headers);
+    free(ctxP->response.memory);
+    delete ctxP;
+
+    LM_TRANSACTION_END();
+    strncpy(transactionId, callerTransactionId, sizeof(transactionId));
+    return -1;
+  }
+
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &writeMemoryCallback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*) &ctxP->response);
+
+  LM_T(LmtClientOutputPayload, ("Sending message to HTTP server (asynchronously): sending message of %d bytes to HTTP server", outgoingMsgSize));
+  httpRequestAsyncAdd(curl, httpRequestAsyncDone, ctxP);
+
+  strncpy(transactionId, callerTransactionId, sizeof(transactionId));
+  return 0;
+}
+
+
 #else // Old functionality()
 
 /* ****************************************************************************
@@ -818,3 +1016,354 @@ std::string httpRequestSend
 }
 
 #endif
+
+
+
+/* ****************************************************************************
+*
+* ParallelLoop - the epoll set and the timer of the multi handle of httpRequestSendParallel
+*/
+typedef struct ParallelLoop
+{
+  int        epollFd;
+  long long  timerDeadline;   // -1: no timer
+} ParallelLoop;
+
+
+
+/* ****************************************************************************
+*
+* ParallelContext - one of the requests of httpRequestSendParallel, while being sent
+*/
+typedef struct ParallelContext
+{
+  HttpRequest*        requestP;
+  std::string         ip;
+  char                portAsString[16];
+  std::string         url;
+  struct curl_slist*  headers;
+  MemoryStruct        response;
+  char                transactionId[64];
+} ParallelContext;
+
+
+
+/* ****************************************************************************
+*
+* PARALLEL_WAIT_MAX_MS - maximum time httpRequestSendParallel sleeps in epoll_wait
+* PARALLEL_MAX_EVENTS  - maximum number of events got from each epoll_wait
+*/
+#define PARALLEL_WAIT_MAX_MS  1000
+#define PARALLEL_MAX_EVENTS   64
+
+
+
+/* ****************************************************************************
+*
+* msecsGet - milliseconds of the monotonic clock
+*/
+static long long msecsGet(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+
+
+/* ****************************************************************************
+*
+* parallelSocket - libcurl's socket callback: start, change or stop watching a socket
+*/
+static int parallelSocket(CURL* easy, curl_socket_t s, int what, void* userp, void* socketp)
+{
+  ParallelLoop*       loopP = (ParallelLoop*) userp;
+  struct epoll_event  ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = s;
+
+  if (what == CURL_POLL_REMOVE)
+  {
+    // The socket may be closed already (and so removed from the epoll set), no error check
+    epoll_ctl(loopP->epollFd, EPOLL_CTL_DEL, s, &ev);
+    return 0;
+  }
+
+  ev.events = ((what & CURL_POLL_IN)? EPOLLIN : 0) | ((what & CURL_POLL_OUT)? EPOLLOUT : 0);
+
+  if ((epoll_ctl(loopP->epollFd, EPOLL_CTL_MOD, s, &ev) != 0) && (errno == ENOENT))
+  {
+    if (epoll_ctl(loopP->epollFd, EPOLL_CTL_ADD, s, &ev) != 0)
+    {
+      LM_E(("Runtime Error (epoll_ctl: %s)", strerror(errno)));
+    }
+  }
+
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* parallelTimer - libcurl's timer callback: -1 means no timeout
+*/
+static int parallelTimer(CURLM* multi, long timeoutMs, void* userp)
+{
+  ParallelLoop* loopP = (ParallelLoop*) userp;
+
+  loopP->timerDeadline = (timeoutMs < 0)? -1 : msecsGet() + timeoutMs;
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* parallelPrepare - the easy handle of one of the requests of httpRequestSendParallel
+*
+* NULL if the request cannot be sent (its response is then "error", as for httpRequestSend).
+* The request is prepared in a transaction of its own, the caller restores its transactionId.
+*/
+static CURL* parallelPrepare(ParallelContext* ctxP, long timeoutInMilliseconds)
+{
+  HttpRequest*    rP              = ctxP->requestP;
+  unsigned short  port            = rP->port;
+  int             outgoingMsgSize = 0;
+  CURL*           curl;
+
+  rP->response = "error";
+  rP->timedOut = false;
+
+  if ((port == 0) || rP->ip.empty() || rP->verb.empty() || rP->resource.empty() || (rP->mimeType.empty() != rP->content.empty()))
+  {
+    LM_E(("Runtime Error (bad parameters for HTTP request to '%s:%d%s')", rP->ip.c_str(), port, rP->resource.c_str()));
+    return NULL;
+  }
+
+  if ((curl = curl_easy_init()) == NULL)
+  {
+    LM_E(("Runtime Error (could not init libcurl)"));
+    return NULL;
+  }
+
+  LM_TRANSACTION_START("to", rP->ip.c_str(), port, rP->resource.c_str());
+  strncpy(ctxP->transactionId, transactionId, sizeof(ctxP->transactionId));
+
+  ctxP->ip              = rP->ip;
+  ctxP->headers         = NULL;
+  ctxP->response.memory = (char*) malloc(1); // will grow as needed
+  ctxP->response.size   = 0;
+
+  if (httpRequestPrepare(curl, ctxP->ip, port, ctxP->portAsString, sizeof(ctxP->portAsString), rP->protocol, rP->verb, rP->tenant,
+                         rP->servicePath, rP->xauthToken, rP->resource, rP->mimeType, rP->content, false, rP->mimeType,
+                         timeoutInMilliseconds, &ctxP->headers, &ctxP->url, &outgoingMsgSize) == false)
+  {
+    curl_easy_cleanup(curl);
+    curl_slist_free_all(ctxP->headers);
+    free(ctxP->response.memory);
+    ctxP->headers = NULL;
+    ctxP->response.memory = NULL;
+
+    LM_TRANSACTION_END();
+    return NULL;
+  }
+
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &writeMemoryCallback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*) &ctxP->response);
+  curl_easy_setopt(curl, CURLOPT_PRIVATE, (char*) ctxP);
+
+  LM_T(LmtClientOutputPayload, ("Sending message to HTTP server (in parallel): sending message of %d bytes to HTTP server", outgoingMsgSize));
+
+  return curl;
+}
+
+
+
+/* ****************************************************************************
+*
+* parallelDone - the response (or the error) of one of the requests of httpRequestSendParallel
+*
+* A request that is not answered in time fails with CURLE_OPERATION_TIMEDOUT (CURLOPT_TIMEOUT_MS).
+*/
+static void parallelDone(CURL* curl, CURLcode res, ParallelContext* ctxP)
+{
+  HttpRequest* rP = ctxP->requestP;
+
+  strncpy(transactionId, ctxP->transactionId, sizeof(transactionId));
+
+  if (res != CURLE_OK)
+  {
+    //
+    // NOTE: Same log line as in httpRequestSend, used by the functional tests in
+    //       cases/880_timeout_for_forward_and_notifications/
+    //
+    LM_W(("Notification failure for %s:%s (curl_easy_perform failed: %s)", ctxP->ip.c_str(), ctxP->portAsString, curl_easy_strerror(res)));
+    rP->response = "";
+    rP->timedOut = (res == CURLE_OPERATION_TIMEDOUT);
+  }
+  else
+  {
+    LM_I(("Notification Successfully Sent to %s", ctxP->url.c_str()));
+    rP->response.assign(ctxP->response.memory, ctxP->response.size);
+  }
+
+  curl_easy_cleanup(curl);
+  curl_slist_free_all(ctxP->headers);
+  free(ctxP->response.memory);
+
+  LM_TRANSACTION_END();
+}
+
+
+
+/* ****************************************************************************
+*
+* httpRequestSendParallel -
+*
+* All the requests are sent at the same time by the calling thread, with a curl multi handle
+* of its own driven by curl_multi_socket_action and epoll (as in httpRequestAsync.cpp), so no
+* thread is created whatever the number of requests. Each request has CURLOPT_TIMEOUT_MS set
+* to the deadline and the wait ends when the last of them is done.
+* The transactionId of the caller is restored before returning.
+*/
+void httpRequestSendParallel(std::vector<HttpRequest*>& requestV, long timeoutInMilliseconds)
+{
+  unsigned int                  size = requestV.size();
+  std::vector<ParallelContext>  ctxV(size);
+  char                          callerTransactionId[64];
+  ParallelLoop                  loop;
+  CURLM*                        multi;
+  int                           stillRunning = 0;
+  int                           pending      = 0;
+
+  if (size == 0)
+  {
+    return;
+  }
+
+  if (timeoutInMilliseconds == -1)
+  {
+    timeoutInMilliseconds = defaultTimeout;
+  }
+
+  strncpy(callerTransactionId, transactionId, sizeof(callerTransactionId));
+
+  loop.timerDeadline = -1;
+
+  if ((loop.epollFd = epoll_create(PARALLEL_MAX_EVENTS)) == -1)
+  {
+    LM_E(("Runtime Error (epoll_create: %s)", strerror(errno)));
+    for (unsigned int ix = 0; ix < size; ++ix)
+    {
+      requestV[ix]->response = "error";
+      requestV[ix]->timedOut = false;
+    }
+    return;
+  }
+
+  if ((multi = curl_multi_init()) == NULL)
+  {
+    LM_E(("Runtime Error (curl_multi_init)"));
+    close(loop.epollFd);
+    for (unsigned int ix = 0; ix < size; ++ix)
+    {
+      requestV[ix]->response = "error";
+      requestV[ix]->timedOut = false;
+    }
+    return;
+  }
+
+  curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, parallelSocket);
+  curl_multi_setopt(multi, CURLMOPT_SOCKETDATA,     &loop);
+  curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION,  parallelTimer);
+  curl_multi_setopt(multi, CURLMOPT_TIMERDATA,      &loop);
+
+  for (unsigned int ix = 0; ix < size; ++ix)
+  {
+    ctxV[ix].requestP = requestV[ix];
+
+    CURL* curl = parallelPrepare(&ctxV[ix], timeoutInMilliseconds);
+
+    if (curl != NULL)
+    {
+      curl_multi_add_handle(multi, curl);
+      ++pending;
+    }
+  }
+
+  strncpy(transactionId, callerTransactionId, sizeof(transactionId));
+
+  //
+  // 'pending' counts the handles added and not yet done (CURLMSG_DONE), not 'stillRunning':
+  // handles failing inside the first curl_multi_socket_action (a malformed URL, a refused
+  // connection) are already missing from 'stillRunning' when their messages are read.
+  //
+  if (pending > 0)
+  {
+    curl_multi_socket_action(multi, CURL_SOCKET_TIMEOUT, 0, &stillRunning);
+  }
+
+  while (true)
+  {
+    CURLMsg*  msg;
+    int       left;
+
+    while ((msg = curl_multi_info_read(multi, &left)) != NULL)
+    {
+      if (msg->msg != CURLMSG_DONE)
+      {
+        continue;
+      }
+
+      CURL*             curl = msg->easy_handle;
+      CURLcode          res  = msg->data.result;
+      ParallelContext*  ctxP = NULL;
+
+      curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**) &ctxP);
+      curl_multi_remove_handle(multi, curl);
+      parallelDone(curl, res, ctxP);
+      --pending;
+    }
+
+    if (pending <= 0)
+    {
+      break;
+    }
+
+    struct epoll_event  events[PARALLEL_MAX_EVENTS];
+    long long           timeout = PARALLEL_WAIT_MAX_MS;
+
+    if (loop.timerDeadline != -1)
+    {
+      timeout = loop.timerDeadline - msecsGet();
+      timeout = (timeout < 0)? 0 : (timeout > PARALLEL_WAIT_MAX_MS)? PARALLEL_WAIT_MAX_MS : timeout;
+    }
+
+    int n = epoll_wait(loop.epollFd, events, PARALLEL_MAX_EVENTS, (int) timeout);
+
+    for (int ix = 0; ix < n; ++ix)
+    {
+      int mask = 0;
+
+      mask |= (events[ix].events & EPOLLIN)?  CURL_CSELECT_IN  : 0;
+      mask |= (events[ix].events & EPOLLOUT)? CURL_CSELECT_OUT : 0;
+      mask |= (events[ix].events & (EPOLLERR | EPOLLHUP))? CURL_CSELECT_ERR : 0;
+
+      curl_multi_socket_action(multi, events[ix].data.fd, mask, &stillRunning);
+    }
+
+    if ((loop.timerDeadline != -1) && (msecsGet() >= loop.timerDeadline))
+    {
+      loop.timerDeadline = -1;
+      curl_multi_socket_action(multi, CURL_SOCKET_TIMEOUT, 0, &stillRunning);
+    }
+  }
+
+  curl_multi_cleanup(multi);
+  close(loop.epollFd);
+
+  strncpy(transactionId, callerTransactionId, sizeof(transactionId));
+}
@@ -75,4 +75,66 @@ extern std::string httpRequestSend
   long                   timeoutInMilliseconds = -1
 );
 
+
+
+/* ****************************************************************************
+*
+* httpRequestSendAsync - send without waiting for the response (see httpRequestAsyncInit)
+*
+* Returns -1 if the request could not be prepared. Whether it was sent or not is only logged.
+*/
+extern int httpRequestSendAsync
+(
+  const std::string&     ip,
+  unsigned short         port,
+  const std::string&     protocol,
+  const std::string&     verb,
+  const std::string&     tenant,
+  const std::string&     servicePath,
+  const std::string&     xauthToken,
+  const std::string&     resource,
+  const std::string&     content_type,
+  const std::string&     content,
+  bool                   useRush,
+  long                   timeoutInMilliseconds = -1
+);
+
+
+
+/* ****************************************************************************
+*
+* HttpRequest - one of the requests of httpRequestSendParallel
+*
+* 'response' and 'timedOut' are output.
+*/
+typedef struct HttpRequest
+{
+  std::string     ip;
+  unsigned short  port;
+  std::string     protocol;
+  std::string     verb;
+  std::string     tenant;
+  std::string     servicePath;
+  std::string     xauthToken;
+  std::string     resource;
+  std::string     mimeType;
+  std::string     content;
+
+  std::string     response;
+  bool            timedOut;
+} HttpRequest;
+
+
+
+/* ****************************************************************************
+*
+* httpRequestSendParallel - send a number of requests concurrently, waiting for all the responses
+*
+* Each request has a deadline of timeoutInMilliseconds (-1: the default timeout of httpRequestInit),
+* so the call takes as long as the slowest of the requests, never (much) longer than the deadline.
+* No threads are created, the requests are driven from the calling thread by a curl multi handle.
+* 'timedOut' is set for the requests finishing with CURLE_OPERATION_TIMEDOUT.
+*/
+extern void httpRequestSendParallel(std::vector<HttpRequest*>& requestV, long timeoutInMilliseconds = -1);
+
 #endif
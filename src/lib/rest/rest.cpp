@@ -28,12 +28,14 @@
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
+#include "common/Arena.h"
 #include "common/string.h"
 #include "common/wsStrip.h"
 #include "common/globals.h"
 #include "common/defaultValues.h"
 #include "parse/forbiddenChars.h"
 #include "rest/RestService.h"
+#include "rest/RestServiceTrie.h"
 #include "rest/rest.h"
 #include "rest/restReply.h"
 #include "rest/OrionError.h"
@@ -86,6 +88,51 @@ static MHD_Daemon*               mhdDaemon_v6          = NULL;
 static struct sockaddr_in        sad;
 static struct sockaddr_in6       sad_v6;
 __thread char                    static_buffer[STATIC_BUFFER_SIZE + 1];
+static unsigned int              mhdModeFlags          = MHD_USE_THREAD_PER_CONNECTION;
+static unsigned int              mhdThreadPoolSize     = 0;
+
+
+
+/* ****************************************************************************
+*
+* restHttpModeSet - 
+*
+* "thread": a thread per connection (the default)
+* "select": a pool of 'threads' threads, each one serving many connections using select()
+* "epoll":  same as "select", but using epoll (only if built with libmicrohttpd >= 0.9.33)
+*
+* In the "select" and "epoll" modes a thread serves many connections, so nothing
+* belonging to a request can be kept in thread-local storage between the calls
+* to connectionTreat (see ciP->transactionId and static_buffer).
+*/
+bool restHttpModeSet(const std::string& mode, int threads)
+{
+  if (mode == "thread")
+  {
+    mhdModeFlags      = MHD_USE_THREAD_PER_CONNECTION;
+    mhdThreadPoolSize = 0;
+    return true;
+  }
+
+  if (mode == "select")
+  {
+    mhdModeFlags = MHD_USE_SELECT_INTERNALLY;
+  }
+#if MHD_VERSION >= 0x00093300
+  else if (mode == "epoll")
+  {
+    mhdModeFlags = MHD_USE_SELECT_INTERNALLY | MHD_USE_EPOLL_LINUX_ONLY;
+  }
+#endif
+  else
+  {
+    return false;
+  }
+
+  mhdThreadPoolSize = (threads < 1)? 1 : threads;
+
+  return true;
+}
 
 
 
@@ -173,6 +220,27 @@ static int uriArgumentGet(void* cbDataP, MHD_ValueKind kind, const char* ckey, c
       return MHD_YES;
     }
   }
+  else if (key == URI_PARAM_PAGINATION_TOKEN)
+  {
+    if ((value.length() % 2) != 0)
+    {
+      OrionError error(SccBadRequest, std::string("Bad pagination token: /") + value + "/ [odd number of characters]");
+      ciP->httpStatusCode = SccBadRequest;
+      ciP->answer         = error.render(ciP, "");
+      return MHD_YES;
+    }
+
+    for (unsigned int ix = 0; ix < value.length(); ++ix)
+    {
+      if (!isxdigit(value[ix]))
+      {
+        OrionError error(SccBadRequest, std::string("Bad pagination token: /") + value + "/ [must be an hexadecimal string]");
+        ciP->httpStatusCode = SccBadRequest;
+        ciP->answer         = error.render(ciP, "");
+        return MHD_YES;
+      }
+    }
+  }
   else if (key == URI_PARAM_ATTRIBUTES_FORMAT)
   {
     // If URI_PARAM_ATTRIBUTES_FORMAT used, set URI_PARAM_ATTRIBUTE_FORMAT as well
@@ -378,10 +446,17 @@ static Format wantedOutputSupported(const std::string& apiVersion, const std::st
 /* ****************************************************************************
 *
 * serve - 
+*
+* The objects of the request are allocated in the arena of the connection, freed all
+* together in requestCompleted, when the ConnectionInfo is deleted.
 */
 static void serve(ConnectionInfo* ciP)
 {
+  Arena* prevArenaP = arenaActivate(&ciP->arena);
+
   restService(ciP, restServiceV);
+
+  arenaActivate(prevArenaP);
 }
 
 
@@ -400,6 +475,8 @@ static void requestCompleted
 {
   ConnectionInfo* ciP      = (ConnectionInfo*) *con_cls;
 
+  strncpy(transactionId, ciP->transactionId.c_str(), sizeof(transactionId));
+
   if ((ciP->payload != NULL) && (ciP->payload != static_buffer))
     free(ciP->payload);
 
@@ -867,6 +944,7 @@ static int connectionTreat
     // Transaction starts here
     //
     LM_TRANSACTION_START("from", ip, port, url);  // Incoming REST request starts
+    ciP->transactionId = transactionId;
 
 
 
@@ -946,6 +1024,12 @@ static int connectionTreat
   }
 
 
+  //
+  // The thread may have served other connections since the previous call
+  //
+  strncpy(transactionId, ciP->transactionId.c_str(), sizeof(transactionId));
+
+
   //
   // 2. Data gathering calls
   //
@@ -958,7 +1042,7 @@ static int connectionTreat
     {
       if (ciP->httpHeaders.contentLength <= PAYLOAD_MAX_SIZE)
       {
-        if (ciP->httpHeaders.contentLength > STATIC_BUFFER_SIZE)
+        if ((ciP->httpHeaders.contentLength > STATIC_BUFFER_SIZE) || (mhdThreadPoolSize != 0))
           ciP->payload = (char*) malloc(ciP->httpHeaders.contentLength + 1);
         else
           ciP->payload = static_buffer;
@@ -1034,7 +1118,7 @@ static int restStart(IpVersion ipVersion, const char* httpsKey = NULL, const cha
     if ((httpsKey != NULL) && (httpsCertificate != NULL))
     {
       LM_T(LmtMhd, ("Starting HTTPS daemon on IPv4 %s port %d", bindIp, port));
-      mhdDaemon = MHD_start_daemon(MHD_USE_THREAD_PER_CONNECTION | MHD_USE_SSL, // MHD_USE_SELECT_INTERNALLY
+      mhdDaemon = MHD_start_daemon(mhdModeFlags | MHD_USE_SSL,
                                    htons(port),
                                    NULL,
                                    NULL,
@@ -1044,13 +1128,14 @@ static int restStart(IpVersion ipVersion, const char* httpsKey = NULL, const cha
                                    MHD_OPTION_CONNECTION_MEMORY_LIMIT,  memoryLimit,
                                    MHD_OPTION_SOCK_ADDR,                (struct sockaddr*) &sad,
                                    MHD_OPTION_NOTIFY_COMPLETED,         requestCompleted, NULL,
+                                   MHD_OPTION_THREAD_POOL_SIZE,         mhdThreadPoolSize,
                                    MHD_OPTION_END);
 
     }
     else
     {
       LM_T(LmtMhd, ("Starting HTTP daemon on IPv4 %s port %d", bindIp, port));
-      mhdDaemon = MHD_start_daemon(MHD_USE_THREAD_PER_CONNECTION, // MHD_USE_SELECT_INTERNALLY | MHD_USE_DEBUG
+      mhdDaemon = MHD_start_daemon(mhdModeFlags,
                                    htons(port),
                                    NULL,
                                    NULL,
@@ -1058,6 +1143,7 @@ static int restStart(IpVersion ipVersion, const char* httpsKey = NULL, const cha
                                    MHD_OPTION_CONNECTION_MEMORY_LIMIT,  memoryLimit,
                                    MHD_OPTION_SOCK_ADDR,                (struct sockaddr*) &sad,
                                    MHD_OPTION_NOTIFY_COMPLETED,         requestCompleted, NULL,
+                                   MHD_OPTION_THREAD_POOL_SIZE,         mhdThreadPoolSize,
                                    MHD_OPTION_END);
 
     }
@@ -1082,7 +1168,7 @@ static int restStart(IpVersion ipVersion, const char* httpsKey = NULL, const cha
     if ((httpsKey != NULL) && (httpsCertificate != NULL))
     {
       LM_T(LmtMhd, ("Starting HTTPS daemon on IPv6 %s port %d", bindIPv6, port));
-      mhdDaemon_v6 = MHD_start_daemon(MHD_USE_THREAD_PER_CONNECTION | MHD_USE_IPv6 | MHD_USE_SSL,
+      mhdDaemon_v6 = MHD_start_daemon(mhdModeFlags | MHD_USE_IPv6 | MHD_USE_SSL,
                                       htons(port),
                                       NULL,
                                       NULL,
@@ -1092,12 +1178,13 @@ static int restStart(IpVersion ipVersion, const char* httpsKey = NULL, const cha
                                       MHD_OPTION_CONNECTION_MEMORY_LIMIT,  memoryLimit,
                                       MHD_OPTION_SOCK_ADDR,                (struct sockaddr*) &sad_v6,
                                       MHD_OPTION_NOTIFY_COMPLETED,         requestCompleted, NULL,
+                                      MHD_OPTION_THREAD_POOL_SIZE,         mhdThreadPoolSize,
                                       MHD_OPTION_END);
     }
     else
     {
       LM_T(LmtMhd, ("Starting HTTP daemon on IPv6 %s port %d", bindIPv6, port));
-      mhdDaemon_v6 = MHD_start_daemon(MHD_USE_THREAD_PER_CONNECTION | MHD_USE_IPv6,
+      mhdDaemon_v6 = MHD_start_daemon(mhdModeFlags | MHD_USE_IPv6,
                                       htons(port),
                                       NULL,
                                       NULL,
@@ -1105,6 +1192,7 @@ static int restStart(IpVersion ipVersion, const char* httpsKey = NULL, const cha
                                       MHD_OPTION_CONNECTION_MEMORY_LIMIT,  memoryLimit,
                                       MHD_OPTION_SOCK_ADDR,                (struct sockaddr*) &sad_v6,
                                       MHD_OPTION_NOTIFY_COMPLETED,         requestCompleted, NULL,
+                                      MHD_OPTION_THREAD_POOL_SIZE,         mhdThreadPoolSize,
                                       MHD_OPTION_END);
     }
 
@@ -1177,6 +1265,9 @@ void restInit
   if ((_ipVersion == IPV6) || (_ipVersion == IPDUAL))
      strncpy(bindIPv6, bindIPv6, MAX_LEN_IP - 1);
 
+  // Compiling the service vector before the first request arrives
+  restServiceTrieBuild(restServiceV);
+
   // Starting REST interface
   int r;
   if ((r = restStart(_ipVersion, key, cert)) != 0)
@@ -65,6 +65,16 @@ typedef void (*RestServeFunction)(ConnectionInfo* ciP);
 
 
 
+/* ****************************************************************************
+*
+* restHttpModeSet - how connections are served (to be called before restInit)
+*
+* Returns false if 'mode' is not supported.
+*/
+extern bool restHttpModeSet(const std::string& mode, int threads);
+
+
+
 /* ****************************************************************************
 *
 * restInit - 
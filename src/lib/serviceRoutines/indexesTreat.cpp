@@ -0,0 +1,81 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/tag.h"
+#include "ngsi/ParseData.h"
+#include "rest/ConnectionInfo.h"
+#include "mongoBackend/indexManager.h"
+#include "serviceRoutines/indexesTreat.h"
+
+
+
+/* ****************************************************************************
+*
+* indexesTreat - 
+*
+* The status of the indexes of each tenant used since the broker was started
+* (see mongoBackend/indexManager.h).
+*/
+std::string indexesTreat
+(
+  ConnectionInfo*            ciP,
+  int                        components,
+  std::vector<std::string>&  compV,
+  ParseData*                 parseDataP
+)
+{
+  std::string               out;
+  std::string               indent  = "";
+  std::string               indent2 = (ciP->outFormat == JSON)? indent + "    " : indent + "  ";
+  std::string               indent3 = indent2 + "  ";
+  std::string               indent4 = indent3 + "  ";
+  std::vector<IndexStatus>  statusV;
+
+  indexesStatusGet(&statusV);
+
+  out += startTag(indent, "orion", ciP->outFormat, true, true);
+  out += startTag(indent2, "indexList", "indexes", ciP->outFormat, true, true);
+
+  for (unsigned int ix = 0; ix < statusV.size(); ++ix)
+  {
+    out += startTag(indent3, "index", "index", ciP->outFormat, false, false);
+    out += valueTag(indent4, "tenant",     statusV[ix].tenant,     ciP->outFormat, true);
+    out += valueTag(indent4, "collection", statusV[ix].collection, ciP->outFormat, true);
+    out += valueTag(indent4, "name",       statusV[ix].name,       ciP->outFormat, true);
+    out += valueTag(indent4, "status",     statusV[ix].status,     ciP->outFormat, false);
+    out += endTag(indent3, "index", ciP->outFormat, ix != statusV.size() - 1);
+  }
+
+  out += endTag(indent2, "indexList", ciP->outFormat, false, true);
+  out += endTag((ciP->outFormat == JSON)? indent + "  " : indent, "orion", ciP->outFormat, false, false, true, true);
+
+  ciP->httpStatusCode = SccOk;
+  return out;
+}
@@ -0,0 +1,196 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/globals.h"
+#include "common/statistics.h"
+#include "common/Format.h"
+
+#include "ngsi/ParseData.h"
+#include "ngsi/Request.h"
+#include "rest/ConnectionInfo.h"
+#include "serviceRoutines/metricsTreat.h"
+
+
+
+/* ****************************************************************************
+*
+* METRICS_MIN_OCTAVE - 
+* METRICS_MAX_OCTAVE - 
+*
+* The buckets of the exported histograms are the powers of two (of microseconds) in
+* between, i.e. from 8 microseconds to 33.5 seconds.
+*/
+#define METRICS_MIN_OCTAVE   3
+#define METRICS_MAX_OCTAVE  25
+
+
+
+/* ****************************************************************************
+*
+* metricHeader - 
+*/
+static std::string metricHeader(const char* name, const char* type, const char* help)
+{
+  char buf[256];
+
+  snprintf(buf, sizeof(buf), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+  return buf;
+}
+
+
+
+/* ****************************************************************************
+*
+* metricValue - 
+*/
+static std::string metricValue(const char* name, const char* label, const char* labelValue, unsigned long value)
+{
+  char buf[256];
+
+  snprintf(buf, sizeof(buf), "%s{%s=\"%s\"} %lu\n", name, label, labelValue, value);
+  return buf;
+}
+
+
+
+/* ****************************************************************************
+*
+* histogramRender - a latency histogram in the Prometheus format, in seconds
+*
+* The buckets of the histogram are cumulative. The power-of-two limits fall on limits
+* of the buckets of LatencyHistogram, so each count is exactly the number of latencies
+* under the limit.
+*/
+static std::string histogramRender
+(
+  const char*              name,
+  const char*              label,
+  const char*              labelValue,
+  const LatencyHistogram&  histogram
+)
+{
+  std::string    out;
+  char           buf[256];
+  unsigned long  cumulative = 0;
+  int            bucket     = 0;
+
+  for (int octave = METRICS_MIN_OCTAVE; octave <= METRICS_MAX_OCTAVE; ++octave)
+  {
+    unsigned long long limit = 1ULL << octave;
+
+    while ((bucket < LATENCY_BUCKETS) && (latencyBucketLimit(bucket) <= limit))
+    {
+      cumulative += histogram.bucketV[bucket];
+      ++bucket;
+    }
+
+    snprintf(buf, sizeof(buf), "%s_bucket{%s=\"%s\",le=\"%.6f\"} %lu\n", name, label, labelValue, limit / 1000000.0, cumulative);
+    out += buf;
+  }
+
+  snprintf(buf, sizeof(buf), "%s_bucket{%s=\"%s\",le=\"+Inf\"} %lu\n", name, label, labelValue, histogram.count);
+  out += buf;
+  snprintf(buf, sizeof(buf), "%s_sum{%s=\"%s\"} %.6f\n", name, label, labelValue, histogram.sum / 1000000.0);
+  out += buf;
+  snprintf(buf, sizeof(buf), "%s_count{%s=\"%s\"} %lu\n", name, label, labelValue, histogram.count);
+  out += buf;
+
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* metricsTreat - 
+*
+* The statistics in the Prometheus text exposition format. As in the statistics
+* request, only what has been used since the last reset of the statistics is included.
+*/
+std::string metricsTreat
+(
+  ConnectionInfo*            ciP,
+  int                        components,
+  std::vector<std::string>&  compV,
+  ParseData*                 parseDataP
+)
+{
+  std::string       out;
+  LatencyHistogram  histogram;
+  unsigned long     counter;
+  char              buf[128];
+
+  ciP->outFormat = TEXT;
+
+  out += metricHeader("orion_requests_total", "counter", "Requests received, by request type");
+  for (int ix = 0; ix < STATISTICS_REQUEST_TYPES; ++ix)
+  {
+    if ((counter = statisticsRequestsGet((RequestType) ix)) != 0)
+    {
+      out += metricValue("orion_requests_total", "request", requestType((RequestType) ix), counter);
+    }
+  }
+
+  out += metricHeader("orion_requests_by_format_total", "counter", "Requests received, by payload format");
+  out += metricValue("orion_requests_by_format_total", "format", "xml",  statisticsCounterGet(StatXmlRequests));
+  out += metricValue("orion_requests_by_format_total", "format", "json", statisticsCounterGet(StatJsonRequests));
+
+  out += metricHeader("orion_errors_total", "counter", "Errors, by kind");
+  out += metricValue("orion_errors_total", "error", "registration",       statisticsCounterGet(StatRegistrationErrors));
+  out += metricValue("orion_errors_total", "error", "registrationUpdate", statisticsCounterGet(StatRegistrationUpdateErrors));
+  out += metricValue("orion_errors_total", "error", "discovery",          statisticsCounterGet(StatDiscoveryErrors));
+
+  out += metricHeader("orion_request_duration_seconds", "histogram", "Latency of the requests, by request type");
+  for (int ix = 0; ix < STATISTICS_REQUEST_TYPES; ++ix)
+  {
+    if (statisticsLatencyGet((RequestType) ix, &histogram) == true)
+    {
+      out += histogramRender("orion_request_duration_seconds", "request", requestType((RequestType) ix), histogram);
+    }
+  }
+
+  out += metricHeader("orion_backend_duration_seconds", "histogram", "Latency of the database operations, by operation");
+  for (int ix = 0; ix < BackendOperations; ++ix)
+  {
+    if (statisticsBackendLatencyGet((BackendOperation) ix, &histogram) == true)
+    {
+      out += histogramRender("orion_backend_duration_seconds", "operation", backendOperationName((BackendOperation) ix), histogram);
+    }
+  }
+
+  out += metricHeader("orion_uptime_seconds", "gauge", "Time since the broker was started");
+  snprintf(buf, sizeof(buf), "orion_uptime_seconds %d\n", getCurrentTime() - startTime);
+  out += buf;
+
+  ciP->httpStatusCode = SccOk;
+  return out;
+}
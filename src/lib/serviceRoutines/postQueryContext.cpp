@@ -66,7 +66,7 @@ static char* jsonPayloadClean(const char* payload)
 
 /* ****************************************************************************
 *
-* queryForward - 
+* queryForwardPrepare - 
 *
 * An entity/attribute has been found on some context provider.
 * We need to forward the query request to the context provider, indicated in qcrsP->contextProvider
@@ -79,8 +79,14 @@ static char* jsonPayloadClean(const char* payload)
 * 6. 'Fix' StatusCode
 * 7. Freeing memory
 *
+* Steps 1 and 2 are done by queryForwardPrepare, that fills in the HTTP request to be sent
+* (returning false and the error in qcrsP if the forward is not possible).
+* Step 3 is done by httpRequestSendParallel, for all the forwards at the same time.
+* Steps 4 to 7 are done by queryForwardResponse, one forward after the other, as the parse
+* functions use (and modify) the ConnectionInfo of the request.
 *
-* FIXME P5: The function 'queryForward' is implemented to pick the format (XML or JSON) based on the
+*
+* FIXME P5: The function 'queryForwardPrepare' is implemented to pick the format (XML or JSON) based on the
 *           count of the Format for all the participating attributes. If we have more attributes 'preferring'
 *           XML than JSON, the forward is done in XML, etc. This is all OK.
 *           What is not OK is that the Accept HTTP header is set to the same format as the Content-Type HTTP Header.
@@ -88,13 +94,19 @@ static char* jsonPayloadClean(const char* payload)
 *           the forward message with an Acceot header of XML/JSON and then at reading the response, instead of 
 *           throwing away the HTTP headers, we could read the "Content-Type" and do the parse according the Content-Type.
 */
-static void queryForward(ConnectionInfo* ciP, QueryContextRequest* qcrP, Format format, QueryContextResponse* qcrsP)
+static bool queryForwardPrepare
+(
+  ConnectionInfo*        ciP,
+  QueryContextRequest*   qcrP,
+  Format                 format,
+  QueryContextResponse*  qcrsP,
+  HttpRequest*           requestP
+)
 {
   std::string     ip;
   std::string     protocol;
   int             port;
   std::string     prefix;
-  std::string     answer;
 
 
   //
@@ -107,7 +119,7 @@ static void queryForward(ConnectionInfo* ciP, QueryContextRequest* qcrP, Format
     //  SccBadRequest should have been returned before, when it was registered!
 
     qcrsP->errorCode.fill(SccContextElementNotFound, "");
-    return;
+    return false;
   }
 
 
@@ -123,34 +135,46 @@ static void queryForward(ConnectionInfo* ciP, QueryContextRequest* qcrP, Format
     {
       LM_E(("Runtime Error (error rendering forward-request)"));
       qcrsP->errorCode.fill(SccContextElementNotFound, "");
-      return;
+      return false;
     }
   }
 
   //
-  // 3. Send the request to the Context Provider (and await the reply)
+  // The request to send to the Context Provider, in step 3
   // FIXME P7: Should Rush be used?
   //
-  std::string     out;
-  std::string     verb         = "POST";
-  std::string     resource     = prefix + "/queryContext";
-  std::string     tenant       = ciP->tenant;
-  std::string     servicePath  = (ciP->httpHeaders.servicePathReceived == true)? ciP->httpHeaders.servicePath : "";
-  std::string     mimeType     = (format == XML)? "application/xml" : "application/json";
-
-  out = httpRequestSend(ip,
-                        port,
-                        protocol,
-                        verb,
-                        tenant,
-                        servicePath,
-                        ciP->httpHeaders.xauthToken,
-                        resource,
-                        mimeType,
-                        payload,
-                        false,
-                        true,
-                        mimeType);
+  requestP->ip          = ip;
+  requestP->port        = port;
+  requestP->protocol    = protocol;
+  requestP->verb        = "POST";
+  requestP->tenant      = ciP->tenant;
+  requestP->servicePath = (ciP->httpHeaders.servicePathReceived == true)? ciP->httpHeaders.servicePath : "";
+  requestP->xauthToken  = ciP->httpHeaders.xauthToken;
+  requestP->resource    = prefix + "/queryContext";
+  requestP->mimeType    = (format == XML)? "application/xml" : "application/json";
+  requestP->content     = payload;
+  requestP->timedOut    = false;
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* queryForwardResponse - steps 4 to 7 of a forward, see queryForwardPrepare
+*/
+static void queryForwardResponse(ConnectionInfo* ciP, Format format, HttpRequest* requestP, QueryContextResponse* qcrsP)
+{
+  std::string&  out = requestP->response;
+  char*         cleanPayload;
+
+  if (requestP->timedOut == true)
+  {
+    LM_W(("Other Error (context provider %s:%d did not respond to 'Query' in time)", requestP->ip.c_str(), requestP->port));
+    qcrsP->errorCode.fill(SccContextElementNotFound, "context provider timeout");
+    return;
+  }
 
   if ((out == "error") || (out == ""))
   {
@@ -300,6 +324,7 @@ std::string postQueryContext
   QueryContextResponseVector  responseV;
   long long                   count;
   long long*                  countP = NULL;
+  std::string                 nextPageToken;
 
 
   //
@@ -326,7 +351,7 @@ std::string postQueryContext
   // 01. Call mongoBackend/mongoQueryContext
   //
   qcrsP->errorCode.fill(SccOk);
-  ciP->httpStatusCode = mongoQueryContext(qcrP, qcrsP, ciP->tenant, ciP->servicePathV, ciP->uriParam, countP);
+  ciP->httpStatusCode = mongoQueryContext(qcrP, qcrsP, ciP->tenant, ciP->servicePathV, ciP->uriParam, countP, &nextPageToken);
 
 
   //
@@ -342,6 +367,17 @@ std::string postQueryContext
   }
 
 
+  //
+  // If keyset pagination (URI parameter 'pageToken') was used and the page is full, the token
+  // to get the next page is returned in HTTP header X-Next-Page-Token (both API versions)
+  //
+  if (nextPageToken != "")
+  {
+    ciP->httpHeader.push_back("X-Next-Page-Token");
+    ciP->httpHeaderValue.push_back(nextPageToken);
+  }
+
+
 
   //
   // 02. Normal case (no requests to be forwarded)
@@ -486,15 +522,17 @@ std::string postQueryContext
   }
 
   //
-  // Now, forward the Query requests, each in a separate thread (to be implemented) and
-  // await all the responses.
-  // Actually, if there is only ONE forward to be done then there is no reason to
-  // do the forward in a separate shell. Better to do it inside the current thread.
+  // Now, forward the Query requests, all at the same time from the current thread, and await all
+  // the responses (httpRequestSendParallel drives them with one curl multi handle).
+  // The wait is limited by -cprForwardTimeout, a context provider that doesn't respond in time
+  // gets a 404 with "context provider timeout" as details, the rest of the responses are kept.
   //
   // If providingApplication is empty then that part of the query has been performed already, locally.
   // 
   //
-  QueryContextResponse* qP;
+  std::vector<QueryContextResponse*>  forwardResponseV;
+  std::vector<HttpRequest*>           httpRequestV;
+  std::vector<HttpRequest*>           httpRequestOfResponseV;
 
   for (unsigned int fIx = 0; fIx < requestV.size() && fIx < cprForwardLimit; ++fIx)
   {
@@ -504,14 +542,39 @@ std::string postQueryContext
       continue;
     }
 
-    qP = new QueryContextResponse();
+    QueryContextResponse*  qP        = new QueryContextResponse();
+    HttpRequest*           requestP  = new HttpRequest();
+
     qP->errorCode.fill(SccOk);
-    queryForward(ciP, requestV[fIx], requestV.format(), qP);
+
+    if (queryForwardPrepare(ciP, requestV[fIx], requestV.format(), qP, requestP) == true)
+    {
+      httpRequestV.push_back(requestP);
+    }
+    else
+    {
+      delete requestP;
+      requestP = NULL;
+    }
+
+    forwardResponseV.push_back(qP);
+    httpRequestOfResponseV.push_back(requestP);
+  }
+
+  httpRequestSendParallel(httpRequestV, cprForwardTimeout);
+
+  for (unsigned int fIx = 0; fIx < forwardResponseV.size(); ++fIx)
+  {
+    if (httpRequestOfResponseV[fIx] != NULL)
+    {
+      queryForwardResponse(ciP, requestV.format(), httpRequestOfResponseV[fIx], forwardResponseV[fIx]);
+      delete httpRequestOfResponseV[fIx];
+    }
 
     //
-    // Now, each ContextElementResponse of qP should be tested to see whether there
+    // Now, each ContextElementResponse of forwardResponseV[fIx] should be tested to see whether there
     // is already an existing ContextElementResponse in responseV
-    responseV.push_back(qP);
+    responseV.push_back(forwardResponseV[fIx]);
   }
 
   std::string detailsString  = ciP->uriParam[URI_PARAM_PAGINATION_DETAILS];
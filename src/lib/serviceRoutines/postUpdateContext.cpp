@@ -92,7 +92,7 @@ static bool forwardsPending(UpdateContextResponse* upcrsP)
 
 /* ****************************************************************************
 *
-* updateForward - 
+* updateForwardPrepare - 
 *
 * An entity/attribute has been found on some context provider.
 * We need to forward the update request to the context provider, indicated in upcrsP->contextProvider
@@ -105,8 +105,12 @@ static bool forwardsPending(UpdateContextResponse* upcrsP)
 * 6. 'Fix' StatusCode
 * 7. Freeing memory
 *
+* Steps 1 and 2 are done by updateForwardPrepare, step 3 by httpRequestSendParallel (all the
+* forwards at the same time) and steps 4 to 7 by updateForwardResponse, see queryForwardPrepare
+* in postQueryContext.cpp.
 *
-* FIXME P5: The function 'updateForward' is implemented to pick the format (XML or JSON) based on the
+*
+* FIXME P5: The function 'updateForwardPrepare' is implemented to pick the format (XML or JSON) based on the
 *           count of the Format for all the participating attributes. If we have more attributes 'preferring'
 *           XML than JSON, the forward is done in XML, etc. This is all OK.
 *           What is not OK is that the Accept HTTP header is set to the same format as the Content-Type HTTP Header.
@@ -114,13 +118,19 @@ static bool forwardsPending(UpdateContextResponse* upcrsP)
 *           the forward message with an Acceot header of XML/JSON and then at reading the response, instead of 
 *           throwing away the HTTP headers, we could read the "Content-Type" and do the parse according the Content-Type.
 */
-static void updateForward(ConnectionInfo* ciP, UpdateContextRequest* upcrP, UpdateContextResponse* upcrsP, Format format)
+static bool updateForwardPrepare
+(
+  ConnectionInfo*         ciP,
+  UpdateContextRequest*   upcrP,
+  UpdateContextResponse*  upcrsP,
+  Format                  format,
+  HttpRequest*            requestP
+)
 {
   std::string     ip;
   std::string     protocol;
   int             port;
   std::string     prefix;
-  std::string     answer;
 
 
   //
@@ -133,7 +143,7 @@ static void updateForward(ConnectionInfo* ciP, UpdateContextRequest* upcrP, Upda
     //  SccBadRequest should have been returned before, when it was registered!
 
     upcrsP->errorCode.fill(SccContextElementNotFound, "");
-    return;
+    return false;
   }
 
 
@@ -155,35 +165,71 @@ static void updateForward(ConnectionInfo* ciP, UpdateContextRequest* upcrP, Upda
     {
       LM_E(("Runtime Error (error rendering forward-request)"));
       upcrsP->errorCode.fill(SccContextElementNotFound, "");
-      return;
+      return false;
     }
   }
 
 
   //
-  // 3. Send the request to the Context Provider (and await the reply)
+  // The request to send to the Context Provider, in step 3
   // FIXME P7: Should Rush be used?
   //
-  std::string     out;
-  std::string     verb         = "POST";
-  std::string     resource     = prefix + "/updateContext";
-  std::string     tenant       = ciP->tenant;
-  std::string     servicePath  = (ciP->httpHeaders.servicePathReceived == true)? ciP->httpHeaders.servicePath : "";
-  std::string     mimeType     = (format == XML)? "application/xml" : "application/json";
-
-  out = httpRequestSend(ip,
-                        port,
-                        protocol,
-                        verb,
-                        tenant,
-                        servicePath,
-                        ciP->httpHeaders.xauthToken,
-                        resource,
-                        mimeType,
-                        cleanPayload,
-                        false,
-                        true,
-                        mimeType);
+  requestP->ip          = ip;
+  requestP->port        = port;
+  requestP->protocol    = protocol;
+  requestP->verb        = "POST";
+  requestP->tenant      = ciP->tenant;
+  requestP->servicePath = (ciP->httpHeaders.servicePathReceived == true)? ciP->httpHeaders.servicePath : "";
+  requestP->xauthToken  = ciP->httpHeaders.xauthToken;
+  requestP->resource    = prefix + "/updateContext";
+  requestP->mimeType    = (format == XML)? "application/xml" : "application/json";
+  requestP->content     = cleanPayload;
+  requestP->timedOut    = false;
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* updateForwardResponse - steps 4 to 7 of a forward, see updateForwardPrepare
+*
+* A forward that is not answered in time gets a 404 "context provider timeout" for each of
+* its entities (in upcrP, the forwarded request), so the results of the other forwards are kept.
+*/
+static void updateForwardResponse
+(
+  ConnectionInfo*         ciP,
+  Format                  format,
+  UpdateContextRequest*   upcrP,
+  HttpRequest*            requestP,
+  UpdateContextResponse*  upcrsP
+)
+{
+  std::string&  out = requestP->response;
+  char*         cleanPayload;
+
+  if (requestP->timedOut == true)
+  {
+    LM_W(("Other Error (context provider %s:%d did not respond to 'Update' in time)", requestP->ip.c_str(), requestP->port));
+
+    for (unsigned int ix = 0; ix < upcrP->contextElementVector.size(); ++ix)
+    {
+      ContextElement*          ceP  = upcrP->contextElementVector[ix];
+      ContextElementResponse*  cerP = new ContextElementResponse(&ceP->entityId, NULL);
+
+      for (unsigned int aIx = 0; aIx < ceP->contextAttributeVector.size(); ++aIx)
+      {
+        cerP->contextElement.contextAttributeVector.push_back(new ContextAttribute(ceP->contextAttributeVector[aIx]));
+      }
+
+      cerP->statusCode.fill(SccContextElementNotFound, "context provider timeout");
+      upcrsP->contextElementResponseVector.push_back(cerP);
+    }
+
+    return;
+  }
 
   if ((out == "error") || (out == ""))
   {
@@ -648,9 +694,16 @@ std::string postUpdateContext
 
 
   //
-  // Calling each of the Context Providers, merging their results into the
-  // total response 'response'
+  // Calling the Context Providers, all at the same time (httpRequestSendParallel),
+  // merging their results into the total response 'response'.
+  // A Context Provider that doesn't respond within -cprForwardTimeout gets a 404 with
+  // "context provider timeout" as details, the rest of the responses are kept.
   //
+  std::vector<UpdateContextResponse*>  forwardResponseV;
+  std::vector<UpdateContextRequest*>   forwardRequestV;
+  std::vector<Format>                  formatV;
+  std::vector<HttpRequest*>            httpRequestV;
+  std::vector<HttpRequest*>            httpRequestOfResponseV;
 
   for (unsigned int ix = 0; ix < requestV.size() && ix < cprForwardLimit; ++ix)
   {
@@ -660,15 +713,41 @@ std::string postUpdateContext
       continue;
     }
 
-    UpdateContextResponse upcrs;
-    Format                format = requestV[ix]->format();
+    UpdateContextResponse*  forwardP  = new UpdateContextResponse();
+    HttpRequest*            requestP  = new HttpRequest();
+    Format                  format    = requestV[ix]->format();
 
-    updateForward(ciP, requestV[ix], &upcrs, format);
+    if (updateForwardPrepare(ciP, requestV[ix], forwardP, format, requestP) == true)
+    {
+      httpRequestV.push_back(requestP);
+    }
+    else
+    {
+      delete requestP;
+      requestP = NULL;
+    }
+
+    forwardResponseV.push_back(forwardP);
+    forwardRequestV.push_back(requestV[ix]);
+    formatV.push_back(format);
+    httpRequestOfResponseV.push_back(requestP);
+  }
+
+  httpRequestSendParallel(httpRequestV, cprForwardTimeout);
+
+  for (unsigned int ix = 0; ix < forwardResponseV.size(); ++ix)
+  {
+    if (httpRequestOfResponseV[ix] != NULL)
+    {
+      updateForwardResponse(ciP, formatV[ix], forwardRequestV[ix], httpRequestOfResponseV[ix], forwardResponseV[ix]);
+      delete httpRequestOfResponseV[ix];
+    }
 
     //
     // Add the result from the forwarded update to the total response in 'response'
     //
-    response.merge(&upcrs);
+    response.merge(forwardResponseV[ix]);
+    delete forwardResponseV[ix];
   }
 
   answer = response.render(ciP, UpdateContext, "");
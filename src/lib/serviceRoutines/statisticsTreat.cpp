@@ -22,6 +22,8 @@
 *
 * Author: Ken Zangelin
 */
+#include <strings.h>
+
 #include <string>
 #include <vector>
 
@@ -36,8 +38,11 @@
 
 #include "ngsi/ParseData.h"
 #include "rest/ConnectionInfo.h"
+#include "rest/uriParamNames.h"
 #include "serviceRoutines/statisticsTreat.h"
 #include "mongoBackend/mongoConnectionPool.h"
+#include "ngsiNotify/senderThreadPool.h"
+#include "rest/httpRequestAsync.h"
 
 
 
@@ -45,367 +50,273 @@
 *
 * TAG_ADD - 
 */
-#define TAG_ADD_COUNTER(tag, counter) valueTag(indent2, tag, counter + 1, ciP->outFormat, true)
+#define TAG_ADD_COUNTER(tag, counter) valueTag(indent2, tag, (int) counter, ciP->outFormat, true)
 #define TAG_ADD_STRING(tag, value)  valueTag(indent2, tag, value, ciP->outFormat, true)
 
 
 
 /* ****************************************************************************
 *
-* statisticsTreat - 
+* RequestCounterTag - tag of the counter of a request type
 */
-std::string statisticsTreat
-(
-  ConnectionInfo*            ciP,
-  int                        components,
-  std::vector<std::string>&  compV,
-  ParseData*                 parseDataP
-)
+typedef struct RequestCounterTag
 {
-  std::string out     = "";
-  std::string tag     = "orion";
-  std::string indent  = "";
-  std::string indent2 = (ciP->outFormat == JSON)? indent + "    " : indent + "  ";
-
-  if (ciP->method == "DELETE")
-  {
-    noOfJsonRequests                                = -1;
-    noOfXmlRequests                                 = -1;
-    noOfRegistrations                               = -1;
-    noOfRegistrationErrors                          = -1;
-    noOfRegistrationUpdates                         = -1;
-    noOfRegistrationUpdateErrors                    = -1;
-    noOfDiscoveries                                 = -1;
-    noOfDiscoveryErrors                             = -1;
-    noOfAvailabilitySubscriptions                   = -1;
-    noOfAvailabilitySubscriptionErrors              = -1;
-    noOfAvailabilityUnsubscriptions                 = -1;
-    noOfAvailabilityUnsubscriptionErrors            = -1;
-    noOfAvailabilitySubscriptionUpdates             = -1;
-    noOfAvailabilitySubscriptionUpdateErrors        = -1;
-    noOfAvailabilityNotificationsReceived           = -1;
-    noOfAvailabilityNotificationsSent               = -1;
-
-    noOfQueries                                     = -1;
-    noOfQueryErrors                                 = -1;
-    noOfUpdates                                     = -1;
-    noOfUpdateErrors                                = -1;
-    noOfSubscriptions                               = -1;
-    noOfSubscriptionErrors                          = -1;
-    noOfSubscriptionUpdates                         = -1;
-    noOfSubscriptionUpdateErrors                    = -1;
-    noOfUnsubscriptions                             = -1;
-    noOfUnsubscriptionErrors                        = -1;
-    noOfNotificationsReceived                       = -1;
-    noOfNotificationsSent                           = -1;
-    noOfQueryContextResponses                       = -1;
-    noOfUpdateContextResponses                      = -1;
-
-    noOfContextEntitiesByEntityId                   = -1;
-    noOfContextEntityAttributes                     = -1;
-    noOfEntityByIdAttributeByName                   = -1;
-    noOfContextEntityTypes                          = -1;
-    noOfContextEntityTypeAttributeContainer         = -1;
-    noOfContextEntityTypeAttribute                  = -1;
-
-    noOfIndividualContextEntity                     = -1;
-    noOfIndividualContextEntityAttributes           = -1;
-    noOfIndividualContextEntityAttribute            = -1;
-    noOfUpdateContextElement                        = -1;
-    noOfAppendContextElement                        = -1;
-    noOfUpdateContextAttribute                      = -1;
-
-    noOfNgsi10ContextEntityTypes                    = -1;
-    noOfNgsi10ContextEntityTypesAttributeContainer  = -1;
-    noOfNgsi10ContextEntityTypesAttribute           = -1;
-    noOfNgsi10SubscriptionsConvOp                   = -1;
-
-    noOfAllContextEntitiesRequests                    = -1;
-    noOfAllEntitiesWithTypeAndIdRequests              = -1;
-    noOfIndividualContextEntityAttributeWithTypeAndId = -1;
-    noOfAttributeValueInstanceWithTypeAndId           = -1;
-    noOfContextEntitiesByEntityIdAndType              = -1;
-    noOfEntityByIdAttributeByNameIdAndType            = -1;
-
-    noOfLogRequests                                 = -1;
-    noOfVersionRequests                             = -1;
-    noOfExitRequests                                = -1;
-    noOfLeakRequests                                = -1;
-    noOfStatisticsRequests                          = -1;
-    noOfInvalidRequests                             = -1;
-    noOfRegisterResponses                           = -1;
-
-    semTimeReqReset();
-    semTimeTransReset();
-    mongoPoolConnectionSemWaitingTimeReset();
-    mutexTimeCCReset();
-
-    out += startTag(indent, tag, ciP->outFormat, true, true);
-    out += valueTag(indent2, "message", "All statistics counter reset", ciP->outFormat);
-    indent2 = (ciP->outFormat == JSON)? indent + "  " : indent;
-    out += endTag(indent2, tag, ciP->outFormat, false, false, true, true);
-    return out;
-  }
-
-  out += startTag(indent, tag, ciP->outFormat, true, true);
-
-  if (noOfXmlRequests != -1)
-  {
-    out += TAG_ADD_COUNTER("xmlRequests", noOfXmlRequests);
-  }
-
-  if (noOfJsonRequests != -1)
-  {
-    out += TAG_ADD_COUNTER("jsonRequests", noOfJsonRequests);
-  }
-
-  if (noOfRegistrations != -1)
-  {
-    out += TAG_ADD_COUNTER("registrations", noOfRegistrations);
-  }
-
-  if (noOfRegistrationUpdates != -1)
-  {
-    out += TAG_ADD_COUNTER("registrationUpdates", noOfRegistrationUpdates);
-  }
-
-  if (noOfDiscoveries != -1)
-  {
-    out += TAG_ADD_COUNTER("discoveries", noOfDiscoveries);
-  }
-
-  if (noOfAvailabilitySubscriptions != -1)
-  {
-    out += TAG_ADD_COUNTER("availabilitySubscriptions", noOfAvailabilitySubscriptions);
-  }
-
-  if (noOfAvailabilitySubscriptionUpdates != -1)
-  {
-    out += TAG_ADD_COUNTER("availabilitySubscriptionUpdates", noOfAvailabilitySubscriptionUpdates);
-  }
-
-  if (noOfAvailabilityUnsubscriptions != -1)
-  {
-    out += TAG_ADD_COUNTER("availabilityUnsubscriptions", noOfAvailabilityUnsubscriptions);
-  }
-
-  if (noOfAvailabilityNotificationsReceived != -1)
-  {
-    out += TAG_ADD_COUNTER("availabilityNotificationsReceived", noOfAvailabilityNotificationsReceived);
-  }
-
-  if (noOfQueries != -1)
-  {
-    out += TAG_ADD_COUNTER("queries", noOfQueries);
-  }
-
-  if (noOfUpdates != -1)
-  {
-    out += TAG_ADD_COUNTER("updates", noOfUpdates);
-  }
-
-  if (noOfSubscriptions != -1)
-  {
-    out += TAG_ADD_COUNTER("subscriptions", noOfSubscriptions);
-  }
-
-  if (noOfSubscriptionUpdates != -1)
-  {
-    out += TAG_ADD_COUNTER("subscriptionUpdates", noOfSubscriptionUpdates);
-  }
-
-  if (noOfUnsubscriptions != -1)
-  {
-    out += TAG_ADD_COUNTER("unsubscriptions", noOfUnsubscriptions);
-  }
-
-  if (noOfNotificationsReceived != -1)
-  {
-    out += TAG_ADD_COUNTER("notificationsReceived", noOfNotificationsReceived);
-  }
+  RequestType  request;
+  const char*  tag;
+} RequestCounterTag;
 
-  if (noOfQueryContextResponses != -1)
-  {
-    out += TAG_ADD_COUNTER("queryResponsesReceived", noOfQueryContextResponses);
-  }
-
-  if (noOfUpdateContextResponses != -1)
-  {
-    out += TAG_ADD_COUNTER("updateResponsesReceived", noOfUpdateContextResponses);
-  }
-
-  if (noOfQueryContextResponses != -1)
-  {
-    out += TAG_ADD_COUNTER("queryResponsesReceived", noOfQueryContextResponses);
-  }
-
-  if (noOfUpdateContextResponses != -1)
-  {
-    out += TAG_ADD_COUNTER("updateResponsesReceived", noOfUpdateContextResponses);
-  }
 
-  if (noOfContextEntitiesByEntityId != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntitiesByEntityId", noOfContextEntitiesByEntityId);
-  }
 
-  if (noOfContextEntityAttributes != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntityAttributes", noOfContextEntityAttributes);
-  }
+/* ****************************************************************************
+*
+* requestCounterTagV - the request counters, in the order of the response
+*/
+static const RequestCounterTag requestCounterTagV[] =
+{
+  { RegisterContext,                                "registrations"                                 },
+  { DiscoverContextAvailability,                    "discoveries"                                   },
+  { SubscribeContextAvailability,                   "availabilitySubscriptions"                     },
+  { UpdateContextAvailabilitySubscription,          "availabilitySubscriptionUpdates"               },
+  { UnsubscribeContextAvailability,                 "availabilityUnsubscriptions"                   },
+  { NotifyContextAvailability,                      "availabilityNotificationsReceived"             },
+  { QueryContext,                                   "queries"                                       },
+  { UpdateContext,                                  "updates"                                       },
+  { SubscribeContext,                               "subscriptions"                                 },
+  { UpdateContextSubscription,                      "subscriptionUpdates"                           },
+  { UnsubscribeContext,                             "unsubscriptions"                               },
+  { NotifyContext,                                  "notificationsReceived"                         },
+  { RtQueryContextResponse,                         "queryResponsesReceived"                        },
+  { RtUpdateContextResponse,                        "updateResponsesReceived"                       },
+  { ContextEntitiesByEntityId,                      "contextEntitiesByEntityId"                     },
+  { ContextEntityAttributes,                        "contextEntityAttributes"                       },
+  { EntityByIdAttributeByName,                      "entityByIdAttributeByName"                     },
+  { ContextEntityTypes,                             "contextEntityTypes"                            },
+  { ContextEntityTypeAttributeContainer,            "contextEntityTypeAttributeContainer"           },
+  { ContextEntityTypeAttribute,                     "contextEntityTypeAttribute"                    },
+  { IndividualContextEntity,                        "individualContextEntity"                       },
+  { IndividualContextEntityAttributes,              "individualContextEntityAttributes"             },
+  { IndividualContextEntityAttribute,               "individualContextEntityAttribute"              },
+  { UpdateContextElement,                           "updateContextElement"                          },
+  { AppendContextElement,                           "appendContextElement"                          },
+  { UpdateContextAttribute,                         "updateContextAttribute"                        },
+  { Ngsi10ContextEntityTypes,                       "contextEntityTypesNgsi10"                      },
+  { Ngsi10ContextEntityTypesAttributeContainer,     "contextEntityTypeAttributeContainerNgsi10"     },
+  { Ngsi10ContextEntityTypesAttribute,              "contextEntityTypeAttributeNgsi10"              },
+  { Ngsi10SubscriptionsConvOp,                      "subscriptionsNgsi10ConvOp"                     },
+  { AllContextEntities,                             "allContextEntitiesRequests"                    },
+  { AllEntitiesWithTypeAndId,                       "allContextEntitiesWithTypeAndIdRequests"       },
+  { IndividualContextEntityAttributeWithTypeAndId,  "individualContextEntityAttributeWithTypeAndId" },
+  { AttributeValueInstanceWithTypeAndId,            "attributeValueInstanceWithTypeAndId"           },
+  { ContextEntitiesByEntityIdAndType,               "contextEntitiesByEntityIdAndType"              },
+  { EntityByIdAttributeByNameIdAndType,             "entityByIdAttributeByNameIdAndType"            },
+  { LogRequest,                                     "logRequests"                                   },
+  { VersionRequest,                                 "versionRequests"                               },
+  { ExitRequest,                                    "exitRequests"                                  },
+  { LeakRequest,                                    "leakRequests"                                  },
+  { StatisticsRequest,                              "statisticsRequests"                            },
+  { MetricsRequest,                                 "metricsRequests"                               },
+  { IndexesRequest,                                 "indexesRequests"                               },
+  { InvalidRequest,                                 "invalidRequests"                               },
+  { RegisterResponse,                               "registerResponses"                             }
+};
 
-  if (noOfEntityByIdAttributeByName != -1)
-  {
-    out += TAG_ADD_COUNTER("entityByIdAttributeByName", noOfEntityByIdAttributeByName);
-  }
 
-  if (noOfContextEntityTypes != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntityTypes", noOfContextEntityTypes);
-  }
 
-  if (noOfContextEntityTypeAttributeContainer != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntityTypeAttributeContainer", noOfContextEntityTypeAttributeContainer);
-  }
+/* ****************************************************************************
+*
+* latencyRender - 
+*/
+static std::string latencyRender
+(
+  const std::string&       indent,
+  const std::string&       tag,
+  const LatencyHistogram&  histogram,
+  Format                   format,
+  bool                     comma
+)
+{
+  std::string  out;
+  std::string  indent2 = indent + "  ";
 
-  if (noOfContextEntityTypeAttribute != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntityTypeAttribute", noOfContextEntityTypeAttribute);
-  }
+  out += startTag(indent, tag, format);
+  out += valueTag(indent2, "count",        (int) histogram.count,                            format, true);
+  out += valueTag(indent2, "averageUsecs", (int) (histogram.sum / histogram.count),          format, true);
+  out += valueTag(indent2, "p50Usecs",     (int) latencyPercentile(&histogram, 50),          format, true);
+  out += valueTag(indent2, "p90Usecs",     (int) latencyPercentile(&histogram, 90),          format, true);
+  out += valueTag(indent2, "p99Usecs",     (int) latencyPercentile(&histogram, 99),          format, false);
+  out += endTag(indent, tag, format, comma);
 
+  return out;
+}
 
-  if (noOfIndividualContextEntity != -1)
-  {
-    out += TAG_ADD_COUNTER("individualContextEntity", noOfIndividualContextEntity);
-  }
 
-  if (noOfIndividualContextEntityAttributes != -1)
-  {
-    out += TAG_ADD_COUNTER("individualContextEntityAttributes", noOfIndividualContextEntityAttributes);
-  }
 
-  if (noOfIndividualContextEntityAttribute != -1)
-  {
-    out += TAG_ADD_COUNTER("individualContextEntityAttribute", noOfIndividualContextEntityAttribute);
-  }
+/* ****************************************************************************
+*
+* latencyTreat - latency of the requests and the mongoBackend operations measured since the last reset
+*/
+static std::string latencyTreat(ConnectionInfo* ciP, const std::string& indent)
+{
+  std::string       out;
+  std::string       indent2 = indent + "  ";
+  LatencyHistogram  histogram;
+  std::vector<int>  requestV;
+  std::vector<int>  operationV;
 
-  if (noOfUpdateContextElement != -1)
+  for (int ix = 0; ix < STATISTICS_REQUEST_TYPES; ++ix)
   {
-    out += TAG_ADD_COUNTER("updateContextElement", noOfUpdateContextElement);
+    if (statisticsLatencyGet((RequestType) ix, &histogram) == true)
+    {
+      requestV.push_back(ix);
+    }
   }
 
-  if (noOfAppendContextElement != -1)
+  for (int ix = 0; ix < BackendOperations; ++ix)
   {
-    out += TAG_ADD_COUNTER("appendContextElement", noOfAppendContextElement);
+    if (statisticsBackendLatencyGet((BackendOperation) ix, &histogram) == true)
+    {
+      operationV.push_back(ix);
+    }
   }
 
-  if (noOfUpdateContextAttribute != -1)
+  if (!requestV.empty())
   {
-    out += TAG_ADD_COUNTER("updateContextAttribute", noOfUpdateContextAttribute);
+    out += startTag(indent, "requestLatency", ciP->outFormat);
+    for (unsigned int ix = 0; ix < requestV.size(); ++ix)
+    {
+      statisticsLatencyGet((RequestType) requestV[ix], &histogram);
+      out += latencyRender(indent2, requestType((RequestType) requestV[ix]), histogram, ciP->outFormat, ix != requestV.size() - 1);
+    }
+    out += endTag(indent, "requestLatency", ciP->outFormat, true);
   }
 
-
-  if (noOfNgsi10ContextEntityTypes != -1)
+  if (!operationV.empty())
   {
-    out += TAG_ADD_COUNTER("contextEntityTypesNgsi10", noOfNgsi10ContextEntityTypes);
+    out += startTag(indent, "backendLatency", ciP->outFormat);
+    for (unsigned int ix = 0; ix < operationV.size(); ++ix)
+    {
+      statisticsBackendLatencyGet((BackendOperation) operationV[ix], &histogram);
+      out += latencyRender(indent2, backendOperationName((BackendOperation) operationV[ix]), histogram, ciP->outFormat, ix != operationV.size() - 1);
+    }
+    out += endTag(indent, "backendLatency", ciP->outFormat, true);
   }
 
-  if (noOfNgsi10ContextEntityTypesAttributeContainer != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntityTypeAttributeContainerNgsi10", noOfNgsi10ContextEntityTypesAttributeContainer);
-  }
+  return out;
+}
 
-  if (noOfNgsi10ContextEntityTypesAttribute != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntityTypeAttributeNgsi10", noOfNgsi10ContextEntityTypesAttribute);
-  }
 
-  if (noOfNgsi10SubscriptionsConvOp != -1)
-  {
-    out += TAG_ADD_COUNTER("subscriptionsNgsi10ConvOp", noOfNgsi10SubscriptionsConvOp);
-  }
 
+/* ****************************************************************************
+*
+* statisticsTreat - 
+*
+* The latency of the requests and of the mongoBackend operations is included with
+* the URI parameter 'latency=on'.
+*/
+std::string statisticsTreat
+(
+  ConnectionInfo*            ciP,
+  int                        components,
+  std::vector<std::string>&  compV,
+  ParseData*                 parseDataP
+)
+{
+  std::string out     = "";
+  std::string tag     = "orion";
+  std::string indent  = "";
+  std::string indent2 = (ciP->outFormat == JSON)? indent + "    " : indent + "  ";
 
-  if (noOfAllContextEntitiesRequests != -1)
+  if (ciP->method == "DELETE")
   {
-    out += TAG_ADD_COUNTER("allContextEntitiesRequests", noOfAllContextEntitiesRequests);
-  }
+    statisticsReset();
 
-  if (noOfAllEntitiesWithTypeAndIdRequests != -1)
-  {
-    out += TAG_ADD_COUNTER("allContextEntitiesWithTypeAndIdRequests", noOfAllEntitiesWithTypeAndIdRequests);
-  }
+    semTimeReqReset();
+    semTimeEntityReset();
+    mongoPoolConnectionSemWaitingTimeReset();
+    mutexTimeCCReset();
+    senderThreadPoolStatisticsReset();
+    httpRequestAsyncStatisticsReset();
 
-  if (noOfIndividualContextEntityAttributeWithTypeAndId != -1)
-  {
-    out += TAG_ADD_COUNTER("individualContextEntityAttributeWithTypeAndId", noOfIndividualContextEntityAttributeWithTypeAndId);
+    out += startTag(indent, tag, ciP->outFormat, true, true);
+    out += valueTag(indent2, "message", "All statistics counter reset", ciP->outFormat);
+    indent2 = (ciP->outFormat == JSON)? indent + "  " : indent;
+    out += endTag(indent2, tag, ciP->outFormat, false, false, true, true);
+    return out;
   }
 
-  if (noOfAttributeValueInstanceWithTypeAndId != -1)
-  {
-    out += TAG_ADD_COUNTER("attributeValueInstanceWithTypeAndId", noOfAttributeValueInstanceWithTypeAndId);
-  }
+  out += startTag(indent, tag, ciP->outFormat, true, true);
 
-  if (noOfContextEntitiesByEntityIdAndType != -1)
-  {
-    out += TAG_ADD_COUNTER("contextEntitiesByEntityIdAndType", noOfContextEntitiesByEntityIdAndType);
-  }
+  unsigned long counter;
 
-  if (noOfEntityByIdAttributeByNameIdAndType != -1)
+  if ((counter = statisticsCounterGet(StatXmlRequests)) != 0)
   {
-    out += TAG_ADD_COUNTER("entityByIdAttributeByNameIdAndType", noOfEntityByIdAttributeByNameIdAndType);
+    out += TAG_ADD_COUNTER("xmlRequests", counter);
   }
 
-  if (noOfLogRequests != -1)
+  if ((counter = statisticsCounterGet(StatJsonRequests)) != 0)
   {
-    out += TAG_ADD_COUNTER("logRequests", noOfLogRequests);
+    out += TAG_ADD_COUNTER("jsonRequests", counter);
   }
 
-  if (noOfVersionRequests != -1)
+  for (unsigned int ix = 0; ix < sizeof(requestCounterTagV) / sizeof(requestCounterTagV[0]); ++ix)
   {
-    out += TAG_ADD_COUNTER("versionRequests", noOfVersionRequests);
+    if ((counter = statisticsRequestsGet(requestCounterTagV[ix].request)) != 0)
+    {
+      out += TAG_ADD_COUNTER(requestCounterTagV[ix].tag, counter);
+    }
   }
 
-  if (noOfExitRequests != -1)
+  if ((counter = statisticsCounterGet(StatRegistrationErrors)) != 0)
   {
-    out += TAG_ADD_COUNTER("exitRequests", noOfExitRequests);
+    out += TAG_ADD_COUNTER("registrationErrors", counter);
   }
 
-  if (noOfLeakRequests != -1)
+  if ((counter = statisticsCounterGet(StatRegistrationUpdateErrors)) != 0)
   {
-    out += TAG_ADD_COUNTER("leakRequests", noOfLeakRequests);
+    out += TAG_ADD_COUNTER("registrationUpdateErrors", counter);
   }
 
-  if (noOfStatisticsRequests != -1)
+  if ((counter = statisticsCounterGet(StatDiscoveryErrors)) != 0)
   {
-    out += TAG_ADD_COUNTER("statisticsRequests", noOfStatisticsRequests);
+    out += TAG_ADD_COUNTER("discoveryErrors", counter);
   }
 
-  if (noOfInvalidRequests != -1)
+  if (strcasecmp(ciP->uriParam[URI_PARAM_STATISTICS_LATENCY].c_str(), "on") == 0)
   {
-    out += TAG_ADD_COUNTER("invalidRequests", noOfInvalidRequests);
+    out += latencyTreat(ciP, indent2);
   }
 
-  if (noOfRegisterResponses != -1)
+  if (senderThreadPoolActive())
   {
-    out += TAG_ADD_COUNTER("registerResponses", noOfRegisterResponses);
-  }
+    int            depth;
+    int            maxDepth;
+    unsigned long  drops;
+    char           queueWaitingTime[64];
 
+    unsigned long  in = senderThreadPoolStatistics(&depth, &maxDepth, &drops, queueWaitingTime, sizeof(queueWaitingTime));
 
-  if (noOfRegistrationErrors != -1)
-  {
-    out += TAG_ADD_COUNTER("registrationErrors", noOfRegistrationErrors);
+    if (in != 0)
+    {
+      out += valueTag(indent2, "notificationQueueIn",          (int) in,    ciP->outFormat, true);
+      out += valueTag(indent2, "notificationQueueSize",        depth,       ciP->outFormat, true);
+      out += valueTag(indent2, "notificationQueueMaxSize",     maxDepth,    ciP->outFormat, true);
+      out += valueTag(indent2, "notificationQueueDrops",       (int) drops, ciP->outFormat, true);
+      out += TAG_ADD_STRING("notificationQueueWaitingTime", queueWaitingTime);
+    }
   }
 
-  if (noOfRegistrationUpdateErrors != -1)
+  if (httpRequestAsyncActive())
   {
-    out += TAG_ADD_COUNTER("registrationUpdateErrors", noOfRegistrationUpdateErrors);
-  }
+    int            inFlight;
+    unsigned long  drops;
+    unsigned long  in = httpRequestAsyncStatistics(&inFlight, &drops);
 
-  if (noOfDiscoveryErrors != -1)
-  {
-    out += TAG_ADD_COUNTER("discoveryErrors", noOfDiscoveryErrors);
+    if (in != 0)
+    {
+      out += valueTag(indent2, "notificationAsyncIn",       (int) in,    ciP->outFormat, true);
+      out += valueTag(indent2, "notificationAsyncInFlight", inFlight,    ciP->outFormat, true);
+      out += valueTag(indent2, "notificationAsyncDrops",    (int) drops, ciP->outFormat, true);
+    }
   }
 
   if (semTimeStatistics)
@@ -418,6 +329,55 @@ std::string statisticsTreat
     mongoPoolConnectionSemWaitingTimeGet(mongoPoolSemaphoreWaitingTime, sizeof(mongoPoolSemaphoreWaitingTime));
     out += TAG_ADD_STRING("dbConnectionPoolWaitingTime", mongoPoolSemaphoreWaitingTime);
 
+    //
+    // Histogram of the waits for a database connection, only if some request had to wait since the last reset
+    //
+    const char*  waitNameV[MONGO_POOL_WAIT_BUCKETS];
+    long         waitCountV[MONGO_POOL_WAIT_BUCKETS];
+
+    if (mongoPoolConnectionWaitsGet(waitNameV, waitCountV) != 0)
+    {
+      std::string indent3 = indent2 + "  ";
+
+      out += startTag(indent2, "dbConnectionPoolWaits", ciP->outFormat);
+      for (int ix = 0; ix < MONGO_POOL_WAIT_BUCKETS; ++ix)
+      {
+        out += valueTag(indent3, waitNameV[ix], (int) waitCountV[ix], ciP->outFormat, ix != MONGO_POOL_WAIT_BUCKETS - 1);
+      }
+      out += endTag(indent2, "dbConnectionPoolWaits", ciP->outFormat, true);
+    }
+
+    if (entitySemActive())
+    {
+      //
+      // Only the stripes that have been taken since the last reset are shown
+      //
+      std::vector<int>          stripeV;
+      std::vector<std::string>  waitingTimeV;
+      char                      stripeWaitingTime[64];
+
+      for (int ix = 0; ix < ENTITY_SEM_STRIPES; ++ix)
+      {
+        if (semTimeEntityGet(ix, stripeWaitingTime, sizeof(stripeWaitingTime)) == true)
+        {
+          stripeV.push_back(ix);
+          waitingTimeV.push_back(stripeWaitingTime);
+        }
+      }
+
+      std::string indent3 = indent2 + "  ";
+
+      out += startTag(indent2, "entitySemaphoreWaitingTime", ciP->outFormat);
+      for (unsigned int ix = 0; ix < stripeV.size(); ++ix)
+      {
+        char stripeName[32];
+
+        snprintf(stripeName, sizeof(stripeName), "stripe%d", stripeV[ix]);
+        out += valueTag(indent3, stripeName, waitingTimeV[ix], ciP->outFormat, ix != stripeV.size() - 1);
+      }
+      out += endTag(indent2, "entitySemaphoreWaitingTime", ciP->outFormat, true);
+    }
+
     char transSemaphoreWaitingTime[64];
     semTimeTransGet(transSemaphoreWaitingTime, sizeof(transSemaphoreWaitingTime));
     out += TAG_ADD_STRING("transactionSemaphoreWaitingTime", transSemaphoreWaitingTime);
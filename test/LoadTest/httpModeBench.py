@@ -0,0 +1,188 @@
+#!/usr/bin/python
+# -*- coding: latin-1 -*-
+# Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+#
+# This file is part of Orion Context Broker.
+#
+# Orion Context Broker is free software: you can redistribute it and/or
+# modify it under the terms of the GNU Affero General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# Orion Context Broker is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+# General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+#
+# For those usages not covered by this license please contact with
+# iot_support at tid dot es
+
+__author__ = 'fermin'
+
+# This program measures how a running broker copes with many idle keep-alive connections,
+# to compare the -httpMode options (thread, select, epoll). For each number of idle
+# connections it:
+#
+# * opens the idle connections (each one sends a GET /version and keeps the connection open,
+#   as an IoT agent between two updates)
+# * reads the RSS and the number of threads of the broker (from /proc, so the broker must
+#   run in the same host)
+# * sends a number of GET /version requests from a few active clients, using keep-alive
+#   connections, and measures their latency
+#
+# and prints one line with the results:
+#
+#   idle   rss(MB)   threads   req/s   p50(ms)   p99(ms)
+#
+# Usage:
+#
+#   httpModeBench.py --pid <broker pid> [--host localhost] [--port 1026] [--idle 0,1000,5000]
+#                    [--active 10] [--requests 5000]
+#
+# The number of open files of this program and of the broker (ulimit -n) must be higher than
+# the number of idle connections. Example, comparing thread and select modes:
+#
+#   contextBroker -fg -httpMode thread &
+#   httpModeBench.py --pid $! --idle 0,1000,2000,5000
+#   kill %1
+#   contextBroker -fg -httpMode select -httpThreads 10 &
+#   httpModeBench.py --pid $! --idle 0,1000,2000,5000
+
+from sys import argv, exit
+from time import sleep, time
+from threading import Thread
+from getopt import getopt, GetoptError
+import resource
+import socket
+
+try:
+    from httplib import HTTPConnection
+except ImportError:
+    from http.client import HTTPConnection
+
+
+def usage():
+    print('usage: %s --pid <broker pid> [--host <host>] [--port <port>] [--idle <n,n,...>] [--active <n>] [--requests <n>]' % argv[0])
+
+
+def broker_status(pid):
+    """RSS (in MB) and number of threads of the broker"""
+    rss     = 0
+    threads = 0
+
+    with open('/proc/%d/status' % pid) as f:
+        for line in f:
+            if line.startswith('VmRSS:'):
+                rss = int(line.split()[1]) / 1024.0
+            elif line.startswith('Threads:'):
+                threads = int(line.split()[1])
+
+    return rss, threads
+
+
+def idle_open(host, port, n):
+    """n connections that have done one request and stay open"""
+    request = 'GET /version HTTP/1.1\r\nHost: %s\r\nAccept: application/json\r\n\r\n' % host
+    sockets = []
+
+    for i in range(n):
+        s = socket.create_connection((host, port))
+        s.sendall(request.encode('ascii'))
+        sockets.append(s)
+
+    # The responses are read afterwards, so the connections are opened as fast as possible
+    for s in sockets:
+        s.settimeout(30)
+        s.recv(4096)
+
+    return sockets
+
+
+def active_client(host, port, requests, latencies):
+    connection = HTTPConnection(host, port)
+
+    for i in range(requests):
+        start = time()
+        connection.request('GET', '/version', headers={'Accept': 'application/json'})
+        connection.getresponse().read()
+        latencies.append(time() - start)
+
+    connection.close()
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+host     = 'localhost'
+port     = 1026
+pid      = None
+idleV    = [0, 1000, 5000]
+active   = 10
+requests = 5000
+
+try:
+    opts, args = getopt(argv[1:], '', ['host=', 'port=', 'pid=', 'idle=', 'active=', 'requests=', 'help'])
+except GetoptError:
+    usage()
+    exit(1)
+
+for opt, arg in opts:
+    if opt == '--host':
+        host = arg
+    elif opt == '--port':
+        port = int(arg)
+    elif opt == '--pid':
+        pid = int(arg)
+    elif opt == '--idle':
+        idleV = [int(n) for n in arg.split(',')]
+    elif opt == '--active':
+        active = int(arg)
+    elif opt == '--requests':
+        requests = int(arg)
+    else:
+        usage()
+        exit(0)
+
+if pid is None:
+    usage()
+    exit(1)
+
+# Room for the idle connections
+soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+needed     = max(idleV) + active + 100
+if soft < needed:
+    resource.setrlimit(resource.RLIMIT_NOFILE, (min(needed, hard), hard))
+
+print('%8s %10s %10s %10s %10s %10s' % ('idle', 'rss(MB)', 'threads', 'req/s', 'p50(ms)', 'p99(ms)'))
+
+for idle in idleV:
+    sockets = idle_open(host, port, idle)
+    sleep(2)
+
+    rss, threads = broker_status(pid)
+
+    latencies = []
+    clients   = []
+    start     = time()
+
+    for i in range(active):
+        clients.append(Thread(target=active_client, args=(host, port, requests // active, latencies)))
+        clients[-1].start()
+
+    for client in clients:
+        client.join()
+
+    elapsed = time() - start
+    latencies.sort()
+
+    print('%8d %10.1f %10d %10.0f %10.2f %10.2f' % (idle, rss, threads, len(latencies) / elapsed,
+                                                    percentile(latencies, 50) * 1000, percentile(latencies, 99) * 1000))
+
+    for s in sockets:
+        s.close()
+
+    sleep(2)
@@ -0,0 +1,310 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "common/Arena.h"
+#include "ngsi/ContextElementVector.h"
+
+
+
+/* ****************************************************************************
+*
+* BENCHMARK_ELEMENTS - context elements of the graph of the benchmark
+* BENCHMARK_ATTRS    - attributes per context element
+* BENCHMARK_METADATA - metadata per attribute
+*/
+#define BENCHMARK_ELEMENTS  1000
+#define BENCHMARK_ATTRS     10
+#define BENCHMARK_METADATA  2
+
+
+
+/* ****************************************************************************
+*
+* Allocation counting -
+*
+* malloc, calloc and realloc of the whole unit test binary go through these functions,
+* which count the calls of the thread that has set mallocCount. Operator new, the strings
+* and vectors of the objects and the arena blocks all end up in malloc, so the benchmark
+* sees every heap allocation of the graph, not only its nodes.
+*/
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t nmemb, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static __thread bool  mallocCount = false;
+static __thread int   mallocs     = 0;
+
+extern "C" void* malloc(size_t size)
+{
+  if (mallocCount)
+  {
+    ++mallocs;
+  }
+
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t nmemb, size_t size)
+{
+  if (mallocCount)
+  {
+    ++mallocs;
+  }
+
+  return __libc_calloc(nmemb, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+  if (mallocCount)
+  {
+    ++mallocs;
+  }
+
+  return __libc_realloc(ptr, size);
+}
+
+
+
+/* ****************************************************************************
+*
+* mallocsGet - heap allocations of the calling thread while running 'function'
+*/
+static int mallocsGet(long long (*function)(void), long long* resultP)
+{
+  mallocs     = 0;
+  mallocCount = true;
+  *resultP    = function();
+  mallocCount = false;
+
+  return mallocs;
+}
+
+
+
+/* ****************************************************************************
+*
+* usecsGet -
+*/
+static long long usecsGet(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (long long) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+/* ****************************************************************************
+*
+* graphBuildAndRelease - the object graph of a big updateContext, as the parsers build it
+*
+* Returns the number of objects created (the heap allocations of these objects, without
+* an arena).
+*/
+static long long graphBuildAndRelease(void)
+{
+  ContextElementVector  ceV;
+  long long             objects = 0;
+
+  for (int ceIx = 0; ceIx < BENCHMARK_ELEMENTS; ++ceIx)
+  {
+    ContextElement* ceP = new ContextElement();
+
+    ++objects;
+    for (int aIx = 0; aIx < BENCHMARK_ATTRS; ++aIx)
+    {
+      ContextAttribute* caP = new ContextAttribute("temperature", "float", std::string("23.5"));
+
+      ++objects;
+      for (int mIx = 0; mIx < BENCHMARK_METADATA; ++mIx)
+      {
+        caP->metadataVector.push_back(new Metadata("accuracy", "float", std::string("0.1")));
+        ++objects;
+      }
+
+      ceP->contextAttributeVector.push_back(caP);
+    }
+
+    ceV.push_back(ceP);
+  }
+
+  ceV.release();
+
+  return objects;
+}
+
+
+
+/* ****************************************************************************
+*
+* allocate -
+*/
+TEST(commonArena, allocate)
+{
+  Arena  arena;
+  char*  p1 = (char*) arena.allocate(1);
+  char*  p2 = (char*) arena.allocate(100);
+  char*  p3 = (char*) arena.allocate(ARENA_BLOCK_SIZE);
+
+  EXPECT_TRUE(p1 != NULL);
+  EXPECT_TRUE(p2 != NULL);
+  EXPECT_TRUE(p3 != NULL);
+  EXPECT_EQ(0, (intptr_t) p1 % 16);
+  EXPECT_EQ(0, (intptr_t) p2 % 16);
+  EXPECT_EQ(16, p2 - p1);
+
+  /* The big object got a block of its own, the small ones still share the first one */
+  EXPECT_EQ(2, arena.blocks());
+  EXPECT_EQ(p2 + 112, arena.allocate(16));
+  EXPECT_EQ(2, arena.blocks());
+  EXPECT_EQ(4, arena.allocations());
+
+  arena.reset();
+  EXPECT_EQ(0, arena.blocks());
+  EXPECT_EQ(0, arena.allocations());
+}
+
+
+
+/* ****************************************************************************
+*
+* full - beyond ARENA_MAX_SIZE the arena doesn't allocate anymore
+*/
+TEST(commonArena, full)
+{
+  Arena arena;
+
+  EXPECT_TRUE(arena.allocate(ARENA_MAX_SIZE) != NULL);
+  EXPECT_TRUE(arena.allocate(16) == NULL);
+
+  /* Objects are allocated in the heap then */
+  Arena*    prevArenaP = arenaActivate(&arena);
+  Metadata* mP         = new Metadata("m", "t", std::string("v"));
+
+  arenaActivate(prevArenaP);
+
+  EXPECT_EQ(1, arena.allocations());
+  EXPECT_EQ("v", mP->stringValue);
+  delete mP;
+}
+
+
+
+/* ****************************************************************************
+*
+* objects - objects created while an arena is active are allocated in it
+*/
+TEST(commonArena, objects)
+{
+  Arena  arena;
+  Arena* prevArenaP = arenaActivate(&arena);
+
+  EntityId* enP = new EntityId("E1", "T1", "false");
+  delete enP;
+
+  EXPECT_EQ(1, arena.allocations());
+  EXPECT_EQ(&arena, arenaActivate(prevArenaP));
+
+  /* Without arena, from the heap */
+  enP = new EntityId("E1", "T1", "false");
+  delete enP;
+  EXPECT_EQ(1, arena.allocations());
+}
+
+
+
+/* ****************************************************************************
+*
+* arenaGraphBuildAndRelease - graphBuildAndRelease in an arena, freed at the end
+*
+* Returns the number of objects allocated in the arena (the blocks it took in arenaBlocks).
+*/
+static int arenaBlocks = 0;
+
+static long long arenaGraphBuildAndRelease(void)
+{
+  Arena      arena;
+  Arena*     prevArenaP = arenaActivate(&arena);
+  long long  allocations;
+
+  graphBuildAndRelease();
+  allocations = arena.allocations();
+  arenaBlocks = arena.blocks();
+  arena.reset();
+
+  arenaActivate(prevArenaP);
+
+  return allocations;
+}
+
+
+
+/* ****************************************************************************
+*
+* benchmark - heap allocations of a big request graph, with and without arena
+*
+* The mallocs include those of the strings and vectors inside the objects, which still
+* come from the heap with an arena: only the nodes themselves go to the arena blocks.
+*/
+TEST(commonArena, benchmark)
+{
+  long long  start;
+  long long  heapUsecs;
+  long long  arenaUsecs;
+  long long  objects;
+  long long  arenaAllocations;
+  int        heapMallocs;
+  int        arenaMallocs;
+
+  start       = usecsGet();
+  heapMallocs = mallocsGet(graphBuildAndRelease, &objects);
+  heapUsecs   = usecsGet() - start;
+
+  start        = usecsGet();
+  arenaMallocs = mallocsGet(arenaGraphBuildAndRelease, &arenaAllocations);
+  arenaUsecs   = usecsGet() - start;
+
+  EXPECT_EQ(BENCHMARK_ELEMENTS * (1 + BENCHMARK_ATTRS * (1 + BENCHMARK_METADATA)), objects);
+  EXPECT_EQ(objects, arenaAllocations);
+
+  /* Each node was a malloc of its own, in the arena they share a few blocks */
+  EXPECT_EQ(heapMallocs - objects + arenaBlocks, arenaMallocs);
+  EXPECT_LT(arenaBlocks * 10, objects);
+
+  RecordProperty("objects",       (int) objects);
+  RecordProperty("heapMallocs",   heapMallocs);
+  RecordProperty("arenaMallocs",  arenaMallocs);
+  RecordProperty("arenaBlocks",   arenaBlocks);
+  RecordProperty("heapUsecs",     (int) heapUsecs);
+  RecordProperty("arenaUsecs",    (int) arenaUsecs);
+}
@@ -22,6 +22,12 @@
 *
 * Author: Ken Zangelin
 */
+#include <pthread.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
@@ -250,3 +256,59 @@ TEST(commonGlobals, getCurrentTime)
   EXPECT_TRUE(now != -1);
   utExit();
 }
+
+
+
+/* ****************************************************************************
+*
+* transactionIdThread - 
+*/
+#define TRANSACTIONS_PER_THREAD  1000
+
+static void* transactionIdThread(void* vP)
+{
+  std::vector<std::string>* idV = (std::vector<std::string>*) vP;
+
+  for (int ix = 0; ix < TRANSACTIONS_PER_THREAD; ++ix)
+  {
+    transactionIdSet();
+    idV->push_back(transactionId);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* transactionIdSet - unique ids, in the <sec>-<msec>-<counter> format, from concurrent threads
+*/
+TEST(commonGlobals, transactionIdSet)
+{
+  const int                 threads = 8;
+  pthread_t                 tid[threads];
+  std::vector<std::string>  idV[threads];
+  std::set<std::string>     idSet;
+
+  for (int ix = 0; ix < threads; ++ix)
+  {
+    pthread_create(&tid[ix], NULL, transactionIdThread, &idV[ix]);
+  }
+
+  for (int ix = 0; ix < threads; ++ix)
+  {
+    pthread_join(tid[ix], NULL);
+    idSet.insert(idV[ix].begin(), idV[ix].end());
+  }
+
+  EXPECT_EQ(threads * TRANSACTIONS_PER_THREAD, idSet.size());
+
+  unsigned long  secs;
+  int            msecs;
+  int            counter;
+  char           end;
+
+  EXPECT_EQ(3, sscanf(idV[0][0].c_str(), "%lu-%03d-%011d%c", &secs, &msecs, &counter, &end));
+  EXPECT_EQ(16, idV[0][0].length() - idV[0][0].find('-'));
+}
@@ -22,6 +22,8 @@
 *
 * Author: Ken Zangelin
 */
+#include <unistd.h>
+
 #include "gtest/gtest.h"
 
 #include "logMsg/logMsg.h"
@@ -56,3 +58,119 @@ TEST(commonSem, unique)
    EXPECT_EQ(0, s);
    EXPECT_TRUE(taken);
 }
+
+
+
+/* ****************************************************************************
+*
+* entitySem - 
+*
+* Same entity (whatever the type) must always map to the same stripe, and without
+* the 'entity' policy the entity semaphores are never taken.
+*/
+TEST(commonSem, entitySem)
+{
+   int s;
+   int stripe1;
+   int stripe2;
+
+   s = semInit(SemReadWriteOp);
+   EXPECT_EQ(0, s);
+
+   s = entitySemTake(__FUNCTION__, "tenant", "/a/b", "E1", &stripe1);
+   EXPECT_EQ(0, s);
+   EXPECT_EQ(-1, stripe1);
+   EXPECT_EQ(0, entitySemGive(__FUNCTION__, stripe1));
+   EXPECT_FALSE(entitySemActive());
+
+   s = semInit(SemEntityOp);
+   EXPECT_EQ(0, s);
+   EXPECT_TRUE(entitySemActive());
+
+   s = entitySemTake(__FUNCTION__, "tenant", "/a/b", "E1", &stripe1);
+   EXPECT_EQ(0, s);
+   EXPECT_TRUE((stripe1 >= 0) && (stripe1 < ENTITY_SEM_STRIPES));
+   EXPECT_EQ(0, entitySemGive(__FUNCTION__, stripe1));
+
+   s = entitySemTake(__FUNCTION__, "tenant", "/a/b", "E1", &stripe2);
+   EXPECT_EQ(0, s);
+   EXPECT_EQ(stripe1, stripe2);
+   EXPECT_EQ(0, entitySemGive(__FUNCTION__, stripe2));
+
+   char buf[64];
+   EXPECT_TRUE(semTimeEntityGet(stripe1, buf, sizeof(buf)));
+   semTimeEntityReset();
+   EXPECT_FALSE(semTimeEntityGet(stripe1, buf, sizeof(buf)));
+
+   // The global 'req' semaphore is not used with the 'entity' policy
+   bool taken;
+   reqSemTake(__FUNCTION__, "test", SemReadWriteOp, &taken);
+   EXPECT_FALSE(taken);
+
+   semInit();
+}
+
+
+
+/* ****************************************************************************
+*
+* curlContextPool - 
+*
+* Up to the pool size, handles to the same destination are different, and released
+* handles are reused.
+*/
+TEST(commonSem, curlContextPool)
+{
+   struct curl_context cc1;
+   struct curl_context cc2;
+   struct curl_context cc3;
+
+   curl_context_pool_set(2, 0);
+
+   EXPECT_EQ(0, get_curl_context("10.0.0.1", &cc1));
+   EXPECT_EQ(0, get_curl_context("10.0.0.1", &cc2));
+   ASSERT_TRUE(cc1.curl != NULL);
+   ASSERT_TRUE(cc2.curl != NULL);
+   EXPECT_TRUE(cc1.curl != cc2.curl);
+
+   CURL* curl2 = cc2.curl;
+   EXPECT_EQ(0, release_curl_context(&cc2));
+   EXPECT_TRUE(cc2.curl == NULL);
+
+   EXPECT_EQ(0, get_curl_context("10.0.0.1", &cc3));
+   EXPECT_TRUE(cc3.curl == curl2);
+
+   EXPECT_EQ(0, release_curl_context(&cc3));
+   EXPECT_EQ(0, release_curl_context(&cc1));
+
+   curl_context_pool_set(1, 0);
+}
+
+
+
+/* ****************************************************************************
+*
+* curlContextPoolExpire -
+*
+* Idle handles are cleaned up after the idle timeout also in the pools of
+* destinations not used any more
+*/
+TEST(commonSem, curlContextPoolExpire)
+{
+   struct curl_context cc;
+
+   curl_context_pool_set(1, 1);
+
+   EXPECT_EQ(0, get_curl_context("10.0.0.2", &cc));
+   EXPECT_EQ(0, release_curl_context(&cc));
+   EXPECT_EQ(1, curl_context_idle_count("10.0.0.2"));
+
+   sleep(3);
+
+   EXPECT_EQ(0, get_curl_context("10.0.0.3", &cc));
+   EXPECT_EQ(0, curl_context_idle_count("10.0.0.2"));
+   EXPECT_EQ(0, release_curl_context(&cc));
+   EXPECT_EQ(1, curl_context_idle_count("10.0.0.3"));
+
+   curl_context_pool_set(1, 0);
+}
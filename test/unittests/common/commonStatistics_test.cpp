@@ -22,6 +22,8 @@
 *
 * Author: Ken Zangelin
 */
+#include <pthread.h>
+
 #include "gtest/gtest.h"
 
 #include "logMsg/logMsg.h"
@@ -37,50 +39,7 @@
 */
 TEST(commonStatistics, statisticsUpdate)
 {
-  noOfRegistrations                          = 0;
-  noOfDiscoveries                            = 0;
-  noOfAvailabilitySubscriptions              = 0;
-  noOfAvailabilityUnsubscriptions            = 0;
-  noOfAvailabilitySubscriptionUpdates        = 0;
-  noOfAvailabilityNotificationsReceived      = 0;
-  noOfQueries                                = 0;
-  noOfUpdates                                = 0;
-  noOfSubscriptions                          = 0;
-  noOfSubscriptionUpdates                    = 0;
-  noOfUnsubscriptions                        = 0;
-  noOfNotificationsReceived                  = 0;
-  noOfQueryContextResponses                  = 0;
-  noOfUpdateContextResponses                 = 0;
-
-  noOfContextEntitiesByEntityId              = 0;
-  noOfContextEntityAttributes                = 0;
-  noOfEntityByIdAttributeByName              = 0;
-  noOfIndividualContextEntity                = 0;
-  noOfIndividualContextEntityAttributes      = 0;
-  noOfIndividualContextEntityAttribute       = 0;
-  noOfUpdateContextElement                   = 0;
-  noOfAppendContextElement                   = 0;
-  noOfUpdateContextAttribute                 = 0;
-  noOfNgsi10ContextEntityTypes               = 0;
-  noOfNgsi10ContextEntityTypesAttributeContainer = 0;
-  noOfNgsi10ContextEntityTypesAttribute      = 0;
-  noOfNgsi10SubscriptionsConvOp              = 0;
-  noOfLogRequests                            = 0;
-  noOfVersionRequests                        = 0;
-  noOfExitRequests                           = 0;
-  noOfLeakRequests                           = 0;
-  noOfStatisticsRequests                     = 0;
-  noOfInvalidRequests                        = 0;
-  noOfRegisterResponses                      = 0;
-  noOfXmlRequests                            = 0;
-  noOfJsonRequests                           = 0;
-
-  noOfRtSubscribeContextAvailabilityResponse          = 0;
-  noOfRtUpdateContextAvailabilitySubscriptionResponse = 0;
-  noOfRtUnsubscribeContextAvailabilityResponse        = 0;
-  noOfRtUnsubscribeContextResponse                    = 0;
-  noOfRtSubscribeResponse                             = 0;
-  noOfRtSubscribeError                                = 0;
+  statisticsReset();
 
   statisticsUpdate(RegisterContext, XML);
   statisticsUpdate(DiscoverContextAvailability, JSON);
@@ -125,48 +84,155 @@ TEST(commonStatistics, statisticsUpdate)
   statisticsUpdate(RtSubscribeResponse, JSON);
   statisticsUpdate(RtSubscribeError, XML);
 
-  EXPECT_EQ(1, noOfRegistrations);
-  EXPECT_EQ(1, noOfDiscoveries);
-  EXPECT_EQ(1, noOfAvailabilitySubscriptions);
-  EXPECT_EQ(1, noOfAvailabilityUnsubscriptions);
-  EXPECT_EQ(1, noOfAvailabilitySubscriptionUpdates);
-  EXPECT_EQ(1, noOfAvailabilityNotificationsReceived);
-  EXPECT_EQ(1, noOfQueries);
-  EXPECT_EQ(1, noOfUpdates);
-  EXPECT_EQ(1, noOfSubscriptions);
-  EXPECT_EQ(1, noOfSubscriptionUpdates);
-  EXPECT_EQ(1, noOfUnsubscriptions);
-  EXPECT_EQ(1, noOfNotificationsReceived);
-  EXPECT_EQ(1, noOfQueryContextResponses);
-  EXPECT_EQ(1, noOfUpdateContextResponses);
-  
-  EXPECT_EQ(1, noOfContextEntitiesByEntityId);
-  EXPECT_EQ(1, noOfContextEntityAttributes);
-  EXPECT_EQ(1, noOfEntityByIdAttributeByName);
-  EXPECT_EQ(1, noOfIndividualContextEntity);
-  EXPECT_EQ(1, noOfIndividualContextEntityAttributes);
-  EXPECT_EQ(1, noOfIndividualContextEntityAttribute);
-  EXPECT_EQ(1, noOfUpdateContextElement);
-  EXPECT_EQ(1, noOfAppendContextElement);
-  EXPECT_EQ(1, noOfUpdateContextAttribute);
-  EXPECT_EQ(1, noOfNgsi10ContextEntityTypes);
-  EXPECT_EQ(1, noOfNgsi10ContextEntityTypesAttributeContainer);
-  EXPECT_EQ(1, noOfNgsi10ContextEntityTypesAttribute);
-  EXPECT_EQ(1, noOfNgsi10SubscriptionsConvOp);
-  EXPECT_EQ(1, noOfLogRequests);
-  EXPECT_EQ(1, noOfVersionRequests);
-  EXPECT_EQ(1, noOfExitRequests);
-  EXPECT_EQ(1, noOfLeakRequests);
-  EXPECT_EQ(1, noOfStatisticsRequests);
-  EXPECT_EQ(1, noOfInvalidRequests);
-  EXPECT_EQ(1, noOfRegisterResponses);
-  EXPECT_EQ(1, noOfRtSubscribeContextAvailabilityResponse);
-  EXPECT_EQ(1, noOfRtUpdateContextAvailabilitySubscriptionResponse);
-  EXPECT_EQ(1, noOfRtUnsubscribeContextAvailabilityResponse);
-  EXPECT_EQ(1, noOfRtUnsubscribeContextResponse);
-  EXPECT_EQ(1, noOfRtSubscribeResponse);
-  EXPECT_EQ(1, noOfRtSubscribeError);
-
-  EXPECT_EQ(20, noOfXmlRequests);
-  EXPECT_EQ(21, noOfJsonRequests);
+  EXPECT_EQ(1, statisticsRequestsGet(RegisterContext));
+  EXPECT_EQ(1, statisticsRequestsGet(DiscoverContextAvailability));
+  EXPECT_EQ(1, statisticsRequestsGet(SubscribeContextAvailability));
+  EXPECT_EQ(1, statisticsRequestsGet(UpdateContextAvailabilitySubscription));
+  EXPECT_EQ(1, statisticsRequestsGet(UnsubscribeContextAvailability));
+  EXPECT_EQ(1, statisticsRequestsGet(NotifyContextAvailability));
+  EXPECT_EQ(1, statisticsRequestsGet(QueryContext));
+  EXPECT_EQ(1, statisticsRequestsGet(SubscribeContext));
+  EXPECT_EQ(1, statisticsRequestsGet(UpdateContextSubscription));
+  EXPECT_EQ(1, statisticsRequestsGet(UnsubscribeContext));
+  EXPECT_EQ(1, statisticsRequestsGet(NotifyContext));
+  EXPECT_EQ(1, statisticsRequestsGet(UpdateContext));
+  EXPECT_EQ(1, statisticsRequestsGet(RtQueryContextResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(RtUpdateContextResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(ContextEntitiesByEntityId));
+  EXPECT_EQ(1, statisticsRequestsGet(ContextEntityAttributes));
+  EXPECT_EQ(1, statisticsRequestsGet(EntityByIdAttributeByName));
+  EXPECT_EQ(1, statisticsRequestsGet(IndividualContextEntity));
+  EXPECT_EQ(1, statisticsRequestsGet(IndividualContextEntityAttributes));
+  EXPECT_EQ(1, statisticsRequestsGet(AttributeValueInstance));
+  EXPECT_EQ(1, statisticsRequestsGet(IndividualContextEntityAttribute));
+  EXPECT_EQ(1, statisticsRequestsGet(UpdateContextElement));
+  EXPECT_EQ(1, statisticsRequestsGet(AppendContextElement));
+  EXPECT_EQ(1, statisticsRequestsGet(UpdateContextAttribute));
+  EXPECT_EQ(1, statisticsRequestsGet(Ngsi10ContextEntityTypes));
+  EXPECT_EQ(1, statisticsRequestsGet(Ngsi10ContextEntityTypesAttributeContainer));
+  EXPECT_EQ(1, statisticsRequestsGet(Ngsi10ContextEntityTypesAttribute));
+  EXPECT_EQ(1, statisticsRequestsGet(Ngsi10SubscriptionsConvOp));
+  EXPECT_EQ(1, statisticsRequestsGet(LogRequest));
+  EXPECT_EQ(1, statisticsRequestsGet(VersionRequest));
+  EXPECT_EQ(1, statisticsRequestsGet(ExitRequest));
+  EXPECT_EQ(1, statisticsRequestsGet(LeakRequest));
+  EXPECT_EQ(1, statisticsRequestsGet(StatisticsRequest));
+  EXPECT_EQ(1, statisticsRequestsGet(InvalidRequest));
+  EXPECT_EQ(1, statisticsRequestsGet(RegisterResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(RtSubscribeContextAvailabilityResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(RtUpdateContextAvailabilitySubscriptionResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(RtUnsubscribeContextAvailabilityResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(RtUnsubscribeContextResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(RtSubscribeResponse));
+  EXPECT_EQ(1, statisticsRequestsGet(RtSubscribeError));
+
+  EXPECT_EQ(20, statisticsCounterGet(StatXmlRequests));
+  EXPECT_EQ(21, statisticsCounterGet(StatJsonRequests));
+
+  statisticsReset();
+  EXPECT_EQ(0, statisticsRequestsGet(QueryContext));
+  EXPECT_EQ(0, statisticsCounterGet(StatXmlRequests));
+}
+
+
+
+/* ****************************************************************************
+*
+* updater - 
+*/
+static void* updater(void* vP)
+{
+  for (int ix = 0; ix < 100000; ++ix)
+  {
+    statisticsUpdate(QueryContext, JSON);
+    statisticsLatencyAdd(QueryContext, ix % 1000);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* concurrentUpdate - no update is lost when many threads count at the same time
+*/
+TEST(commonStatistics, concurrentUpdate)
+{
+  pthread_t         tid[8];
+  LatencyHistogram  histogram;
+
+  statisticsReset();
+
+  for (int ix = 0; ix < 8; ++ix)
+  {
+    pthread_create(&tid[ix], NULL, updater, NULL);
+  }
+
+  for (int ix = 0; ix < 8; ++ix)
+  {
+    pthread_join(tid[ix], NULL);
+  }
+
+  EXPECT_EQ(800000, statisticsRequestsGet(QueryContext));
+  EXPECT_EQ(800000, statisticsCounterGet(StatJsonRequests));
+
+  ASSERT_TRUE(statisticsLatencyGet(QueryContext, &histogram));
+  EXPECT_EQ(800000, histogram.count);
+  EXPECT_EQ(8ULL * 100 * (999 * 1000 / 2), histogram.sum);
+
+  statisticsReset();
+  EXPECT_FALSE(statisticsLatencyGet(QueryContext, &histogram));
+}
+
+
+
+/* ****************************************************************************
+*
+* latencyHistogram - buckets and percentiles
+*/
+TEST(commonStatistics, latencyHistogram)
+{
+  LatencyHistogram histogram;
+
+  statisticsReset();
+
+  EXPECT_FALSE(statisticsBackendLatencyGet(BoQueryContext, &histogram));
+
+  /* 90 fast operations (3 usecs) and 10 slow ones (1000 usecs) */
+  for (int ix = 0; ix < 90; ++ix)
+  {
+    statisticsBackendLatencyAdd(BoQueryContext, 3);
+  }
+
+  for (int ix = 0; ix < 10; ++ix)
+  {
+    statisticsBackendLatencyAdd(BoQueryContext, 1000);
+  }
+
+  ASSERT_TRUE(statisticsBackendLatencyGet(BoQueryContext, &histogram));
+  EXPECT_EQ(100, histogram.count);
+  EXPECT_EQ(90 * 3 + 10 * 1000, histogram.sum);
+
+  /* The limits of the buckets are 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, ... */
+  EXPECT_EQ(1,  latencyBucketLimit(0));
+  EXPECT_EQ(4,  latencyBucketLimit(3));
+  EXPECT_EQ(5,  latencyBucketLimit(4));
+  EXPECT_EQ(8,  latencyBucketLimit(7));
+  EXPECT_EQ(10, latencyBucketLimit(8));
+  EXPECT_EQ(16, latencyBucketLimit(11));
+
+  EXPECT_EQ(4, latencyPercentile(&histogram, 50));
+  EXPECT_EQ(4, latencyPercentile(&histogram, 89));
+
+  /* 1000 is in [896, 1024) */
+  EXPECT_EQ(1024, latencyPercentile(&histogram, 90));
+  EXPECT_EQ(1024, latencyPercentile(&histogram, 99));
+
+  /* A latency out of range goes to the last bucket */
+  statisticsBackendLatencyAdd(BoUpdateContext, 1LL << 40);
+  ASSERT_TRUE(statisticsBackendLatencyGet(BoUpdateContext, &histogram));
+  EXPECT_EQ(1, histogram.bucketV[LATENCY_BUCKETS - 1]);
+
+  statisticsReset();
 }
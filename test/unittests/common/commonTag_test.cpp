@@ -132,3 +132,57 @@ TEST(commonTag, valueTag)
    out = valueTag(indent, tag, tag, "8", JSON, false);
    EXPECT_EQ(stringJsonNoComma, out);
 }
+
+
+
+/* ****************************************************************************
+*
+* htmlEscape - 
+*/
+TEST(commonTag, htmlEscape)
+{
+   std::string out = "prefix:";
+
+   htmlEscape(out, "a<b>(c)='d';\"e\"");
+   EXPECT_EQ("prefix:a&lt;b&gt;&#40;c&#41;&#61;&#39;d&#39;&#59;&quot;e&quot;", out);
+
+   out = "";
+   htmlEscape(out, "");
+   EXPECT_EQ("", out);
+}
+
+
+
+/* ****************************************************************************
+*
+* append - the *Append functions render what the string-returning functions did
+*
+* The expected output is the one of the string-returning functions before they became
+* wrappers of the *Append functions. The equivalence for a whole render tree is checked
+* by the largeRender test of QueryContextResponse.
+*/
+TEST(commonTag, append)
+{
+   std::string      tag    = "TAG";
+   std::string      indent = "  ";
+   std::string      out    = "";
+   std::string      expected;
+
+   expected += "  {\n    \"TAG\" : {\n";
+   expected += "  \"TAG\" : [\n";
+   expected += "  \"TAG\" : \"&lt;v&gt;\",\n";
+   expected += "  <TAG>8</TAG>\n";
+   expected += "  \"v\"\n";
+   expected += "  ],\n";
+   expected += "  </TAG>\n";
+
+   startTagAppend(out, indent, tag, JSON, true, true);
+   startTagAppend(out, indent, tag, tag, JSON, true, true);
+   valueTagAppend(out, indent, tag, "<v>", JSON, true);
+   valueTagAppend(out, indent, tag, 8, XML);
+   valueTagAppend(out, indent, tag, "", "v", JSON, false);
+   endTagAppend(out, indent, tag, JSON, true, true);
+   endTagAppend(out, indent, tag, XML);
+
+   EXPECT_EQ(expected, out);
+}
@@ -44,7 +44,7 @@
 *
 * restServiceV - 
 */
-RestService restServiceV[] =
+static RestService restServiceV[] =
 {
   { "POST",   RegisterContext,                       2, { "ngsi9",  "registerContext"                       }, "", postRegisterContext                       },
   { "GET",    ContextEntitiesByEntityId,             3, { "ngsi9", "contextEntities", "*"                   }, "", getContextEntitiesByEntityId              },
@@ -0,0 +1,116 @@
+/*
+*
+* Copyright 2013 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>
+#include <sys/time.h>
+
+#include <string>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "jsonParse/jsonRequest.h"
+#include "ngsi/ParseData.h"
+#include "ngsi/Request.h"
+#include "rest/ConnectionInfo.h"
+
+#include "unittest.h"
+
+
+
+/* ****************************************************************************
+*
+* updateContextBatch - 
+*
+* Returns the payload of an updateContext request with 'elements' context elements of
+* 'attributes' attributes each.
+*/
+static std::string updateContextBatch(int elements, int attributes)
+{
+  std::string payload = "{\"contextElements\": [";
+  char        buf[256];
+
+  for (int eIx = 0; eIx < elements; ++eIx)
+  {
+    snprintf(buf, sizeof(buf), "%s{\"type\": \"Room\", \"isPattern\": \"false\", \"id\": \"Room%d\", \"attributes\": [", (eIx == 0)? "" : ", ", eIx);
+    payload += buf;
+
+    for (int aIx = 0; aIx < attributes; ++aIx)
+    {
+      snprintf(buf, sizeof(buf), "%s{\"name\": \"A%d\", \"type\": \"float\", \"value\": %d.50, "
+               "\"metadatas\": [{\"name\": \"accuracy\", \"type\": \"float\", \"value\": \"0.8\"}]}",
+               (aIx == 0)? "" : ", ", aIx, aIx);
+      payload += buf;
+    }
+
+    payload += "]}";
+  }
+
+  payload += "], \"updateAction\": \"APPEND\"}";
+
+  return payload;
+}
+
+
+
+/* ****************************************************************************
+*
+* largeUpdateContext - 
+*
+* Parse of a large updateContext batch. The time of the parse is not checked (it depends
+* on the machine) but recorded as a property of the test, in the XML output of gtest.
+*/
+TEST(jsonParse, largeUpdateContext)
+{
+  ConnectionInfo  ci("/v1/updateContext", "POST", "1.1");
+  ParseData       parseData;
+  JsonRequest*    reqP     = NULL;
+  std::string     payload  = updateContextBatch(1000, 5);
+  struct timeval  start;
+  struct timeval  end;
+  std::string     out;
+
+  utInit();
+
+  ci.inFormat  = JSON;
+  ci.outFormat = JSON;
+
+  gettimeofday(&start, NULL);
+  out = jsonTreat(payload.c_str(), &ci, &parseData, UpdateContext, "updateContextRequest", &reqP);
+  gettimeofday(&end, NULL);
+
+  EXPECT_EQ("OK", out);
+  ASSERT_EQ(1000, parseData.upcr.res.contextElementVector.size());
+  EXPECT_EQ("Room999", parseData.upcr.res.contextElementVector[999]->entityId.id);
+  ASSERT_EQ(5, parseData.upcr.res.contextElementVector[999]->contextAttributeVector.size());
+
+  // Numbers are kept as they are written in the payload
+  EXPECT_EQ("4.50", parseData.upcr.res.contextElementVector[999]->contextAttributeVector[4]->stringValue);
+
+  RecordProperty("usecs", (int) ((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec)));
+
+  reqP->release(&parseData);
+
+  utExit();
+}
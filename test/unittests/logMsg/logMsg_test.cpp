@@ -0,0 +1,374 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+#include "parseArgs/parseArgs.h"
+#include "rest/ConnectionInfo.h"
+#include "rest/RestService.h"
+#include "serviceRoutines/versionTreat.h"
+
+
+
+/* ****************************************************************************
+*
+* Benchmark size
+*/
+#define THREADS   8
+#define LINES     5000
+#define REQUESTS  2000
+
+
+
+/* ****************************************************************************
+*
+* evaluations - number of times the (expensive) argument of a log line is computed
+*/
+static int evaluations = 0;
+
+
+
+/* ****************************************************************************
+*
+* expensive - stands for the query.toString() of mongoBackend
+*/
+static std::string expensive(void)
+{
+  __sync_fetch_and_add(&evaluations, 1);
+  return std::string(200, 'q');
+}
+
+
+
+/* ****************************************************************************
+*
+* usecsGet -
+*/
+static long long usecsGet(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (long long) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+/* ****************************************************************************
+*
+* logger -
+*/
+static void* logger(void* vP)
+{
+  const char* phase = (const char*) vP;
+
+  for (int ix = 0; ix < LINES; ++ix)
+  {
+    LM_T(LmtMongo, ("logMsg benchmark %s %p %d (%s)", phase, (void*) pthread_self(), ix, expensive().c_str()));
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* run - log LINES lines from each one of THREADS threads, returns the elapsed usecs
+*/
+static long long run(const char* phase)
+{
+  pthread_t  tid[THREADS];
+  long long  start = usecsGet();
+
+  for (int ix = 0; ix < THREADS; ++ix)
+  {
+    pthread_create(&tid[ix], NULL, logger, (void*) phase);
+  }
+
+  for (int ix = 0; ix < THREADS; ++ix)
+  {
+    pthread_join(tid[ix], NULL);
+  }
+
+  lmAsyncFlush();
+
+  return usecsGet() - start;
+}
+
+
+
+/* ****************************************************************************
+*
+* linesCheck - number of lines of 'phase' in the log file, checking the order of each thread
+*
+* With NULL as 'phase', the number of lines of the log file.
+*/
+static int linesCheck(int fd, const char* phase)
+{
+  char   path[64];
+  char   line[1024];
+  char   prefix[64];
+  int    lines = 0;
+  bool   ordered = true;
+  void*  threadV[THREADS];
+  int    lastV[THREADS];
+  FILE*  fP;
+
+  snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+  snprintf(prefix, sizeof(prefix), "logMsg benchmark %s ", (phase == NULL)? "" : phase);
+
+  if ((fP = fopen(path, "r")) == NULL)
+  {
+    return -1;
+  }
+
+  memset(threadV, 0, sizeof(threadV));
+
+  while (fgets(line, sizeof(line), fP) != NULL)
+  {
+    if (phase == NULL)
+    {
+      ++lines;
+      continue;
+    }
+
+    char*  textP = strstr(line, prefix);
+    void*  thread;
+    int    lineNo;
+
+    if ((textP == NULL) || (sscanf(&textP[strlen(prefix)], "%p %d", &thread, &lineNo) != 2))
+    {
+      continue;
+    }
+
+    for (int ix = 0; ix < THREADS; ++ix)
+    {
+      if (threadV[ix] == NULL)
+      {
+        threadV[ix] = thread;
+        lastV[ix]   = -1;
+      }
+
+      if (threadV[ix] == thread)
+      {
+        ordered    = ordered && (lineNo == lastV[ix] + 1);
+        lastV[ix]  = lineNo;
+        break;
+      }
+    }
+
+    ++lines;
+  }
+
+  fclose(fP);
+
+  return (ordered == true)? lines : -1;
+}
+
+
+
+/* ****************************************************************************
+*
+* rs -
+*/
+static RestService rs[] =
+{
+  { "GET",    VersionRequest,                        1, { "version"                                                }, "", versionTreat                              },
+  { "",       InvalidRequest,                        0, {                                                          }, "", NULL                                      }
+};
+
+
+
+/* ****************************************************************************
+*
+* requester - serve REQUESTS requests, with the INFO lines the broker logs for each one
+*
+* The transaction lines are the ones of rest.cpp and the 'Database Operation Successful'
+* line the one mongoBackend logs after each operation.
+*/
+static void* requester(void* vP)
+{
+  for (int ix = 0; ix < REQUESTS; ++ix)
+  {
+    ConnectionInfo  ci("/version", "GET", "1.1");
+    std::string     out;
+
+    LM_TRANSACTION_START("from", "127.0.0.1", 1026, "/version");
+    out = restService(&ci, rs);
+    LM_I(("Database Operation Successful (%s)", expensive().c_str()));
+    LM_TRANSACTION_END();
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* requestsRun - REQUESTS requests from each one of THREADS threads, returns requests per second
+*
+* INFO lines are also shown on the screen of the unit tests, which is /dev/null meanwhile.
+*/
+static int requestsRun(void)
+{
+  pthread_t  tid[THREADS];
+  int        screenFd = dup(1);
+  int        nullFd   = open("/dev/null", O_WRONLY);
+  long long  start;
+  long long  usecs;
+
+  fflush(stdout);
+  dup2(nullFd, 1);
+
+  start = usecsGet();
+
+  for (int ix = 0; ix < THREADS; ++ix)
+  {
+    pthread_create(&tid[ix], NULL, requester, NULL);
+  }
+
+  for (int ix = 0; ix < THREADS; ++ix)
+  {
+    pthread_join(tid[ix], NULL);
+  }
+
+  lmAsyncFlush();
+
+  usecs = usecsGet() - start;
+
+  dup2(screenFd, 1);
+  close(screenFd);
+  close(nullFd);
+
+  return (int) ((long long) THREADS * REQUESTS * 1000000 / ((usecs == 0)? 1 : usecs));
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncBenchmark - log lines and requests, with logging off, synchronous and asynchronous
+*
+* Trace lines are used instead of LM_I to keep them out of the screen of the unit tests,
+* the path in lmOut is the same.
+*/
+TEST(logMsg, asyncBenchmark)
+{
+  int        fd;
+  long long  offUsecs;
+  long long  syncUsecs;
+  long long  asyncUsecs;
+  int        reqOffPerSec;
+  int        reqSyncPerSec;
+  int        reqAsyncPerSec;
+
+  ASSERT_EQ(LmsOk, lmFdGet(paLmFdGet(), &fd));
+
+  /* Logging off: the arguments of the lines are not even computed */
+  lmTraceLevelSet(LmtMongo, false);
+  offUsecs = run("off");
+  EXPECT_EQ(0, evaluations);
+
+  /* INFO off (as lmSilent is, for all lines) */
+  lmSilent     = true;
+  reqOffPerSec = requestsRun();
+  lmSilent     = false;
+  EXPECT_EQ(0, evaluations);
+
+  lmTraceLevelSet(LmtMongo, true);
+
+  syncUsecs = run("sync");
+  EXPECT_EQ(THREADS * LINES, linesCheck(fd, "sync"));
+  reqSyncPerSec = requestsRun();
+
+  EXPECT_EQ(LmsOk, lmAsyncStart());
+  asyncUsecs = run("async");
+  EXPECT_EQ(THREADS * LINES, linesCheck(fd, "async"));
+  reqAsyncPerSec = requestsRun();
+
+  lmTraceLevelSet(LmtMongo, false);
+
+  RecordProperty("offUsecs",        (int) offUsecs);
+  RecordProperty("syncUsecs",       (int) syncUsecs);
+  RecordProperty("asyncUsecs",      (int) asyncUsecs);
+  RecordProperty("reqOffPerSec",    reqOffPerSec);
+  RecordProperty("reqSyncPerSec",   reqSyncPerSec);
+  RecordProperty("reqAsyncPerSec",  reqAsyncPerSec);
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncClear - the log file is cleared also when the lines are written asynchronously
+*
+* Runs after asyncBenchmark, so the asynchronous output is on.
+*/
+TEST(logMsg, asyncClear)
+{
+  int   fd;
+  bool  clearOn;
+  int   at;
+  int   keep;
+  int   last;
+  int   lines;
+
+  ASSERT_EQ(LmsOk, lmFdGet(paLmFdGet(), &fd));
+  lmClearGet(&clearOn, &at, &keep, &last, NULL);
+
+  EXPECT_EQ(LmsOk, lmClearAt(1000, 100, 100));
+  EXPECT_EQ(LmsOk, lmDoClear());
+
+  lmTraceLevelSet(LmtMongo, true);
+  for (int ix = 0; ix < 5000; ++ix)
+  {
+    LM_T(LmtMongo, ("logMsg clear %d", ix));
+  }
+  lmAsyncFlush();
+  lmTraceLevelSet(LmtMongo, false);
+
+  /* Cleared whenever it reached 1000 lines */
+  lines = linesCheck(fd, NULL);
+  EXPECT_GT(lines, 0);
+  EXPECT_LT(lines, 1000 + 4);
+
+  if (clearOn == false)
+  {
+    lmDontClear();
+  }
+  lmClearAt(at, keep, last);
+}
@@ -64,6 +64,7 @@ int   logFd             = -1;
 int   fwdPort           = -1;
 char  fwdHost[64];
 unsigned cprForwardLimit = 1000;
+long     cprForwardTimeout = -1;
 
 
 
@@ -0,0 +1,131 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "mongoBackend/entityTypesCache.h"
+
+
+
+/* ****************************************************************************
+*
+* names -
+*/
+static std::vector<std::string> names(const char* n1, const char* n2 = NULL, const char* n3 = NULL)
+{
+  std::vector<std::string> v;
+
+  v.push_back(n1);
+
+  if (n2 != NULL)
+  {
+    v.push_back(n2);
+  }
+
+  if (n3 != NULL)
+  {
+    v.push_back(n3);
+  }
+
+  return v;
+}
+
+
+
+/* ****************************************************************************
+*
+* summary -
+*/
+TEST(entityTypesCache, summary)
+{
+  std::map<std::string, std::set<std::string> >  types;
+  std::vector<std::string>                        noPath;
+  std::vector<std::string>                        home;
+  std::vector<std::string>                        kitchen;
+  std::vector<std::string>                        none;
+
+  typesCacheInit(true);
+
+  home.push_back("/home/#");
+  kitchen.push_back("/home/kitchen");
+
+  typesCacheEntityCreated("", "/home/kitchen", "Room", names("temp", "pressure"));
+  typesCacheEntityCreated("", "/home/hall",    "Room", names("temp", "humidity"));
+  typesCacheEntityCreated("", "/office",       "Car",  names("speed"));
+  typesCacheEntityCreated("", "",              "",     none);
+
+  /* All the service paths, types sorted (entities without type first) */
+  EXPECT_TRUE(typesCacheGet("", noPath, &types));
+  ASSERT_EQ(3, types.size());
+  EXPECT_EQ("", types.begin()->first);
+  EXPECT_EQ(0, types[""].size());
+  EXPECT_EQ(1, types["Car"].size());
+  EXPECT_EQ(3, types["Room"].size());
+  types.clear();
+
+  /* Hierarchical service path */
+  EXPECT_TRUE(typesCacheGet("", home, &types));
+  ASSERT_EQ(1, types.size());
+  EXPECT_EQ(3, types["Room"].size());
+  types.clear();
+
+  /* Exact service path */
+  EXPECT_TRUE(typesCacheGet("", kitchen, &types));
+  ASSERT_EQ(1, types.size());
+  EXPECT_EQ(2, types["Room"].size());
+  EXPECT_EQ(1, types["Room"].count("pressure"));
+  types.clear();
+
+  /* An attribute stays while some entity of the type has it */
+  typesCacheAttrNamesChanged("", "/home/kitchen", "Room", names("light"), names("temp"));
+  EXPECT_TRUE(typesCacheGet("", home, &types));
+  EXPECT_EQ(4, types["Room"].size());
+  EXPECT_EQ(1, types["Room"].count("temp"));
+  types.clear();
+
+  /* ... and the type stays while it has entities */
+  typesCacheEntityRemoved("", "/home/hall", "Room", names("temp", "humidity"));
+  EXPECT_TRUE(typesCacheGet("", home, &types));
+  ASSERT_EQ(1, types.size());
+  EXPECT_EQ(2, types["Room"].size());
+  EXPECT_EQ(0, types["Room"].count("temp"));
+  types.clear();
+
+  typesCacheEntityRemoved("", "/home/kitchen", "Room", names("pressure", "light"));
+  EXPECT_TRUE(typesCacheGet("", home, &types));
+  EXPECT_EQ(0, types.size());
+
+  /* Other tenant */
+  EXPECT_TRUE(typesCacheGet("t1", noPath, &types));
+  EXPECT_EQ(0, types.size());
+
+  typesCacheEntityRemoved("", "/office", "Car", names("speed"));
+  typesCacheEntityRemoved("", "", "", none);
+  typesCacheInit(false);
+}
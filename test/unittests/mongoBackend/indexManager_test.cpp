@@ -0,0 +1,85 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "testInit.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/indexManager.h"
+
+#include "mongo/client/dbclient.h"
+
+
+
+/* ****************************************************************************
+*
+* ensure -
+*/
+TEST(indexManager, ensure)
+{
+  std::vector<IndexStatus> statusV;
+
+  setupDatabase();
+
+  indexesStatusGet(&statusV);
+  EXPECT_EQ(0, statusV.size());
+
+  indexesEnsure("");
+  indexesStatusGet(&statusV);
+
+  unsigned int indexes = statusV.size();
+
+  ASSERT_LT(0, indexes);
+  for (unsigned int ix = 0; ix < statusV.size(); ++ix)
+  {
+    EXPECT_EQ("", statusV[ix].tenant);
+    EXPECT_TRUE((statusV[ix].status == "ok") || (statusV[ix].status == "unsupported")) << statusV[ix].name;
+  }
+
+  /* The indexes are in the database */
+  DBClientBase*             connection = getMongoConnection();
+  std::list<BSONObj>        indexL     = connection->getIndexSpecs(ENTITIES_COLL);
+  std::vector<std::string>  nameV;
+
+  releaseMongoConnection(connection);
+
+  for (std::list<BSONObj>::iterator it = indexL.begin(); it != indexL.end(); ++it)
+  {
+    nameV.push_back(it->getStringField("name"));
+  }
+
+  EXPECT_NE(nameV.end(), std::find(nameV.begin(), nameV.end(), "attrNames_1"));
+  EXPECT_NE(nameV.end(), std::find(nameV.begin(), nameV.end(), "creDate_1__id_1"));
+
+  /* Second time for the same tenant: nothing new */
+  statusV.clear();
+  indexesEnsure("");
+  indexesStatusGet(&statusV);
+  EXPECT_EQ(indexes, statusV.size());
+}
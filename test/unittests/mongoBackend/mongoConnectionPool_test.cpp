@@ -0,0 +1,373 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "testInit.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/mongoConnectionPool.h"
+
+#include "mongo/client/dbclient.h"
+
+
+
+extern void setMongoConnectionForUnitTest(DBClientBase*);
+
+
+
+/* ****************************************************************************
+*
+* Connections in the hands of the threads of the tests
+*
+* A connection given to two threads at the same time is counted in 'sharedErrors'.
+*/
+static pthread_mutex_t          ownedMutex   = PTHREAD_MUTEX_INITIALIZER;
+static std::set<DBClientBase*>  ownedSet;
+static int                      sharedErrors = 0;
+static volatile bool            checkerStop  = false;
+
+
+
+/* ****************************************************************************
+*
+* msNow - 
+*/
+static long msNow(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+
+
+/* ****************************************************************************
+*
+* poolRestart - a pool of the tests, with the time waiting for connections measured
+*/
+static void poolRestart(int poolSize, int poolMin)
+{
+  mongoConnectionPoolShutdown();
+  mongoPoolConnectionSemWaitingTimeReset();
+
+  ownedSet.clear();
+  sharedErrors = 0;
+
+  ASSERT_EQ(0, mongoConnectionPoolInit("localhost", "", "", "", "", false, 0, 1, poolSize, true, poolMin));
+}
+
+
+
+/* ****************************************************************************
+*
+* poolRestore - the pool of the rest of the unit tests (see setupDatabase)
+*
+* The connection of the unit tests was taken from the previous pool, so it is
+* forgotten (the next setupDatabase takes a new one).
+*/
+static void poolRestore(void)
+{
+  mongoConnectionPoolShutdown();
+  EXPECT_EQ(0, mongoConnectionPoolInit("localhost", "", "", "", "", false, 0, 10, 10, false, 1));
+  setMongoConnectionForUnitTest(NULL);
+}
+
+
+
+/* ****************************************************************************
+*
+* own - 
+*/
+static void own(DBClientBase* connection)
+{
+  pthread_mutex_lock(&ownedMutex);
+
+  if ((connection == NULL) || (ownedSet.insert(connection).second == false))
+  {
+    ++sharedErrors;
+  }
+
+  pthread_mutex_unlock(&ownedMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* disown - 
+*/
+static void disown(DBClientBase* connection)
+{
+  pthread_mutex_lock(&ownedMutex);
+  ownedSet.erase(connection);
+  pthread_mutex_unlock(&ownedMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* getRelease - thread getting and releasing connections
+*/
+static void* getRelease(void* vP)
+{
+  long iterations = (long) vP;
+
+  for (long ix = 0; ix < iterations; ++ix)
+  {
+    DBClientBase* connection = mongoPoolConnectionGet();
+
+    own(connection);
+    usleep(ix % 3 * 100);
+    disown(connection);
+
+    mongoPoolConnectionRelease(connection);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* healthChecker - thread checking the idle connections until told to stop
+*/
+static void* healthChecker(void* vP)
+{
+  while (checkerStop == false)
+  {
+    mongoConnectionPoolHealthCheck();
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* allDistinct - take all the connections of the pool at the same time, all must be different
+*/
+static void allDistinct(int poolSize)
+{
+  std::vector<DBClientBase*> connectionV;
+
+  for (int ix = 0; ix < poolSize; ++ix)
+  {
+    DBClientBase* connection = mongoPoolConnectionGet();
+
+    own(connection);
+    connectionV.push_back(connection);
+  }
+
+  EXPECT_EQ(0, sharedErrors);
+  EXPECT_EQ(poolSize, mongoConnectionPoolConnected());
+
+  for (unsigned int ix = 0; ix < connectionV.size(); ++ix)
+  {
+    disown(connectionV[ix]);
+    mongoPoolConnectionRelease(connectionV[ix]);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* poolMin - the first poolMin connections are established at startup, the rest on demand
+*/
+TEST(mongoConnectionPool, poolMin)
+{
+  const char*  nameV[MONGO_POOL_WAIT_BUCKETS];
+  long         countV[MONGO_POOL_WAIT_BUCKETS];
+
+  setupDatabase();
+  poolRestart(8, 4);
+
+  EXPECT_EQ(4, mongoConnectionPoolConnected());
+
+  /* growing the pool is not waiting for a connection */
+  allDistinct(8);
+  EXPECT_EQ(0, mongoPoolConnectionWaitsGet(nameV, countV));
+
+  poolRestore();
+}
+
+
+
+/* ****************************************************************************
+*
+* releaseTwice - releasing a connection twice doesn't make it available twice
+*/
+TEST(mongoConnectionPool, releaseTwice)
+{
+  setupDatabase();
+  poolRestart(2, 2);
+
+  DBClientBase* connection = mongoPoolConnectionGet();
+
+  mongoPoolConnectionRelease(connection);
+  mongoPoolConnectionRelease(connection);
+
+  allDistinct(2);
+
+  poolRestore();
+}
+
+
+
+/* ****************************************************************************
+*
+* waitForRelease - with all the connections in use, a caller waits until one is released
+*/
+static DBClientBase* waitedConnection = NULL;
+static long          waitedAt         = 0;
+
+static void* waitingGet(void* vP)
+{
+  waitedConnection = mongoPoolConnectionGet();
+  waitedAt         = msNow();
+
+  return NULL;
+}
+
+TEST(mongoConnectionPool, waitForRelease)
+{
+  const char*  nameV[MONGO_POOL_WAIT_BUCKETS];
+  long         countV[MONGO_POOL_WAIT_BUCKETS];
+  pthread_t    tid;
+
+  setupDatabase();
+  poolRestart(2, 2);
+
+  DBClientBase* connection1 = mongoPoolConnectionGet();
+  DBClientBase* connection2 = mongoPoolConnectionGet();
+
+  waitedConnection = NULL;
+  ASSERT_EQ(0, pthread_create(&tid, NULL, waitingGet, NULL));
+
+  usleep(200000);
+  EXPECT_TRUE(waitedConnection == NULL);
+
+  long releasedAt = msNow();
+
+  mongoPoolConnectionRelease(connection2);
+  pthread_join(tid, NULL);
+
+  /* the waiter is woken up by the release, it doesn't poll */
+  EXPECT_TRUE(waitedConnection == connection2);
+  EXPECT_LT(waitedAt - releasedAt, 100);
+  EXPECT_EQ(1, mongoPoolConnectionWaitsGet(nameV, countV));
+
+  mongoPoolConnectionRelease(connection1);
+  mongoPoolConnectionRelease(waitedConnection);
+
+  poolRestore();
+}
+
+
+
+/* ****************************************************************************
+*
+* concurrentGetRelease - many threads sharing a small pool, that grows on demand
+*/
+TEST(mongoConnectionPool, concurrentGetRelease)
+{
+  const char*             nameV[MONGO_POOL_WAIT_BUCKETS];
+  long                    countV[MONGO_POOL_WAIT_BUCKETS];
+  std::vector<pthread_t>  tidV;
+
+  setupDatabase();
+  poolRestart(4, 1);
+
+  for (int ix = 0; ix < 16; ++ix)
+  {
+    pthread_t tid;
+
+    ASSERT_EQ(0, pthread_create(&tid, NULL, getRelease, (void*) 500));
+    tidV.push_back(tid);
+  }
+
+  for (unsigned int ix = 0; ix < tidV.size(); ++ix)
+  {
+    pthread_join(tidV[ix], NULL);
+  }
+
+  EXPECT_EQ(0, sharedErrors);
+  EXPECT_LT(0, mongoPoolConnectionWaitsGet(nameV, countV));
+  EXPECT_GE(4, mongoConnectionPoolConnected());
+
+  /* all the tokens and slots are back */
+  allDistinct(4);
+
+  poolRestore();
+}
+
+
+
+/* ****************************************************************************
+*
+* concurrentHealthCheck - the health check takes idle connections while they are being used
+*/
+TEST(mongoConnectionPool, concurrentHealthCheck)
+{
+  std::vector<pthread_t>  tidV;
+  pthread_t               checkerTid;
+
+  setupDatabase();
+  poolRestart(4, 4);
+
+  checkerStop = false;
+  ASSERT_EQ(0, pthread_create(&checkerTid, NULL, healthChecker, NULL));
+
+  for (int ix = 0; ix < 8; ++ix)
+  {
+    pthread_t tid;
+
+    ASSERT_EQ(0, pthread_create(&tid, NULL, getRelease, (void*) 200));
+    tidV.push_back(tid);
+  }
+
+  for (unsigned int ix = 0; ix < tidV.size(); ++ix)
+  {
+    pthread_join(tidV[ix], NULL);
+  }
+
+  checkerStop = true;
+  pthread_join(checkerTid, NULL);
+
+  EXPECT_EQ(0, sharedErrors);
+  allDistinct(4);
+
+  poolRestore();
+}
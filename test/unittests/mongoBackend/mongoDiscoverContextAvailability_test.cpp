@@ -2615,7 +2615,7 @@ TEST(mongoDiscoverContextAvailabilityRequest, mongoDbQueryFail)
               "- query(): { query: { $or: [ { contextRegistration.entities: { $in: [ { id: \"E3\", type: \"T3\" }, { type: \"T3\", id: \"E3\" } ] } }, "
               "{ contextRegistration.entities.id: { $in: [] } } ], "
               "expiration: { $gt: 1360232700 }"
-              ", servicePath: { $in: [ /^/.*/, null ] } }"
+              ", servicePath: { $in: [ /^//, null ] } }"
               ", orderby: { _id: 1 } } - exception: boom!!", res.errorCode.details);
     EXPECT_EQ(0,res.responseVector.size());
 
@@ -1110,6 +1110,237 @@ TEST(mongoQueryContextRequest, paginationNonExistingDetails)
     utExit();
 }
 
+/* ****************************************************************************
+*
+* paginationToken -
+*
+*/
+TEST(mongoQueryContextRequest, paginationToken)
+{
+    HttpStatusCode         ms;
+    QueryContextRequest   req;
+    QueryContextResponse  res1;
+    QueryContextResponse  res2;
+    std::string           nextPageToken;
+
+    utInit();
+
+    /* Prepare database */
+    prepareDatabaseForPagination();
+
+    /* Forge the request (from "inside" to "outside") */
+    EntityId en("E.*", "T", "true");
+    req.entityIdVector.push_back(&en);
+    uriParams[URI_PARAM_PAGINATION_DETAILS]  = "off";
+    uriParams[URI_PARAM_PAGINATION_OFFSET]   = "3";
+    uriParams[URI_PARAM_PAGINATION_LIMIT]    = "4";
+    uriParams[URI_PARAM_PAGINATION_TOKEN]    = "";
+
+    /* Invoke the function in mongoBackend library (first page, offset is ignored) */
+    ms = mongoQueryContext(&req, &res1, "", servicePathVector , uriParams, NULL, &nextPageToken);
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+
+    ASSERT_EQ(4, res1.contextElementResponseVector.size());
+    EXPECT_EQ("E1", res1.contextElementResponseVector.get(0)->contextElement.entityId.id);
+    EXPECT_EQ("E2", res1.contextElementResponseVector.get(1)->contextElement.entityId.id);
+    EXPECT_EQ("E3", res1.contextElementResponseVector.get(2)->contextElement.entityId.id);
+    EXPECT_EQ("E4", res1.contextElementResponseVector.get(3)->contextElement.entityId.id);
+    ASSERT_NE("", nextPageToken);
+
+    /* Invoke the function in mongoBackend library (second and last page) */
+    uriParams[URI_PARAM_PAGINATION_TOKEN] = nextPageToken;
+    nextPageToken = "";
+    ms = mongoQueryContext(&req, &res2, "", servicePathVector , uriParams, NULL, &nextPageToken);
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+
+    ASSERT_EQ(2, res2.contextElementResponseVector.size());
+    EXPECT_EQ("E5", res2.contextElementResponseVector.get(0)->contextElement.entityId.id);
+    EXPECT_EQ("E6", res2.contextElementResponseVector.get(1)->contextElement.entityId.id);
+    EXPECT_EQ("", nextPageToken);
+
+    uriParams.erase(URI_PARAM_PAGINATION_TOKEN);
+    uriParams[URI_PARAM_PAGINATION_OFFSET] = "0";
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    utExit();
+}
+
+/* ****************************************************************************
+*
+* paginationOffsetNoToken -
+*
+* A full page got with offset (no pageToken) doesn't give a token for the next page
+*/
+TEST(mongoQueryContextRequest, paginationOffsetNoToken)
+{
+    HttpStatusCode         ms;
+    QueryContextRequest   req;
+    QueryContextResponse  res;
+    std::string           nextPageToken;
+
+    utInit();
+
+    /* Prepare database */
+    prepareDatabaseForPagination();
+
+    /* Forge the request (from "inside" to "outside") */
+    EntityId en("E.*", "T", "true");
+    req.entityIdVector.push_back(&en);
+    uriParams[URI_PARAM_PAGINATION_DETAILS]  = "off";
+    uriParams[URI_PARAM_PAGINATION_OFFSET]   = "1";
+    uriParams[URI_PARAM_PAGINATION_LIMIT]    = "2";
+
+    /* Invoke the function in mongoBackend library */
+    ms = mongoQueryContext(&req, &res, "", servicePathVector , uriParams, NULL, &nextPageToken);
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+
+    ASSERT_EQ(2, res.contextElementResponseVector.size());
+    EXPECT_EQ("E2", res.contextElementResponseVector.get(0)->contextElement.entityId.id);
+    EXPECT_EQ("E3", res.contextElementResponseVector.get(1)->contextElement.entityId.id);
+    EXPECT_EQ("", nextPageToken);
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    utExit();
+}
+
+/* ****************************************************************************
+*
+* paginationBadToken -
+*
+*/
+TEST(mongoQueryContextRequest, paginationBadToken)
+{
+    HttpStatusCode         ms;
+    QueryContextRequest   req;
+    QueryContextResponse  res;
+
+    utInit();
+
+    /* Prepare database */
+    prepareDatabaseForPagination();
+
+    /* Forge the request (from "inside" to "outside") */
+    EntityId en("E.*", "T", "true");
+    req.entityIdVector.push_back(&en);
+    uriParams[URI_PARAM_PAGINATION_DETAILS]  = "off";
+    uriParams[URI_PARAM_PAGINATION_TOKEN]    = "0a000000ffff";
+
+    /* Invoke the function in mongoBackend library */
+    ms = mongoQueryContext(&req, &res, "", servicePathVector , uriParams);
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+
+    EXPECT_EQ(SccBadRequest, res.errorCode.code);
+    EXPECT_EQ("Bad pagination token", res.errorCode.details);
+    EXPECT_EQ(0, res.contextElementResponseVector.size());
+
+    uriParams.erase(URI_PARAM_PAGINATION_TOKEN);
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    utExit();
+}
+
+/* ****************************************************************************
+*
+* tokenFromKey -
+*
+* Hexadecimal dump of 'key', as done by the broker when generating a pagination token
+*/
+static std::string tokenFromKey(const BSONObj& key)
+{
+  static const char     hexV[] = "0123456789abcdef";
+  const unsigned char*  dataP  = (const unsigned char*) key.objdata();
+  std::string           token;
+
+  for (int ix = 0; ix < key.objsize(); ++ix)
+  {
+    token += hexV[dataP[ix] >> 4];
+    token += hexV[dataP[ix] & 0x0F];
+  }
+
+  return token;
+}
+
+/* ****************************************************************************
+*
+* paginationForgedToken -
+*
+* Well-formed BSON tokens with operators (or values of unexpected types) in 'c' or 'i'
+* are rejected, as they would end up in the query
+*/
+TEST(mongoQueryContextRequest, paginationForgedToken)
+{
+    HttpStatusCode         ms;
+    QueryContextRequest   req;
+    BSONObj               goodId = BSON("id" << "E1" << "type" << "T" << "servicePath" << "/");
+    std::vector<BSONObj>  keyV;
+
+    keyV.push_back(BSON("c" << BSON("$gt" << 0) << "i" << goodId));
+    keyV.push_back(BSON("c" << "1" << "i" << goodId));
+    keyV.push_back(BSON("i" << goodId));
+    keyV.push_back(BSON("c" << 1 << "i" << "E1"));
+    keyV.push_back(BSON("c" << 1 << "i" << BSON("$ne" << "")));
+    keyV.push_back(BSON("c" << 1 << "i" << BSON("id" << BSON("$ne" << "") << "type" << "T" << "servicePath" << "/")));
+    keyV.push_back(BSON("c" << 1 << "i" << BSON("type" << "T" << "servicePath" << "/")));
+    keyV.push_back(BSON("c" << 1 << "i" << BSON("id" << "E1" << "type" << 1)));
+    keyV.push_back(BSON("c" << 1 << "i" << BSON("id" << "E1" << "type" << "T" << "servicePath" << "/" << "x" << "y")));
+
+    utInit();
+
+    /* Prepare database */
+    prepareDatabaseForPagination();
+
+    /* Forge the request (from "inside" to "outside") */
+    EntityId en("E.*", "T", "true");
+    req.entityIdVector.push_back(&en);
+    uriParams[URI_PARAM_PAGINATION_DETAILS]  = "off";
+
+    for (unsigned int ix = 0; ix < keyV.size(); ++ix)
+    {
+      QueryContextResponse  res;
+
+      uriParams[URI_PARAM_PAGINATION_TOKEN] = tokenFromKey(keyV[ix]);
+
+      /* Invoke the function in mongoBackend library */
+      ms = mongoQueryContext(&req, &res, "", servicePathVector , uriParams);
+
+      /* Check response is as expected */
+      EXPECT_EQ(SccOk, ms);
+      EXPECT_EQ(SccBadRequest, res.errorCode.code) << keyV[ix].toString();
+      EXPECT_EQ("Bad pagination token", res.errorCode.details);
+      EXPECT_EQ(0, res.contextElementResponseVector.size());
+    }
+
+    /* A key with the right shape is accepted (E1 with creDate 1 is not in the DB, but that doesn't matter) */
+    QueryContextResponse  res;
+
+    uriParams[URI_PARAM_PAGINATION_TOKEN] = tokenFromKey(BSON("c" << 1 << "i" << goodId));
+    ms = mongoQueryContext(&req, &res, "", servicePathVector , uriParams);
+
+    EXPECT_EQ(SccOk, ms);
+    EXPECT_NE(SccBadRequest, res.errorCode.code);
+
+    uriParams.erase(URI_PARAM_PAGINATION_TOKEN);
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    utExit();
+}
+
 /* ****************************************************************************
 *
 * queryWithServicePathEntPatternType_2levels -
@@ -3890,7 +4121,7 @@ TEST(mongoQueryContextRequest, mongoDbQueryFail)
     EXPECT_EQ(SccReceiverInternalError, res.errorCode.code);
     EXPECT_EQ("Internal Server Error", res.errorCode.reasonPhrase);
     EXPECT_EQ("collection: utest.entities - "
-              "query(): { query: { $or: [ { _id.id: \"E1\", _id.type: \"T1\" } ], _id.servicePath: { $in: [ /^/.*/, null ] } }, orderby: { creDate: 1 } } - "
+              "query(): { query: { $or: [ { _id.id: \"E1\", _id.type: \"T1\" } ], _id.servicePath: { $in: [ /^//, null ] } }, orderby: { creDate: 1 } } - "
               "exception: boom!!", res.errorCode.details);
     EXPECT_EQ(0,res.contextElementResponseVector.size());    
 
@@ -31,6 +31,7 @@
 #include "common/globals.h"
 #include "orionTypes/OrionValueType.h"
 #include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/MongoCommonUpdate.h"
 #include "mongoBackend/mongoUpdateContext.h"
 #include "mongoBackend/mongoQueryContext.h"
 #include "ngsi/EntityId.h"
@@ -148,6 +149,10 @@ extern void setMongoConnectionForUnitTest(DBClientBase*);
 * - servicePathEntityDeletion_3levels
 * - servicePathEntityVectorNotAllowed
 *
+* With the batch write path (-updateBatch):
+*
+* - appendNEntNAttrBatch        - APPEND N entity (existing and new), N attributes
+*
 * Note these tests are not "canonical" unit tests. Canon says that in this case we should have
 * mocked MongoDB. Actually, we think is very much powerful to check that everything is ok at
 * MongoDB layer.
@@ -10703,3 +10708,133 @@ TEST(mongoUpdateContextRequest, servicePathEntityVectorNotAllowed)
 
   utExit();
 }
+
+
+
+/* ****************************************************************************
+*
+* appendNEntNAttrBatch -
+*
+* The response and the database must be the same as without the batch write path,
+* including the per-entity status code of an element failing its preconditions
+*/
+TEST(mongoUpdateContextRequest, appendNEntNAttrBatch)
+{
+  HttpStatusCode         ms;
+  UpdateContextRequest   req;
+  UpdateContextResponse  res;
+
+  utInit();
+
+  /* Prepare database */
+  prepareDatabase();
+  setUpdateBatch(true);
+
+  /* Forge the request (from "inside" to "outside") */
+  ContextElement ce1, ce2, ce3, ce4;
+  ce1.entityId.fill("E1", "T1", "false");
+  ContextAttribute ca1("A8", "TA8", "val8");
+  ContextAttribute ca2("A1", "TA1", "new_val1");
+  ce2.entityId.fill("E4", "T4", "false");
+  ContextAttribute ca3("A9", "TA9", "val9");
+  ce3.entityId.fill("E5", "T5", "false");
+  ContextAttribute ca4("A10", "TA10", "");
+  ce4.entityId.fill("E2", "T2", "false");
+  ContextAttribute ca5("A3", "TA3", "new_val3");
+  ce1.contextAttributeVector.push_back(&ca1);
+  ce1.contextAttributeVector.push_back(&ca2);
+  ce2.contextAttributeVector.push_back(&ca3);
+  ce3.contextAttributeVector.push_back(&ca4);
+  ce4.contextAttributeVector.push_back(&ca5);
+  req.contextElementVector.push_back(&ce1);
+  req.contextElementVector.push_back(&ce2);
+  req.contextElementVector.push_back(&ce3);
+  req.contextElementVector.push_back(&ce4);
+  req.updateActionType.set("APPEND");
+
+  /* Invoke the function in mongoBackend library */
+  servicePathVector.clear();
+  ms = mongoUpdateContext(&req, &res, "", servicePathVector, uriParams, "");
+
+  /* Check response is as expected */
+  EXPECT_EQ(SccOk, ms);
+
+  EXPECT_EQ(SccOk, res.errorCode.code);
+  EXPECT_EQ("OK", res.errorCode.reasonPhrase);
+  EXPECT_EQ(0, res.errorCode.details.size());
+
+  ASSERT_EQ(4, res.contextElementResponseVector.size());
+  /* Context Element response # 1 */
+  EXPECT_EQ("E1", RES_CER(0).entityId.id);
+  EXPECT_EQ("T1", RES_CER(0).entityId.type);
+  ASSERT_EQ(2, RES_CER(0).contextAttributeVector.size());
+  EXPECT_EQ("A8", RES_CER_ATTR(0, 0)->name);
+  EXPECT_EQ("A1", RES_CER_ATTR(0, 1)->name);
+  EXPECT_EQ(SccOk, RES_CER_STATUS(0).code);
+  EXPECT_EQ("", RES_CER_STATUS(0).details);
+
+  /* Context Element response # 2 */
+  EXPECT_EQ("E4", RES_CER(1).entityId.id);
+  EXPECT_EQ("T4", RES_CER(1).entityId.type);
+  ASSERT_EQ(1, RES_CER(1).contextAttributeVector.size());
+  EXPECT_EQ("A9", RES_CER_ATTR(1, 0)->name);
+  EXPECT_EQ(SccOk, RES_CER_STATUS(1).code);
+  EXPECT_EQ("", RES_CER_STATUS(1).details);
+
+  /* Context Element response # 3 */
+  EXPECT_EQ("E5", RES_CER(2).entityId.id);
+  EXPECT_EQ("T5", RES_CER(2).entityId.type);
+  EXPECT_EQ(SccInvalidParameter, RES_CER_STATUS(2).code);
+
+  /* Context Element response # 4 */
+  EXPECT_EQ("E2", RES_CER(3).entityId.id);
+  EXPECT_EQ("T2", RES_CER(3).entityId.type);
+  ASSERT_EQ(1, RES_CER(3).contextAttributeVector.size());
+  EXPECT_EQ("A3", RES_CER_ATTR(3, 0)->name);
+  EXPECT_EQ(SccOk, RES_CER_STATUS(3).code);
+  EXPECT_EQ("", RES_CER_STATUS(3).details);
+
+  /* Check that every involved collection at MongoDB is as expected */
+  DBClientBase* connection = getMongoConnection();
+
+  /* entities collection */
+  BSONObj ent, attrs;
+  std::vector<BSONElement> attrNames;
+  ASSERT_EQ(6, connection->count(ENTITIES_COLL, BSONObj()));
+
+  ent = connection->findOne(ENTITIES_COLL, BSON("_id.id" << "E1" << "_id.type" << "T1"));
+  EXPECT_EQ(1360232700, ent.getIntField("modDate"));
+  attrs = ent.getField("attrs").embeddedObject();
+  attrNames = ent.getField("attrNames").Array();
+  ASSERT_EQ(3, attrs.nFields());
+  ASSERT_EQ(3, attrNames.size());
+  EXPECT_TRUE(findAttr(attrNames, "A8"));
+  EXPECT_STREQ("val8", C_STR_FIELD(attrs.getField("A8").embeddedObject(), "value"));
+  EXPECT_STREQ("new_val1", C_STR_FIELD(attrs.getField("A1").embeddedObject(), "value"));
+
+  ent = connection->findOne(ENTITIES_COLL, BSON("_id.id" << "E4" << "_id.type" << "T4"));
+  EXPECT_STREQ("E4", C_STR_FIELD(ent.getObjectField("_id"), "id"));
+  EXPECT_EQ(1360232700, ent.getIntField("creDate"));
+  attrs = ent.getField("attrs").embeddedObject();
+  attrNames = ent.getField("attrNames").Array();
+  ASSERT_EQ(1, attrs.nFields());
+  ASSERT_EQ(1, attrNames.size());
+  EXPECT_STREQ("val9", C_STR_FIELD(attrs.getField("A9").embeddedObject(), "value"));
+
+  ent = connection->findOne(ENTITIES_COLL, BSON("_id.id" << "E2" << "_id.type" << "T2"));
+  attrs = ent.getField("attrs").embeddedObject();
+  ASSERT_EQ(2, attrs.nFields());
+  EXPECT_STREQ("new_val3", C_STR_FIELD(attrs.getField("A3").embeddedObject(), "value"));
+
+  /* Not touched by the request */
+  ent = connection->findOne(ENTITIES_COLL, BSON("_id.id" << "E1" << "_id.type" << "T1bis"));
+  EXPECT_FALSE(ent.hasField("modDate"));
+
+  EXPECT_EQ(0, connection->count(ENTITIES_COLL, BSON("_id.id" << "E5")));
+
+  /* Release connection */
+  setMongoConnectionForUnitTest(NULL);
+  setUpdateBatch(false);
+
+  utExit();
+}
@@ -30,6 +30,7 @@
 
 #include "common/globals.h"
 #include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/MongoCommonUpdate.h"
 #include "mongoBackend/mongoUpdateContext.h"
 #include "ngsi/EntityId.h"
 #include "ngsi/ContextElementResponse.h"
@@ -51,12 +52,16 @@ extern void setMongoConnectionForUnitTest(DBClientBase*);
 * - Cond1_updateMatch_no_type
 * - Cond1_appendMatch_no_type
 * - Cond1_deleteMatch_no_type
+* - Cond1_updateMatch_typelessRequest
+* - Cond1_appendMatch_typelessRequest
+* - Cond1_deleteMatch_typelessRequest
 * - Cond1_updateMatch_pattern
 * - Cond1_appendMatch_pattern
 * - Cond1_deleteMatch_pattern
 * - Cond1_updateMatch_pattern_noType
 * - Cond1_appendMatch_pattern_noType
 * - Cond1_deleteMatch_pattern_noType
+* - Cond1_appendMatch_patternBatch
 * - Cond1_updateMatchDisjoint
 * - Cond1_appendMatchDisjoint
 * - Cond1_deleteMatchDisjoint
@@ -782,6 +787,276 @@ TEST(mongoUpdateContext_withOnchangeSubscriptions, Cond1_deleteMatch_noType)
     delete timerMock;
 }
 
+/* ****************************************************************************
+*
+* Cond1_updateMatch_typelessRequest -
+*
+* The request has no type, so E1/T1, E1/T and E1 (without type) are updated. Each
+* notification includes only the entity that triggered it, as it is after the update
+*/
+TEST(mongoUpdateContext_withOnchangeSubscriptions, Cond1_updateMatch_typelessRequest)
+{
+    HttpStatusCode         ms;
+    UpdateContextRequest   req;
+    UpdateContextResponse  res;
+
+    /* Prepare mock */
+    NotifyContextRequest expectedNcr1, expectedNcr3, expectedNcr4T1, expectedNcr4T, expectedNcr4NoType;
+    ContextElementResponse cerT1, cerT, cerNoType;
+    cerT1.contextElement.entityId.fill("E1", "T1", "false");
+    cerT.contextElement.entityId.fill("E1", "T", "false");
+    cerNoType.contextElement.entityId.fill("E1", "", "false");
+    ContextAttribute ca1("A1", "TA1", "new_val");
+    ContextAttribute ca2("A3", "TA3", "W");
+    cerT1.contextElement.contextAttributeVector.push_back(&ca1);
+    cerT1.contextElement.contextAttributeVector.push_back(&ca2);
+    cerT.contextElement.contextAttributeVector.push_back(&ca1);
+    cerT.contextElement.contextAttributeVector.push_back(&ca2);
+    cerNoType.contextElement.contextAttributeVector.push_back(&ca1);
+    cerNoType.contextElement.contextAttributeVector.push_back(&ca2);
+    expectedNcr1.originator.set("localhost");
+    expectedNcr1.contextElementResponseVector.push_back(&cerT1);
+    expectedNcr1.subscriptionId.set("51307b66f481db11bf860001");
+    expectedNcr3.originator.set("localhost");
+    expectedNcr3.contextElementResponseVector.push_back(&cerT);
+    expectedNcr3.subscriptionId.set("51307b66f481db11bf860003");
+    expectedNcr4T1.originator.set("localhost");
+    expectedNcr4T1.contextElementResponseVector.push_back(&cerT1);
+    expectedNcr4T1.subscriptionId.set("51307b66f481db11bf860004");
+    expectedNcr4T.originator.set("localhost");
+    expectedNcr4T.contextElementResponseVector.push_back(&cerT);
+    expectedNcr4T.subscriptionId.set("51307b66f481db11bf860004");
+    expectedNcr4NoType.originator.set("localhost");
+    expectedNcr4NoType.contextElementResponseVector.push_back(&cerNoType);
+    expectedNcr4NoType.subscriptionId.set("51307b66f481db11bf860004");
+
+    NotifierMock* notifierMock = new NotifierMock();
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr1),"http://notify1.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr3),"http://notify3.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4T1),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4T),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4NoType),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, createIntervalThread(_,_,_))
+            .Times(0);
+    setNotifier(notifierMock);
+
+    TimerMock* timerMock = new TimerMock();
+    ON_CALL(*timerMock, getCurrentTime())
+            .WillByDefault(Return(1360232700));
+    setTimer(timerMock);
+
+    /* Forge the request (from "inside" to "outside") */
+    ContextElement ce;
+    ce.entityId.fill("E1", "", "false");
+    ContextAttribute ca("A1", "TA1", "new_val");
+    ce.contextAttributeVector.push_back(&ca);
+    req.contextElementVector.push_back(&ce);
+    req.updateActionType.set("UPDATE");
+
+    /* Prepare database */
+    prepareDatabaseWithNoTypeSubscriptions();
+
+    /* Invoke the function in mongoBackend library */
+    servicePathVector.clear();
+    ms = mongoUpdateContext(&req, &res, "", servicePathVector, uriParams, "");
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+    ASSERT_EQ(3, res.contextElementResponseVector.size());
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    /* Release mock */
+    delete notifierMock;
+    delete timerMock;
+}
+
+/* ****************************************************************************
+*
+* Cond1_appendMatch_typelessRequest -
+*
+* The request has no type, so E1/T1, E1/T and E1 (without type) are updated. Each
+* notification includes only the entity that triggered it, as it is after the update
+*/
+TEST(mongoUpdateContext_withOnchangeSubscriptions, Cond1_appendMatch_typelessRequest)
+{
+    HttpStatusCode         ms;
+    UpdateContextRequest   req;
+    UpdateContextResponse  res;
+
+    /* Prepare mock */
+    NotifyContextRequest expectedNcr1, expectedNcr3, expectedNcr4T1, expectedNcr4T, expectedNcr4NoType;
+    ContextElementResponse cerT1, cerT, cerNoType;
+    cerT1.contextElement.entityId.fill("E1", "T1", "false");
+    cerT.contextElement.entityId.fill("E1", "T", "false");
+    cerNoType.contextElement.entityId.fill("E1", "", "false");
+    ContextAttribute ca1("A1", "TA1", "X");
+    ContextAttribute ca2("A3", "TA3", "W");
+    ContextAttribute ca3("A4", "TA4", "new_val");
+    cerT1.contextElement.contextAttributeVector.push_back(&ca1);
+    cerT1.contextElement.contextAttributeVector.push_back(&ca2);
+    cerT1.contextElement.contextAttributeVector.push_back(&ca3);
+    cerT.contextElement.contextAttributeVector.push_back(&ca1);
+    cerT.contextElement.contextAttributeVector.push_back(&ca2);
+    cerT.contextElement.contextAttributeVector.push_back(&ca3);
+    cerNoType.contextElement.contextAttributeVector.push_back(&ca1);
+    cerNoType.contextElement.contextAttributeVector.push_back(&ca2);
+    cerNoType.contextElement.contextAttributeVector.push_back(&ca3);
+    expectedNcr1.originator.set("localhost");
+    expectedNcr1.contextElementResponseVector.push_back(&cerT1);
+    expectedNcr1.subscriptionId.set("51307b66f481db11bf860001");
+    expectedNcr3.originator.set("localhost");
+    expectedNcr3.contextElementResponseVector.push_back(&cerT);
+    expectedNcr3.subscriptionId.set("51307b66f481db11bf860003");
+    expectedNcr4T1.originator.set("localhost");
+    expectedNcr4T1.contextElementResponseVector.push_back(&cerT1);
+    expectedNcr4T1.subscriptionId.set("51307b66f481db11bf860004");
+    expectedNcr4T.originator.set("localhost");
+    expectedNcr4T.contextElementResponseVector.push_back(&cerT);
+    expectedNcr4T.subscriptionId.set("51307b66f481db11bf860004");
+    expectedNcr4NoType.originator.set("localhost");
+    expectedNcr4NoType.contextElementResponseVector.push_back(&cerNoType);
+    expectedNcr4NoType.subscriptionId.set("51307b66f481db11bf860004");
+
+    NotifierMock* notifierMock = new NotifierMock();
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr1),"http://notify1.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr3),"http://notify3.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4T1),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4T),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4NoType),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, createIntervalThread(_,_,_))
+            .Times(0);
+    setNotifier(notifierMock);
+
+    TimerMock* timerMock = new TimerMock();
+    ON_CALL(*timerMock, getCurrentTime())
+            .WillByDefault(Return(1360232700));
+    setTimer(timerMock);
+
+    /* Forge the request (from "inside" to "outside") */
+    ContextElement ce;
+    ce.entityId.fill("E1", "", "false");
+    ContextAttribute ca("A4", "TA4", "new_val");
+    ce.contextAttributeVector.push_back(&ca);
+    req.contextElementVector.push_back(&ce);
+    req.updateActionType.set("APPEND");
+
+    /* Prepare database */
+    prepareDatabaseWithNoTypeSubscriptions();
+
+    /* Invoke the function in mongoBackend library */
+    servicePathVector.clear();
+    ms = mongoUpdateContext(&req, &res, "", servicePathVector, uriParams, "");
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+    ASSERT_EQ(3, res.contextElementResponseVector.size());
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    /* Release mock */
+    delete notifierMock;
+    delete timerMock;
+}
+
+/* ****************************************************************************
+*
+* Cond1_deleteMatch_typelessRequest -
+*
+* The request has no type, so E1/T1, E1/T and E1 (without type) are updated. Each
+* notification includes only the entity that triggered it, as it is after the update
+*/
+TEST(mongoUpdateContext_withOnchangeSubscriptions, Cond1_deleteMatch_typelessRequest)
+{
+    HttpStatusCode         ms;
+    UpdateContextRequest   req;
+    UpdateContextResponse  res;
+
+    /* Prepare mock */
+    NotifyContextRequest expectedNcr1, expectedNcr3, expectedNcr4T1, expectedNcr4T, expectedNcr4NoType;
+    ContextElementResponse cerT1, cerT, cerNoType;
+    cerT1.contextElement.entityId.fill("E1", "T1", "false");
+    cerT.contextElement.entityId.fill("E1", "T", "false");
+    cerNoType.contextElement.entityId.fill("E1", "", "false");
+    ContextAttribute ca1("A3", "TA3", "W");
+    cerT1.contextElement.contextAttributeVector.push_back(&ca1);
+    cerT.contextElement.contextAttributeVector.push_back(&ca1);
+    cerNoType.contextElement.contextAttributeVector.push_back(&ca1);
+    expectedNcr1.originator.set("localhost");
+    expectedNcr1.contextElementResponseVector.push_back(&cerT1);
+    expectedNcr1.subscriptionId.set("51307b66f481db11bf860001");
+    expectedNcr3.originator.set("localhost");
+    expectedNcr3.contextElementResponseVector.push_back(&cerT);
+    expectedNcr3.subscriptionId.set("51307b66f481db11bf860003");
+    expectedNcr4T1.originator.set("localhost");
+    expectedNcr4T1.contextElementResponseVector.push_back(&cerT1);
+    expectedNcr4T1.subscriptionId.set("51307b66f481db11bf860004");
+    expectedNcr4T.originator.set("localhost");
+    expectedNcr4T.contextElementResponseVector.push_back(&cerT);
+    expectedNcr4T.subscriptionId.set("51307b66f481db11bf860004");
+    expectedNcr4NoType.originator.set("localhost");
+    expectedNcr4NoType.contextElementResponseVector.push_back(&cerNoType);
+    expectedNcr4NoType.subscriptionId.set("51307b66f481db11bf860004");
+
+    NotifierMock* notifierMock = new NotifierMock();
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr1),"http://notify1.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr3),"http://notify3.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4T1),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4T),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr4NoType),"http://notify4.me", "", "", XML))
+            .Times(1);
+    EXPECT_CALL(*notifierMock, createIntervalThread(_,_,_))
+            .Times(0);
+    setNotifier(notifierMock);
+
+    TimerMock* timerMock = new TimerMock();
+    ON_CALL(*timerMock, getCurrentTime())
+            .WillByDefault(Return(1360232700));
+    setTimer(timerMock);
+
+    /* Forge the request (from "inside" to "outside") */
+    ContextElement ce;
+    ce.entityId.fill("E1", "", "false");
+    ContextAttribute ca("A1", "TA1", "");
+    ce.contextAttributeVector.push_back(&ca);
+    req.contextElementVector.push_back(&ce);
+    req.updateActionType.set("DELETE");
+
+    /* Prepare database */
+    prepareDatabaseWithNoTypeSubscriptions();
+
+    /* Invoke the function in mongoBackend library */
+    servicePathVector.clear();
+    ms = mongoUpdateContext(&req, &res, "", servicePathVector, uriParams, "");
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+    ASSERT_EQ(3, res.contextElementResponseVector.size());
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    /* Release mock */
+    delete notifierMock;
+    delete timerMock;
+}
+
 /* ****************************************************************************
 *
 * Cond1_updateMatch_pattern -
@@ -913,6 +1188,87 @@ TEST(mongoUpdateContext_withOnchangeSubscriptions, Cond1_appendMatch_pattern)
     delete timerMock;
 }
 
+/* ****************************************************************************
+*
+* Cond1_appendMatch_patternBatch -
+*
+* With the batch write path, a pattern that can not be evaluated in memory ("\d" is
+* not the same in POSIX and in JavaScript) is resolved by the database, as without it
+*/
+TEST(mongoUpdateContext_withOnchangeSubscriptions, Cond1_appendMatch_patternBatch)
+{
+    HttpStatusCode         ms;
+    UpdateContextRequest   req;
+    UpdateContextResponse  res;
+
+    /* Prepare mock */
+    NotifierMock* notifierMock = new NotifierMock();
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(_,"http://notify3.me", "", "", XML))
+            .Times(2);
+    EXPECT_CALL(*notifierMock, sendNotifyContextRequest(_,"http://notify6.me", "", "", XML))
+            .Times(2);
+    EXPECT_CALL(*notifierMock, createIntervalThread(_,_,_))
+            .Times(0);
+    setNotifier(notifierMock);
+
+    TimerMock* timerMock = new TimerMock();
+    ON_CALL(*timerMock, getCurrentTime())
+            .WillByDefault(Return(1360232700));
+    setTimer(timerMock);
+
+    /* Forge the request (from "inside" to "outside") */
+    ContextElement ce1, ce2;
+    ce1.entityId.fill("E1", "T", "false");
+    ContextAttribute ca1("A4", "TA4", "new_val");
+    ce1.contextAttributeVector.push_back(&ca1);
+    ce2.entityId.fill("E2", "T", "false");
+    ContextAttribute ca2("A4", "TA4", "new_val");
+    ce2.contextAttributeVector.push_back(&ca2);
+    req.contextElementVector.push_back(&ce1);
+    req.contextElementVector.push_back(&ce2);
+    req.updateActionType.set("APPEND");
+
+    /* Prepare database */
+    prepareDatabase();
+
+    DBClientBase* connection = getMongoConnection();
+    BSONObj sub6 = BSON("_id" << OID("51307b66f481db11bf860006") <<
+                        "expiration" << 1500000000 <<
+                        "lastNotification" << 20000000 <<
+                        "reference" << "http://notify6.me" <<
+                        "entities" << BSON_ARRAY(BSON("id" << "E\\d" << "type" << "T" << "isPattern" << "true")) <<
+                        "attrs" << BSON_ARRAY("A1" << "A3" << "A4") <<
+                        "conditions" << BSON_ARRAY(BSON(
+                                                       "type" << "ONCHANGE" <<
+                                                       "value" << BSON_ARRAY("A1" << "A2" << "A4" << "A5")
+                                                       ))
+                        );
+    connection->insert(SUBSCRIBECONTEXT_COLL, sub6);
+
+    /* Invoke the function in mongoBackend library */
+    setUpdateBatch(true);
+    servicePathVector.clear();
+    ms = mongoUpdateContext(&req, &res, "", servicePathVector, uriParams, "");
+    setUpdateBatch(false);
+
+    /* Check response is as expected */
+    EXPECT_EQ(SccOk, ms);
+    ASSERT_EQ(2, res.contextElementResponseVector.size());
+    EXPECT_EQ(SccOk, RES_CER_STATUS(0).code);
+    EXPECT_EQ(SccOk, RES_CER_STATUS(1).code);
+
+    /* Check lastNotification */
+    BSONObj sub = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID("51307b66f481db11bf860006")));
+    EXPECT_EQ(1360232700, sub.getIntField("lastNotification"));
+
+    /* Release connection */
+    setMongoConnectionForUnitTest(NULL);
+
+    /* Release mock */
+    delete notifierMock;
+    delete timerMock;
+}
+
 /* ****************************************************************************
 *
 * Cond1_deleteMatch_pattern -
@@ -0,0 +1,189 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <string.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "mongoBackend/MongoGlobal.h"
+
+#include "mongo/client/dbclient.h"
+
+
+
+/* ****************************************************************************
+*
+* BENCHMARK_LOOPS -
+*/
+#define BENCHMARK_LOOPS  100000
+
+
+
+/* ****************************************************************************
+*
+* pathV -
+*/
+static std::vector<std::string> pathV(const char* p1, const char* p2 = NULL)
+{
+  std::vector<std::string> v;
+
+  v.push_back(p1);
+
+  if (p2 != NULL)
+  {
+    v.push_back(p2);
+  }
+
+  return v;
+}
+
+
+
+/* ****************************************************************************
+*
+* usecsGet -
+*/
+static long long usecsGet(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (long long) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+/* ****************************************************************************
+*
+* regexFilter - the filter as it was built before, composing JSON for fromjson()
+*/
+static BSONObj regexFilter(const std::vector<std::string>& servicePath)
+{
+  std::string  value     = "{ $in: [ ";
+  bool         nullAdded = false;
+
+  for (unsigned int ix = 0 ; ix < servicePath.size(); ++ix)
+  {
+    if (!nullAdded && ((servicePath[ix] == "/") || (servicePath[ix] == "/#")))
+    {
+      value += "null, ";
+      nullAdded = true;
+    }
+
+    char path[MAX_SERVICE_NAME_LEN];
+    slashEscape(servicePath[ix].c_str(), path, sizeof(path));
+
+    if (path[strlen(path) - 1] == '#')
+    {
+      path[strlen(path) - 3] = 0;
+      value += std::string("/^") + path + "$/, " + std::string("/^") + path + "\\/.*/";
+    }
+    else
+    {
+      value += std::string("/^") + path + "$/";
+    }
+
+    if (ix < servicePath.size() - 1)
+    {
+      value += std::string(", ");
+    }
+  }
+
+  value += " ] }";
+
+  return fromjson(value);
+}
+
+
+
+/* ****************************************************************************
+*
+* query - filters for the entities in a service path
+*/
+TEST(servicePathFilter, query)
+{
+  std::vector<std::string> none;
+
+  EXPECT_EQ("{ $in: [ /^//, null ] }",                   fillQueryServicePath(none).toString());
+  EXPECT_EQ("{ $in: [ \"/home/kitchen\" ] }",            fillQueryServicePath(pathV("/home/kitchen")).toString());
+  EXPECT_EQ("{ $in: [ \"/home\", /^/home// ] }",         fillQueryServicePath(pathV("/home/#")).toString());
+  EXPECT_EQ("{ $in: [ null, \"/\" ] }",                  fillQueryServicePath(pathV("/")).toString());
+  EXPECT_EQ("{ $in: [ null, \"\", /^// ] }",             fillQueryServicePath(pathV("/#")).toString());
+  EXPECT_EQ("{ $in: [ \"/a\", \"/b\", /^/b// ] }",       fillQueryServicePath(pathV("/a", "/b/#")).toString());
+
+  /* Second time, from the cache */
+  EXPECT_EQ("{ $in: [ \"/home\", /^/home// ] }",         fillQueryServicePath(pathV("/home/#")).toString());
+}
+
+
+
+/* ****************************************************************************
+*
+* subscription - filters for the subscriptions covering an entity
+*/
+TEST(servicePathFilter, subscription)
+{
+  EXPECT_EQ("{ $in: [ \"\", \"/#\", \"/\", null ] }", fillQuerySubscriptionServicePath("").toString());
+  EXPECT_EQ("{ $in: [ \"\", \"/#\", \"/a1/#\", \"/a1/a2/#\", \"/a1/a2\", null ] }",
+            fillQuerySubscriptionServicePath("/a1/a2").toString());
+}
+
+
+
+/* ****************************************************************************
+*
+* benchmark - filter built with fromjson() vs the BSON filters (cached)
+*/
+TEST(servicePathFilter, benchmark)
+{
+  std::vector<std::string>  spV = pathV("/madrid/retiro/#", "/madrid/centro");
+  long long                 start;
+  long long                 regexUsecs;
+  long long                 bsonUsecs;
+  int                       size = 0;
+
+  start = usecsGet();
+  for (int ix = 0; ix < BENCHMARK_LOOPS; ++ix)
+  {
+    size += regexFilter(spV).objsize();
+  }
+  regexUsecs = usecsGet() - start;
+
+  start = usecsGet();
+  for (int ix = 0; ix < BENCHMARK_LOOPS; ++ix)
+  {
+    size += fillQueryServicePath(spV).objsize();
+  }
+  bsonUsecs = usecsGet() - start;
+
+  EXPECT_LT(0, size);
+  EXPECT_LT(bsonUsecs, regexUsecs);
+
+  RecordProperty("regexUsecs", (int) regexUsecs);
+  RecordProperty("bsonUsecs",  (int) bsonUsecs);
+}
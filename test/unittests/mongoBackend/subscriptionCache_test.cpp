@@ -0,0 +1,222 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <map>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "testInit.h"
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "common/globals.h"
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/TriggeredSubscription.h"
+#include "mongoBackend/subscriptionCache.h"
+
+#include "mongo/client/dbclient.h"
+
+#include "commonMocks.h"
+
+using ::testing::Return;
+
+
+
+/* ****************************************************************************
+*
+* matchRelease -
+*/
+static void matchRelease(std::map<std::string, TriggeredSubscription*>& subs)
+{
+  for (std::map<std::string, TriggeredSubscription*>::iterator it = subs.begin(); it != subs.end(); ++it)
+  {
+    it->second->attrL.release();
+    delete it->second;
+  }
+
+  subs.clear();
+}
+
+
+
+/* ****************************************************************************
+*
+* match -
+*/
+TEST(subscriptionCache, match)
+{
+  std::map<std::string, TriggeredSubscription*> subs;
+
+  TimerMock* timerMock = new TimerMock();
+  ON_CALL(*timerMock, getCurrentTime())
+          .WillByDefault(Return(1360232700));
+  setTimer(timerMock);
+
+  subCacheInit(true);
+
+  BSONObj sub1 = BSON("expiration" << 1879048191 <<
+                      "reference" << "http://notify1.me" <<
+                      "entities" << BSON_ARRAY(BSON("id" << "E1" << "type" << "T1" << "isPattern" << "false")) <<
+                      "attrs" << BSON_ARRAY("A1") <<
+                      "conditions" << BSON_ARRAY(BSON("type" << "ONCHANGE" << "value" << BSON_ARRAY("A1"))) <<
+                      "servicePath" << "/home/#" <<
+                      "format" << "JSON");
+
+  BSONObj sub2 = BSON("expiration" << 1879048191 <<
+                      "reference" << "http://notify2.me" <<
+                      "entities" << BSON_ARRAY(BSON("id" << "E.*" << "isPattern" << "true")) <<
+                      "attrs" << BSONArray() <<
+                      "conditions" << BSON_ARRAY(BSON("type" << "ONCHANGE" << "value" << BSON_ARRAY("A1" << "A2"))));
+
+  BSONObj sub3 = BSON("expiration" << 1000 <<
+                      "reference" << "http://notify3.me" <<
+                      "entities" << BSON_ARRAY(BSON("id" << "E1" << "isPattern" << "false")) <<
+                      "attrs" << BSONArray() <<
+                      "conditions" << BSON_ARRAY(BSON("type" << "ONCHANGE" << "value" << BSON_ARRAY("A1"))));
+
+  subCacheInsert("", "51307b66f481db11bf860001", sub1);
+  subCacheInsert("", "51307b66f481db11bf860002", sub2);
+  subCacheInsert("", "51307b66f481db11bf860003", sub3);
+
+  /* Both sub1 and sub2 (sub3 is expired) */
+  subCacheMatch("", "E1", "T1", "A1", "/home/kitchen", subs);
+  EXPECT_EQ(2, subs.size());
+  ASSERT_EQ(1, subs.count("51307b66f481db11bf860001"));
+  EXPECT_EQ(JSON, subs["51307b66f481db11bf860001"]->format);
+  EXPECT_EQ("http://notify1.me", subs["51307b66f481db11bf860001"]->reference);
+  EXPECT_EQ(1, subs["51307b66f481db11bf860001"]->attrL.size());
+  EXPECT_EQ(1, subs.count("51307b66f481db11bf860002"));
+  matchRelease(subs);
+
+  /* Type mismatch for sub1 */
+  subCacheMatch("", "E1", "T2", "A1", "/home", subs);
+  EXPECT_EQ(1, subs.size());
+  EXPECT_EQ(1, subs.count("51307b66f481db11bf860002"));
+  matchRelease(subs);
+
+  /* Service path mismatch for sub1 */
+  subCacheMatch("", "E1", "T1", "A1", "/office", subs);
+  EXPECT_EQ(1, subs.size());
+  EXPECT_EQ(1, subs.count("51307b66f481db11bf860002"));
+  matchRelease(subs);
+
+  /* Attribute not in the conditions of sub1 */
+  subCacheMatch("", "E1", "T1", "A2", "/home", subs);
+  EXPECT_EQ(1, subs.size());
+  EXPECT_EQ(1, subs.count("51307b66f481db11bf860002"));
+  matchRelease(subs);
+
+  /* Other tenant */
+  subCacheMatch("t1", "E1", "T1", "A1", "/home", subs);
+  EXPECT_EQ(0, subs.size());
+
+  /* Remove sub2 */
+  subCacheRemove("", "51307b66f481db11bf860002");
+  subCacheMatch("", "E1", "T1", "A1", "/home", subs);
+  EXPECT_EQ(1, subs.size());
+  EXPECT_EQ(1, subs.count("51307b66f481db11bf860001"));
+  matchRelease(subs);
+
+  /* Last notification update */
+  subCacheLastNotificationSet("", "51307b66f481db11bf860001", 1360232000);
+  subCacheMatch("", "E1", "T1", "A1", "/home", subs);
+  ASSERT_EQ(1, subs.size());
+  EXPECT_EQ(1360232000, subs["51307b66f481db11bf860001"]->lastNotification);
+  matchRelease(subs);
+
+  subCacheRemove("", "51307b66f481db11bf860001");
+  subCacheRemove("", "51307b66f481db11bf860003");
+  subCacheInit(false);
+
+  delete timerMock;
+}
+
+
+
+/* ****************************************************************************
+*
+* patterns - JavaScript patterns without the same meaning in POSIX are left to the database
+*/
+TEST(subscriptionCache, patterns)
+{
+  std::map<std::string, TriggeredSubscription*> subs;
+
+  TimerMock* timerMock = new TimerMock();
+  ON_CALL(*timerMock, getCurrentTime())
+          .WillByDefault(Return(1360232700));
+  setTimer(timerMock);
+
+  subCacheInit(true);
+
+  BSONObj sub1 = BSON("expiration" << 1879048191 <<
+                      "reference" << "http://notify1.me" <<
+                      "entities" << BSON_ARRAY(BSON("id" << "Room[0-9]+" << "type" << "T" << "isPattern" << "true")) <<
+                      "attrs" << BSONArray() <<
+                      "conditions" << BSON_ARRAY(BSON("type" << "ONCHANGE" << "value" << BSON_ARRAY("A1"))));
+
+  BSONObj sub2 = BSON("expiration" << 1879048191 <<
+                      "reference" << "http://notify2.me" <<
+                      "entities" << BSON_ARRAY(BSON("id" << "Room\\d+" << "type" << "T" << "isPattern" << "true")) <<
+                      "attrs" << BSONArray() <<
+                      "conditions" << BSON_ARRAY(BSON("type" << "ONCHANGE" << "value" << BSON_ARRAY("A2"))));
+
+  BSONObj sub3 = BSON("expiration" << 1879048191 <<
+                      "reference" << "http://notify3.me" <<
+                      "entities" << BSON_ARRAY(BSON("id" << "Ro+?m" << "type" << "T2" << "isPattern" << "true")) <<
+                      "attrs" << BSONArray() <<
+                      "conditions" << BSON_ARRAY(BSON("type" << "ONCHANGE" << "value" << BSON_ARRAY("A1"))));
+
+  subCacheInsert("", "51307b66f481db11bf860001", sub1);
+  subCacheInsert("", "51307b66f481db11bf860002", sub2);
+  subCacheInsert("", "51307b66f481db11bf860003", sub3);
+
+  /* The ERE-compatible pattern is resolved in memory (sub3 has another type) */
+  EXPECT_TRUE(subCacheMatch("", "Room12", "T", "A1", "/", subs));
+  EXPECT_EQ(1, subs.size());
+  EXPECT_EQ(1, subs.count("51307b66f481db11bf860001"));
+  matchRelease(subs);
+
+  EXPECT_TRUE(subCacheMatch("", "Hall", "T", "A1", "/", subs));
+  EXPECT_EQ(0, subs.size());
+
+  /* \d is not POSIX: the database has to be queried */
+  EXPECT_FALSE(subCacheMatch("", "Room12", "T", "A2", "/", subs));
+  EXPECT_EQ(0, subs.size());
+
+  /* Neither are lazy quantifiers */
+  EXPECT_FALSE(subCacheMatch("", "Room", "T2", "A1", "/", subs));
+  matchRelease(subs);
+
+  /* Unknown tenant */
+  EXPECT_TRUE(subCacheMatch("t2", "Room12", "T", "A2", "/", subs));
+  EXPECT_EQ(0, subs.size());
+
+  subCacheRemove("", "51307b66f481db11bf860001");
+  subCacheRemove("", "51307b66f481db11bf860002");
+  subCacheRemove("", "51307b66f481db11bf860003");
+  subCacheInit(false);
+
+  delete timerMock;
+}
@@ -0,0 +1,142 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <string>
+
+#include "gtest/gtest.h"
+#include "testInit.h"
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/subscriptionCounters.h"
+
+#include "mongo/client/dbclient.h"
+
+
+
+/* ****************************************************************************
+*
+* flush -
+*/
+TEST(subscriptionCounters, flush)
+{
+  const std::string subId = "51307b66f481db11bf860001";
+
+  setupDatabase();
+
+  DBClientBase* connection = getMongoConnection();
+
+  connection->insert(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId) <<
+                                                 "expiration" << 1879048191 <<
+                                                 "lastNotification" << 15000000 <<
+                                                 "count" << 3 <<
+                                                 "reference" << "http://notify1.me"));
+
+  subCountersInit(3600);
+  EXPECT_TRUE(subCountersActive());
+  EXPECT_EQ(-1, subCountersLastNotificationGet("", subId));
+
+  /* Accumulated in memory, the most recent lastNotification is kept */
+  subCountersNotified("", subId, 20000000);
+  subCountersNotified("", subId, 19000000);
+  EXPECT_EQ(20000000, subCountersLastNotificationGet("", subId));
+  EXPECT_EQ(-1, subCountersLastNotificationGet("t1", subId));
+
+  BSONObj sub = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId)));
+  EXPECT_EQ(15000000, sub.getIntField("lastNotification"));
+  EXPECT_EQ(3, sub.getIntField("count"));
+
+  /* Written to the database by the flush */
+  subCountersFlush();
+  EXPECT_EQ(-1, subCountersLastNotificationGet("", subId));
+
+  sub = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId)));
+  EXPECT_EQ(20000000, sub.getIntField("lastNotification"));
+  EXPECT_EQ(5, sub.getIntField("count"));
+
+  subCountersShutdown();
+  EXPECT_FALSE(subCountersActive());
+}
+
+
+
+/* ****************************************************************************
+*
+* partialFailure - only the updates that failed are retried, count is not incremented twice
+*
+* The count of the second subscription is not a number, so its $inc fails (the whole update
+* of that subscription, actually) while the update of the first subscription is applied.
+*/
+TEST(subscriptionCounters, partialFailure)
+{
+  const std::string subId1 = "51307b66f481db11bf860001";
+  const std::string subId2 = "51307b66f481db11bf860002";
+
+  setupDatabase();
+
+  DBClientBase* connection = getMongoConnection();
+
+  connection->insert(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId1) <<
+                                                 "expiration" << 1879048191 <<
+                                                 "lastNotification" << 15000000 <<
+                                                 "count" << 3 <<
+                                                 "reference" << "http://notify1.me"));
+  connection->insert(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId2) <<
+                                                 "expiration" << 1879048191 <<
+                                                 "lastNotification" << 15000000 <<
+                                                 "count" << "three" <<
+                                                 "reference" << "http://notify2.me"));
+
+  subCountersInit(3600);
+
+  subCountersNotified("", subId1, 20000000);
+  subCountersNotified("", subId2, 20000000);
+  subCountersFlush();
+
+  /* The first one is written, the second one is still pending */
+  EXPECT_EQ(-1, subCountersLastNotificationGet("", subId1));
+  EXPECT_EQ(20000000, subCountersLastNotificationGet("", subId2));
+
+  BSONObj sub1 = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId1)));
+  BSONObj sub2 = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId2)));
+
+  EXPECT_EQ(20000000, sub1.getIntField("lastNotification"));
+  EXPECT_EQ(4, sub1.getIntField("count"));
+  EXPECT_EQ(15000000, sub2.getIntField("lastNotification"));
+
+  /* Once the second one is fixed, the retry writes it, without touching the first one */
+  connection->update(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId2)), BSON("$set" << BSON("count" << 10)));
+  subCountersShutdown();
+
+  EXPECT_EQ(-1, subCountersLastNotificationGet("", subId2));
+
+  sub1 = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId1)));
+  sub2 = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID(subId2)));
+
+  EXPECT_EQ(4, sub1.getIntField("count"));
+  EXPECT_EQ(20000000, sub2.getIntField("lastNotification"));
+  EXPECT_EQ(11, sub2.getIntField("count"));
+}
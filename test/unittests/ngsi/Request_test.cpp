@@ -85,6 +85,8 @@ TEST(Request, requestType)
     { LogRequest,                                  "Log"                                                    },
     { VersionRequest,                              "Version"                                                },
     { StatisticsRequest,                           "Statistics"                                             },
+    { MetricsRequest,                              "Metrics"                                                },
+    { IndexesRequest,                              "Indexes"                                                },
     { ExitRequest,                                 "Exit"                                                   },
     { LeakRequest,                                 "Leak"                                                   },
     { RegisterResponse,                            "RegisterContextResponse"                                },
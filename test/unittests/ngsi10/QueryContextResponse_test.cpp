@@ -22,8 +22,16 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdio.h>
+#include <sys/time.h>
+
+#include <string>
+
 #include "gtest/gtest.h"
 
+#include "ngsi/ContextElementResponse.h"
+#include "ngsi/ContextAttribute.h"
+#include "ngsi/Metadata.h"
 #include "ngsi10/QueryContextResponse.h"
 #include "rest/ConnectionInfo.h"
 
@@ -232,3 +240,205 @@ TEST(QueryContextResponse, json_render)
 
   utExit();
 }
+
+
+
+/* ****************************************************************************
+*
+* largeResponseBuild - a response of 'entities' context elements
+*
+* With characters to be escaped, metadata, domain metadata, attribute domain names and
+* error status codes here and there.
+*/
+static void largeResponseBuild(QueryContextResponse* qcrP, int entities)
+{
+  for (int ix = 0; ix < entities; ++ix)
+  {
+    ContextElementResponse*  cerP = new ContextElementResponse();
+    ContextAttribute*        a1   = new ContextAttribute("temperature", "float", "23.5");
+    ContextAttribute*        a2   = new ContextAttribute("desc", "string", "a (b) = 'c'; d");
+    char                     id[64];
+
+    snprintf(id, sizeof(id), "Room<%d>", ix);
+    cerP->contextElement.entityId.fill(id, "Ro\"om", (ix % 10 == 9)? "true" : "false");
+
+    a2->metadataVector.push_back(new Metadata("ID", "string", "m1"));
+    if (ix % 5 == 0)
+    {
+      a2->metadataVector.push_back(new Metadata("unit", "string", "<none>"));
+    }
+
+    cerP->contextElement.contextAttributeVector.push_back(a1);
+    cerP->contextElement.contextAttributeVector.push_back(a2);
+
+    if (ix % 3 == 0)
+    {
+      cerP->contextElement.domainMetadataVector.push_back(new Metadata("dm", "string", "domain"));
+    }
+
+    if (ix % 4 == 0)
+    {
+      cerP->contextElement.attributeDomainName.set("Domain");
+    }
+
+    if (ix % 11 == 0)
+    {
+      cerP->statusCode.fill(SccContextElementNotFound, "no <such> entity");
+    }
+    else if (ix % 7 == 0)
+    {
+      cerP->statusCode.fill(SccOk, "some (details)");
+    }
+    else
+    {
+      cerP->statusCode.fill(SccOk, "");
+    }
+
+    qcrP->contextElementResponseVector.push_back(cerP);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* fileRead - the whole content of a file in testData (too large for testDataFromFile)
+*/
+static std::string fileRead(const char* fileName)
+{
+  std::string  path  = std::string("test/unittests/testData/") + fileName;
+  FILE*        fP    = fopen(path.c_str(), "r");
+  std::string  content;
+  char         buf[4096];
+  size_t       nb;
+
+  if (fP == NULL)
+  {
+    return "";
+  }
+
+  while ((nb = fread(buf, 1, sizeof(buf), fP)) > 0)
+  {
+    content.append(buf, nb);
+  }
+
+  fclose(fP);
+
+  return content;
+}
+
+
+
+/* ****************************************************************************
+*
+* largeRender - 
+*
+* A large response rendered into a single buffer is byte by byte the same as with
+* the former render path (the expected files were generated with the string-returning
+* render functions, before the buffer overloads were introduced)
+*/
+TEST(QueryContextResponse, largeRender)
+{
+  QueryContextResponse  qcr;
+  ConnectionInfo        ciXml(XML);
+  ConnectionInfo        ciJson(JSON);
+  std::string           expected;
+
+  utInit();
+
+  largeResponseBuild(&qcr, 40);
+
+  expected = fileRead("ngsi10.queryContextResponse.large.valid.xml");
+  ASSERT_NE("", expected);
+  EXPECT_EQ(expected, qcr.render(&ciXml, QueryContext, ""));
+
+  expected = fileRead("ngsi10.queryContextResponse.large.valid.json");
+  ASSERT_NE("", expected);
+  EXPECT_EQ(expected, qcr.render(&ciJson, QueryContext, ""));
+
+  qcr.release();
+
+  utExit();
+}
+
+
+
+/* ****************************************************************************
+*
+* usecsGet - 
+*/
+static long long usecsGet(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (long long) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+/* ****************************************************************************
+*
+* largeRenderBenchmark - a single buffer vs a string per context element
+*
+* The context element responses rendered into one buffer, against rendering each one of
+* them into a string of its own (as the string-returning render functions do) and appending
+* it. The times are not checked (the result depends on the machine load) but recorded as
+* properties of the test, in the XML output of gtest.
+*/
+TEST(QueryContextResponse, largeRenderBenchmark)
+{
+  const int             entities  = 1000;
+  const int             loops     = 20;
+  Format                formatV[] = { XML, JSON };
+  QueryContextResponse  qcr;
+
+  utInit();
+
+  largeResponseBuild(&qcr, entities);
+
+  ContextElementResponseVector& cerV = qcr.contextElementResponseVector;
+
+  for (unsigned int fx = 0; fx < sizeof(formatV) / sizeof(formatV[0]); ++fx)
+  {
+    ConnectionInfo  ci(formatV[fx]);
+    std::string     bufferOut;
+    std::string     stringOut;
+    long long       start;
+    long long       bufferUsecs;
+    long long       stringUsecs;
+
+    start = usecsGet();
+    for (int loop = 0; loop < loops; ++loop)
+    {
+      bufferOut = "";
+      for (unsigned int ix = 0; ix < cerV.size(); ++ix)
+      {
+        cerV[ix]->render(bufferOut, &ci, QueryContext, "", ix != cerV.size() - 1);
+      }
+    }
+    bufferUsecs = usecsGet() - start;
+
+    start = usecsGet();
+    for (int loop = 0; loop < loops; ++loop)
+    {
+      stringOut = "";
+      for (unsigned int ix = 0; ix < cerV.size(); ++ix)
+      {
+        stringOut += cerV[ix]->render(&ci, QueryContext, "", ix != cerV.size() - 1);
+      }
+    }
+    stringUsecs = usecsGet() - start;
+
+    EXPECT_EQ(stringOut, bufferOut);
+
+    std::string prefix = (formatV[fx] == XML)? "xml" : "json";
+
+    RecordProperty(prefix + "BufferUsecs", (int) (bufferUsecs / loops));
+    RecordProperty(prefix + "StringUsecs", (int) (stringUsecs / loops));
+  }
+
+  qcr.release();
+
+  utExit();
+}
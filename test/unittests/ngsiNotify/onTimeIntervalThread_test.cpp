@@ -0,0 +1,312 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <time.h>
+
+#include <string>
+
+#include "unittest.h"
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "ngsi/ContextElementResponse.h"
+#include "ngsi10/NotifyContextRequest.h"
+#include "ngsiNotify/onTimeIntervalThread.h"
+
+#include "mongo/client/dbclient.h"
+
+
+
+/* ****************************************************************************
+*
+* Tests
+*
+* - scheduleUnschedule
+* - interval
+* - grouping
+* - throttling
+* - expiration
+*
+* The scheduler thread is not started, the due conditions are served by onTimeIntervalRun
+* and the time of the notifications (getCurrentTime) is the one of the TimerMock of utInit.
+*/
+
+
+
+/* ****************************************************************************
+*
+* prepareDatabase -
+*
+* Entities:
+*
+* - E1/T1: A1, A2
+*
+* Subscriptions (all of them on E1/T1):
+*
+* - sub1: A1
+* - sub2: A1 (same query as sub1)
+* - sub3: A2
+* - sub4: A1, throttling 10, notified 5 seconds ago
+* - sub5: A1, throttling 10, notified 100 seconds ago
+* - sub6: A1, expired
+*/
+static void prepareDatabase(void)
+{
+  setupDatabase();
+
+  DBClientBase* connection = getMongoConnection();
+
+  connection->insert(ENTITIES_COLL, BSON("_id" << BSON("id" << "E1" << "type" << "T1") <<
+                                         "attrNames" << BSON_ARRAY("A1" << "A2") <<
+                                         "attrs" << BSON("A1" << BSON("type" << "TA1" << "value" << "X") <<
+                                                         "A2" << BSON("type" << "TA2" << "value" << "Z"))));
+
+  const char* subIds[]      = { "51307b66f481db11bf860001", "51307b66f481db11bf860002", "51307b66f481db11bf860003",
+                                "51307b66f481db11bf860004", "51307b66f481db11bf860005", "51307b66f481db11bf860006" };
+  const char* references[]  = { "http://notify1.me", "http://notify2.me", "http://notify3.me",
+                                "http://notify4.me", "http://notify5.me", "http://notify6.me" };
+  const char* attrs[]       = { "A1", "A1", "A2", "A1", "A1", "A1" };
+  int         expirations[] = { 1500000000, 1500000000, 1500000000, 1500000000, 1500000000, 1360232700 };
+  int         lastNotifs[]  = { 20000000, 20000000, 20000000, 1360232695, 1360232600, 20000000 };
+
+  for (unsigned int ix = 0; ix < 6; ++ix)
+  {
+    BSONObjBuilder bob;
+
+    bob.append("_id", OID(subIds[ix]));
+    bob.append("expiration", expirations[ix]);
+    bob.append("lastNotification", lastNotifs[ix]);
+    bob.append("reference", references[ix]);
+    bob.append("entities", BSON_ARRAY(BSON("id" << "E1" << "type" << "T1" << "isPattern" << "false")));
+    bob.append("attrs", BSON_ARRAY(attrs[ix]));
+    bob.append("conditions", BSON_ARRAY(BSON("type" << "ONTIMEINTERVAL" << "value" << 60)));
+    bob.append("format", "XML");
+
+    if ((ix == 3) || (ix == 4))
+    {
+      bob.append("throttling", 10);
+    }
+
+    connection->insert(SUBSCRIBECONTEXT_COLL, bob.obj());
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* scheduleUnschedule -
+*
+* The conditions of an unscheduled subscription are left in the schedule (marked as
+* removed) but no notification is sent for them.
+*/
+TEST(onTimeIntervalThread, scheduleUnschedule)
+{
+  utInit();
+  prepareDatabase();
+  onTimeIntervalResetForUnitTest();
+
+  NotifierMock notifierMock;
+
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(_, "http://notify1.me", "", "", XML))
+    .Times(0);
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(_, "http://notify2.me", "", "", XML))
+    .Times(1);
+
+  onTimeIntervalSchedule("51307b66f481db11bf860001", 60, "", &notifierMock);
+  onTimeIntervalSchedule("51307b66f481db11bf860001", 120, "", &notifierMock);
+  onTimeIntervalSchedule("51307b66f481db11bf860002", 60, "", &notifierMock);
+
+  EXPECT_EQ(2, onTimeIntervalScheduled("51307b66f481db11bf860001"));
+  EXPECT_EQ(1, onTimeIntervalScheduled("51307b66f481db11bf860002"));
+
+  onTimeIntervalUnschedule("51307b66f481db11bf860001");
+
+  EXPECT_EQ(0, onTimeIntervalScheduled("51307b66f481db11bf860001"));
+  EXPECT_EQ(1, onTimeIntervalScheduled("51307b66f481db11bf860002"));
+
+  onTimeIntervalRun(time(NULL));
+
+  onTimeIntervalResetForUnitTest();
+  utExit();
+}
+
+
+
+/* ****************************************************************************
+*
+* interval -
+*
+* The first notification is due right away, the next one 'interval' seconds later
+*/
+TEST(onTimeIntervalThread, interval)
+{
+  utInit();
+  prepareDatabase();
+  onTimeIntervalResetForUnitTest();
+
+  NotifierMock notifierMock;
+
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(_, "http://notify1.me", "", "", XML))
+    .Times(2);
+
+  onTimeIntervalSchedule("51307b66f481db11bf860001", 60, "", &notifierMock);
+
+  int now = time(NULL);
+
+  onTimeIntervalRun(now);
+  onTimeIntervalRun(now + 59);
+  onTimeIntervalRun(now + 60);
+
+  EXPECT_EQ(1, onTimeIntervalScheduled("51307b66f481db11bf860001"));
+
+  /* The lastNotification of csubs is updated */
+  DBClientBase* connection = getMongoConnection();
+  BSONObj       sub        = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID("51307b66f481db11bf860001")));
+
+  EXPECT_EQ(1360232700, sub.getIntField("lastNotification"));
+
+  onTimeIntervalResetForUnitTest();
+  utExit();
+}
+
+
+
+/* ****************************************************************************
+*
+* grouping -
+*
+* sub1 and sub2 are served by the same query, sub3 by another one: each subscription
+* gets its own subscriptionId and only the attributes it asked for
+*/
+TEST(onTimeIntervalThread, grouping)
+{
+  utInit();
+  prepareDatabase();
+  onTimeIntervalResetForUnitTest();
+
+  NotifyContextRequest    expectedNcr1, expectedNcr2, expectedNcr3;
+  ContextElementResponse  cerA1, cerA2;
+  ContextAttribute        caA1("A1", "TA1", "X");
+  ContextAttribute        caA2("A2", "TA2", "Z");
+
+  cerA1.contextElement.entityId.fill("E1", "T1", "false");
+  cerA1.contextElement.contextAttributeVector.push_back(&caA1);
+  cerA2.contextElement.entityId.fill("E1", "T1", "false");
+  cerA2.contextElement.contextAttributeVector.push_back(&caA2);
+
+  expectedNcr1.originator.set("localhost");
+  expectedNcr1.subscriptionId.set("51307b66f481db11bf860001");
+  expectedNcr1.contextElementResponseVector.push_back(&cerA1);
+  expectedNcr2.originator.set("localhost");
+  expectedNcr2.subscriptionId.set("51307b66f481db11bf860002");
+  expectedNcr2.contextElementResponseVector.push_back(&cerA1);
+  expectedNcr3.originator.set("localhost");
+  expectedNcr3.subscriptionId.set("51307b66f481db11bf860003");
+  expectedNcr3.contextElementResponseVector.push_back(&cerA2);
+
+  NotifierMock notifierMock;
+
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr1), "http://notify1.me", "", "", XML))
+    .Times(1);
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr2), "http://notify2.me", "", "", XML))
+    .Times(1);
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(MatchNcr(&expectedNcr3), "http://notify3.me", "", "", XML))
+    .Times(1);
+
+  onTimeIntervalSchedule("51307b66f481db11bf860001", 60, "", &notifierMock);
+  onTimeIntervalSchedule("51307b66f481db11bf860002", 60, "", &notifierMock);
+  onTimeIntervalSchedule("51307b66f481db11bf860003", 60, "", &notifierMock);
+
+  onTimeIntervalRun(time(NULL));
+
+  onTimeIntervalResetForUnitTest();
+  utExit();
+}
+
+
+
+/* ****************************************************************************
+*
+* throttling -
+*
+* sub4 was notified less than 'throttling' seconds ago, sub5 more
+*/
+TEST(onTimeIntervalThread, throttling)
+{
+  utInit();
+  prepareDatabase();
+  onTimeIntervalResetForUnitTest();
+
+  NotifierMock notifierMock;
+
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(_, "http://notify4.me", "", "", XML))
+    .Times(0);
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(_, "http://notify5.me", "", "", XML))
+    .Times(1);
+
+  onTimeIntervalSchedule("51307b66f481db11bf860004", 60, "", &notifierMock);
+  onTimeIntervalSchedule("51307b66f481db11bf860005", 60, "", &notifierMock);
+
+  onTimeIntervalRun(time(NULL));
+
+  /* A throttled subscription is still scheduled */
+  EXPECT_EQ(1, onTimeIntervalScheduled("51307b66f481db11bf860004"));
+
+  onTimeIntervalResetForUnitTest();
+  utExit();
+}
+
+
+
+/* ****************************************************************************
+*
+* expiration -
+*/
+TEST(onTimeIntervalThread, expiration)
+{
+  utInit();
+  prepareDatabase();
+  onTimeIntervalResetForUnitTest();
+
+  NotifierMock notifierMock;
+
+  EXPECT_CALL(notifierMock, sendNotifyContextRequest(_, _, _, _, _))
+    .Times(0);
+
+  onTimeIntervalSchedule("51307b66f481db11bf860006", 60, "", &notifierMock);
+
+  onTimeIntervalRun(time(NULL));
+
+  /* The csubs document is not modified */
+  DBClientBase* connection = getMongoConnection();
+  BSONObj       sub        = connection->findOne(SUBSCRIBECONTEXT_COLL, BSON("_id" << OID("51307b66f481db11bf860006")));
+
+  EXPECT_EQ(20000000, sub.getIntField("lastNotification"));
+
+  onTimeIntervalResetForUnitTest();
+  utExit();
+}
@@ -0,0 +1,462 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/QueueOverflow.h"
+#include "ngsiNotify/senderThread.h"
+#include "ngsiNotify/senderThreadPool.h"
+
+
+
+/* ****************************************************************************
+*
+* WAIT_MAX - milliseconds a test waits for the workers
+*/
+#define WAIT_MAX  5000
+
+
+
+/* ****************************************************************************
+*
+* The notifications 'sent' by the workers (their resource), in sending order
+*
+* While the gate is closed, the workers wait in testSend, so the queue is not consumed.
+*/
+static pthread_mutex_t           sentMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t            gateCond  = PTHREAD_COND_INITIALIZER;
+static bool                      gateOpen  = true;
+static int                       sending   = 0;
+static std::vector<std::string>  sentV;
+
+
+
+/* ****************************************************************************
+*
+* testSend - the send function of the workers during the tests
+*/
+static void testSend(SenderThreadParams* params)
+{
+  pthread_mutex_lock(&sentMutex);
+
+  ++sending;
+  while (!gateOpen)
+  {
+    pthread_cond_wait(&gateCond, &sentMutex);
+  }
+  --sending;
+
+  sentV.push_back(params->resource);
+  pthread_mutex_unlock(&sentMutex);
+
+  delete params;
+}
+
+
+
+/* ****************************************************************************
+*
+* gateSet - 
+*/
+static void gateSet(bool open)
+{
+  pthread_mutex_lock(&sentMutex);
+  gateOpen = open;
+  pthread_cond_broadcast(&gateCond);
+  pthread_mutex_unlock(&sentMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* msNow - 
+*/
+static long msNow(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+
+
+/* ****************************************************************************
+*
+* sendingWait - wait until 'n' workers are held at the gate
+*/
+static bool sendingWait(int n)
+{
+  long start = msNow();
+
+  while (msNow() - start < WAIT_MAX)
+  {
+    pthread_mutex_lock(&sentMutex);
+    int s = sending;
+    pthread_mutex_unlock(&sentMutex);
+
+    if (s == n)
+    {
+      return true;
+    }
+
+    usleep(1000);
+  }
+
+  return false;
+}
+
+
+
+/* ****************************************************************************
+*
+* sentWait - wait until 'n' notifications have been sent, returns the resources sent
+*/
+static std::vector<std::string> sentWait(unsigned int n)
+{
+  long                      start = msNow();
+  std::vector<std::string>  v;
+
+  while (msNow() - start < WAIT_MAX)
+  {
+    pthread_mutex_lock(&sentMutex);
+    v = sentV;
+    pthread_mutex_unlock(&sentMutex);
+
+    if (v.size() >= n)
+    {
+      break;
+    }
+
+    usleep(1000);
+  }
+
+  return v;
+}
+
+
+
+/* ****************************************************************************
+*
+* enqueue - 
+*/
+static void enqueue(const std::string& resource)
+{
+  SenderThreadParams* params = new SenderThreadParams();
+
+  params->ip       = "127.0.0.1";
+  params->port     = 1;
+  params->verb     = "POST";
+  params->resource = resource;
+  params->transactionId[0] = 0;
+
+  senderThreadPoolEnqueue(params);
+}
+
+
+
+/* ****************************************************************************
+*
+* poolStart - 
+*/
+static void poolStart(int workers, int queueSize, QueueOverflow overflow)
+{
+  sentV.clear();
+  gateSet(true);
+  senderThreadPoolSendFunctionSet(testSend);
+  senderThreadPoolStatisticsReset();
+
+  ASSERT_EQ(0, senderThreadPoolInit(workers, queueSize, overflow));
+  EXPECT_TRUE(senderThreadPoolActive());
+}
+
+
+
+/* ****************************************************************************
+*
+* poolStop - 
+*/
+static void poolStop(void)
+{
+  gateSet(true);
+  senderThreadPoolShutdown();
+  senderThreadPoolSendFunctionSet(NULL);
+
+  EXPECT_FALSE(senderThreadPoolActive());
+}
+
+
+
+/* ****************************************************************************
+*
+* off - with 0 workers the pool is not started
+*/
+TEST(senderThreadPool, off)
+{
+  EXPECT_EQ(0, senderThreadPoolInit(0, 10, QoBlock));
+  EXPECT_FALSE(senderThreadPoolActive());
+}
+
+
+
+/* ****************************************************************************
+*
+* fifo - one worker sends the notifications in the order they were queued
+*/
+TEST(senderThreadPool, fifo)
+{
+  int            depth;
+  int            maxDepth;
+  unsigned long  drops;
+  char           wait[64];
+
+  poolStart(1, 100, QoBlock);
+
+  for (int ix = 0; ix < 50; ++ix)
+  {
+    enqueue(std::string("/") + (char) ('A' + ix % 26) + (char) ('a' + ix / 26));
+  }
+
+  std::vector<std::string> v = sentWait(50);
+
+  ASSERT_EQ(50, v.size());
+  for (int ix = 0; ix < 50; ++ix)
+  {
+    EXPECT_EQ(std::string("/") + (char) ('A' + ix % 26) + (char) ('a' + ix / 26), v[ix]);
+  }
+
+  EXPECT_EQ(50, senderThreadPoolStatistics(&depth, &maxDepth, &drops, wait, sizeof(wait)));
+  EXPECT_EQ(0, depth);
+  EXPECT_EQ(0, drops);
+
+  poolStop();
+}
+
+
+
+/* ****************************************************************************
+*
+* workers - all the notifications are sent, by several workers at the same time
+*/
+TEST(senderThreadPool, workers)
+{
+  poolStart(4, 1000, QoBlock);
+
+  gateSet(false);
+  for (int ix = 0; ix < 500; ++ix)
+  {
+    enqueue("/n");
+  }
+
+  /* the four workers are sending at the same time */
+  EXPECT_TRUE(sendingWait(4));
+
+  gateSet(true);
+  EXPECT_EQ(500, sentWait(500).size());
+
+  poolStop();
+}
+
+
+
+/* ****************************************************************************
+*
+* dropOldest - a notification arriving to a full queue discards the oldest queued one
+*/
+TEST(senderThreadPool, dropOldest)
+{
+  int            depth;
+  int            maxDepth;
+  unsigned long  drops;
+  char           wait[64];
+
+  poolStart(1, 2, QoDropOldest);
+
+  gateSet(false);
+  enqueue("/1");
+  ASSERT_TRUE(sendingWait(1));
+
+  enqueue("/2");
+  enqueue("/3");
+  enqueue("/4");
+
+  EXPECT_EQ(4, senderThreadPoolStatistics(&depth, &maxDepth, &drops, wait, sizeof(wait)));
+  EXPECT_EQ(2, depth);
+  EXPECT_EQ(2, maxDepth);
+  EXPECT_EQ(1, drops);
+
+  gateSet(true);
+
+  std::vector<std::string> v = sentWait(3);
+
+  ASSERT_EQ(3, v.size());
+  EXPECT_EQ("/1", v[0]);
+  EXPECT_EQ("/3", v[1]);
+  EXPECT_EQ("/4", v[2]);
+
+  poolStop();
+}
+
+
+
+/* ****************************************************************************
+*
+* dropNewest - a notification arriving to a full queue is discarded
+*/
+TEST(senderThreadPool, dropNewest)
+{
+  int            depth;
+  int            maxDepth;
+  unsigned long  drops;
+  char           wait[64];
+
+  poolStart(1, 2, QoDropNewest);
+
+  gateSet(false);
+  enqueue("/1");
+  ASSERT_TRUE(sendingWait(1));
+
+  enqueue("/2");
+  enqueue("/3");
+  enqueue("/4");
+
+  EXPECT_EQ(4, senderThreadPoolStatistics(&depth, &maxDepth, &drops, wait, sizeof(wait)));
+  EXPECT_EQ(2, depth);
+  EXPECT_EQ(1, drops);
+
+  gateSet(true);
+
+  std::vector<std::string> v = sentWait(3);
+
+  ASSERT_EQ(3, v.size());
+  EXPECT_EQ("/1", v[0]);
+  EXPECT_EQ("/2", v[1]);
+  EXPECT_EQ("/3", v[2]);
+
+  poolStop();
+}
+
+
+
+/* ****************************************************************************
+*
+* blockingEnqueue - 
+*/
+static void* blockingEnqueue(void* p)
+{
+  enqueue("/3");
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* block - a notification arriving to a full queue waits until there is room for it
+*/
+TEST(senderThreadPool, block)
+{
+  int            depth;
+  int            maxDepth;
+  unsigned long  drops;
+  char           wait[64];
+  pthread_t      tid;
+
+  poolStart(1, 1, QoBlock);
+
+  gateSet(false);
+  enqueue("/1");
+  ASSERT_TRUE(sendingWait(1));
+  enqueue("/2");
+
+  ASSERT_EQ(0, pthread_create(&tid, NULL, blockingEnqueue, NULL));
+
+  /* the producer is blocked: the queue is still full, with "/2" only */
+  usleep(100000);
+  EXPECT_EQ(3, senderThreadPoolStatistics(&depth, &maxDepth, &drops, wait, sizeof(wait)));
+  EXPECT_EQ(1, depth);
+  EXPECT_EQ(0, drops);
+
+  gateSet(true);
+  pthread_join(tid, NULL);
+
+  std::vector<std::string> v = sentWait(3);
+
+  ASSERT_EQ(3, v.size());
+  EXPECT_EQ("/1", v[0]);
+  EXPECT_EQ("/2", v[1]);
+  EXPECT_EQ("/3", v[2]);
+
+  poolStop();
+}
+
+
+
+/* ****************************************************************************
+*
+* shutdown - 
+*/
+static void* shutdown(void* p)
+{
+  senderThreadPoolShutdown();
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* shutdownPending - the notifications left in the queue are freed, not sent
+*/
+TEST(senderThreadPool, shutdownPending)
+{
+  pthread_t tid;
+
+  poolStart(1, 10, QoBlock);
+
+  gateSet(false);
+  enqueue("/1");
+  ASSERT_TRUE(sendingWait(1));
+  enqueue("/2");
+  enqueue("/3");
+
+  /* the worker finishes "/1" once the pool is stopping, "/2" and "/3" are freed */
+  ASSERT_EQ(0, pthread_create(&tid, NULL, shutdown, NULL));
+  usleep(100000);
+  gateSet(true);
+  pthread_join(tid, NULL);
+
+  EXPECT_FALSE(senderThreadPoolActive());
+  EXPECT_EQ(1, sentWait(1).size());
+
+  senderThreadPoolSendFunctionSet(NULL);
+}
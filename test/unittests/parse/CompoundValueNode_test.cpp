@@ -50,7 +50,7 @@ TEST(CompoundValueNode, tree)
 
   for (int ix = 0; ix < 5; ++ix)
   {
-    vecItem = new orion::CompoundValueNode(vec, std::string("/vec/") + name, name, "a", ix, orion::ValueTypeString, 2);
+    vecItem = new orion::CompoundValueNode(vec, name, "a", ix, orion::ValueTypeString);
     vec->add(vecItem);
   }
 
@@ -65,7 +65,7 @@ TEST(CompoundValueNode, tree)
   ASSERT_EQ(6, copy->childV[0]->childV.size());
   ASSERT_STREQ("vecItem", copy->childV[0]->childV[0]->name.c_str());
   ASSERT_EQ(3, copy->childV[0]->childV[3]->siblingNo);
-  ASSERT_EQ(2, copy->childV[0]->childV[3]->level);
+  ASSERT_EQ(2, copy->childV[0]->childV[3]->level());
 
   delete tree;
   delete copy;
@@ -107,8 +107,8 @@ TEST(CompoundValueNode, vectorInvalidAndOk)
   lmTraceLevelSet(LmtCompoundValueAdd, true);
 
   orion::CompoundValueNode*  tree     = new orion::CompoundValueNode(orion::ValueTypeObject);
-  orion::CompoundValueNode*  vec      = new orion::CompoundValueNode(tree, "/vec", "vec", "", 0, orion::ValueTypeVector, 1);
-  orion::CompoundValueNode*  item1    = new orion::CompoundValueNode(vec, std::string("/vec/vecitem1"), "vecitem1",  "a", 0, orion::ValueTypeString, 2);
+  orion::CompoundValueNode*  vec      = new orion::CompoundValueNode(tree, "vec", "", 0, orion::ValueTypeVector);
+  orion::CompoundValueNode*  item1    = new orion::CompoundValueNode(vec, "vecitem1",  "a", 0, orion::ValueTypeString);
   const char*                outFile1 = "ngsi.compoundValue.vector.valid.xml";
   const char*                outFile2 = "ngsi.compoundValue.vector.invalid.json";
 
@@ -122,12 +122,10 @@ TEST(CompoundValueNode, vectorInvalidAndOk)
   vec->add(item1);
   vec->add(orion::ValueTypeString, "vecitem", "a");
 
-  tree->finish();
-  EXPECT_STREQ("bad tag-name of vector item: /vecitem/, should be /vecitem1/", tree->error.c_str());
+  EXPECT_EQ("bad tag-name of vector item: /vecitem/, should be /vecitem1/", tree->finish());
 
   item1->name = "vecitem";
-  tree->finish();
-  EXPECT_STREQ("OK", tree->error.c_str());
+  EXPECT_EQ("OK", tree->finish());
 
   std::string rendered;
 
@@ -160,9 +158,9 @@ TEST(CompoundValueNode, structInvalidAndOk)
   lmTraceLevelSet(LmtCompoundValueAdd, true);
 
   orion::CompoundValueNode*  tree     = new orion::CompoundValueNode(orion::ValueTypeObject);
-  orion::CompoundValueNode*  str      = new orion::CompoundValueNode(tree, "/struct", "struct", "", 0, orion::ValueTypeObject, 1);
-  orion::CompoundValueNode*  item1    = new orion::CompoundValueNode(str, std::string("/struct/structitem"), "structitem", "a", 0, orion::ValueTypeString, 2);
-  orion::CompoundValueNode*  item2    = new orion::CompoundValueNode(str, std::string("/struct/structitem"), "structitem", "a", 1, orion::ValueTypeString, 2);
+  orion::CompoundValueNode*  str      = new orion::CompoundValueNode(tree, "struct", "", 0, orion::ValueTypeObject);
+  orion::CompoundValueNode*  item1    = new orion::CompoundValueNode(str, "structitem", "a", 0, orion::ValueTypeString);
+  orion::CompoundValueNode*  item2    = new orion::CompoundValueNode(str, "structitem", "a", 1, orion::ValueTypeString);
   const char*                outFile1 = "ngsi.compoundValue.struct.valid.xml";
   const char*                outFile2 = "ngsi.compoundValue.struct.invalid.json";
 
@@ -175,12 +173,10 @@ TEST(CompoundValueNode, structInvalidAndOk)
   str->add(item1);
   str->add(item2);
 
-  tree->finish();
-  EXPECT_STREQ("duplicated tag-name: /structitem/ in path: /struct", tree->error.c_str());
+  EXPECT_EQ("duplicated tag-name: /structitem/ in path: /struct", tree->finish());
 
   item2->name = "structitem2";
-  tree->finish();
-  EXPECT_STREQ("OK", tree->error.c_str());
+  EXPECT_EQ("OK", tree->finish());
 
   std::string rendered;
 
@@ -200,3 +196,105 @@ TEST(CompoundValueNode, structInvalidAndOk)
   lmTraceLevelSet(LmtCompoundValueAdd, false);
   utExit();
 }
+
+
+
+/* ****************************************************************************
+*
+* GEOJSON_POINTS -
+*/
+#define GEOJSON_POINTS  1000
+
+
+
+/* ****************************************************************************
+*
+* heapBytes - memory taken by a string outside the node (short strings are kept inside)
+*/
+static int heapBytes(orion::CompoundValueNode* node, const std::string& s)
+{
+  const char* start = (const char*) node;
+  const char* end   = start + sizeof(orion::CompoundValueNode);
+
+  if ((s.data() >= start) && (s.data() < end))
+  {
+    return 0;
+  }
+
+  return s.capacity() + 1;
+}
+
+
+
+/* ****************************************************************************
+*
+* treeBytes - memory taken by a compound value, its strings and child vectors included
+*/
+static int treeBytes(orion::CompoundValueNode* node)
+{
+  int bytes = sizeof(orion::CompoundValueNode);
+
+  bytes += heapBytes(node, node->name) + heapBytes(node, node->stringValue);
+  bytes += node->childV.capacity() * sizeof(orion::CompoundValueNode*);
+
+  for (unsigned int ix = 0; ix < node->childV.size(); ++ix)
+  {
+    bytes += treeBytes(node->childV[ix]);
+  }
+
+  return bytes;
+}
+
+
+
+/* ****************************************************************************
+*
+* geoJsonMemory - memory of a GeoJSON polygon, compared to its JSON payload
+*
+* No path, level, root pointer nor error is kept per node, as they used to be, so
+* the memory of a node is its name, its value and its children.
+*/
+TEST(CompoundValueNode, geoJsonMemory)
+{
+  orion::CompoundValueNode*  tree = new orion::CompoundValueNode(orion::ValueTypeObject);
+  orion::CompoundValueNode*  coords;
+  orion::CompoundValueNode*  ring;
+  orion::CompoundValueNode*  point;
+  int                        nodes;
+  int                        bytes;
+  int                        payload;
+
+  utInit();
+
+  tree->add(orion::ValueTypeString, "type", "Polygon");
+  coords = tree->add(orion::ValueTypeVector, "coordinates", "");
+  ring   = coords->add(orion::ValueTypeVector, "", "");
+
+  for (int ix = 0; ix < GEOJSON_POINTS; ++ix)
+  {
+    point = ring->add(orion::ValueTypeVector, "", "");
+    point->add(orion::ValueTypeNumber, "", -3.691944 + ix * 0.0001);
+    point->add(orion::ValueTypeNumber, "", 40.418889 + ix * 0.0001);
+  }
+
+  EXPECT_EQ("OK", tree->finish());
+  EXPECT_EQ("/coordinates/[0]/[999]/[1]", ring->childV[999]->childV[1]->path());
+  EXPECT_EQ(4, ring->childV[999]->childV[1]->level());
+  EXPECT_EQ(tree, ring->childV[999]->childV[1]->root());
+
+  nodes   = 4 + GEOJSON_POINTS * 3;
+  bytes   = treeBytes(tree);
+  payload = tree->toJson(true).size();
+
+  /* The per node bookkeeping (no path, level, root nor error) is gone for good */
+  EXPECT_GE(2 * sizeof(std::string) + sizeof(std::vector<void*>) + 3 * sizeof(void*), sizeof(orion::CompoundValueNode));
+  EXPECT_LT(bytes, 20 * payload);
+
+  RecordProperty("nodes",     nodes);
+  RecordProperty("nodeSize",  (int) sizeof(orion::CompoundValueNode));
+  RecordProperty("treeBytes", bytes);
+  RecordProperty("jsonBytes", payload);
+
+  delete tree;
+  utExit();
+}
@@ -131,7 +131,7 @@ TEST(compoundValue, updateOneString)
   EXPECT_TRUE(cvnRootP != NULL);
 
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a struct in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -139,9 +139,9 @@ TEST(compoundValue, updateOneString)
   // The root should have exactly one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path); 
+  EXPECT_EQ("/", cvnRootP->path()); 
   
   // The child
   childP = cvnRootP->childV[0];
@@ -152,10 +152,10 @@ TEST(compoundValue, updateOneString)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s1",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s1",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   utExit();
@@ -196,7 +196,7 @@ TEST(compoundValue, updateOneStringJson)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a struct in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -204,9 +204,9 @@ TEST(compoundValue, updateOneStringJson)
   // The root should have exactly one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);
+  EXPECT_EQ("/", cvnRootP->path());
   
   // The child
   childP = cvnRootP->childV[0];
@@ -217,10 +217,10 @@ TEST(compoundValue, updateOneStringJson)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s1",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s1",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   utExit();
@@ -257,7 +257,7 @@ TEST(compoundValue, updateTwoStrings)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a struct in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -265,9 +265,9 @@ TEST(compoundValue, updateTwoStrings)
   // The root should have exactly two children
   EXPECT_EQ(2, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);
+  EXPECT_EQ("/", cvnRootP->path());
 
   // child 1
   childP = cvnRootP->childV[0];
@@ -278,10 +278,10 @@ TEST(compoundValue, updateTwoStrings)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s1",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s1",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   // child 2
@@ -293,10 +293,10 @@ TEST(compoundValue, updateTwoStrings)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s2",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s2",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(1,                                 childP->siblingNo);
 
   utExit();
@@ -335,7 +335,7 @@ TEST(compoundValue, updateTwoStringsJson)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a struct in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -343,9 +343,9 @@ TEST(compoundValue, updateTwoStringsJson)
   // The root should have exactly two children
   EXPECT_EQ(2, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);
+  EXPECT_EQ("/", cvnRootP->path());
 
   // child 1
   childP = cvnRootP->childV[0];
@@ -356,10 +356,10 @@ TEST(compoundValue, updateTwoStringsJson)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s1",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s1",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   // child 2
@@ -371,10 +371,10 @@ TEST(compoundValue, updateTwoStringsJson)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s2",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s2",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(1,                                 childP->siblingNo);
 
   utExit();
@@ -464,7 +464,7 @@ TEST(compoundValue, updateContextValueVectorOneItem)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'vector' in this test case
   EXPECT_EQ(orion::ValueTypeVector, cvnRootP->valueType);
@@ -472,9 +472,9 @@ TEST(compoundValue, updateContextValueVectorOneItem)
   // The root should have exactly one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path); 
+  EXPECT_EQ("/", cvnRootP->path()); 
   
   // The child
   childP = cvnRootP->childV[0];
@@ -485,10 +485,10 @@ TEST(compoundValue, updateContextValueVectorOneItem)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/vecitem",                        childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/vecitem",                        childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   utExit();
@@ -526,7 +526,7 @@ TEST(compoundValue, updateContextValueVectorOneItemJson)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'vector' in this test case
   EXPECT_EQ(orion::ValueTypeVector, cvnRootP->valueType);
@@ -534,9 +534,9 @@ TEST(compoundValue, updateContextValueVectorOneItemJson)
   // The root should have exactly one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);  
+  EXPECT_EQ("/", cvnRootP->path());  
   
   // The child
   childP = cvnRootP->childV[0];
@@ -547,10 +547,10 @@ TEST(compoundValue, updateContextValueVectorOneItemJson)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/item",                           childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/item",                           childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   utExit();
@@ -588,7 +588,7 @@ TEST(compoundValue, updateContextValueVectorFiveItems)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'vector' in this test case
   EXPECT_EQ(orion::ValueTypeVector, cvnRootP->valueType);
@@ -596,9 +596,9 @@ TEST(compoundValue, updateContextValueVectorFiveItems)
   // The root should have five children
   EXPECT_EQ(5, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);
+  EXPECT_EQ("/", cvnRootP->path());
   
   // Child 1-5
   std::string value[] = { "1", "2", "3", "4", "5" };
@@ -612,10 +612,10 @@ TEST(compoundValue, updateContextValueVectorFiveItems)
     EXPECT_EQ(0,                                 childP->childV.size());
 
     EXPECT_EQ(cvnRootP,                          childP->container);
-    EXPECT_EQ(cvnRootP,                          childP->rootP);
+    EXPECT_EQ(cvnRootP,                          childP->root());
 
-    EXPECT_EQ("/vecitem",                        childP->path);
-    EXPECT_EQ(1,                                 childP->level);
+    EXPECT_EQ("/vecitem",                        childP->path());
+    EXPECT_EQ(1,                                 childP->level());
     EXPECT_EQ(childIx,                           childP->siblingNo);
   }
 
@@ -654,7 +654,7 @@ TEST(compoundValue, updateContextValueVectorFiveItemsJson)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'vector' in this test case
   EXPECT_EQ(orion::ValueTypeVector, cvnRootP->valueType);
@@ -662,9 +662,9 @@ TEST(compoundValue, updateContextValueVectorFiveItemsJson)
   // The root should have five children
   EXPECT_EQ(5, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path); 
+  EXPECT_EQ("/", cvnRootP->path()); 
   
   // Child 1-5
   std::string value[] = { "1", "2", "3", "4", "5" };
@@ -678,10 +678,10 @@ TEST(compoundValue, updateContextValueVectorFiveItemsJson)
     EXPECT_EQ(0,                                 childP->childV.size());
 
     EXPECT_EQ(cvnRootP,                          childP->container);
-    EXPECT_EQ(cvnRootP,                          childP->rootP);
+    EXPECT_EQ(cvnRootP,                          childP->root());
 
-    EXPECT_EQ("/item",                           childP->path);
-    EXPECT_EQ(1,                                 childP->level);
+    EXPECT_EQ("/item",                           childP->path());
+    EXPECT_EQ(1,                                 childP->level());
     EXPECT_EQ(childIx,                           childP->siblingNo);
   }
 
@@ -751,7 +751,7 @@ TEST(compoundValue, updateTwoStructs)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'struct' in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -759,9 +759,9 @@ TEST(compoundValue, updateTwoStructs)
   // The root should have two children
   EXPECT_EQ(2, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path); 
+  EXPECT_EQ("/", cvnRootP->path()); 
 
   // Now, child struct 1
   structP = cvnRootP->childV[0];
@@ -771,10 +771,10 @@ TEST(compoundValue, updateTwoStructs)
   EXPECT_EQ(2,                                 structP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          structP->container);
-  EXPECT_EQ(cvnRootP,                          structP->rootP);
+  EXPECT_EQ(cvnRootP,                          structP->root());
 
-  EXPECT_EQ("/struct1",                        structP->path);
-  EXPECT_EQ(1,                                 structP->level);
+  EXPECT_EQ("/struct1",                        structP->path());
+  EXPECT_EQ(1,                                 structP->level());
   EXPECT_EQ(0,                                 structP->siblingNo);
 
 
@@ -787,10 +787,10 @@ TEST(compoundValue, updateTwoStructs)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct1/s1-1",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct1/s1-1",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(0,                                   childP->siblingNo);
 
 
@@ -803,10 +803,10 @@ TEST(compoundValue, updateTwoStructs)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct1/s1-2",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct1/s1-2",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(1,                                   childP->siblingNo);
 
 
@@ -819,10 +819,10 @@ TEST(compoundValue, updateTwoStructs)
   EXPECT_EQ(2,                                 structP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          structP->container);
-  EXPECT_EQ(cvnRootP,                          structP->rootP);
+  EXPECT_EQ(cvnRootP,                          structP->root());
 
-  EXPECT_EQ("/struct2",                        structP->path);
-  EXPECT_EQ(1,                                 structP->level);
+  EXPECT_EQ("/struct2",                        structP->path());
+  EXPECT_EQ(1,                                 structP->level());
   EXPECT_EQ(1,                                 structP->siblingNo);
 
   // Child 1 of struct2
@@ -834,10 +834,10 @@ TEST(compoundValue, updateTwoStructs)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct2/s2-1",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct2/s2-1",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(0,                                   childP->siblingNo);
 
 
@@ -850,10 +850,10 @@ TEST(compoundValue, updateTwoStructs)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct2/s2-2",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct2/s2-2",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(1,                                   childP->siblingNo);
 
   utExit();
@@ -901,7 +901,7 @@ TEST(compoundValue, updateTwoStructsJson)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'struct' in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -909,9 +909,9 @@ TEST(compoundValue, updateTwoStructsJson)
   // The root should have two children
   EXPECT_EQ(2, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path); 
+  EXPECT_EQ("/", cvnRootP->path()); 
 
   // Now, child struct 1
   structP = cvnRootP->childV[0];
@@ -921,10 +921,10 @@ TEST(compoundValue, updateTwoStructsJson)
   EXPECT_EQ(2,                                 structP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          structP->container);
-  EXPECT_EQ(cvnRootP,                          structP->rootP);
+  EXPECT_EQ(cvnRootP,                          structP->root());
 
-  EXPECT_EQ("/struct1",                        structP->path);
-  EXPECT_EQ(1,                                 structP->level);
+  EXPECT_EQ("/struct1",                        structP->path());
+  EXPECT_EQ(1,                                 structP->level());
   EXPECT_EQ(0,                                 structP->siblingNo);
 
   // Child 1 of struct1
@@ -936,10 +936,10 @@ TEST(compoundValue, updateTwoStructsJson)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct1/s1-1",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct1/s1-1",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(0,                                   childP->siblingNo);
 
 
@@ -952,10 +952,10 @@ TEST(compoundValue, updateTwoStructsJson)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct1/s1-2",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct1/s1-2",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(1,                                   childP->siblingNo);
 
 
@@ -968,10 +968,10 @@ TEST(compoundValue, updateTwoStructsJson)
   EXPECT_EQ(2,                                 structP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          structP->container);
-  EXPECT_EQ(cvnRootP,                          structP->rootP);
+  EXPECT_EQ(cvnRootP,                          structP->root());
 
-  EXPECT_EQ("/struct2",                        structP->path);
-  EXPECT_EQ(1,                                 structP->level);
+  EXPECT_EQ("/struct2",                        structP->path());
+  EXPECT_EQ(1,                                 structP->level());
   EXPECT_EQ(1,                                 structP->siblingNo);
 
   // Child 1 of struct2
@@ -983,10 +983,10 @@ TEST(compoundValue, updateTwoStructsJson)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct2/s2-1",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct2/s2-1",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(0,                                   childP->siblingNo);
 
 
@@ -999,10 +999,10 @@ TEST(compoundValue, updateTwoStructsJson)
   EXPECT_EQ(0,                                   childP->childV.size());
 
   EXPECT_EQ(structP,                             childP->container);
-  EXPECT_EQ(cvnRootP,                            childP->rootP);
+  EXPECT_EQ(cvnRootP,                            childP->root());
 
-  EXPECT_EQ("/struct2/s2-2",                     childP->path);
-  EXPECT_EQ(2,                                   childP->level);
+  EXPECT_EQ("/struct2/s2-2",                     childP->path());
+  EXPECT_EQ(2,                                   childP->level());
   EXPECT_EQ(1,                                   childP->siblingNo);
 
   utExit();
@@ -1050,7 +1050,7 @@ TEST(compoundValue, sixLevels)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'struct' in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -1058,9 +1058,9 @@ TEST(compoundValue, sixLevels)
   // The root should have one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);  
+  EXPECT_EQ("/", cvnRootP->path());  
 
   // Now, child 1: level1
   level1 = cvnRootP->childV[0];
@@ -1071,10 +1071,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(2,                                 level1->childV.size());
 
   EXPECT_EQ(cvnRootP,                          level1->container);
-  EXPECT_EQ(cvnRootP,                          level1->rootP);
+  EXPECT_EQ(cvnRootP,                          level1->root());
 
-  EXPECT_EQ("/level1",                         level1->path);
-  EXPECT_EQ(1,                                 level1->level);
+  EXPECT_EQ("/level1",                         level1->path());
+  EXPECT_EQ(1,                                 level1->level());
   EXPECT_EQ(0,                                 level1->siblingNo);
 
   // /level1/level == 1
@@ -1086,10 +1086,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(level1,                            childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/level1/level",                   childP->path);
-  EXPECT_EQ(2,                                 childP->level);
+  EXPECT_EQ("/level1/level",                   childP->path());
+  EXPECT_EQ(2,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
 
@@ -1101,10 +1101,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(2,                                 level2->childV.size());
 
   EXPECT_EQ(level1,                            level2->container);
-  EXPECT_EQ(cvnRootP,                          level2->rootP);
+  EXPECT_EQ(cvnRootP,                          level2->root());
 
-  EXPECT_EQ("/level1/level2",                  level2->path);
-  EXPECT_EQ(2,                                 level2->level);
+  EXPECT_EQ("/level1/level2",                  level2->path());
+  EXPECT_EQ(2,                                 level2->level());
   EXPECT_EQ(1,                                 level2->siblingNo);
 
 
@@ -1117,10 +1117,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(level2,                            childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/level1/level2/level",            childP->path);
-  EXPECT_EQ(3,                                 childP->level);
+  EXPECT_EQ("/level1/level2/level",            childP->path());
+  EXPECT_EQ(3,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   // /level1/level2/level3 == Vector
@@ -1131,10 +1131,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(2,                                 level3->childV.size());
 
   EXPECT_EQ(level2,                            level3->container);
-  EXPECT_EQ(cvnRootP,                          level3->rootP);
+  EXPECT_EQ(cvnRootP,                          level3->root());
 
-  EXPECT_EQ("/level1/level2/level3",           level3->path);
-  EXPECT_EQ(3,                                 level3->level);
+  EXPECT_EQ("/level1/level2/level3",           level3->path());
+  EXPECT_EQ(3,                                 level3->level());
   EXPECT_EQ(1,                                 level3->siblingNo);
 
   // /level1/level2/level3/level4item[0]
@@ -1145,10 +1145,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(2,                                  vitemP->childV.size());
 
   EXPECT_EQ(level3,                             vitemP->container);
-  EXPECT_EQ(cvnRootP,                           vitemP->rootP);
+  EXPECT_EQ(cvnRootP,                           vitemP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item", vitemP->path);
-  EXPECT_EQ(4,                                  vitemP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item", vitemP->path());
+  EXPECT_EQ(4,                                  vitemP->level());
   EXPECT_EQ(0,                                  vitemP->siblingNo);
   
   // /level1/level2/level3/level4item[0]/level
@@ -1160,10 +1160,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                        childP->childV.size());
 
   EXPECT_EQ(vitemP,                                   childP->container);
-  EXPECT_EQ(cvnRootP,                                 childP->rootP);
+  EXPECT_EQ(cvnRootP,                                 childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/level", childP->path);
-  EXPECT_EQ(5,                                        childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/level", childP->path());
+  EXPECT_EQ(5,                                        childP->level());
   EXPECT_EQ(0,                                        childP->siblingNo);
 
   // /level1/level2/level3/level4item[0]/struct1
@@ -1174,10 +1174,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(3,                                          structP->childV.size());
 
   EXPECT_EQ(vitemP,                                     structP->container);
-  EXPECT_EQ(cvnRootP,                                   structP->rootP);
+  EXPECT_EQ(cvnRootP,                                   structP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct1", structP->path);
-  EXPECT_EQ(5,                                          structP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct1", structP->path());
+  EXPECT_EQ(5,                                          structP->level());
   EXPECT_EQ(1,                                          structP->siblingNo);
 
   // /level1/level2/level3/level4item[0]/struct1/level
@@ -1189,10 +1189,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct1/level", childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct1/level", childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(0,                                                childP->siblingNo);
 
   // /level1/level2/level3/level4item[0]/struct1/s1-1
@@ -1204,10 +1204,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct1/s1-1",  childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct1/s1-1",  childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(1,                                                childP->siblingNo);
 
   // /level1/level2/level3/level4item[0]/struct1/s1-2
@@ -1219,10 +1219,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct1/s1-2",  childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct1/s1-2",  childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(2,                                                childP->siblingNo);
 
 
@@ -1234,10 +1234,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(2,                                  vitemP->childV.size());
 
   EXPECT_EQ(level3,                             vitemP->container);
-  EXPECT_EQ(cvnRootP,                           vitemP->rootP);
+  EXPECT_EQ(cvnRootP,                           vitemP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item", vitemP->path);
-  EXPECT_EQ(4,                                  vitemP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item", vitemP->path());
+  EXPECT_EQ(4,                                  vitemP->level());
   EXPECT_EQ(1,                                  vitemP->siblingNo);
   
   // /level1/level2/level3/level4item[1]/level
@@ -1249,10 +1249,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                        childP->childV.size());
 
   EXPECT_EQ(vitemP,                                   childP->container);
-  EXPECT_EQ(cvnRootP,                                 childP->rootP);
+  EXPECT_EQ(cvnRootP,                                 childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/level", childP->path);
-  EXPECT_EQ(5,                                        childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/level", childP->path());
+  EXPECT_EQ(5,                                        childP->level());
   EXPECT_EQ(0,                                        childP->siblingNo);
 
   // /level1/level2/level3/level4item[1]/struct2
@@ -1263,10 +1263,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(3,                                          structP->childV.size());
 
   EXPECT_EQ(vitemP,                                     structP->container);
-  EXPECT_EQ(cvnRootP,                                   structP->rootP);
+  EXPECT_EQ(cvnRootP,                                   structP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct2", structP->path);
-  EXPECT_EQ(5,                                          structP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct2", structP->path());
+  EXPECT_EQ(5,                                          structP->level());
   EXPECT_EQ(1,                                          structP->siblingNo);
 
   // /level1/level2/level3/level4item[1]/struct2/level
@@ -1278,10 +1278,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct2/level", childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct2/level", childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(0,                                                childP->siblingNo);
 
   // /level1/level2/level3/level4item[1]/struct2/s2-1
@@ -1293,10 +1293,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct2/s2-1",  childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct2/s2-1",  childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(1,                                                childP->siblingNo);
 
   // /level1/level2/level3/level4item[1]/struct2/s2-2
@@ -1308,10 +1308,10 @@ TEST(compoundValue, sixLevels)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/level4item/struct2/s2-2",  childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/level4item/struct2/s2-2",  childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(2,                                                childP->siblingNo);
 
   utExit();
@@ -1363,7 +1363,7 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_TRUE(cvnRootP != NULL);
 
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a 'struct' in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -1371,9 +1371,9 @@ TEST(compoundValue, sixLevelsJson)
   // The root should have one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);
+  EXPECT_EQ("/", cvnRootP->path());
   
 
   // Now, child 1: level1
@@ -1385,10 +1385,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(2,                                 level1->childV.size());
 
   EXPECT_EQ(cvnRootP,                          level1->container);
-  EXPECT_EQ(cvnRootP,                          level1->rootP);
+  EXPECT_EQ(cvnRootP,                          level1->root());
 
-  EXPECT_EQ("/level1",                         level1->path);
-  EXPECT_EQ(1,                                 level1->level);
+  EXPECT_EQ("/level1",                         level1->path());
+  EXPECT_EQ(1,                                 level1->level());
   EXPECT_EQ(0,                                 level1->siblingNo);
 
   // /level1/level == 1
@@ -1400,10 +1400,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(level1,                            childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/level1/level",                   childP->path);
-  EXPECT_EQ(2,                                 childP->level);
+  EXPECT_EQ("/level1/level",                   childP->path());
+  EXPECT_EQ(2,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
 
@@ -1415,10 +1415,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(2,                                 level2->childV.size());
 
   EXPECT_EQ(level1,                            level2->container);
-  EXPECT_EQ(cvnRootP,                          level2->rootP);
+  EXPECT_EQ(cvnRootP,                          level2->root());
 
-  EXPECT_EQ("/level1/level2",                  level2->path);
-  EXPECT_EQ(2,                                 level2->level);
+  EXPECT_EQ("/level1/level2",                  level2->path());
+  EXPECT_EQ(2,                                 level2->level());
   EXPECT_EQ(1,                                 level2->siblingNo);
 
 
@@ -1431,10 +1431,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(level2,                            childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/level1/level2/level",            childP->path);
-  EXPECT_EQ(3,                                 childP->level);
+  EXPECT_EQ("/level1/level2/level",            childP->path());
+  EXPECT_EQ(3,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
   // /level1/level2/level3 == Vector
@@ -1445,10 +1445,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(2,                                 level3->childV.size());
 
   EXPECT_EQ(level2,                            level3->container);
-  EXPECT_EQ(cvnRootP,                          level3->rootP);
+  EXPECT_EQ(cvnRootP,                          level3->root());
 
-  EXPECT_EQ("/level1/level2/level3",           level3->path);
-  EXPECT_EQ(3,                                 level3->level);
+  EXPECT_EQ("/level1/level2/level3",           level3->path());
+  EXPECT_EQ(3,                                 level3->level());
   EXPECT_EQ(1,                                 level3->siblingNo);
 
   // /level1/level2/level3/level4item[0]
@@ -1459,10 +1459,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(2,                                  vitemP->childV.size());
 
   EXPECT_EQ(level3,                             vitemP->container);
-  EXPECT_EQ(cvnRootP,                           vitemP->rootP);
+  EXPECT_EQ(cvnRootP,                           vitemP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item",       vitemP->path);
-  EXPECT_EQ(4,                                  vitemP->level);
+  EXPECT_EQ("/level1/level2/level3/item",       vitemP->path());
+  EXPECT_EQ(4,                                  vitemP->level());
   EXPECT_EQ(0,                                  vitemP->siblingNo);
   
   // /level1/level2/level3/item[0]/level
@@ -1474,10 +1474,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                        childP->childV.size());
 
   EXPECT_EQ(vitemP,                                   childP->container);
-  EXPECT_EQ(cvnRootP,                                 childP->rootP);
+  EXPECT_EQ(cvnRootP,                                 childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/level",       childP->path);
-  EXPECT_EQ(5,                                        childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/level",       childP->path());
+  EXPECT_EQ(5,                                        childP->level());
   EXPECT_EQ(0,                                        childP->siblingNo);
 
   // /level1/level2/level3/item[0]/struct1
@@ -1488,10 +1488,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(3,                                          structP->childV.size());
 
   EXPECT_EQ(vitemP,                                     structP->container);
-  EXPECT_EQ(cvnRootP,                                   structP->rootP);
+  EXPECT_EQ(cvnRootP,                                   structP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct1",       structP->path);
-  EXPECT_EQ(5,                                          structP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct1",       structP->path());
+  EXPECT_EQ(5,                                          structP->level());
   EXPECT_EQ(1,                                          structP->siblingNo);
 
   // /level1/level2/level3/item[0]/struct1/level
@@ -1503,10 +1503,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct1/level",       childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct1/level",       childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(0,                                                childP->siblingNo);
 
   // /level1/level2/level3/item[0]/struct1/s1-1
@@ -1518,10 +1518,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct1/s1-1",        childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct1/s1-1",        childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(1,                                                childP->siblingNo);
 
   // /level1/level2/level3/item[0]/struct1/s1-2
@@ -1533,10 +1533,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct1/s1-2",        childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct1/s1-2",        childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(2,                                                childP->siblingNo);
 
 
@@ -1548,10 +1548,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(2,                                  vitemP->childV.size());
 
   EXPECT_EQ(level3,                             vitemP->container);
-  EXPECT_EQ(cvnRootP,                           vitemP->rootP);
+  EXPECT_EQ(cvnRootP,                           vitemP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item",       vitemP->path);
-  EXPECT_EQ(4,                                  vitemP->level);
+  EXPECT_EQ("/level1/level2/level3/item",       vitemP->path());
+  EXPECT_EQ(4,                                  vitemP->level());
   EXPECT_EQ(1,                                  vitemP->siblingNo);
   
   // /level1/level2/level3/item[1]/level
@@ -1563,10 +1563,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                        childP->childV.size());
 
   EXPECT_EQ(vitemP,                                   childP->container);
-  EXPECT_EQ(cvnRootP,                                 childP->rootP);
+  EXPECT_EQ(cvnRootP,                                 childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/level",       childP->path);
-  EXPECT_EQ(5,                                        childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/level",       childP->path());
+  EXPECT_EQ(5,                                        childP->level());
   EXPECT_EQ(0,                                        childP->siblingNo);
 
   // /level1/level2/level3/item[1]/struct2
@@ -1577,10 +1577,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(3,                                          structP->childV.size());
 
   EXPECT_EQ(vitemP,                                     structP->container);
-  EXPECT_EQ(cvnRootP,                                   structP->rootP);
+  EXPECT_EQ(cvnRootP,                                   structP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct2",       structP->path);
-  EXPECT_EQ(5,                                          structP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct2",       structP->path());
+  EXPECT_EQ(5,                                          structP->level());
   EXPECT_EQ(1,                                          structP->siblingNo);
 
   // /level1/level2/level3/item[1]/struct2/level
@@ -1592,10 +1592,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct2/level",       childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct2/level",       childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(0,                                                childP->siblingNo);
 
   // /level1/level2/level3/item[1]/struct2/s2-1
@@ -1607,10 +1607,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct2/s2-1",        childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct2/s2-1",        childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(1,                                                childP->siblingNo);
 
   // /level1/level2/level3/item[1]/struct2/s2-2
@@ -1622,10 +1622,10 @@ TEST(compoundValue, sixLevelsJson)
   EXPECT_EQ(0,                                                childP->childV.size());
 
   EXPECT_EQ(structP,                                          childP->container);
-  EXPECT_EQ(cvnRootP,                                         childP->rootP);
+  EXPECT_EQ(cvnRootP,                                         childP->root());
 
-  EXPECT_EQ("/level1/level2/level3/item/struct2/s2-2",        childP->path);
-  EXPECT_EQ(6,                                                childP->level);
+  EXPECT_EQ("/level1/level2/level3/item/struct2/s2-2",        childP->path());
+  EXPECT_EQ(6,                                                childP->level());
   EXPECT_EQ(2,                                                childP->siblingNo);
 
   utExit();
@@ -1663,7 +1663,7 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValues)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a struct in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -1671,9 +1671,9 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValues)
   // The root should have exactly one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);  
+  EXPECT_EQ("/", cvnRootP->path());  
   
   // The child
   childP = cvnRootP->childV[0];
@@ -1684,10 +1684,10 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValues)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s1",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s1",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
 
@@ -1703,7 +1703,7 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValues)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a vector in this test case
   EXPECT_EQ(orion::ValueTypeVector, cvnRootP->valueType);
@@ -1711,9 +1711,9 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValues)
   // The root should have four children
   EXPECT_EQ(4, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path); 
+  EXPECT_EQ("/", cvnRootP->path()); 
   
   // The children
   const char* value[] = { "I-0", "I-1", "I-2", "I-3" };
@@ -1727,10 +1727,10 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValues)
     EXPECT_EQ(0,                                 childP->childV.size());
 
     EXPECT_EQ(cvnRootP,                          childP->container);
-    EXPECT_EQ(cvnRootP,                          childP->rootP);
+    EXPECT_EQ(cvnRootP,                          childP->root());
 
-    EXPECT_EQ("/item",                           childP->path);
-    EXPECT_EQ(1,                                 childP->level);
+    EXPECT_EQ("/item",                           childP->path());
+    EXPECT_EQ(1,                                 childP->level());
     EXPECT_EQ(ix,                                childP->siblingNo);
   }
 
@@ -1769,7 +1769,7 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValuesJson)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a struct in this test case
   EXPECT_EQ(orion::ValueTypeObject, cvnRootP->valueType);
@@ -1777,9 +1777,9 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValuesJson)
   // The root should have exactly one child
   EXPECT_EQ(1, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);  
+  EXPECT_EQ("/", cvnRootP->path());  
   
   // The child
   childP = cvnRootP->childV[0];
@@ -1790,10 +1790,10 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValuesJson)
   EXPECT_EQ(0,                                 childP->childV.size());
 
   EXPECT_EQ(cvnRootP,                          childP->container);
-  EXPECT_EQ(cvnRootP,                          childP->rootP);
+  EXPECT_EQ(cvnRootP,                          childP->root());
 
-  EXPECT_EQ("/s1",                             childP->path);
-  EXPECT_EQ(1,                                 childP->level);
+  EXPECT_EQ("/s1",                             childP->path());
+  EXPECT_EQ(1,                                 childP->level());
   EXPECT_EQ(0,                                 childP->siblingNo);
 
 
@@ -1809,7 +1809,7 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValuesJson)
   cvnRootP = caP->compoundValueP;
   
   // The root pointer of the root must be the root itself
-  EXPECT_EQ(cvnRootP, cvnRootP->rootP);
+  EXPECT_EQ(cvnRootP, cvnRootP->root());
 
   // The root should be a vector in this test case
   EXPECT_EQ(orion::ValueTypeVector, cvnRootP->valueType);
@@ -1817,9 +1817,9 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValuesJson)
   // The root should have four children
   EXPECT_EQ(4, cvnRootP->childV.size());
 
-  EXPECT_EQ(0, cvnRootP->level);
+  EXPECT_EQ(0, cvnRootP->level());
   EXPECT_EQ(0, cvnRootP->siblingNo);
-  EXPECT_EQ("/", cvnRootP->path);  
+  EXPECT_EQ("/", cvnRootP->path());  
   
   // The children
   const char* value[] = { "I-0", "I-1", "I-2", "I-3" };
@@ -1833,10 +1833,10 @@ TEST(compoundValue, updateOneStringAndOneVectorInSeparateContextValuesJson)
     EXPECT_EQ(0,                       childP->childV.size());
 
     EXPECT_EQ(cvnRootP,                childP->container);
-    EXPECT_EQ(cvnRootP,                childP->rootP);
+    EXPECT_EQ(cvnRootP,                childP->root());
 
-    EXPECT_EQ("/item",                 childP->path);
-    EXPECT_EQ(1,                       childP->level);
+    EXPECT_EQ("/item",                 childP->path());
+    EXPECT_EQ(1,                       childP->level());
     EXPECT_EQ(ix,                      childP->siblingNo);
   }
 
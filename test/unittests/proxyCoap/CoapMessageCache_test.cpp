@@ -0,0 +1,192 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: TID Developer
+*/
+#include <string.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "proxyCoap/CoapMessageCache.h"
+
+
+
+/* ****************************************************************************
+*
+* T0 - current time of the tests
+*/
+#define T0  1360232700
+
+
+
+/* ****************************************************************************
+*
+* keyIpv4 - 
+*/
+static std::string keyIpv4(const char* ip, unsigned short port, unsigned short messageId)
+{
+  struct sockaddr_storage  from;
+  struct sockaddr_in*      inP = (struct sockaddr_in*) &from;
+
+  memset(&from, 0, sizeof(from));
+  inP->sin_family = AF_INET;
+  inP->sin_port   = htons(port);
+  inet_pton(AF_INET, ip, &inP->sin_addr);
+
+  return CoapMessageCache::key(&from, messageId);
+}
+
+
+
+/* ****************************************************************************
+*
+* keys - the source endpoint and the message ID make the key
+*/
+TEST(CoapMessageCache, keys)
+{
+  struct sockaddr_storage  from;
+  struct sockaddr_in6*     in6P = (struct sockaddr_in6*) &from;
+
+  memset(&from, 0, sizeof(from));
+  in6P->sin6_family = AF_INET6;
+  in6P->sin6_port   = htons(5683);
+  inet_pton(AF_INET6, "::1", &in6P->sin6_addr);
+
+  std::string key = keyIpv4("127.0.0.1", 5683, 1);
+
+  EXPECT_EQ(key, keyIpv4("127.0.0.1", 5683, 1));
+  EXPECT_NE(key, keyIpv4("127.0.0.1", 5683, 2));
+  EXPECT_NE(key, keyIpv4("127.0.0.1", 5684, 1));
+  EXPECT_NE(key, keyIpv4("127.0.0.2", 5683, 1));
+  EXPECT_NE(key, CoapMessageCache::key(&from, 1));
+}
+
+
+
+/* ****************************************************************************
+*
+* lookup - New, InProcess and Answered
+*/
+TEST(CoapMessageCache, lookup)
+{
+  CoapMessageCache  cache;
+  std::string       key1 = keyIpv4("127.0.0.1", 5683, 1);
+  std::string       key2 = keyIpv4("127.0.0.1", 5683, 2);
+  std::string       response;
+
+  EXPECT_EQ(CoapMessageCache::New,       cache.lookup(key1, &response, T0));
+  EXPECT_EQ(CoapMessageCache::InProcess, cache.lookup(key1, &response, T0));
+  EXPECT_EQ(CoapMessageCache::New,       cache.lookup(key2, &response, T0));
+
+  /* The response of the first one is resent */
+  cache.done(key1, (const unsigned char*) "ack1", 4);
+  EXPECT_EQ(CoapMessageCache::Answered, cache.lookup(key1, &response, T0 + 1));
+  EXPECT_EQ("ack1", response);
+
+  /* Nothing was sent for the second one */
+  response = "";
+  cache.done(key2, NULL, 0);
+  EXPECT_EQ(CoapMessageCache::Answered, cache.lookup(key2, &response, T0 + 1));
+  EXPECT_EQ("", response);
+
+  /* done for an unknown exchange is ignored */
+  cache.done(keyIpv4("127.0.0.1", 5683, 3), NULL, 0);
+  EXPECT_EQ(CoapMessageCache::New, cache.lookup(keyIpv4("127.0.0.1", 5683, 3), &response, T0 + 1));
+}
+
+
+
+/* ****************************************************************************
+*
+* expiration - an answered exchange is forgotten after COAP_EXCHANGE_LIFETIME seconds
+*/
+TEST(CoapMessageCache, expiration)
+{
+  CoapMessageCache  cache;
+  std::string       key = keyIpv4("127.0.0.1", 5683, 1);
+  std::string       response;
+
+  EXPECT_EQ(CoapMessageCache::New, cache.lookup(key, &response, T0));
+  cache.done(key, (const unsigned char*) "ack", 3);
+
+  EXPECT_EQ(CoapMessageCache::Answered, cache.lookup(key, &response, T0 + COAP_EXCHANGE_LIFETIME - 1));
+  EXPECT_EQ(CoapMessageCache::New,      cache.lookup(key, &response, T0 + COAP_EXCHANGE_LIFETIME));
+}
+
+
+
+/* ****************************************************************************
+*
+* inProcessSkipped - an exchange in process is kept, the ones after it are purged anyway
+*/
+TEST(CoapMessageCache, inProcessSkipped)
+{
+  CoapMessageCache  cache;
+  std::string       slow = keyIpv4("127.0.0.1", 5683, 1);
+  std::string       fast = keyIpv4("127.0.0.1", 5683, 2);
+  std::string       response;
+
+  EXPECT_EQ(CoapMessageCache::New, cache.lookup(slow, &response, T0));
+  EXPECT_EQ(CoapMessageCache::New, cache.lookup(fast, &response, T0));
+  cache.done(fast, (const unsigned char*) "ack", 3);
+
+  EXPECT_EQ(CoapMessageCache::New,       cache.lookup(fast, &response, T0 + COAP_EXCHANGE_LIFETIME + 1));
+  EXPECT_EQ(CoapMessageCache::InProcess, cache.lookup(slow, &response, T0 + COAP_EXCHANGE_LIFETIME + 1));
+
+  /* Once answered, it is purged as any other expired exchange */
+  cache.done(slow, NULL, 0);
+  EXPECT_EQ(CoapMessageCache::New, cache.lookup(slow, &response, T0 + COAP_EXCHANGE_LIFETIME + 2));
+}
+
+
+
+/* ****************************************************************************
+*
+* cap - beyond the maximum number of exchanges, the oldest answered one is forgotten
+*/
+TEST(CoapMessageCache, cap)
+{
+  CoapMessageCache  cache(4);
+  std::string       response;
+
+  /* 1 stays in process, 2, 3 and 4 are answered */
+  for (unsigned short id = 1; id <= 4; ++id)
+  {
+    EXPECT_EQ(CoapMessageCache::New, cache.lookup(keyIpv4("127.0.0.1", 5683, id), &response, T0));
+
+    if (id != 1)
+    {
+      cache.done(keyIpv4("127.0.0.1", 5683, id), NULL, 0);
+    }
+  }
+
+  /* 5 makes the cache forget 2 (the oldest answered one) */
+  EXPECT_EQ(CoapMessageCache::New,       cache.lookup(keyIpv4("127.0.0.1", 5683, 5), &response, T0));
+  EXPECT_EQ(CoapMessageCache::InProcess, cache.lookup(keyIpv4("127.0.0.1", 5683, 1), &response, T0));
+  EXPECT_EQ(CoapMessageCache::Answered,  cache.lookup(keyIpv4("127.0.0.1", 5683, 3), &response, T0));
+  EXPECT_EQ(CoapMessageCache::Answered,  cache.lookup(keyIpv4("127.0.0.1", 5683, 4), &response, T0));
+  EXPECT_EQ(CoapMessageCache::New,       cache.lookup(keyIpv4("127.0.0.1", 5683, 2), &response, T0));
+}
@@ -0,0 +1,353 @@
+/*
+*
+* Copyright 2013 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Ken Zangelin
+*/
+#include <strings.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/string.h"
+#include "ngsi/ParseData.h"
+#include "ngsi/Request.h"
+#include "rest/ConnectionInfo.h"
+#include "rest/RestService.h"
+#include "rest/RestServiceTrie.h"
+#include "contextBroker/orionRestServices.h"
+
+
+
+/* ****************************************************************************
+*
+* treat - 
+*/
+static std::string treat(ConnectionInfo* ciP, int components, std::vector<std::string>& compV, ParseData* parseDataP)
+{
+  return "OK";
+}
+
+
+
+/* ****************************************************************************
+*
+* rs - 
+*
+* A subset of the broker service vector, with the same structure: specific verbs before
+* the badVerb services ("*") of the same URL, wildcard components and the services for
+* any number of components at the end.
+*/
+static RestService rs[] =
+{
+  { "GET",    EntitiesRequest,                       2, { "v2", "entities"                                         }, "",                                      treat },
+  { "POST",   EntitiesRequest,                       2, { "v2", "entities"                                         }, "",                                      treat },
+  { "*",      EntitiesRequest,                       2, { "v2", "entities"                                         }, "",                                      treat },
+  { "GET",    EntityRequest,                         3, { "v2", "entities", "*"                                    }, "",                                      treat },
+  { "DELETE", EntityRequest,                         3, { "v2", "entities", "*"                                    }, "",                                      treat },
+  { "*",      EntityRequest,                         3, { "v2", "entities", "*"                                    }, "",                                      treat },
+  { "GET",    EntityAttributeRequest,                5, { "v2", "entities", "*", "attrs", "*"                      }, "",                                      treat },
+  { "*",      EntityAttributeRequest,                5, { "v2", "entities", "*", "attrs", "*"                      }, "",                                      treat },
+  { "POST",   RegisterContext,                       2, { "ngsi9",  "registerContext"                              }, "registerContextRequest",                treat },
+  { "*",      RegisterContext,                       2, { "ngsi9",  "registerContext"                              }, "registerContextRequest",                treat },
+  { "POST",   UpdateContext,                         2, { "ngsi10", "updateContext"                                }, "updateContextRequest",                  treat },
+  { "*",      UpdateContext,                         2, { "ngsi10", "updateContext"                                }, "updateContextRequest",                  treat },
+  { "GET",    IndividualContextEntity,               3, { "ngsi10", "contextEntities", "*"                         }, "",                                      treat },
+  { "PUT",    IndividualContextEntity,               3, { "ngsi10", "contextEntities", "*"                         }, "updateContextElementRequest",           treat },
+  { "*",      IndividualContextEntity,               3, { "ngsi10", "contextEntities", "*"                         }, "",                                      treat },
+  { "GET",    IndividualContextEntityAttributes,     4, { "ngsi10", "contextEntities", "*", "attributes"           }, "",                                      treat },
+  { "*",      IndividualContextEntityAttributes,     4, { "ngsi10", "contextEntities", "*", "attributes"           }, "",                                      treat },
+  { "GET",    IndividualContextEntityAttribute,      5, { "ngsi10", "contextEntities", "*", "attributes", "*"      }, "",                                      treat },
+  { "*",      IndividualContextEntityAttribute,      5, { "ngsi10", "contextEntities", "*", "attributes", "*"      }, "",                                      treat },
+  { "GET",    EntityTypes,                           2, { "v1", "contextTypes"                                     }, "",                                      treat },
+  { "GET",    LogRequest,                            2, { "log", "trace"                                           }, "",                                      treat },
+  { "PUT",    LogRequest,                            3, { "log", "trace", "*"                                      }, "",                                      treat },
+  { "*",      LogRequest,                            2, { "log", "trace"                                           }, "",                                      treat },
+  { "GET",    StatisticsRequest,                     1, { "statistics"                                             }, "",                                      treat },
+  { "*",      StatisticsRequest,                     1, { "statistics"                                             }, "",                                      treat },
+  { "*",      InvalidRequest,                        2, { "ngsi9",  "*"                                            }, "",                                      treat },
+  { "*",      InvalidRequest,                        2, { "ngsi10", "*"                                            }, "",                                      treat },
+  { "*",      InvalidRequest,                        0, { "*", "*", "*", "*", "*", "*"                             }, "",                                      treat },
+
+  { "",       InvalidRequest,                        0, {                                                          }, "",                                      NULL  }
+};
+
+
+
+/* ****************************************************************************
+*
+* linearLookup - the linear scan of the service vector that the trie replaces
+*/
+static int linearLookup(RestService* serviceV, const std::string& verb, const std::vector<std::string>& compV)
+{
+  int components = compV.size();
+
+  for (int ix = 0; serviceV[ix].treat != NULL; ++ix)
+  {
+    if ((serviceV[ix].components != 0) && (serviceV[ix].components != components))
+    {
+      continue;
+    }
+
+    if ((verb != serviceV[ix].verb) && (serviceV[ix].verb != "*"))
+    {
+      continue;
+    }
+
+    bool match = true;
+    for (int compNo = 0; compNo < components; ++compNo)
+    {
+      if (serviceV[ix].compV[compNo] == "*")
+      {
+        continue;
+      }
+
+      if (strcasecmp(serviceV[ix].compV[compNo].c_str(), compV[compNo].c_str()) != 0)
+      {
+        match = false;
+        break;
+      }
+    }
+
+    if (match == true)
+    {
+      return ix;
+    }
+  }
+
+  return -1;
+}
+
+
+
+/* ****************************************************************************
+*
+* urlV - 
+*/
+static const char* urlV[] =
+{
+  "/v2/entities",
+  "/V2/ENTITIES",
+  "/v2/entities/E1",
+  "/v2/entities/E1/attrs/A1",
+  "/v2/entities/E1/attrs",
+  "/ngsi9/registerContext",
+  "/ngsi9/registercontext",
+  "/ngsi9/unknown",
+  "/ngsi10/updateContext",
+  "/ngsi10/contextEntities/E1",
+  "/ngsi10/contextEntities/E1/attributes",
+  "/ngsi10/contextEntities/E1/attributes/A1",
+  "/ngsi10/contextEntities/E1/attributes/A1/extra",
+  "/v1/contextTypes",
+  "/v1/contextTypes/T1",
+  "/log/trace",
+  "/log/trace/5",
+  "/statistics",
+  "/a/b/c/d/e/f",
+  "/a/b/c/d/e/f/g",
+  "/a//b",
+  NULL
+};
+
+static const char* verbV[] = { "GET", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", NULL };
+
+
+
+/* ****************************************************************************
+*
+* sameMatch - the trie finds the same service as the linear scan
+*/
+TEST(RestServiceTrie, sameMatch)
+{
+  restServiceTrieBuild(rs);
+
+  for (int urlIx = 0; urlV[urlIx] != NULL; ++urlIx)
+  {
+    std::vector<std::string> compV;
+
+    stringSplit(urlV[urlIx], '/', compV);
+
+    for (int verbIx = 0; verbV[verbIx] != NULL; ++verbIx)
+    {
+      EXPECT_EQ(linearLookup(rs, verbV[verbIx], compV), restServiceTrieLookup(rs, verbV[verbIx], compV)) << verbV[verbIx] << " " << urlV[urlIx];
+    }
+  }
+
+  /* Some explicit checks, in case both implementations are wrong in the same way */
+  std::vector<std::string> compV;
+
+  stringSplit("/v2/entities/E1", '/', compV);
+  EXPECT_EQ(3, restServiceTrieLookup(rs, "GET", compV));
+  EXPECT_EQ(5, restServiceTrieLookup(rs, "PATCH", compV));
+  compV.clear();
+
+  stringSplit("/NGSI9/unknown", '/', compV);
+  EXPECT_EQ(25, restServiceTrieLookup(rs, "POST", compV));
+  compV.clear();
+
+  stringSplit("/a/b/c/d/e/f/g", '/', compV);
+  EXPECT_EQ(-1, restServiceTrieLookup(rs, "GET", compV));
+}
+
+
+
+/* ****************************************************************************
+*
+* usecsGet - 
+*/
+static long long usecsGet(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (long long) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+/* ****************************************************************************
+*
+* requestsBuild - one request per service of 'serviceV', matching its URL and verb
+*
+* Wildcard components are replaced by an id and badVerb services ("*") get a PATCH.
+* The services with any number of components (0) are left out.
+*/
+static void requestsBuild
+(
+  RestService*                             serviceV,
+  std::vector<std::vector<std::string> >&  requestV,
+  std::vector<std::string>&                requestVerbV
+)
+{
+  for (int ix = 0; serviceV[ix].treat != NULL; ++ix)
+  {
+    std::vector<std::string> compV;
+
+    if (serviceV[ix].components == 0)
+    {
+      continue;
+    }
+
+    for (int compNo = 0; compNo < serviceV[ix].components; ++compNo)
+    {
+      compV.push_back((serviceV[ix].compV[compNo] == "*")? "id" : serviceV[ix].compV[compNo]);
+    }
+
+    requestV.push_back(compV);
+    requestVerbV.push_back((serviceV[ix].verb == "*")? "PATCH" : serviceV[ix].verb);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* brokerSameMatch - the trie of the broker service vector finds the same services as the linear scan
+*/
+TEST(RestServiceTrie, brokerSameMatch)
+{
+  std::vector<std::vector<std::string> >  requestV;
+  std::vector<std::string>                requestVerbV;
+
+  requestsBuild(restServiceV, requestV, requestVerbV);
+  restServiceTrieBuild(restServiceV);
+
+  for (unsigned int ix = 0; ix < requestV.size(); ++ix)
+  {
+    for (int verbIx = 0; verbV[verbIx] != NULL; ++verbIx)
+    {
+      EXPECT_EQ(linearLookup(restServiceV, verbV[verbIx], requestV[ix]), restServiceTrieLookup(restServiceV, verbV[verbIx], requestV[ix])) << verbV[verbIx] << " request " << ix;
+    }
+  }
+
+  for (int urlIx = 0; urlV[urlIx] != NULL; ++urlIx)
+  {
+    std::vector<std::string> compV;
+
+    stringSplit(urlV[urlIx], '/', compV);
+
+    for (int verbIx = 0; verbV[verbIx] != NULL; ++verbIx)
+    {
+      EXPECT_EQ(linearLookup(restServiceV, verbV[verbIx], compV), restServiceTrieLookup(restServiceV, verbV[verbIx], compV)) << verbV[verbIx] << " " << urlV[urlIx];
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* benchmark - lookup of all the services of the broker, linear scan vs trie
+*
+* The times are not checked (the result depends on the machine load) but recorded
+* as properties of the test, in the XML output of gtest.
+*/
+TEST(RestServiceTrie, benchmark)
+{
+  const int                               loops = 2000;
+  std::vector<std::vector<std::string> >  requestV;
+  std::vector<std::string>                requestVerbV;
+  long long                               start;
+  long long                               linearUsecs;
+  long long                               trieUsecs;
+  long long                               linearSum = 0;
+  long long                               trieSum   = 0;
+  int                                     services  = 0;
+
+  while (restServiceV[services].treat != NULL)
+  {
+    ++services;
+  }
+
+  requestsBuild(restServiceV, requestV, requestVerbV);
+  restServiceTrieBuild(restServiceV);
+
+  start = usecsGet();
+  for (int loop = 0; loop < loops; ++loop)
+  {
+    for (unsigned int ix = 0; ix < requestV.size(); ++ix)
+    {
+      linearSum += linearLookup(restServiceV, requestVerbV[ix], requestV[ix]);
+    }
+  }
+  linearUsecs = usecsGet() - start;
+
+  start = usecsGet();
+  for (int loop = 0; loop < loops; ++loop)
+  {
+    for (unsigned int ix = 0; ix < requestV.size(); ++ix)
+    {
+      trieSum += restServiceTrieLookup(restServiceV, requestVerbV[ix], requestV[ix]);
+    }
+  }
+  trieUsecs = usecsGet() - start;
+
+  EXPECT_EQ(linearSum, trieSum);
+
+  RecordProperty("services",    services);
+  RecordProperty("lookups",     (int) (loops * requestV.size()));
+  RecordProperty("linearUsecs", (int) linearUsecs);
+  RecordProperty("trieUsecs",   (int) trieUsecs);
+}
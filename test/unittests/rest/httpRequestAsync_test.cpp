@@ -0,0 +1,676 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <curl/curl.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/QueueOverflow.h"
+#include "rest/httpRequestAsync.h"
+
+
+
+/* ****************************************************************************
+*
+* WAIT_MAX - milliseconds a test waits for the notifications to be done
+*/
+#define WAIT_MAX  5000
+
+
+
+/* ****************************************************************************
+*
+* Results of the requests, filled in by 'done' (from the event loop thread, mostly)
+*/
+static pthread_mutex_t        resultMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<CURLcode>  resultV;
+static std::vector<long>      idV;
+
+
+
+/* ****************************************************************************
+*
+* msNow - 
+*/
+static long msNow(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+
+
+/* ****************************************************************************
+*
+* done - 
+*/
+static void done(CURL* curl, CURLcode res, void* data)
+{
+  pthread_mutex_lock(&resultMutex);
+  resultV.push_back(res);
+  idV.push_back((long) data);
+  pthread_mutex_unlock(&resultMutex);
+
+  curl_easy_cleanup(curl);
+}
+
+
+
+/* ****************************************************************************
+*
+* resultsReset - 
+*/
+static void resultsReset(void)
+{
+  pthread_mutex_lock(&resultMutex);
+  resultV.clear();
+  idV.clear();
+  pthread_mutex_unlock(&resultMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* resultsWait - wait until 'n' requests are done, returns the number of done requests
+*/
+static int resultsWait(unsigned int n)
+{
+  long          start = msNow();
+  unsigned int  size  = 0;
+
+  while (msNow() - start < WAIT_MAX)
+  {
+    pthread_mutex_lock(&resultMutex);
+    size = resultV.size();
+    pthread_mutex_unlock(&resultMutex);
+
+    if (size >= n)
+    {
+      break;
+    }
+
+    usleep(10000);
+  }
+
+  return size;
+}
+
+
+
+/* ****************************************************************************
+*
+* resultGet - result of the request with id 'id' (CURL_LAST if not done)
+*/
+static CURLcode resultGet(long id)
+{
+  CURLcode res = CURL_LAST;
+
+  pthread_mutex_lock(&resultMutex);
+
+  for (unsigned int ix = 0; ix < idV.size(); ++ix)
+  {
+    if (idV[ix] == id)
+    {
+      res = resultV[ix];
+    }
+  }
+
+  pthread_mutex_unlock(&resultMutex);
+
+  return res;
+}
+
+
+
+/* ****************************************************************************
+*
+* inFlightWait - wait until 'n' requests are in flight
+*/
+static bool inFlightWait(int n)
+{
+  long start = msNow();
+
+  while (msNow() - start < WAIT_MAX)
+  {
+    int            inFlight;
+    unsigned long  drops;
+
+    httpRequestAsyncStatistics(&inFlight, &drops);
+
+    if (inFlight == n)
+    {
+      return true;
+    }
+
+    usleep(10000);
+  }
+
+  return false;
+}
+
+
+
+/* ****************************************************************************
+*
+* listenFd - a socket listening in 127.0.0.1, in an ephemeral port
+*
+* If nobody accepts the connections, the requests are sent (the connection is
+* completed by the kernel) but never answered.
+*/
+static int listenFd(unsigned short* portP)
+{
+  int                 fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in  sin;
+  socklen_t           len = sizeof(sin);
+
+  memset(&sin, 0, sizeof(sin));
+  sin.sin_family      = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sin.sin_port        = 0;
+
+  if ((bind(fd, (struct sockaddr*) &sin, sizeof(sin)) != 0) || (listen(fd, 128) != 0))
+  {
+    close(fd);
+    return -1;
+  }
+
+  getsockname(fd, (struct sockaddr*) &sin, &len);
+  *portP = ntohs(sin.sin_port);
+
+  return fd;
+}
+
+
+
+/* ****************************************************************************
+*
+* responder - answers 200 OK to the requests of the connections accepted in the socket
+*/
+static void* responder(void* p)
+{
+  int fd = (long) p;
+
+  while (true)
+  {
+    int cfd = accept(fd, NULL, NULL);
+
+    if (cfd == -1)
+    {
+      break;
+    }
+
+    char  buf[1024];
+    int   nb;
+
+    while ((nb = read(cfd, buf, sizeof(buf) - 1)) > 0)
+    {
+      buf[nb] = 0;
+      if (strstr(buf, "\r\n\r\n") != NULL)
+      {
+        break;
+      }
+    }
+
+    const char* response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nOK";
+
+    if (write(cfd, response, strlen(response)) == -1)
+    {
+      perror("write");
+    }
+
+    close(cfd);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* keepAliveResponder - answers 200 OK to all the requests of each connection
+*
+* The number of accepted connections is left in 'accepts'.
+*/
+static int accepts = 0;
+
+static void* keepAliveResponder(void* p)
+{
+  int fd = (long) p;
+
+  while (true)
+  {
+    int cfd = accept(fd, NULL, NULL);
+
+    if (cfd == -1)
+    {
+      break;
+    }
+
+    ++accepts;
+
+    char  buf[1024];
+    int   nb;
+
+    while ((nb = read(cfd, buf, sizeof(buf) - 1)) > 0)
+    {
+      buf[nb] = 0;
+      if (strstr(buf, "\r\n\r\n") == NULL)
+      {
+        continue;
+      }
+
+      const char* response = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+
+      if (write(cfd, response, strlen(response)) == -1)
+      {
+        perror("write");
+      }
+    }
+
+    close(cfd);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* doneRelease - 'done' giving the handle back to be reused
+*/
+static void doneRelease(CURL* curl, CURLcode res, void* data)
+{
+  httpRequestAsyncHandleRelease("127.0.0.1", curl);
+
+  pthread_mutex_lock(&resultMutex);
+  resultV.push_back(res);
+  idV.push_back((long) data);
+  pthread_mutex_unlock(&resultMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* requestAdd - add a GET request, 'id' is the data given to 'done'
+*/
+static void requestAdd(unsigned short port, long timeoutMs, long id)
+{
+  CURL*  curl = curl_easy_init();
+  char   url[64];
+
+  snprintf(url, sizeof(url), "http://127.0.0.1:%d/notify", port);
+
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+  curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+
+  httpRequestAsyncAdd(curl, done, (void*) id);
+}
+
+
+
+/* ****************************************************************************
+*
+* completion - all the requests are sent and answered
+*/
+TEST(httpRequestAsync, completion)
+{
+  unsigned short  port;
+  int             fd = listenFd(&port);
+  pthread_t       tid;
+  int             inFlight;
+  unsigned long   drops;
+
+  ASSERT_NE(-1, fd);
+  pthread_create(&tid, NULL, responder, (void*) (long) fd);
+
+  resultsReset();
+  EXPECT_EQ(0, httpRequestAsyncInit(4, 100, QoDropNewest));
+  EXPECT_TRUE(httpRequestAsyncActive());
+
+  for (long ix = 0; ix < 20; ++ix)
+  {
+    requestAdd(port, 2000, ix);
+  }
+
+  EXPECT_EQ(20, resultsWait(20));
+
+  for (long ix = 0; ix < 20; ++ix)
+  {
+    EXPECT_EQ(CURLE_OK, resultGet(ix));
+  }
+
+  EXPECT_EQ(20, httpRequestAsyncStatistics(&inFlight, &drops));
+  EXPECT_EQ(0, inFlight);
+  EXPECT_EQ(0, drops);
+
+  httpRequestAsyncShutdown();
+  httpRequestAsyncStatisticsReset();
+  EXPECT_FALSE(httpRequestAsyncActive());
+
+  shutdown(fd, SHUT_RDWR);
+  pthread_join(tid, NULL);
+  close(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* timeout - a request that is not answered in time
+*/
+TEST(httpRequestAsync, timeout)
+{
+  unsigned short  port;
+  int             fd = listenFd(&port);
+  long            start;
+
+  ASSERT_NE(-1, fd);
+
+  resultsReset();
+  EXPECT_EQ(0, httpRequestAsyncInit(4, 100, QoDropNewest));
+
+  start = msNow();
+  requestAdd(port, 200, 1);
+
+  EXPECT_EQ(1, resultsWait(1));
+  EXPECT_EQ(CURLE_OPERATION_TIMEDOUT, resultGet(1));
+  EXPECT_LE(200, msNow() - start);
+
+  httpRequestAsyncShutdown();
+  httpRequestAsyncStatisticsReset();
+  close(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* queueFullDropNewest - the request arriving to a full queue is discarded
+*/
+TEST(httpRequestAsync, queueFullDropNewest)
+{
+  unsigned short  port;
+  int             fd = listenFd(&port);
+  int             inFlight;
+  unsigned long   drops;
+
+  ASSERT_NE(-1, fd);
+
+  resultsReset();
+  EXPECT_EQ(0, httpRequestAsyncInit(1, 1, QoDropNewest));
+
+  requestAdd(port, 3000, 1);
+  ASSERT_TRUE(inFlightWait(1));
+  requestAdd(port, 3000, 2);
+  requestAdd(port, 3000, 3);
+
+  EXPECT_EQ(CURLE_FAILED_INIT, resultGet(3));
+  EXPECT_EQ(CURL_LAST, resultGet(1));
+  EXPECT_EQ(CURL_LAST, resultGet(2));
+  EXPECT_EQ(3, httpRequestAsyncStatistics(&inFlight, &drops));
+  EXPECT_EQ(1, drops);
+
+  // The request in flight is aborted and the waiting one discarded
+  httpRequestAsyncShutdown();
+  httpRequestAsyncStatisticsReset();
+
+  EXPECT_EQ(CURLE_ABORTED_BY_CALLBACK, resultGet(1));
+  EXPECT_EQ(CURLE_FAILED_INIT, resultGet(2));
+  close(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* queueFullDropOldest - the oldest waiting request is discarded to make room
+*/
+TEST(httpRequestAsync, queueFullDropOldest)
+{
+  unsigned short  port;
+  int             fd = listenFd(&port);
+  int             inFlight;
+  unsigned long   drops;
+
+  ASSERT_NE(-1, fd);
+
+  resultsReset();
+  EXPECT_EQ(0, httpRequestAsyncInit(1, 1, QoDropOldest));
+
+  requestAdd(port, 3000, 1);
+  ASSERT_TRUE(inFlightWait(1));
+  requestAdd(port, 3000, 2);
+  requestAdd(port, 3000, 3);
+
+  EXPECT_EQ(CURLE_FAILED_INIT, resultGet(2));
+  EXPECT_EQ(CURL_LAST, resultGet(3));
+  httpRequestAsyncStatistics(&inFlight, &drops);
+  EXPECT_EQ(1, drops);
+
+  httpRequestAsyncShutdown();
+  httpRequestAsyncStatisticsReset();
+
+  EXPECT_EQ(CURLE_ABORTED_BY_CALLBACK, resultGet(1));
+  EXPECT_EQ(CURLE_FAILED_INIT, resultGet(3));
+  close(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* queueFullBlock - the caller waits until there is room in the queue
+*/
+TEST(httpRequestAsync, queueFullBlock)
+{
+  unsigned short  port;
+  int             fd = listenFd(&port);
+  int             inFlight;
+  unsigned long   drops;
+  long            start;
+
+  ASSERT_NE(-1, fd);
+
+  resultsReset();
+  EXPECT_EQ(0, httpRequestAsyncInit(1, 1, QoBlock));
+
+  requestAdd(port, 300, 1);
+  ASSERT_TRUE(inFlightWait(1));
+  requestAdd(port, 300, 2);
+
+  // Request 1 has to time out, so that request 2 leaves the queue and 3 gets in
+  start = msNow();
+  requestAdd(port, 300, 3);
+
+  EXPECT_LE(250, msNow() - start);
+  EXPECT_EQ(CURLE_OPERATION_TIMEDOUT, resultGet(1));
+
+  EXPECT_EQ(3, resultsWait(3));
+  EXPECT_EQ(CURLE_OPERATION_TIMEDOUT, resultGet(2));
+  EXPECT_EQ(CURLE_OPERATION_TIMEDOUT, resultGet(3));
+  httpRequestAsyncStatistics(&inFlight, &drops);
+  EXPECT_EQ(0, drops);
+
+  httpRequestAsyncShutdown();
+  httpRequestAsyncStatisticsReset();
+  close(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* highDescriptors - requests whose sockets are beyond FD_SETSIZE
+*
+* The descriptors below FD_SETSIZE are taken, so that the sockets of the requests
+* get higher numbers (select() could not be used with them).
+*/
+TEST(httpRequestAsync, highDescriptors)
+{
+  struct rlimit     rl;
+  std::vector<int>  fdV;
+  unsigned short    port;
+  int               fd;
+  pthread_t         tid;
+
+  getrlimit(RLIMIT_NOFILE, &rl);
+  if (rl.rlim_max < FD_SETSIZE + 100)
+  {
+    return;  // not possible in this system
+  }
+
+  rl.rlim_cur = FD_SETSIZE + 100;
+  setrlimit(RLIMIT_NOFILE, &rl);
+
+  while (true)
+  {
+    int dfd = dup(0);
+
+    if ((dfd == -1) || (dfd >= FD_SETSIZE))
+    {
+      if (dfd != -1)
+      {
+        close(dfd);
+      }
+      break;
+    }
+
+    fdV.push_back(dfd);
+  }
+
+  fd = listenFd(&port);
+  ASSERT_NE(-1, fd);
+  EXPECT_LE(FD_SETSIZE, fd);
+  pthread_create(&tid, NULL, responder, (void*) (long) fd);
+
+  resultsReset();
+  EXPECT_EQ(0, httpRequestAsyncInit(8, 100, QoDropNewest));
+
+  for (long ix = 0; ix < 20; ++ix)
+  {
+    requestAdd(port, 2000, ix);
+  }
+
+  EXPECT_EQ(20, resultsWait(20));
+
+  for (long ix = 0; ix < 20; ++ix)
+  {
+    EXPECT_EQ(CURLE_OK, resultGet(ix));
+  }
+
+  httpRequestAsyncShutdown();
+  httpRequestAsyncStatisticsReset();
+
+  shutdown(fd, SHUT_RDWR);
+  pthread_join(tid, NULL);
+  close(fd);
+
+  for (unsigned int ix = 0; ix < fdV.size(); ++ix)
+  {
+    close(fdV[ix]);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* handleReuse - 
+*
+* The handles given back are reused for the next requests to the same destination,
+* and so is the connection
+*/
+TEST(httpRequestAsync, handleReuse)
+{
+  unsigned short  port;
+  int             fd = listenFd(&port);
+  pthread_t       tid;
+  CURL*           first = NULL;
+  char            url[64];
+
+  ASSERT_NE(-1, fd);
+  accepts = 0;
+  pthread_create(&tid, NULL, keepAliveResponder, (void*) (long) fd);
+  snprintf(url, sizeof(url), "http://127.0.0.1:%d/notify", port);
+
+  resultsReset();
+  EXPECT_EQ(0, httpRequestAsyncInit(4, 100, QoDropNewest, 60));
+
+  for (long ix = 0; ix < 5; ++ix)
+  {
+    CURL* curl = httpRequestAsyncHandleGet("127.0.0.1");
+
+    ASSERT_TRUE(curl != NULL);
+
+    if (ix == 0)
+    {
+      first = curl;
+    }
+    else
+    {
+      EXPECT_TRUE(curl == first);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 2000L);
+
+    httpRequestAsyncAdd(curl, doneRelease, (void*) ix);
+    EXPECT_EQ(ix + 1, resultsWait(ix + 1));
+    EXPECT_EQ(CURLE_OK, resultGet(ix));
+  }
+
+  EXPECT_EQ(1, accepts);
+
+  // Handles to other destinations are different
+  CURL* other = httpRequestAsyncHandleGet("127.0.0.2");
+
+  EXPECT_TRUE(other != first);
+  curl_easy_cleanup(other);
+
+  httpRequestAsyncShutdown();
+  httpRequestAsyncStatisticsReset();
+
+  shutdown(fd, SHUT_RDWR);
+  pthread_join(tid, NULL);
+  close(fd);
+}
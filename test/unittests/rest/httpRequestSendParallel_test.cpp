@@ -0,0 +1,361 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rest/httpRequestSend.h"
+
+
+
+/* ****************************************************************************
+*
+* msNow - 
+*/
+static long msNow(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+
+
+/* ****************************************************************************
+*
+* listenFd - a socket listening in 127.0.0.1, in an ephemeral port
+*
+* If nobody accepts the connections, the requests are sent (the connection is
+* completed by the kernel) but never answered.
+*/
+static int listenFd(unsigned short* portP)
+{
+  int                 fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in  sin;
+  socklen_t           len = sizeof(sin);
+
+  memset(&sin, 0, sizeof(sin));
+  sin.sin_family      = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sin.sin_port        = 0;
+
+  if ((bind(fd, (struct sockaddr*) &sin, sizeof(sin)) != 0) || (listen(fd, 512) != 0))
+  {
+    close(fd);
+    return -1;
+  }
+
+  getsockname(fd, (struct sockaddr*) &sin, &len);
+  *portP = ntohs(sin.sin_port);
+
+  return fd;
+}
+
+
+
+/* ****************************************************************************
+*
+* closedPort - a port nobody listens to (connections are refused)
+*/
+static unsigned short closedPort(void)
+{
+  unsigned short  port;
+  int             fd = listenFd(&port);
+
+  close(fd);
+  return port;
+}
+
+
+
+/* ****************************************************************************
+*
+* responder - answers the requests of the connections accepted in the socket
+*
+* The response payload is the resource of the request.
+*/
+static void* responder(void* p)
+{
+  int fd = (long) p;
+
+  while (true)
+  {
+    int cfd = accept(fd, NULL, NULL);
+
+    if (cfd == -1)
+    {
+      break;
+    }
+
+    std::string  request;
+    char         buf[1024];
+    int          nb;
+
+    while ((nb = read(cfd, buf, sizeof(buf))) > 0)
+    {
+      request.append(buf, nb);
+
+      size_t headersEnd = request.find("\r\n\r\n");
+      size_t lengthAt   = request.find("Content-length: ");
+
+      if ((headersEnd != std::string::npos) && (lengthAt != std::string::npos) &&
+          (request.size() >= headersEnd + 4 + atoi(request.c_str() + lengthAt + 16)))
+      {
+        break;
+      }
+    }
+
+    std::string  resource = request.substr(request.find(' ') + 1);
+    char         response[256];
+
+    resource = resource.substr(0, resource.find(' '));
+    snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nContent-Length: %d\r\nConnection: close\r\n\r\n%s",
+             (int) resource.size(), resource.c_str());
+
+    if (write(cfd, response, strlen(response)) == -1)
+    {
+      perror("write");
+    }
+
+    close(cfd);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* slowResponder - responder, starting to accept connections after 300 milliseconds
+*/
+static void* slowResponder(void* p)
+{
+  usleep(300000);
+  return responder(p);
+}
+
+
+
+/* ****************************************************************************
+*
+* requestNew - 
+*/
+static HttpRequest* requestNew(unsigned short port, const std::string& resource)
+{
+  HttpRequest* rP = new HttpRequest();
+
+  rP->ip       = "127.0.0.1";
+  rP->port     = port;
+  rP->protocol = "http:";
+  rP->verb     = "POST";
+  rP->resource = resource;
+  rP->mimeType = "application/json";
+  rP->content  = "{}";
+  rP->timedOut = false;
+
+  return rP;
+}
+
+
+
+/* ****************************************************************************
+*
+* mixed - a provider answering, one that is late and one that is down
+*
+* Only the late one is timed out (CURLE_OPERATION_TIMEDOUT), and the call doesn't wait
+* much more than the deadline.
+*/
+TEST(httpRequestSendParallel, mixed)
+{
+  unsigned short             okPort;
+  unsigned short             latePort;
+  int                        okFd   = listenFd(&okPort);
+  int                        lateFd = listenFd(&latePort);
+  pthread_t                  tid;
+  std::vector<HttpRequest*>  requestV;
+
+  ASSERT_NE(-1, okFd);
+  ASSERT_NE(-1, lateFd);
+  pthread_create(&tid, NULL, responder, (void*) (long) okFd);
+
+  requestV.push_back(requestNew(okPort,       "/ok"));
+  requestV.push_back(requestNew(latePort,     "/late"));
+  requestV.push_back(requestNew(closedPort(), "/down"));
+
+  long start = msNow();
+  httpRequestSendParallel(requestV, 500);
+  long elapsed = msNow() - start;
+
+  EXPECT_GE(elapsed, 450);
+  EXPECT_LT(elapsed, 2000);
+
+  EXPECT_FALSE(requestV[0]->timedOut);
+  EXPECT_NE(std::string::npos, requestV[0]->response.find("200 OK"));
+  EXPECT_EQ("/ok", requestV[0]->response.substr(requestV[0]->response.size() - 3));
+
+  EXPECT_TRUE(requestV[1]->timedOut);
+  EXPECT_EQ("", requestV[1]->response);
+
+  EXPECT_FALSE(requestV[2]->timedOut);
+  EXPECT_EQ("", requestV[2]->response);
+
+  for (unsigned int ix = 0; ix < requestV.size(); ++ix)
+  {
+    delete requestV[ix];
+  }
+
+  shutdown(okFd, SHUT_RDWR);
+  close(okFd);
+  pthread_join(tid, NULL);
+  close(lateFd);
+}
+
+
+
+/* ****************************************************************************
+*
+* failingAndSlow - providers failing at once and one answering late
+*
+* The failing requests may be finished by the first curl_multi_socket_action (a refused
+* connection, depending on the libcurl version, and a malformed URL), the wait must go on
+* until the slow provider (still within the deadline) answers.
+*/
+TEST(httpRequestSendParallel, failingAndSlow)
+{
+  unsigned short             slowPort;
+  int                        slowFd = listenFd(&slowPort);
+  pthread_t                  tid;
+  std::vector<HttpRequest*>  requestV;
+
+  ASSERT_NE(-1, slowFd);
+  pthread_create(&tid, NULL, slowResponder, (void*) (long) slowFd);
+
+  requestV.push_back(requestNew(closedPort(), "/down"));
+  requestV.push_back(requestNew(slowPort,     "/slow"));
+  requestV.push_back(requestNew(slowPort,     "/malformed"));
+  requestV[2]->ip = "bad host";
+
+  long start = msNow();
+  httpRequestSendParallel(requestV, 2000);
+  long elapsed = msNow() - start;
+
+  EXPECT_GE(elapsed, 250);
+  EXPECT_LT(elapsed, 1500);
+
+  EXPECT_FALSE(requestV[0]->timedOut);
+  EXPECT_EQ("", requestV[0]->response);
+
+  EXPECT_FALSE(requestV[1]->timedOut);
+  EXPECT_NE(std::string::npos, requestV[1]->response.find("200 OK"));
+  EXPECT_EQ("/slow", requestV[1]->response.substr(requestV[1]->response.size() - 5));
+
+  EXPECT_FALSE(requestV[2]->timedOut);
+  EXPECT_EQ("", requestV[2]->response);
+
+  for (unsigned int ix = 0; ix < requestV.size(); ++ix)
+  {
+    delete requestV[ix];
+  }
+
+  shutdown(slowFd, SHUT_RDWR);
+  close(slowFd);
+  pthread_join(tid, NULL);
+}
+
+
+
+/* ****************************************************************************
+*
+* many - a lot of requests at the same time, no thread is created for them
+*
+* Each response goes to its own request.
+*/
+TEST(httpRequestSendParallel, many)
+{
+  unsigned short             port;
+  int                        fd = listenFd(&port);
+  pthread_t                  tid;
+  std::vector<HttpRequest*>  requestV;
+
+  ASSERT_NE(-1, fd);
+  pthread_create(&tid, NULL, responder, (void*) (long) fd);
+
+  for (int ix = 0; ix < 300; ++ix)
+  {
+    char resource[32];
+
+    snprintf(resource, sizeof(resource), "/r%d", ix);
+    requestV.push_back(requestNew(port, resource));
+  }
+
+  httpRequestSendParallel(requestV, 5000);
+
+  for (int ix = 0; ix < 300; ++ix)
+  {
+    char resource[32];
+
+    snprintf(resource, sizeof(resource), "\r\n\r\n/r%d", ix);
+    EXPECT_FALSE(requestV[ix]->timedOut);
+    EXPECT_NE(std::string::npos, requestV[ix]->response.find(resource)) << "request " << ix;
+    delete requestV[ix];
+  }
+
+  shutdown(fd, SHUT_RDWR);
+  close(fd);
+  pthread_join(tid, NULL);
+}
+
+
+
+/* ****************************************************************************
+*
+* badRequest - a request that can not be sent gets "error" as response
+*/
+TEST(httpRequestSendParallel, badRequest)
+{
+  std::vector<HttpRequest*>  requestV;
+
+  requestV.push_back(requestNew(0, "/noPort"));
+
+  httpRequestSendParallel(requestV, 500);
+
+  EXPECT_EQ("error", requestV[0]->response);
+  EXPECT_FALSE(requestV[0]->timedOut);
+
+  delete requestV[0];
+}
@@ -22,6 +22,11 @@
 *
 * Author: Ken Zangelin
 */
+#include <string.h>
+#include <sys/time.h>
+
+#include <string>
+
 #include "logMsg/logMsg.h"
 
 #include "serviceRoutines/postQueryContext.h"
@@ -29,6 +34,12 @@
 #include "rest/RestService.h"
 
 #include "unittest.h"
+#include "testProvider.h"
+
+#include "common/globals.h"
+#include "mongoBackend/MongoGlobal.h"
+
+#include "mongo/client/dbclient.h"
 
 
 
@@ -73,3 +84,73 @@ TEST(postQueryContext, notFound)
 
   utExit();
 }
+
+
+
+/* ****************************************************************************
+*
+* forwardTimeout - two context providers, one answering and one not answering in time
+*
+* The result of the one answering is returned, the call doesn't wait much more than
+* -cprForwardTimeout for the other one.
+*/
+TEST(postQueryContext, forwardTimeout)
+{
+  ConnectionInfo  ci("/ngsi10/queryContext",  "POST", "1.1");
+  TestProvider    okProvider;
+  TestProvider    lateProvider;
+  const char*     payload    = "{\"entities\": [{\"type\": \"T1\", \"isPattern\": \"false\", \"id\": \"E1\"},"
+                                              "{\"type\": \"T2\", \"isPattern\": \"false\", \"id\": \"E2\"}],"
+                               "\"attributes\": [\"A1\", \"A2\"]}";
+  const char*     cpPayload  = "{\"contextResponses\": [{\"contextElement\": {\"attributes\": [{\"name\": \"A1\", \"type\": \"TA1\", \"value\": \"fromProvider\"}],"
+                               "\"id\": \"E1\", \"isPattern\": \"false\", \"type\": \"T1\"},"
+                               "\"statusCode\": {\"code\": \"200\", \"reasonPhrase\": \"OK\"}}]}";
+  std::string     out;
+
+  utInit();
+
+  ASSERT_TRUE(testProviderStart(&okProvider, true, cpPayload));
+  ASSERT_TRUE(testProviderStart(&lateProvider, false));
+
+  DBClientBase*  connection = getMongoConnection();
+  BSONObj        cr1 = BSON("providingApplication" << testProviderUrl(&okProvider) <<
+                            "entities" << BSON_ARRAY(BSON("id" << "E1" << "type" << "T1")) <<
+                            "attrs" << BSON_ARRAY(BSON("name" << "A1" << "type" << "TA1" << "isDomain" << "false")));
+  BSONObj        cr2 = BSON("providingApplication" << testProviderUrl(&lateProvider) <<
+                            "entities" << BSON_ARRAY(BSON("id" << "E2" << "type" << "T2")) <<
+                            "attrs" << BSON_ARRAY(BSON("name" << "A2" << "type" << "TA2" << "isDomain" << "false")));
+
+  connection->insert(REGISTRATIONS_COLL, BSON("_id" << OID("51307b66f481db11bf860001") <<
+                                              "expiration" << 1879048191 <<
+                                              "format" << "JSON" <<
+                                              "contextRegistration" << BSON_ARRAY(cr1 << cr2)));
+
+  strncpy(testBuf, payload, sizeof(testBuf));
+  ci.outFormat    = JSON;
+  ci.inFormat     = JSON;
+  ci.payload      = testBuf;
+  ci.payloadSize  = strlen(testBuf);
+
+  cprForwardTimeout = 500;
+
+  struct timeval start;
+  struct timeval end;
+
+  gettimeofday(&start, NULL);
+  out = restService(&ci, rs);
+  gettimeofday(&end, NULL);
+
+  cprForwardTimeout = -1;
+
+  long elapsed = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000;
+
+  EXPECT_GE(elapsed, 450);
+  EXPECT_LT(elapsed, 3000);
+  EXPECT_NE(std::string::npos, out.find("fromProvider")) << out;
+  EXPECT_EQ(std::string::npos, out.find("E2")) << out;
+
+  testProviderStop(&okProvider);
+  testProviderStop(&lateProvider);
+
+  utExit();
+}
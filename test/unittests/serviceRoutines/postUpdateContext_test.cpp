@@ -22,6 +22,11 @@
 *
 * Author: Ken Zangelin
 */
+#include <string.h>
+#include <sys/time.h>
+
+#include <string>
+
 #include "logMsg/logMsg.h"
 
 #include "serviceRoutines/postUpdateContext.h"
@@ -29,6 +34,12 @@
 #include "rest/RestService.h"
 
 #include "unittest.h"
+#include "testProvider.h"
+
+#include "common/globals.h"
+#include "mongoBackend/MongoGlobal.h"
+
+#include "mongo/client/dbclient.h"
 
 
 
@@ -71,3 +82,72 @@ TEST(postUpdateContext, createEntity)
 
   utExit();
 }
+
+
+
+/* ****************************************************************************
+*
+* forwardTimeout - two context providers, one answering and one not answering in time
+*
+* The entity of the one answering is updated, the one of the other gets a 404 with
+* "context provider timeout" as details.
+*/
+TEST(postUpdateContext, forwardTimeout)
+{
+  ConnectionInfo  ci("/ngsi10/updateContext",  "POST", "1.1");
+  TestProvider    okProvider;
+  TestProvider    lateProvider;
+  const char*     payload    = "{\"contextElements\": ["
+                               "{\"type\": \"T1\", \"isPattern\": \"false\", \"id\": \"E1\", \"attributes\": [{\"name\": \"A1\", \"type\": \"TA1\", \"value\": \"10\"}]},"
+                               "{\"type\": \"T2\", \"isPattern\": \"false\", \"id\": \"E2\", \"attributes\": [{\"name\": \"A2\", \"type\": \"TA2\", \"value\": \"20\"}]}],"
+                               "\"updateAction\": \"UPDATE\"}";
+  const char*     cpPayload  = "{\"contextResponses\": [{\"contextElement\": {\"attributes\": [{\"name\": \"A1\", \"type\": \"TA1\", \"value\": \"\"}],"
+                               "\"id\": \"E1\", \"isPattern\": \"false\", \"type\": \"T1\"},"
+                               "\"statusCode\": {\"code\": \"200\", \"reasonPhrase\": \"OK\"}}]}";
+  std::string     out;
+
+  utInit();
+
+  ASSERT_TRUE(testProviderStart(&okProvider, true, cpPayload));
+  ASSERT_TRUE(testProviderStart(&lateProvider, false));
+
+  DBClientBase*  connection = getMongoConnection();
+  BSONObj        cr1 = BSON("providingApplication" << testProviderUrl(&okProvider) <<
+                            "entities" << BSON_ARRAY(BSON("id" << "E1" << "type" << "T1")) <<
+                            "attrs" << BSON_ARRAY(BSON("name" << "A1" << "type" << "TA1" << "isDomain" << "false")));
+  BSONObj        cr2 = BSON("providingApplication" << testProviderUrl(&lateProvider) <<
+                            "entities" << BSON_ARRAY(BSON("id" << "E2" << "type" << "T2")) <<
+                            "attrs" << BSON_ARRAY(BSON("name" << "A2" << "type" << "TA2" << "isDomain" << "false")));
+
+  connection->insert(REGISTRATIONS_COLL, BSON("_id" << OID("51307b66f481db11bf860001") <<
+                                              "expiration" << 1879048191 <<
+                                              "format" << "JSON" <<
+                                              "contextRegistration" << BSON_ARRAY(cr1 << cr2)));
+
+  strncpy(testBuf, payload, sizeof(testBuf));
+  ci.outFormat    = JSON;
+  ci.inFormat     = JSON;
+  ci.payload      = testBuf;
+  ci.payloadSize  = strlen(testBuf);
+
+  cprForwardTimeout = 500;
+  out = restService(&ci, rs);
+  cprForwardTimeout = -1;
+
+  size_t e1At      = out.find("\"E1\"");
+  size_t e2At      = out.find("\"E2\"");
+  size_t timeoutAt = out.find("context provider timeout");
+
+  ASSERT_NE(std::string::npos, e1At) << out;
+  ASSERT_NE(std::string::npos, e2At) << out;
+  ASSERT_NE(std::string::npos, timeoutAt) << out;
+
+  /* E1 is OK, the timeout is the status of E2 */
+  EXPECT_NE(std::string::npos, out.substr(e1At, e2At - e1At).find("\"200\"")) << out;
+  EXPECT_GT(timeoutAt, e2At);
+
+  testProviderStop(&okProvider);
+  testProviderStop(&lateProvider);
+
+  utExit();
+}
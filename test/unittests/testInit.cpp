@@ -28,6 +28,7 @@
 #include "logMsg/logMsg.h"
 
 #include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/indexManager.h"
 #include "mongo/client/dbclient.h"
 
 using namespace mongo;
@@ -67,6 +68,9 @@ void setupDatabase(void)
 
     releaseMongoConnection(connection);
 
+    /* The collections are dropped, so are their indexes */
+    indexesReset();
+
     setDbPrefix(DBPREFIX);
     setRegistrationsCollectionName("registrations");
     setEntitiesCollectionName("entities");
@@ -0,0 +1,169 @@
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <string>
+
+#include "testProvider.h"
+
+
+
+/* ****************************************************************************
+*
+* requestRead - read a request, up to the end of its payload (Content-length)
+*/
+static void requestRead(int fd)
+{
+  std::string  request;
+  char         buf[1024];
+  int          nb;
+
+  while ((nb = read(fd, buf, sizeof(buf))) > 0)
+  {
+    request.append(buf, nb);
+
+    size_t headersEnd = request.find("\r\n\r\n");
+    size_t lengthAt   = request.find("Content-length: ");
+
+    if ((headersEnd != std::string::npos) &&
+        ((lengthAt == std::string::npos) || (request.size() >= headersEnd + 4 + atoi(request.c_str() + lengthAt + 16))))
+    {
+      break;
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* responder - 
+*/
+static void* responder(void* p)
+{
+  TestProvider* tpP = (TestProvider*) p;
+
+  while (true)
+  {
+    int cfd = accept(tpP->fd, NULL, NULL);
+
+    if (cfd == -1)
+    {
+      break;
+    }
+
+    requestRead(cfd);
+
+    char header[128];
+
+    snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Length: %d\r\nConnection: close\r\n\r\n", (int) tpP->payload.size());
+
+    std::string response = std::string(header) + tpP->payload;
+
+    if (write(cfd, response.c_str(), response.size()) == -1)
+    {
+      perror("write");
+    }
+
+    close(cfd);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* testProviderStart - 
+*/
+bool testProviderStart(TestProvider* tpP, bool answer, const std::string& payload)
+{
+  struct sockaddr_in  sin;
+  socklen_t           len = sizeof(sin);
+
+  tpP->fd      = socket(AF_INET, SOCK_STREAM, 0);
+  tpP->answer  = answer;
+  tpP->payload = payload;
+
+  memset(&sin, 0, sizeof(sin));
+  sin.sin_family      = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sin.sin_port        = 0;
+
+  if ((bind(tpP->fd, (struct sockaddr*) &sin, sizeof(sin)) != 0) || (listen(tpP->fd, 128) != 0))
+  {
+    close(tpP->fd);
+    return false;
+  }
+
+  getsockname(tpP->fd, (struct sockaddr*) &sin, &len);
+  tpP->port = ntohs(sin.sin_port);
+
+  if ((answer == true) && (pthread_create(&tpP->tid, NULL, responder, tpP) != 0))
+  {
+    close(tpP->fd);
+    return false;
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* testProviderUrl - 
+*/
+std::string testProviderUrl(TestProvider* tpP)
+{
+  char url[64];
+
+  snprintf(url, sizeof(url), "http://127.0.0.1:%d/v1", tpP->port);
+  return url;
+}
+
+
+
+/* ****************************************************************************
+*
+* testProviderStop - 
+*/
+void testProviderStop(TestProvider* tpP)
+{
+  shutdown(tpP->fd, SHUT_RDWR);
+  close(tpP->fd);
+
+  if (tpP->answer == true)
+  {
+    pthread_join(tpP->tid, NULL);
+  }
+}
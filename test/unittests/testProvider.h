@@ -0,0 +1,75 @@
+#ifndef TEST_PROVIDER_H
+#define TEST_PROVIDER_H
+
+/*
+*
+* Copyright 2015 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Fermin Galan
+*/
+#include <pthread.h>
+
+#include <string>
+
+
+
+/* ****************************************************************************
+*
+* TestProvider - a context provider listening in 127.0.0.1, in an ephemeral port
+*
+* If 'answer' is true, every request gets a 200 OK with 'payload' (the payload is
+* not checked against the request). Otherwise, the connections are completed by the
+* kernel but never accepted, so the requests are sent but never answered.
+*/
+typedef struct TestProvider
+{
+  int             fd;
+  unsigned short  port;
+  bool            answer;
+  std::string     payload;
+  pthread_t       tid;
+} TestProvider;
+
+
+
+/* ****************************************************************************
+*
+* testProviderStart - false if the provider could not be started
+*/
+extern bool testProviderStart(TestProvider* tpP, bool answer, const std::string& payload = "");
+
+
+
+/* ****************************************************************************
+*
+* testProviderUrl - the URL to register the provider with (prefix '/v1')
+*/
+extern std::string testProviderUrl(TestProvider* tpP);
+
+
+
+/* ****************************************************************************
+*
+* testProviderStop - 
+*/
+extern void testProviderStop(TestProvider* tpP);
+
+#endif